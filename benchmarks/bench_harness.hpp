@@ -0,0 +1,312 @@
+/**
+ * @file bench_harness.hpp
+ * @brief Minimal microbenchmark harness with JSON output
+ *
+ * Each benchmark is a function that runs its operation a given number of
+ * times. The runner calibrates the iteration count until one run takes at
+ * least the minimum time, repeats the run, and reports nanoseconds per
+ * operation (median, min, max over the repetitions). Results are written as
+ * JSON so they can be archived and compared between builds.
+ *
+ * A baseline is a results file with a per-benchmark tolerance (percent).
+ * compare() scales the baseline by the ratio of a calibration benchmark (a
+ * fixed integer loop) between the two runs, so a uniformly slower or faster
+ * machine does not read as a regression, then flags every benchmark whose
+ * median exceeds its scaled baseline by more than its tolerance.
+ *
+ * Header-only and dependency-free so it builds wherever the tests build.
+ */
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <map>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Keep a value alive so the optimizer cannot drop the work producing it
+ */
+template <typename T>
+inline void doNotOptimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+/**
+ * @struct BenchmarkResult
+ * @brief Timing of one benchmark (nanoseconds per operation)
+ */
+struct BenchmarkResult {
+    std::string name;
+    uint64_t iterations = 0;    // Per repetition
+    int repetitions = 0;
+    double medianNs = 0.0;
+    double minNs = 0.0;
+    double maxNs = 0.0;
+};
+
+/**
+ * @struct Baseline
+ * @brief Reference results loaded from a JSON file written by the runner
+ */
+struct Baseline {
+    struct Entry {
+        double realTimeNs = 0.0;
+        double tolerancePct = 0.0;   // 0 = use the default tolerance
+    };
+
+    std::string buildType;
+    std::map<std::string, Entry> entries;
+
+    /**
+     * @brief Load a baseline; only the fields the runner writes are read
+     */
+    bool load(const std::string& path) {
+        std::ifstream in(path);
+        if (!in) {
+            return false;
+        }
+        std::stringstream buffer;
+        buffer << in.rdbuf();
+        const std::string text = buffer.str();
+
+        buildType = stringField(text, 0, text.size(), "build_type");
+        entries.clear();
+        size_t pos = 0;
+        while ((pos = text.find("{\"name\":", pos)) != std::string::npos) {
+            size_t end = text.find('}', pos);
+            if (end == std::string::npos) {
+                break;
+            }
+            std::string name = stringField(text, pos, end, "name");
+            Entry entry;
+            entry.realTimeNs = numberField(text, pos, end, "real_time");
+            entry.tolerancePct = numberField(text, pos, end, "tolerance");
+            if (!name.empty() && entry.realTimeNs > 0.0) {
+                entries[name] = entry;
+            }
+            pos = end;
+        }
+        return !entries.empty();
+    }
+
+private:
+    static size_t valueStart(const std::string& text, size_t begin, size_t end, const char* key) {
+        std::string quoted = std::string("\"") + key + "\":";
+        size_t at = text.find(quoted, begin);
+        if (at == std::string::npos || at >= end) {
+            return std::string::npos;
+        }
+        at += quoted.size();
+        while (at < end && text[at] == ' ') at++;
+        return at;
+    }
+
+    static std::string stringField(const std::string& text, size_t begin, size_t end, const char* key) {
+        size_t at = valueStart(text, begin, end, key);
+        if (at == std::string::npos || text[at] != '"') {
+            return std::string();
+        }
+        size_t close = text.find('"', at + 1);
+        return close == std::string::npos ? std::string() : text.substr(at + 1, close - at - 1);
+    }
+
+    static double numberField(const std::string& text, size_t begin, size_t end, const char* key) {
+        size_t at = valueStart(text, begin, end, key);
+        return at == std::string::npos ? 0.0 : std::strtod(text.c_str() + at, nullptr);
+    }
+};
+
+/**
+ * @class BenchmarkRunner
+ * @brief Registers, runs and reports benchmarks
+ */
+class BenchmarkRunner {
+public:
+    using Function = std::function<void(uint64_t iterations)>;
+
+    struct Options {
+        double minTimeMs = 100.0;   // Minimum duration of one repetition
+        int repetitions = 5;
+        std::string filter;         // Substring of the benchmark name; empty = all
+    };
+
+    void add(const std::string& name, Function function) {
+        m_benchmarks.push_back({name, std::move(function)});
+    }
+
+    std::vector<std::string> names() const {
+        std::vector<std::string> result;
+        for (const auto& benchmark : m_benchmarks) {
+            result.push_back(benchmark.name);
+        }
+        return result;
+    }
+
+    std::vector<BenchmarkResult> run(const Options& options) const {
+        std::vector<BenchmarkResult> results;
+        for (const auto& benchmark : m_benchmarks) {
+            if (!options.filter.empty() && benchmark.name.find(options.filter) == std::string::npos) {
+                continue;
+            }
+            results.push_back(runOne(benchmark, options));
+        }
+        return results;
+    }
+
+    /**
+     * @brief Write results as JSON; with a baseline, each entry keeps its tolerance
+     */
+    static void writeJson(std::ostream& out, const std::vector<BenchmarkResult>& results, const Options& options,
+                          const Baseline* tolerances = nullptr, double defaultTolerancePct = 0.0) {
+        std::time_t now = std::time(nullptr);
+        char date[32] = {};
+        std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+
+        out << "{\n  \"context\": {\n"
+            << "    \"date\": \"" << date << "\",\n"
+            << "    \"num_cpus\": " << std::thread::hardware_concurrency() << ",\n"
+            << "    \"build_type\": \"" << buildType() << "\",\n"
+            << "    \"min_time_ms\": " << options.minTimeMs << ",\n"
+            << "    \"repetitions\": " << options.repetitions << "\n"
+            << "  },\n  \"benchmarks\": [";
+        for (size_t i = 0; i < results.size(); ++i) {
+            const BenchmarkResult& r = results[i];
+            out << (i ? ",\n" : "\n") << std::fixed << std::setprecision(2)
+                << "    {\"name\": \"" << escape(r.name) << "\", \"iterations\": " << r.iterations
+                << ", \"repetitions\": " << r.repetitions
+                << ", \"real_time\": " << r.medianNs << ", \"min_time\": " << r.minNs
+                << ", \"max_time\": " << r.maxNs << ", \"time_unit\": \"ns\"";
+            if (tolerances) {
+                auto it = tolerances->entries.find(r.name);
+                double tolerance = (it != tolerances->entries.end() && it->second.tolerancePct > 0.0)
+                    ? it->second.tolerancePct : defaultTolerancePct;
+                out << ", \"tolerance\": " << tolerance;
+            }
+            out << "}";
+        }
+        out << "\n  ]\n}\n";
+    }
+
+    /**
+     * @brief Compare results against a baseline and print a table
+     *
+     * @param calibrationName Benchmark used to scale the baseline to this machine (may be absent)
+     * @return Number of benchmarks slower than their tolerance allows
+     */
+    static int compare(const std::vector<BenchmarkResult>& results, const Baseline& baseline,
+                       double defaultTolerancePct, const std::string& calibrationName, std::ostream& out) {
+        double scale = 1.0;
+        auto calibration = baseline.entries.find(calibrationName);
+        for (const auto& r : results) {
+            if (r.name == calibrationName && calibration != baseline.entries.end()) {
+                scale = r.medianNs / calibration->second.realTimeNs;
+            }
+        }
+
+        out << std::fixed << std::setprecision(2)
+            << "Baseline scaled by " << scale << " (" << calibrationName << ")\n"
+            << std::left << std::setw(32) << "benchmark" << std::right
+            << std::setw(14) << "baseline ns" << std::setw(14) << "current ns"
+            << std::setw(10) << "change" << std::setw(10) << "limit" << "  status\n";
+
+        int regressions = 0;
+        for (const auto& r : results) {
+            auto it = baseline.entries.find(r.name);
+            out << std::left << std::setw(32) << r.name << std::right;
+            if (it == baseline.entries.end()) {
+                out << std::setw(14) << "-" << std::setw(14) << r.medianNs
+                    << std::setw(10) << "-" << std::setw(10) << "-" << "  new\n";
+                continue;
+            }
+            double expected = it->second.realTimeNs * scale;
+            double tolerance = it->second.tolerancePct > 0.0 ? it->second.tolerancePct : defaultTolerancePct;
+            double changePct = (r.medianNs / expected - 1.0) * 100.0;
+            bool regressed = r.name != calibrationName && changePct > tolerance;
+            regressions += regressed ? 1 : 0;
+
+            std::ostringstream change;
+            change << std::fixed << std::setprecision(1) << std::showpos << changePct << "%";
+            std::ostringstream limit;
+            limit << std::fixed << std::setprecision(0) << "+" << tolerance << "%";
+            out << std::setw(14) << expected << std::setw(14) << r.medianNs
+                << std::setw(10) << change.str() << std::setw(10) << limit.str()
+                << "  " << (regressed ? "REGRESSED" : "ok") << "\n";
+        }
+        return regressions;
+    }
+
+    static const char* buildType() {
+#ifdef NDEBUG
+        return "release";
+#else
+        return "debug";
+#endif
+    }
+
+private:
+    struct Benchmark {
+        std::string name;
+        Function function;
+    };
+
+    static double timeRunNs(const Function& function, uint64_t iterations) {
+        auto start = std::chrono::steady_clock::now();
+        function(iterations);
+        auto end = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::nano>(end - start).count();
+    }
+
+    static BenchmarkResult runOne(const Benchmark& benchmark, const Options& options) {
+        // Grow the iteration count until one run covers the minimum time
+        const double minTimeNs = options.minTimeMs * 1e6;
+        uint64_t iterations = 1;
+        double elapsed = timeRunNs(benchmark.function, iterations);
+        while (elapsed < minTimeNs && iterations < (1ull << 40)) {
+            double scale = elapsed > 0.0 ? (minTimeNs * 1.2) / elapsed : 10.0;
+            uint64_t next = static_cast<uint64_t>(iterations * std::min(std::max(scale, 1.5), 10.0));
+            iterations = std::max(next, iterations + 1);
+            elapsed = timeRunNs(benchmark.function, iterations);
+        }
+
+        std::vector<double> perOp;
+        for (int rep = 0; rep < std::max(1, options.repetitions); ++rep) {
+            perOp.push_back(timeRunNs(benchmark.function, iterations) / static_cast<double>(iterations));
+        }
+        std::sort(perOp.begin(), perOp.end());
+
+        BenchmarkResult result;
+        result.name = benchmark.name;
+        result.iterations = iterations;
+        result.repetitions = static_cast<int>(perOp.size());
+        result.medianNs = perOp[perOp.size() / 2];
+        result.minNs = perOp.front();
+        result.maxNs = perOp.back();
+        return result;
+    }
+
+    static std::string escape(const std::string& text) {
+        std::string escaped;
+        for (char c : text) {
+            if (c == '"' || c == '\\') escaped += '\\';
+            escaped += c;
+        }
+        return escaped;
+    }
+
+    std::vector<Benchmark> m_benchmarks;
+};
@@ -0,0 +1,42 @@
+#!/usr/bin/env bash
+# Build plain, LTO and PGO (+LTO) Release variants and compare them on the replay
+# workload and the translate microbenchmarks. Prints a Markdown table; all variants
+# must report the same replay checksum.
+#
+# Usage: benchmarks/compare_builds.sh [work-dir] [replay iterations]
+set -euo pipefail
+
+root="$(cd "$(dirname "$0")/.." && pwd)"
+work="${1:-$root/build-compare}"
+iterations="${2:-300}"
+runs=5
+
+cmake -S "$root" -B "$work/plain" -DCMAKE_BUILD_TYPE=Release -DBUILD_TESTS=OFF > /dev/null
+cmake --build "$work/plain" --target xidp_replay xidp_bench -j"$(nproc)" > /dev/null
+cmake -S "$root" -B "$work/lto" -DCMAKE_BUILD_TYPE=Release -DBUILD_TESTS=OFF -DXIDP_LTO=ON > /dev/null
+cmake --build "$work/lto" --target xidp_replay xidp_bench -j"$(nproc)" > /dev/null
+"$root/benchmarks/pgo_build.sh" "$work/pgo" --lto -DBUILD_TESTS=OFF > /dev/null
+
+# Median of several replay runs, in ns per frame
+replay_median() {
+    for _ in $(seq "$runs"); do
+        "$1/xidp_replay" --json --iterations="$iterations" "$root/tests/golden"
+    done | sed -E 's/.*"ns_per_frame": ([0-9.]+).*"checksum": "([0-9a-f]+)".*/\1 \2/' \
+         | sort -n | awk -v n="$runs" 'NR == int((n + 1) / 2) { print }'
+}
+
+bench_median() {
+    "$1/xidp_bench" --filter="$2" --repetitions="$runs" --min-time-ms=100 --pin-cpu=auto 2> /dev/null \
+        | sed -nE 's/.*"name": "([^"]+)".*"real_time": ([0-9.]+).*/\1 \2/p'
+}
+
+echo "| Build | replay ns/frame | translate/1 ns | translate/16 ns | translate/64 ns | checksum |"
+echo "| :--- | ---: | ---: | ---: | ---: | :--- |"
+for variant in plain lto pgo; do
+    read -r replay checksum <<< "$(replay_median "$work/$variant")"
+    bench="$(bench_median "$work/$variant" translate/)"
+    t1="$(awk '$1 == "translate/1_controllers" { print $2 }' <<< "$bench")"
+    t16="$(awk '$1 == "translate/16_controllers" { print $2 }' <<< "$bench")"
+    t64="$(awk '$1 == "translate/64_controllers" { print $2 }' <<< "$bench")"
+    echo "| $variant | $replay | $t1 | $t16 | $t64 | $checksum |"
+done
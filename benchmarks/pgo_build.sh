@@ -0,0 +1,34 @@
+#!/usr/bin/env bash
+# Profile-guided Release build (GCC or Clang) trained by replaying the bundled recordings.
+# Both phases use the same build directory, since GCC matches profiles by object path.
+#
+# Usage: benchmarks/pgo_build.sh [build-dir] [--lto] [extra cmake arguments...]
+set -euo pipefail
+
+root="$(cd "$(dirname "$0")/.." && pwd)"
+build="${1:-$root/build-pgo}"
+shift || true
+lto=OFF
+if [[ "${1:-}" == "--lto" ]]; then
+    lto=ON
+    shift
+fi
+profiles="$build/pgo-profiles"
+targets=(--target xidp_replay xidp_bench xidp_latency)
+
+# 1. Instrumented build
+rm -rf "$profiles"
+cmake -S "$root" -B "$build" -DCMAKE_BUILD_TYPE=Release -DBUILD_BENCHMARKS=ON \
+    -DXIDP_LTO="$lto" -DXIDP_PGO=GENERATE -DXIDP_PGO_DIR="$profiles" "$@"
+cmake --build "$build" "${targets[@]}" -j"$(nproc)"
+
+# 2. Training run: headless replay of every recording
+"$build/xidp_replay" --iterations=200 "$root/tests/golden"
+if compgen -G "$profiles/*.profraw" > /dev/null; then
+    llvm-profdata merge -o "$profiles/xidp.profdata" "$profiles"/*.profraw
+fi
+
+# 3. Optimized build from the profiles
+cmake -S "$root" -B "$build" -DXIDP_PGO=USE
+cmake --build "$build" "${targets[@]}" -j"$(nproc)" --clean-first
+echo "PGO build ready in $build"
@@ -0,0 +1,15 @@
+#!/usr/bin/env bash
+# Refresh benchmarks/baseline.json from a Release build of xidp_bench on this machine.
+# Per-benchmark tolerances already in the baseline are kept; new benchmarks get the default.
+#
+# Usage: benchmarks/update_baseline.sh [build-dir] [extra xidp_bench arguments...]
+set -euo pipefail
+
+root="$(cd "$(dirname "$0")/.." && pwd)"
+build="${1:-$root/build-perf}"
+shift || true
+
+cmake -S "$root" -B "$build" -DCMAKE_BUILD_TYPE=Release -DBUILD_BENCHMARKS=ON
+cmake --build "$build" --target xidp_bench -j"$(nproc)"
+"$build/xidp_bench" --pin-cpu=auto --repetitions=9 --min-time-ms=200 \
+    --write-baseline="$root/benchmarks/baseline.json" "$@"
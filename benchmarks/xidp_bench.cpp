@@ -0,0 +1,456 @@
+/**
+ * @file xidp_bench.cpp
+ * @brief Microbenchmarks of the hot-path stages of the translation pipeline
+ *
+ * Usage: xidp_bench [--filter=<substring>] [--min-time-ms=<ms>] [--repetitions=<n>]
+ *                   [--out=<file>] [--list] [--pin-cpu=<core>|auto]
+ *                   [--baseline=<file>] [--tolerance=<percent>] [--write-baseline=<file>]
+ *
+ * Results are written as JSON (to stdout unless --out is given). With
+ * --baseline the run is compared against a checked-in baseline and the exit
+ * code is 1 if any benchmark regressed beyond its tolerance (the perf test).
+ * --write-baseline refreshes a baseline, keeping its per-benchmark tolerances.
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "bench_harness.hpp"
+#include "core/translation_layer.hpp"
+#include "core/device_splitter.hpp"
+#include "core/motion.hpp"
+#include "utils/config_manager.hpp"
+#include "utils/logger.hpp"
+#include "utils/threading.hpp"
+#include "utils/timing.hpp"
+
+namespace {
+
+ControllerState makeXInputState(int userId) {
+    ControllerState state{};
+    state.userId = userId;
+    state.isConnected = true;
+    state.xinputState.dwPacketNumber = 1;
+    state.xinputState.Gamepad.sThumbLX = 12000;
+    state.xinputState.Gamepad.sThumbLY = -8000;
+    state.xinputState.Gamepad.sThumbRX = 3000;
+    state.xinputState.Gamepad.bRightTrigger = 200;
+    return state;
+}
+
+// DS4 by product name: mapped through the device profile
+ControllerState makeProfileHidState() {
+    ControllerState state{};
+    state.userId = -1;
+    state.isConnected = true;
+    state.devicePath = L"\\\\?\\hid#vid_054c&pid_09cc#bench";
+    state.productName = L"Wireless Controller";
+    state.m_activeButtons = {2, 5, 10};
+    state.m_hidValues = {{0x30, 200}, {0x31, 40}, {0x32, 128}, {0x35, 90}};
+    return state;
+}
+
+// Unknown gamepad: generic mapping with value-cap range lookups
+ControllerState makeGenericHidState() {
+    ControllerState state{};
+    state.userId = -1;
+    state.isConnected = true;
+    state.devicePath = L"\\\\?\\hid#vid_1234&pid_5678#bench";
+    state.productName = L"Generic USB Joystick";
+    state.m_activeButtons = {1, 3};
+    const USAGE usages[] = {0x30, 0x31, 0x32, 0x35};
+    for (USAGE usage : usages) {
+        HIDP_VALUE_CAPS cap{};
+        cap.UsagePage = 0x01;
+        cap.Range.UsageMin = usage;
+        cap.LogicalMin = 0;
+        cap.LogicalMax = 1023;
+        state.valueCaps.push_back(cap);
+        state.m_hidValues[usage] = 700;
+    }
+    return state;
+}
+
+// Mix for the N-controller runs: even slots XInput, odd slots alternate profile and generic HID
+std::vector<ControllerState> makeControllers(size_t count) {
+    std::vector<ControllerState> states;
+    for (size_t i = 0; i < count; ++i) {
+        if (i % 2 == 0) {
+            states.push_back(makeXInputState(static_cast<int>(i)));
+        } else if (i % 4 == 1) {
+            states.push_back(makeProfileHidState());
+        } else {
+            states.push_back(makeGenericHidState());
+        }
+    }
+    return states;
+}
+
+// Translation layer with every optional stage off
+void disableStages(TranslationLayer& layer) {
+    layer.setSOCDCleaningEnabled(false);
+    layer.setDebouncingEnabled(false);
+    layer.setStickDeadzoneEnabled(false);
+}
+
+void addTranslate(BenchmarkRunner& runner, const std::string& name, std::vector<ControllerState> inputs,
+                  void (*configure)(TranslationLayer&), void (*mutate)(std::vector<ControllerState>&, uint64_t)) {
+    runner.add(name, [inputs, configure, mutate](uint64_t iterations) mutable {
+        TranslationLayer layer;
+        configure(layer);
+        for (uint64_t i = 0; i < iterations; ++i) {
+            if (mutate) mutate(inputs, i);
+            auto translated = layer.translate(inputs);
+            doNotOptimize(translated);
+        }
+    });
+}
+
+// Fixed integer work with no memory traffic; its ratio between two machines scales the baseline
+const char* const CALIBRATION_BENCHMARK = "calibration/integer_loop";
+
+void registerCalibration(BenchmarkRunner& runner) {
+    runner.add(CALIBRATION_BENCHMARK, [](uint64_t iterations) {
+        uint64_t x = 1;
+        for (uint64_t i = 0; i < iterations; ++i) {
+            for (int step = 0; step < 64; ++step) {
+                x = x * 6364136223846793005ull + 1442695040888963407ull;
+            }
+            doNotOptimize(x);
+        }
+    });
+}
+
+void registerDecode(BenchmarkRunner& runner) {
+    // Motion block of a DS4 USB input report (0x054C:0x09CC, report ID 0x01)
+    runner.add("hid_decode/ds4_motion", [](uint64_t iterations) {
+        MotionReportPlan plan = MotionReportPlan::forDevice(0x054C, 0x09CC);
+        uint8_t report[64] = {};
+        report[0] = 0x01;
+        for (size_t b = 1; b < sizeof(report); ++b) report[b] = static_cast<uint8_t>(b * 7);
+        MotionState motion{};
+        for (uint64_t i = 0; i < iterations; ++i) {
+            report[13] = static_cast<uint8_t>(i);
+            extractMotion(plan, report, sizeof(report), motion);
+            doNotOptimize(motion);
+        }
+    });
+
+    // Decoded usages scattered into two split outputs
+    runner.add("hid_decode/split_2_outputs", [](uint64_t iterations) {
+        SplitDeviceConfig config;
+        config.sourceMatch = L"Arcade Stick";
+        SplitOutputConfig p1{"P1", {{1, XINPUT_GAMEPAD_A}, {2, XINPUT_GAMEPAD_B}}, {{0x30, SplitField::LX}, {0x31, SplitField::LY}}};
+        SplitOutputConfig p2{"P2", {{9, XINPUT_GAMEPAD_A}, {10, XINPUT_GAMEPAD_B}}, {{0x32, SplitField::LX}, {0x35, SplitField::LY}}};
+        config.outputs = {p1, p2};
+        DeviceSplitter splitter;
+        splitter.configure({config});
+
+        ControllerState state = makeGenericHidState();
+        state.productName = L"Arcade Stick";
+        state.m_activeButtons = {1, 10};
+        DeviceSplitter::Binding binding = splitter.bind(splitter.findDevice(state), state);
+        std::array<SplitGamepad, DeviceSplitter::MAX_OUTPUTS> outputs;
+        for (uint64_t i = 0; i < iterations; ++i) {
+            splitter.split(binding, state, outputs);
+            doNotOptimize(outputs);
+        }
+    });
+}
+
+void registerConversion(BenchmarkRunner& runner) {
+    addTranslate(runner, "convert/xinput", {makeXInputState(0)}, disableStages, nullptr);
+    addTranslate(runner, "convert/hid_profile", {makeProfileHidState()}, disableStages, nullptr);
+    addTranslate(runner, "convert/hid_generic", {makeGenericHidState()}, disableStages, nullptr);
+}
+
+void registerStages(BenchmarkRunner& runner) {
+    // Each stage alone on one XInput pad; compare with convert/xinput for the stage cost
+    addTranslate(runner, "stage/socd", {makeXInputState(0)},
+        [](TranslationLayer& layer) {
+            disableStages(layer);
+            layer.setSOCDCleaningEnabled(true);
+            layer.setSOCDMethod(2);
+        },
+        [](std::vector<ControllerState>& inputs, uint64_t i) {
+            inputs[0].xinputState.Gamepad.wButtons = (i & 1)
+                ? (XINPUT_GAMEPAD_DPAD_LEFT | XINPUT_GAMEPAD_DPAD_RIGHT) : XINPUT_GAMEPAD_DPAD_UP;
+        });
+
+    addTranslate(runner, "stage/debounce", {makeXInputState(0)},
+        [](TranslationLayer& layer) {
+            disableStages(layer);
+            layer.setDebouncingEnabled(true);
+            layer.setDebounceIntervalMs(5);
+        },
+        [](std::vector<ControllerState>& inputs, uint64_t i) {
+            inputs[0].xinputState.Gamepad.wButtons = (i & 1) ? XINPUT_GAMEPAD_A : 0;
+        });
+
+    addTranslate(runner, "stage/deadzone", {makeXInputState(0)},
+        [](TranslationLayer& layer) {
+            disableStages(layer);
+            layer.setStickDeadzoneEnabled(true);
+            layer.setLeftStickDeadzone(0.15f);
+            layer.setRightStickDeadzone(0.15f);
+            layer.setLeftStickAntiDeadzone(0.05f);
+        },
+        [](std::vector<ControllerState>& inputs, uint64_t i) {
+            inputs[0].xinputState.Gamepad.sThumbLX = static_cast<SHORT>((i * 977) & 0x7FFF);
+        });
+}
+
+void registerEncoding(BenchmarkRunner& runner) {
+    TranslationLayer source;
+    std::vector<TranslatedState> translated = source.translate({makeXInputState(0)});
+    TranslatedState state = translated.front();
+
+    runner.add("encode/xinput", [state](uint64_t iterations) mutable {
+        TranslationLayer layer;
+        for (uint64_t i = 0; i < iterations; ++i) {
+            state.gamepad.sThumbLX = static_cast<SHORT>(i);
+            XINPUT_STATE encoded = layer.translateToXInput(state);
+            doNotOptimize(encoded);
+        }
+    });
+
+    runner.add("encode/ds4", [state](uint64_t iterations) mutable {
+        TranslationLayer layer;
+        for (uint64_t i = 0; i < iterations; ++i) {
+            state.gamepad.sThumbLX = static_cast<SHORT>(i);
+            TranslationLayer::DInputState encoded = layer.translateToDInput(state);
+            doNotOptimize(encoded);
+        }
+    });
+}
+
+void registerTranslate(BenchmarkRunner& runner) {
+    // Default configuration (SOCD on), as the proxy runs out of the box
+    for (size_t count : {1, 4, 16, 64, 256}) {
+        addTranslate(runner, "translate/" + std::to_string(count) + "_controllers", makeControllers(count),
+            [](TranslationLayer&) {},
+            [](std::vector<ControllerState>& inputs, uint64_t i) {
+                inputs[0].xinputState.Gamepad.sThumbLX = static_cast<SHORT>(i);
+            });
+    }
+
+    // Same frames on a 3-worker work-stealing pool (scaling needs as many free cores)
+    for (size_t count : {16, 64, 256}) {
+        addTranslate(runner, "translate_parallel/" + std::to_string(count) + "_controllers", makeControllers(count),
+            [](TranslationLayer& layer) { layer.setParallelTranslation(3, 1); },
+            [](std::vector<ControllerState>& inputs, uint64_t i) {
+                inputs[0].xinputState.Gamepad.sThumbLX = static_cast<SHORT>(i);
+            });
+    }
+}
+
+void registerConfig(BenchmarkRunner& runner) {
+    ConfigManager& config = ConfigManager::getInstance();
+    config.setInt("bench_int", 1000);
+    config.setBool("bench_bool", true);
+    config.setFloat("bench_float", 0.25f);
+    config.setString("bench_string", "xinput");
+
+    runner.add("config/get_int", [&config](uint64_t iterations) {
+        for (uint64_t i = 0; i < iterations; ++i) doNotOptimize(config.getInt("bench_int", 0));
+    });
+    runner.add("config/get_bool", [&config](uint64_t iterations) {
+        for (uint64_t i = 0; i < iterations; ++i) doNotOptimize(config.getBool("bench_bool", false));
+    });
+    runner.add("config/get_float", [&config](uint64_t iterations) {
+        for (uint64_t i = 0; i < iterations; ++i) doNotOptimize(config.getFloat("bench_float", 0.0f));
+    });
+    runner.add("config/get_string", [&config](uint64_t iterations) {
+        for (uint64_t i = 0; i < iterations; ++i) doNotOptimize(config.getString("bench_string", ""));
+    });
+    runner.add("config/get_missing", [&config](uint64_t iterations) {
+        for (uint64_t i = 0; i < iterations; ++i) doNotOptimize(config.getInt("bench_missing", 7));
+    });
+}
+
+void registerLogger(BenchmarkRunner& runner) {
+    // Console output goes to a null stream so only the logger's own cost is measured
+    runner.add("logger/log", [](uint64_t iterations) {
+        std::ostringstream sink;
+        std::streambuf* previous = std::cout.rdbuf(sink.rdbuf());
+        for (uint64_t i = 0; i < iterations; ++i) {
+            Logger::log("InputCapture: Device 3 report rate changed");
+            if ((i & 1023) == 1023) {
+                Logger::clear();
+                sink.str(std::string());
+            }
+        }
+        std::cout.rdbuf(previous);
+        Logger::clear();
+    });
+    runner.add("logger/error", [](uint64_t iterations) {
+        std::ostringstream sink;
+        std::streambuf* previous = std::cerr.rdbuf(sink.rdbuf());
+        for (uint64_t i = 0; i < iterations; ++i) {
+            Logger::error("VirtualDeviceEmulator: X360 update failed");
+            if ((i & 1023) == 1023) {
+                Logger::clear();
+                sink.str(std::string());
+            }
+        }
+        std::cerr.rdbuf(previous);
+        Logger::clear();
+    });
+}
+
+struct CommandLine {
+    BenchmarkRunner::Options options;
+    std::string outPath;
+    std::string baselinePath;        // Compare against this baseline, exit 1 on regression
+    std::string writeBaselinePath;   // Write results as a baseline, keeping existing tolerances
+    double tolerancePct = 25.0;      // For benchmarks without their own tolerance
+    int pinCpu = -1;                 // -1 = no pinning, -2 = last core
+    bool list = false;
+};
+
+const char* const USAGE_TEXT =
+    "Usage: xidp_bench [--filter=<substring>] [--min-time-ms=<ms>] [--repetitions=<n>]\n"
+    "                  [--out=<file>] [--list] [--pin-cpu=<core>|auto]\n"
+    "                  [--baseline=<file>] [--tolerance=<percent>] [--write-baseline=<file>]\n";
+
+bool parseArgs(int argc, char** argv, CommandLine& cmd) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&arg](const char* prefix) -> const char* {
+            size_t length = std::strlen(prefix);
+            return arg.compare(0, length, prefix) == 0 ? arg.c_str() + length : nullptr;
+        };
+        if (const char* v = value("--filter=")) {
+            cmd.options.filter = v;
+        } else if (const char* v = value("--min-time-ms=")) {
+            cmd.options.minTimeMs = std::atof(v);
+        } else if (const char* v = value("--repetitions=")) {
+            cmd.options.repetitions = std::atoi(v);
+        } else if (const char* v = value("--out=")) {
+            cmd.outPath = v;
+        } else if (const char* v = value("--baseline=")) {
+            cmd.baselinePath = v;
+        } else if (const char* v = value("--write-baseline=")) {
+            cmd.writeBaselinePath = v;
+        } else if (const char* v = value("--tolerance=")) {
+            cmd.tolerancePct = std::atof(v);
+        } else if (const char* v = value("--pin-cpu=")) {
+            cmd.pinCpu = (std::strcmp(v, "auto") == 0) ? -2 : std::atoi(v);
+        } else if (arg == "--list") {
+            cmd.list = true;
+        } else {
+            std::cerr << "Unknown argument: " << arg << "\n" << USAGE_TEXT;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool writeResults(const std::string& path, const std::vector<BenchmarkResult>& results,
+                  const BenchmarkRunner::Options& options, const Baseline* tolerances, double tolerancePct) {
+    std::ofstream out(path);
+    if (!out) {
+        std::cerr << "Cannot write " << path << "\n";
+        return false;
+    }
+    BenchmarkRunner::writeJson(out, results, options, tolerances, tolerancePct);
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    CommandLine cmd;
+    if (!parseArgs(argc, argv, cmd)) {
+        return 2;
+    }
+
+    TimingUtils::initialize();
+
+    BenchmarkRunner runner;
+    registerCalibration(runner);
+    registerDecode(runner);
+    registerConversion(runner);
+    registerStages(runner);
+    registerEncoding(runner);
+    registerTranslate(runner);
+    registerConfig(runner);
+    registerLogger(runner);
+
+    if (cmd.list) {
+        for (const auto& name : runner.names()) {
+            std::cout << name << "\n";
+        }
+        return 0;
+    }
+
+    Baseline baseline;
+    if (!cmd.baselinePath.empty()) {
+        if (!baseline.load(cmd.baselinePath)) {
+            std::cerr << "Cannot read baseline " << cmd.baselinePath << "\n";
+            return 2;
+        }
+        // Debug and release timings are not comparable; refuse rather than report noise
+        if (baseline.buildType != BenchmarkRunner::buildType()) {
+            std::cerr << "Baseline is a " << baseline.buildType << " build, this is a "
+                      << BenchmarkRunner::buildType() << " build; rebuild with the matching build type\n";
+            return 2;
+        }
+    }
+
+    // One core, best-effort high priority: keeps migrations and preemption out of the medians
+    if (cmd.pinCpu != -1) {
+        int core = cmd.pinCpu == -2 ? ThreadingUtils::getLogicalCoreCount() - 1 : cmd.pinCpu;
+        if (!ThreadingUtils::setCurrentThreadAffinity(core)) {
+            std::cerr << "Warning: could not pin to CPU " << core << "\n";
+        }
+        ThreadingUtils::setCurrentThreadToHighPriority();
+    }
+
+    std::vector<BenchmarkResult> results;
+    bool calibrated = false;
+    if (!cmd.options.filter.empty() && !cmd.baselinePath.empty()) {
+        // A filtered comparison still needs the calibration to scale the baseline
+        BenchmarkRunner::Options calibration = cmd.options;
+        calibration.filter = CALIBRATION_BENCHMARK;
+        results = runner.run(calibration);
+        calibrated = true;
+    }
+    for (const auto& result : runner.run(cmd.options)) {
+        if (!calibrated || result.name != CALIBRATION_BENCHMARK) {
+            results.push_back(result);
+        }
+    }
+    for (const auto& result : results) {
+        std::cerr << result.name << ": " << result.medianNs << " ns/op\n";
+    }
+
+    if (!cmd.outPath.empty() && !writeResults(cmd.outPath, results, cmd.options, nullptr, 0.0)) {
+        return 1;
+    }
+    if (!cmd.writeBaselinePath.empty()) {
+        Baseline existing;
+        existing.load(cmd.writeBaselinePath);
+        if (!writeResults(cmd.writeBaselinePath, results, cmd.options, &existing, cmd.tolerancePct)) {
+            return 1;
+        }
+        std::cerr << "Baseline written to " << cmd.writeBaselinePath << "\n";
+    }
+    if (cmd.outPath.empty() && cmd.writeBaselinePath.empty() && cmd.baselinePath.empty()) {
+        BenchmarkRunner::writeJson(std::cout, results, cmd.options);
+    }
+
+    if (!cmd.baselinePath.empty()) {
+        int regressions = BenchmarkRunner::compare(results, baseline, cmd.tolerancePct, CALIBRATION_BENCHMARK, std::cout);
+        if (regressions > 0) {
+            std::cout << regressions << " benchmark(s) regressed against " << cmd.baselinePath << "\n";
+            return 1;
+        }
+        std::cout << "No regressions against " << cmd.baselinePath << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,188 @@
+/**
+ * @file xidp_drift.cpp
+ * @brief Offline stick drift analysis of recordings, with deadzone recommendations
+ *
+ * Usage: xidp_drift [--workers=<n>] [--rest-window=<n>] [--margin=<f>] [--game-deadzone=<f>]
+ *                   [--synthesize=<minutes> [--pads=<n>]] <recording>...
+ *
+ * Prints, per device, the resting center distribution, noise radius, gate
+ * shape and report intervals of each stick, the recommended deadzone,
+ * anti-deadzone and calibration, and config.ini values covering all devices.
+ * .xrec containers are memory-mapped and their chunks scanned in parallel.
+ *
+ * With --synthesize, first streams a 1 kHz session of --pads drifting XInput
+ * pads (known center offsets and noise, a full gate sweep every 30 s, round
+ * gates on even pads and square gates on odd ones) into the one .xrec file
+ * given, then analyzes it. The game's own deadzone cannot be seen in a
+ * recording; pass it as --game-deadzone to get a matching anti-deadzone.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "core/drift_analyzer.hpp"
+
+namespace {
+
+struct CommandLine {
+    DriftAnalyzer::Options options;
+    uint32_t synthesizeMinutes = 0;
+    size_t pads = 4;
+    std::vector<std::string> files;
+};
+
+const char* const USAGE_TEXT =
+    "Usage: xidp_drift [--workers=<n>] [--rest-window=<n>] [--margin=<f>] [--game-deadzone=<f>]\n"
+    "                  [--synthesize=<minutes> [--pads=<n>]] <recording>...\n";
+
+bool parseArgs(int argc, char** argv, CommandLine& cmd) {
+    cmd.options.workers = std::max(1u, std::thread::hardware_concurrency()) - 1;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&arg](const char* prefix) -> const char* {
+            size_t length = std::strlen(prefix);
+            return arg.compare(0, length, prefix) == 0 ? arg.c_str() + length : nullptr;
+        };
+        if (const char* v = value("--workers=")) {
+            cmd.options.workers = static_cast<size_t>(std::max(0, std::atoi(v)));
+        } else if (const char* v = value("--rest-window=")) {
+            cmd.options.restWindow = std::max(1, std::atoi(v));
+        } else if (const char* v = value("--margin=")) {
+            cmd.options.margin = std::max(1.0, std::atof(v));
+        } else if (const char* v = value("--game-deadzone=")) {
+            cmd.options.gameDeadzone = static_cast<float>(std::clamp(std::atof(v), 0.0, 0.9));
+        } else if (const char* v = value("--synthesize=")) {
+            cmd.synthesizeMinutes = static_cast<uint32_t>(std::max(1, std::atoi(v)));
+        } else if (const char* v = value("--pads=")) {
+            cmd.pads = static_cast<size_t>(std::max(1, std::atoi(v)));
+        } else if (arg.compare(0, 2, "--") == 0) {
+            std::cerr << "Unknown argument: " << arg << "\n" << USAGE_TEXT;
+            return false;
+        } else {
+            cmd.files.push_back(arg);
+        }
+    }
+    if (cmd.files.empty() || (cmd.synthesizeMinutes > 0 && cmd.files.size() != 1)) {
+        std::cerr << USAGE_TEXT;
+        return false;
+    }
+    return true;
+}
+
+SHORT toAxis(double value) {
+    return static_cast<SHORT>(std::lround(std::clamp(value, -32768.0, 32767.0)));
+}
+
+// Streamed frame by frame, so an hour of four pads never sits in memory
+bool synthesize(const std::string& path, uint32_t minutes, size_t pads) {
+    SessionRecording session;
+    for (size_t pad = 0; pad < pads; ++pad) {
+        SessionRecording::Device device;
+        device.kind = SessionRecording::SourceKind::XINPUT;
+        device.userId = static_cast<int>(pad);
+        session.devices.push_back(device);
+    }
+    std::ofstream out(path, std::ios::binary);
+    if (!out) {
+        std::cerr << path << ": cannot create\n";
+        return false;
+    }
+    RecordingWriter writer(out, session);
+
+    std::mt19937 rng(4242);
+    std::uniform_int_distribution<int> offset(-2500, 2500);
+    std::uniform_int_distribution<int> jitter(0, 30);
+    struct Drift {
+        int centers[4];
+        int noise;
+    };
+    std::vector<Drift> drift(pads);
+    for (size_t pad = 0; pad < pads; ++pad) {
+        for (int& center : drift[pad].centers) center = offset(rng);
+        drift[pad].noise = 60 + 40 * static_cast<int>(pad);
+        std::cout << "pad " << pad << ": left center (" << drift[pad].centers[0] << ", " << drift[pad].centers[1]
+                  << "), right center (" << drift[pad].centers[2] << ", " << drift[pad].centers[3]
+                  << "), noise +-" << drift[pad].noise << ", " << (pad % 2 ? "square" : "round") << " gates\n";
+    }
+
+    const uint32_t sweepEvery = 30000;
+    const uint32_t sweepFrames = 1000;
+    const uint64_t frames = static_cast<uint64_t>(minutes) * 60000;
+    std::vector<SessionRecording::Sample> state(pads);
+    SessionRecording::Frame frame;
+    for (uint64_t f = 0; f < frames; ++f) {
+        frame.timeUs = f * 1000 + static_cast<uint64_t>(jitter(rng));
+        frame.samples.clear();
+        const uint32_t phase = static_cast<uint32_t>(f % sweepEvery);
+        for (size_t pad = 0; pad < pads; ++pad) {
+            SessionRecording::Sample& sample = state[pad];
+            sample.device = pad;
+            sample.packetNumber++;
+            XINPUT_GAMEPAD& g = sample.gamepad;
+            const Drift& d = drift[pad];
+            if (phase < sweepFrames) {
+                const double angle = 2.0 * 3.14159265358979 * phase / sweepFrames;
+                const double radius = pad % 2 ? 46000.0 : 32500.0;
+                g.sThumbLX = toAxis(radius * std::cos(angle));
+                g.sThumbLY = toAxis(radius * std::sin(angle));
+                g.sThumbRX = toAxis(-radius * std::sin(angle));
+                g.sThumbRY = toAxis(radius * std::cos(angle));
+            } else {
+                std::uniform_int_distribution<int> noise(-d.noise, d.noise);
+                g.sThumbLX = toAxis(d.centers[0] + noise(rng));
+                g.sThumbLY = toAxis(d.centers[1] + noise(rng));
+                g.sThumbRX = toAxis(d.centers[2] + noise(rng));
+                g.sThumbRY = toAxis(d.centers[3] + noise(rng));
+            }
+            frame.samples.push_back(sample);
+        }
+        if (!writer.append(frame)) {
+            std::cerr << path << ": write failed\n";
+            return false;
+        }
+    }
+    return writer.finish();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    CommandLine cmd;
+    if (!parseArgs(argc, argv, cmd)) {
+        return 2;
+    }
+    if (cmd.synthesizeMinutes > 0) {
+        auto start = std::chrono::steady_clock::now();
+        if (!synthesize(cmd.files.front(), cmd.synthesizeMinutes, cmd.pads)) {
+            return 2;
+        }
+        std::cout << "wrote " << cmd.synthesizeMinutes << " min of " << cmd.pads << " pads to " << cmd.files.front()
+                  << " in " << std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count()
+                  << " s\n\n";
+    }
+
+    DriftAnalyzer analyzer(cmd.options);
+    for (const auto& file : cmd.files) {
+        DriftAnalyzer::Result result;
+        std::string error;
+        auto start = std::chrono::steady_clock::now();
+        if (!analyzer.analyzeFile(file, result, &error)) {
+            std::cerr << file << ": " << error << "\n";
+            return 1;
+        }
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "== " << file << " (" << seconds * 1000.0 << " ms including open, "
+                  << cmd.options.workers + 1 << " threads)\n";
+        DriftAnalyzer::writeReport(result, std::cout);
+        std::cout << "\n";
+    }
+    return 0;
+}
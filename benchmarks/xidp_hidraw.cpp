@@ -0,0 +1,220 @@
+/**
+ * @file xidp_hidraw.cpp
+ * @brief Linux latency of the hidraw backend, from report sent to report decoded,
+ *        and of the whole hidraw -> Pipeline -> uinput stack
+ *
+ * Usage: xidp_hidraw [--reports=<n>] [--devices=<n>] [--report-rate-hz=<hz>]
+ *                    [--loop-hz=<hz>] [--stream]
+ *
+ * Emulates generic 10-bit joysticks with VirtualHidDevice (/dev/uhid when it
+ * can be opened, else the socket pair stand-in; --stream forces the latter),
+ * sends one report per report period round-robin across the devices, and
+ * times each from the write to the moment HidrawInputSource read it. Three
+ * ways of reading:
+ * - epoll:  capture thread blocked in epoll_wait(), woken by the report
+ * - frame:  a pipeline-style loop calling update() at --loop-hz
+ * - stack:  epoll capture feeding a Pipeline at --loop-hz whose bus is a
+ *           UinputBus (/dev/uinput when available, else in memory); timed
+ *           to the bus write of the translated frame
+ * Exit code 1 if a report was not read (or written) within a second.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "core/hidraw_source.hpp"
+#include "core/latency_rig.hpp"
+#include "core/pipeline.hpp"
+#include "core/uinput_bus.hpp"
+#include "core/virtual_hid_device.hpp"
+#include "utils/config_manager.hpp"
+#include "../tests/hid_descriptors.hpp"
+
+namespace {
+
+struct CommandLine {
+    uint32_t reports = 2000;
+    size_t devices = 1;
+    uint32_t reportRateHz = 1000;
+    uint32_t loopHz = 1000;
+    bool allowUhid = true;
+};
+
+const char* const USAGE_TEXT =
+    "Usage: xidp_hidraw [--reports=<n>] [--devices=<n>] [--report-rate-hz=<hz>]\n"
+    "                   [--loop-hz=<hz>] [--stream]\n";
+
+bool parseArgs(int argc, char** argv, CommandLine& cmd) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&arg](const char* prefix) -> const char* {
+            size_t length = std::strlen(prefix);
+            return arg.compare(0, length, prefix) == 0 ? arg.c_str() + length : nullptr;
+        };
+        if (const char* v = value("--reports=")) {
+            cmd.reports = static_cast<uint32_t>(std::max(1, std::atoi(v)));
+        } else if (const char* v = value("--devices=")) {
+            cmd.devices = static_cast<size_t>(std::max(1, std::atoi(v)));
+        } else if (const char* v = value("--report-rate-hz=")) {
+            cmd.reportRateHz = static_cast<uint32_t>(std::max(1, std::atoi(v)));
+        } else if (const char* v = value("--loop-hz=")) {
+            cmd.loopHz = static_cast<uint32_t>(std::max(1, std::atoi(v)));
+        } else if (arg == "--stream") {
+            cmd.allowUhid = false;
+        } else {
+            std::cerr << "Unknown argument: " << arg << "\n" << USAGE_TEXT;
+            return false;
+        }
+    }
+    return true;
+}
+
+struct RunResult {
+    const char* mode = "";
+    const char* backend = "";
+    const char* output = "-";
+    LatencyRig::Result latency;
+};
+
+enum class Mode {
+    EPOLL,
+    FRAME,
+    STACK
+};
+
+RunResult run(const CommandLine& cmd, Mode mode) {
+    static const VirtualHidDevice::Spec spec = {"Generic USB Joystick", 0x0079, 0x0006,
+                                                hid_fixtures::GENERIC_DESCRIPTOR};
+    auto ownedSource = std::make_unique<HidrawInputSource>();
+    HidrawInputSource& source = *ownedSource;
+    std::vector<std::unique_ptr<VirtualHidDevice>> devices;
+    for (size_t i = 0; i < cmd.devices; ++i) {
+        auto device = std::make_unique<VirtualHidDevice>();
+        if (!device->create(spec, cmd.allowUhid) || !device->attach(source)) {
+            std::cerr << "Could not create virtual device " << i << "\n";
+            std::exit(2);
+        }
+        devices.push_back(std::move(device));
+    }
+
+    RunResult result;
+    result.mode = mode == Mode::EPOLL ? "epoll" : mode == Mode::FRAME ? "frame" : "stack";
+    result.backend = devices[0]->getBackend() == VirtualHidDevice::Backend::UHID ? "uhid" : "stream";
+
+    // Stack mode: the proxy's loop end to end. HID sources have no XInput slot,
+    // so every device lands on target -1 and only that target's writes are timed.
+    std::unique_ptr<Pipeline> pipeline;
+    UinputBus* bus = nullptr;
+    if (mode == Mode::STACK) {
+        ConfigManager config;
+        config.setInt("polling_frequency", static_cast<int>(cmd.loopHz));
+        config.setBool("stick_deadzone_enabled", false);
+        std::unique_ptr<UinputBus> uinput = UinputBus::create();
+        bus = uinput.get();
+        result.output = bus->getMode() == UinputBus::Mode::UINPUT ? "uinput" : "memory";
+        pipeline = std::make_unique<Pipeline>(0, config.createView(), std::move(ownedSource), std::move(uinput));
+    }
+
+    // Frame mode: the loop a Pipeline runs, reading only in update()
+    std::atomic<bool> looping(mode == Mode::FRAME);
+    std::thread loop;
+    if (mode == Mode::FRAME) {
+        loop = std::thread([&]() {
+            const auto period = std::chrono::microseconds(1000000 / cmd.loopHz);
+            auto next = std::chrono::steady_clock::now();
+            while (looping) {
+                source.update(0.0);
+                next += period;
+                std::this_thread::sleep_until(next);
+            }
+        });
+    } else {
+        source.start();
+        if (pipeline) pipeline->start();
+    }
+    if (bus) {
+        // The first frame creates the target with the devices' idle state; don't time it
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+        while (bus->getStats(-1).writes == 0 && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    auto arrived = [&](size_t index) {
+        return bus ? bus->getStats(-1).writes : source.getReportCount(index);
+    };
+    auto arrivedUs = [&](size_t index) {
+        return bus ? bus->getStats(-1).lastWriteUs : source.lastReportUs(index);
+    };
+
+    const auto period = std::chrono::microseconds(1000000 / cmd.reportRateHz);
+    auto next = std::chrono::steady_clock::now();
+    std::vector<double> latencies;
+    latencies.reserve(cmd.reports);
+    result.latency.edges = cmd.reports;
+    for (uint32_t i = 0; i < cmd.reports; ++i) {
+        size_t index = i % cmd.devices;
+        uint64_t expected = arrived(index) + 1;
+        std::vector<uint8_t> report = hid_fixtures::genericReport(static_cast<uint16_t>(i % 1024), 512, 0);
+        uint64_t sentUs = HidrawInputSource::nowUs();
+        devices[index]->sendReport(report.data(), report.size());
+
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+        while (arrived(index) < expected && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::yield();
+        }
+        if (arrived(index) >= expected) {
+            uint64_t readUs = arrivedUs(index);
+            latencies.push_back(readUs > sentUs ? static_cast<double>(readUs - sentUs) : 0.0);
+            result.latency.delivered++;
+        }
+        next += period;
+        std::this_thread::sleep_until(next);
+    }
+
+    looping = false;
+    if (loop.joinable()) loop.join();
+    if (pipeline) pipeline->stop();
+    source.stop();
+    LatencyRig::summarize(latencies, result.latency);
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    CommandLine cmd;
+    if (!parseArgs(argc, argv, cmd)) {
+        return 2;
+    }
+
+    std::cout << cmd.devices << " virtual joystick(s), " << cmd.reports << " reports at " << cmd.reportRateHz
+              << " Hz, frame loop " << cmd.loopHz << " Hz\n";
+    std::cout << std::left << std::setw(8) << "mode" << std::setw(8) << "device" << std::setw(8) << "output"
+              << std::right
+              << std::setw(9) << "reports" << std::setw(7) << "lost" << std::setw(10) << "mean us"
+              << std::setw(10) << "p50 us" << std::setw(10) << "p90 us" << std::setw(10) << "p99 us"
+              << std::setw(10) << "max us" << "\n";
+
+    bool lost = false;
+    for (Mode mode : {Mode::EPOLL, Mode::FRAME, Mode::STACK}) {
+        RunResult r = run(cmd, mode);
+        lost = lost || r.latency.delivered < r.latency.edges;
+        std::cout << std::left << std::setw(8) << r.mode << std::setw(8) << r.backend << std::setw(8) << r.output
+                  << std::right
+                  << std::setw(9) << r.latency.edges << std::setw(7) << (r.latency.edges - r.latency.delivered)
+                  << std::fixed << std::setprecision(1)
+                  << std::setw(10) << r.latency.meanUs << std::setw(10) << r.latency.p50Us
+                  << std::setw(10) << r.latency.p90Us << std::setw(10) << r.latency.p99Us
+                  << std::setw(10) << r.latency.maxUs << std::endl;
+    }
+    return lost ? 1 : 0;
+}
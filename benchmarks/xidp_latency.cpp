@@ -0,0 +1,167 @@
+/**
+ * @file xidp_latency.cpp
+ * @brief End-to-end edge latency across pacing, threading and controller counts
+ *
+ * Usage: xidp_latency [--duration-ms=<ms>] [--controllers=<n>[,<n>...]]
+ *                     [--pacing=fixed|spin|phase] [--threading=inline|inject]
+ *                     [--report-rate-hz=<hz>] [--loop-hz=<hz>] [--shaping] [--out=<file>]
+ *
+ * Runs every combination of the selected pacings, threading modes and
+ * controller counts through LatencyRig, prints a table and optionally writes
+ * the distributions as JSON. Exit code 1 if any scenario lost edges.
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "core/latency_rig.hpp"
+
+namespace {
+
+struct CommandLine {
+    uint32_t durationMs = 1000;
+    uint32_t reportRateHz = 1000;
+    uint32_t loopHz = 1000;
+    bool shaping = false;
+    std::vector<size_t> controllers = {1, 4, 16};
+    std::vector<LatencyRig::Pacing> pacings = {
+        LatencyRig::Pacing::FIXED, LatencyRig::Pacing::SPIN, LatencyRig::Pacing::PHASE_ALIGNED};
+    std::vector<LatencyRig::Threading> threadings = {
+        LatencyRig::Threading::INLINE, LatencyRig::Threading::INJECT_THREAD};
+    std::string outPath;
+};
+
+const char* const USAGE_TEXT =
+    "Usage: xidp_latency [--duration-ms=<ms>] [--controllers=<n>[,<n>...]]\n"
+    "                    [--pacing=fixed|spin|phase] [--threading=inline|inject]\n"
+    "                    [--report-rate-hz=<hz>] [--loop-hz=<hz>] [--shaping] [--out=<file>]\n";
+
+bool parseArgs(int argc, char** argv, CommandLine& cmd) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&arg](const char* prefix) -> const char* {
+            size_t length = std::strlen(prefix);
+            return arg.compare(0, length, prefix) == 0 ? arg.c_str() + length : nullptr;
+        };
+        if (const char* v = value("--duration-ms=")) {
+            cmd.durationMs = static_cast<uint32_t>(std::atoi(v));
+        } else if (const char* v = value("--report-rate-hz=")) {
+            cmd.reportRateHz = static_cast<uint32_t>(std::atoi(v));
+        } else if (const char* v = value("--loop-hz=")) {
+            cmd.loopHz = static_cast<uint32_t>(std::atoi(v));
+        } else if (const char* v = value("--controllers=")) {
+            cmd.controllers.clear();
+            std::stringstream list(v);
+            std::string item;
+            while (std::getline(list, item, ',')) {
+                int count = std::atoi(item.c_str());
+                if (count > 0) cmd.controllers.push_back(static_cast<size_t>(count));
+            }
+        } else if (const char* v = value("--pacing=")) {
+            std::string name = v;
+            if (name == "fixed") cmd.pacings = {LatencyRig::Pacing::FIXED};
+            else if (name == "spin") cmd.pacings = {LatencyRig::Pacing::SPIN};
+            else if (name == "phase") cmd.pacings = {LatencyRig::Pacing::PHASE_ALIGNED};
+            else {
+                std::cerr << "Unknown pacing: " << name << "\n" << USAGE_TEXT;
+                return false;
+            }
+        } else if (const char* v = value("--threading=")) {
+            std::string name = v;
+            if (name == "inline") cmd.threadings = {LatencyRig::Threading::INLINE};
+            else if (name == "inject") cmd.threadings = {LatencyRig::Threading::INJECT_THREAD};
+            else {
+                std::cerr << "Unknown threading: " << name << "\n" << USAGE_TEXT;
+                return false;
+            }
+        } else if (const char* v = value("--out=")) {
+            cmd.outPath = v;
+        } else if (arg == "--shaping") {
+            cmd.shaping = true;
+        } else {
+            std::cerr << "Unknown argument: " << arg << "\n" << USAGE_TEXT;
+            return false;
+        }
+    }
+    if (cmd.controllers.empty()) {
+        std::cerr << "No controller counts given\n" << USAGE_TEXT;
+        return false;
+    }
+    return true;
+}
+
+void writeJson(std::ostream& out, const std::vector<LatencyRig::Result>& results) {
+    out << "{\n  \"context\": {\n"
+        << "    \"num_cpus\": " << std::thread::hardware_concurrency() << "\n"
+        << "  },\n  \"scenarios\": [";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const LatencyRig::Result& r = results[i];
+        out << (i ? ",\n" : "\n") << std::fixed << std::setprecision(1)
+            << "    {\"name\": \"" << LatencyRig::describe(r.scenario) << "\""
+            << ", \"pacing\": \"" << LatencyRig::pacingName(r.scenario.pacing) << "\""
+            << ", \"threading\": \"" << LatencyRig::threadingName(r.scenario.threading) << "\""
+            << ", \"controllers\": " << r.scenario.controllers
+            << ", \"edges\": " << r.edges << ", \"delivered\": " << r.delivered
+            << ", \"sequence_errors\": " << r.sequenceErrors
+            << ", \"mean_us\": " << r.meanUs << ", \"p50_us\": " << r.p50Us
+            << ", \"p90_us\": " << r.p90Us << ", \"p99_us\": " << r.p99Us
+            << ", \"max_us\": " << r.maxUs << ", \"loop_frames\": " << r.loopFrames << "}";
+    }
+    out << "\n  ]\n}\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    CommandLine cmd;
+    if (!parseArgs(argc, argv, cmd)) {
+        return 2;
+    }
+
+    std::cout << std::left << std::setw(40) << "scenario" << std::right
+              << std::setw(8) << "edges" << std::setw(8) << "lost" << std::setw(8) << "seqerr"
+              << std::setw(10) << "mean us" << std::setw(10) << "p50 us" << std::setw(10) << "p90 us"
+              << std::setw(10) << "p99 us" << std::setw(10) << "max us" << "\n";
+
+    std::vector<LatencyRig::Result> results;
+    bool lost = false;
+    for (LatencyRig::Pacing pacing : cmd.pacings) {
+        for (LatencyRig::Threading threading : cmd.threadings) {
+            for (size_t controllers : cmd.controllers) {
+                LatencyRig::Scenario scenario;
+                scenario.pacing = pacing;
+                scenario.threading = threading;
+                scenario.controllers = controllers;
+                scenario.loopHz = cmd.loopHz;
+                scenario.reportRateHz = cmd.reportRateHz;
+                scenario.durationMs = cmd.durationMs;
+                scenario.outputShaping = cmd.shaping;
+
+                LatencyRig::Result r = LatencyRig::run(scenario);
+                lost = lost || r.delivered < r.edges || r.sequenceErrors > 0;
+                std::cout << std::left << std::setw(40) << LatencyRig::describe(scenario) << std::right
+                          << std::setw(8) << r.edges << std::setw(8) << (r.edges - r.delivered)
+                          << std::setw(8) << r.sequenceErrors << std::fixed << std::setprecision(1)
+                          << std::setw(10) << r.meanUs << std::setw(10) << r.p50Us << std::setw(10) << r.p90Us
+                          << std::setw(10) << r.p99Us << std::setw(10) << r.maxUs << std::endl;
+                results.push_back(r);
+            }
+        }
+    }
+
+    if (!cmd.outPath.empty()) {
+        std::ofstream out(cmd.outPath);
+        if (!out) {
+            std::cerr << "Cannot write " << cmd.outPath << "\n";
+            return 1;
+        }
+        writeJson(out, results);
+    }
+    return lost ? 1 : 0;
+}
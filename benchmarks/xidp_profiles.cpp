@@ -0,0 +1,334 @@
+/**
+ * @file xidp_profiles.cpp
+ * @brief Device profile compiler, blob dump, SDL database import and startup/lookup benchmarks
+ *
+ * Usage: xidp_profiles compile <directory> [--out=<file>]
+ *        xidp_profiles dump <profiles.bin>
+ *        xidp_profiles import <gamecontrollerdb.txt> [--platform=<name>]
+ *        xidp_profiles bench [--profiles=<n>] [--lookups=<n>]
+ *        xidp_profiles bench-db [--entries=<n>] [--lookups=<n>]
+ *
+ * compile builds the built-in profiles, <directory>/gamecontrollerdb.txt and every
+ * *.profile of <directory> into one blob (default <directory>/profiles.bin, what
+ * the proxy maps at startup). dump prints the mappings of a blob. import times
+ * parsing and compiling an SDL database and reports what it kept. bench writes
+ * <n> synthetic profile sources to a scratch directory and times a cold start
+ * (parse and compile), a warm start (map and validate the blob) and the
+ * per-device lookups; bench-db does the same for a synthetic database of the
+ * size of the community one.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "core/controller_db.hpp"
+#include "core/profile_library.hpp"
+
+namespace {
+
+const char* const USAGE_TEXT =
+    "Usage: xidp_profiles compile <directory> [--out=<file>]\n"
+    "       xidp_profiles dump <profiles.bin>\n"
+    "       xidp_profiles import <gamecontrollerdb.txt> [--platform=<name>]\n"
+    "       xidp_profiles bench [--profiles=<n>] [--lookups=<n>]\n"
+    "       xidp_profiles bench-db [--entries=<n>] [--lookups=<n>]\n";
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+const char* targetName(uint8_t target) {
+    static const char* const NAMES[] = {"-", "lx", "ly", "rx", "ry", "lt", "rt"};
+    return target < sizeof(NAMES) / sizeof(NAMES[0]) ? NAMES[target] : "?";
+}
+
+int compileCommand(const std::vector<std::string>& args) {
+    std::string directory, output;
+    for (const auto& arg : args) {
+        if (arg.rfind("--out=", 0) == 0) output = arg.substr(6);
+        else directory = arg;
+    }
+    if (directory.empty()) {
+        std::cerr << USAGE_TEXT;
+        return 2;
+    }
+    if (output.empty()) {
+        output = (std::filesystem::path(directory) / ProfileLibrary::COMPILED_NAME).string();
+    }
+    std::string error;
+    auto start = std::chrono::steady_clock::now();
+    if (!ProfileLibrary::compileDirectory(directory, output, &error)) {
+        std::cerr << error << "\n";
+        return 1;
+    }
+    ProfileLibrary library;
+    if (!library.open(output, &error)) {
+        std::cerr << error << "\n";
+        return 1;
+    }
+    std::cout << "compiled " << library.size() << " profile(s) into " << output << " ("
+              << std::filesystem::file_size(output) << " bytes) in " << secondsSince(start) * 1000.0 << " ms\n";
+    return 0;
+}
+
+int dumpCommand(const std::vector<std::string>& args) {
+    if (args.size() != 1) {
+        std::cerr << USAGE_TEXT;
+        return 2;
+    }
+    ProfileLibrary library;
+    std::string error;
+    if (!library.open(args[0], &error)) {
+        std::cerr << error << "\n";
+        return 1;
+    }
+    std::cout << library.size() << " profile(s), source stamp " << std::hex << library.getSourceStamp() << std::dec
+              << "\n";
+    for (size_t i = 0; i < library.size(); ++i) {
+        const ProfileLibrary::Profile& profile = library.at(i);
+        std::cout << "\n" << library.getName(profile) << "\n";
+        for (size_t usage = 1; usage < ProfileLibrary::BUTTON_USAGES; ++usage) {
+            if (profile.buttons[usage] != 0) {
+                std::cout << "  button " << usage << " -> 0x" << std::hex << std::setw(4) << std::setfill('0')
+                          << profile.buttons[usage] << std::dec << std::setfill(' ') << "\n";
+            }
+            const uint8_t triggers = profile.buttonTriggers[usage];
+            if (triggers & ProfileLibrary::TRIGGER_LEFT) std::cout << "  button " << usage << " -> lt\n";
+            if (triggers & ProfileLibrary::TRIGGER_RIGHT) std::cout << "  button " << usage << " -> rt\n";
+        }
+        static const char* const DIRECTIONS[ProfileLibrary::HAT_DIRECTIONS] = {"up", "right", "down", "left"};
+        for (size_t d = 0; d < ProfileLibrary::HAT_DIRECTIONS; ++d) {
+            if (profile.hat[d] != 0) {
+                std::cout << "  hat " << DIRECTIONS[d] << " -> 0x" << std::hex << std::setw(4) << std::setfill('0')
+                          << profile.hat[d] << std::dec << std::setfill(' ') << "\n";
+            }
+        }
+        for (size_t a = 0; a < ProfileLibrary::AXIS_USAGES; ++a) {
+            const ProfileLibrary::Axis& axis = profile.axes[a];
+            if (axis.target == ProfileLibrary::AXIS_NONE) continue;
+            std::cout << "  axis 0x" << std::hex << ProfileLibrary::AXIS_FIRST_USAGE + a << std::dec << " -> "
+                      << targetName(axis.target);
+            if (axis.mode == ProfileLibrary::AXIS_FIXED) {
+                std::cout << " fixed center=" << axis.center << " scale=" << axis.scale;
+            } else {
+                std::cout << " caps";
+            }
+            std::cout << (axis.invert ? " invert" : "") << "\n";
+        }
+    }
+    return 0;
+}
+
+int benchCommand(const std::vector<std::string>& args) {
+    size_t profiles = 500;
+    size_t lookups = 1000000;
+    for (const auto& arg : args) {
+        if (arg.rfind("--profiles=", 0) == 0) profiles = static_cast<size_t>(std::max(1, std::atoi(arg.c_str() + 11)));
+        else if (arg.rfind("--lookups=", 0) == 0) lookups = static_cast<size_t>(std::max(1, std::atoi(arg.c_str() + 10)));
+        else {
+            std::cerr << USAGE_TEXT;
+            return 2;
+        }
+    }
+
+    namespace fs = std::filesystem;
+    fs::path dir = fs::temp_directory_path() / "xidp_profiles_bench";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    for (size_t i = 0; i < profiles; ++i) {
+        std::ofstream out(dir / ("pad" + std::to_string(i) + ".profile"));
+        char usb[16];
+        std::snprintf(usb, sizeof(usb), "%04x:%04x", static_cast<unsigned>(0x2000 + i / 0x10000),
+                      static_cast<unsigned>(i & 0xFFFF));
+        out << "xidp-profile 1\nname \"Pad " << i << "\"\nmatch usb=" << usb << "\nmatch name=\"Synthetic Pad " << i
+            << "\"\nbutton 1 a\nbutton 2 b\nbutton 3 x\nbutton 4 y\nbutton 5 lb\nbutton 6 rb\nbutton 9 back\n"
+               "button 10 start\naxis 0x30 lx caps\naxis 0x31 ly caps invert\naxis 0x32 rx caps\n"
+               "axis 0x35 ry caps invert\naxis 0x33 lt caps\naxis 0x34 rt caps\n";
+    }
+
+    std::string error;
+    auto start = std::chrono::steady_clock::now();
+    auto cold = ProfileLibrary::loadDirectory(dir.string(), &error);
+    const double coldSeconds = secondsSince(start);
+    start = std::chrono::steady_clock::now();
+    auto warm = ProfileLibrary::loadDirectory(dir.string(), &error);
+    const double warmSeconds = secondsSince(start);
+    if (!cold || !warm) {
+        std::cerr << error << "\n";
+        return 1;
+    }
+
+    std::vector<std::wstring> names;
+    for (size_t i = 0; i < profiles; ++i) names.push_back(L"Synthetic Pad " + std::to_wstring(i));
+    size_t found = 0;
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < lookups; ++i) {
+        const size_t pad = i % profiles;
+        found += warm->find(static_cast<uint16_t>(0x2000 + pad / 0x10000), static_cast<uint16_t>(pad & 0xFFFF), L"") != nullptr;
+    }
+    const double usbSeconds = secondsSince(start);
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < lookups; ++i) {
+        found += warm->find(0, 0, names[i % profiles]) != nullptr;
+    }
+    const double nameSeconds = secondsSince(start);
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < lookups; ++i) {
+        found += warm->find(0x1234, static_cast<uint16_t>(i), L"Unknown Pad") != nullptr;
+    }
+    const double missSeconds = secondsSince(start);
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << profiles << " profiles, blob " << fs::file_size(dir / ProfileLibrary::COMPILED_NAME) << " bytes\n";
+    std::cout << "  cold start (parse + compile + write): " << coldSeconds * 1000.0 << " ms\n";
+    std::cout << "  warm start (map + validate):          " << warmSeconds * 1000.0 << " ms"
+              << (warm->isMapped() ? "" : " (not mapped!)") << "\n";
+    std::cout << std::setprecision(1);
+    std::cout << "  lookup by USB id:   " << usbSeconds * 1e9 / lookups << " ns\n";
+    std::cout << "  lookup by name:     " << nameSeconds * 1e9 / lookups << " ns\n";
+    std::cout << "  miss (id and name): " << missSeconds * 1e9 / lookups << " ns\n";
+    fs::remove_all(dir);
+    return found == 2 * lookups ? 0 : 1;
+}
+
+int importCommand(const std::vector<std::string>& args) {
+    std::string path;
+    std::string platform = ControllerDb::nativePlatform();
+    for (const auto& arg : args) {
+        if (arg.rfind("--platform=", 0) == 0) platform = arg.substr(11);
+        else path = arg;
+    }
+    if (path.empty()) {
+        std::cerr << USAGE_TEXT;
+        return 2;
+    }
+    std::vector<ProfileLibrary::Source> sources;
+    ControllerDb::Stats stats;
+    std::string error;
+    auto start = std::chrono::steady_clock::now();
+    if (!ControllerDb::importFile(path, platform, sources, &stats, &error)) {
+        std::cerr << error << "\n";
+        return 1;
+    }
+    const double parseSeconds = secondsSince(start);
+    std::vector<uint8_t> blob;
+    start = std::chrono::steady_clock::now();
+    if (!ProfileLibrary::compile(sources, sources.size(), 0, blob, &error)) {
+        std::cerr << error << "\n";
+        return 1;
+    }
+    const double compileSeconds = secondsSince(start);
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << path << " (" << platform << "): " << stats.lines << " lines, " << stats.entries << " entries\n";
+    std::cout << "  imported:          " << stats.imported << "\n";
+    std::cout << "  other platform:    " << stats.otherPlatform << "\n";
+    std::cout << "  no USB id in GUID: " << stats.unsupportedGuid << "\n";
+    std::cout << "  unusable:          " << stats.unusable << "\n";
+    std::cout << "  replaced:          " << stats.replaced << "\n";
+    std::cout << "  skipped bindings:  " << stats.skippedBindings << "\n";
+    std::cout << "  parse:   " << parseSeconds * 1000.0 << " ms\n";
+    std::cout << "  compile: " << compileSeconds * 1000.0 << " ms (blob " << blob.size() << " bytes)\n";
+    return 0;
+}
+
+int benchDbCommand(const std::vector<std::string>& args) {
+    size_t entries = 7000;
+    size_t lookups = 1000000;
+    for (const auto& arg : args) {
+        if (arg.rfind("--entries=", 0) == 0) entries = static_cast<size_t>(std::max(1, std::atoi(arg.c_str() + 10)));
+        else if (arg.rfind("--lookups=", 0) == 0) lookups = static_cast<size_t>(std::max(1, std::atoi(arg.c_str() + 10)));
+        else {
+            std::cerr << USAGE_TEXT;
+            return 2;
+        }
+    }
+
+    // The community database: about a third per desktop platform, some with a version
+    namespace fs = std::filesystem;
+    static const char* const PLATFORMS[] = {"Windows", "Linux", "Mac OS X"};
+    const std::string platform = ControllerDb::nativePlatform();
+    fs::path dir = fs::temp_directory_path() / "xidp_profiles_bench_db";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    std::vector<std::pair<uint16_t, uint16_t>> native;
+    {
+        std::ofstream out(dir / ProfileLibrary::CONTROLLER_DB_NAME);
+        out << "# Synthetic SDL game controller database\n";
+        for (size_t i = 0; i < entries; ++i) {
+            const uint16_t vendorId = static_cast<uint16_t>(0x2000 + i / 0x10000);
+            const uint16_t productId = static_cast<uint16_t>(i & 0xFFFF);
+            const uint16_t version = i % 4 == 0 ? static_cast<uint16_t>(0x0100 + i % 16) : 0;
+            const char* entryPlatform = PLATFORMS[i % 3];
+            char guid[40];
+            std::snprintf(guid, sizeof(guid), "03000000%02x%02x0000%02x%02x0000%02x%02x0000", vendorId & 0xFF,
+                          vendorId >> 8, productId & 0xFF, productId >> 8, version & 0xFF, version >> 8);
+            out << guid << ",Synthetic Pad " << i << ",a:b0,b:b1,x:b2,y:b3,back:b8,guide:b12,start:b9,"
+                << "leftstick:b10,rightstick:b11,leftshoulder:b4,rightshoulder:b5,dpup:h0.1,dpdown:h0.4,"
+                << "dpleft:h0.8,dpright:h0.2,leftx:a0,lefty:a1,rightx:a3,righty:a4,lefttrigger:a2,"
+                << "righttrigger:a5,platform:" << entryPlatform << ",\n";
+            if (platform == entryPlatform) native.emplace_back(vendorId, productId);
+        }
+    }
+    if (native.empty()) {
+        std::cerr << "no entries for " << platform << "\n";
+        return 1;
+    }
+
+    std::string error;
+    auto start = std::chrono::steady_clock::now();
+    auto cold = ProfileLibrary::loadDirectory(dir.string(), &error);
+    const double coldSeconds = secondsSince(start);
+    start = std::chrono::steady_clock::now();
+    auto warm = ProfileLibrary::loadDirectory(dir.string(), &error);
+    const double warmSeconds = secondsSince(start);
+    if (!cold || !warm) {
+        std::cerr << error << "\n";
+        return 1;
+    }
+
+    size_t found = 0;
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < lookups; ++i) {
+        const auto& [vendorId, productId] = native[i % native.size()];
+        found += warm->find(vendorId, productId, L"", 0x0100) != nullptr;
+    }
+    const double lookupSeconds = secondsSince(start);
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << entries << " database entries, " << warm->size() << " " << platform << " profiles, blob "
+              << fs::file_size(dir / ProfileLibrary::COMPILED_NAME) << " bytes\n";
+    std::cout << "  cold start (import + compile + write): " << coldSeconds * 1000.0 << " ms\n";
+    std::cout << "  warm start (map + validate):           " << warmSeconds * 1000.0 << " ms"
+              << (warm->isMapped() ? "" : " (not mapped!)") << "\n";
+    std::cout << std::setprecision(1);
+    std::cout << "  lookup by USB id and version: " << lookupSeconds * 1e9 / lookups << " ns\n";
+    fs::remove_all(dir);
+    return found == lookups ? 0 : 1;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << USAGE_TEXT;
+        return 2;
+    }
+    const std::string command = argv[1];
+    const std::vector<std::string> args(argv + 2, argv + argc);
+    if (command == "compile") return compileCommand(args);
+    if (command == "dump") return dumpCommand(args);
+    if (command == "import") return importCommand(args);
+    if (command == "bench") return benchCommand(args);
+    if (command == "bench-db") return benchDbCommand(args);
+    std::cerr << USAGE_TEXT;
+    return 2;
+}
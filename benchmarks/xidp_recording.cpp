@@ -0,0 +1,189 @@
+/**
+ * @file xidp_recording.cpp
+ * @brief Size and throughput of the recording container against the text format
+ *
+ * Usage: xidp_recording [--pads=<n>] [--seconds=<s>] [--chunk-frames=<n>] [<recording.rec>...]
+ *
+ * Without files, synthesizes a 1 kHz session of --pads XInput pads whose
+ * sticks wander and whose buttons change a few times a second, which is what
+ * long play sessions look like. For each session, prints the text and
+ * container sizes, the compression ratio, encode and decode throughput (MB/s
+ * of text-equivalent data and frames/s) and the mean time of a random seek.
+ * Exit code 1 if a round trip does not reproduce the text format.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "core/recording_container.hpp"
+
+namespace {
+
+struct CommandLine {
+    size_t pads = 4;
+    uint32_t seconds = 600;
+    uint32_t chunkFrames = RecordingWriter::Options().chunkFrames;
+    std::vector<std::string> files;
+};
+
+const char* const USAGE_TEXT =
+    "Usage: xidp_recording [--pads=<n>] [--seconds=<s>] [--chunk-frames=<n>] [<recording.rec>...]\n";
+
+bool parseArgs(int argc, char** argv, CommandLine& cmd) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&arg](const char* prefix) -> const char* {
+            size_t length = std::strlen(prefix);
+            return arg.compare(0, length, prefix) == 0 ? arg.c_str() + length : nullptr;
+        };
+        if (const char* v = value("--pads=")) {
+            cmd.pads = static_cast<size_t>(std::max(1, std::atoi(v)));
+        } else if (const char* v = value("--seconds=")) {
+            cmd.seconds = static_cast<uint32_t>(std::max(1, std::atoi(v)));
+        } else if (const char* v = value("--chunk-frames=")) {
+            cmd.chunkFrames = static_cast<uint32_t>(std::max(1, std::atoi(v)));
+        } else if (arg.compare(0, 2, "--") == 0) {
+            std::cerr << "Unknown argument: " << arg << "\n" << USAGE_TEXT;
+            return false;
+        } else {
+            cmd.files.push_back(arg);
+        }
+    }
+    return true;
+}
+
+SessionRecording synthesize(size_t pads, uint32_t seconds) {
+    SessionRecording recording;
+    for (size_t pad = 0; pad < pads; ++pad) {
+        SessionRecording::Device device;
+        device.kind = SessionRecording::SourceKind::XINPUT;
+        device.userId = static_cast<int>(pad);
+        recording.devices.push_back(device);
+    }
+
+    std::mt19937 rng(1234);
+    std::uniform_int_distribution<int> step(-400, 400);
+    std::uniform_int_distribution<int> percent(0, 99);
+    std::vector<SessionRecording::Sample> state(pads);
+    for (size_t pad = 0; pad < pads; ++pad) {
+        state[pad].device = pad;
+    }
+    auto walk = [&](SHORT& axis) {
+        axis = static_cast<SHORT>(std::clamp(axis + step(rng), -32768, 32767));
+    };
+
+    const uint32_t frames = seconds * 1000;
+    recording.frames.reserve(frames);
+    for (uint32_t f = 0; f < frames; ++f) {
+        SessionRecording::Frame frame;
+        frame.timeUs = static_cast<uint64_t>(f) * 1000 + static_cast<uint64_t>(percent(rng) % 20);
+        for (auto& sample : state) {
+            XINPUT_GAMEPAD& g = sample.gamepad;
+            walk(g.sThumbLX);
+            walk(g.sThumbLY);
+            if (percent(rng) < 50) {
+                walk(g.sThumbRX);
+                walk(g.sThumbRY);
+            }
+            if (percent(rng) < 1) g.wButtons ^= static_cast<WORD>(1u << (percent(rng) % 16));
+            if (percent(rng) < 2) g.bRightTrigger = static_cast<BYTE>(percent(rng) * 255 / 99);
+            sample.packetNumber++;
+            frame.samples.push_back(sample);
+        }
+        recording.frames.push_back(std::move(frame));
+    }
+    return recording;
+}
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool measure(const std::string& name, const SessionRecording& recording, const CommandLine& cmd) {
+    std::ostringstream text;
+    recording.write(text);
+    const std::string reference = text.str();
+
+    RecordingWriter::Options options;
+    options.chunkFrames = cmd.chunkFrames;
+    std::ostringstream out;
+    auto start = std::chrono::steady_clock::now();
+    RecordingWriter::write(recording, out, options);
+    double encodeSeconds = secondsSince(start);
+    const std::string bytes = out.str();
+
+    std::istringstream in(bytes);
+    RecordingReader reader;
+    SessionRecording decoded;
+    start = std::chrono::steady_clock::now();
+    bool ok = reader.open(in) && reader.readAll(decoded);
+    double decodeSeconds = secondsSince(start);
+
+    std::ostringstream roundTrip;
+    decoded.write(roundTrip);
+    ok = ok && roundTrip.str() == reference;
+
+    // Random seeks over the whole session
+    double seekUs = 0.0;
+    if (ok && !recording.frames.empty()) {
+        std::mt19937_64 rng(99);
+        std::uniform_int_distribution<uint64_t> when(recording.frames.front().timeUs, recording.frames.back().timeUs);
+        const int seeks = 200;
+        SessionRecording::Frame frame;
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < seeks; ++i) {
+            ok = ok && reader.seek(when(rng)) && reader.next(frame);
+        }
+        seekUs = secondsSince(start) * 1e6 / seeks;
+    }
+
+    const double megabytes = static_cast<double>(reference.size()) / 1e6;
+    const double frames = static_cast<double>(recording.frames.size());
+    std::cout << std::left << std::setw(24) << name << std::right << std::fixed << std::setprecision(2)
+              << std::setw(10) << megabytes << std::setw(10) << static_cast<double>(bytes.size()) / 1e6
+              << std::setprecision(1) << std::setw(8) << (bytes.empty() ? 0.0 : static_cast<double>(reference.size()) / bytes.size())
+              << std::setw(9) << megabytes / encodeSeconds << std::setw(9) << megabytes / decodeSeconds
+              << std::setw(11) << frames / encodeSeconds / 1e6 << std::setw(11) << frames / decodeSeconds / 1e6
+              << std::setw(9) << seekUs << (ok ? "" : "  ROUND TRIP FAILED") << std::endl;
+    return ok;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    CommandLine cmd;
+    if (!parseArgs(argc, argv, cmd)) {
+        return 2;
+    }
+
+    std::cout << "chunks of " << cmd.chunkFrames << " frames; MB/s counts text-format bytes\n";
+    std::cout << std::left << std::setw(24) << "session" << std::right << std::setw(10) << "text MB"
+              << std::setw(10) << "xrec MB" << std::setw(8) << "ratio" << std::setw(9) << "enc MB/s"
+              << std::setw(9) << "dec MB/s" << std::setw(11) << "enc Mfr/s" << std::setw(11) << "dec Mfr/s"
+              << std::setw(9) << "seek us" << "\n";
+
+    bool ok = true;
+    if (cmd.files.empty()) {
+        std::ostringstream name;
+        name << cmd.pads << " pads, " << cmd.seconds << " s";
+        ok = measure(name.str(), synthesize(cmd.pads, cmd.seconds), cmd);
+    }
+    for (const auto& file : cmd.files) {
+        SessionRecording recording;
+        std::string error;
+        if (!recording.load(file, &error)) {
+            std::cerr << file << ": " << error << "\n";
+            return 2;
+        }
+        std::string name = file.substr(file.find_last_of("/\\") + 1);
+        ok = measure(name, recording, cmd) && ok;
+    }
+    return ok ? 0 : 1;
+}
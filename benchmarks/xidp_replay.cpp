@@ -0,0 +1,72 @@
+/**
+ * @file xidp_replay.cpp
+ * @brief Headless replay of recorded sessions (PGO training and build comparison)
+ *
+ * Usage: xidp_replay [--iterations=<n>] [--simd=<level>] [--json] <recording|directory>...
+ *
+ * Replays the recordings through translation, output shaping and both
+ * encoders and prints the throughput and the output checksum. Builds with
+ * different optimization settings or SIMD levels must print the same checksum.
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "core/replay_workload.hpp"
+#include "core/simd_kernels.hpp"
+
+int main(int argc, char** argv) {
+    uint32_t iterations = 100;
+    bool json = false;
+    ReplayWorkload workload;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.compare(0, 13, "--iterations=") == 0) {
+            iterations = static_cast<uint32_t>(std::atoi(arg.c_str() + 13));
+        } else if (arg.compare(0, 7, "--simd=") == 0) {
+            SimdLevel level;
+            if (!SimdKernels::parseLevel(arg.substr(7), level)) {
+                std::cerr << "Unknown SIMD level: " << arg.substr(7) << "\n";
+                return 2;
+            }
+            SimdKernels::select(level);
+        } else if (arg == "--json") {
+            json = true;
+        } else if (arg.compare(0, 2, "--") == 0) {
+            std::cerr << "Unknown argument: " << arg << "\n";
+            return 2;
+        } else {
+            std::string error;
+            if (!workload.add(arg, &error)) {
+                std::cerr << error << "\n";
+                return 2;
+            }
+        }
+    }
+    if (workload.size() == 0 || iterations == 0) {
+        std::cerr << "Usage: xidp_replay [--iterations=<n>] [--simd=<level>] [--json] <recording|directory>...\n";
+        return 2;
+    }
+
+    ReplayWorkload::Stats stats = workload.run(iterations);
+    double nsPerFrame = stats.frames ? stats.seconds * 1e9 / static_cast<double>(stats.frames) : 0.0;
+    if (json) {
+        std::cout << std::fixed << std::setprecision(2)
+                  << "{\"recordings\": " << stats.recordings << ", \"iterations\": " << iterations
+                  << ", \"frames\": " << stats.frames << ", \"outputs\": " << stats.outputs
+                  << ", \"simd\": \"" << SimdKernels::describe() << "\""
+                  << ", \"seconds\": " << stats.seconds << ", \"ns_per_frame\": " << nsPerFrame
+                  << ", \"checksum\": \"" << std::hex << stats.checksum << std::dec << "\"}\n";
+    } else {
+        std::cout << stats.recordings << " recordings x " << iterations << ": "
+                  << stats.frames << " frames, " << stats.outputs << " reports in "
+                  << std::fixed << std::setprecision(3) << stats.seconds << " s ("
+                  << std::setprecision(1) << nsPerFrame << " ns/frame), checksum "
+                  << std::hex << stats.checksum << std::dec << "\n";
+    }
+    return 0;
+}
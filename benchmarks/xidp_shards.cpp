@@ -0,0 +1,160 @@
+/**
+ * @file xidp_shards.cpp
+ * @brief Loop cost and edge latency of one pipeline vs. controllers sharded across several
+ *
+ * Usage: xidp_shards [--controllers=<n>] [--shards=<n>[,<n>...]] [--duration-ms=<ms>]
+ *                    [--report-rate-hz=<hz>] [--loop-hz=<hz>] [--no-pin]
+ *
+ * For each shard count, PipelineSupervisor splits the synthetic controllers
+ * into contiguous shards; every shard gets its own SyntheticInputSource,
+ * EdgeProbeBus and pipeline thread pinned to its own core. Prints loop cost
+ * per frame and the edge latency distribution over all shards. Exit code 1
+ * if any run lost edges.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "core/latency_rig.hpp"
+#include "core/pipeline.hpp"
+#include "core/synthetic_source.hpp"
+#include "utils/threading.hpp"
+
+namespace {
+
+struct CommandLine {
+    size_t controllers = 64;
+    std::vector<size_t> shards = {1, 4};
+    uint32_t durationMs = 2000;
+    uint32_t reportRateHz = 1000;
+    uint32_t loopHz = 1000;
+    uint32_t reportsPerEdge = 8;
+    bool pin = true;
+};
+
+const char* const USAGE_TEXT =
+    "Usage: xidp_shards [--controllers=<n>] [--shards=<n>[,<n>...]] [--duration-ms=<ms>]\n"
+    "                   [--report-rate-hz=<hz>] [--loop-hz=<hz>] [--no-pin]\n";
+
+bool parseArgs(int argc, char** argv, CommandLine& cmd) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&arg](const char* prefix) -> const char* {
+            size_t length = std::strlen(prefix);
+            return arg.compare(0, length, prefix) == 0 ? arg.c_str() + length : nullptr;
+        };
+        if (const char* v = value("--controllers=")) {
+            cmd.controllers = static_cast<size_t>(std::max(1, std::atoi(v)));
+        } else if (const char* v = value("--shards=")) {
+            cmd.shards.clear();
+            std::stringstream list(v);
+            std::string item;
+            while (std::getline(list, item, ',')) {
+                int count = std::atoi(item.c_str());
+                if (count > 0) cmd.shards.push_back(static_cast<size_t>(count));
+            }
+        } else if (const char* v = value("--duration-ms=")) {
+            cmd.durationMs = static_cast<uint32_t>(std::atoi(v));
+        } else if (const char* v = value("--report-rate-hz=")) {
+            cmd.reportRateHz = static_cast<uint32_t>(std::atoi(v));
+        } else if (const char* v = value("--loop-hz=")) {
+            cmd.loopHz = static_cast<uint32_t>(std::atoi(v));
+        } else if (arg == "--no-pin") {
+            cmd.pin = false;
+        } else {
+            std::cerr << "Unknown argument: " << arg << "\n" << USAGE_TEXT;
+            return false;
+        }
+    }
+    if (cmd.shards.empty()) {
+        std::cerr << "No shard counts given\n" << USAGE_TEXT;
+        return false;
+    }
+    return true;
+}
+
+struct RunResult {
+    size_t shards = 0;
+    Pipeline::Stats stats;
+    double busyPerFrameUs = 0.0;
+    LatencyRig::Result latency;
+};
+
+RunResult runSharded(const CommandLine& cmd, size_t shardCount) {
+    ConfigManager base;
+    base.setBool("stick_deadzone_enabled", false);   // Keeps the sequence number in the right stick
+    base.setInt("polling_frequency", static_cast<int>(cmd.loopHz));
+
+    std::vector<PipelineSupervisor::Shard> shards =
+        PipelineSupervisor::plan(cmd.controllers, shardCount, ThreadingUtils::getLogicalCoreCount());
+    std::vector<SyntheticInputSource*> sources;
+    std::vector<EdgeProbeBus*> buses;
+    PipelineSupervisor supervisor(base, shards, [&](size_t, const PipelineSupervisor::Shard& shard) {
+        SyntheticInputSource::Config config;
+        config.controllers = shard.count;
+        config.reportRateHz = cmd.reportRateHz;
+        config.reportsPerEdge = cmd.reportsPerEdge;
+        auto source = std::make_unique<SyntheticInputSource>(config);
+        auto bus = std::make_unique<EdgeProbeBus>(shard.count);
+        sources.push_back(source.get());
+        buses.push_back(bus.get());
+        return PipelineSupervisor::Endpoints{std::move(source), std::move(bus)};
+    });
+
+    supervisor.start(cmd.pin);
+    for (auto* source : sources) source->start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(cmd.durationMs));
+    for (auto* source : sources) source->stop();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));   // Let the last edges through
+    supervisor.stop();
+
+    RunResult result;
+    result.shards = supervisor.size();
+    result.stats = supervisor.totalStats();
+    result.busyPerFrameUs = result.stats.frames
+        ? static_cast<double>(result.stats.busyUs) / static_cast<double>(result.stats.frames) : 0.0;
+    std::vector<double> latencies;
+    for (size_t i = 0; i < supervisor.size(); ++i) {
+        buses[i]->match(sources[i]->getEdges(), cmd.reportsPerEdge, result.latency, latencies);
+    }
+    LatencyRig::summarize(latencies, result.latency);
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    CommandLine cmd;
+    if (!parseArgs(argc, argv, cmd)) {
+        return 2;
+    }
+
+    std::cout << cmd.controllers << " synthetic controllers at " << cmd.reportRateHz << " Hz, "
+              << cmd.loopHz << " Hz loops, " << ThreadingUtils::getLogicalCoreCount() << " logical cores"
+              << (cmd.pin ? ", pinned" : ", unpinned") << "\n";
+    std::cout << std::left << std::setw(8) << "shards" << std::right
+              << std::setw(10) << "frames" << std::setw(12) << "busy us/f" << std::setw(10) << "max us"
+              << std::setw(10) << "overruns" << std::setw(8) << "edges" << std::setw(8) << "lost"
+              << std::setw(10) << "p50 us" << std::setw(10) << "p99 us" << std::setw(10) << "max us" << "\n";
+
+    bool lost = false;
+    for (size_t shardCount : cmd.shards) {
+        RunResult r = runSharded(cmd, shardCount);
+        lost = lost || r.latency.delivered < r.latency.edges || r.latency.sequenceErrors > 0;
+        std::cout << std::left << std::setw(8) << r.shards << std::right
+                  << std::setw(10) << r.stats.frames << std::fixed << std::setprecision(1)
+                  << std::setw(12) << r.busyPerFrameUs << std::setw(10) << r.stats.maxFrameUs
+                  << std::setw(10) << r.stats.overruns << std::setw(8) << r.latency.edges
+                  << std::setw(8) << (r.latency.edges - r.latency.delivered)
+                  << std::setw(10) << r.latency.p50Us << std::setw(10) << r.latency.p99Us
+                  << std::setw(10) << r.latency.maxUs << std::endl;
+    }
+    return lost ? 1 : 0;
+}
@@ -0,0 +1,176 @@
+/**
+ * @file xidp_stream.cpp
+ * @brief Datagram size and one-way latency of controller state streaming over loopback
+ *
+ * Usage: xidp_stream [--controllers=<n>] [--frames=<n>] [--rate-hz=<hz>]
+ *                    [--keyframe-ms=<ms>]
+ *
+ * A UdpStreamSender publishes --frames frames at --rate-hz to a
+ * UdpStreamReceiver thread on 127.0.0.1. Each frame's timestamp is the send
+ * time; latency is measured when the receiver's callback sees the frame (same
+ * clock, same machine). Two scenarios:
+ * - sticks:  every controller's left stick moves every frame
+ * - buttons: one controller at a time toggles A, everything else held
+ * Exit code 1 if the last frame of a run never arrived.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "core/latency_rig.hpp"
+#include "core/state_stream.hpp"
+#include "utils/timing.hpp"
+
+namespace {
+
+struct CommandLine {
+    size_t controllers = 4;
+    uint32_t frames = 5000;
+    uint32_t rateHz = 1000;
+    uint32_t keyframeMs = 50;
+};
+
+const char* const USAGE_TEXT =
+    "Usage: xidp_stream [--controllers=<n>] [--frames=<n>] [--rate-hz=<hz>]\n"
+    "                   [--keyframe-ms=<ms>]\n";
+
+bool parseArgs(int argc, char** argv, CommandLine& cmd) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&arg](const char* prefix) -> const char* {
+            size_t length = std::strlen(prefix);
+            return arg.compare(0, length, prefix) == 0 ? arg.c_str() + length : nullptr;
+        };
+        if (const char* v = value("--controllers=")) {
+            cmd.controllers = std::min(StateStreamEncoder::MAX_CONTROLLERS, static_cast<size_t>(std::max(1, std::atoi(v))));
+        } else if (const char* v = value("--frames=")) {
+            cmd.frames = static_cast<uint32_t>(std::max(1, std::atoi(v)));
+        } else if (const char* v = value("--rate-hz=")) {
+            cmd.rateHz = static_cast<uint32_t>(std::max(1, std::atoi(v)));
+        } else if (const char* v = value("--keyframe-ms=")) {
+            cmd.keyframeMs = static_cast<uint32_t>(std::max(1, std::atoi(v)));
+        } else {
+            std::cerr << "Unknown argument: " << arg << "\n" << USAGE_TEXT;
+            return false;
+        }
+    }
+    return true;
+}
+
+uint64_t nowUs() {
+    return static_cast<uint64_t>(TimingUtils::counterToMicroseconds(TimingUtils::getPerformanceCounter()));
+}
+
+struct RunResult {
+    const char* scenario = "";
+    UdpStreamSender::Stats sent;
+    UdpStreamReceiver::Stats received;
+    LatencyRig::Result latency;
+    bool complete = false;
+};
+
+RunResult run(const CommandLine& cmd, bool sticks) {
+    RunResult result;
+    result.scenario = sticks ? "sticks" : "buttons";
+
+    UdpStreamReceiver receiver;
+    if (!receiver.open(0, "127.0.0.1")) {
+        std::exit(2);
+    }
+    std::mutex mutex;
+    std::vector<double> latencies;
+    latencies.reserve(cmd.frames);
+    uint32_t lastFrame = 0;
+    receiver.setFrameCallback([&](const StateStreamDecoder::Frame& frame) {
+        uint64_t arrivedUs = nowUs();
+        std::lock_guard<std::mutex> lock(mutex);
+        latencies.push_back(arrivedUs > frame.timestampUs ? static_cast<double>(arrivedUs - frame.timestampUs) : 0.0);
+        lastFrame = static_cast<uint32_t>(frame.states[0].gamepad.sThumbRX);
+    });
+    receiver.start();
+
+    UdpStreamSender sender(static_cast<uint64_t>(cmd.keyframeMs) * 1000);
+    if (!sender.open("127.0.0.1", receiver.getPort())) {
+        std::exit(2);
+    }
+
+    std::vector<TranslatedState> states(cmd.controllers);
+    for (size_t i = 0; i < states.size(); ++i) {
+        states[i] = TranslatedState{};
+        states[i].sourceUserId = static_cast<int>(i);
+        states[i].isXInputSource = true;
+        states[i].targetType = TranslatedState::TARGET_XINPUT;
+        states[i].gamepad.wButtons = XINPUT_GAMEPAD_LEFT_SHOULDER;
+        states[i].gamepad.sThumbLY = 12000;
+    }
+
+    const auto period = std::chrono::microseconds(1000000 / cmd.rateHz);
+    auto next = std::chrono::steady_clock::now();
+    for (uint32_t frame = 1; frame <= cmd.frames; ++frame) {
+        if (sticks) {
+            for (auto& state : states) {
+                state.gamepad.sThumbLX = static_cast<SHORT>((frame * 97) % 65536 - 32768);
+            }
+        } else {
+            states[frame % states.size()].gamepad.wButtons ^= XINPUT_GAMEPAD_A;
+        }
+        states[0].gamepad.sThumbRX = static_cast<SHORT>(frame % 32768);   // Frame marker
+        sender.send(states, nowUs());
+        next += period;
+        std::this_thread::sleep_until(next);
+    }
+
+    const uint32_t lastMarker = cmd.frames % 32768;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+    while (std::chrono::steady_clock::now() < deadline) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (lastFrame == lastMarker) break;
+    }
+    receiver.stop();
+
+    result.sent = sender.getStats();
+    result.received = receiver.getStats();
+    std::lock_guard<std::mutex> lock(mutex);
+    result.complete = lastFrame == lastMarker;
+    result.latency.edges = cmd.frames;
+    result.latency.delivered = latencies.size();
+    LatencyRig::summarize(latencies, result.latency);
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    CommandLine cmd;
+    if (!parseArgs(argc, argv, cmd)) {
+        return 2;
+    }
+    TimingUtils::initialize();
+
+    std::cout << cmd.controllers << " controller(s), " << cmd.frames << " frames at " << cmd.rateHz
+              << " Hz, keyframe every " << cmd.keyframeMs << " ms, loopback\n";
+    std::cout << std::left << std::setw(9) << "scenario" << std::right << std::setw(10) << "datagrams"
+              << std::setw(10) << "bytes/dg" << std::setw(11) << "delivered" << std::setw(7) << "lost"
+              << std::setw(10) << "mean us" << std::setw(10) << "p50 us" << std::setw(10) << "p99 us"
+              << std::setw(10) << "max us" << "\n";
+
+    bool incomplete = false;
+    for (bool sticks : {true, false}) {
+        RunResult r = run(cmd, sticks);
+        incomplete = incomplete || !r.complete;
+        double bytesPerDatagram = r.sent.datagrams ? static_cast<double>(r.sent.bytes) / r.sent.datagrams : 0.0;
+        std::cout << std::left << std::setw(9) << r.scenario << std::right << std::setw(10) << r.sent.datagrams
+                  << std::fixed << std::setprecision(1) << std::setw(10) << bytesPerDatagram
+                  << std::setw(11) << r.latency.delivered << std::setw(7) << r.received.decoder.lost
+                  << std::setw(10) << r.latency.meanUs << std::setw(10) << r.latency.p50Us
+                  << std::setw(10) << r.latency.p99Us << std::setw(10) << r.latency.maxUs << std::endl;
+    }
+    return incomplete ? 1 : 0;
+}
@@ -12,20 +12,36 @@
 .PARAMETER BuildType
     Build configuration type (Release or Debug). Default: Release
 
+.PARAMETER LTO
+    Build with link-time code generation (/GL, /LTCG)
+
+.PARAMETER PGO
+    Profile-guided optimization phase (Off, Generate or Use). Default: Off
+    After a Generate build, train it with the headless replay:
+        .\build\xinput_dinput_proxy.exe --replay tests\golden --iterations 200
+    then rebuild with -PGO Use.
+
 .EXAMPLE
     .\build.ps1
     .\build.ps1 -Clean
     .\build.ps1 -BuildType Debug
+    .\build.ps1 -LTO
+    .\build.ps1 -PGO Generate
 #>
 
 param(
     [switch]$Clean,
     [ValidateSet("Release", "Debug")]
-    [string]$BuildType = "Release"
+    [string]$BuildType = "Release",
+    [switch]$LTO,
+    [ValidateSet("Off", "Generate", "Use")]
+    [string]$PGO = "Off"
 )
 
 # Configuration
 $ErrorActionPreference = "Stop"
+$LtoFlag = if ($LTO) { "ON" } else { "OFF" }
+$PgoFlag = $PGO.ToUpper()
 $ProjectName = "XInput-DirectInput Proxy"
 $BuildDir = "build"
 $ExeName = "xinput_dinput_proxy.exe"
@@ -127,7 +143,7 @@ if errorlevel 1 (
 
 REM Run CMake
 echo Running CMake configuration...
-cmake .. -GNinja -DCMAKE_BUILD_TYPE=$BuildType
+cmake .. -GNinja -DCMAKE_BUILD_TYPE=$BuildType -DXIDP_LTO=$LtoFlag -DXIDP_PGO=$PgoFlag
 if errorlevel 1 (
     echo ERROR: CMake configuration failed
     exit /b 1
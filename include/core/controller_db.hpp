@@ -0,0 +1,82 @@
+/**
+ * @file controller_db.hpp
+ * @brief Import of SDL gamecontrollerdb.txt mappings as device profiles
+ *
+ * Each line of the community database maps one joystick GUID to the SDL
+ * gamepad layout:
+ *
+ *     030000004c050000cc09000000000000,PS4 Controller,a:b1,b:b2,...,dpup:h0.1,
+ *         leftx:a0,lefty:a1,lefttrigger:a3,righttrigger:a4,platform:Windows,
+ *
+ * Entries of one platform are turned into ProfileLibrary sources keyed by
+ * the USB vendor/product id and version in the GUID (the vid/pid GUIDs of
+ * SDL 2.0.5 and later, and the older "PIDVID" DirectInput ones). SDL indices
+ * become HID usages the way HID devices enumerate them: button bN is button
+ * usage N+1, axis aN is Generic Desktop usage 0x30+N (X Y Z Rx Ry Rz ...)
+ * and hat h0 is the hat switch.
+ *
+ * Bindings XInput cannot express (guide, paddles, touchpad, misc buttons)
+ * and half-axis bindings ("+a2", "-leftx") are skipped and counted; the
+ * rest of the entry is still imported. Entries whose GUID carries no USB id
+ * (xinput, CRC-only names) are skipped.
+ *
+ * The result goes through ProfileLibrary::compile like any profile, so the
+ * database is parsed once and later starts map the compiled blob.
+ */
+#pragma once
+
+#include <cstddef>
+#include <istream>
+#include <string>
+#include <vector>
+#include "core/profile_library.hpp"
+
+/**
+ * @class ControllerDb
+ * @brief Parser for SDL game controller mapping databases
+ */
+class ControllerDb {
+public:
+    /**
+     * @struct Stats
+     * @brief What an import took and what it left out
+     */
+    struct Stats {
+        size_t lines = 0;
+        size_t entries = 0;             // Mapping lines of any platform
+        size_t imported = 0;            // Turned into sources
+        size_t otherPlatform = 0;
+        size_t unsupportedGuid = 0;     // No USB id in the GUID
+        size_t unusable = 0;            // Malformed, or no binding XInput can use
+        size_t replaced = 0;            // Same GUID again later in the file (the later one wins, as in SDL)
+        size_t skippedBindings = 0;
+    };
+
+    /**
+     * @brief Platform name of this build as used in the database ("Windows", "Linux", "Mac OS X")
+     */
+    static std::string nativePlatform();
+
+    /**
+     * @brief USB id and version of an SDL joystick GUID
+     * @return False if the GUID does not carry a vendor/product id
+     */
+    static bool parseGuid(const std::string& guid, ProfileLibrary::Source::UsbId& id);
+
+    /**
+     * @brief Import every entry of one platform (entries without platform field apply to all)
+     *
+     * Malformed lines are counted and skipped, like SDL does. Versioned
+     * entries also match their vendor/product id when no entry for that id
+     * without version exists, since not every capture path knows the version.
+     */
+    static void import(std::istream& in, const std::string& platform, std::vector<ProfileLibrary::Source>& sources,
+                       Stats* stats = nullptr, const std::string& origin = ProfileLibrary::CONTROLLER_DB_NAME);
+
+    /**
+     * @brief Import a database file
+     */
+    static bool importFile(const std::string& path, const std::string& platform,
+                           std::vector<ProfileLibrary::Source>& sources, Stats* stats = nullptr,
+                           std::string* error = nullptr);
+};
@@ -7,6 +7,7 @@
 #include "core/input_capture.hpp"
 #include "core/translation_layer.hpp"
 #include "core/virtual_device_emulator.hpp"
+#include "core/input_merger.hpp"
 
 /**
  * @brief Manages the lifecycle of physical and virtual controller devices
@@ -28,6 +29,13 @@ public:
     );
     ~DeviceManager() = default;
 
+    /**
+     * @brief Route merged devices to one virtual controller per merge group
+     *
+     * @param merger Merge configuration (nullptr disables merging)
+     */
+    void setInputMerger(const InputMerger* merger) { m_inputMerger = merger; }
+
     /**
      * @brief Process connected physical devices and manage virtual device lifecycle
      * 
@@ -88,8 +96,17 @@ private:
      */
     void destroyVirtualDevicesForController(int userId);
 
+    /**
+     * @brief Create or destroy the virtual device of each merge group
+     * 
+     * @param groupConnected Per-group flag: at least one member is connected
+     * @param translationEnabled Whether translation is active
+     */
+    void processMergeGroups(const std::vector<bool>& groupConnected, bool translationEnabled);
+
     VirtualDeviceEmulator* m_emulator;
     TranslationLayer* m_translationLayer;
+    const InputMerger* m_inputMerger;
 
     // Track physical devices that have been hidden or failed to hide
     std::set<std::wstring> m_hiddenDeviceIds;
@@ -0,0 +1,180 @@
+/**
+ * @file device_splitter.hpp
+ * @brief One-to-many splitting of a physical device into several virtual controllers
+ *
+ * Some arcade encoders and dual-player fight sticks expose two players' worth
+ * of controls on a single HID interface. A split configuration assigns
+ * disjoint button and axis subsets of that device to separate outputs, each
+ * presented as its own virtual controller.
+ *
+ * The configuration is compiled into a dense plan (button usage -> output and
+ * XInput bit, axis usage -> output and field) so all outputs are produced by
+ * one pass over the already-decoded report: a table lookup per pressed button
+ * and one value lookup per mapped axis. The logical ranges of the mapped axes
+ * are resolved from the device's value caps once, when the device is bound.
+ */
+#pragma once
+
+#include <array>
+#include <string>
+#include <vector>
+#include <utility>
+#include "core/hid_axis.hpp"
+#include "core/input_capture.hpp"
+
+/**
+ * @enum SplitField
+ * @brief Analog destination of a split axis
+ */
+enum class SplitField : uint8_t {
+    LX, LY, RX, RY, LT, RT
+};
+
+/**
+ * @struct SplitOutputConfig
+ * @brief Controls of one virtual controller carved out of a physical device
+ */
+struct SplitOutputConfig {
+    std::string name;
+    std::vector<std::pair<USAGE, WORD>> buttons;     // HID button usage -> XInput button
+    std::vector<std::pair<USAGE, SplitField>> axes;  // HID axis usage -> gamepad field
+};
+
+/**
+ * @struct SplitDeviceConfig
+ * @brief A physical device and the outputs it is split into
+ */
+struct SplitDeviceConfig {
+    std::wstring sourceMatch;  // Product name or device instance ID substring
+    std::vector<SplitOutputConfig> outputs;
+};
+
+/**
+ * @struct SplitGamepad
+ * @brief Gamepad fields of one split output (same layout as TranslatedState::GamepadState)
+ */
+struct SplitGamepad {
+    WORD wButtons;
+    BYTE bLeftTrigger;
+    BYTE bRightTrigger;
+    SHORT sThumbLX;
+    SHORT sThumbLY;
+    SHORT sThumbRX;
+    SHORT sThumbRY;
+};
+
+/**
+ * @class DeviceSplitter
+ * @brief Compiles split configurations and scatters decoded input into outputs
+ *
+ * Per-output pipeline state (debounce timing, last emitted state for change
+ * detection) lives here so each output is processed independently.
+ */
+class DeviceSplitter {
+public:
+    static constexpr int SPLIT_USER_ID_BASE = 200;
+    static constexpr size_t MAX_DEVICES = 4;
+    static constexpr size_t MAX_OUTPUTS = 4;
+    static constexpr USAGE MAX_BUTTON_USAGE = 128;
+
+    /**
+     * @struct OutputState
+     * @brief Independent pipeline state of one split output
+     */
+    struct OutputState {
+        uint64_t lastButtonChangeTime;
+        SplitGamepad lastEmitted;
+        bool hasEmitted;
+    };
+
+    DeviceSplitter();
+
+    /**
+     * @brief Compile split configurations into dense lookup plans
+     */
+    void configure(const std::vector<SplitDeviceConfig>& devices);
+
+    bool isEnabled() const { return m_deviceCount > 0; }
+    size_t getDeviceCount() const { return m_deviceCount; }
+    size_t getOutputCount(int device) const { return m_plans[device].outputCount; }
+    const std::string& getOutputName(int device, int output) const { return m_plans[device].outputNames[output]; }
+    static int virtualUserId(int device, int output) {
+        return SPLIT_USER_ID_BASE + device * static_cast<int>(MAX_OUTPUTS) + output;
+    }
+
+    /**
+     * @brief Find the split configuration a physical device belongs to
+     *
+     * @return Device index, or -1 if the device is not split
+     */
+    int findDevice(const ControllerState& state) const;
+
+    /**
+     * @struct Binding
+     * @brief A split plan bound to one physical device
+     *
+     * Holds the logical range of every mapped axis, in plan order, so split()
+     * does no value cap scans. Rebind when a different device shows up.
+     */
+    struct Binding {
+        int device = -1;
+        std::vector<HidAxis::Range> axisRanges;
+    };
+
+    /**
+     * @brief Bind a split plan to the physical device it was found for
+     *
+     * @param device Device index from findDevice()
+     * @param state Captured state of the device (value caps)
+     */
+    Binding bind(int device, const ControllerState& state) const;
+
+    /**
+     * @brief Scatter one decoded report into the outputs of a split device
+     *
+     * @param binding Plan bound to the device by bind()
+     * @param state Captured state (decoded buttons and values)
+     * @param outputs Per-output gamepad state, fully overwritten
+     */
+    void split(const Binding& binding, const ControllerState& state,
+               std::array<SplitGamepad, MAX_OUTPUTS>& outputs) const;
+
+    // One-off split that binds on every call (tools and tests)
+    void split(int device, const ControllerState& state, std::array<SplitGamepad, MAX_OUTPUTS>& outputs) const {
+        split(bind(device, state), state, outputs);
+    }
+
+    OutputState& outputState(int device, int output) { return m_outputStates[device][output]; }
+
+    /**
+     * @brief Parse "usage:BUTTON,..." (e.g. "1:A,2:B,13:DPAD_UP")
+     */
+    static std::vector<std::pair<USAGE, WORD>> parseButtonList(const std::string& text);
+
+    /**
+     * @brief Parse "usage:FIELD,..." (e.g. "0x30:LX,0x31:LY")
+     */
+    static std::vector<std::pair<USAGE, SplitField>> parseAxisList(const std::string& text);
+
+private:
+    static constexpr uint8_t UNMAPPED = 0xFF;
+
+    struct AxisEntry {
+        USAGE usage;
+        uint8_t output;
+        SplitField field;
+    };
+
+    struct CompiledPlan {
+        std::wstring sourceMatch;
+        size_t outputCount = 0;
+        std::array<std::string, MAX_OUTPUTS> outputNames;
+        std::array<uint8_t, MAX_BUTTON_USAGE + 1> buttonOutput{};
+        std::array<WORD, MAX_BUTTON_USAGE + 1> buttonMask{};
+        std::vector<AxisEntry> axes;
+    };
+
+    std::array<CompiledPlan, MAX_DEVICES> m_plans;
+    std::array<std::array<OutputState, MAX_OUTPUTS>, MAX_DEVICES> m_outputStates{};
+    size_t m_deviceCount;
+};
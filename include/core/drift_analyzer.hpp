@@ -0,0 +1,165 @@
+/**
+ * @file drift_analyzer.hpp
+ * @brief Offline stick drift analysis of recorded sessions
+ *
+ * Describes every stick of every device in a recording: where it rests (the
+ * distribution of its resting center), how far it wanders around that center
+ * (noise radius), how far it reaches in eight directions (gate shape) and how
+ * regularly the device reported. From that it recommends per device a
+ * deadzone just wide enough to swallow the drift, an anti-deadzone that
+ * cancels the game's own deadzone, and a calibration (center offset and
+ * per-direction gain).
+ *
+ * Containers (.xrec) are memory-mapped and their chunks scanned in parallel
+ * on a WorkStealingPool. Each chunk's stick samples are gathered per device
+ * and run through the stickStats SIMD kernel and per-axis rest histograms;
+ * the per-thread partial results are merged once at the end. Text recordings
+ * are loaded and scanned in slices the same way.
+ */
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "core/recording_container.hpp"
+#include "core/session_recording.hpp"
+#include "core/simd_kernels.hpp"
+#include "utils/work_stealing_pool.hpp"
+
+/**
+ * @class DriftAnalyzer
+ * @brief Scans recordings for resting center, noise, gate shape and report timing
+ */
+class DriftAnalyzer {
+public:
+    static constexpr int LEFT_STICK = 0;
+    static constexpr int RIGHT_STICK = 1;
+    static constexpr uint32_t INTERVAL_BIN_US = 10;
+    static constexpr size_t INTERVAL_BINS = 10000;   // Up to 100 ms; longer gaps share the last bin
+
+    /**
+     * @struct Options
+     * @brief Analysis parameters
+     */
+    struct Options {
+        int32_t restWindow = 8192;        // Inside +-restWindow on both axes the stick counts as resting
+        double noisePercentile = 99.0;    // Share of resting samples the deadzone must cover
+        double margin = 1.2;              // Deadzone = margin * (center offset + noise radius)
+        float gameDeadzone = 0.0f;        // The game's own deadzone, cancelled by the anti-deadzone
+        size_t workers = 0;               // Pool threads besides the caller
+        uint32_t sliceFrames = 4096;      // Frames per task for in-memory recordings
+    };
+
+    /**
+     * @struct Interval
+     * @brief Time between consecutive samples of a device
+     */
+    struct Interval {
+        uint64_t count = 0;
+        double meanUs = 0.0;
+        double p50Us = 0.0;
+        double p99Us = 0.0;
+        uint64_t maxUs = 0;
+    };
+
+    /**
+     * @struct Stick
+     * @brief Findings and recommendations for one stick
+     */
+    struct Stick {
+        bool present = false;
+        uint64_t samples = 0;
+        uint64_t restSamples = 0;
+        double meanX = 0.0;               // Mean resting position
+        double meanY = 0.0;
+        int32_t medianX = 0;              // Median resting position (the center used below)
+        int32_t medianY = 0;
+        int32_t lowX = 0;                 // Resting distribution at 100 - noisePercentile ...
+        int32_t highX = 0;                // ... and at noisePercentile
+        int32_t lowY = 0;
+        int32_t highY = 0;
+        double noiseRadius = 0.0;         // Farthest percentile corner from the median center
+        int32_t extents[8] = {};          // Reach along +x, -x, +y, -y, x+y, x-y, y-x, -x-y (StickStats order)
+        double gateRatio = 0.0;           // Diagonal reach / axis reach: ~1.0 round gate, ~1.41 square
+        const char* gateShape = "unknown";
+        float deadzone = 0.0f;            // Recommended left/right_stick_deadzone
+        float antiDeadzone = 0.0f;        // Recommended left/right_stick_anti_deadzone
+        double gain[4] = {1.0, 1.0, 1.0, 1.0};   // Calibration for +x, -x, +y, -y from the median center
+    };
+
+    /**
+     * @struct Device
+     * @brief Findings for one recorded device
+     */
+    struct Device {
+        size_t index = 0;
+        SessionRecording::Device info;
+        uint64_t samples = 0;
+        Interval interval;
+        Stick sticks[2];
+    };
+
+    /**
+     * @struct Result
+     * @brief Everything one analysis found
+     */
+    struct Result {
+        std::vector<Device> devices;
+        uint64_t frames = 0;
+        uint64_t samples = 0;
+        size_t tasks = 0;                 // Chunks or slices scanned
+        double seconds = 0.0;             // Wall time of the scan and merge
+        const char* kernel = "";          // stickStats variant used
+    };
+
+    DriftAnalyzer();
+    explicit DriftAnalyzer(const Options& options);
+    ~DriftAnalyzer();
+
+    /**
+     * @brief Analyze a .xrec (memory-mapped) or .rec file
+     */
+    bool analyzeFile(const std::string& path, Result& result, std::string* error = nullptr);
+
+    /**
+     * @brief Analyze an open container; chunks run in parallel if it was opened over memory
+     */
+    bool analyze(const RecordingReader& reader, Result& result, std::string* error = nullptr);
+
+    bool analyze(const SessionRecording& recording, Result& result, std::string* error = nullptr);
+
+    const Options& getOptions() const { return m_options; }
+
+    /**
+     * @brief Human-readable report with suggested config.ini values
+     */
+    static void writeReport(const Result& result, std::ostream& out);
+
+private:
+    struct StickPartial;
+    struct DevicePartial;
+    struct Partial;
+    struct TaskEdges;
+    struct Layout;
+
+    using SampleSource = std::function<bool(const RecordingReader::SampleVisitor& visit, std::string* error)>;
+
+    bool run(const std::vector<SessionRecording::Device>& devices, size_t tasks,
+             const std::function<SampleSource(size_t task)>& sourceFor, Result& result, std::string* error);
+    void scanTask(const Layout& layout, const SampleSource& source, Partial& partial, TaskEdges& edges,
+                  std::string& error) const;
+    void finish(const Layout& layout, const std::vector<Partial*>& partials, const std::vector<TaskEdges>& edges,
+                Result& result) const;
+    Partial* acquirePartial(const Layout& layout);
+    void releasePartial(Partial* partial);
+
+    Options m_options;
+    WorkStealingPool m_pool;
+    std::mutex m_partialMutex;
+    std::vector<std::unique_ptr<Partial>> m_partials;   // One per concurrently running task, reused
+    std::vector<Partial*> m_freePartials;
+};
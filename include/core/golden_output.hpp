@@ -0,0 +1,79 @@
+/**
+ * @file golden_output.hpp
+ * @brief Golden output streams of replayed recordings, with tolerant comparison
+ *
+ * Rendering replays a SessionRecording through a fresh TranslationLayer
+ * configured from the recording's options, and encodes every translated
+ * state with both encoders (translateToXInput and translateToDInput). Each
+ * output becomes one record of named fields:
+ *
+ *     f=12 slot=1 user=-1 src=hid target=xinput pkt=12000 btn=0x1000 lt=0 rt=0
+ *       lx=-256 ly=512 rx=0 ry=0 dx=-256 dy=512 dz=-32768 drx=0 dry=0 drz=-32768
+ *       pov=4294967295 dbtn=0x1 gx=12 gy=-4 gz=0 ax=100 ay=8000 az=-300 mts=1024
+ *
+ * (one line per record; the motion fields are present only for a valid
+ * motion sample). Comparison is exact for identity and digital fields; stick
+ * axes, triggers and motion may differ by the tolerance stored in the golden
+ * file, so a faster kernel that rounds differently by one step still passes
+ * while a wrong mapping does not.
+ */
+#pragma once
+
+#include <cstddef>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+class SessionRecording;
+
+/**
+ * @class GoldenOutput
+ * @brief Output report stream of one recording
+ */
+class GoldenOutput {
+public:
+    static constexpr int FORMAT_VERSION = 1;
+
+    /**
+     * @struct Tolerance
+     * @brief Allowed absolute difference per analog field class
+     */
+    struct Tolerance {
+        int axis = 1;       // Stick axes, XInput and DirectInput (16-bit units)
+        int trigger = 1;    // Triggers (8-bit units; DirectInput Z/Rz scaled by 257)
+        int motion = 0;     // Gyro and accelerometer (raw sensor units)
+    };
+
+    struct Record {
+        std::vector<std::pair<std::string, std::string>> fields;
+    };
+
+    struct Mismatch {
+        size_t record;      // Index of the record (or of the first missing one)
+        std::string field;  // Empty for a structural difference
+        std::string expected;
+        std::string actual;
+    };
+
+    Tolerance tolerance;
+    std::vector<Record> records;
+
+    /**
+     * @brief Replay a recording and render its output stream
+     */
+    static bool render(const SessionRecording& recording, GoldenOutput& output, std::string* error = nullptr);
+
+    bool parse(std::istream& in, std::string* error = nullptr);
+    bool load(const std::string& path, std::string* error = nullptr);
+    void write(std::ostream& out) const;
+
+    /**
+     * @brief Compare an output stream against this golden stream using its tolerance
+     *
+     * @param maxMismatches Stop after this many differences
+     * @return Differences, empty if the streams match
+     */
+    std::vector<Mismatch> compare(const GoldenOutput& actual, size_t maxMismatches = 20) const;
+};
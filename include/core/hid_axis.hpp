@@ -0,0 +1,33 @@
+/**
+ * @file hid_axis.hpp
+ * @brief Scaling of HID Generic Desktop axes to gamepad stick and trigger ranges
+ *
+ * The generic HID mapping, the device splitter and the drift analyzer all turn
+ * a reported axis value into an XInput stick or trigger value from the axis'
+ * logical range; they share these helpers so a device reads the same in every
+ * path.
+ */
+#pragma once
+
+#include "core/input_capture.hpp"
+
+class HidAxis {
+public:
+    // Logical range assumed for an axis the device has no value cap for
+    static constexpr LONG DEFAULT_LOGICAL_MIN = 0;
+    static constexpr LONG DEFAULT_LOGICAL_MAX = 65535;
+
+    struct Range {
+        LONG logicalMin = DEFAULT_LOGICAL_MIN;
+        LONG logicalMax = DEFAULT_LOGICAL_MAX;
+    };
+
+    // Logical range of a Generic Desktop usage from the device's value caps
+    static Range findRange(const ControllerState& state, USAGE usage);
+
+    // Normalize [logicalMin, logicalMax] to -32768..32767 (invert for HID Y, which grows downwards)
+    static SHORT toStick(LONG value, const Range& range, bool invert);
+
+    // Normalize [logicalMin, logicalMax] to 0..255
+    static BYTE toTrigger(LONG value, const Range& range);
+};
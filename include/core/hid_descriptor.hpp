@@ -0,0 +1,146 @@
+/**
+ * @file hid_descriptor.hpp
+ * @brief Portable HID report descriptor parser and input report decoder
+ *
+ * Off Windows there is no HidP_* API to interpret input reports, so this
+ * module does the part of it the capture path needs: it walks the report
+ * descriptor once (global/local/main items, report IDs, push/pop) and lays
+ * out every input field as a bit offset inside its report. Decoding a report
+ * is then a few shifts per field.
+ *
+ * The decoded form matches what InputCapture stores on Windows, so the same
+ * TranslationLayer code reads it:
+ * - Button page usages that are set go to m_activeButtons (replaced by every
+ *   report that carries buttons)
+ * - Every other variable input goes to m_hidValues keyed by usage, as the raw
+ *   unsigned field value (HidP_GetUsageValue semantics)
+ * - Value fields are also exported as HIDP_VALUE_CAPS for axis normalization
+ *
+ * Like HidP_GetUsageValue, a main item with more elements than usages (a
+ * vendor blob such as the DS4's 54 bytes under one usage) is not decoded as
+ * values; motion data in those bytes goes through MotionReportPlan instead.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "core/input_capture.hpp"
+
+/**
+ * @class HidReportDescriptor
+ * @brief Input field layout of one device, built from its report descriptor
+ */
+class HidReportDescriptor {
+public:
+    static constexpr USAGE BUTTON_PAGE = 0x09;
+
+    /**
+     * @struct ValueField
+     * @brief One variable input element other than a button
+     */
+    struct ValueField {
+        uint8_t reportId;
+        uint32_t bitOffset;      // From the start of the report buffer (the ID byte included)
+        uint8_t bitSize;
+        USAGE usagePage;
+        USAGE usage;
+        LONG logicalMin;
+        LONG logicalMax;
+        bool hasNull;
+    };
+
+    /**
+     * @struct ButtonField
+     * @brief One single-bit button input
+     */
+    struct ButtonField {
+        uint8_t reportId;
+        uint32_t bitOffset;
+        USAGE usage;
+    };
+
+    /**
+     * @struct ButtonArrayField
+     * @brief Array input on the button page (each element holds a pressed usage index)
+     */
+    struct ButtonArrayField {
+        uint8_t reportId;
+        uint32_t bitOffset;
+        uint8_t bitSize;
+        uint16_t count;
+        USAGE usageMin;
+        USAGE usageMax;
+        LONG logicalMin;
+    };
+
+    HidReportDescriptor();
+
+    /**
+     * @brief Parse a report descriptor, replacing any previous layout
+     * @return false if the descriptor is malformed (see getError())
+     */
+    bool parse(const uint8_t* descriptor, size_t length);
+
+    const std::string& getError() const { return m_error; }
+
+    // Top-level application collection (e.g. Generic Desktop / Game Pad)
+    USAGE getUsagePage() const { return m_usagePage; }
+    USAGE getUsage() const { return m_usage; }
+
+    bool usesReportIds() const { return m_usesReportIds; }
+
+    /**
+     * @brief Input report length in bytes (including the ID byte when IDs are used), 0 if unknown
+     */
+    size_t getInputReportLength(uint8_t reportId) const;
+    size_t getMaxInputReportLength() const;
+
+    const std::vector<ValueField>& getValueFields() const { return m_values; }
+    const std::vector<ButtonField>& getButtonFields() const { return m_buttons; }
+    const std::vector<ButtonArrayField>& getButtonArrays() const { return m_buttonArrays; }
+
+    /**
+     * @brief Value caps equivalent to HidP_GetValueCaps (one per value field)
+     */
+    std::vector<HIDP_VALUE_CAPS> buildValueCaps() const;
+
+    /**
+     * @brief Summary caps equivalent to HidP_GetCaps for the input side
+     */
+    HIDP_CAPS buildCaps() const;
+
+    /**
+     * @brief Decode one input report into the controller state
+     *
+     * Fields that do not fit in @p length are skipped. Motion is extracted
+     * when the state has a motion plan.
+     *
+     * @return false if the report ID is not an input report of this device
+     */
+    bool decode(const uint8_t* report, size_t length, ControllerState& state) const;
+
+    /**
+     * @brief Read an unsigned little-endian bit field (at most 32 bits)
+     */
+    static uint32_t readBits(const uint8_t* report, size_t length, uint32_t bitOffset, uint8_t bitSize);
+
+private:
+    struct ReportLayout {
+        uint8_t reportId;
+        uint32_t bits;           // Input bits after the ID byte
+    };
+
+    uint32_t& inputCursor(uint8_t reportId);
+    uint32_t reportBase() const { return m_usesReportIds ? 8u : 0u; }
+
+    std::vector<ValueField> m_values;
+    std::vector<ButtonField> m_buttons;
+    std::vector<ButtonArrayField> m_buttonArrays;
+    std::vector<ReportLayout> m_reports;
+    USAGE m_usagePage;
+    USAGE m_usage;
+    bool m_usesReportIds;
+    std::string m_error;
+};
@@ -0,0 +1,137 @@
+/**
+ * @file hidraw_source.hpp
+ * @brief Linux capture backend reading HID devices through /dev/hidraw*
+ *
+ * The Linux counterpart of the HID half of InputCapture. Each device node is
+ * opened non-blocking; its report descriptor (HIDIOCGRDESC) is parsed by
+ * HidReportDescriptor, and name and IDs come from HIDIOCGRAWNAME and
+ * HIDIOCGRAWINFO. All nodes sit in one epoll set, so a capture thread sleeps
+ * in epoll_wait() until a report arrives instead of polling on a timer, then
+ * drains every ready node and decodes the reports into ControllerState the
+ * same way InputCapture does on Windows. The translation pipeline needs no
+ * changes to consume it.
+ *
+ * Two ways to drive it:
+ * - update(): non-blocking, reads whatever arrived since the last frame
+ *   (what Pipeline::runFrame() does)
+ * - start(): a capture thread blocked in epoll_wait(); update() then only
+ *   publishes, and each report is timestamped the moment it is read
+ *
+ * An unplugged device is reported once as disconnected (no buttons, no
+ * values) so the pipeline releases its virtual pad, then left out of
+ * getInputStates(). Its entry is reused when the same node is opened again,
+ * so rescans never duplicate a device.
+ *
+ * addStream() takes an already open descriptor plus a report descriptor, so
+ * tests and machines without /dev/uhid can feed recorded reports through a
+ * SOCK_SEQPACKET socket (one read per report, like hidraw).
+ */
+#pragma once
+
+#ifdef __linux__
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "core/hid_descriptor.hpp"
+#include "core/input_source.hpp"
+#include "core/input_capture.hpp"
+
+/**
+ * @class HidrawInputSource
+ * @brief Event-driven hidraw reader producing HID controller states
+ */
+class HidrawInputSource : public InputSource {
+public:
+    HidrawInputSource();
+    ~HidrawInputSource() override;
+
+    HidrawInputSource(const HidrawInputSource&) = delete;
+    HidrawInputSource& operator=(const HidrawInputSource&) = delete;
+
+    /**
+     * @brief Open every hidraw* node in a directory that is not open yet
+     * @return Number of devices added
+     */
+    size_t scan(const std::string& directory = "/dev");
+
+    /**
+     * @brief Open one hidraw node and read its descriptor, name and IDs
+     */
+    bool openDevice(const std::string& path);
+
+    /**
+     * @brief Add a report stream that is not a hidraw node (takes ownership of fd)
+     *
+     * Every read() on @p fd must return exactly one input report.
+     */
+    bool addStream(int fd, const std::vector<uint8_t>& descriptor, const std::string& name,
+                   uint16_t vendorId, uint16_t productId, const std::string& path);
+
+    /**
+     * @brief Wait up to timeoutMs (-1: until a report or wake()) and read all ready reports
+     * @return Reports decoded
+     */
+    size_t poll(int timeoutMs);
+
+    /**
+     * @brief Make a blocked poll() return
+     */
+    void wake();
+
+    /**
+     * @brief Run poll(-1) on a capture thread until stop()
+     */
+    void start();
+    void stop();
+    bool isRunning() const { return m_running; }
+
+    void update(double deltaTime) override;
+    std::vector<ControllerState> getInputStates() const override;
+
+    // Device entries, including unplugged ones waiting to be reused
+    size_t getDeviceCount() const;
+
+    /**
+     * @brief When the newest report of a device entry was read (microseconds, TimingUtils clock)
+     */
+    uint64_t lastReportUs(size_t device) const;
+    uint64_t getReportCount(size_t device) const;
+
+    /**
+     * @brief HIDIOCGRDESCSIZE + HIDIOCGRDESC on an open hidraw node
+     */
+    static bool readDescriptor(int fd, std::vector<uint8_t>& descriptor);
+
+    static uint64_t nowUs();
+
+private:
+    struct Device {
+        int fd;
+        std::string path;
+        HidReportDescriptor descriptor;
+        ControllerState state;
+        uint64_t lastReportUs;
+        uint64_t reports;
+        bool disconnectReported = false;   // Closed and already published once as disconnected
+    };
+
+    bool addDevice(int fd, const std::vector<uint8_t>& descriptor, const std::string& name,
+                   uint16_t vendorId, uint16_t productId, const std::string& path, const std::string& instanceId);
+    size_t drain(Device& device);
+    void closeDevice(Device& device);
+
+    int m_epoll;
+    int m_wakeFd;
+    std::atomic<bool> m_running;
+    std::thread m_thread;
+
+    mutable std::mutex m_mutex;     // Guards m_devices while the capture thread runs
+    std::vector<std::unique_ptr<Device>> m_devices;
+};
+
+#endif // __linux__
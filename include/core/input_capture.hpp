@@ -14,13 +14,16 @@
 #include <atomic>
 #include <mutex>
 #include "utils/logger.hpp"
+#include "core/motion.hpp"
+#include "core/xinput_slot_scheduler.hpp"
+#include "core/polling_scheduler.hpp"
+#include "core/report_phase.hpp"
+#include "core/input_source.hpp"
 
-// Windows headers
-#include <windows.h>
-#include <xinput.h>
-#include <hidsdi.h>
-#include <setupapi.h>
-#include <guiddef.h>
+class SourceArbiter;
+
+// Windows headers (or their portable subset off Windows)
+#include "utils/platform.hpp"
 
 // GameInput API (for Windows 11)
 #ifdef __cplusplus_winrt
@@ -47,12 +50,19 @@ struct ControllerState {
     std::wstring devicePath;
     std::wstring deviceInstanceId; // Unique system ID for HidHide
     std::wstring productName; // Friendly name
+    USHORT vendorId = 0; // 0 when unknown (profiles then match by name only)
+    USHORT productId = 0;
+    USHORT versionNumber = 0; // 0 when unknown (versioned profiles then fall back to vid:pid)
     bool isConnected;
     DWORD lastError; // Store API error code for debugging
     
     // Raw HID Data (Captured during poll)
     std::vector<USAGE> m_activeButtons;
     std::unordered_map<USAGE, LONG> m_hidValues;
+
+    // Motion sensors (vendor-defined report bytes, see core/motion.hpp)
+    MotionReportPlan motionPlan;
+    MotionState motion;
     
     // For XInput source, we still keep the xinputState above.
     // XInput state is already captured in xinputState.Gamepad.
@@ -97,7 +107,7 @@ struct ControllerState {
  * - Sub-millisecond polling latency
  * - Vibration/rumble output support
  */
-class InputCapture {
+class InputCapture : public InputSource {
 public:
     InputCapture();
     ~InputCapture();
@@ -105,8 +115,8 @@ public:
     bool initialize();
     void shutdown();
     
-    void update(double deltaTime);
-    std::vector<ControllerState> getInputStates() const;
+    void update(double deltaTime) override;
+    std::vector<ControllerState> getInputStates() const override;
     
     // Device management
     void refreshDevices();
@@ -116,6 +126,30 @@ public:
     void lockStates() const { m_statesMutex.lock(); }
     void unlockStates() const { m_statesMutex.unlock(); }
     
+    // Source arbitration for pads readable through both XInput and HID
+    // (set before initialize(); the arbiter is guarded by lockStates())
+    void setSourceArbitrationEnabled(bool enabled) { m_sourceArbitrationEnabled = enabled; }
+    bool isSourceArbitrationEnabled() const { return m_sourceArbitrationEnabled; }
+    const SourceArbiter* getSourceArbiter() const { return m_sourceArbiter.get(); }
+    
+    // Per-device polling groups (set before initialize())
+    void setPollingGroups(bool enabled, uint32_t baseRateHz, const std::vector<PollingRateOverride>& overrides);
+    bool isPollingGroupsEnabled() const { return m_pollingGroupsEnabled; }
+    uint64_t getNextPollDeadlineUs() const;
+    PollingScheduler::DeviceTiming getPollingTiming(size_t index) const;
+    PollingScheduler::GroupStats getPollingGroupStats(size_t rateClass) const;
+    
+    // Phase-aligned sampling: wake just before the fastest HID device's report
+    void setPhaseAlignedSampling(bool enabled);
+    bool isPhaseAlignedSampling() const { return m_phaseAlignedEnabled; }
+    PhaseAlignedPacer::WakePlan planPhaseWake(uint64_t lastWakeUs, uint64_t regularWakeUs) const;
+    void watchPhaseAnchor(const PhaseAlignedPacer::WakePlan& plan);
+    ReportPhaseEstimator getPhaseEstimate(size_t index) const;
+    int getPhaseAnchor() const;
+    
+    // XInput slot presence scheduling (poll cost per slot)
+    XInputSlotScheduler::SlotStats getSlotStats(size_t slot) const { return m_slotScheduler.getStats(slot); }
+    
     // Output control
     void setVibration(int userId, float leftMotor, float rightMotor);
     
@@ -135,6 +169,11 @@ private:
     bool initializeHID();
     void pollXInputControllers();
     void pollHIDControllers();
+    bool pollHIDDevice(size_t index);
+    void recordPollingService(size_t index, bool newReport);
+    void recordPhaseSample(size_t index, bool newReport);
+    bool openArbitrationReader(ControllerState& state);
+    void closeArbitrationReader(ControllerState& state);
 
     mutable std::mutex m_statesMutex;
     std::vector<ControllerState> m_controllerStates;
@@ -148,6 +187,22 @@ private:
     // Device enumeration
     std::vector<std::wstring> m_hidDevicePaths;
 
+    // Rate classes with independent deadlines
+    bool m_pollingGroupsEnabled;
+    PollingScheduler m_pollingScheduler;
+
+    // Report period/phase per HID device, and when each was last read
+    bool m_phaseAlignedEnabled;
+    PhaseAlignedPacer m_phasePacer;
+    std::vector<uint64_t> m_phaseLastLookUs;
+
+    // Skips XInputGetState on empty slots until their probe is due
+    XInputSlotScheduler m_slotScheduler;
+
+    // XInput/HID arbitration
+    bool m_sourceArbitrationEnabled;
+    std::unique_ptr<SourceArbiter> m_sourceArbiter;
+
     // HID Parsing helpers
     void parseHIDReport(ControllerState& state, PCHAR report, ULONG reportLength);
     void getHIDUsages(ControllerState& state, PCHAR report, ULONG reportLength);
@@ -0,0 +1,163 @@
+/**
+ * @file input_merger.hpp
+ * @brief Many-to-one merging of physical devices into one virtual controller
+ *
+ * Sim-racing and arcade setups split one logical controller across several
+ * HID devices (pedals, shifter, button box). A merge group combines those
+ * sources into a single virtual target with a per-field merge policy.
+ *
+ * Each source publishes its latest translated frame into a seqlock slot, so
+ * producers never block and the consumer always merges the newest frame of
+ * every source, regardless of how fast each device reports.
+ */
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <string>
+#include <vector>
+#include "core/translation_layer.hpp"
+
+/**
+ * @enum MergePolicy
+ * @brief How one gamepad field is combined across the sources of a group
+ */
+enum class MergePolicy {
+    OR,            // Bitwise OR (buttons); behaves like MAX for analog fields
+    MAX,           // Largest value (triggers) or largest deflection (sticks)
+    LAST_CHANGED,  // Value from the source that changed this field most recently
+    PRIORITY       // First source (in configured order) with a non-neutral value
+};
+
+/**
+ * @struct MergeGroupConfig
+ * @brief One merged virtual controller and the sources that feed it
+ */
+struct MergeGroupConfig {
+    std::string name;
+    // Product name or device instance ID substrings, in priority order
+    std::vector<std::wstring> sourceMatches;
+    MergePolicy buttons = MergePolicy::OR;
+    MergePolicy triggers = MergePolicy::MAX;
+    MergePolicy sticks = MergePolicy::MAX;
+};
+
+/**
+ * @class InputMerger
+ * @brief Combines several source devices into one report per frame
+ *
+ * Usage from the main loop:
+ * - DeviceManager asks findGroup() to create one virtual device per group
+ *   (userId = virtualUserId(group)) instead of one per member device
+ * - apply() publishes the member states of a translated frame, removes them
+ *   and appends one merged state per active group
+ *
+ * publish() may also be called directly from capture threads; it is
+ * wait-free for the producer. compose() must only be called from one thread.
+ */
+class InputMerger {
+public:
+    static constexpr int MERGED_USER_ID_BASE = 100;
+    static constexpr size_t MAX_GROUPS = 4;
+    static constexpr size_t MAX_SOURCES_PER_GROUP = 8;
+
+    InputMerger();
+
+    /**
+     * @brief Set the merge groups (call before any publish/compose)
+     */
+    void configure(const std::vector<MergeGroupConfig>& groups);
+
+    bool isEnabled() const { return m_groupCount > 0; }
+    size_t getGroupCount() const { return m_groupCount; }
+    const MergeGroupConfig& getGroup(size_t group) const { return m_groups[group].config; }
+    static int virtualUserId(int group) { return MERGED_USER_ID_BASE + group; }
+
+    /**
+     * @brief Find the merge group a physical device belongs to
+     *
+     * @param state Captured controller state
+     * @param sourceIndex Optional output: priority index of the matched source
+     * @return Group index, or -1 if the device is not merged
+     */
+    int findGroup(const ControllerState& state, int* sourceIndex = nullptr) const;
+
+    /**
+     * @brief Publish the latest frame of one source (wait-free, one writer per source)
+     */
+    void publish(int group, int source, const TranslatedState& state);
+
+    /**
+     * @brief Mark a source as gone so it stops contributing to the merge
+     */
+    void clearSource(int group, int source);
+
+    /**
+     * @brief Merge the latest frame of every present source of a group
+     *
+     * @param group Group index
+     * @param merged Output state (sourceUserId = virtualUserId(group))
+     * @return false if no source of the group has published a frame
+     */
+    bool compose(int group, TranslatedState& merged);
+
+    /**
+     * @brief Replace member states in a translated frame with merged states
+     *
+     * @param inputStates Captured states (indexed by TranslatedState::sourceSlot)
+     * @param translatedStates Translated frame, modified in place
+     */
+    void apply(const std::vector<ControllerState>& inputStates, std::vector<TranslatedState>& translatedStates);
+
+    static MergePolicy parsePolicy(const std::string& name, MergePolicy defaultPolicy);
+
+private:
+    // Field order inside a merged frame
+    enum Field { F_BUTTONS, F_LT, F_RT, F_LX, F_LY, F_RX, F_RY, FIELD_COUNT };
+
+    // Seqlock slot holding the latest frame of one source
+    struct SourceSlot {
+        std::atomic<uint32_t> sequence{0};
+        std::atomic<uint64_t> fields{0};    // buttons | lt | rt | lx | ly
+        std::atomic<uint64_t> fieldsExt{0}; // rx | ry | target type | present
+        std::atomic<uint64_t> timestamp{0};
+    };
+
+    // Consumer-side change tracking for LAST_CHANGED
+    struct SourceHistory {
+        std::array<int32_t, FIELD_COUNT> lastValue{};
+        std::array<uint64_t, FIELD_COUNT> lastChange{};
+    };
+
+    struct Group {
+        MergeGroupConfig config;
+        std::array<MergePolicy, FIELD_COUNT> policy{};
+        size_t sourceCount = 0;
+        std::array<SourceSlot, MAX_SOURCES_PER_GROUP> slots;
+        std::array<SourceHistory, MAX_SOURCES_PER_GROUP> history;
+    };
+
+    struct Frame {
+        std::array<int32_t, FIELD_COUNT> values;
+        uint64_t timestamp;
+        int targetType;
+        bool present;
+    };
+
+    // Group membership of the device last seen in one input slot
+    struct SlotMembership {
+        std::wstring instanceId;
+        int group = -1;
+        int source = -1;
+        bool resolved = false;
+    };
+
+    bool readSlot(const SourceSlot& slot, Frame& frame) const;
+
+    // findGroup() for the device in an input slot, cached until the slot changes device
+    int groupForSlot(size_t slot, const ControllerState& state, int* sourceIndex);
+
+    std::array<Group, MAX_GROUPS> m_groups;
+    size_t m_groupCount;
+    std::vector<SlotMembership> m_slotMembership;
+};
@@ -0,0 +1,30 @@
+/**
+ * @file input_source.hpp
+ * @brief Capture-side interface of the proxy pipeline
+ *
+ * The proxy loop needs two things from capture: advance it (poll devices for
+ * new reports) and take a snapshot of the controller states. InputCapture
+ * implements this against XInput and HID; SyntheticInputSource generates
+ * states in-process so the rest of the pipeline (translation, merge, inject)
+ * can be driven and measured without hardware.
+ */
+#pragma once
+
+#include <vector>
+
+struct ControllerState;
+
+/**
+ * @class InputSource
+ * @brief Produces controller states for TranslationLayer::translate()
+ */
+class InputSource {
+public:
+    virtual ~InputSource() = default;
+
+    // Poll for new reports (deltaTime: microseconds since the previous update)
+    virtual void update(double deltaTime) = 0;
+
+    // Snapshot of the current controller states
+    virtual std::vector<ControllerState> getInputStates() const = 0;
+};
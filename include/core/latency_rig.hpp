@@ -0,0 +1,118 @@
+/**
+ * @file latency_rig.hpp
+ * @brief End-to-end latency measurement of the pipeline without hardware
+ *
+ * Drives a Pipeline with a SyntheticInputSource and a probe VirtualBus, so
+ * capture update, translate, merge, output shaping and the target health
+ * monitor are the proxy's own code; the rig only paces the loop. The probe
+ * records when each button edge reaches the virtual bus. Edge latency is
+ * measured from the moment the edge's report became available to capture to
+ * the moment its submit reached the bus, so it includes the capture pacing
+ * delay as well as the pipeline.
+ *
+ * Scenarios vary the loop pacing (fixed sleep, spin, phase-aligned), the
+ * injection threading (submit inline from the loop, or hand off to an inject
+ * thread) and the number of controllers.
+ */
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "core/synthetic_source.hpp"
+#include "core/target_health.hpp"
+
+/**
+ * @class LatencyRig
+ * @brief Runs latency scenarios and summarizes the edge latency distribution
+ */
+class LatencyRig {
+public:
+    enum class Pacing {
+        FIXED,          // Sleep until the next loop interval (the default proxy loop)
+        SPIN,           // Yield-spin until the next loop interval
+        PHASE_ALIGNED   // Wake just before the fastest locked device's next report
+    };
+
+    enum class Threading {
+        INLINE,         // The loop submits to the bus itself (VirtualDeviceEmulator::sendInput)
+        INJECT_THREAD   // The loop queues states for the pipeline's injection thread
+    };
+
+    struct Scenario {
+        Pacing pacing = Pacing::FIXED;
+        Threading threading = Threading::INLINE;
+        size_t controllers = 1;
+        uint32_t loopHz = 1000;
+        uint32_t reportRateHz = 1000;
+        uint32_t reportsPerEdge = 8;
+        uint32_t durationMs = 1000;
+        bool outputShaping = false;
+    };
+
+    /**
+     * @struct Result
+     * @brief Edge latency distribution of one scenario (microseconds)
+     */
+    struct Result {
+        Scenario scenario;
+        size_t edges = 0;            // Generated
+        size_t delivered = 0;        // Reached the bus
+        size_t sequenceErrors = 0;   // Delivered with a sequence number outside the edge's report span
+        double meanUs = 0.0;
+        double p50Us = 0.0;
+        double p90Us = 0.0;
+        double p99Us = 0.0;
+        double maxUs = 0.0;
+        uint64_t loopFrames = 0;
+    };
+
+    static Result run(const Scenario& scenario);
+
+    /**
+     * @brief Fill mean and percentiles from edge latencies (sorts them)
+     */
+    static void summarize(std::vector<double>& latencies, Result& result);
+
+    static const char* pacingName(Pacing pacing);
+    static const char* threadingName(Threading threading);
+    static std::string describe(const Scenario& scenario);
+};
+
+/**
+ * @class EdgeProbeBus
+ * @brief Virtual bus that records when each A-button edge arrives, per target
+ *
+ * Arrivals are recorded per source user id, which is the synthetic
+ * controller index of the source feeding the pipeline.
+ */
+class EdgeProbeBus : public VirtualBus {
+public:
+    struct Arrival {
+        uint16_t sequence;
+        bool pressed;
+        uint64_t arrivedUs;
+    };
+
+    explicit EdgeProbeBus(size_t targets);
+
+    bool submit(int targetId, const TranslatedState& state) override;
+    bool replug(int targetId) override;
+
+    std::vector<std::vector<Arrival>> arrivals() const;
+
+    /**
+     * @brief Pair the k-th generated edge of each controller with the k-th arrival
+     *
+     * Counts edges, deliveries and sequence errors into result and appends
+     * one latency per delivered edge that is not a sequence error.
+     */
+    void match(const std::vector<SyntheticInputSource::Edge>& edges, uint32_t reportsPerEdge,
+               LatencyRig::Result& result, std::vector<double>& latencies) const;
+
+private:
+    mutable std::mutex m_mutex;
+    std::vector<bool> m_pressed;
+    std::vector<std::vector<Arrival>> m_arrivals;
+};
@@ -0,0 +1,136 @@
+/**
+ * @file motion.hpp
+ * @brief Motion sensor extraction and gyro-to-stick mapping
+ *
+ * DualShock 4 and DualSense controllers carry gyroscope and accelerometer data
+ * in vendor-defined bytes of their input reports, which the HID value caps do
+ * not describe. This module resolves a per-device report plan (byte offsets for
+ * each report ID the device sends) and extracts the motion block from the raw
+ * report. It also provides an integer-only gyro-to-right-stick mapper.
+ *
+ * Everything here is plain integer math on raw buffers so it runs in the
+ * capture path at a few nanoseconds per report.
+ */
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @struct MotionState
+ * @brief Raw motion sensor sample in DualShock 4 conventions
+ */
+struct MotionState {
+    int16_t gyro[3];          // Pitch, yaw, roll (raw sensor units)
+    int16_t accel[3];         // X, Y, Z (raw sensor units)
+    uint16_t sensorTimestamp; // DS4 timestamp units (5.33 us)
+    bool valid;               // False if the last report carried no motion block
+};
+
+/**
+ * @struct MotionReportLayout
+ * @brief Location of the motion block inside one input report
+ *
+ * Offsets are relative to the start of the buffer returned by the HID read,
+ * i.e. byte 0 is the report ID.
+ */
+struct MotionReportLayout {
+    uint8_t reportId;
+    uint8_t gyroOffset;       // Three little-endian int16 values
+    uint8_t accelOffset;      // Three little-endian int16 values
+    uint8_t timestampOffset;
+    uint8_t timestampShift;   // Right shift to convert the native timestamp to DS4 units
+    bool timestamp32;         // Native timestamp is 32-bit (DualSense) rather than 16-bit (DS4)
+    uint8_t minLength;        // Reports shorter than this carry no motion (e.g. DS4 BT 0x01)
+};
+
+/**
+ * @struct MotionReportPlan
+ * @brief Per-device list of report layouts that carry motion data
+ *
+ * Resolved once from the USB vendor/product IDs when a device is opened.
+ * An empty plan (layoutCount == 0) means the device has no known motion data.
+ */
+struct MotionReportPlan {
+    static constexpr size_t MAX_LAYOUTS = 2; // USB + Bluetooth report formats
+    MotionReportLayout layouts[MAX_LAYOUTS];
+    uint8_t layoutCount;
+
+    bool hasMotion() const { return layoutCount > 0; }
+
+    /**
+     * @brief Build the report plan for a device
+     *
+     * @param vendorId USB vendor ID
+     * @param productId USB product ID
+     * @return Plan with the known layouts (empty for devices without motion)
+     */
+    static MotionReportPlan forDevice(uint16_t vendorId, uint16_t productId);
+};
+
+/**
+ * @brief Extract the motion block from a raw input report
+ *
+ * @param plan Device report plan
+ * @param report Raw report buffer (byte 0 = report ID)
+ * @param length Number of valid bytes in the buffer
+ * @param motion Output sample; motion.valid is cleared if the report has no motion
+ * @return true if a motion sample was extracted
+ */
+bool extractMotion(const MotionReportPlan& plan, const uint8_t* report, size_t length, MotionState& motion);
+
+/**
+ * @struct GyroFilterState
+ * @brief Per-controller smoothing state for the gyro mapper
+ */
+struct GyroFilterState {
+    int32_t smoothX; // Q8 fixed-point
+    int32_t smoothY; // Q8 fixed-point
+};
+
+/**
+ * @class GyroStickMapper
+ * @brief Maps gyroscope rotation onto right stick deflection
+ *
+ * Yaw drives the stick X axis and pitch drives the Y axis. Per sample:
+ * - Deadzone: rotation below the threshold is dropped, larger rotation is
+ *   shifted down by the threshold so there is no jump at the edge
+ * - Smoothing: exponential moving average in Q8 fixed-point
+ * - Sensitivity: Q8 fixed-point gain from gyro units to stick units
+ * - Ratchet: while any ratchet button is held the gyro is disengaged and the
+ *   smoothing state is cleared, so the player can re-center like lifting a mouse
+ *
+ * The result is added to the physical stick value and saturated to int16.
+ * Floating-point settings are converted once in the setters; the per-report
+ * path is integer-only.
+ */
+class GyroStickMapper {
+public:
+    GyroStickMapper();
+
+    void setSensitivity(float sensitivity);  // Stick units per gyro unit
+    void setSmoothing(float smoothing);      // 0.0 (none) to 0.95 (heavy)
+    void setDeadzone(int deadzone);          // Raw gyro units
+    void setRatchetButtons(uint16_t buttons); // XInput button mask, 0 = no ratchet
+
+    float getSensitivity() const { return static_cast<float>(m_sensitivityQ8) / 256.0f; }
+    uint16_t getRatchetButtons() const { return m_ratchetButtons; }
+
+    /**
+     * @brief Apply gyro rotation to a stick
+     *
+     * @param motion Motion sample (ignored if not valid)
+     * @param buttons Current XInput button state (for the ratchet)
+     * @param filter Per-controller smoothing state
+     * @param stickX Right stick X, modified in place
+     * @param stickY Right stick Y, modified in place
+     */
+    void apply(const MotionState& motion, uint16_t buttons, GyroFilterState& filter,
+               int16_t& stickX, int16_t& stickY) const;
+
+private:
+    int32_t m_sensitivityQ8;
+    int32_t m_alphaQ8;       // EMA weight of the new sample (256 = no smoothing)
+    int32_t m_deadzone;
+    uint16_t m_ratchetButtons;
+};
@@ -0,0 +1,126 @@
+/**
+ * @file output_shaper.hpp
+ * @brief Per-virtual-device output rate shaping for the inject stage
+ *
+ * The capture loop runs at up to several kHz while games read XInput or the
+ * DS4 report at 60-240 Hz, so submitting every frame mostly produces driver
+ * calls nobody reads. The shaper sits in front of the ViGEm submit:
+ *
+ * - Reports identical to the last one submitted are dropped.
+ * - Digital edges (a button or a trigger crossing its threshold) are
+ *   submitted immediately, so a press is never delayed.
+ * - Pure analog motion (sticks, trigger travel, motion sensors) is coalesced:
+ *   the newest state is held until the device's next deadline, at most
+ *   maxRateHz submits per second, and is flushed even if input stops.
+ *
+ * Deadlines are kept per virtual device, so a busy pad does not hold back
+ * another. Offers come from the capture thread and flushes from the inject
+ * thread, so all state is guarded by an internal mutex.
+ *
+ * The shaper records a state as submitted when it releases it, so released
+ * states must reach the driver in release order: a held state flushed by
+ * takeDue() and sent after a newer edge would leave the pad on the stale
+ * state, with identical later frames dropped as UNCHANGED. When offers and
+ * flushes run on different threads, release and queue each state under one
+ * caller lock and send from a single thread.
+ */
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <utility>
+#include <vector>
+#include "core/translation_layer.hpp"
+
+/**
+ * @class OutputShaper
+ * @brief Decides which translated states reach the virtual device driver
+ */
+class OutputShaper {
+public:
+    static constexpr BYTE TRIGGER_EDGE_THRESHOLD = 30;  // XINPUT_GAMEPAD_TRIGGER_THRESHOLD
+
+    enum class Decision {
+        SUBMIT,      // Send now
+        COALESCE,    // Held until the device's deadline; newer analog state replaces it
+        UNCHANGED    // Same as the last submitted report
+    };
+
+    /**
+     * @struct Metrics
+     * @brief Submit counters of one virtual device
+     */
+    struct Metrics {
+        uint64_t offered = 0;
+        uint64_t submitted = 0;   // Driver calls, including edges and flushes
+        uint64_t edges = 0;       // Submitted immediately for a digital edge
+        uint64_t flushed = 0;     // Held analog state submitted at its deadline
+        uint64_t coalesced = 0;   // Analog reports absorbed without a driver call
+        uint64_t unchanged = 0;   // Dropped as identical to the last submit
+    };
+
+    OutputShaper();
+
+    /**
+     * @brief Cap on submits per second per device for analog-only changes (0 = no cap)
+     */
+    void setMaxRateHz(uint32_t hz);
+    uint32_t getMaxRateHz() const;
+
+    /**
+     * @brief Offer the newest translated state of one virtual device
+     *
+     * On COALESCE the state is kept and later returned by takeDue().
+     */
+    Decision offer(const TranslatedState& state, uint64_t nowUs);
+
+    /**
+     * @brief Collect held states whose deadline has passed (counted as submitted)
+     */
+    std::vector<TranslatedState> takeDue(uint64_t nowUs);
+
+    /**
+     * @brief Earliest deadline of any held state, or UINT64_MAX
+     */
+    uint64_t nextDeadlineUs() const;
+
+    /**
+     * @brief Forget a device (destroyed, or its submit failed and must be resent)
+     */
+    void forget(TranslatedState::TargetType type, int userId);
+
+    Metrics getMetrics(TranslatedState::TargetType type, int userId) const;
+
+    /**
+     * @brief True when the change between two states includes a digital edge
+     */
+    static bool hasDigitalEdge(const TranslatedState& previous, const TranslatedState& next);
+
+    /**
+     * @brief True when two states would produce the same driver report
+     */
+    static bool sameReport(const TranslatedState& a, const TranslatedState& b);
+
+private:
+    using Key = std::pair<int, int>;  // Target type, userId
+
+    struct Device {
+        bool hasSubmitted = false;
+        TranslatedState lastSubmitted{};
+        bool hasPending = false;
+        TranslatedState pending{};
+        uint64_t nextSubmitUs = 0;    // Earliest time an analog-only change may be sent
+        Metrics metrics;
+    };
+
+    static Key keyOf(TranslatedState::TargetType type, int userId) {
+        return {static_cast<int>(type), userId};
+    }
+    void markSubmitted(Device& device, const TranslatedState& state, uint64_t nowUs);
+
+    mutable std::mutex m_mutex;
+    uint32_t m_maxRateHz;
+    uint64_t m_minIntervalUs;
+    std::map<Key, Device> m_devices;
+};
@@ -0,0 +1,204 @@
+/**
+ * @file pipeline.hpp
+ * @brief Self-contained proxy pipeline instances and a supervisor that shards controllers
+ *
+ * A Pipeline owns everything one proxy loop needs: its own view of the
+ * configuration, its own log sink, its input source, translator, merger,
+ * output shaper, target health monitor and virtual bus. Nothing is shared
+ * between pipelines, so several can run side by side in one process, each
+ * on its own thread and core.
+ *
+ * Output goes through a TargetInjector, as in VirtualDeviceEmulator. With
+ * inject_thread_enabled, runFrame() only queues the shaped states and the
+ * injector's thread submits them and services the target health monitor.
+ * Bus targets are numbered per (target type, source user id) on first sight.
+ *
+ * PipelineSupervisor splits a set of controllers into contiguous shards and
+ * runs one pipeline per shard. Per-shard settings come from "shard<N>."
+ * prefixed keys of the base configuration (see ConfigManager::createView).
+ */
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "core/input_source.hpp"
+#include "core/input_merger.hpp"
+#include "core/target_health.hpp"
+#include "core/target_injector.hpp"
+#include "core/translation_layer.hpp"
+#include "utils/config_manager.hpp"
+#include "utils/logger.hpp"
+
+/**
+ * @class Pipeline
+ * @brief One capture -> translate -> merge -> shape -> inject loop
+ */
+class Pipeline {
+public:
+    /**
+     * @struct Stats
+     * @brief Loop counters (microseconds for times)
+     */
+    struct Stats {
+        uint64_t frames = 0;
+        uint64_t statesTranslated = 0;
+        uint64_t submits = 0;          // Reports handed to the target health monitor (by the injection thread if enabled)
+        uint64_t busyUs = 0;           // Time spent inside runFrame()
+        uint64_t maxFrameUs = 0;
+        uint64_t overruns = 0;         // Frames that took longer than the loop interval
+    };
+
+    Pipeline(int id, std::unique_ptr<ConfigManager> config,
+             std::unique_ptr<InputSource> source, std::unique_ptr<VirtualBus> bus);
+    ~Pipeline();
+
+    Pipeline(const Pipeline&) = delete;
+    Pipeline& operator=(const Pipeline&) = delete;
+
+    /**
+     * @brief Apply the translation keys of a config to a translation layer
+     *
+     * Shared with the proxy's startup so both read the same keys and defaults.
+     */
+    static void configureTranslation(ConfigManager& config, TranslationLayer& translationLayer);
+
+    /**
+     * @brief Apply the output shaping and target health keys of a config to an injector
+     *
+     * Shared with the proxy's startup, like configureTranslation().
+     */
+    static void configureOutput(ConfigManager& config, TargetInjector& injector);
+
+    /**
+     * @brief Run the loop on its own thread at polling_frequency (plus the injection thread if enabled)
+     * @param core Core to pin the loop thread to, or -1 to leave it unpinned
+     */
+    void start(int core = -1);
+
+    /**
+     * @brief Start only the injection thread, for callers that pace runFrame() themselves
+     *
+     * No-op unless inject_thread_enabled; stop() ends it.
+     */
+    void startInjection();
+
+    /**
+     * @brief Stop the threads and flush the pipeline's log to the process log
+     */
+    void stop();
+    bool isRunning() const { return m_running; }
+
+    /**
+     * @brief One loop iteration (the loop thread calls this; tests may call it directly)
+     *
+     * With the injection thread enabled the states are only queued; they are
+     * submitted once start() has launched the injection thread.
+     */
+    void runFrame(uint64_t nowUs);
+
+    Stats getStats() const;
+
+    int getId() const { return m_id; }
+    ConfigManager& getConfig() { return *m_config; }
+    LogSink& getLog() { return m_log; }
+    TranslationLayer& getTranslationLayer() { return m_translationLayer; }
+    InputSource& getSource() { return *m_source; }
+    VirtualBus& getBus() { return *m_bus; }
+    TargetInjector& getInjector() { return m_injector; }
+
+private:
+    void run(int core);
+    int resolveTarget(const TranslatedState& state);
+
+    int m_id;
+    std::unique_ptr<ConfigManager> m_config;
+    LogSink m_log;
+    std::unique_ptr<InputSource> m_source;
+    std::unique_ptr<VirtualBus> m_bus;
+    TargetInjector m_injector;
+
+    TranslationLayer m_translationLayer;
+    InputMerger m_inputMerger;
+    std::map<std::pair<int, int>, int> m_targetIds;   // (target type, source user id) -> bus target id
+    uint64_t m_intervalUs;
+    uint64_t m_lastFrameUs;
+
+    std::atomic<bool> m_running;
+    std::thread m_thread;
+
+    bool m_injectThreadEnabled;   // Submits and target health service on the injector's thread
+
+    mutable std::mutex m_statsMutex;
+    Stats m_stats;
+};
+
+/**
+ * @class PipelineSupervisor
+ * @brief Shards controllers across pipelines, one thread and core per shard
+ */
+class PipelineSupervisor {
+public:
+    /**
+     * @struct Shard
+     * @brief Contiguous controller range of one pipeline
+     */
+    struct Shard {
+        size_t first = 0;
+        size_t count = 0;
+        int core = -1;
+    };
+
+    /**
+     * @brief Builds the source and bus of one shard
+     *
+     * The source must report the shard's controllers as local ids 0..count-1.
+     */
+    struct Endpoints {
+        std::unique_ptr<InputSource> source;
+        std::unique_ptr<VirtualBus> bus;
+    };
+    using EndpointFactory = std::function<Endpoints(size_t shardIndex, const Shard& shard)>;
+
+    /**
+     * @brief Balanced contiguous split (shard sizes differ by at most one)
+     *
+     * Shards are clamped to the controller count; shard i gets core
+     * (firstCore + i) % coreCount.
+     */
+    static std::vector<Shard> plan(size_t controllers, size_t shards, int coreCount, int firstCore = 0);
+
+    PipelineSupervisor(const ConfigManager& baseConfig, const std::vector<Shard>& shards,
+                       const EndpointFactory& factory);
+    ~PipelineSupervisor();
+
+    /**
+     * @brief Start every pipeline; pinned to its shard's core when pin is set
+     */
+    void start(bool pin = true);
+    void stop();
+
+    /**
+     * @brief Forward the pipelines' pending log lines to the process log
+     *
+     * Pipeline threads never block on console or file output; the owner
+     * calls this periodically (stop() flushes as well).
+     */
+    size_t flushLogs();
+
+    size_t size() const { return m_pipelines.size(); }
+    Pipeline& pipeline(size_t index) { return *m_pipelines[index]; }
+    const Shard& shard(size_t index) const { return m_shards[index]; }
+
+    Pipeline::Stats totalStats() const;
+
+private:
+    std::vector<Shard> m_shards;
+    std::vector<std::unique_ptr<Pipeline>> m_pipelines;
+};
@@ -0,0 +1,142 @@
+/**
+ * @file polling_scheduler.hpp
+ * @brief Per-device polling groups served by independent deadlines
+ *
+ * Devices report at very different rates (1 kHz DualSense, 250 Hz XInput pad,
+ * 125 Hz generic gamepad). Instead of servicing every device at the global
+ * polling frequency, each device belongs to a rate class (base rate divided
+ * by 1, 2, 4 or 8). Every class has its own deadline in one shared scheduler;
+ * a frame services only the devices whose class is due, and the capture loop
+ * sleeps until the earliest deadline of a class that has members.
+ *
+ * Classes are assigned from config overrides or automatically from the
+ * measured report interval: a device is polled at least twice per report
+ * interval, and promoted to a faster class whenever nearly every poll finds
+ * a new report (the sign of being under-sampled).
+ */
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @struct PollingRateOverride
+ * @brief Fixed rate for devices whose product name or instance ID matches
+ */
+struct PollingRateOverride {
+    std::wstring match;
+    uint32_t rateHz;
+};
+
+/**
+ * @class PollingScheduler
+ * @brief Rate classes with deadlines, plus per-device report interval tracking
+ *
+ * Devices are identified by their index in InputCapture's state list.
+ * Not internally synchronized; InputCapture drives it under its state mutex.
+ */
+class PollingScheduler {
+public:
+    static constexpr size_t CLASS_COUNT = 4;                 // base, /2, /4, /8
+    static constexpr uint64_t CLASSIFY_WINDOW = 32;          // Services between class decisions
+    static constexpr uint64_t MIN_REPORTS_TO_CLASSIFY = 16;  // Reports before leaving the default class
+    static constexpr double UNDERSAMPLED_HIT_RATIO = 0.9;
+
+    /**
+     * @struct DeviceTiming
+     * @brief Scheduling state and measurements of one device
+     */
+    struct DeviceTiming {
+        bool configured = false;
+        bool active = false;          // Connected; inactive devices do not hold a class deadline
+        bool pinned = false;          // Class fixed by config override
+        size_t rateClass = 0;
+        std::wstring instanceId;
+        double reportIntervalUs = 0.0; // Moving average of report-to-report time
+        uint64_t lastReportUs = 0;
+        uint64_t reports = 0;
+        uint64_t services = 0;
+        uint64_t windowServices = 0;
+        uint64_t windowHits = 0;
+    };
+
+    /**
+     * @struct GroupStats
+     * @brief Rate and load of one rate class
+     */
+    struct GroupStats {
+        uint32_t rateHz = 0;
+        size_t members = 0;
+        uint64_t deadlinesServed = 0;
+        uint64_t deadlinesMissed = 0; // Served more than a full period late
+    };
+
+    PollingScheduler();
+
+    void setBaseRate(uint32_t hz);
+    void setOverrides(const std::vector<PollingRateOverride>& overrides) { m_overrides = overrides; }
+
+    /**
+     * @brief Bind a device index to a physical device (re-binds when the instance ID changes)
+     */
+    void assignDevice(size_t device, const std::wstring& productName, const std::wstring& instanceId);
+    void setActive(size_t device, bool active);
+
+    /**
+     * @brief Start a frame: mark classes whose deadline has passed as due
+     */
+    void beginFrame(uint64_t nowUs);
+
+    /**
+     * @brief Whether a device should be serviced this frame
+     *
+     * Inactive devices are serviced on every frame that has any class due so
+     * hot-plug detection does not depend on a rate class.
+     */
+    bool isDue(size_t device) const;
+
+    /**
+     * @brief Record a service of a device and whether it produced a new report
+     */
+    void recordService(size_t device, bool newReport, uint64_t nowUs);
+
+    /**
+     * @brief Earliest deadline among classes that have active members
+     */
+    uint64_t nextDeadlineUs() const;
+
+    uint32_t classRateHz(size_t rateClass) const { return m_baseRateHz >> rateClass; }
+    uint64_t classPeriodUs(size_t rateClass) const { return 1000000ULL / classRateHz(rateClass); }
+    size_t getDeviceCount() const { return m_devices.size(); }
+    DeviceTiming getTiming(size_t device) const;
+    GroupStats getGroupStats(size_t rateClass) const;
+
+    /**
+     * @brief Slowest class still polling at least twice per report interval
+     */
+    size_t classForInterval(double reportIntervalUs) const;
+
+    /**
+     * @brief Slowest class that still meets a requested rate
+     */
+    size_t classForRate(uint32_t rateHz) const;
+
+    /**
+     * @brief Parse "match:hz;match:hz" (e.g. "DualSense:1000;Generic USB:125")
+     */
+    static std::vector<PollingRateOverride> parseOverrides(const std::string& text);
+
+private:
+    DeviceTiming& device(size_t index);
+    void classify(DeviceTiming& timing);
+
+    uint32_t m_baseRateHz;
+    std::vector<PollingRateOverride> m_overrides;
+    std::vector<DeviceTiming> m_devices;
+    std::array<uint64_t, CLASS_COUNT> m_deadlineUs{};
+    std::array<uint64_t, CLASS_COUNT> m_served{};
+    std::array<uint64_t, CLASS_COUNT> m_missed{};
+    uint32_t m_dueMask;
+};
@@ -0,0 +1,227 @@
+/**
+ * @file profile_library.hpp
+ * @brief Device mapping profiles compiled into one memory-mapped blob
+ *
+ * A profile tells TranslationLayer how a HID device's buttons and axes map
+ * onto the XInput layout. Profiles are written one per file in
+ * profile_directory (*.profile, line-oriented like recordings, # comments):
+ *
+ *     xidp-profile 1
+ *     name "DualSense"
+ *     match usb=054c:0ce6
+ *     match name="DualSense Wireless Controller"
+ *     button 1 x
+ *     button 2 a
+ *     button 7 lt
+ *     hat up up
+ *     axis 0x30 lx fixed center=128 scale=256
+ *     axis 0x31 ly fixed center=128 scale=256 invert
+ *     axis 0x33 lt caps
+ *
+ * USB matches may name a device version (usb=vvvv:pppp:version), which wins
+ * over the plain id. Buttons map a button usage (1-31) to XInput button
+ * names (a b x y lb rb back start ls rs up down left right, lt rt for a
+ * fully pulled trigger) or a 0x mask. Hat lines map a direction of the hat
+ * switch (usage 0x39) to buttons. Axes map an axis usage (0x30-0x3f) to lx
+ * ly rx ry lt rt, either normalized from the device's value caps like the
+ * generic mapping ("caps") or as (value - center) * scale ("fixed"),
+ * saturated; "invert" flips the sign.
+ *
+ * The compiler turns the built-in profiles, an SDL gamecontrollerdb.txt
+ * (see ControllerDb) and a directory of sources into a single blob: dense
+ * per-profile button, hat and axis tables, an open-addressing hash index
+ * over the match keys (USB vendor/product id and version, product name) and
+ * a string table, behind a header with a checksum and a stamp of the source
+ * files. At startup the blob is memory-mapped and validated once;
+ * a device lookup is one hash probe into the mapped index, so hundreds of
+ * profiles cost no parse time. The blob is rebuilt when the sources change.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "utils/mapped_file.hpp"
+#include "utils/platform.hpp"
+
+/**
+ * @class ProfileLibrary
+ * @brief Compiled device profiles with hash lookup by USB id or product name
+ */
+class ProfileLibrary {
+public:
+    static constexpr int SOURCE_VERSION = 1;
+    static constexpr uint32_t FORMAT_VERSION = 2;
+    static constexpr size_t BUTTON_USAGES = 32;       // Dense button table, index = usage (0 unused)
+    static constexpr USAGE AXIS_FIRST_USAGE = 0x30;
+    static constexpr size_t AXIS_USAGES = 16;         // Dense axis table for usages 0x30-0x3f
+    static constexpr USAGE HAT_USAGE = 0x39;
+    static constexpr const char* COMPILED_NAME = "profiles.bin";
+    static constexpr const char* CONTROLLER_DB_NAME = "gamecontrollerdb.txt";
+
+    enum HatDirection {
+        HAT_UP = 0,
+        HAT_RIGHT,
+        HAT_DOWN,
+        HAT_LEFT,
+        HAT_DIRECTIONS
+    };
+
+    enum ButtonTrigger : uint8_t {
+        TRIGGER_LEFT = 1,
+        TRIGGER_RIGHT = 2
+    };
+
+    enum AxisTarget : uint8_t {
+        AXIS_NONE = 0,
+        AXIS_LEFT_X,
+        AXIS_LEFT_Y,
+        AXIS_RIGHT_X,
+        AXIS_RIGHT_Y,
+        AXIS_LEFT_TRIGGER,
+        AXIS_RIGHT_TRIGGER
+    };
+
+    enum AxisMode : uint8_t {
+        AXIS_CAPS = 0,      // Normalized from the device's logical range
+        AXIS_FIXED = 1      // (value - center) * scale
+    };
+
+    /**
+     * @struct Axis
+     * @brief One axis transform as stored in the blob
+     */
+    struct Axis {
+        uint8_t target = AXIS_NONE;
+        uint8_t mode = AXIS_CAPS;
+        uint8_t invert = 0;
+        uint8_t reserved = 0;
+        int32_t center = 0;
+        int32_t scale = 1;
+    };
+
+    /**
+     * @struct Profile
+     * @brief One compiled profile, read in place from the blob
+     */
+    struct Profile {
+        uint32_t nameOffset;                // Display name (UTF-8) in the string table
+        uint32_t nameLength;
+        uint16_t buttons[BUTTON_USAGES];    // XInput button mask per button usage
+        uint16_t hat[HAT_DIRECTIONS];       // XInput button mask per hat direction
+        uint8_t buttonTriggers[BUTTON_USAGES];  // ButtonTrigger bits per button usage
+        Axis axes[AXIS_USAGES];             // Transform per axis usage - AXIS_FIRST_USAGE
+    };
+
+    /**
+     * @struct Source
+     * @brief Parsed form of one profile file
+     */
+    struct Source {
+        struct UsbId {
+            uint16_t vendorId;
+            uint16_t productId;
+            uint16_t version = 0;                            // 0 = any version
+        };
+
+        std::string name;
+        std::vector<UsbId> usbIds;
+        std::vector<std::string> productNames;               // UTF-8
+        std::map<USAGE, WORD> buttons;
+        std::map<USAGE, uint8_t> buttonTriggers;
+        WORD hat[HAT_DIRECTIONS] = {};
+        std::map<USAGE, Axis> axes;
+        std::string origin;                                  // File the source came from, for errors
+    };
+
+    ProfileLibrary();
+    ~ProfileLibrary();
+
+    ProfileLibrary(const ProfileLibrary&) = delete;
+    ProfileLibrary& operator=(const ProfileLibrary&) = delete;
+
+    /**
+     * @brief Parse a profile source
+     * @param error Receives "line N: reason" on failure (may be null)
+     */
+    static bool parse(std::istream& in, Source& source, std::string* error = nullptr);
+
+    /**
+     * @brief Compile sources into a blob
+     *
+     * The first overridableCount sources (built-ins and imported databases)
+     * may be overridden: a later source with the same match key takes it
+     * over. Any other duplicate key is an error.
+     */
+    static bool compile(const std::vector<Source>& sources, size_t overridableCount, uint64_t sourceStamp,
+                        std::vector<uint8_t>& blob, std::string* error = nullptr);
+
+    /**
+     * @brief Compile the built-in profiles, the directory's gamecontrollerdb.txt and its *.profile files into a blob file
+     */
+    static bool compileDirectory(const std::string& directory, const std::string& outputPath,
+                                 std::string* error = nullptr);
+
+    /**
+     * @brief Library of a profile directory: its compiled blob if that is current, else freshly compiled
+     *
+     * A stale or damaged blob is rebuilt and written back (best effort; a
+     * read-only directory still gets the in-memory library).
+     */
+    static std::shared_ptr<const ProfileLibrary> loadDirectory(const std::string& directory,
+                                                               std::string* error = nullptr);
+
+    /**
+     * @brief The profiles compiled into the proxy (DualShock 4)
+     */
+    static std::shared_ptr<const ProfileLibrary> builtIn();
+
+    /**
+     * @brief Stamp of the sources of a directory (profile files and database: names, sizes, times) and the built-ins
+     */
+    static uint64_t sourceStamp(const std::string& directory);
+
+    /**
+     * @brief Map and validate a compiled blob
+     */
+    bool open(const std::string& path, std::string* error = nullptr);
+
+    /**
+     * @brief Validate and adopt a blob held in memory
+     */
+    bool open(std::vector<uint8_t> blob, std::string* error = nullptr);
+
+    /**
+     * @brief Profile of a device: by USB id and version, USB id, then product name
+     * @return Null if no profile matches
+     */
+    const Profile* find(uint16_t vendorId, uint16_t productId, const std::wstring& productName,
+                        uint16_t version = 0) const;
+
+    size_t size() const { return m_profileCount; }
+    const Profile& at(size_t index) const { return m_profiles[index]; }
+    std::string getName(const Profile& profile) const;
+    uint64_t getSourceStamp() const { return m_sourceStamp; }
+    bool isMapped() const { return m_file.isOpen(); }
+
+private:
+    struct Bucket;
+
+    bool adopt(const uint8_t* data, size_t size, std::string* error);
+    const Profile* probe(uint64_t hash, uint32_t kind, uint32_t usbId, uint32_t version, const std::wstring* name) const;
+
+    MappedFile m_file;
+    std::vector<uint8_t> m_owned;
+    const Bucket* m_buckets;
+    uint32_t m_bucketCount;
+    const Profile* m_profiles;
+    uint32_t m_profileCount;
+    const uint8_t* m_strings;
+    uint32_t m_stringBytes;
+    uint64_t m_sourceStamp;
+};
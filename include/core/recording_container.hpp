@@ -0,0 +1,240 @@
+/**
+ * @file recording_container.hpp
+ * @brief Compact, seekable binary container for long recorded sessions
+ *
+ * The text format of SessionRecording is meant for short, reviewable
+ * sessions; hours of 1 kHz capture from several pads need something smaller
+ * and faster to scan. The container (.xrec) keeps the same content:
+ *
+ *   header   "XIDPREC" 0, version:u32, metadata length:u32, metadata
+ *            (the text format's option/device/cap lines, no frames)
+ *   chunk    "XCNK", payload length:u32, frames:u32, firstTimeUs:u64,
+ *            lastTimeUs:u64, FNV-1a of the payload:u32, payload
+ *   ...
+ *   index    per chunk: offset:u64, firstTimeUs:u64, lastTimeUs:u64, frames:u32
+ *   trailer  index offset:u64, chunks:u32, frames:u64, "XIDPIDX" 0
+ *
+ * A chunk payload starts with a keyframe: the last sample of every device
+ * seen so far, so each chunk decodes on its own. Frames follow as a varint
+ * time delta, a sample count and the samples. Each sample is coded against
+ * the device's previous sample: a mask of the fields that changed and only
+ * those, as zigzag varint deltas (button words as XOR, HID reports as a
+ * changed-byte bitmap when the length is unchanged). A frame where one axis
+ * moved costs a few bytes.
+ *
+ * The writer streams: it buffers one chunk and the last sample per device, so
+ * memory stays bounded however long the session. The reader binary-searches
+ * the index to seek by timestamp and decodes one chunk at a time. A file
+ * whose writer never finished (no trailer) is recovered by scanning the
+ * chunks that are complete.
+ */
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "core/session_recording.hpp"
+
+/**
+ * @class RecordingWriter
+ * @brief Streams frames into a container
+ */
+class RecordingWriter {
+public:
+    static constexpr uint32_t FORMAT_VERSION = 1;
+
+    /**
+     * @struct Options
+     * @brief A chunk closes at whichever limit it reaches first
+     */
+    struct Options {
+        uint32_t chunkFrames = 4096;
+        size_t chunkBytes = 256 * 1024;
+    };
+
+    /**
+     * @struct Stats
+     * @brief Output counters
+     */
+    struct Stats {
+        uint64_t frames = 0;
+        uint64_t samples = 0;
+        uint64_t chunks = 0;
+        uint64_t bytes = 0;       // Written to the stream so far
+    };
+
+    /**
+     * @param session Options and devices of the session (its frames are ignored)
+     */
+    RecordingWriter(std::ostream& out, const SessionRecording& session, const Options& options);
+    RecordingWriter(std::ostream& out, const SessionRecording& session);
+
+    /**
+     * @brief Append a frame
+     * @return False if the frame goes back in time or names an unknown device
+     */
+    bool append(const SessionRecording::Frame& frame);
+
+    /**
+     * @brief Flush the open chunk and write the index; no appends afterwards
+     */
+    bool finish();
+
+    const Stats& getStats() const { return m_stats; }
+
+    /**
+     * @brief Write a whole in-memory recording
+     */
+    static bool write(const SessionRecording& recording, std::ostream& out, const Options& options);
+    static bool write(const SessionRecording& recording, std::ostream& out);
+    static bool save(const SessionRecording& recording, const std::string& path, const Options& options);
+    static bool save(const SessionRecording& recording, const std::string& path);
+
+private:
+    struct ChunkInfo {
+        uint64_t offset;
+        uint64_t firstTimeUs;
+        uint64_t lastTimeUs;
+        uint32_t frames;
+    };
+
+    void flushChunk();
+
+    std::ostream& m_out;
+    Options m_options;
+    std::vector<SessionRecording::SourceKind> m_kinds;
+    std::vector<SessionRecording::Sample> m_last;   // Last sample per device (whole session)
+    std::vector<bool> m_seen;
+
+    std::vector<uint8_t> m_chunk;                   // Payload of the open chunk
+    std::vector<SessionRecording::Sample> m_chunkLast;
+    uint32_t m_chunkFrames;
+    uint64_t m_chunkFirstUs;
+    uint64_t m_previousUs;
+    bool m_finished;
+
+    std::vector<ChunkInfo> m_index;
+    Stats m_stats;
+};
+
+/**
+ * @class RecordingReader
+ * @brief Reads a container frame by frame, with seeking by timestamp
+ */
+class RecordingReader {
+public:
+    /**
+     * @struct Chunk
+     * @brief Index entry of one chunk
+     */
+    struct Chunk {
+        uint64_t offset = 0;
+        uint64_t firstTimeUs = 0;
+        uint64_t lastTimeUs = 0;
+        uint32_t frames = 0;
+    };
+
+    using SampleVisitor = std::function<void(uint64_t timeUs, const SessionRecording::Sample& sample)>;
+
+    RecordingReader();
+
+    /**
+     * @brief Read the metadata and the chunk index
+     *
+     * The stream must stay valid while the reader is used.
+     */
+    bool open(std::istream& in, std::string* error = nullptr);
+
+    /**
+     * @brief Same over a container already in memory (e.g. a MappedFile)
+     *
+     * Chunks are decoded in place instead of copied out. The bytes must stay
+     * valid while the reader is used.
+     */
+    bool open(const uint8_t* data, size_t size, std::string* error = nullptr);
+
+    // Options and devices of the session (no frames)
+    const SessionRecording& getSession() const { return m_session; }
+    const std::vector<Chunk>& getChunks() const { return m_chunks; }
+    uint64_t getFrameCount() const { return m_frameCount; }
+    bool wasRecovered() const { return m_recovered; }   // Index rebuilt from the chunks
+    bool isInMemory() const { return m_data != nullptr; }
+
+    /**
+     * @brief Position before the first frame at or after timeUs
+     *
+     * The next frame also carries the latest sample of every device seen
+     * before it, so replay from there starts from the right state.
+     */
+    bool seek(uint64_t timeUs);
+
+    /**
+     * @brief Decode the next frame
+     * @return False at the end or on a damaged chunk (see getError())
+     */
+    bool next(SessionRecording::Frame& frame);
+
+    const std::string& getError() const { return m_error; }
+
+    /**
+     * @brief Decode one chunk and call visit for each of its samples, in order
+     *
+     * No frames are built and the frame position is left alone, so scans over
+     * hours of data allocate nothing per sample. Concurrent calls (one chunk
+     * per thread) are safe on a reader opened over memory.
+     */
+    bool visitChunk(size_t index, const SampleVisitor& visit, std::string* error = nullptr) const;
+
+    /**
+     * @brief Decode everything into an in-memory recording
+     */
+    bool readAll(SessionRecording& recording, std::string* error = nullptr);
+
+    /**
+     * @brief True if the stream starts with the container magic (stream is rewound)
+     */
+    static bool isContainer(std::istream& in);
+    static bool load(const std::string& path, SessionRecording& recording, std::string* error = nullptr);
+
+private:
+    struct ChunkView {
+        const uint8_t* payload = nullptr;
+        size_t length = 0;
+        uint32_t frames = 0;
+        uint64_t firstTimeUs = 0;
+    };
+
+    bool openContainer(std::string* error);
+    bool readAt(uint64_t offset, uint8_t* data, size_t length) const;
+    void scanChunks(uint64_t from, uint64_t end);
+    bool readChunk(size_t index, std::vector<uint8_t>& buffer, ChunkView& view, std::string& error) const;
+    bool decodeKeyframe(const ChunkView& view, size_t& offset, std::vector<SessionRecording::Sample>& last,
+                        std::vector<bool>& known) const;
+    bool loadChunk(size_t index);
+    bool decodeFrame(SessionRecording::Frame& frame);
+    bool fail(const std::string& reason);
+
+    std::istream* m_in;
+    const uint8_t* m_data;                          // Set instead of m_in for a reader over memory
+    uint64_t m_size;
+    SessionRecording m_session;
+    std::vector<Chunk> m_chunks;
+    uint64_t m_frameCount;
+    bool m_recovered;
+
+    size_t m_nextChunk;                             // Chunk to load once m_payload is used up
+    std::vector<uint8_t> m_payload;                 // Copy of the chunk when reading a stream
+    const uint8_t* m_payloadData;
+    size_t m_payloadSize;
+    size_t m_offset;                                // Read position in m_payload
+    uint32_t m_framesLeft;
+    uint64_t m_previousUs;
+    std::vector<SessionRecording::Sample> m_last;   // Previous sample per device within the chunk
+    std::vector<bool> m_known;
+    SessionRecording::Frame m_peeked;               // First frame after a seek, with the state before it
+    bool m_hasPeeked;
+    std::string m_error;
+};
@@ -0,0 +1,106 @@
+/**
+ * @file replay_corpus.hpp
+ * @brief Parallel golden-output regression runs over a corpus of recordings
+ *
+ * Every <name>.rec or <name>.xrec of a corpus directory is rendered with
+ * GoldenOutput::render and compared against <name>.golden. Recordings are
+ * fanned out over a WorkStealingPool; each one is replayed by its own
+ * TranslationLayer and RecordingPlayer, whose clock is the recording's frame
+ * sequence, so no state is shared between recordings and the wall clock
+ * never enters the output.
+ *
+ * Outcomes are stored by corpus position (sorted by name), so the report is
+ * the same whatever the number of workers and the order tasks finish in;
+ * only the timing columns vary between runs.
+ */
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "core/golden_output.hpp"
+#include "utils/work_stealing_pool.hpp"
+
+/**
+ * @class ReplayCorpus
+ * @brief Recordings with golden streams, replayed and compared in parallel
+ */
+class ReplayCorpus {
+public:
+    /**
+     * @struct Entry
+     * @brief One recording and its golden stream
+     */
+    struct Entry {
+        std::string name;           // File name without extension
+        std::string recordingPath;
+        std::string goldenPath;
+    };
+
+    /**
+     * @struct Outcome
+     * @brief Result of one recording
+     */
+    struct Outcome {
+        std::string name;
+        bool passed = false;
+        std::string error;          // Load or render failure; empty if it was compared
+        std::vector<GoldenOutput::Mismatch> mismatches;
+        uint64_t frames = 0;
+        uint64_t records = 0;       // Output records rendered
+        double seconds = 0.0;       // Load, render and compare
+    };
+
+    /**
+     * @struct Summary
+     * @brief Outcomes in corpus order plus totals
+     */
+    struct Summary {
+        std::vector<Outcome> outcomes;
+        size_t passed = 0;
+        size_t failed = 0;
+        uint64_t frames = 0;
+        double seconds = 0.0;       // Wall time of the whole run
+        double busySeconds = 0.0;   // Sum of the per-recording times
+        size_t threads = 0;         // Workers plus the calling thread
+    };
+
+    /**
+     * @param workers Pool threads besides the caller (0 runs everything on the caller)
+     * @param maxMismatches Differences kept per recording
+     */
+    explicit ReplayCorpus(size_t workers, size_t maxMismatches = 20);
+
+    /**
+     * @brief Add every recording of a directory (sorted by name)
+     *
+     * A recording without a golden file is still added and fails with that
+     * reason, so a forgotten bless shows up in the report.
+     */
+    bool addDirectory(const std::string& path, std::string* error = nullptr);
+
+    void add(const Entry& entry);
+
+    const std::vector<Entry>& getEntries() const { return m_entries; }
+
+    /**
+     * @brief Replay and compare every recording
+     */
+    Summary run();
+
+    /**
+     * @brief Replay one recording (what each pool task does)
+     */
+    Outcome runOne(const Entry& entry) const;
+
+    /**
+     * @brief One line per recording with its differences, then the totals
+     */
+    static void writeReport(const Summary& summary, std::ostream& out);
+
+private:
+    WorkStealingPool m_pool;
+    size_t m_maxMismatches;
+    std::vector<Entry> m_entries;
+};
@@ -0,0 +1,48 @@
+/**
+ * @file replay_workload.hpp
+ * @brief Headless replay of recorded sessions through the hot path
+ *
+ * Replays SessionRecordings through translation, output shaping and both
+ * report encoders as fast as possible, without devices, drivers or the
+ * dashboard. This is the training workload of profile-guided builds and the
+ * workload of the plain/LTO/PGO build comparison.
+ *
+ * The checksum folds every encoded report, so builds with different
+ * optimization settings can be checked to produce identical output.
+ */
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "core/session_recording.hpp"
+
+/**
+ * @class ReplayWorkload
+ * @brief A set of recordings replayed as one benchmark workload
+ */
+class ReplayWorkload {
+public:
+    struct Stats {
+        size_t recordings = 0;
+        uint64_t frames = 0;
+        uint64_t outputs = 0;       // Translated states encoded
+        double seconds = 0.0;
+        uint64_t checksum = 0;
+    };
+
+    /**
+     * @brief Add a recording, or every *.rec and *.xrec in a directory (sorted by name)
+     */
+    bool add(const std::string& path, std::string* error = nullptr);
+
+    size_t size() const { return m_recordings.size(); }
+
+    /**
+     * @brief Replay every recording the given number of times
+     */
+    Stats run(uint32_t iterations) const;
+
+private:
+    std::vector<SessionRecording> m_recordings;
+};
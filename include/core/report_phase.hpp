@@ -0,0 +1,117 @@
+/**
+ * @file report_phase.hpp
+ * @brief Report period/phase estimation and phase-aligned loop pacing
+ *
+ * The capture loop runs on its own clock, so each report waits a random
+ * fraction of a loop period before it is picked up (half a period on
+ * average). ReportPhaseEstimator tracks a device's report period and phase
+ * from report timestamps with a second-order phase-locked loop, which follows
+ * crystal drift and rides through jitter and dropped reports.
+ *
+ * PhaseAlignedPacer uses the fastest locked device as an anchor: instead of
+ * waking on a fixed grid, the loop wakes just before that device's expected
+ * arrival and briefly watches it until the report lands. The wake time only
+ * moves within the current loop period, so the loop rate does not go up.
+ * Input age drops from half a period to the watch resolution.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @class ReportPhaseEstimator
+ * @brief Period and phase of one device's reports (all times in microseconds)
+ */
+class ReportPhaseEstimator {
+public:
+    static constexpr int TRAINING_INTERVALS = 8;    // Intervals used to seed the period
+    static constexpr int LOCK_REPORTS = 16;         // Consistent reports before the estimate is trusted
+    static constexpr int MAX_OUTLIERS = 8;          // Consecutive outliers before retraining
+    static constexpr double PHASE_GAIN = 0.2;
+    static constexpr double PERIOD_GAIN = 0.005;
+    static constexpr double EXACT_WINDOW = 0.05;    // Arrival windows up to this fraction of a period are exact
+
+    ReportPhaseEstimator();
+
+    /**
+     * @brief Feed one report
+     *
+     * A report found waiting only says it arrived between the previous look
+     * and this one. Narrow windows (watching for the report) are treated as
+     * exact timestamps; wide ones only nudge the phase.
+     *
+     * @param timestampUs When the report was seen
+     * @param arrivedAfterUs When the device was last looked at without a report
+     */
+    void onReport(uint64_t timestampUs, uint64_t arrivedAfterUs);
+    void onReport(uint64_t timestampUs) { onReport(timestampUs, timestampUs); }
+    void reset();
+
+    bool isLocked() const;
+    double periodUs() const { return m_periodUs; }
+    double jitterUs() const { return m_jitterUs; }
+    uint64_t reports() const { return m_reports; }
+
+    /**
+     * @brief First expected arrival strictly after a point in time
+     */
+    double predictNextUs(double afterUs) const;
+
+private:
+    uint64_t m_reports;
+    uint64_t m_lastUs;
+    double m_trainingIntervals[TRAINING_INTERVALS];
+    int m_trainingCount;
+    bool m_trained;
+    double m_periodUs;
+    double m_nextUs;       // Expected arrival of the next report
+    double m_jitterUs;     // Moving average of absolute phase error
+    int m_consistent;
+    int m_outliers;
+};
+
+/**
+ * @class PhaseAlignedPacer
+ * @brief Plans loop wake-ups around the fastest locked device's arrivals
+ */
+class PhaseAlignedPacer {
+public:
+    static constexpr double MIN_GUARD_US = 50.0;
+    static constexpr double JITTER_GUARD_FACTOR = 3.0;
+
+    /**
+     * @struct WakePlan
+     * @brief When to wake, and how long to watch the anchor device afterwards
+     */
+    struct WakePlan {
+        uint64_t wakeUs;
+        uint64_t watchUntilUs;   // Equal to wakeUs when there is nothing to watch
+        int anchor;              // Device index, or -1 when running on the regular grid
+    };
+
+    void onReport(size_t device, uint64_t timestampUs, uint64_t arrivedAfterUs);
+    void onReport(size_t device, uint64_t timestampUs) { onReport(device, timestampUs, timestampUs); }
+    void reset(size_t device);
+
+    /**
+     * @brief Plan the next wake-up
+     *
+     * @param lastWakeUs When the loop last woke
+     * @param regularWakeUs When the loop would wake without alignment
+     */
+    WakePlan plan(uint64_t lastWakeUs, uint64_t regularWakeUs) const;
+
+    /**
+     * @brief Fastest locked device, or -1
+     */
+    int anchor() const;
+
+    const ReportPhaseEstimator* estimator(size_t device) const {
+        return device < m_estimators.size() ? &m_estimators[device] : nullptr;
+    }
+
+private:
+    std::vector<ReportPhaseEstimator> m_estimators;
+};
@@ -0,0 +1,136 @@
+/**
+ * @file session_recording.hpp
+ * @brief Recorded input sessions and their replay as an InputSource
+ *
+ * A recording holds the devices of a session (XInput slots and HID devices
+ * with their value caps), the translation options it was captured with, and
+ * a list of frames. Each frame carries the reports that arrived since the
+ * previous frame; a device without a report keeps its last state, the way
+ * InputCapture keeps the last completed read.
+ *
+ * Recordings are line-oriented text so they can be checked in and reviewed:
+ *
+ *     xidp-recording 1
+ *     option stick_deadzone 1
+ *     device 0 xinput user=0
+ *     device 1 hid vid=054c pid=09cc name="Wireless Controller" path="\\?\hid#vid_054c&pid_09cc#1"
+ *     cap 1 0x30 0 255
+ *     frame 1000
+ *     x 0 packet=1 buttons=0x1000 lt=0 rt=255 lx=0 ly=0 rx=-1200 ry=0
+ *     h 1 buttons=2,5 values=0x30:128,0x31:40 report=01807f...
+ *
+ * HID samples carry the decoded usages and values as captured, plus the raw
+ * report when the device has a motion block (decoded again on replay).
+ * Replayed states are stamped with the frame time in microseconds rather
+ * than performance counter ticks, so replay is identical on every platform.
+ */
+#pragma once
+
+#include <cstdint>
+#include <istream>
+#include <map>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "core/input_source.hpp"
+#include "core/input_capture.hpp"
+
+class TranslationLayer;
+
+/**
+ * @class SessionRecording
+ * @brief In-memory form of a recorded session
+ */
+class SessionRecording {
+public:
+    static constexpr int FORMAT_VERSION = 1;
+
+    enum class SourceKind {
+        XINPUT,
+        HID
+    };
+
+    struct ValueCap {
+        USAGE usage;
+        LONG logicalMin;
+        LONG logicalMax;
+    };
+
+    struct Device {
+        SourceKind kind = SourceKind::HID;
+        int userId = -1;                // XInput slot; -1 for HID
+        USHORT vendorId = 0;
+        USHORT productId = 0;
+        std::string productName;
+        std::string devicePath;
+        std::vector<ValueCap> valueCaps;
+    };
+
+    /**
+     * @struct Sample
+     * @brief One report of one device
+     */
+    struct Sample {
+        size_t device = 0;
+        // XInput
+        DWORD packetNumber = 0;
+        XINPUT_GAMEPAD gamepad{};
+        // HID
+        std::vector<USAGE> buttons;
+        std::vector<std::pair<USAGE, LONG>> values;
+        std::vector<uint8_t> report;    // Raw report (byte 0 = report ID), may be empty
+    };
+
+    struct Frame {
+        uint64_t timeUs = 0;
+        std::vector<Sample> samples;
+    };
+
+    std::map<std::string, std::string> options;   // Translation options, see applyOptions()
+    std::vector<Device> devices;
+    std::vector<Frame> frames;
+
+    /**
+     * @brief Parse a recording
+     *
+     * @param error Receives "line N: reason" on failure (may be null)
+     */
+    bool parse(std::istream& in, std::string* error = nullptr);
+    bool load(const std::string& path, std::string* error = nullptr);
+    void write(std::ostream& out) const;
+
+    /**
+     * @brief Configure a translation layer from the recording's options
+     *
+     * Supported: socd, socd_method, xinput_to_dinput, dinput_to_xinput,
+     * stick_deadzone, left_deadzone, right_deadzone, left_anti_deadzone,
+     * right_anti_deadzone, motion_passthrough, gyro_to_stick,
+     * gyro_sensitivity, gyro_smoothing, gyro_deadzone. Debouncing is not
+     * replayable (it runs on the wall clock) and is rejected.
+     */
+    bool applyOptions(TranslationLayer& layer, std::string* error = nullptr) const;
+};
+
+/**
+ * @class RecordingPlayer
+ * @brief Replays a recording frame by frame through the InputSource interface
+ *
+ * Each update() applies the next frame; getInputStates() returns every
+ * device of the session in recording order.
+ */
+class RecordingPlayer : public InputSource {
+public:
+    explicit RecordingPlayer(const SessionRecording& recording);
+
+    void update(double deltaTime) override;
+    std::vector<ControllerState> getInputStates() const override;
+
+    bool done() const { return m_nextFrame >= m_recording.frames.size(); }
+    size_t frameIndex() const { return m_nextFrame; }   // Frames applied so far
+
+private:
+    const SessionRecording& m_recording;
+    std::vector<ControllerState> m_states;
+    size_t m_nextFrame;
+};
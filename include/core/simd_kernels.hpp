@@ -0,0 +1,119 @@
+/**
+ * @file simd_kernels.hpp
+ * @brief Hot-path kernels with runtime CPU dispatch
+ *
+ * Each kernel has a scalar reference and SIMD variants compiled in their own
+ * translation units with per-file instruction set flags, so the binary runs
+ * on the portable baseline and still uses SSE4.1, AVX2, BMI2 or AVX-512 where
+ * the CPU has them. The best variants are bound into a function pointer table
+ * on first use; select() caps the level (configuration, tests).
+ *
+ * All variants produce bit-identical results: the float math follows the
+ * scalar reference operation for operation, and the kernel units are built
+ * without floating-point contraction.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "utils/platform.hpp"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define XIDP_SIMD_X86 1
+#endif
+
+enum class SimdLevel {
+    SCALAR,
+    SSE41,
+    AVX2,       // AVX2, with BMI2 kernels where the CPU has BMI2
+    AVX512      // AVX-512 F/BW/VL
+};
+
+/**
+ * @struct StickStats
+ * @brief Running statistics of one stick's samples (offline drift analysis)
+ */
+struct StickStats {
+    // Farthest projection onto +x, -x, +y, -y, x+y, x-y, y-x, -x-y (0 if never reached)
+    int32_t extents[8] = {};
+    // Samples with |x| and |y| inside the rest window, and their sums
+    uint64_t restCount = 0;
+    int64_t restSumX = 0;
+    int64_t restSumY = 0;
+};
+
+/**
+ * @struct SimdKernelTable
+ * @brief Bound kernel variants
+ */
+struct SimdKernelTable {
+    // Scaled radial deadzone, in place, over interleaved x,y stick pairs
+    void (*radialDeadzone)(SHORT* xy, size_t pairs, float deadzone, float antiDeadzone);
+    // XInput buttons to DirectInput button bytes 0-15 (0x80 = pressed)
+    void (*encodeDInputButtons)(WORD buttons, BYTE* rgbButtons);
+    // Equality of two 12-byte gamepad reports (TranslatedState::GamepadState)
+    bool (*sameGamepad)(const void* a, const void* b);
+    // Accumulate StickStats over interleaved x,y pairs (exact integer math in every variant)
+    void (*stickStats)(const SHORT* xy, size_t pairs, int32_t restWindow, StickStats& stats);
+
+    const char* radialDeadzoneVariant;
+    const char* encodeDInputButtonsVariant;
+    const char* sameGamepadVariant;
+    const char* stickStatsVariant;
+};
+
+/**
+ * @class SimdKernels
+ * @brief Selects and exposes the kernel variants for this CPU
+ */
+class SimdKernels {
+public:
+    static constexpr size_t GAMEPAD_REPORT_BYTES = 12;
+
+    static const SimdKernelTable& active();
+
+    /**
+     * @brief Bind the best variants up to a level
+     *
+     * Safe while other threads run kernels: they finish with the table they
+     * fetched and pick up the new one on their next active() call.
+     *
+     * @return The level actually bound (capped by what the CPU supports)
+     */
+    static SimdLevel select(SimdLevel maxLevel);
+
+    static SimdLevel supportedLevel();
+
+    /**
+     * @brief Table of one level without binding it (level must be supported)
+     */
+    static SimdKernelTable tableFor(SimdLevel level);
+
+    static const char* levelName(SimdLevel level);
+    static bool parseLevel(const std::string& name, SimdLevel& level);
+
+    // Active hot-path variants, e.g. "deadzone=avx2 buttons=bmi2 dedup=sse4.1"
+    static std::string describe();
+};
+
+// Variants, exposed for tests and benchmarks; use SimdKernels::active() in the pipeline
+namespace SimdVariants {
+    void radialDeadzoneScalar(SHORT* xy, size_t pairs, float deadzone, float antiDeadzone);
+    void encodeDInputButtonsScalar(WORD buttons, BYTE* rgbButtons);
+    bool sameGamepadScalar(const void* a, const void* b);
+    void stickStatsScalar(const SHORT* xy, size_t pairs, int32_t restWindow, StickStats& stats);
+
+#ifdef XIDP_SIMD_X86
+    void radialDeadzoneSse41(SHORT* xy, size_t pairs, float deadzone, float antiDeadzone);
+    void encodeDInputButtonsSse41(WORD buttons, BYTE* rgbButtons);
+    bool sameGamepadSse41(const void* a, const void* b);
+    void stickStatsSse41(const SHORT* xy, size_t pairs, int32_t restWindow, StickStats& stats);
+
+    void radialDeadzoneAvx2(SHORT* xy, size_t pairs, float deadzone, float antiDeadzone);
+    void encodeDInputButtonsBmi2(WORD buttons, BYTE* rgbButtons);
+    void stickStatsAvx2(const SHORT* xy, size_t pairs, int32_t restWindow, StickStats& stats);
+
+    void radialDeadzoneAvx512(SHORT* xy, size_t pairs, float deadzone, float antiDeadzone);
+#endif
+}
@@ -0,0 +1,124 @@
+/**
+ * @file source_arbiter.hpp
+ * @brief Freshest-source arbitration for pads visible through both XInput and HID
+ *
+ * An Xbox controller matched to an XInput slot also exposes an IG_ HID
+ * collection. The two paths are serviced by different driver stacks and
+ * deliver the same physical change at different times. The arbiter accepts
+ * timestamped updates from both paths and forwards whichever source produced
+ * the newest distinct state first. When the slower path later reports the
+ * same state it is recognised as an echo and only used to measure how far
+ * behind it was, so a quick tap seen by both paths is never replayed.
+ *
+ * The arbiter is plain state with no locking; InputCapture drives it under
+ * its state mutex.
+ */
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include "core/input_capture.hpp"
+
+/**
+ * @enum CaptureSource
+ * @brief Input path a gamepad state was read from
+ */
+enum class CaptureSource : uint8_t {
+    XINPUT = 0,
+    HID = 1
+};
+
+/**
+ * @class SourceArbiter
+ * @brief Per-physical-device selection between the XInput and HID paths
+ */
+class SourceArbiter {
+public:
+    static constexpr size_t MAX_DEVICES = XUSER_MAX_COUNT;
+    static constexpr size_t SOURCE_COUNT = 2;
+    static constexpr size_t PENDING_DEPTH = 8;       // Forwarded states awaiting the other path
+    static constexpr int STICK_MATCH_TOLERANCE = 256; // HID and XInput stick scaling differ slightly
+
+    /**
+     * @struct Metrics
+     * @brief Arbitration statistics of one device, indexed by CaptureSource
+     *
+     * Lead times are in performance counter ticks: how much earlier the
+     * winning source delivered a state the other source later confirmed.
+     */
+    struct Metrics {
+        std::array<uint64_t, SOURCE_COUNT> updates{};    // Distinct states reported
+        std::array<uint64_t, SOURCE_COUNT> wins{};       // States forwarded from this source
+        std::array<uint64_t, SOURCE_COUNT> confirmed{};  // Wins later seen on the other source
+        std::array<uint64_t, SOURCE_COUNT> stale{};      // Updates older than the forwarded state
+        std::array<uint64_t, SOURCE_COUNT> totalLeadTicks{};
+        std::array<uint64_t, SOURCE_COUNT> maxLeadTicks{};
+
+        uint64_t averageLeadTicks(CaptureSource source) const {
+            size_t s = static_cast<size_t>(source);
+            return confirmed[s] ? totalLeadTicks[s] / confirmed[s] : 0;
+        }
+    };
+
+    SourceArbiter();
+
+    /**
+     * @brief Offer an update from one source
+     *
+     * @param device Physical device index (XInput slot)
+     * @param source Path the update was read from
+     * @param gamepad State decoded from that path
+     * @param timestamp Performance counter value when the update was read
+     * @return true if the forwarded state changed
+     */
+    bool submit(int device, CaptureSource source, const XINPUT_GAMEPAD& gamepad, uint64_t timestamp);
+
+    /**
+     * @brief State to forward downstream for a device
+     */
+    const XINPUT_GAMEPAD& current(int device) const { return m_devices[device].forwarded; }
+    CaptureSource lastWinner(int device) const { return m_devices[device].lastWinner; }
+    const Metrics& getMetrics(int device) const { return m_devices[device].metrics; }
+
+    /**
+     * @brief Forget history and metrics, e.g. after the pad was unplugged
+     */
+    void reset(int device);
+
+    /**
+     * @brief Whether two states describe the same physical input
+     *
+     * The HID collection cannot report the Guide button and folds both
+     * triggers into one axis, so those are compared the way HID sees them.
+     */
+    static bool equivalent(const XINPUT_GAMEPAD& a, const XINPUT_GAMEPAD& b);
+
+    /**
+     * @brief Decode the Xbox HID collection (buttons 1-10, hat, X/Y/Rx/Ry, combined Z)
+     */
+    static XINPUT_GAMEPAD fromXboxHID(const ControllerState& state);
+
+private:
+    struct PendingState {
+        XINPUT_GAMEPAD gamepad;
+        uint64_t timestamp;
+        CaptureSource source;
+        bool valid;
+    };
+
+    struct DeviceState {
+        XINPUT_GAMEPAD forwarded{};
+        uint64_t forwardedTimestamp = 0;
+        CaptureSource lastWinner = CaptureSource::XINPUT;
+        std::array<XINPUT_GAMEPAD, SOURCE_COUNT> lastSeen{};
+        std::array<bool, SOURCE_COUNT> hasSeen{};
+        std::array<PendingState, PENDING_DEPTH> pending{};
+        size_t pendingHead = 0;
+        Metrics metrics;
+    };
+
+    // Match an update against states the other source already forwarded
+    bool confirmPending(DeviceState& device, CaptureSource source, const XINPUT_GAMEPAD& gamepad, uint64_t timestamp);
+
+    std::array<DeviceState, MAX_DEVICES> m_devices;
+};
@@ -0,0 +1,306 @@
+/**
+ * @file state_stream.hpp
+ * @brief Streaming translated controller frames to another machine over UDP
+ *
+ * A sender publishes every frame of translated states (all controllers in one
+ * datagram) and a receiver on the rig turns them back into TranslatedStates
+ * for its VirtualDeviceEmulator.
+ *
+ * Wire format, little endian:
+ *
+ *   header   'X' 'S' version flags  session:u32  seq:u32  keyframeSeq:u32
+ *            timestampUs:u64  count:u8                         (25 bytes)
+ *   entry    slot:u8  mask:u8  fields present in mask, in bit order:
+ *            0 buttons:u16  1 LT:u8  2 RT:u8  3 LX:i16  4 LY:i16
+ *            5 RX:i16  6 RY:i16  7 identity (meta:u8, sourceUserId:i16)
+ *
+ * A keyframe (flags bit 0) carries every controller with every field. Other
+ * frames carry, per controller, only the fields that differ from the keyframe
+ * they name, so a lost delta costs only itself. A lost keyframe is worse:
+ * every delta naming it is undecodable until the next keyframe, so on the
+ * first such delta the receiver sends the sender a keyframe request
+ *
+ *   request  'X' 'S' version 0x02  session:u32                 (8 bytes)
+ *
+ * and the sender makes its next frame a keyframe. Keyframes also go out every
+ * keyframe interval and whenever the controller set changes; frames identical
+ * to the previous one are not sent at all.
+ *
+ * The receiver is latest-wins: anything older than the newest applied frame is
+ * dropped, and when several datagrams are queued only the newest is delivered.
+ * A new sender session (restart) resets it, so the receiver should listen on
+ * loopback or only accept its configured sender (setAllowedPeer()). Motion
+ * samples are not streamed.
+ */
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "core/translation_layer.hpp"
+
+/**
+ * @class StateStreamEncoder
+ * @brief Turns frames of translated states into keyframe/delta datagrams
+ */
+class StateStreamEncoder {
+public:
+    static constexpr size_t HEADER_SIZE = 25;
+    static constexpr size_t MAX_CONTROLLERS = 255;
+
+    /**
+     * @param keyframeIntervalUs Longest time between two keyframes
+     * @param session Sender session id (0: pick a random one)
+     */
+    explicit StateStreamEncoder(uint64_t keyframeIntervalUs = 50000, uint32_t session = 0);
+
+    /**
+     * @brief Encode one frame
+     * @param states Controllers of the frame (at most MAX_CONTROLLERS are sent)
+     * @param timestampUs Sender clock, echoed to the receiver
+     * @param out Datagram; left empty if the frame equals the previous one
+     * @return True if a datagram was produced
+     */
+    bool encode(const std::vector<TranslatedState>& states, uint64_t timestampUs, std::vector<uint8_t>& out);
+
+    // Make the next encode() a keyframe (e.g. after a receiver joined)
+    void forceKeyframe() { m_forceKeyframe = true; }
+
+    uint32_t getSession() const { return m_session; }
+    uint32_t getSequence() const { return m_sequence; }
+
+private:
+    struct Slot {
+        uint8_t meta;
+        int16_t sourceUserId;
+        TranslatedState::GamepadState gamepad;
+    };
+
+    static Slot makeSlot(const TranslatedState& state);
+
+    uint64_t m_keyframeIntervalUs;
+    uint32_t m_session;
+    uint32_t m_sequence;
+    uint32_t m_keyframeSequence;
+    uint64_t m_keyframeUs;
+    bool m_forceKeyframe;
+    std::vector<Slot> m_keyframe;    // Baseline the deltas refer to
+    std::vector<Slot> m_previous;    // Last frame sent
+};
+
+/**
+ * @class StateStreamDecoder
+ * @brief Rebuilds frames from datagrams, latest-wins
+ */
+class StateStreamDecoder {
+public:
+    enum class Result {
+        APPLIED,        // Newest frame so far; frame filled
+        STALE,          // Duplicate or older than the last applied frame
+        NO_KEYFRAME,    // Delta whose keyframe was lost; waits for the next one (frame.session set)
+        MALFORMED
+    };
+
+    /**
+     * @struct Frame
+     * @brief One decoded frame; states[i].sourceSlot is the sender's slot i
+     */
+    struct Frame {
+        uint32_t session = 0;
+        uint32_t sequence = 0;
+        uint64_t timestampUs = 0;
+        bool keyframe = false;
+        std::vector<TranslatedState> states;
+    };
+
+    /**
+     * @struct Stats
+     * @brief Datagram counters
+     */
+    struct Stats {
+        uint64_t applied = 0;
+        uint64_t keyframes = 0;
+        uint64_t stale = 0;
+        uint64_t noKeyframe = 0;
+        uint64_t malformed = 0;
+        uint64_t lost = 0;          // Sequence numbers skipped between applied frames
+        uint64_t sessions = 0;      // Sender sessions seen
+    };
+
+    StateStreamDecoder();
+
+    Result decode(const uint8_t* data, size_t length, Frame& frame);
+
+    /**
+     * @brief Build the datagram asking the sender of session for a keyframe
+     */
+    static void encodeKeyframeRequest(uint32_t session, std::vector<uint8_t>& out);
+
+    /**
+     * @brief True if data is a keyframe request for session
+     */
+    static bool isKeyframeRequest(const uint8_t* data, size_t length, uint32_t session);
+
+    Stats getStats() const { return m_stats; }
+
+private:
+    bool m_synced;              // A session is known
+    uint32_t m_session;
+    bool m_haveApplied;         // m_lastSequence is valid
+    uint32_t m_lastSequence;
+    bool m_haveKeyframe;
+    uint32_t m_keyframeSequence;
+    std::vector<TranslatedState> m_keyframe;
+    Stats m_stats;
+};
+
+/**
+ * @class UdpStreamSender
+ * @brief Publishes frames to one receiver
+ */
+class UdpStreamSender {
+public:
+    /**
+     * @struct Stats
+     * @brief Send counters
+     */
+    struct Stats {
+        uint64_t frames = 0;        // send() calls
+        uint64_t datagrams = 0;     // Datagrams handed to the socket
+        uint64_t bytes = 0;
+        uint64_t skipped = 0;       // Frames equal to the previous one
+        uint64_t errors = 0;        // Datagrams the socket refused
+        uint64_t keyframeRequests = 0;  // Receiver requests honored
+    };
+
+    explicit UdpStreamSender(uint64_t keyframeIntervalUs = 50000);
+    ~UdpStreamSender();
+
+    UdpStreamSender(const UdpStreamSender&) = delete;
+    UdpStreamSender& operator=(const UdpStreamSender&) = delete;
+
+    /**
+     * @brief Resolve the receiver and open a non-blocking socket to it
+     */
+    bool open(const std::string& host, uint16_t port);
+    void close();
+    bool isOpen() const { return m_socket != INVALID_HANDLE; }
+
+    /**
+     * @brief Encode and send one frame (nothing is sent for an unchanged frame)
+     *
+     * Keyframe requests the receiver sent back are read first, so a requested
+     * keyframe goes out with this frame.
+     *
+     * @return False if a datagram was due and could not be sent
+     */
+    bool send(const std::vector<TranslatedState>& states, uint64_t nowUs);
+
+    // Next frame goes out as a keyframe
+    void forceKeyframe() { m_encoder.forceKeyframe(); }
+
+    Stats getStats() const { return m_stats; }
+
+private:
+    static constexpr intptr_t INVALID_HANDLE = -1;
+
+    void readRequests();
+
+    intptr_t m_socket;
+    StateStreamEncoder m_encoder;
+    std::vector<uint8_t> m_buffer;
+    Stats m_stats;
+};
+
+/**
+ * @class UdpStreamReceiver
+ * @brief Receives frames and hands the newest to a callback
+ */
+class UdpStreamReceiver {
+public:
+    using FrameCallback = std::function<void(const StateStreamDecoder::Frame& frame)>;
+
+    // Address family (4 or 6) followed by the address bytes
+    using HostKey = std::array<uint8_t, 17>;
+
+    /**
+     * @struct Stats
+     * @brief Receive counters (decoder counters included)
+     */
+    struct Stats {
+        uint64_t datagrams = 0;
+        uint64_t bytes = 0;
+        uint64_t delivered = 0;           // Frames handed to the callback
+        uint64_t superseded = 0;          // Applied frames replaced by a newer one in the same drain
+        uint64_t lastReceiveUs = 0;       // Local clock when the last delivered frame was read
+        uint64_t rejected = 0;            // Datagrams from hosts other than the allowed peer
+        uint64_t keyframeRequests = 0;    // Keyframe requests sent after a lost keyframe
+        StateStreamDecoder::Stats decoder;
+    };
+
+    UdpStreamReceiver();
+    ~UdpStreamReceiver();
+
+    UdpStreamReceiver(const UdpStreamReceiver&) = delete;
+    UdpStreamReceiver& operator=(const UdpStreamReceiver&) = delete;
+
+    /**
+     * @brief Bind the listening socket
+     * @param port UDP port (0: any free port, see getPort())
+     * @param bindAddress Local address; anything but loopback exposes the
+     *        receiver to the network, so pair it with setAllowedPeer()
+     */
+    bool open(uint16_t port, const std::string& bindAddress = "127.0.0.1");
+    void close();
+    uint16_t getPort() const { return m_port; }
+
+    /**
+     * @brief Only accept datagrams from this host (any source port)
+     * @param host Sender address or name; empty accepts every host
+     * @return False if host does not resolve (nothing is accepted then)
+     */
+    bool setAllowedPeer(const std::string& host);
+
+    void setFrameCallback(FrameCallback callback);
+
+    /**
+     * @brief Wait for datagrams, drain the socket and deliver the newest frame
+     * @param timeoutMs How long to wait for the first datagram (0: don't wait)
+     * @return Datagrams read
+     */
+    size_t poll(int timeoutMs);
+
+    /**
+     * @brief Run poll() on a thread until stop()
+     */
+    void start();
+    void stop();
+    bool isRunning() const { return m_running; }
+
+    Stats getStats() const;
+
+private:
+    static constexpr intptr_t INVALID_HANDLE = -1;
+
+    intptr_t m_socket;
+    uint16_t m_port;
+    StateStreamDecoder m_decoder;
+    std::vector<uint8_t> m_buffer;
+    FrameCallback m_callback;
+
+    bool m_peerFiltered;
+    std::vector<HostKey> m_allowedPeers;
+    uint32_t m_requestedSession;                        // Keyframe already requested (0: none)
+    std::vector<uint8_t> m_request;
+
+    std::atomic<bool> m_running;
+    std::thread m_thread;
+
+    mutable std::mutex m_statsMutex;
+    Stats m_stats;
+};
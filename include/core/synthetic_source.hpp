@@ -0,0 +1,87 @@
+/**
+ * @file synthetic_source.hpp
+ * @brief In-process input source with sequence-stamped button edges
+ *
+ * A generator thread plays the part of the devices: every controller sends a
+ * report at its report rate (controllers are staggered across the period),
+ * and the newest report of each controller becomes visible to the next
+ * update(), the way a completed HID read or a new XInput packet does.
+ *
+ * Each report carries a 16-bit per-controller sequence number in the right
+ * stick X axis (passed through translation unchanged while stick deadzones are
+ * off), and the A button toggles every reportsPerEdge reports. Every toggle is
+ * recorded as an Edge with the time its report became available, so a probe
+ * on the output side can compute capture-to-report latency.
+ */
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "core/input_source.hpp"
+#include "core/input_capture.hpp"
+
+/**
+ * @class SyntheticInputSource
+ * @brief Simulated XInput controllers driven by a generator thread
+ */
+class SyntheticInputSource : public InputSource {
+public:
+    struct Config {
+        size_t controllers = 1;
+        uint32_t reportRateHz = 1000;
+        uint32_t reportsPerEdge = 8;    // A toggles every N reports
+    };
+
+    /**
+     * @struct Edge
+     * @brief One generated button edge
+     */
+    struct Edge {
+        size_t controller;
+        uint16_t sequence;        // Sequence number of the report that carried the edge
+        bool pressed;
+        uint64_t generatedUs;     // When the report became available to update()
+    };
+
+    explicit SyntheticInputSource(const Config& config);
+    ~SyntheticInputSource() override;
+
+    void start();
+    void stop();
+
+    void update(double deltaTime) override;
+    std::vector<ControllerState> getInputStates() const override;
+
+    /**
+     * @brief Timestamp (microseconds) of the newest report of a controller seen by update()
+     */
+    uint64_t lastReportUs(size_t controller) const;
+
+    /**
+     * @brief All edges generated so far, in generation order
+     */
+    std::vector<Edge> getEdges() const;
+
+    const Config& getConfig() const { return m_config; }
+
+    static uint16_t sequenceOf(SHORT thumbRX) { return static_cast<uint16_t>(thumbRX); }
+
+    static uint64_t nowUs();
+
+private:
+    void generate();
+
+    Config m_config;
+    std::atomic<bool> m_running;
+    std::thread m_generator;
+
+    mutable std::mutex m_mutex;
+    std::vector<ControllerState> m_pending;     // Newest generated report per controller
+    std::vector<uint64_t> m_pendingUs;
+    std::vector<ControllerState> m_visible;     // What the last update() picked up
+    std::vector<uint64_t> m_visibleUs;
+    std::vector<Edge> m_edges;
+};
@@ -0,0 +1,147 @@
+/**
+ * @file target_health.hpp
+ * @brief Per-target health tracking and reconnection for virtual devices
+ *
+ * A submit to the virtual bus can fail transiently (driver busy) or for good
+ * (target unplugged by the bus, driver restarted). Each target moves through:
+ *
+ *   HEALTHY      -> submits go straight through
+ *   DEGRADED     -> recent failures; submits continue, the last failed report
+ *                   is retried a bounded number of times, retryDelayUs apart
+ *   RECONNECTING -> too many consecutive failures; submits are skipped and the
+ *                   target is re-plugged on the bus with exponential backoff
+ *   DEAD         -> re-plug budget exhausted; nothing is attempted until the
+ *                   target is tracked again (e.g. the physical device re-arrives)
+ *
+ * The bus is an interface so the state machine can be driven by a mock bus
+ * that injects failures. Bus calls are made without holding the monitor lock,
+ * so the bus implementation may take its own locks.
+ *
+ * Retries must never overtake newer reports: every submit() gets a per-target
+ * sequence number and a retry is dropped once a newer report was submitted.
+ * Call submit() and service() for one target from one thread (the proxy's
+ * injection thread), so retries and new reports share one ordered path.
+ */
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <vector>
+#include "core/translation_layer.hpp"
+
+/**
+ * @class VirtualBus
+ * @brief Where virtual targets live (ViGEmBus in the proxy, a mock in tests)
+ */
+class VirtualBus {
+public:
+    virtual ~VirtualBus() = default;
+
+    // Send one report to a target; false on failure
+    virtual bool submit(int targetId, const TranslatedState& state) = 0;
+
+    // Remove the target from the bus (if still present) and add it again
+    virtual bool replug(int targetId) = 0;
+};
+
+/**
+ * @class TargetHealthMonitor
+ * @brief Health state machine, bounded retry and re-plug backoff per target
+ */
+class TargetHealthMonitor {
+public:
+    enum class Health {
+        HEALTHY,
+        DEGRADED,
+        RECONNECTING,
+        DEAD
+    };
+
+    /**
+     * @struct Policy
+     * @brief Error budget and backoff settings
+     */
+    struct Policy {
+        uint32_t failuresToReconnect = 3;       // Consecutive failures before re-plugging
+        uint32_t maxRetries = 2;                // Retries of one failed report
+        uint64_t retryDelayUs = 2000;           // Wait before each retry, so a transient error can clear
+        uint32_t maxReconnectAttempts = 6;      // Re-plug attempts before giving up
+        uint64_t initialBackoffUs = 50000;      // Wait before the first re-plug
+        uint64_t maxBackoffUs = 2000000;
+    };
+
+    /**
+     * @struct Metrics
+     * @brief Counters of one target
+     */
+    struct Metrics {
+        Health health = Health::HEALTHY;
+        uint64_t submits = 0;            // Successful submits
+        uint64_t failures = 0;           // Failed submits
+        uint64_t retries = 0;            // Retry submits of a failed report
+        uint64_t skipped = 0;            // Reports not attempted (reconnecting or dead)
+        uint64_t reconnectAttempts = 0;
+        uint64_t reconnects = 0;         // Successful re-plugs
+        uint32_t consecutiveFailures = 0;
+        uint64_t backoffUs = 0;          // Current wait between re-plug attempts
+    };
+
+    TargetHealthMonitor();
+
+    void setPolicy(const Policy& policy);
+    Policy getPolicy() const;
+
+    /**
+     * @brief Start tracking a target as healthy (new target, or revive a dead one)
+     */
+    void track(int targetId);
+    void untrack(int targetId);
+
+    /**
+     * @brief Submit through the bus unless the target is reconnecting or dead
+     *
+     * @return True when the report reached the bus
+     */
+    bool submit(VirtualBus& bus, int targetId, const TranslatedState& state, uint64_t nowUs);
+
+    /**
+     * @brief Retry failed reports and re-plug targets whose backoff has expired
+     *
+     * Called from the inject thread; does nothing for healthy or dead targets.
+     */
+    void service(VirtualBus& bus, uint64_t nowUs);
+
+    /**
+     * @brief Earliest time service() has work to do, or UINT64_MAX
+     */
+    uint64_t nextServiceUs() const;
+
+    Health health(int targetId) const;
+    Metrics getMetrics(int targetId) const;
+    std::vector<int> trackedTargets() const;
+
+    static const char* healthName(Health health);
+
+private:
+    struct Target {
+        Metrics metrics;
+        uint32_t reconnectAttempts = 0;   // Since the target last went down
+        uint64_t nextReconnectUs = 0;
+        uint64_t submitSequence = 0;      // Reports handed to submit() so far
+        bool hasRetry = false;            // Newest failed report, resent by service()
+        TranslatedState retryState{};
+        uint64_t retrySequence = 0;       // submitSequence of retryState
+        uint32_t retryCount = 0;
+        uint64_t nextRetryUs = 0;
+        bool hasLatest = false;           // Newest report, sent after a successful re-plug
+        TranslatedState latestState{};
+    };
+
+    void recordSubmit(Target& target, bool ok, uint64_t nowUs);
+    void recordReconnect(Target& target, bool ok, uint64_t nowUs);
+
+    mutable std::mutex m_mutex;
+    Policy m_policy;
+    std::map<int, Target> m_targets;
+};
@@ -0,0 +1,109 @@
+/**
+ * @file target_injector.hpp
+ * @brief Output stage of a proxy loop: shaping, ordered submits and target health
+ *
+ * VirtualDeviceEmulator (ViGEmBus) and every Pipeline (any VirtualBus) send
+ * translated states the same way, through one TargetInjector:
+ *
+ *   offer()  runs released states through the output shaper and queues them
+ *   pump()   submits the queue and the shaper's due states through the target
+ *            health monitor, then services its retries and re-plugs
+ *
+ * With start(), an injection thread pumps whenever a state is queued or a
+ * shaper/health deadline passes; without it, the owner calls pump() itself.
+ *
+ * Shaping decisions and the queue share one mutex and only one thread pumps,
+ * so states reach a target in release order: an older held state can never be
+ * submitted after a newer edge (see OutputShaper). A submit that does not
+ * reach the bus is forgotten by the shaper, so it is not treated as the last
+ * report the target saw.
+ */
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "core/output_shaper.hpp"
+#include "core/target_health.hpp"
+#include "core/translation_layer.hpp"
+#include "utils/logger.hpp"
+
+/**
+ * @class TargetInjector
+ * @brief Shapes translated states and submits them to their bus targets in order
+ */
+class TargetInjector {
+public:
+    // Bus target of a released state, or -1 to drop it (no such target)
+    using TargetResolver = std::function<int(const TranslatedState& state)>;
+
+    TargetInjector(VirtualBus& bus, TargetResolver resolver);
+    ~TargetInjector();
+
+    TargetInjector(const TargetInjector&) = delete;
+    TargetInjector& operator=(const TargetInjector&) = delete;
+
+    void setOutputShaping(bool enabled, uint32_t maxRateHz);
+    bool isOutputShapingEnabled() const { return m_outputShapingEnabled; }
+    void setHealthPolicy(const TargetHealthMonitor::Policy& policy);
+
+    /**
+     * @brief Shape released states and queue the ones to submit for the next pump()
+     */
+    void offer(const std::vector<TranslatedState>& states, uint64_t nowUs);
+
+    /**
+     * @brief Submit queued and due states, then service target health
+     *
+     * The injection thread's loop body; call it from one thread at a time.
+     */
+    void pump(uint64_t nowUs);
+
+    /**
+     * @brief Pump on an injection thread until stop()
+     * @param highPriority Raise the thread's priority
+     * @param sink Log sink for the thread's Logger calls (nullptr: process log)
+     */
+    void start(bool highPriority = false, LogSink* sink = nullptr);
+    void stop();
+    bool isRunning() const { return m_thread.joinable(); }
+
+    // Target lifetime: track a target when it is created, forget it when it is destroyed
+    void trackTarget(int targetId);
+    void forgetTarget(int targetId, TranslatedState::TargetType type, int userId);
+
+    OutputShaper::Metrics getOutputMetrics(TranslatedState::TargetType type, int userId) const {
+        return m_outputShaper.getMetrics(type, userId);
+    }
+    TargetHealthMonitor::Metrics getTargetHealth(int targetId) const {
+        return m_targetHealth.getMetrics(targetId);
+    }
+
+    // Reports handed to the target health monitor (delivered or not)
+    uint64_t getSubmits() const { return m_submits; }
+
+private:
+    static constexpr uint64_t MAX_IDLE_US = 1000;   // Longest sleep of the injection thread
+
+    void run(bool highPriority, LogSink* sink);
+    void submitToTarget(const TranslatedState& state, uint64_t nowUs);
+
+    VirtualBus& m_bus;
+    TargetResolver m_resolver;
+
+    std::atomic<bool> m_outputShapingEnabled;
+    OutputShaper m_outputShaper;
+    TargetHealthMonitor m_targetHealth;
+    std::atomic<uint64_t> m_submits;
+
+    std::mutex m_queueMutex;
+    std::condition_variable m_queueReady;
+    std::vector<TranslatedState> m_queue;
+    std::vector<TranslatedState> m_batch;   // Swapped with m_queue by pump()
+    std::atomic<bool> m_running;
+    std::thread m_thread;
+};
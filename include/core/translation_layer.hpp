@@ -11,7 +11,12 @@
 #include <cstdint>
 #include <algorithm>
 #include <array>
+#include <memory>
 #include "core/input_capture.hpp"
+#include "core/device_splitter.hpp"
+#include "core/profile_library.hpp"
+
+class WorkStealingPool;
 
 /**
  * @struct TranslatedState
@@ -22,6 +27,7 @@
  */
 struct TranslatedState {
     int sourceUserId;  // Original controller ID
+    int sourceSlot;    // Index of the source in the captured state list
     bool isXInputSource;  // True if source was XInput, false if HID
     
     // Translated gamepad state (standardized format)
@@ -34,6 +40,9 @@ struct TranslatedState {
         SHORT sThumbRX;
         SHORT sThumbRY;
     } gamepad;
+
+    // Motion sensor sample (valid only for sources with a motion report plan)
+    MotionState motion;
     
     // Timestamp of when this state was translated
     uint64_t timestamp;
@@ -60,7 +69,7 @@ struct TranslatedState {
 class TranslationLayer {
 public:
     TranslationLayer();
-    ~TranslationLayer() = default;
+    ~TranslationLayer();
     
     // Translate input states from source format to target format
     std::vector<TranslatedState> translate(const std::vector<ControllerState>& inputStates);
@@ -87,6 +96,31 @@ public:
     void setRightStickAntiDeadzone(float antiDeadzone);
     float getLeftStickDeadzone() const { return m_leftStickDeadzone; }
     float getRightStickDeadzone() const { return m_rightStickDeadzone; }
+
+    // Motion sensors
+    void setMotionPassthroughEnabled(bool enabled);
+    void setGyroToStickEnabled(bool enabled);
+    void setGyroSensitivity(float sensitivity);
+    void setGyroSmoothing(float smoothing);
+    void setGyroDeadzone(int deadzone);
+    void setGyroRatchetButtons(WORD buttons);
+    bool isMotionPassthroughEnabled() const { return m_motionPassthroughEnabled; }
+    bool isGyroToStickEnabled() const { return m_gyroToStickEnabled; }
+    
+    // Parallel translation: frames with at least minControllers inputs are split into
+    // chunks run on a persistent work-stealing pool (workers = 0: always serial)
+    void setParallelTranslation(size_t workers, size_t minControllers);
+    size_t getParallelWorkers() const;
+    size_t getParallelThreshold() const { return m_parallelThreshold; }
+    bool wasLastTranslateParallel() const { return m_lastTranslateParallel; }
+    
+    // Split one physical device into several virtual controllers
+    void setSplitConfiguration(const std::vector<SplitDeviceConfig>& devices);
+    const DeviceSplitter& getDeviceSplitter() const { return m_deviceSplitter; }
+    
+    // Device mapping profiles (nullptr restores the built-in library)
+    void setProfileLibrary(std::shared_ptr<const ProfileLibrary> library);
+    const ProfileLibrary& getProfileLibrary() const;
     
     // Translate standardized state to XInput format
     XINPUT_STATE translateToXInput(const TranslatedState& state);
@@ -107,18 +141,15 @@ public:
         WORD wButtons;
         BYTE bLeftTrigger;
         BYTE bRightTrigger;
+
+        // Motion passthrough (sent via the extended DS4 report)
+        MotionState motion;
     };
     DInputState translateToDInput(const TranslatedState& state);
 
 private:
-    struct HIDMappingProfile {
-        std::wstring productName;
-        std::unordered_map<USAGE, WORD> buttonMap;
-        std::unordered_map<USAGE, int> axisMap; // Index into gamepad axes
-    };
-    std::unordered_map<std::wstring, HIDMappingProfile> m_deviceProfiles;
+    std::shared_ptr<const ProfileLibrary> m_profiles;  // Device-specific mappings, looked up per HID device
     
-    void initializeProfiles();
     bool m_xinputToDInputEnabled;
     bool m_dinputToXInputEnabled;
     bool m_socdCleaningEnabled;
@@ -133,24 +164,81 @@ private:
     float m_leftStickAntiDeadzone;
     float m_rightStickAntiDeadzone;
 
+    // Motion sensor settings
+    bool m_motionPassthroughEnabled;
+    bool m_gyroToStickEnabled;
+    GyroStickMapper m_gyroMapper;
+
     // Internal state for debouncing (fixed size to prevent unbounded growth)
     static constexpr size_t MAX_CONTROLLERS = 16;
     std::array<uint64_t, MAX_CONTROLLERS> m_lastButtonChangeTime;
+    std::array<GyroFilterState, MAX_CONTROLLERS> m_gyroFilters;
 
     // Apply SOCD cleaning to a gamepad state
     void applySOCDControl(TranslatedState::GamepadState& gamepad);
 
-    // Apply debouncing to a gamepad state
-    bool applyDebouncing(int userId, WORD currentButtons, WORD& cleanedButtons);
+    // Apply debouncing to a gamepad state (lastChangeTime is the per-output debounce state)
+    bool applyDebouncing(uint64_t& lastChangeTime, WORD currentButtons, WORD& cleanedButtons);
+    
+    // SOCD, debouncing and (unless batched by the caller) stick deadzones for one output
+    void applyInputProcessing(TranslatedState& translatedState, uint64_t* lastButtonChangeTime,
+                              bool stickDeadzone);
+    
+    // Split devices: one decode, several outputs
+    DeviceSplitter m_deviceSplitter;
+    void translateSplitDevice(const DeviceSplitter::Binding& binding, size_t slot, const ControllerState& inputState,
+                              std::vector<TranslatedState>& translatedStates);
+
+    // What the HID device in one input slot resolves to, kept until another device shows up there
+    struct SlotBinding {
+        bool resolved = false;
+        std::wstring devicePath;
+        USHORT vendorId = 0;                 // With the path: a different device reusing the node rebinds
+        USHORT productId = 0;
+        int splitDevice = -1;                // -1: not split
+        DeviceSplitter::Binding split;
+        const ProfileLibrary::Profile* profile = nullptr;   // Into m_profiles; nullptr: generic mapping
+        LONG hatLogicalMin = 0;              // Logical min of the hat switch value cap
+    };
+    std::vector<SlotBinding> m_slotBindings;  // Sized per frame before any chunk runs
+    const SlotBinding& bindSlot(size_t slot, const ControllerState& inputState);
     
     // Apply scaled radial deadzone to stick axes
     void applyScaledRadialDeadzone(SHORT& thumbX, SHORT& thumbY, float deadzone, float antiDeadzone);
 
+    // Per-call scratch of translateRange(); one per parallel chunk
+    struct TranslateScratch {
+        std::vector<size_t> directStates;   // Indices of non-split states in the chunk's output
+        std::vector<SHORT> leftSticks;      // Interleaved x,y scratch for the batched deadzone
+        std::vector<SHORT> rightSticks;
+    };
+    
+    // Translate inputStates[begin, end) and append the results to translatedStates
+    void translateRange(const std::vector<ControllerState>& inputStates, size_t begin, size_t end,
+                        TranslateScratch& scratch, std::vector<TranslatedState>& translatedStates);
+    
+    // Stick deadzones of the scratch's direct states in one SIMD kernel call per stick
+    void applyBatchedStickDeadzones(std::vector<TranslatedState>& states, TranslateScratch& scratch);
+    TranslateScratch m_scratch;
+    
+    // Parallel translation. Filter state is owned per controller (debounce by userId,
+    // gyro filter by slot, split outputs by split device), so chunks share nothing as
+    // long as no two slots map to the same owner; frames where they do run serially.
+    bool controllersOwnTheirState(const std::vector<ControllerState>& inputStates);
+    void translateParallel(const std::vector<ControllerState>& inputStates,
+                           std::vector<TranslatedState>& translatedStates);
+    static constexpr size_t PARALLEL_MIN_CHUNK = 8;
+    std::unique_ptr<WorkStealingPool> m_pool;
+    size_t m_parallelThreshold;
+    bool m_lastTranslateParallel;
+    std::vector<TranslateScratch> m_chunkScratch;
+    std::vector<std::vector<TranslatedState>> m_chunkOutputs;
+
     // Convert XInput state to standardized format
     TranslatedState convertXInputToStandard(const ControllerState& inputState);
 
     // Convert HID state to standardized format
-    TranslatedState convertHIDToStandard(const ControllerState& inputState);
+    TranslatedState convertHIDToStandard(const ControllerState& inputState, const SlotBinding& binding);
 
 public:
     // Helpers for safe scaling
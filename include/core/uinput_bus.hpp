@@ -0,0 +1,180 @@
+/**
+ * @file uinput_bus.hpp
+ * @brief Linux output backend: virtual gamepads through /dev/uinput
+ *
+ * The Linux counterpart of VirtualDeviceEmulator's ViGEm targets. Each target
+ * is a uinput device with the evdev layout of the pad it stands in for:
+ * - X360: xpad identity (045E:028E), sticks -32768..32767 (Y down-positive),
+ *   triggers 0..255, D-pad as hat
+ * - DS4: hid-playstation identity (054C:05C4), sticks 0..255 with the same
+ *   byte conversion as the ViGEm DS4 report, digital L2/R2 alongside the
+ *   analog triggers
+ * Face buttons follow the Linux gamepad spec (BTN_SOUTH = A/Cross, ...).
+ *
+ * submit() diffs the state against what the target last emitted and sends
+ * only the changed keys and axes, plus SYN_REPORT, in a single write(). A
+ * frame without changes writes nothing.
+ *
+ * Targets advertise FF_RUMBLE. Effect uploads and erases from games arrive as
+ * EV_UINPUT requests on the uinput descriptor and are answered by
+ * pumpFeedback() (or the feedback thread, start()); playing an effect calls
+ * the rumble callback with the effect's strong/weak magnitudes, like the ViGEm
+ * X360 notification does on Windows.
+ *
+ * In MEMORY mode (no /dev/uinput, or chosen explicitly) nothing is created in
+ * the kernel: batches are encoded and diffed the same way and kept for
+ * inspection, so the pipeline and tests run unchanged.
+ */
+#pragma once
+
+#ifdef __linux__
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <linux/input.h>
+#include "core/target_health.hpp"
+#include "core/translation_layer.hpp"
+
+/**
+ * @class UinputBus
+ * @brief VirtualBus emitting X360/DS4 evdev gamepads
+ */
+class UinputBus : public VirtualBus {
+public:
+    enum class Mode {
+        UINPUT,       // Kernel devices through /dev/uinput
+        MEMORY        // Encoded batches kept in memory only
+    };
+
+    /**
+     * @struct Event
+     * @brief One evdev event of a batch
+     */
+    struct Event {
+        uint16_t type;
+        uint16_t code;
+        int32_t value;
+    };
+
+    /**
+     * @struct Stats
+     * @brief Counters of one target
+     */
+    struct Stats {
+        uint64_t submits = 0;
+        uint64_t writes = 0;         // Batches written (frames with at least one change)
+        uint64_t events = 0;         // Key/axis events, SYN_REPORT not counted
+        uint64_t rumbleEvents = 0;   // Rumble callback invocations
+        uint64_t lastWriteUs = 0;
+        uint64_t creations = 0;      // Device creations (first submit and replugs)
+    };
+
+    using RumbleCallback = std::function<void(int userId, float leftMotor, float rightMotor)>;
+
+    explicit UinputBus(Mode mode);
+    ~UinputBus() override;
+
+    UinputBus(const UinputBus&) = delete;
+    UinputBus& operator=(const UinputBus&) = delete;
+
+    /**
+     * @brief True if /dev/uinput can be opened by this process
+     */
+    static bool uinputAvailable();
+
+    /**
+     * @brief UINPUT mode when available, else MEMORY
+     */
+    static std::unique_ptr<UinputBus> create();
+
+    Mode getMode() const { return m_mode; }
+
+    // VirtualBus: targets are created on first submit, typed by state.targetType
+    bool submit(int targetId, const TranslatedState& state) override;
+    bool replug(int targetId) override;
+
+    // Called after the bus lock is released, so it may submit to the bus itself
+    void setRumbleCallback(RumbleCallback callback);
+
+    /**
+     * @brief Answer pending force-feedback requests (UINPUT mode)
+     * @param timeoutMs How long to wait for one (-1: until one arrives or wake)
+     * @return Requests and playback events handled
+     */
+    size_t pumpFeedback(int timeoutMs);
+
+    /**
+     * @brief Run pumpFeedback(-1) on a thread until stop()
+     */
+    void start();
+    void stop();
+
+    // Effect handling behind the EV_UINPUT/EV_FF requests (also drive MEMORY mode targets)
+    bool uploadEffect(int targetId, const ff_effect& effect);
+    bool eraseEffect(int targetId, int effectId);
+    void playEffect(int targetId, int effectId, bool play);
+
+    /**
+     * @brief Full evdev state of a state on a target type, in emission order
+     */
+    static void encode(TranslatedState::TargetType type, const TranslatedState& state, std::vector<Event>& out);
+
+    // Inspection
+    std::vector<Event> getLastBatch(int targetId) const;
+    int32_t getValue(int targetId, uint16_t type, uint16_t code) const;
+    Stats getStats(int targetId) const;
+    std::string getDeviceName(int targetId) const;   // sysfs name under /sys/devices/virtual/input (UINPUT mode)
+    size_t getTargetCount() const;
+
+private:
+    struct Target {
+        int id;
+        TranslatedState::TargetType type;
+        int fd;                                  // uinput descriptor, -1 in MEMORY mode
+        std::string sysname;
+        std::vector<Event> emitted;              // Last value of every key/axis, encode() order
+        std::vector<Event> lastBatch;
+        std::map<int, ff_effect> effects;        // Uploaded rumble effects by id
+        std::map<int, bool> playing;
+        Stats stats;
+
+        // submit() scratch, reused so a report allocates nothing once warm
+        std::vector<Event> encoded;
+        std::vector<Event> batch;
+        std::vector<input_event> events;
+    };
+
+    // Motor levels of one target, computed under the lock and delivered after it is released
+    struct Rumble {
+        int targetId;
+        float strong;
+        float weak;
+    };
+
+    Target* findTarget(int targetId);
+    const Target* findTarget(int targetId) const;
+    bool createDevice(Target& target);
+    void destroyDevice(Target& target);
+    void handleFeedback(Target& target, const input_event& event, std::vector<Rumble>& rumble);
+    Rumble rumbleOf(Target& target);
+    static void deliverRumble(const RumbleCallback& callback, const std::vector<Rumble>& rumble);
+
+    Mode m_mode;
+    int m_epoll;
+    int m_wakeFd;
+    std::atomic<bool> m_running;
+    std::thread m_thread;
+
+    mutable std::mutex m_mutex;
+    std::vector<std::unique_ptr<Target>> m_targets;
+    RumbleCallback m_rumbleCallback;
+};
+
+#endif // __linux__
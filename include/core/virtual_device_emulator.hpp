@@ -23,9 +23,13 @@ extern "C" {
 #include <mutex>
 #include <atomic>
 #include <functional>
+#include <unordered_map>
 #include "utils/logger.hpp"
 
 #include "core/translation_layer.hpp"
+#include "core/output_shaper.hpp"
+#include "core/target_health.hpp"
+#include "core/target_injector.hpp"
 
 // Forward declaration for ViGEmBus
 // Use void* to avoid including ViGEm headers or getting into typedef conflicts
@@ -44,9 +48,10 @@ class HidHideController;
  * - Rumble/vibration passthrough from games to physical controllers
  * - HidHide integration for physical device masking
  * - Thread-safe device management
+ * - Re-plugs failing targets with backoff instead of dropping them for good
  * - Automatic cleanup on shutdown
  */
-class VirtualDeviceEmulator {
+class VirtualDeviceEmulator : private VirtualBus {
 public:
     VirtualDeviceEmulator();
     ~VirtualDeviceEmulator();
@@ -65,6 +70,16 @@ public:
     // Configuration
     void setRumbleEnabled(bool enabled);
     void setRumbleIntensity(float intensity); // 0.0 to 1.0
+    
+    // Output rate shaping and failing targets (configured with Pipeline::configureOutput)
+    TargetInjector& getInjector() { return m_injector; }
+    bool isOutputShapingEnabled() const { return m_injector.isOutputShapingEnabled(); }
+    OutputShaper::Metrics getOutputMetrics(TranslatedState::TargetType type, int userId) const {
+        return m_injector.getOutputMetrics(type, userId);
+    }
+    TargetHealthMonitor::Metrics getTargetHealth(int deviceId) const {
+        return m_injector.getTargetHealth(deviceId);
+    }
 
     // HidHide integration
     void enableHidHideIntegration(bool enable);
@@ -111,6 +126,12 @@ private:
     // Methods for sending input to different device types
     bool sendToVirtualXInputDevice(int userId, const XINPUT_STATE& state);
     bool sendToVirtualDInputDevice(int userId, const TranslationLayer::DInputState& state);
+    bool submitTranslatedState(const TranslatedState& state);
+    int findVirtualDeviceId(TranslatedState::TargetType type, int userId) const;
+
+    // VirtualBus, driven by m_injector's target health monitor
+    bool submit(int targetId, const TranslatedState& state) override;
+    bool replug(int targetId) override;
 
     std::atomic<bool> m_initialized;
     std::atomic<bool> m_running;
@@ -134,7 +155,16 @@ private:
     // Callbacks
     DeviceCallback m_deviceCallback;
     RumbleCallback m_rumbleCallback;
-    static VirtualDeviceEmulator* m_instance;
+
+    // Rumble notifications carry their owner, so several emulators (one per
+    // pipeline) can coexist. One context per userId, kept until destruction
+    // because ViGEm may still deliver a notification while a target is torn down.
+    struct RumbleContext {
+        VirtualDeviceEmulator* owner;
+        int userId;
+    };
+    std::unordered_map<int, std::unique_ptr<RumbleContext>> m_rumbleContexts;
+    RumbleContext* rumbleContext(int userId);
     static void CALLBACK x360Notification(
         PVIGEM_CLIENT client,
         PVIGEM_TARGET target,
@@ -144,10 +174,9 @@ private:
         LPVOID userData
     );
 
-    // Threading for input injection
-    std::unique_ptr<std::thread> m_injectionThread;
-    std::mutex m_injectionQueueMutex;
-    std::vector<TranslatedState> m_injectionQueue;
+    // Shaping, ordered submits and target health. Its injection thread is the only
+    // sender; sendInput() only queues the states the shaper releases.
+    TargetInjector m_injector;
 
     // Error tracking
     std::string m_lastError;
@@ -0,0 +1,95 @@
+/**
+ * @file virtual_hid_device.hpp
+ * @brief Virtual HID devices for exercising the hidraw backend without hardware
+ *
+ * With /dev/uhid available (root, uhid module loaded) the device is created
+ * in the kernel from a recorded report descriptor, shows up as a real
+ * /dev/hidrawN node, and every sendReport() travels the same kernel path as
+ * a USB interrupt transfer. The device is created on BUS_VIRTUAL so vendor
+ * drivers (hid-playstation, hid-sony) leave it to hid-generic; HIDIOCGRAWINFO
+ * still reports the recorded vendor and product IDs.
+ *
+ * Without uhid it falls back to a SOCK_SEQPACKET socket pair attached with
+ * HidrawInputSource::addStream(): the same descriptor parsing, epoll wakeups
+ * and one-report-per-read semantics, minus the kernel HID core.
+ */
+#pragma once
+
+#ifdef __linux__
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class HidrawInputSource;
+
+/**
+ * @class VirtualHidDevice
+ * @brief One emulated HID device feeding a HidrawInputSource
+ */
+class VirtualHidDevice {
+public:
+    /**
+     * @struct Spec
+     * @brief Recorded identity of the emulated device
+     */
+    struct Spec {
+        std::string name;
+        uint16_t vendorId = 0;
+        uint16_t productId = 0;
+        std::vector<uint8_t> descriptor;
+    };
+
+    enum class Backend {
+        UHID,         // Kernel device through /dev/uhid
+        STREAM        // Socket pair stand-in
+    };
+
+    VirtualHidDevice();
+    ~VirtualHidDevice();
+
+    VirtualHidDevice(const VirtualHidDevice&) = delete;
+    VirtualHidDevice& operator=(const VirtualHidDevice&) = delete;
+
+    /**
+     * @brief True if /dev/uhid can be opened by this process
+     */
+    static bool uhidAvailable();
+
+    /**
+     * @brief Create the device (uhid when available and allowed, else the stand-in)
+     */
+    bool create(const Spec& spec, bool allowUhid = true);
+
+    /**
+     * @brief Make the device visible to a source: opens the hidraw node, or hands over the stream
+     *
+     * For uhid this waits (up to timeoutMs) for the kernel to create the node.
+     */
+    bool attach(HidrawInputSource& source, int timeoutMs = 2000);
+
+    /**
+     * @brief Send one input report (byte 0 is the report ID when the descriptor uses IDs)
+     */
+    bool sendReport(const uint8_t* report, size_t length);
+
+    /**
+     * @brief Unplug: destroys the uhid device or closes the stream
+     */
+    void destroy();
+
+    Backend getBackend() const { return m_backend; }
+    const std::string& getNodePath() const { return m_nodePath; }
+
+private:
+    std::string findHidrawNode() const;
+
+    Spec m_spec;
+    Backend m_backend;
+    int m_fd;             // /dev/uhid, or our end of the socket pair
+    int m_peerFd;         // Stream end not yet handed to a source
+    std::string m_uniq;   // Identifies our uhid device in sysfs
+    std::string m_nodePath;
+};
+
+#endif // __linux__
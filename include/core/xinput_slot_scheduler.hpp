@@ -0,0 +1,90 @@
+/**
+ * @file xinput_slot_scheduler.hpp
+ * @brief Presence-aware scheduling of XInputGetState calls
+ *
+ * XInputGetState on an empty slot walks the driver stack before reporting
+ * ERROR_DEVICE_NOT_CONNECTED and can cost close to a millisecond, which at a
+ * 1 kHz loop is most of the frame budget. The scheduler polls connected slots
+ * every frame and probes empty slots with exponential backoff. A probe can be
+ * forced (device refresh, HID arrival of an IG_ interface) so a newly plugged
+ * pad is picked up immediately instead of after the current backoff.
+ *
+ * Polling happens on the capture thread, which owns the live statistics and
+ * publishes a copy under one lock per poll; probe requests and statistics
+ * reads may come from any thread.
+ *
+ * The XInput call and the clock are injected so the schedule can be verified
+ * with a fake provider off Windows.
+ */
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include "utils/platform.hpp"
+
+/**
+ * @class XInputSlotScheduler
+ * @brief Decides which XInput slots to query each frame and measures the cost
+ */
+class XInputSlotScheduler {
+public:
+    using Provider = std::function<DWORD(DWORD userIndex, XINPUT_STATE* state)>;
+    using Clock = std::function<uint64_t()>; // Monotonic microseconds
+
+    static constexpr size_t SLOT_COUNT = XUSER_MAX_COUNT;
+    static constexpr uint64_t INITIAL_BACKOFF_US = 50000;   // First re-probe of an empty slot
+    static constexpr uint64_t MAX_BACKOFF_US = 2000000;     // Never wait longer than this
+
+    /**
+     * @struct SlotStats
+     * @brief Poll cost statistics of one slot
+     */
+    struct SlotStats {
+        bool connected = false;
+        uint64_t calls = 0;          // XInputGetState calls made
+        uint64_t skipped = 0;        // Frames the slot was not queried
+        uint64_t emptyProbes = 0;    // Calls that found no controller
+        double lastCostUs = 0.0;
+        double averageCostUs = 0.0;  // Exponential moving average
+        double maxCostUs = 0.0;
+        uint64_t backoffUs = 0;      // Current probe interval while empty
+    };
+
+    XInputSlotScheduler(Provider provider, Clock clock);
+
+    /**
+     * @brief Query one slot if it is due this frame
+     *
+     * @param slot XInput user index (0-3)
+     * @param state Receives the XInput state when the slot was queried
+     * @return Result of XInputGetState, or ERROR_DEVICE_NOT_CONNECTED when the
+     *         slot is empty and its next probe is not due yet
+     */
+    DWORD poll(DWORD slot, XINPUT_STATE* state);
+
+    /**
+     * @brief Probe every empty slot on its next poll (hot-plug, HID arrival)
+     */
+    void requestProbe();
+
+    SlotStats getStats(size_t slot) const;
+
+private:
+    struct Slot {
+        uint64_t nextProbeUs = 0;
+        std::atomic<bool> probeRequested{false};
+        SlotStats stats;      // Capture thread only
+        SlotStats published;  // Copy for getStats(), guarded by m_statsMutex
+    };
+
+    // Copy a slot's statistics out for readers on other threads
+    void publish(Slot& slot);
+
+    Provider m_provider;
+    Clock m_clock;
+    std::array<Slot, SLOT_COUNT> m_slots;
+    mutable std::mutex m_statsMutex;
+};
@@ -6,8 +6,16 @@
 #include <sstream>
 #include <filesystem>
 #include <mutex>
+#include <memory>
 #include "logger.hpp"
 
+/**
+ * @class ConfigManager
+ * @brief Key/value settings from config.ini
+ *
+ * getInstance() is the process configuration the proxy loads at startup.
+ * Pipelines take a view of it (createView) and read only their own copy.
+ */
 class ConfigManager {
 public:
     static ConfigManager& getInstance() {
@@ -15,6 +23,19 @@ public:
         return instance;
     }
 
+    ConfigManager() = default;
+    ~ConfigManager() = default;
+
+    /**
+     * @brief Independent copy for one pipeline instance
+     *
+     * Keys starting with overridePrefix (e.g. "shard1.") replace the plain
+     * key in the view, so one config.ini can tune shards individually. Other
+     * instances' sections (e.g. "shard2.") are left out of the view. Later
+     * changes to either side do not affect the other.
+     */
+    std::unique_ptr<ConfigManager> createView(const std::string& overridePrefix = "") const;
+
     // Load configuration from file
     bool load(const std::string& filename = "config.ini");
     
@@ -37,8 +58,6 @@ public:
     bool hasKey(const std::string& key) const;
     
 private:
-    ConfigManager() = default;
-    ~ConfigManager() = default;
     ConfigManager(const ConfigManager&) = delete;
     ConfigManager& operator=(const ConfigManager&) = delete;
     
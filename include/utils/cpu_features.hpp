@@ -0,0 +1,29 @@
+#pragma once
+
+#include <string>
+
+/**
+ * @class CpuFeatures
+ * @brief Instruction set extensions of the running CPU
+ *
+ * Detected once with CPUID (and XGETBV, so AVX/AVX-512 also require the OS to
+ * save the wider registers). Always all-false on non-x86 builds.
+ */
+class CpuFeatures {
+public:
+    struct Flags {
+        bool sse41 = false;
+        bool avx2 = false;
+        bool bmi2 = false;
+        bool avx512 = false;   // AVX-512 F + BW + VL
+    };
+
+    // Detect on first call; cached afterwards
+    static const Flags& get();
+
+    // e.g. "sse4.1 avx2 bmi2 avx512"
+    static std::string describe();
+
+private:
+    static Flags detect();
+};
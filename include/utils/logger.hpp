@@ -1,4 +1,6 @@
 #pragma once
+#include <cstdint>
+#include <deque>
 #include <vector>
 #include <string>
 #include <mutex>
@@ -7,30 +9,123 @@
 #include <filesystem>
 #include <chrono>
 #include <iomanip>
-#include <Windows.h>
+#include <utility>
+#include "utils/platform.hpp"
+
+/**
+ * @class LogSink
+ * @brief Log of one pipeline instance
+ *
+ * Keeps the newest lines of the instance in a bounded buffer. Logging only
+ * takes the sink's own lock: lines reach the process log (console, history,
+ * file), tagged with the prefix, when the owner calls flush() from a thread
+ * that may block on I/O. Lines evicted before they were flushed are counted
+ * as dropped. Bind a sink to a thread with Logger::Scope and everything that
+ * thread logs through the static Logger API (capture, emulator, config)
+ * lands in the pipeline it belongs to.
+ */
+class LogSink {
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 1024;
+
+    explicit LogSink(std::string prefix = "", size_t capacity = DEFAULT_CAPACITY)
+        : m_prefix(std::move(prefix)), m_capacity(capacity > 0 ? capacity : 1) {}
+
+    void log(const std::string& message);
+    void error(const std::string& message);
+
+    /**
+     * @brief Forward the lines not yet forwarded to the process log
+     * @return Number of lines forwarded
+     */
+    size_t flush();
+
+    // Newest lines, oldest first (at most the capacity)
+    std::vector<std::string> getLogs() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::vector<std::string> lines;
+        lines.reserve(m_logs.size());
+        for (const auto& entry : m_logs) {
+            lines.push_back(entry.line);
+        }
+        return lines;
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_logs.clear();
+        m_unflushed = 0;
+    }
+
+    // Lines evicted before they reached the process log
+    uint64_t getDropped() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_dropped;
+    }
+
+    const std::string& getPrefix() const { return m_prefix; }
+
+private:
+    struct Entry {
+        std::string line;
+        bool isError;
+    };
+
+    void append(std::string line, bool isError);
+
+    std::string m_prefix;
+    size_t m_capacity;
+    mutable std::mutex m_mutex;
+    std::deque<Entry> m_logs;
+    size_t m_unflushed = 0;      // Newest entries not yet forwarded
+    uint64_t m_dropped = 0;
+};
 
 class Logger {
 public:
     static void log(const std::string& message) {
-        std::lock_guard<std::mutex> lock(m_mutex);
-        m_logs.push_back(message);
-        std::cout << message << std::endl;
-        
-        // Auto-save to file if enabled
-        if (m_autoSaveEnabled) {
-            appendToFile(message);
+        if (t_sink) {
+            t_sink->log(message);
+            return;
         }
+        writeLine(message, false);
     }
 
     static void error(const std::string& message) {
+        if (t_sink) {
+            t_sink->error(message);
+            return;
+        }
+        writeLine("ERROR: " + message, true);
+    }
+
+    /**
+     * @class Scope
+     * @brief Routes this thread's Logger calls to a LogSink while in scope
+     */
+    class Scope {
+    public:
+        explicit Scope(LogSink& sink) : m_previous(t_sink) { t_sink = &sink; }
+        ~Scope() { t_sink = m_previous; }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        LogSink* m_previous;
+    };
+
+    // Sink bound to the calling thread, or nullptr for the process log
+    static LogSink* currentSink() { return t_sink; }
+
+    // Append one line to the process log (console, history and auto-save file)
+    static void writeLine(const std::string& line, bool isError) {
         std::lock_guard<std::mutex> lock(m_mutex);
-        std::string errorMsg = "ERROR: " + message;
-        m_logs.push_back(errorMsg);
-        std::cerr << errorMsg << std::endl;
+        m_logs.push_back(line);
+        (isError ? std::cerr : std::cout) << line << std::endl;
         
         // Auto-save to file if enabled
         if (m_autoSaveEnabled) {
-            appendToFile(errorMsg);
+            appendToFile(line);
         }
     }
 
@@ -47,6 +142,7 @@ public:
     static std::string wstringToNarrow(const std::wstring& wstr) {
         if (wstr.empty()) return std::string();
         
+#ifdef _WIN32
         int size_needed = WideCharToMultiByte(CP_UTF8, 0, wstr.c_str(), (int)wstr.length(), NULL, 0, NULL, NULL);
         if (size_needed <= 0) {
             // Fallback to simple conversion
@@ -60,6 +156,14 @@ public:
         std::string narrow(size_needed, 0);
         WideCharToMultiByte(CP_UTF8, 0, wstr.c_str(), (int)wstr.length(), &narrow[0], size_needed, NULL, NULL);
         return narrow;
+#else
+        // Device strings are ASCII in practice; keep the low byte like the Windows fallback
+        std::string narrow;
+        for (wchar_t wc : wstr) {
+            narrow += static_cast<char>(wc);
+        }
+        return narrow;
+#endif
     }
 
     static void saveToTimestampedFile() {
@@ -75,10 +179,7 @@ public:
             }
 
             // Get executable directory
-            wchar_t path[MAX_PATH];
-            GetModuleFileNameW(NULL, path, MAX_PATH);
-            std::filesystem::path exePath(path);
-            std::filesystem::path logDir = exePath.parent_path();
+            std::filesystem::path logDir = getExecutableDirectory();
 
             // Generate filename: yyyy-mm-dd-HHMMSS.log
             auto now = std::chrono::system_clock::now();
@@ -113,10 +214,7 @@ public:
         
         if (enable && !m_autoSaveEnabled) {
             // Open log file for continuous writing
-            wchar_t path[MAX_PATH];
-            GetModuleFileNameW(NULL, path, MAX_PATH);
-            std::filesystem::path exePath(path);
-            std::filesystem::path logDir = exePath.parent_path();
+            std::filesystem::path logDir = getExecutableDirectory();
 
             // Generate filename: yyyy-mm-dd-HHMMSS.log
             auto now = std::chrono::system_clock::now();
@@ -166,7 +264,20 @@ public:
         return ss.str();
     }
 
+    static std::filesystem::path getExecutableDirectory() {
+#ifdef _WIN32
+        wchar_t path[MAX_PATH];
+        GetModuleFileNameW(NULL, path, MAX_PATH);
+        return std::filesystem::path(path).parent_path();
+#else
+        std::error_code ec;
+        std::filesystem::path exePath = std::filesystem::read_symlink("/proc/self/exe", ec);
+        return ec ? std::filesystem::current_path() : exePath.parent_path();
+#endif
+    }
+
 private:
+    static inline thread_local LogSink* t_sink = nullptr;
     static inline std::vector<std::string> m_logs;
     static inline std::mutex m_mutex;
     static inline bool m_autoSaveEnabled = false;
@@ -181,3 +292,37 @@ private:
         }
     }
 };
+
+inline void LogSink::append(std::string line, bool isError) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_logs.size() == m_capacity) {
+        if (m_unflushed == m_logs.size()) {
+            m_unflushed--;
+            m_dropped++;
+        }
+        m_logs.pop_front();
+    }
+    m_logs.push_back({std::move(line), isError});
+    m_unflushed++;
+}
+
+inline void LogSink::log(const std::string& message) {
+    append(message, false);
+}
+
+inline void LogSink::error(const std::string& message) {
+    append("ERROR: " + message, true);
+}
+
+inline size_t LogSink::flush() {
+    std::vector<Entry> pending;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        pending.assign(m_logs.end() - static_cast<std::ptrdiff_t>(m_unflushed), m_logs.end());
+        m_unflushed = 0;
+    }
+    for (const auto& entry : pending) {
+        Logger::writeLine(m_prefix + entry.line, entry.isError);
+    }
+    return pending.size();
+}
@@ -0,0 +1,45 @@
+/**
+ * @file mapped_file.hpp
+ * @brief Read-only memory mapping of a whole file
+ *
+ * Offline tools scan recordings of hours of input; mapping them lets the
+ * page cache serve the bytes and several threads decode different chunks of
+ * the same file without copies or shared stream state.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * @class MappedFile
+ * @brief Maps a file read-only for the lifetime of the object
+ */
+class MappedFile {
+public:
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /**
+     * @brief Map a file (an empty file maps to size 0 and a null pointer)
+     */
+    bool open(const std::string& path, std::string* error = nullptr);
+    void close();
+
+    const uint8_t* data() const { return m_data; }
+    size_t size() const { return m_size; }
+    bool isOpen() const { return m_open; }
+
+private:
+    const uint8_t* m_data;
+    size_t m_size;
+    bool m_open;
+#ifdef _WIN32
+    void* m_file;
+    void* m_mapping;
+#endif
+};
@@ -0,0 +1,211 @@
+/**
+ * @file platform.hpp
+ * @brief Platform header shim for the portable parts of the pipeline
+ *
+ * On Windows this simply pulls in the Win32, XInput and HID headers the core
+ * modules are written against. On other platforms it provides the minimal
+ * subset of those types and constants (same names, sizes and layouts) so that
+ * the translation layer, its tests and the offline tools build and run on
+ * Linux. Nothing here talks to an OS API; modules that do (input capture,
+ * HidHide, ViGEmBus) remain Windows-only.
+ */
+#pragma once
+
+#ifdef _WIN32
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#include <xinput.h>
+#include <hidsdi.h>
+#include <hidusage.h>
+#include <setupapi.h>
+#include <guiddef.h>
+
+#else
+
+#include <cstdint>
+#include <cstddef>
+
+// Basic Win32 integer types
+typedef uint8_t  BYTE;
+typedef uint8_t  UCHAR;
+typedef uint8_t  BOOLEAN;
+typedef char     CHAR;
+typedef char*    PCHAR;
+typedef uint16_t WORD;
+typedef uint16_t USHORT;
+typedef int16_t  SHORT;
+typedef uint32_t DWORD;
+typedef uint32_t ULONG;
+typedef int32_t  LONG;
+typedef int      BOOL;
+typedef uintptr_t ULONG_PTR;
+typedef uintptr_t DWORD_PTR;
+typedef void*    PVOID;
+typedef void*    LPVOID;
+typedef void*    HANDLE;
+typedef int32_t  NTSTATUS;
+
+typedef union _LARGE_INTEGER {
+    int64_t QuadPart;
+} LARGE_INTEGER;
+
+#ifndef TRUE
+#define TRUE 1
+#endif
+#ifndef FALSE
+#define FALSE 0
+#endif
+
+#define CALLBACK
+#define WINAPI
+#define INVALID_HANDLE_VALUE (reinterpret_cast<HANDLE>(static_cast<intptr_t>(-1)))
+
+// Error codes surfaced through ControllerState::lastError
+#define ERROR_SUCCESS              0L
+#define ERROR_BAD_COMMAND          22L
+#define ERROR_IO_INCOMPLETE        996L
+#define ERROR_IO_PENDING           997L
+#define ERROR_DEVICE_NOT_CONNECTED 1167L
+
+// XInput
+#define XUSER_MAX_COUNT 4
+
+#define XINPUT_GAMEPAD_DPAD_UP          0x0001
+#define XINPUT_GAMEPAD_DPAD_DOWN        0x0002
+#define XINPUT_GAMEPAD_DPAD_LEFT        0x0004
+#define XINPUT_GAMEPAD_DPAD_RIGHT       0x0008
+#define XINPUT_GAMEPAD_START            0x0010
+#define XINPUT_GAMEPAD_BACK             0x0020
+#define XINPUT_GAMEPAD_LEFT_THUMB       0x0040
+#define XINPUT_GAMEPAD_RIGHT_THUMB      0x0080
+#define XINPUT_GAMEPAD_LEFT_SHOULDER    0x0100
+#define XINPUT_GAMEPAD_RIGHT_SHOULDER   0x0200
+#define XINPUT_GAMEPAD_A                0x1000
+#define XINPUT_GAMEPAD_B                0x2000
+#define XINPUT_GAMEPAD_X                0x4000
+#define XINPUT_GAMEPAD_Y                0x8000
+
+typedef struct _XINPUT_GAMEPAD {
+    WORD  wButtons;
+    BYTE  bLeftTrigger;
+    BYTE  bRightTrigger;
+    SHORT sThumbLX;
+    SHORT sThumbLY;
+    SHORT sThumbRX;
+    SHORT sThumbRY;
+} XINPUT_GAMEPAD;
+
+typedef struct _XINPUT_STATE {
+    DWORD          dwPacketNumber;
+    XINPUT_GAMEPAD Gamepad;
+} XINPUT_STATE;
+
+typedef struct _XINPUT_VIBRATION {
+    WORD wLeftMotorSpeed;
+    WORD wRightMotorSpeed;
+} XINPUT_VIBRATION;
+
+// HID parsing (hidpi.h)
+typedef USHORT USAGE;
+typedef struct _HIDP_PREPARSED_DATA* PHIDP_PREPARSED_DATA;
+
+typedef struct _HIDP_CAPS {
+    USAGE  Usage;
+    USAGE  UsagePage;
+    USHORT InputReportByteLength;
+    USHORT OutputReportByteLength;
+    USHORT FeatureReportByteLength;
+    USHORT Reserved[17];
+    USHORT NumberLinkCollectionNodes;
+    USHORT NumberInputButtonCaps;
+    USHORT NumberInputValueCaps;
+    USHORT NumberInputDataIndices;
+    USHORT NumberOutputButtonCaps;
+    USHORT NumberOutputValueCaps;
+    USHORT NumberOutputDataIndices;
+    USHORT NumberFeatureButtonCaps;
+    USHORT NumberFeatureValueCaps;
+    USHORT NumberFeatureDataIndices;
+} HIDP_CAPS;
+
+typedef struct _HIDP_BUTTON_CAPS {
+    USAGE   UsagePage;
+    UCHAR   ReportID;
+    BOOLEAN IsAlias;
+    USHORT  BitField;
+    USHORT  LinkCollection;
+    USAGE   LinkUsage;
+    USAGE   LinkUsagePage;
+    BOOLEAN IsRange;
+    BOOLEAN IsStringRange;
+    BOOLEAN IsDesignatorRange;
+    BOOLEAN IsAbsolute;
+    USHORT  ReportCount;
+    USHORT  Reserved2;
+    ULONG   Reserved[9];
+    union {
+        struct {
+            USAGE  UsageMin, UsageMax;
+            USHORT StringMin, StringMax;
+            USHORT DesignatorMin, DesignatorMax;
+            USHORT DataIndexMin, DataIndexMax;
+        } Range;
+        struct {
+            USAGE  Usage, Reserved1;
+            USHORT StringIndex, Reserved2;
+            USHORT DesignatorIndex, Reserved3;
+            USHORT DataIndex, Reserved4;
+        } NotRange;
+    };
+} HIDP_BUTTON_CAPS;
+
+typedef struct _HIDP_VALUE_CAPS {
+    USAGE   UsagePage;
+    UCHAR   ReportID;
+    BOOLEAN IsAlias;
+    USHORT  BitField;
+    USHORT  LinkCollection;
+    USAGE   LinkUsage;
+    USAGE   LinkUsagePage;
+    BOOLEAN IsRange;
+    BOOLEAN IsStringRange;
+    BOOLEAN IsDesignatorRange;
+    BOOLEAN IsAbsolute;
+    BOOLEAN HasNull;
+    UCHAR   Reserved;
+    USHORT  BitSize;
+    USHORT  ReportCount;
+    USHORT  Reserved2[5];
+    ULONG   UnitsExp;
+    ULONG   Units;
+    LONG    LogicalMin, LogicalMax;
+    LONG    PhysicalMin, PhysicalMax;
+    union {
+        struct {
+            USAGE  UsageMin, UsageMax;
+            USHORT StringMin, StringMax;
+            USHORT DesignatorMin, DesignatorMax;
+            USHORT DataIndexMin, DataIndexMax;
+        } Range;
+        struct {
+            USAGE  Usage, Reserved1;
+            USHORT StringIndex, Reserved2;
+            USHORT DesignatorIndex, Reserved3;
+            USHORT DataIndex, Reserved4;
+        } NotRange;
+    };
+} HIDP_VALUE_CAPS;
+
+// Overlapped I/O bookkeeping (only stored, never used off Windows)
+typedef struct _OVERLAPPED {
+    ULONG_PTR Internal;
+    ULONG_PTR InternalHigh;
+    DWORD     Offset;
+    DWORD     OffsetHigh;
+    HANDLE    hEvent;
+} OVERLAPPED;
+
+#endif // _WIN32
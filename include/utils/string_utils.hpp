@@ -0,0 +1,17 @@
+/**
+ * @file string_utils.hpp
+ * @brief Small string helpers shared by the device matching code
+ *
+ * Merge groups, split plans and polling overrides all select devices by a
+ * product name or instance ID substring from the config; they share one
+ * matcher so a pattern selects the same devices everywhere.
+ */
+#pragma once
+
+#include <string>
+
+class StringUtils {
+public:
+    // Case-insensitive substring search; an empty needle matches nothing
+    static bool containsCaseInsensitive(const std::wstring& haystack, const std::wstring& needle);
+};
@@ -1,7 +1,7 @@
 #pragma once
 
 #include <thread>
-#include <windows.h>
+#include "utils/platform.hpp"
 
 class ThreadingUtils {
 public:
@@ -1,6 +1,6 @@
 #pragma once
 
-#include <windows.h>
+#include "utils/platform.hpp"
 #include <cstdint>
 
 class TimingUtils {
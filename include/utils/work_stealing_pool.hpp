@@ -0,0 +1,86 @@
+/**
+ * @file work_stealing_pool.hpp
+ * @brief Small persistent thread pool for per-frame parallel loops
+ *
+ * parallelFor() splits task indices 0..n-1 into one contiguous range per
+ * participant (the workers and the calling thread). Each participant takes
+ * tasks from the front of its own range and, once that is empty, steals
+ * single tasks from the back of the others' ranges. A range is one 64-bit
+ * atomic (begin, end), so taking and stealing are lock-free.
+ *
+ * Workers are created once. Between jobs they spin (yielding) for a short
+ * while so back-to-back frames do not pay a wake-up, then park on a
+ * condition variable.
+ */
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @class WorkStealingPool
+ * @brief Persistent workers running one parallelFor() at a time
+ */
+class WorkStealingPool {
+public:
+    // Yielding polls of a worker before it parks
+    static constexpr int SPIN_ITERATIONS = 2000;
+
+    /**
+     * @param workers Threads besides the caller (0 runs everything on the caller)
+     */
+    explicit WorkStealingPool(size_t workers);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    /**
+     * @brief Run task(i) for every i in [0, tasks) and return when all are done
+     *
+     * The caller takes part. Not reentrant: one parallelFor() at a time.
+     */
+    void parallelFor(size_t tasks, const std::function<void(size_t)>& task);
+
+    size_t getWorkerCount() const { return m_workers.size(); }
+
+    /**
+     * @brief Tasks run by a participant other than the one they were assigned to (since construction)
+     */
+    uint64_t getStolenCount() const { return m_stolen; }
+
+private:
+    struct alignas(64) Range {
+        std::atomic<uint64_t> bounds{0};   // begin in the low 32 bits, end in the high 32 bits
+    };
+
+    static uint64_t pack(uint32_t begin, uint32_t end) {
+        return static_cast<uint64_t>(begin) | (static_cast<uint64_t>(end) << 32);
+    }
+
+    void workerLoop(size_t participant);
+    void runTasks(size_t participant);
+    bool takeOwn(size_t participant, uint32_t& index);
+    bool steal(size_t participant, uint32_t& index);
+
+    std::vector<std::thread> m_workers;
+    std::unique_ptr<Range[]> m_ranges;     // One per participant; 0 is the caller
+    size_t m_participants;
+
+    const std::function<void(size_t)>* m_task;
+    std::atomic<size_t> m_remaining;
+    std::atomic<size_t> m_active;          // Workers currently inside runTasks()
+    std::atomic<uint64_t> m_stolen;
+
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::atomic<uint64_t> m_generation;
+    std::atomic<bool> m_stop;
+};
@@ -0,0 +1,26 @@
+xidp-profile 1
+# Sony DualSense over USB or Bluetooth (HID gamepad mode)
+name "DualSense"
+match usb=054c:0ce6
+match usb=054c:0df2
+match name="DualSense Wireless Controller"
+
+button 1 x              # Square
+button 2 a              # Cross
+button 3 b              # Circle
+button 4 y              # Triangle
+button 5 lb
+button 6 rb
+button 9 back           # Create
+button 10 start         # Options
+button 11 ls
+button 12 rs
+
+# Sticks report 0-255 centered at 128, Y grows downwards
+axis 0x30 lx fixed center=128 scale=256
+axis 0x31 ly fixed center=128 scale=256 invert
+axis 0x32 rx fixed center=128 scale=256
+axis 0x35 ry fixed center=128 scale=256 invert
+# Analog L2/R2 on Rx/Ry
+axis 0x33 lt caps
+axis 0x34 rt caps
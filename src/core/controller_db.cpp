@@ -0,0 +1,288 @@
+#include "core/controller_db.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <tuple>
+
+namespace {
+
+using UsbId = ProfileLibrary::Source::UsbId;
+
+enum class TargetKind { BUTTON, TRIGGER, STICK };
+
+struct Target {
+    const char* name;
+    TargetKind kind;
+    WORD buttons;               // BUTTON
+    uint8_t axisTarget;         // TRIGGER and STICK
+    uint8_t buttonTrigger;      // TRIGGER from a button
+    bool vertical;              // STICK: SDL's +y is down, XInput's is up
+};
+
+// SDL gamepad fields with an XInput equivalent. guide, misc1, paddle1-4 and touchpad have none.
+const Target TARGETS[] = {
+    {"a", TargetKind::BUTTON, XINPUT_GAMEPAD_A, 0, 0, false},
+    {"b", TargetKind::BUTTON, XINPUT_GAMEPAD_B, 0, 0, false},
+    {"x", TargetKind::BUTTON, XINPUT_GAMEPAD_X, 0, 0, false},
+    {"y", TargetKind::BUTTON, XINPUT_GAMEPAD_Y, 0, 0, false},
+    {"back", TargetKind::BUTTON, XINPUT_GAMEPAD_BACK, 0, 0, false},
+    {"start", TargetKind::BUTTON, XINPUT_GAMEPAD_START, 0, 0, false},
+    {"leftstick", TargetKind::BUTTON, XINPUT_GAMEPAD_LEFT_THUMB, 0, 0, false},
+    {"rightstick", TargetKind::BUTTON, XINPUT_GAMEPAD_RIGHT_THUMB, 0, 0, false},
+    {"leftshoulder", TargetKind::BUTTON, XINPUT_GAMEPAD_LEFT_SHOULDER, 0, 0, false},
+    {"rightshoulder", TargetKind::BUTTON, XINPUT_GAMEPAD_RIGHT_SHOULDER, 0, 0, false},
+    {"dpup", TargetKind::BUTTON, XINPUT_GAMEPAD_DPAD_UP, 0, 0, false},
+    {"dpdown", TargetKind::BUTTON, XINPUT_GAMEPAD_DPAD_DOWN, 0, 0, false},
+    {"dpleft", TargetKind::BUTTON, XINPUT_GAMEPAD_DPAD_LEFT, 0, 0, false},
+    {"dpright", TargetKind::BUTTON, XINPUT_GAMEPAD_DPAD_RIGHT, 0, 0, false},
+    {"lefttrigger", TargetKind::TRIGGER, 0, ProfileLibrary::AXIS_LEFT_TRIGGER, ProfileLibrary::TRIGGER_LEFT, false},
+    {"righttrigger", TargetKind::TRIGGER, 0, ProfileLibrary::AXIS_RIGHT_TRIGGER, ProfileLibrary::TRIGGER_RIGHT, false},
+    {"leftx", TargetKind::STICK, 0, ProfileLibrary::AXIS_LEFT_X, 0, false},
+    {"lefty", TargetKind::STICK, 0, ProfileLibrary::AXIS_LEFT_Y, 0, true},
+    {"rightx", TargetKind::STICK, 0, ProfileLibrary::AXIS_RIGHT_X, 0, false},
+    {"righty", TargetKind::STICK, 0, ProfileLibrary::AXIS_RIGHT_Y, 0, true},
+};
+
+const Target* findTarget(const std::string& name) {
+    for (const auto& target : TARGETS) {
+        if (name == target.name) return &target;
+    }
+    return nullptr;
+}
+
+// One physical input of a binding: bN, aN (optionally ~ inverted), hH.M
+struct Input {
+    char kind = 0;
+    int index = 0;
+    int hatMask = 0;
+    bool invert = false;
+};
+
+bool parseIndex(const char* text, int& value, const char** end) {
+    char* stop = nullptr;
+    long number = std::strtol(text, &stop, 10);
+    if (stop == text || number < 0 || number > 255) return false;
+    value = static_cast<int>(number);
+    *end = stop;
+    return true;
+}
+
+bool parseInput(const std::string& text, Input& input) {
+    if (text.size() < 2) return false;
+    const char* end = nullptr;
+    input.kind = text[0];
+    if (!parseIndex(text.c_str() + 1, input.index, &end)) return false;
+    if (input.kind == 'b') {
+        return *end == '\0';
+    }
+    if (input.kind == 'a') {
+        input.invert = *end == '~';
+        return *end == '\0' || (input.invert && end[1] == '\0');
+    }
+    if (input.kind == 'h') {
+        return *end == '.' && parseIndex(end + 1, input.hatMask, &end) && *end == '\0';
+    }
+    return false;
+}
+
+int hexDigit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// Adds one binding to a source; false if XInput or the profile tables cannot express it
+bool applyBinding(const std::string& field, const std::string& value, ProfileLibrary::Source& source) {
+    const Target* target = findTarget(field);
+    Input input;
+    if (!target || !parseInput(value, input)) {
+        return false;       // Unknown or half-axis output ("+leftx"), or half-axis input ("+a2")
+    }
+    const USAGE buttonUsage = static_cast<USAGE>(input.index + 1);
+    const USAGE axisUsage = static_cast<USAGE>(ProfileLibrary::AXIS_FIRST_USAGE + input.index);
+    const bool buttonFits = input.kind == 'b' && buttonUsage < ProfileLibrary::BUTTON_USAGES;
+    const bool axisFits = input.kind == 'a' && static_cast<size_t>(input.index) < ProfileLibrary::AXIS_USAGES;
+
+    auto mapAxis = [&](bool invert) {
+        ProfileLibrary::Axis axis;
+        axis.target = target->axisTarget;
+        axis.mode = ProfileLibrary::AXIS_CAPS;
+        axis.invert = invert ? 1 : 0;
+        return source.axes.emplace(axisUsage, axis).second;    // One target per axis
+    };
+
+    switch (target->kind) {
+        case TargetKind::BUTTON:
+            if (buttonFits) {
+                source.buttons[buttonUsage] |= target->buttons;
+                return true;
+            }
+            if (input.kind == 'h' && input.index == 0) {
+                for (int direction = 0; direction < ProfileLibrary::HAT_DIRECTIONS; ++direction) {
+                    if (input.hatMask == (1 << direction)) {
+                        source.hat[direction] |= target->buttons;
+                        return true;
+                    }
+                }
+            }
+            return false;
+        case TargetKind::TRIGGER:
+            if (buttonFits) {
+                source.buttonTriggers[buttonUsage] |= target->buttonTrigger;
+                return true;
+            }
+            return axisFits && mapAxis(input.invert);
+        case TargetKind::STICK:
+            return axisFits && mapAxis(input.invert != target->vertical);
+    }
+    return false;
+}
+
+std::vector<std::string> splitFields(const std::string& line) {
+    std::vector<std::string> fields;
+    size_t start = 0;
+    while (start <= line.size()) {
+        size_t comma = line.find(',', start);
+        if (comma == std::string::npos) comma = line.size();
+        std::string field = line.substr(start, comma - start);
+        while (!field.empty() && (field.back() == '\r' || field.back() == ' ')) field.pop_back();
+        while (!field.empty() && field.front() == ' ') field.erase(field.begin());
+        if (!field.empty()) fields.push_back(field);
+        start = comma + 1;
+    }
+    return fields;
+}
+
+} // namespace
+
+std::string ControllerDb::nativePlatform() {
+#if defined(_WIN32)
+    return "Windows";
+#elif defined(__APPLE__)
+    return "Mac OS X";
+#elif defined(__ANDROID__)
+    return "Android";
+#else
+    return "Linux";
+#endif
+}
+
+bool ControllerDb::parseGuid(const std::string& guid, UsbId& id) {
+    if (guid.size() != 32) {
+        return false;
+    }
+    uint8_t bytes[16];
+    for (size_t i = 0; i < 16; ++i) {
+        int high = hexDigit(guid[2 * i]);
+        int low = hexDigit(guid[2 * i + 1]);
+        if (high < 0 || low < 0) return false;
+        bytes[i] = static_cast<uint8_t>(high << 4 | low);
+    }
+    auto word = [&bytes](size_t offset) { return static_cast<uint16_t>(bytes[offset] | bytes[offset + 1] << 8); };
+
+    if (std::memcmp(bytes + 10, "PIDVID", 6) == 0) {
+        // DirectInput era: vendor, product, then zeros and "PIDVID"
+        id = UsbId{word(0), word(2), 0};
+    } else {
+        // bus, crc, vendor, 0, product, 0, version, driver signature/data
+        if (word(6) != 0 || word(10) != 0) return false;
+        id = UsbId{word(4), word(8), word(12)};
+    }
+    return id.vendorId != 0 || id.productId != 0;
+}
+
+void ControllerDb::import(std::istream& in, const std::string& platform, std::vector<ProfileLibrary::Source>& sources,
+                          Stats* stats, const std::string& origin) {
+    Stats local;
+    Stats& counts = stats ? *stats : local;
+    std::map<std::tuple<uint16_t, uint16_t, uint16_t>, size_t> byId;      // Source index of each imported GUID
+    const size_t first = sources.size();
+
+    std::string line;
+    size_t lineNumber = 0;
+    while (std::getline(in, line)) {
+        lineNumber++;
+        counts.lines++;
+        std::vector<std::string> fields = splitFields(line);
+        if (fields.empty() || fields[0][0] == '#') {
+            continue;
+        }
+        counts.entries++;
+        if (fields.size() < 2) {
+            counts.unusable++;
+            continue;
+        }
+
+        bool samePlatform = true;
+        for (size_t i = 2; i < fields.size(); ++i) {
+            if (fields[i].compare(0, 9, "platform:") == 0) {
+                samePlatform = fields[i].substr(9) == platform;
+            }
+        }
+        if (!samePlatform) {
+            counts.otherPlatform++;
+            continue;
+        }
+
+        UsbId id{0, 0, 0};
+        if (!parseGuid(fields[0], id)) {
+            counts.unsupportedGuid++;
+            continue;
+        }
+
+        ProfileLibrary::Source source;
+        source.name = fields[1];
+        source.origin = origin + ":" + std::to_string(lineNumber);
+        source.usbIds.push_back(id);
+        size_t bindings = 0;
+        for (size_t i = 2; i < fields.size(); ++i) {
+            const size_t colon = fields[i].find(':');
+            if (colon == std::string::npos) continue;
+            const std::string field = fields[i].substr(0, colon);
+            if (field == "platform" || field == "crc" || field == "hint" || field.compare(0, 3, "sdk") == 0) {
+                continue;
+            }
+            if (applyBinding(field, fields[i].substr(colon + 1), source)) {
+                bindings++;
+            } else {
+                counts.skippedBindings++;
+            }
+        }
+        if (bindings == 0) {
+            counts.unusable++;
+            continue;
+        }
+
+        auto [it, inserted] = byId.emplace(std::make_tuple(id.vendorId, id.productId, id.version), sources.size());
+        if (inserted) {
+            sources.push_back(std::move(source));
+            counts.imported++;
+        } else {
+            sources[it->second] = std::move(source);
+            counts.replaced++;
+        }
+    }
+
+    // Versioned entries also stand in for their plain id, first one in the file wins
+    for (size_t i = first; i < sources.size(); ++i) {
+        const UsbId id = sources[i].usbIds.front();
+        if (id.version != 0 && byId.emplace(std::make_tuple(id.vendorId, id.productId, uint16_t(0)), i).second) {
+            sources[i].usbIds.push_back(UsbId{id.vendorId, id.productId, 0});
+        }
+    }
+}
+
+bool ControllerDb::importFile(const std::string& path, const std::string& platform,
+                              std::vector<ProfileLibrary::Source>& sources, Stats* stats, std::string* error) {
+    std::ifstream in(path);
+    if (!in) {
+        if (error) *error = "cannot read " + path;
+        return false;
+    }
+    import(in, platform, sources, stats, std::filesystem::path(path).filename().string());
+    return true;
+}
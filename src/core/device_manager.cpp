@@ -9,7 +9,8 @@ DeviceManager::DeviceManager(
     VirtualDeviceEmulator* emulator,
     TranslationLayer* translationLayer
 ) : m_emulator(emulator),
-    m_translationLayer(translationLayer) {
+    m_translationLayer(translationLayer),
+    m_inputMerger(nullptr) {
 }
 
 void DeviceManager::processDevices(
@@ -17,7 +18,16 @@ void DeviceManager::processDevices(
     bool translationEnabled,
     bool hidHideEnabled
 ) {
+    std::vector<bool> groupConnected(m_inputMerger ? m_inputMerger->getGroupCount() : 0, false);
+
     for (const auto& state : inputStates) {
+        // Merged devices share their group's virtual device
+        int mergeGroup = m_inputMerger ? m_inputMerger->findGroup(state) : -1;
+        
+        // Split devices get one virtual device per output
+        const DeviceSplitter& splitter = m_translationLayer->getDeviceSplitter();
+        int splitDevice = (mergeGroup < 0 && state.userId < 0 && splitter.isEnabled()) ? splitter.findDevice(state) : -1;
+
         if (state.isConnected) {
             // Only hide DInput devices (userId < 0) when translating to XInput
             // XInput devices (userId >= 0) cannot be hidden via HidHide as they use XInput API
@@ -42,15 +52,60 @@ void DeviceManager::processDevices(
                 }
             }
 
+            if (mergeGroup >= 0) {
+                groupConnected[mergeGroup] = true;
+                continue;
+            }
+
+            if (splitDevice >= 0) {
+                if (translationEnabled) {
+                    for (size_t output = 0; output < splitter.getOutputCount(splitDevice); ++output) {
+                        ControllerState outputState{};
+                        outputState.userId = DeviceSplitter::virtualUserId(splitDevice, static_cast<int>(output));
+                        const std::string& name = splitter.getOutputName(splitDevice, static_cast<int>(output));
+                        outputState.productName = std::wstring(name.begin(), name.end());
+                        outputState.isConnected = true;
+                        createVirtualDevicesForController(outputState, translationEnabled);
+                    }
+                }
+                continue;
+            }
+
             // Create virtual devices if translation is enabled
             if (translationEnabled) {
                 createVirtualDevicesForController(state, translationEnabled);
             }
-        } else {
+        } else if (splitDevice >= 0) {
+            for (size_t output = 0; output < splitter.getOutputCount(splitDevice); ++output) {
+                destroyVirtualDevicesForController(DeviceSplitter::virtualUserId(splitDevice, static_cast<int>(output)));
+            }
+        } else if (mergeGroup < 0) {
             // Handle disconnection
             destroyVirtualDevicesForController(state.userId);
         }
     }
+
+    processMergeGroups(groupConnected, translationEnabled);
+}
+
+void DeviceManager::processMergeGroups(const std::vector<bool>& groupConnected, bool translationEnabled) {
+    for (size_t group = 0; group < groupConnected.size(); ++group) {
+        int virtualUserId = InputMerger::virtualUserId(static_cast<int>(group));
+
+        if (groupConnected[group]) {
+            if (translationEnabled) {
+                ControllerState groupState{};
+                groupState.userId = virtualUserId;
+                groupState.productName = std::wstring(m_inputMerger->getGroup(group).name.begin(),
+                                                      m_inputMerger->getGroup(group).name.end());
+                groupState.isConnected = true;
+                createVirtualDevicesForController(groupState, translationEnabled);
+            }
+        } else {
+            // Last member gone
+            destroyVirtualDevicesForController(virtualUserId);
+        }
+    }
 }
 
 bool DeviceManager::hidePhysicalDevice(const ControllerState& state) {
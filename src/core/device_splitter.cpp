@@ -0,0 +1,178 @@
+#include "core/device_splitter.hpp"
+#include "utils/string_utils.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <sstream>
+
+namespace {
+    struct ButtonName {
+        const char* name;
+        WORD mask;
+    };
+
+    constexpr ButtonName BUTTON_NAMES[] = {
+        {"A", XINPUT_GAMEPAD_A},
+        {"B", XINPUT_GAMEPAD_B},
+        {"X", XINPUT_GAMEPAD_X},
+        {"Y", XINPUT_GAMEPAD_Y},
+        {"LB", XINPUT_GAMEPAD_LEFT_SHOULDER},
+        {"RB", XINPUT_GAMEPAD_RIGHT_SHOULDER},
+        {"BACK", XINPUT_GAMEPAD_BACK},
+        {"START", XINPUT_GAMEPAD_START},
+        {"L3", XINPUT_GAMEPAD_LEFT_THUMB},
+        {"R3", XINPUT_GAMEPAD_RIGHT_THUMB},
+        {"DPAD_UP", XINPUT_GAMEPAD_DPAD_UP},
+        {"DPAD_DOWN", XINPUT_GAMEPAD_DPAD_DOWN},
+        {"DPAD_LEFT", XINPUT_GAMEPAD_DPAD_LEFT},
+        {"DPAD_RIGHT", XINPUT_GAMEPAD_DPAD_RIGHT},
+    };
+
+    std::string toUpper(std::string text) {
+        std::transform(text.begin(), text.end(), text.begin(), ::toupper);
+        return text;
+    }
+
+    std::string trim(const std::string& text) {
+        size_t first = text.find_first_not_of(" \t");
+        if (first == std::string::npos) return "";
+        size_t last = text.find_last_not_of(" \t");
+        return text.substr(first, last - first + 1);
+    }
+
+    // Split "usage:NAME,usage:NAME" into (usage, NAME) pairs, skipping malformed entries
+    std::vector<std::pair<USAGE, std::string>> parsePairs(const std::string& text) {
+        std::vector<std::pair<USAGE, std::string>> pairs;
+        std::stringstream ss(text);
+        std::string entry;
+        while (std::getline(ss, entry, ',')) {
+            size_t colon = entry.find(':');
+            if (colon == std::string::npos) continue;
+            try {
+                unsigned long usage = std::stoul(trim(entry.substr(0, colon)), nullptr, 0);
+                if (usage == 0 || usage > 0xFFFF) continue;
+                pairs.emplace_back(static_cast<USAGE>(usage), toUpper(trim(entry.substr(colon + 1))));
+            } catch (...) {
+                continue;
+            }
+        }
+        return pairs;
+    }
+}
+
+DeviceSplitter::DeviceSplitter()
+    : m_deviceCount(0) {
+}
+
+void DeviceSplitter::configure(const std::vector<SplitDeviceConfig>& devices) {
+    m_deviceCount = std::min(devices.size(), MAX_DEVICES);
+    for (size_t d = 0; d < m_deviceCount; ++d) {
+        CompiledPlan& plan = m_plans[d];
+        plan = CompiledPlan{};
+        plan.sourceMatch = devices[d].sourceMatch;
+        plan.outputCount = std::min(devices[d].outputs.size(), MAX_OUTPUTS);
+        plan.buttonOutput.fill(UNMAPPED);
+
+        for (size_t o = 0; o < plan.outputCount; ++o) {
+            const SplitOutputConfig& output = devices[d].outputs[o];
+            plan.outputNames[o] = output.name;
+
+            // Outputs must be disjoint: the first output to claim a usage keeps it
+            for (const auto& [usage, mask] : output.buttons) {
+                if (usage > MAX_BUTTON_USAGE || plan.buttonOutput[usage] != UNMAPPED) continue;
+                plan.buttonOutput[usage] = static_cast<uint8_t>(o);
+                plan.buttonMask[usage] = mask;
+            }
+            for (const auto& [usage, field] : output.axes) {
+                bool claimed = std::any_of(plan.axes.begin(), plan.axes.end(),
+                                           [usage = usage](const AxisEntry& e) { return e.usage == usage; });
+                if (!claimed) {
+                    plan.axes.push_back({usage, static_cast<uint8_t>(o), field});
+                }
+            }
+        }
+
+        for (auto& state : m_outputStates[d]) {
+            state = OutputState{};
+        }
+    }
+}
+
+int DeviceSplitter::findDevice(const ControllerState& state) const {
+    for (size_t d = 0; d < m_deviceCount; ++d) {
+        if (StringUtils::containsCaseInsensitive(state.productName, m_plans[d].sourceMatch) ||
+            StringUtils::containsCaseInsensitive(state.deviceInstanceId, m_plans[d].sourceMatch)) {
+            return static_cast<int>(d);
+        }
+    }
+    return -1;
+}
+
+DeviceSplitter::Binding DeviceSplitter::bind(int device, const ControllerState& state) const {
+    Binding binding;
+    binding.device = device;
+    for (const AxisEntry& axis : m_plans[device].axes) {
+        binding.axisRanges.push_back(HidAxis::findRange(state, axis.usage));
+    }
+    return binding;
+}
+
+void DeviceSplitter::split(const Binding& binding, const ControllerState& state,
+                           std::array<SplitGamepad, MAX_OUTPUTS>& outputs) const {
+    const CompiledPlan& plan = m_plans[binding.device];
+    outputs.fill(SplitGamepad{});
+
+    // Buttons: one table lookup per active usage
+    for (USAGE usage : state.m_activeButtons) {
+        if (usage > MAX_BUTTON_USAGE) continue;
+        uint8_t output = plan.buttonOutput[usage];
+        if (output != UNMAPPED) {
+            outputs[output].wButtons |= plan.buttonMask[usage];
+        }
+    }
+
+    // Axes: a handful of entries per device, ranges resolved by bind()
+    for (size_t a = 0; a < plan.axes.size(); ++a) {
+        const AxisEntry& axis = plan.axes[a];
+        auto it = state.m_hidValues.find(axis.usage);
+        if (it == state.m_hidValues.end()) continue;
+
+        const HidAxis::Range& range = binding.axisRanges[a];
+        SplitGamepad& out = outputs[axis.output];
+        LONG value = it->second;
+        switch (axis.field) {
+            case SplitField::LX: out.sThumbLX = HidAxis::toStick(value, range, false); break;
+            case SplitField::LY: out.sThumbLY = HidAxis::toStick(value, range, true); break;
+            case SplitField::RX: out.sThumbRX = HidAxis::toStick(value, range, false); break;
+            case SplitField::RY: out.sThumbRY = HidAxis::toStick(value, range, true); break;
+            case SplitField::LT: out.bLeftTrigger = HidAxis::toTrigger(value, range); break;
+            case SplitField::RT: out.bRightTrigger = HidAxis::toTrigger(value, range); break;
+        }
+    }
+}
+
+std::vector<std::pair<USAGE, WORD>> DeviceSplitter::parseButtonList(const std::string& text) {
+    std::vector<std::pair<USAGE, WORD>> buttons;
+    for (const auto& [usage, name] : parsePairs(text)) {
+        for (const auto& button : BUTTON_NAMES) {
+            if (name == button.name) {
+                buttons.emplace_back(usage, button.mask);
+                break;
+            }
+        }
+    }
+    return buttons;
+}
+
+std::vector<std::pair<USAGE, SplitField>> DeviceSplitter::parseAxisList(const std::string& text) {
+    std::vector<std::pair<USAGE, SplitField>> axes;
+    for (const auto& [usage, name] : parsePairs(text)) {
+        if (name == "LX") axes.emplace_back(usage, SplitField::LX);
+        else if (name == "LY") axes.emplace_back(usage, SplitField::LY);
+        else if (name == "RX") axes.emplace_back(usage, SplitField::RX);
+        else if (name == "RY") axes.emplace_back(usage, SplitField::RY);
+        else if (name == "LT") axes.emplace_back(usage, SplitField::LT);
+        else if (name == "RT") axes.emplace_back(usage, SplitField::RT);
+    }
+    return axes;
+}
@@ -0,0 +1,503 @@
+#include "core/drift_analyzer.hpp"
+#include "core/hid_axis.hpp"
+#include "utils/mapped_file.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+
+namespace {
+
+using Sample = SessionRecording::Sample;
+
+constexpr double FULL_SCALE = 32767.0;
+constexpr double SQRT2 = 1.4142135623730951;
+
+// HID stick usages in the order lx, ly, rx, ry, as TranslationLayer maps them
+constexpr USAGE STICK_USAGES[4] = {0x30, 0x31, 0x32, 0x35};
+
+// Smallest histogram index whose cumulative count reaches percent of total
+template <typename Count>
+size_t percentileIndex(const std::vector<Count>& histogram, uint64_t total, double percent) {
+    uint64_t target = static_cast<uint64_t>(std::ceil(percent / 100.0 * static_cast<double>(total)));
+    target = std::max<uint64_t>(1, std::min(target, total));
+    uint64_t cumulative = 0;
+    for (size_t i = 0; i < histogram.size(); ++i) {
+        cumulative += histogram[i];
+        if (cumulative >= target) return i;
+    }
+    return histogram.empty() ? 0 : histogram.size() - 1;
+}
+
+} // namespace
+
+struct DriftAnalyzer::Layout {
+    struct Axis {
+        HidAxis::Range range;
+        bool invert = false;
+    };
+    struct DeviceLayout {
+        bool xinput = false;
+        bool sticks[2] = {false, false};
+        Axis axes[4];
+    };
+
+    std::vector<DeviceLayout> devices;
+    int32_t restWindow;
+    size_t histogramSize;
+
+    Layout(const std::vector<SessionRecording::Device>& recorded, int32_t window)
+        : restWindow(window), histogramSize(2 * static_cast<size_t>(window) + 1) {
+        for (const auto& device : recorded) {
+            DeviceLayout layout;
+            layout.xinput = device.kind == SessionRecording::SourceKind::XINPUT;
+            if (layout.xinput) {
+                layout.sticks[LEFT_STICK] = layout.sticks[RIGHT_STICK] = true;
+            } else {
+                // A HID stick exists if the device declared both of its axes
+                bool declared[4] = {false, false, false, false};
+                for (int a = 0; a < 4; ++a) {
+                    // First cap of the usage, as HidAxis::findRange picks it live
+                    for (const auto& cap : device.valueCaps) {
+                        if (cap.usage != STICK_USAGES[a]) continue;
+                        declared[a] = true;
+                        layout.axes[a].range.logicalMin = cap.logicalMin;
+                        layout.axes[a].range.logicalMax = cap.logicalMax;
+                        break;
+                    }
+                    layout.axes[a].invert = (a % 2) == 1;   // HID Y grows downwards
+                }
+                layout.sticks[LEFT_STICK] = declared[0] && declared[1];
+                layout.sticks[RIGHT_STICK] = declared[2] && declared[3];
+            }
+            devices.push_back(layout);
+        }
+    }
+};
+
+struct DriftAnalyzer::StickPartial {
+    StickStats stats;
+    std::vector<uint32_t> histogramX;   // Resting samples, index = value + restWindow
+    std::vector<uint32_t> histogramY;
+    uint64_t samples = 0;
+};
+
+struct DriftAnalyzer::DevicePartial {
+    StickPartial sticks[2];
+    std::vector<uint64_t> intervals;    // INTERVAL_BIN_US bins
+    uint64_t intervalCount = 0;
+    uint64_t intervalSumUs = 0;
+    uint64_t maxIntervalUs = 0;
+    uint64_t samples = 0;
+    std::vector<SHORT> xy[2];           // Scratch: interleaved stick samples of the current task
+};
+
+struct DriftAnalyzer::Partial {
+    std::vector<DevicePartial> devices;
+};
+
+struct DriftAnalyzer::TaskEdges {
+    std::vector<uint64_t> firstUs;      // First and last sample time per device within the task
+    std::vector<uint64_t> lastUs;
+    std::vector<bool> seen;
+    std::string error;
+};
+
+DriftAnalyzer::DriftAnalyzer()
+    : DriftAnalyzer(Options()) {
+}
+
+DriftAnalyzer::DriftAnalyzer(const Options& options)
+    : m_options(options),
+      m_pool(options.workers) {
+    m_options.restWindow = std::clamp(m_options.restWindow, 1, 32768);
+    m_options.noisePercentile = std::clamp(m_options.noisePercentile, 50.0, 100.0);
+    m_options.sliceFrames = std::max<uint32_t>(1, m_options.sliceFrames);
+}
+
+DriftAnalyzer::~DriftAnalyzer() = default;
+
+bool DriftAnalyzer::analyzeFile(const std::string& path, Result& result, std::string* error) {
+    MappedFile file;
+    if (!file.open(path, error)) {
+        return false;
+    }
+    RecordingReader reader;
+    if (file.size() >= 8 && reader.open(file.data(), file.size(), nullptr)) {
+        return analyze(reader, result, error);
+    }
+
+    // Not a container: the text format
+    SessionRecording recording;
+    if (!recording.load(path, error)) {
+        return false;
+    }
+    return analyze(recording, result, error);
+}
+
+bool DriftAnalyzer::analyze(const RecordingReader& reader, Result& result, std::string* error) {
+    result = Result();
+    result.frames = reader.getFrameCount();
+    // A stream-backed reader shares one read position: its chunks are read one at a time
+    std::mutex streamMutex;
+    auto sourceFor = [&reader, &streamMutex](size_t task) -> SampleSource {
+        return [&reader, &streamMutex, task](const RecordingReader::SampleVisitor& visit, std::string* failure) {
+            if (reader.isInMemory()) {
+                return reader.visitChunk(task, visit, failure);
+            }
+            std::lock_guard<std::mutex> lock(streamMutex);
+            return reader.visitChunk(task, visit, failure);
+        };
+    };
+    return run(reader.getSession().devices, reader.getChunks().size(), sourceFor, result, error);
+}
+
+bool DriftAnalyzer::analyze(const SessionRecording& recording, Result& result, std::string* error) {
+    result = Result();
+    result.frames = recording.frames.size();
+    const size_t slice = m_options.sliceFrames;
+    const size_t tasks = (recording.frames.size() + slice - 1) / slice;
+    auto sourceFor = [&recording, slice](size_t task) -> SampleSource {
+        return [&recording, slice, task](const RecordingReader::SampleVisitor& visit, std::string* failure) {
+            const size_t end = std::min(recording.frames.size(), (task + 1) * slice);
+            for (size_t f = task * slice; f < end; ++f) {
+                for (const auto& sample : recording.frames[f].samples) {
+                    if (sample.device >= recording.devices.size()) {
+                        if (failure) *failure = "frame " + std::to_string(f) + " names an unknown device";
+                        return false;
+                    }
+                    visit(recording.frames[f].timeUs, sample);
+                }
+            }
+            return true;
+        };
+    };
+    return run(recording.devices, tasks, sourceFor, result, error);
+}
+
+DriftAnalyzer::Partial* DriftAnalyzer::acquirePartial(const Layout& layout) {
+    std::lock_guard<std::mutex> lock(m_partialMutex);
+    if (!m_freePartials.empty()) {
+        Partial* partial = m_freePartials.back();
+        m_freePartials.pop_back();
+        return partial;
+    }
+    auto partial = std::make_unique<Partial>();
+    partial->devices.resize(layout.devices.size());
+    for (auto& device : partial->devices) {
+        for (auto& stick : device.sticks) {
+            stick.histogramX.assign(layout.histogramSize, 0);
+            stick.histogramY.assign(layout.histogramSize, 0);
+        }
+        device.intervals.assign(INTERVAL_BINS, 0);
+    }
+    m_partials.push_back(std::move(partial));
+    return m_partials.back().get();
+}
+
+void DriftAnalyzer::releasePartial(Partial* partial) {
+    std::lock_guard<std::mutex> lock(m_partialMutex);
+    m_freePartials.push_back(partial);
+}
+
+bool DriftAnalyzer::run(const std::vector<SessionRecording::Device>& devices, size_t tasks,
+                        const std::function<SampleSource(size_t task)>& sourceFor, Result& result,
+                        std::string* error) {
+    const auto start = std::chrono::steady_clock::now();
+    const Layout layout(devices, m_options.restWindow);
+    m_partials.clear();
+    m_freePartials.clear();
+
+    std::vector<TaskEdges> edges(tasks);
+    m_pool.parallelFor(tasks, [&](size_t task) {
+        Partial* partial = acquirePartial(layout);
+        scanTask(layout, sourceFor(task), *partial, edges[task], edges[task].error);
+        releasePartial(partial);
+    });
+    for (const auto& task : edges) {
+        if (!task.error.empty()) {
+            if (error) *error = task.error;
+            return false;
+        }
+    }
+
+    std::vector<Partial*> partials;
+    for (const auto& partial : m_partials) {
+        partials.push_back(partial.get());
+    }
+    for (size_t d = 0; d < devices.size(); ++d) {
+        Device device;
+        device.index = d;
+        device.info = devices[d];
+        result.devices.push_back(device);
+    }
+    finish(layout, partials, edges, result);
+    result.tasks = tasks;
+    result.kernel = SimdKernels::active().stickStatsVariant;
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return true;
+}
+
+void DriftAnalyzer::scanTask(const Layout& layout, const SampleSource& source, Partial& partial, TaskEdges& edges,
+                             std::string& error) const {
+    const size_t deviceCount = layout.devices.size();
+    edges.firstUs.assign(deviceCount, 0);
+    edges.lastUs.assign(deviceCount, 0);
+    edges.seen.assign(deviceCount, false);
+
+    auto visit = [&](uint64_t timeUs, const Sample& sample) {
+        const size_t d = sample.device;
+        const Layout::DeviceLayout& device = layout.devices[d];
+        DevicePartial& target = partial.devices[d];
+        target.samples++;
+        if (edges.seen[d]) {
+            const uint64_t interval = timeUs - edges.lastUs[d];
+            target.intervals[std::min<uint64_t>(interval / INTERVAL_BIN_US, INTERVAL_BINS - 1)]++;
+            target.intervalCount++;
+            target.intervalSumUs += interval;
+            target.maxIntervalUs = std::max(target.maxIntervalUs, interval);
+        } else {
+            edges.seen[d] = true;
+            edges.firstUs[d] = timeUs;
+        }
+        edges.lastUs[d] = timeUs;
+
+        if (device.xinput) {
+            const XINPUT_GAMEPAD& g = sample.gamepad;
+            target.xy[LEFT_STICK].insert(target.xy[LEFT_STICK].end(), {g.sThumbLX, g.sThumbLY});
+            target.xy[RIGHT_STICK].insert(target.xy[RIGHT_STICK].end(), {g.sThumbRX, g.sThumbRY});
+            return;
+        }
+        SHORT axes[4] = {0, 0, 0, 0};
+        bool found[4] = {false, false, false, false};
+        for (const auto& [usage, value] : sample.values) {
+            for (int a = 0; a < 4; ++a) {
+                if (usage == STICK_USAGES[a]) {
+                    axes[a] = HidAxis::toStick(value, device.axes[a].range, device.axes[a].invert);
+                    found[a] = true;
+                }
+            }
+        }
+        for (int s = 0; s < 2; ++s) {
+            if (device.sticks[s] && found[2 * s] && found[2 * s + 1]) {
+                target.xy[s].insert(target.xy[s].end(), {axes[2 * s], axes[2 * s + 1]});
+            }
+        }
+    };
+    if (!source(visit, &error)) {
+        if (error.empty()) error = "scan failed";
+        return;
+    }
+
+    // The task's samples per stick, through the SIMD kernel and the rest histograms
+    const SimdKernelTable& kernels = SimdKernels::active();
+    const int32_t window = layout.restWindow;
+    for (auto& device : partial.devices) {
+        for (int s = 0; s < 2; ++s) {
+            std::vector<SHORT>& xy = device.xy[s];
+            StickPartial& stick = device.sticks[s];
+            const size_t pairs = xy.size() / 2;
+            kernels.stickStats(xy.data(), pairs, window, stick.stats);
+            stick.samples += pairs;
+            for (size_t i = 0; i < pairs; ++i) {
+                const int32_t x = xy[2 * i];
+                const int32_t y = xy[2 * i + 1];
+                if (std::abs(x) <= window && std::abs(y) <= window) {
+                    stick.histogramX[static_cast<size_t>(x + window)]++;
+                    stick.histogramY[static_cast<size_t>(y + window)]++;
+                }
+            }
+            xy.clear();
+        }
+    }
+}
+
+void DriftAnalyzer::finish(const Layout& layout, const std::vector<Partial*>& partials,
+                           const std::vector<TaskEdges>& edges, Result& result) const {
+    const int32_t window = layout.restWindow;
+    const double high = m_options.noisePercentile;
+    const double low = 100.0 - high;
+
+    for (size_t d = 0; d < result.devices.size(); ++d) {
+        Device& device = result.devices[d];
+
+        // Merge the per-thread partials of this device
+        DevicePartial merged;
+        merged.intervals.assign(INTERVAL_BINS, 0);
+        for (auto& stick : merged.sticks) {
+            stick.histogramX.assign(layout.histogramSize, 0);
+            stick.histogramY.assign(layout.histogramSize, 0);
+        }
+        for (const Partial* partial : partials) {
+            const DevicePartial& part = partial->devices[d];
+            merged.samples += part.samples;
+            merged.intervalCount += part.intervalCount;
+            merged.intervalSumUs += part.intervalSumUs;
+            merged.maxIntervalUs = std::max(merged.maxIntervalUs, part.maxIntervalUs);
+            for (size_t i = 0; i < INTERVAL_BINS; ++i) merged.intervals[i] += part.intervals[i];
+            for (int s = 0; s < 2; ++s) {
+                StickPartial& into = merged.sticks[s];
+                const StickPartial& from = part.sticks[s];
+                into.samples += from.samples;
+                for (int k = 0; k < 8; ++k) {
+                    into.stats.extents[k] = std::max(into.stats.extents[k], from.stats.extents[k]);
+                }
+                into.stats.restCount += from.stats.restCount;
+                into.stats.restSumX += from.stats.restSumX;
+                into.stats.restSumY += from.stats.restSumY;
+                for (size_t i = 0; i < layout.histogramSize; ++i) {
+                    into.histogramX[i] += from.histogramX[i];
+                    into.histogramY[i] += from.histogramY[i];
+                }
+            }
+        }
+
+        // Intervals that span two tasks
+        bool havePrevious = false;
+        uint64_t previousUs = 0;
+        for (const auto& task : edges) {
+            if (!task.seen[d]) continue;
+            if (havePrevious) {
+                const uint64_t interval = task.firstUs[d] - previousUs;
+                merged.intervals[std::min<uint64_t>(interval / INTERVAL_BIN_US, INTERVAL_BINS - 1)]++;
+                merged.intervalCount++;
+                merged.intervalSumUs += interval;
+                merged.maxIntervalUs = std::max(merged.maxIntervalUs, interval);
+            }
+            havePrevious = true;
+            previousUs = task.lastUs[d];
+        }
+
+        device.samples = merged.samples;
+        result.samples += merged.samples;
+        Interval& interval = device.interval;
+        interval.count = merged.intervalCount;
+        if (interval.count > 0) {
+            auto binUs = [](size_t bin) { return (static_cast<double>(bin) + 0.5) * INTERVAL_BIN_US; };
+            interval.meanUs = static_cast<double>(merged.intervalSumUs) / static_cast<double>(interval.count);
+            interval.p50Us = binUs(percentileIndex(merged.intervals, interval.count, 50.0));
+            interval.p99Us = binUs(percentileIndex(merged.intervals, interval.count, 99.0));
+            interval.maxUs = merged.maxIntervalUs;
+        }
+
+        for (int s = 0; s < 2; ++s) {
+            const StickPartial& from = merged.sticks[s];
+            Stick& stick = device.sticks[s];
+            stick.present = layout.devices[d].sticks[s] && from.samples > 0;
+            if (!stick.present) continue;
+            stick.samples = from.samples;
+            stick.restSamples = from.stats.restCount;
+            std::copy(std::begin(from.stats.extents), std::end(from.stats.extents), stick.extents);
+
+            if (stick.restSamples > 0) {
+                const double rest = static_cast<double>(stick.restSamples);
+                stick.meanX = static_cast<double>(from.stats.restSumX) / rest;
+                stick.meanY = static_cast<double>(from.stats.restSumY) / rest;
+                auto valueAt = [&](const std::vector<uint32_t>& histogram, double percent) {
+                    return static_cast<int32_t>(percentileIndex(histogram, stick.restSamples, percent)) - window;
+                };
+                stick.medianX = valueAt(from.histogramX, 50.0);
+                stick.medianY = valueAt(from.histogramY, 50.0);
+                stick.lowX = valueAt(from.histogramX, low);
+                stick.highX = valueAt(from.histogramX, high);
+                stick.lowY = valueAt(from.histogramY, low);
+                stick.highY = valueAt(from.histogramY, high);
+                const double spreadX = std::max(stick.medianX - stick.lowX, stick.highX - stick.medianX);
+                const double spreadY = std::max(stick.medianY - stick.lowY, stick.highY - stick.medianY);
+                stick.noiseRadius = std::hypot(spreadX, spreadY);
+
+                // The deadzone must cover the offset center plus its noise, since it is centered on 0
+                const double drift = std::hypot(stick.medianX, stick.medianY) + stick.noiseRadius;
+                const double deadzone = std::min(0.5, m_options.margin * drift / FULL_SCALE);
+                stick.deadzone = static_cast<float>(std::ceil(deadzone * 200.0) / 200.0);
+                // Only with a deadzone of our own: otherwise resting noise would be lifted past the game's
+                stick.antiDeadzone = stick.deadzone > 0.0f ? m_options.gameDeadzone : 0.0f;
+            }
+
+            // Gate shape, only once the stick went most of the way in all eight directions
+            const double half = FULL_SCALE / 2.0;
+            bool swept = true;
+            for (int k = 0; k < 8; ++k) {
+                swept = swept && stick.extents[k] / (k < 4 ? 1.0 : SQRT2) >= half;
+            }
+            if (swept) {
+                const double axis = (stick.extents[0] + stick.extents[1] + stick.extents[2] + stick.extents[3]) / 4.0;
+                const double diagonal =
+                    (stick.extents[4] + stick.extents[5] + stick.extents[6] + stick.extents[7]) / 4.0 / SQRT2;
+                stick.gateRatio = diagonal / axis;
+                stick.gateShape = stick.gateRatio < 1.1 ? "round" : stick.gateRatio > 1.3 ? "square" : "rounded square";
+            }
+
+            // Gains that stretch each half-axis from the median center to full scale
+            const double reach[4] = {
+                static_cast<double>(stick.extents[0] - stick.medianX), static_cast<double>(stick.extents[1] + stick.medianX),
+                static_cast<double>(stick.extents[2] - stick.medianY), static_cast<double>(stick.extents[3] + stick.medianY)};
+            for (int k = 0; k < 4; ++k) {
+                const double fullScale = k % 2 ? FULL_SCALE + 1.0 : FULL_SCALE;   // Negative side reaches -32768
+                stick.gain[k] = reach[k] >= half ? fullScale / reach[k] : 1.0;
+            }
+        }
+    }
+}
+
+void DriftAnalyzer::writeReport(const Result& result, std::ostream& out) {
+    static const char* const STICK_NAMES[2] = {"left", "right"};
+    const std::ios::fmtflags flags = out.flags();
+    out << std::fixed;
+    out << result.devices.size() << " device(s), " << result.frames << " frames, " << result.samples << " samples in "
+        << std::setprecision(3) << result.seconds << " s (" << result.tasks << " tasks, stickStats "
+        << result.kernel << ")\n";
+
+    float deadzones[2] = {0.0f, 0.0f};
+    float antiDeadzones[2] = {0.0f, 0.0f};
+    for (const Device& device : result.devices) {
+        out << "\nDevice " << device.index << ": ";
+        if (device.info.kind == SessionRecording::SourceKind::XINPUT) {
+            out << "XInput user " << device.info.userId;
+        } else {
+            out << "HID " << std::hex << std::setfill('0') << std::setw(4) << device.info.vendorId << ":"
+                << std::setw(4) << device.info.productId << std::dec << std::setfill(' ');
+            if (!device.info.productName.empty()) out << " " << device.info.productName;
+        }
+        out << "\n";
+        const Interval& interval = device.interval;
+        out << std::setprecision(1) << "  reports: " << device.samples << ", interval mean " << interval.meanUs
+            << " us, p50 " << interval.p50Us << " us, p99 " << interval.p99Us << " us, max " << interval.maxUs
+            << " us\n";
+
+        for (int s = 0; s < 2; ++s) {
+            const Stick& stick = device.sticks[s];
+            if (!stick.present) continue;
+            const double resting = 100.0 * static_cast<double>(stick.restSamples) / static_cast<double>(stick.samples);
+            out << "  " << STICK_NAMES[s] << " stick: " << std::setprecision(1) << resting << "% of "
+                << stick.samples << " samples resting\n";
+            if (stick.restSamples == 0) {
+                out << "    never at rest; no recommendation\n";
+                continue;
+            }
+            out << "    center: median (" << stick.medianX << ", " << stick.medianY << "), mean (" << stick.meanX
+                << ", " << stick.meanY << "), spread x " << stick.lowX << ".." << stick.highX << " y "
+                << stick.lowY << ".." << stick.highY << "\n";
+            out << "    noise radius " << stick.noiseRadius << ", gate " << stick.gateShape;
+            if (stick.gateRatio > 0.0) out << std::setprecision(2) << " (diagonal/axis " << stick.gateRatio << ")";
+            out << "\n";
+            out << std::setprecision(3) << "    recommended: deadzone " << stick.deadzone << ", anti-deadzone "
+                << stick.antiDeadzone << ", center (" << stick.medianX << ", " << stick.medianY << "), gain +x "
+                << stick.gain[0] << " -x " << stick.gain[1] << " +y " << stick.gain[2] << " -y " << stick.gain[3]
+                << "\n";
+            deadzones[s] = std::max(deadzones[s], stick.deadzone);
+            antiDeadzones[s] = std::max(antiDeadzones[s], stick.antiDeadzone);
+        }
+    }
+
+    // The proxy applies one deadzone per stick to every device: take the widest
+    out << "\n[InputProcessing] (widest over all devices)\n" << std::setprecision(3);
+    out << "stick_deadzone_enabled=" << ((deadzones[0] > 0.0f || deadzones[1] > 0.0f) ? "true" : "false") << "\n";
+    out << "left_stick_deadzone=" << deadzones[0] << "\n";
+    out << "right_stick_deadzone=" << deadzones[1] << "\n";
+    out << "left_stick_anti_deadzone=" << antiDeadzones[0] << "\n";
+    out << "right_stick_anti_deadzone=" << antiDeadzones[1] << "\n";
+    out.flags(flags);
+}
@@ -0,0 +1,240 @@
+#include "core/golden_output.hpp"
+#include "core/session_recording.hpp"
+#include "core/translation_layer.hpp"
+
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+namespace {
+
+enum class FieldClass {
+    EXACT,
+    AXIS,
+    TRIGGER,
+    DINPUT_TRIGGER,
+    MOTION
+};
+
+FieldClass classify(const std::string& name) {
+    if (name == "lx" || name == "ly" || name == "rx" || name == "ry" ||
+        name == "dx" || name == "dy" || name == "drx" || name == "dry") {
+        return FieldClass::AXIS;
+    }
+    if (name == "lt" || name == "rt") return FieldClass::TRIGGER;
+    if (name == "dz" || name == "drz") return FieldClass::DINPUT_TRIGGER;
+    if (name == "gx" || name == "gy" || name == "gz" || name == "ax" || name == "ay" || name == "az") {
+        return FieldClass::MOTION;
+    }
+    return FieldClass::EXACT;
+}
+
+bool toInteger(const std::string& text, long long& value) {
+    char* end = nullptr;
+    value = std::strtoll(text.c_str(), &end, 0);
+    return !text.empty() && end && *end == '\0';
+}
+
+std::string hex(unsigned long long value) {
+    std::ostringstream out;
+    out << "0x" << std::hex << value;
+    return out.str();
+}
+
+} // namespace
+
+bool GoldenOutput::render(const SessionRecording& recording, GoldenOutput& output, std::string* error) {
+    TranslationLayer layer;
+    if (!recording.applyOptions(layer, error)) {
+        return false;
+    }
+
+    output.records.clear();
+    RecordingPlayer player(recording);
+    while (!player.done()) {
+        player.update(0.0);
+        size_t frame = player.frameIndex() - 1;
+        for (const auto& state : layer.translate(player.getInputStates())) {
+            XINPUT_STATE xinput = layer.translateToXInput(state);
+            TranslationLayer::DInputState dinput = layer.translateToDInput(state);
+
+            uint32_t dinputButtons = 0;
+            for (int b = 0; b < 32; ++b) {
+                if (dinput.rgbButtons[b] & 0x80) dinputButtons |= 1u << b;
+            }
+
+            Record record;
+            auto add = [&record](const char* name, const std::string& value) {
+                record.fields.push_back({name, value});
+            };
+            add("f", std::to_string(frame));
+            add("slot", std::to_string(state.sourceSlot));
+            add("user", std::to_string(state.sourceUserId));
+            add("src", state.isXInputSource ? "xinput" : "hid");
+            add("target", state.targetType == TranslatedState::TARGET_XINPUT ? "xinput" : "dinput");
+            add("pkt", std::to_string(xinput.dwPacketNumber));
+            add("btn", hex(xinput.Gamepad.wButtons));
+            add("lt", std::to_string(xinput.Gamepad.bLeftTrigger));
+            add("rt", std::to_string(xinput.Gamepad.bRightTrigger));
+            add("lx", std::to_string(xinput.Gamepad.sThumbLX));
+            add("ly", std::to_string(xinput.Gamepad.sThumbLY));
+            add("rx", std::to_string(xinput.Gamepad.sThumbRX));
+            add("ry", std::to_string(xinput.Gamepad.sThumbRY));
+            add("dx", std::to_string(dinput.lX));
+            add("dy", std::to_string(dinput.lY));
+            add("dz", std::to_string(dinput.lZ));
+            add("drx", std::to_string(dinput.lRx));
+            add("dry", std::to_string(dinput.lRy));
+            add("drz", std::to_string(dinput.lRz));
+            add("pov", std::to_string(dinput.rgdwPOV[0]));
+            add("dbtn", hex(dinputButtons));
+            if (dinput.motion.valid) {
+                add("gx", std::to_string(dinput.motion.gyro[0]));
+                add("gy", std::to_string(dinput.motion.gyro[1]));
+                add("gz", std::to_string(dinput.motion.gyro[2]));
+                add("ax", std::to_string(dinput.motion.accel[0]));
+                add("ay", std::to_string(dinput.motion.accel[1]));
+                add("az", std::to_string(dinput.motion.accel[2]));
+                add("mts", std::to_string(dinput.motion.sensorTimestamp));
+            }
+            output.records.push_back(record);
+        }
+    }
+    return true;
+}
+
+bool GoldenOutput::parse(std::istream& in, std::string* error) {
+    records.clear();
+    tolerance = Tolerance{};
+
+    int lineNumber = 0;
+    auto fail = [&](const std::string& reason) {
+        if (error) {
+            *error = "line " + std::to_string(lineNumber) + ": " + reason;
+        }
+        return false;
+    };
+
+    std::string line;
+    bool sawHeader = false;
+    while (std::getline(in, line)) {
+        lineNumber++;
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::istringstream tokens(line);
+        std::string token;
+        tokens >> token;
+
+        if (!sawHeader) {
+            int version = 0;
+            if (token != "xidp-golden" || !(tokens >> version) || version != FORMAT_VERSION) {
+                return fail("expected 'xidp-golden " + std::to_string(FORMAT_VERSION) + "'");
+            }
+            sawHeader = true;
+            continue;
+        }
+
+        if (token == "tolerance") {
+            while (tokens >> token) {
+                size_t eq = token.find('=');
+                long long value = 0;
+                if (eq == std::string::npos || !toInteger(token.substr(eq + 1), value) || value < 0) {
+                    return fail("bad tolerance: " + token);
+                }
+                std::string name = token.substr(0, eq);
+                if (name == "axis") tolerance.axis = static_cast<int>(value);
+                else if (name == "trigger") tolerance.trigger = static_cast<int>(value);
+                else if (name == "motion") tolerance.motion = static_cast<int>(value);
+                else return fail("unknown tolerance class: " + name);
+            }
+            continue;
+        }
+
+        Record record;
+        do {
+            size_t eq = token.find('=');
+            if (eq == std::string::npos || eq == 0) {
+                return fail("expected name=value: " + token);
+            }
+            record.fields.push_back({token.substr(0, eq), token.substr(eq + 1)});
+        } while (tokens >> token);
+        records.push_back(record);
+    }
+
+    if (!sawHeader) {
+        lineNumber = 0;
+        return fail("empty golden file");
+    }
+    return true;
+}
+
+bool GoldenOutput::load(const std::string& path, std::string* error) {
+    std::ifstream in(path);
+    if (!in) {
+        if (error) *error = "cannot open " + path;
+        return false;
+    }
+    return parse(in, error);
+}
+
+void GoldenOutput::write(std::ostream& out) const {
+    out << "xidp-golden " << FORMAT_VERSION << "\n"
+        << "tolerance axis=" << tolerance.axis << " trigger=" << tolerance.trigger
+        << " motion=" << tolerance.motion << "\n";
+    for (const auto& record : records) {
+        for (size_t i = 0; i < record.fields.size(); ++i) {
+            out << (i ? " " : "") << record.fields[i].first << "=" << record.fields[i].second;
+        }
+        out << "\n";
+    }
+}
+
+std::vector<GoldenOutput::Mismatch> GoldenOutput::compare(const GoldenOutput& actual, size_t maxMismatches) const {
+    std::vector<Mismatch> mismatches;
+    auto full = [&]() { return mismatches.size() >= maxMismatches; };
+
+    size_t common = records.size() < actual.records.size() ? records.size() : actual.records.size();
+    for (size_t r = 0; r < common && !full(); ++r) {
+        const Record& want = records[r];
+        const Record& got = actual.records[r];
+        if (want.fields.size() != got.fields.size()) {
+            mismatches.push_back({r, "", std::to_string(want.fields.size()) + " fields",
+                                  std::to_string(got.fields.size()) + " fields"});
+            continue;
+        }
+        for (size_t i = 0; i < want.fields.size() && !full(); ++i) {
+            const auto& [name, expected] = want.fields[i];
+            const auto& [gotName, value] = got.fields[i];
+            if (name != gotName) {
+                mismatches.push_back({r, name, name, gotName});
+                break;
+            }
+            if (expected == value) {
+                continue;
+            }
+
+            long long limit = 0;
+            switch (classify(name)) {
+                case FieldClass::AXIS: limit = tolerance.axis; break;
+                case FieldClass::TRIGGER: limit = tolerance.trigger; break;
+                case FieldClass::DINPUT_TRIGGER: limit = 257LL * tolerance.trigger; break;
+                case FieldClass::MOTION: limit = tolerance.motion; break;
+                case FieldClass::EXACT: limit = 0; break;
+            }
+            long long a = 0, b = 0;
+            bool numeric = toInteger(expected, a) && toInteger(value, b);
+            long long diff = a > b ? a - b : b - a;
+            if (!numeric || diff > limit) {
+                mismatches.push_back({r, name, expected, value});
+            }
+        }
+    }
+
+    if (records.size() != actual.records.size() && !full()) {
+        mismatches.push_back({common, "", std::to_string(records.size()) + " records",
+                              std::to_string(actual.records.size()) + " records"});
+    }
+    return mismatches;
+}
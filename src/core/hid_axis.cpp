@@ -0,0 +1,37 @@
+#include "core/hid_axis.hpp"
+
+HidAxis::Range HidAxis::findRange(const ControllerState& state, USAGE usage) {
+    Range range;
+    for (const auto& cap : state.valueCaps) {
+        if (cap.UsagePage == 0x01 && cap.Range.UsageMin == usage) {
+            range.logicalMin = cap.LogicalMin;
+            range.logicalMax = cap.LogicalMax;
+            break;
+        }
+    }
+    return range;
+}
+
+SHORT HidAxis::toStick(LONG value, const Range& range, bool invert) {
+    LONG center = (range.logicalMax + range.logicalMin) / 2;
+    LONG span = range.logicalMax - range.logicalMin;
+    if (span == 0) span = 1;  // Avoid division by zero
+
+    // (value - center) / (span/2) * 32767, clamped to SHORT
+    double normalized = static_cast<double>(value - center) / (span / 2.0) * 32767.0;
+    if (normalized > 32767.0) normalized = 32767.0;
+    if (normalized < -32768.0) normalized = -32768.0;
+
+    SHORT result = static_cast<SHORT>(normalized);
+    return invert ? static_cast<SHORT>(-result) : result;
+}
+
+BYTE HidAxis::toTrigger(LONG value, const Range& range) {
+    LONG span = range.logicalMax - range.logicalMin;
+    if (span == 0) span = 1;
+
+    double normalized = static_cast<double>(value - range.logicalMin) / span * 255.0;
+    if (normalized > 255.0) normalized = 255.0;
+    if (normalized < 0.0) normalized = 0.0;
+    return static_cast<BYTE>(normalized);
+}
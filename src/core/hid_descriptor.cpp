@@ -0,0 +1,386 @@
+#include "core/hid_descriptor.hpp"
+
+#include <algorithm>
+
+namespace {
+
+// Item types (bits 2-3 of the prefix)
+constexpr uint8_t TYPE_MAIN = 0;
+constexpr uint8_t TYPE_GLOBAL = 1;
+constexpr uint8_t TYPE_LOCAL = 2;
+
+// Main item tags
+constexpr uint8_t MAIN_INPUT = 0x8;
+constexpr uint8_t MAIN_OUTPUT = 0x9;
+constexpr uint8_t MAIN_COLLECTION = 0xA;
+constexpr uint8_t MAIN_FEATURE = 0xB;
+constexpr uint8_t MAIN_END_COLLECTION = 0xC;
+
+// Global item tags
+constexpr uint8_t GLOBAL_USAGE_PAGE = 0x0;
+constexpr uint8_t GLOBAL_LOGICAL_MIN = 0x1;
+constexpr uint8_t GLOBAL_LOGICAL_MAX = 0x2;
+constexpr uint8_t GLOBAL_REPORT_SIZE = 0x7;
+constexpr uint8_t GLOBAL_REPORT_ID = 0x8;
+constexpr uint8_t GLOBAL_REPORT_COUNT = 0x9;
+constexpr uint8_t GLOBAL_PUSH = 0xA;
+constexpr uint8_t GLOBAL_POP = 0xB;
+
+// Local item tags
+constexpr uint8_t LOCAL_USAGE = 0x0;
+constexpr uint8_t LOCAL_USAGE_MIN = 0x1;
+constexpr uint8_t LOCAL_USAGE_MAX = 0x2;
+
+// Main item data bits
+constexpr uint32_t DATA_CONSTANT = 0x01;
+constexpr uint32_t DATA_VARIABLE = 0x02;
+constexpr uint32_t DATA_NULL_STATE = 0x40;
+
+constexpr uint8_t LONG_ITEM_PREFIX = 0xFE;
+constexpr size_t MAX_GLOBAL_STACK = 8;
+constexpr uint32_t MAX_REPORT_BITS = 8 * ControllerState::INPUT_BUFFER_SIZE;
+
+struct GlobalState {
+    uint32_t usagePage = 0;
+    int32_t logicalMin = 0;
+    int32_t logicalMax = 0;
+    uint32_t logicalMaxRaw = 0;
+    uint8_t logicalMaxSize = 0;
+    uint32_t reportSize = 0;
+    uint32_t reportCount = 0;
+    uint8_t reportId = 0;
+};
+
+struct LocalState {
+    std::vector<uint32_t> usages;   // Extended usages (page in the high 16 bits)
+    uint32_t usageMin = 0;
+    uint32_t usageMax = 0;
+    bool hasMin = false;
+    bool hasMax = false;
+
+    void clear() { *this = LocalState(); }
+};
+
+int32_t signExtend(uint32_t value, uint8_t size) {
+    switch (size) {
+        case 1: return static_cast<int8_t>(value);
+        case 2: return static_cast<int16_t>(value);
+        default: return static_cast<int32_t>(value);
+    }
+}
+
+// A usage without an explicit page takes the current Usage Page
+uint32_t extendUsage(uint32_t usage, uint8_t size, uint32_t usagePage) {
+    return size == 4 ? usage : ((usagePage << 16) | (usage & 0xFFFF));
+}
+
+} // namespace
+
+HidReportDescriptor::HidReportDescriptor()
+    : m_usagePage(0),
+      m_usage(0),
+      m_usesReportIds(false) {
+}
+
+uint32_t& HidReportDescriptor::inputCursor(uint8_t reportId) {
+    for (auto& report : m_reports) {
+        if (report.reportId == reportId) {
+            return report.bits;
+        }
+    }
+    m_reports.push_back(ReportLayout{reportId, 0});
+    return m_reports.back().bits;
+}
+
+bool HidReportDescriptor::parse(const uint8_t* descriptor, size_t length) {
+    m_values.clear();
+    m_buttons.clear();
+    m_buttonArrays.clear();
+    m_reports.clear();
+    m_usagePage = 0;
+    m_usage = 0;
+    m_usesReportIds = false;
+    m_error.clear();
+
+    auto fail = [this](size_t offset, const std::string& message) {
+        m_error = message + " at byte " + std::to_string(offset);
+        return false;
+    };
+
+    GlobalState global;
+    std::vector<GlobalState> globalStack;
+    LocalState local;
+    int depth = 0;
+
+    size_t pos = 0;
+    while (pos < length) {
+        size_t itemOffset = pos;
+        uint8_t prefix = descriptor[pos++];
+
+        if (prefix == LONG_ITEM_PREFIX) {
+            if (pos + 2 > length) return fail(itemOffset, "Truncated long item");
+            pos += 2 + descriptor[pos];
+            if (pos > length) return fail(itemOffset, "Truncated long item");
+            continue;
+        }
+
+        uint8_t size = prefix & 0x03;
+        if (size == 3) size = 4;
+        uint8_t type = (prefix >> 2) & 0x03;
+        uint8_t tag = prefix >> 4;
+        if (pos + size > length) return fail(itemOffset, "Truncated item");
+
+        uint32_t data = 0;
+        for (uint8_t i = 0; i < size; ++i) {
+            data |= static_cast<uint32_t>(descriptor[pos + i]) << (8 * i);
+        }
+        pos += size;
+
+        if (type == TYPE_GLOBAL) {
+            switch (tag) {
+                case GLOBAL_USAGE_PAGE: global.usagePage = data & 0xFFFF; break;
+                case GLOBAL_LOGICAL_MIN: global.logicalMin = signExtend(data, size); break;
+                case GLOBAL_LOGICAL_MAX:
+                    global.logicalMax = signExtend(data, size);
+                    global.logicalMaxRaw = data;
+                    global.logicalMaxSize = size;
+                    break;
+                case GLOBAL_REPORT_SIZE: global.reportSize = data; break;
+                case GLOBAL_REPORT_COUNT: global.reportCount = data; break;
+                case GLOBAL_REPORT_ID:
+                    if (data == 0 || data > 0xFF) return fail(itemOffset, "Invalid report ID");
+                    if (!m_usesReportIds && !m_reports.empty()) {
+                        return fail(itemOffset, "Report ID after unnumbered input");
+                    }
+                    m_usesReportIds = true;
+                    global.reportId = static_cast<uint8_t>(data);
+                    break;
+                case GLOBAL_PUSH:
+                    if (globalStack.size() >= MAX_GLOBAL_STACK) return fail(itemOffset, "Push too deep");
+                    globalStack.push_back(global);
+                    break;
+                case GLOBAL_POP:
+                    if (globalStack.empty()) return fail(itemOffset, "Pop without push");
+                    global = globalStack.back();
+                    globalStack.pop_back();
+                    break;
+                default:
+                    break;   // Physical range, units: not needed for decoding
+            }
+            continue;
+        }
+
+        if (type == TYPE_LOCAL) {
+            switch (tag) {
+                case LOCAL_USAGE: local.usages.push_back(extendUsage(data, size, global.usagePage)); break;
+                case LOCAL_USAGE_MIN: local.usageMin = extendUsage(data, size, global.usagePage); local.hasMin = true; break;
+                case LOCAL_USAGE_MAX: local.usageMax = extendUsage(data, size, global.usagePage); local.hasMax = true; break;
+                default: break;
+            }
+            continue;
+        }
+
+        if (type != TYPE_MAIN) {
+            continue;   // Reserved item type
+        }
+
+        switch (tag) {
+            case MAIN_COLLECTION:
+                // The first application collection names the device
+                if (depth == 0 && m_usage == 0) {
+                    uint32_t usage = !local.usages.empty() ? local.usages.front() : local.usageMin;
+                    m_usagePage = static_cast<USAGE>(usage >> 16);
+                    m_usage = static_cast<USAGE>(usage & 0xFFFF);
+                }
+                depth++;
+                break;
+            case MAIN_END_COLLECTION:
+                if (depth == 0) return fail(itemOffset, "End Collection without Collection");
+                depth--;
+                break;
+            case MAIN_INPUT: {
+                uint32_t& cursor = inputCursor(global.reportId);
+                // Both fields come straight from the descriptor: multiply in 64 bits and bound
+                // the count on its own (a zero size would let any count through) before the
+                // usage and field vectors below grow with it
+                uint64_t bits = static_cast<uint64_t>(global.reportSize) * global.reportCount;
+                if (global.reportSize > 32 || global.reportCount > MAX_REPORT_BITS ||
+                    cursor + bits > MAX_REPORT_BITS) {
+                    return fail(itemOffset, "Input item too large");
+                }
+                uint32_t start = reportBase() + cursor;
+                cursor += static_cast<uint32_t>(bits);
+                if (data & DATA_CONSTANT || global.reportCount == 0 || global.reportSize == 0) {
+                    break;   // Padding
+                }
+
+                // A non-negative minimum means the maximum is unsigned (26 FF 00 and 25 FF alike)
+                LONG logicalMin = global.logicalMin;
+                LONG logicalMax = global.logicalMin >= 0 && global.logicalMaxSize < 4
+                    ? static_cast<LONG>(global.logicalMaxRaw) : global.logicalMax;
+
+                // Usage list, or the range when no list was given
+                std::vector<uint32_t> usages = local.usages;
+                if (usages.empty() && local.hasMin && local.hasMax && local.usageMax >= local.usageMin) {
+                    for (uint32_t usage = local.usageMin;
+                         usage <= local.usageMax && usages.size() < global.reportCount; ++usage) {
+                        usages.push_back(usage);
+                    }
+                }
+
+                if (!(data & DATA_VARIABLE)) {
+                    uint32_t first = local.hasMin ? local.usageMin : (usages.empty() ? 0 : usages.front());
+                    uint32_t last = local.hasMax ? local.usageMax : (usages.empty() ? 0 : usages.back());
+                    if ((first >> 16) == BUTTON_PAGE && global.reportSize <= 16) {
+                        m_buttonArrays.push_back(ButtonArrayField{
+                            global.reportId, start, static_cast<uint8_t>(global.reportSize),
+                            static_cast<uint16_t>(global.reportCount),
+                            static_cast<USAGE>(first & 0xFFFF), static_cast<USAGE>(last & 0xFFFF), logicalMin});
+                    }
+                    break;
+                }
+
+                size_t elements = std::min<size_t>(usages.size(), global.reportCount);
+                if (usages.size() < global.reportCount && usages.size() <= 1) {
+                    // Value array under one usage: HidP_GetUsageValue refuses these
+                    if (usages.empty() || (usages.front() >> 16) != BUTTON_PAGE) elements = 0;
+                }
+                for (size_t i = 0; i < elements; ++i) {
+                    uint32_t offset = start + static_cast<uint32_t>(i) * global.reportSize;
+                    USAGE page = static_cast<USAGE>(usages[i] >> 16);
+                    USAGE usage = static_cast<USAGE>(usages[i] & 0xFFFF);
+                    if (page == BUTTON_PAGE && global.reportSize == 1) {
+                        m_buttons.push_back(ButtonField{global.reportId, offset, usage});
+                    } else {
+                        m_values.push_back(ValueField{global.reportId, offset, static_cast<uint8_t>(global.reportSize),
+                                                      page, usage, logicalMin, logicalMax,
+                                                      (data & DATA_NULL_STATE) != 0});
+                    }
+                }
+                break;
+            }
+            case MAIN_OUTPUT:
+            case MAIN_FEATURE:
+                break;   // Only input reports are decoded
+            default:
+                break;
+        }
+        local.clear();
+    }
+
+    if (depth != 0) {
+        return fail(length, "Unterminated collection");
+    }
+    return true;
+}
+
+size_t HidReportDescriptor::getInputReportLength(uint8_t reportId) const {
+    for (const auto& report : m_reports) {
+        if (report.reportId == reportId) {
+            return (report.bits + 7) / 8 + (m_usesReportIds ? 1 : 0);
+        }
+    }
+    return 0;
+}
+
+size_t HidReportDescriptor::getMaxInputReportLength() const {
+    size_t length = 0;
+    for (const auto& report : m_reports) {
+        length = std::max(length, getInputReportLength(report.reportId));
+    }
+    return length;
+}
+
+std::vector<HIDP_VALUE_CAPS> HidReportDescriptor::buildValueCaps() const {
+    std::vector<HIDP_VALUE_CAPS> caps;
+    caps.reserve(m_values.size());
+    for (const auto& field : m_values) {
+        HIDP_VALUE_CAPS cap{};
+        cap.UsagePage = field.usagePage;
+        cap.ReportID = field.reportId;
+        cap.IsAbsolute = 1;
+        cap.HasNull = field.hasNull ? 1 : 0;
+        cap.BitSize = field.bitSize;
+        cap.ReportCount = 1;
+        cap.LogicalMin = field.logicalMin;
+        cap.LogicalMax = field.logicalMax;
+        cap.Range.UsageMin = field.usage;
+        cap.Range.UsageMax = field.usage;
+        caps.push_back(cap);
+    }
+    return caps;
+}
+
+HIDP_CAPS HidReportDescriptor::buildCaps() const {
+    HIDP_CAPS caps{};
+    caps.Usage = m_usage;
+    caps.UsagePage = m_usagePage;
+    caps.InputReportByteLength = static_cast<USHORT>(getMaxInputReportLength());
+    caps.NumberInputButtonCaps = static_cast<USHORT>(m_buttons.size() + m_buttonArrays.size());
+    caps.NumberInputValueCaps = static_cast<USHORT>(m_values.size());
+    return caps;
+}
+
+uint32_t HidReportDescriptor::readBits(const uint8_t* report, size_t length, uint32_t bitOffset, uint8_t bitSize) {
+    if (bitSize == 0 || bitSize > 32 || bitOffset + bitSize > 8 * length) {
+        return 0;
+    }
+    // Gather the (at most five) bytes spanned by the field
+    size_t first = bitOffset / 8;
+    size_t last = (bitOffset + bitSize - 1) / 8;
+    uint64_t window = 0;
+    for (size_t i = last + 1; i-- > first;) {
+        window = (window << 8) | report[i];
+    }
+    window >>= bitOffset % 8;
+    return static_cast<uint32_t>(bitSize == 32 ? window : window & ((1ull << bitSize) - 1));
+}
+
+bool HidReportDescriptor::decode(const uint8_t* report, size_t length, ControllerState& state) const {
+    if (!report || length == 0) {
+        return false;
+    }
+    uint8_t reportId = m_usesReportIds ? report[0] : 0;
+    if (getInputReportLength(reportId) == 0) {
+        return false;
+    }
+    size_t bits = 8 * length;
+
+    // Buttons are replaced only by reports that carry them, as with HidP_GetUsages
+    bool hasButtons = false;
+    for (const auto& field : m_buttons) {
+        if (field.reportId != reportId || field.bitOffset >= bits) continue;
+        if (!hasButtons) {
+            state.m_activeButtons.clear();
+            hasButtons = true;
+        }
+        if (report[field.bitOffset / 8] & (1u << (field.bitOffset % 8))) {
+            state.m_activeButtons.push_back(field.usage);
+        }
+    }
+    for (const auto& field : m_buttonArrays) {
+        if (field.reportId != reportId) continue;
+        if (!hasButtons) {
+            state.m_activeButtons.clear();
+            hasButtons = true;
+        }
+        for (uint16_t i = 0; i < field.count; ++i) {
+            uint32_t offset = field.bitOffset + static_cast<uint32_t>(i) * field.bitSize;
+            if (offset + field.bitSize > bits) break;
+            LONG index = static_cast<LONG>(readBits(report, length, offset, field.bitSize)) - field.logicalMin;
+            if (index >= 0 && index <= static_cast<LONG>(field.usageMax) - static_cast<LONG>(field.usageMin)) {
+                state.m_activeButtons.push_back(static_cast<USAGE>(field.usageMin + index));
+            }
+        }
+    }
+
+    for (const auto& field : m_values) {
+        if (field.reportId != reportId || field.bitOffset + field.bitSize > bits) continue;
+        state.m_hidValues[field.usage] = static_cast<LONG>(readBits(report, length, field.bitOffset, field.bitSize));
+    }
+
+    if (state.motionPlan.hasMotion()) {
+        extractMotion(state.motionPlan, report, length, state.motion);
+    }
+    return true;
+}
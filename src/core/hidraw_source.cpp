@@ -0,0 +1,342 @@
+#include "core/hidraw_source.hpp"
+
+#ifdef __linux__
+
+#include "utils/logger.hpp"
+#include "utils/timing.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <fstream>
+#include <linux/hidraw.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr uint64_t WAKE_TOKEN = 0;
+constexpr int MAX_EVENTS = 16;
+
+std::wstring widen(const std::string& text) {
+    return std::wstring(text.begin(), text.end());
+}
+
+std::string trim(std::string text) {
+    while (!text.empty() && (text.back() == '\n' || text.back() == ' ' || text.back() == '\0')) {
+        text.pop_back();
+    }
+    return text;
+}
+
+// HIDIOCGRAWNAME is "<manufacturer> <product>" for USB devices, while
+// InputCapture matches profiles on the product string alone (DS4: "Wireless
+// Controller"). USB interfaces expose that string two levels up in sysfs.
+std::string usbProductName(const std::string& node) {
+    std::ifstream file("/sys/class/hidraw/" + node + "/device/../../product");
+    std::string product;
+    std::getline(file, product);
+    return trim(product);
+}
+
+} // namespace
+
+HidrawInputSource::HidrawInputSource()
+    : m_epoll(epoll_create1(EPOLL_CLOEXEC)),
+      m_wakeFd(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)),
+      m_running(false) {
+    TimingUtils::initialize();
+    if (m_epoll < 0 || m_wakeFd < 0) {
+        Logger::error("hidraw: epoll/eventfd setup failed: " + std::string(std::strerror(errno)));
+        return;
+    }
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.u64 = WAKE_TOKEN;
+    epoll_ctl(m_epoll, EPOLL_CTL_ADD, m_wakeFd, &event);
+}
+
+HidrawInputSource::~HidrawInputSource() {
+    stop();
+    for (auto& device : m_devices) {
+        closeDevice(*device);
+    }
+    if (m_wakeFd >= 0) close(m_wakeFd);
+    if (m_epoll >= 0) close(m_epoll);
+}
+
+uint64_t HidrawInputSource::nowUs() {
+    return static_cast<uint64_t>(TimingUtils::counterToMicroseconds(TimingUtils::getPerformanceCounter()));
+}
+
+bool HidrawInputSource::readDescriptor(int fd, std::vector<uint8_t>& descriptor) {
+    int size = 0;
+    if (ioctl(fd, HIDIOCGRDESCSIZE, &size) < 0 || size <= 0 || size > HID_MAX_DESCRIPTOR_SIZE) {
+        return false;
+    }
+    hidraw_report_descriptor raw{};
+    raw.size = static_cast<uint32_t>(size);
+    if (ioctl(fd, HIDIOCGRDESC, &raw) < 0) {
+        return false;
+    }
+    descriptor.assign(raw.value, raw.value + raw.size);
+    return true;
+}
+
+size_t HidrawInputSource::scan(const std::string& directory) {
+    std::vector<std::string> nodes;
+    if (DIR* dir = opendir(directory.c_str())) {
+        while (dirent* entry = readdir(dir)) {
+            if (std::strncmp(entry->d_name, "hidraw", 6) == 0) {
+                nodes.push_back(directory + "/" + entry->d_name);
+            }
+        }
+        closedir(dir);
+    }
+    std::sort(nodes.begin(), nodes.end());
+
+    size_t added = 0;
+    for (const auto& path : nodes) {
+        bool known = false;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (const auto& device : m_devices) {
+                known = known || (device->fd >= 0 && device->path == path);
+            }
+        }
+        if (!known && openDevice(path)) {
+            added++;
+        }
+    }
+    return added;
+}
+
+bool HidrawInputSource::openDevice(const std::string& path) {
+    int fd = open(path.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) {
+        Logger::error("hidraw: cannot open " + path + ": " + std::strerror(errno));
+        return false;
+    }
+
+    std::vector<uint8_t> descriptor;
+    hidraw_devinfo info{};
+    char name[256] = {};
+    char phys[256] = {};
+    if (!readDescriptor(fd, descriptor) || ioctl(fd, HIDIOCGRAWINFO, &info) < 0 ||
+        ioctl(fd, HIDIOCGRAWNAME(sizeof(name) - 1), name) < 0) {
+        Logger::error("hidraw: cannot query " + path + ": " + std::strerror(errno));
+        close(fd);
+        return false;
+    }
+    ioctl(fd, HIDIOCGRAWPHYS(sizeof(phys) - 1), phys);
+
+    std::string node = path.substr(path.find_last_of('/') + 1);
+    std::string product = usbProductName(node);
+    return addDevice(fd, descriptor, product.empty() ? trim(name) : product,
+                     static_cast<uint16_t>(info.vendor), static_cast<uint16_t>(info.product), path, trim(phys));
+}
+
+bool HidrawInputSource::addStream(int fd, const std::vector<uint8_t>& descriptor, const std::string& name,
+                                  uint16_t vendorId, uint16_t productId, const std::string& path) {
+    int flags = fcntl(fd, F_GETFL);
+    if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0) {
+        close(fd);
+        return false;
+    }
+    return addDevice(fd, descriptor, name, vendorId, productId, path, path);
+}
+
+bool HidrawInputSource::addDevice(int fd, const std::vector<uint8_t>& descriptor, const std::string& name,
+                                  uint16_t vendorId, uint16_t productId, const std::string& path,
+                                  const std::string& instanceId) {
+    auto device = std::make_unique<Device>();
+    device->fd = fd;
+    device->path = path;
+    if (!device->descriptor.parse(descriptor.data(), descriptor.size())) {
+        Logger::error("hidraw: bad report descriptor on " + path + ": " + device->descriptor.getError());
+        close(fd);
+        return false;
+    }
+
+    ControllerState& state = device->state;
+    state = ControllerState{};
+    state.userId = -1;
+    state.hidHandle = nullptr;
+    state.devicePath = widen(path);
+    state.deviceInstanceId = widen(instanceId);
+    state.productName = widen(name);
+    state.vendorId = vendorId;
+    state.productId = productId;
+    state.isConnected = true;
+    state.caps = device->descriptor.buildCaps();
+    state.valueCaps = device->descriptor.buildValueCaps();
+    state.motionPlan = MotionReportPlan::forDevice(vendorId, productId);
+    device->lastReportUs = 0;
+    device->reports = 0;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    // A node that comes back takes over its closed entry (and epoll token) instead of adding another
+    size_t index = m_devices.size();
+    for (size_t i = 0; i < m_devices.size(); ++i) {
+        if (m_devices[i]->fd < 0 && m_devices[i]->path == path) {
+            index = i;
+            break;
+        }
+    }
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.u64 = index + 1;
+    if (epoll_ctl(m_epoll, EPOLL_CTL_ADD, fd, &event) < 0) {
+        Logger::error("hidraw: epoll_ctl failed for " + path + ": " + std::strerror(errno));
+        close(fd);
+        return false;
+    }
+    Logger::log("hidraw: " + name + " (" + path + "), " + std::to_string(state.valueCaps.size()) + " values, " +
+                std::to_string(device->descriptor.getButtonFields().size()) + " buttons");
+    if (index < m_devices.size()) {
+        m_devices[index] = std::move(device);
+    } else {
+        m_devices.push_back(std::move(device));
+    }
+    return true;
+}
+
+size_t HidrawInputSource::poll(int timeoutMs) {
+    epoll_event events[MAX_EVENTS];
+    int ready;
+    do {
+        ready = epoll_wait(m_epoll, events, MAX_EVENTS, timeoutMs);
+    } while (ready < 0 && errno == EINTR);
+    if (ready <= 0) {
+        return 0;
+    }
+
+    size_t reports = 0;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (int i = 0; i < ready; ++i) {
+        uint64_t token = events[i].data.u64;
+        if (token == WAKE_TOKEN) {
+            uint64_t count;
+            while (read(m_wakeFd, &count, sizeof(count)) > 0) {}
+            continue;
+        }
+        if (token - 1 < m_devices.size() && m_devices[token - 1]->fd >= 0) {
+            reports += drain(*m_devices[token - 1]);
+        }
+    }
+    return reports;
+}
+
+size_t HidrawInputSource::drain(Device& device) {
+    ControllerState& state = device.state;
+    size_t reports = 0;
+    while (true) {
+        ssize_t length = read(device.fd, state.inputBuffer, sizeof(state.inputBuffer));
+        if (length > 0) {
+            state.timestamp = TimingUtils::getPerformanceCounter();
+            if (device.descriptor.decode(state.inputBuffer, static_cast<size_t>(length), state)) {
+                device.lastReportUs = static_cast<uint64_t>(TimingUtils::counterToMicroseconds(state.timestamp));
+                device.reports++;
+                reports++;
+            }
+            continue;
+        }
+        if (length < 0 && errno == EINTR) {
+            continue;
+        }
+        if (length < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        }
+        // EOF (stream closed) or ENODEV (device unplugged)
+        state.lastError = length < 0 ? static_cast<DWORD>(errno) : 0;
+        Logger::log("hidraw: " + device.path + " disconnected");
+        closeDevice(device);
+        break;
+    }
+    return reports;
+}
+
+void HidrawInputSource::closeDevice(Device& device) {
+    if (device.fd < 0) {
+        return;
+    }
+    epoll_ctl(m_epoll, EPOLL_CTL_DEL, device.fd, nullptr);
+    close(device.fd);
+    device.fd = -1;
+    device.state.isConnected = false;
+    device.state.m_activeButtons.clear();
+    device.state.m_hidValues.clear();
+}
+
+void HidrawInputSource::wake() {
+    uint64_t one = 1;
+    ssize_t written = write(m_wakeFd, &one, sizeof(one));
+    (void)written;
+}
+
+void HidrawInputSource::start() {
+    if (m_running.exchange(true)) {
+        return;
+    }
+    m_thread = std::thread([this]() {
+        while (m_running) {
+            poll(-1);
+        }
+    });
+}
+
+void HidrawInputSource::stop() {
+    if (!m_running.exchange(false)) {
+        return;
+    }
+    wake();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+void HidrawInputSource::update(double deltaTime) {
+    (void)deltaTime;
+    // With the capture thread running, reports are already read as they arrive
+    if (!m_running) {
+        poll(0);
+    }
+}
+
+std::vector<ControllerState> HidrawInputSource::getInputStates() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<ControllerState> states;
+    states.reserve(m_devices.size());
+    for (const auto& device : m_devices) {
+        if (device->fd < 0) {
+            // Publish the disconnect once so the pad is released, then leave the entry out
+            if (device->disconnectReported) {
+                continue;
+            }
+            device->disconnectReported = true;
+        }
+        states.push_back(device->state);
+    }
+    return states;
+}
+
+size_t HidrawInputSource::getDeviceCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_devices.size();
+}
+
+uint64_t HidrawInputSource::lastReportUs(size_t device) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return device < m_devices.size() ? m_devices[device]->lastReportUs : 0;
+}
+
+uint64_t HidrawInputSource::getReportCount(size_t device) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return device < m_devices.size() ? m_devices[device]->reports : 0;
+}
+
+#endif // __linux__
@@ -1,4 +1,5 @@
 #include "core/input_capture.hpp"
+#include "core/source_arbiter.hpp"
 #include "utils/timing.hpp"
 
 #include <thread>
@@ -16,6 +17,13 @@
 InputCapture::InputCapture() 
     : m_running(false), 
       m_lastPollTime(0),
+      m_pollingGroupsEnabled(false),
+      m_phaseAlignedEnabled(false),
+      m_slotScheduler(
+          [](DWORD userIndex, XINPUT_STATE* state) { return XInputGetState(userIndex, state); },
+          []() { return static_cast<uint64_t>(TimingUtils::counterToMicroseconds(TimingUtils::getPerformanceCounter())); }),
+      m_sourceArbitrationEnabled(false),
+      m_sourceArbiter(std::make_unique<SourceArbiter>()),
       m_loggingEnabled(false),
       m_logFilePath("controller_input_log.csv"),
       m_logStartTime(0),
@@ -76,6 +84,12 @@ void InputCapture::shutdown() {
 }
 
 void InputCapture::update(double deltaTime) {
+    if (m_pollingGroupsEnabled) {
+        std::lock_guard<std::mutex> lock(m_statesMutex);
+        m_pollingScheduler.beginFrame(
+            static_cast<uint64_t>(TimingUtils::counterToMicroseconds(TimingUtils::getPerformanceCounter())));
+    }
+    
     pollXInputControllers();
     pollHIDControllers();
     
@@ -97,7 +111,88 @@ std::vector<ControllerState> InputCapture::getInputStates() const {
     return m_controllerStates;
 }
 
+void InputCapture::setPollingGroups(bool enabled, uint32_t baseRateHz, const std::vector<PollingRateOverride>& overrides) {
+    std::lock_guard<std::mutex> lock(m_statesMutex);
+    m_pollingGroupsEnabled = enabled;
+    m_pollingScheduler.setBaseRate(baseRateHz);
+    m_pollingScheduler.setOverrides(overrides);
+}
+
+uint64_t InputCapture::getNextPollDeadlineUs() const {
+    std::lock_guard<std::mutex> lock(m_statesMutex);
+    return m_pollingScheduler.nextDeadlineUs();
+}
+
+PollingScheduler::DeviceTiming InputCapture::getPollingTiming(size_t index) const {
+    std::lock_guard<std::mutex> lock(m_statesMutex);
+    return m_pollingScheduler.getTiming(index);
+}
+
+PollingScheduler::GroupStats InputCapture::getPollingGroupStats(size_t rateClass) const {
+    std::lock_guard<std::mutex> lock(m_statesMutex);
+    return m_pollingScheduler.getGroupStats(rateClass);
+}
+
+void InputCapture::setPhaseAlignedSampling(bool enabled) {
+    std::lock_guard<std::mutex> lock(m_statesMutex);
+    m_phaseAlignedEnabled = enabled;
+}
+
+PhaseAlignedPacer::WakePlan InputCapture::planPhaseWake(uint64_t lastWakeUs, uint64_t regularWakeUs) const {
+    std::lock_guard<std::mutex> lock(m_statesMutex);
+    if (!m_phaseAlignedEnabled) {
+        return {regularWakeUs, regularWakeUs, -1};
+    }
+    return m_phasePacer.plan(lastWakeUs, regularWakeUs);
+}
+
+void InputCapture::watchPhaseAnchor(const PhaseAlignedPacer::WakePlan& plan) {
+    if (plan.anchor < 0) {
+        return;
+    }
+    size_t index = static_cast<size_t>(plan.anchor);
+    
+    // Spin on the anchor alone until its report lands; the regular update()
+    // that follows picks up everything else
+    while (true) {
+        {
+            std::lock_guard<std::mutex> lock(m_statesMutex);
+            if (index >= m_controllerStates.size()) {
+                return;
+            }
+            ControllerState& state = m_controllerStates[index];
+            if (state.userId >= 0 || state.hidHandle == INVALID_HANDLE_VALUE || state.hidHandle == nullptr) {
+                return;
+            }
+            bool newReport = pollHIDDevice(index);
+            recordPhaseSample(index, newReport);
+            if (newReport || !state.isConnected) {
+                return;
+            }
+        }
+        uint64_t nowUs = static_cast<uint64_t>(TimingUtils::counterToMicroseconds(TimingUtils::getPerformanceCounter()));
+        if (nowUs >= plan.watchUntilUs) {
+            return;
+        }
+        std::this_thread::yield();
+    }
+}
+
+ReportPhaseEstimator InputCapture::getPhaseEstimate(size_t index) const {
+    std::lock_guard<std::mutex> lock(m_statesMutex);
+    const ReportPhaseEstimator* estimator = m_phasePacer.estimator(index);
+    return estimator ? *estimator : ReportPhaseEstimator{};
+}
+
+int InputCapture::getPhaseAnchor() const {
+    std::lock_guard<std::mutex> lock(m_statesMutex);
+    return m_phasePacer.anchor();
+}
+
 void InputCapture::refreshDevices() {
+    // A refresh usually follows a hot-plug, so look at empty XInput slots right away
+    m_slotScheduler.requestProbe();
+    
     // Refresh HID device list
     initializeHID();
 }
@@ -315,6 +410,14 @@ bool InputCapture::initializeHID() {
                                 state.devicePath = devicePath;
                                 state.isConnected = true; // MARK CONNECTED ONLY WHEN MATCHED
                                 
+                                // With arbitration the HID collection stays open as a second input path
+                                if (m_sourceArbitrationEnabled && openArbitrationReader(state)) {
+                                    m_sourceArbiter->reset(state.userId);
+                                    Logger::log("InputCapture: Reading User " + std::to_string(state.userId) + " through both XInput and HID");
+                                    found = true;
+                                    break;
+                                }
+                                
                                 // Also try to get the product name for this XInput device
                                 HANDLE h = CreateFileW(devicePath.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, 0, nullptr);
                                 if (h != INVALID_HANDLE_VALUE) {
@@ -327,6 +430,9 @@ bool InputCapture::initializeHID() {
                                 
                                 Logger::log("InputCapture: Matched XInput device to User " + std::to_string(state.userId) + ": " + Logger::wstringToNarrow(state.productName));
                                 
+                                // The IG_ interface arrived: its XInput slot must not wait out a backoff
+                                m_slotScheduler.requestProbe();
+                                
                                 found = true;
                                 break;
                             }
@@ -407,6 +513,14 @@ bool InputCapture::initializeHID() {
                              HIDD_ATTRIBUTES attributes;
                              attributes.Size = sizeof(HIDD_ATTRIBUTES);
                              if (HidD_GetAttributes(deviceHandle, &attributes)) {
+                                 newState.vendorId = attributes.VendorID;
+                                 newState.productId = attributes.ProductID;
+                                 newState.versionNumber = attributes.VersionNumber;
+                                 newState.motionPlan = MotionReportPlan::forDevice(attributes.VendorID, attributes.ProductID);
+                                 if (newState.motionPlan.hasMotion()) {
+                                     Logger::log("InputCapture: Motion sensors available for " + Logger::wstringToNarrow(newState.productName));
+                                 }
+                                 
                                  std::stringstream ss;
                                  ss << "InputCapture: HID Attributes - VendorID: 0x" << std::hex << attributes.VendorID 
                                     << ", ProductID: 0x" << attributes.ProductID 
@@ -482,8 +596,13 @@ bool InputCapture::initializeHID() {
 
 void InputCapture::pollXInputControllers() {
     for (size_t i = 0; i < XUSER_MAX_COUNT; ++i) {
-        XINPUT_STATE state;
-        DWORD result = XInputGetState(static_cast<DWORD>(i), &state);
+        // Slots in a slower polling group are left alone until their deadline
+        if (m_pollingGroupsEnabled && !m_pollingScheduler.isDue(i)) {
+            continue;
+        }
+        
+        XINPUT_STATE state{};
+        DWORD result = m_slotScheduler.poll(static_cast<DWORD>(i), &state);
         
         {
             std::lock_guard<std::mutex> lock(m_statesMutex);
@@ -499,8 +618,18 @@ void InputCapture::pollXInputControllers() {
                         firstPollLogged[i] = true;
                     }
                     
+                    // A new packet is a distinct update from the XInput path
+                    bool newPacket = result == ERROR_SUCCESS && state.dwPacketNumber != m_controllerStates[i].xinputPacketNumber;
+                    bool arbitrated = m_controllerStates[i].hidHandle != nullptr && m_controllerStates[i].hidHandle != INVALID_HANDLE_VALUE;
+                    if (arbitrated && newPacket) {
+                        m_sourceArbiter->submit(static_cast<int>(i), CaptureSource::XINPUT, state.Gamepad, TimingUtils::getPerformanceCounter());
+                    }
+                    
                     m_controllerStates[i].xinputState = state;
                     m_controllerStates[i].xinputPacketNumber = state.dwPacketNumber;
+                    if (arbitrated) {
+                        m_controllerStates[i].xinputState.Gamepad = m_sourceArbiter->current(static_cast<int>(i));
+                    }
                     
                     // Mark as connected only if XInput poll succeeds AND device is matched
                     if (result == ERROR_SUCCESS) {
@@ -508,12 +637,18 @@ void InputCapture::pollXInputControllers() {
                     } else {
                         m_controllerStates[i].isConnected = false;
                         m_controllerStates[i].deviceInstanceId = L""; // Clear so it can be re-matched
+                        if (arbitrated) {
+                            closeArbitrationReader(m_controllerStates[i]);
+                            m_sourceArbiter->reset(static_cast<int>(i));
+                        }
                     }
                     m_controllerStates[i].lastError = result;
+                    recordPollingService(i, newPacket);
                 } else {
                     // No HID device matched to this XInput slot - mark as disconnected
                     m_controllerStates[i].isConnected = false;
                     m_controllerStates[i].lastError = ERROR_DEVICE_NOT_CONNECTED;
+                    recordPollingService(i, false);
                 }
                 
                 m_controllerStates[i].timestamp = TimingUtils::getPerformanceCounter();
@@ -522,71 +657,191 @@ void InputCapture::pollXInputControllers() {
     }
 }
 
+bool InputCapture::openArbitrationReader(ControllerState& state) {
+    HANDLE handle = CreateFileW(state.devicePath.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE,
+                                nullptr, OPEN_EXISTING, FILE_FLAG_OVERLAPPED, nullptr);
+    if (handle == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    
+    PHIDP_PREPARSED_DATA preparsedData;
+    if (!HidD_GetPreparsedData(handle, &preparsedData)) {
+        CloseHandle(handle);
+        return false;
+    }
+    
+    wchar_t productBuffer[128];
+    if (HidD_GetProductString(handle, productBuffer, sizeof(productBuffer))) {
+        state.productName = productBuffer;
+    }
+    
+    state.hidHandle = handle;
+    state.preparsedData = preparsedData;
+    HidP_GetCaps(preparsedData, &state.caps);
+    
+    USHORT capsLength = state.caps.NumberInputButtonCaps;
+    state.buttonCaps.resize(capsLength);
+    if (capsLength > 0) {
+        HidP_GetButtonCaps(HidP_Input, state.buttonCaps.data(), &capsLength, preparsedData);
+    }
+    capsLength = state.caps.NumberInputValueCaps;
+    state.valueCaps.resize(capsLength);
+    if (capsLength > 0) {
+        HidP_GetValueCaps(HidP_Input, state.valueCaps.data(), &capsLength, preparsedData);
+    }
+    
+    memset(&state.overlapped, 0, sizeof(OVERLAPPED));
+    state.overlapped.hEvent = CreateEvent(nullptr, TRUE, FALSE, nullptr);
+    state.isReadPending = false;
+    return true;
+}
+
+void InputCapture::closeArbitrationReader(ControllerState& state) {
+    if (state.isReadPending) {
+        CancelIo(state.hidHandle);
+        state.isReadPending = false;
+    }
+    if (state.overlapped.hEvent) {
+        CloseHandle(state.overlapped.hEvent);
+        state.overlapped.hEvent = nullptr;
+    }
+    CloseHandle(state.hidHandle);
+    state.hidHandle = nullptr;
+    if (state.preparsedData) {
+        HidD_FreePreparsedData(state.preparsedData);
+        state.preparsedData = nullptr;
+    }
+    state.m_activeButtons.clear();
+    state.m_hidValues.clear();
+}
+
 void InputCapture::pollHIDControllers() {
     std::lock_guard<std::mutex> lock(m_statesMutex);
     
-    for (auto& state : m_controllerStates) {
-        if (state.hidHandle != INVALID_HANDLE_VALUE && state.hidHandle != nullptr && state.userId < 0) { // Only poll HID, not pure XInput
+    for (size_t index = 0; index < m_controllerStates.size(); ++index) {
+        auto& state = m_controllerStates[index];
+        if (m_pollingGroupsEnabled && !m_pollingScheduler.isDue(index)) {
+            continue;
+        }
+        
+        if (state.hidHandle != INVALID_HANDLE_VALUE && state.hidHandle != nullptr &&
+            (state.userId < 0 || m_sourceArbitrationEnabled)) { // XInput slots only carry a handle when arbitrated
+            bool newReport = pollHIDDevice(index);
             
-            // If no read is pending, start one
-            if (!state.isReadPending) {
-                // Reset event
-                ResetEvent(state.overlapped.hEvent);
-                
-                DWORD bytesRead = 0;
-                BOOL success = ReadFile(state.hidHandle, state.inputBuffer, sizeof(state.inputBuffer), &bytesRead, &state.overlapped);
-                
-                if (success) {
-                    // Immediate success (cached data?)
-                    state.isConnected = true;
-                    state.timestamp = TimingUtils::getPerformanceCounter();
-                    parseHIDReport(state, reinterpret_cast<PCHAR>(state.inputBuffer), bytesRead);
-                } else {
-                    DWORD error = GetLastError();
-                    if (error == ERROR_IO_PENDING) {
-                        state.isReadPending = true;
-                    } else {
-                        // Read failed
-                        // Check availability or ignore
-                        if (error == ERROR_DEVICE_NOT_CONNECTED) {
-                             state.isConnected = false;
-                             state.lastError = error;
-                        }
-                    }
-                }
+            // Arbitrated XInput slots are accounted for by the XInput path
+            if (state.userId < 0) {
+                recordPollingService(index, newReport);
+                recordPhaseSample(index, newReport);
+            }
+        }
+    }
+}
+
+bool InputCapture::pollHIDDevice(size_t index) {
+    ControllerState& state = m_controllerStates[index];
+    bool newReport = false;
+    
+    // If no read is pending, start one
+    if (!state.isReadPending) {
+        // Reset event
+        ResetEvent(state.overlapped.hEvent);
+        
+        DWORD bytesRead = 0;
+        BOOL success = ReadFile(state.hidHandle, state.inputBuffer, sizeof(state.inputBuffer), &bytesRead, &state.overlapped);
+        
+        if (success) {
+            // Immediate success (cached data?)
+            state.isConnected = true;
+            state.timestamp = TimingUtils::getPerformanceCounter();
+            parseHIDReport(state, reinterpret_cast<PCHAR>(state.inputBuffer), bytesRead);
+            newReport = true;
+            if (state.userId >= 0) {
+                m_sourceArbiter->submit(state.userId, CaptureSource::HID, SourceArbiter::fromXboxHID(state), state.timestamp);
+                state.xinputState.Gamepad = m_sourceArbiter->current(state.userId);
+            }
+        } else {
+            DWORD error = GetLastError();
+            if (error == ERROR_IO_PENDING) {
+                state.isReadPending = true;
             } else {
-                // Read IS pending, check if it completed
-                DWORD bytesTransferred = 0;
-                if (GetOverlappedResult(state.hidHandle, &state.overlapped, &bytesTransferred, FALSE)) {
-                    // Completed!
-                    state.isReadPending = false;
-                    state.isConnected = true;
-                    state.timestamp = TimingUtils::getPerformanceCounter();
-                    
-                    if (bytesTransferred > 0) {
-                        parseHIDReport(state, reinterpret_cast<PCHAR>(state.inputBuffer), bytesTransferred);
-                    }
-                } else {
-                    // Not done or error
-                    DWORD error = GetLastError();
-                    if (error == ERROR_IO_INCOMPLETE) {
-                        // Still pending - this is normal, continue waiting
-                        // Don't mark as disconnected
-                    } else if (error == ERROR_DEVICE_NOT_CONNECTED || error == ERROR_BAD_COMMAND) {
-                        // Device actually disconnected
-                        state.isReadPending = false;
-                        state.isConnected = false;
-                        state.lastError = error;
-                    } else {
-                        // Other transient error - retry on next poll
-                        state.isReadPending = false;
-                        // Don't mark as disconnected for transient errors
-                        state.lastError = error;
-                    }
+                // Read failed
+                // Check availability or ignore
+                if (error == ERROR_DEVICE_NOT_CONNECTED) {
+                     state.isConnected = false;
+                     state.lastError = error;
                 }
             }
         }
+    } else {
+        // Read IS pending, check if it completed
+        DWORD bytesTransferred = 0;
+        if (GetOverlappedResult(state.hidHandle, &state.overlapped, &bytesTransferred, FALSE)) {
+            // Completed!
+            state.isReadPending = false;
+            state.isConnected = true;
+            state.timestamp = TimingUtils::getPerformanceCounter();
+            
+            if (bytesTransferred > 0) {
+                parseHIDReport(state, reinterpret_cast<PCHAR>(state.inputBuffer), bytesTransferred);
+                newReport = true;
+                if (state.userId >= 0) {
+                    m_sourceArbiter->submit(state.userId, CaptureSource::HID, SourceArbiter::fromXboxHID(state), state.timestamp);
+                    state.xinputState.Gamepad = m_sourceArbiter->current(state.userId);
+                }
+            }
+        } else {
+            // Not done or error
+            DWORD error = GetLastError();
+            if (error == ERROR_IO_INCOMPLETE) {
+                // Still pending - this is normal, continue waiting
+                // Don't mark as disconnected
+            } else if (error == ERROR_DEVICE_NOT_CONNECTED || error == ERROR_BAD_COMMAND) {
+                // Device actually disconnected
+                state.isReadPending = false;
+                state.isConnected = false;
+                state.lastError = error;
+            } else {
+                // Other transient error - retry on next poll
+                state.isReadPending = false;
+                // Don't mark as disconnected for transient errors
+                state.lastError = error;
+            }
+        }
     }
+    
+    return newReport;
+}
+
+void InputCapture::recordPollingService(size_t index, bool newReport) {
+    if (!m_pollingGroupsEnabled) {
+        return;
+    }
+    const ControllerState& state = m_controllerStates[index];
+    m_pollingScheduler.assignDevice(index, state.productName, state.deviceInstanceId);
+    m_pollingScheduler.setActive(index, state.isConnected);
+    m_pollingScheduler.recordService(index, newReport,
+        static_cast<uint64_t>(TimingUtils::counterToMicroseconds(TimingUtils::getPerformanceCounter())));
+}
+
+void InputCapture::recordPhaseSample(size_t index, bool newReport) {
+    if (!m_phaseAlignedEnabled) {
+        return;
+    }
+    if (index >= m_phaseLastLookUs.size()) {
+        m_phaseLastLookUs.resize(index + 1, 0);
+    }
+    if (!m_controllerStates[index].isConnected) {
+        m_phasePacer.reset(index);
+        m_phaseLastLookUs[index] = 0;
+        return;
+    }
+    
+    // The report arrived somewhere between the previous read and this one
+    uint64_t nowUs = static_cast<uint64_t>(TimingUtils::counterToMicroseconds(TimingUtils::getPerformanceCounter()));
+    if (newReport) {
+        m_phasePacer.onReport(index, nowUs, m_phaseLastLookUs[index] ? m_phaseLastLookUs[index] : nowUs);
+    }
+    m_phaseLastLookUs[index] = nowUs;
 }
 
 void InputCapture::parseHIDReport(ControllerState& state, PCHAR report, ULONG reportLength) {
@@ -599,6 +854,11 @@ void InputCapture::parseHIDReport(ControllerState& state, PCHAR report, ULONG re
 
     // Parse Values (Axes)
     getHIDValues(state, report, reportLength);
+
+    // Motion sensors live in vendor-defined bytes the value caps don't describe
+    if (state.motionPlan.hasMotion()) {
+        extractMotion(state.motionPlan, reinterpret_cast<const uint8_t*>(report), reportLength, state.motion);
+    }
 }
 
 void InputCapture::getHIDUsages(ControllerState& state, PCHAR report, ULONG reportLength) {
@@ -0,0 +1,265 @@
+#include "core/input_merger.hpp"
+#include "utils/string_utils.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+
+namespace {
+    inline uint64_t packFields(const TranslatedState::GamepadState& g) {
+        return static_cast<uint64_t>(g.wButtons) |
+               (static_cast<uint64_t>(g.bLeftTrigger) << 16) |
+               (static_cast<uint64_t>(g.bRightTrigger) << 24) |
+               (static_cast<uint64_t>(static_cast<uint16_t>(g.sThumbLX)) << 32) |
+               (static_cast<uint64_t>(static_cast<uint16_t>(g.sThumbLY)) << 48);
+    }
+
+    inline uint64_t packFieldsExt(const TranslatedState& s) {
+        return static_cast<uint64_t>(static_cast<uint16_t>(s.gamepad.sThumbRX)) |
+               (static_cast<uint64_t>(static_cast<uint16_t>(s.gamepad.sThumbRY)) << 16) |
+               (static_cast<uint64_t>(s.targetType & 0xFF) << 32) |
+               (1ULL << 40); // present
+    }
+
+    // Pick the value with the largest magnitude, keeping its sign
+    inline int32_t largerDeflection(int32_t a, int32_t b) {
+        return (std::abs(b) > std::abs(a)) ? b : a;
+    }
+
+}
+
+InputMerger::InputMerger()
+    : m_groupCount(0) {
+}
+
+void InputMerger::configure(const std::vector<MergeGroupConfig>& groups) {
+    m_groupCount = std::min(groups.size(), MAX_GROUPS);
+    for (size_t g = 0; g < m_groupCount; ++g) {
+        Group& group = m_groups[g];
+        group.config = groups[g];
+        group.sourceCount = std::min(group.config.sourceMatches.size(), MAX_SOURCES_PER_GROUP);
+        group.policy[F_BUTTONS] = group.config.buttons;
+        group.policy[F_LT] = group.policy[F_RT] = group.config.triggers;
+        group.policy[F_LX] = group.policy[F_LY] = group.policy[F_RX] = group.policy[F_RY] = group.config.sticks;
+        for (size_t s = 0; s < MAX_SOURCES_PER_GROUP; ++s) {
+            clearSource(static_cast<int>(g), static_cast<int>(s));
+            group.history[s] = SourceHistory{};
+        }
+    }
+    m_slotMembership.clear();
+}
+
+int InputMerger::findGroup(const ControllerState& state, int* sourceIndex) const {
+    for (size_t g = 0; g < m_groupCount; ++g) {
+        const Group& group = m_groups[g];
+        for (size_t s = 0; s < group.sourceCount; ++s) {
+            const std::wstring& match = group.config.sourceMatches[s];
+            if (StringUtils::containsCaseInsensitive(state.productName, match) ||
+                StringUtils::containsCaseInsensitive(state.deviceInstanceId, match)) {
+                if (sourceIndex) *sourceIndex = static_cast<int>(s);
+                return static_cast<int>(g);
+            }
+        }
+    }
+    return -1;
+}
+
+int InputMerger::groupForSlot(size_t slot, const ControllerState& state, int* sourceIndex) {
+    if (slot >= m_slotMembership.size()) {
+        m_slotMembership.resize(slot + 1);
+    }
+    // Match the config patterns only when a different device shows up in the slot
+    SlotMembership& membership = m_slotMembership[slot];
+    if (!membership.resolved || membership.instanceId != state.deviceInstanceId) {
+        membership.resolved = true;
+        membership.instanceId = state.deviceInstanceId;
+        membership.group = findGroup(state, &membership.source);
+    }
+    *sourceIndex = membership.source;
+    return membership.group;
+}
+
+void InputMerger::publish(int group, int source, const TranslatedState& state) {
+    SourceSlot& slot = m_groups[group].slots[source];
+
+    // Seqlock write: odd sequence while the frame is being replaced
+    uint32_t seq = slot.sequence.load(std::memory_order_relaxed);
+    slot.sequence.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot.fields.store(packFields(state.gamepad), std::memory_order_relaxed);
+    slot.fieldsExt.store(packFieldsExt(state), std::memory_order_relaxed);
+    slot.timestamp.store(state.timestamp, std::memory_order_relaxed);
+
+    slot.sequence.store(seq + 2, std::memory_order_release);
+}
+
+void InputMerger::clearSource(int group, int source) {
+    SourceSlot& slot = m_groups[group].slots[source];
+    uint32_t seq = slot.sequence.load(std::memory_order_relaxed);
+    slot.sequence.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.fields.store(0, std::memory_order_relaxed);
+    slot.fieldsExt.store(0, std::memory_order_relaxed);
+    slot.timestamp.store(0, std::memory_order_relaxed);
+    slot.sequence.store(seq + 2, std::memory_order_release);
+}
+
+bool InputMerger::readSlot(const SourceSlot& slot, Frame& frame) const {
+    uint64_t fields, fieldsExt, timestamp;
+    uint32_t before, after;
+    do {
+        before = slot.sequence.load(std::memory_order_acquire);
+        if (before & 1) {
+            continue; // Writer in progress
+        }
+        fields = slot.fields.load(std::memory_order_relaxed);
+        fieldsExt = slot.fieldsExt.load(std::memory_order_relaxed);
+        timestamp = slot.timestamp.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        after = slot.sequence.load(std::memory_order_relaxed);
+    } while ((before & 1) || before != after);
+
+    frame.present = (fieldsExt >> 40) & 1;
+    frame.targetType = static_cast<int>((fieldsExt >> 32) & 0xFF);
+    frame.timestamp = timestamp;
+    frame.values[F_BUTTONS] = static_cast<int32_t>(fields & 0xFFFF);
+    frame.values[F_LT] = static_cast<int32_t>((fields >> 16) & 0xFF);
+    frame.values[F_RT] = static_cast<int32_t>((fields >> 24) & 0xFF);
+    frame.values[F_LX] = static_cast<int16_t>((fields >> 32) & 0xFFFF);
+    frame.values[F_LY] = static_cast<int16_t>((fields >> 48) & 0xFFFF);
+    frame.values[F_RX] = static_cast<int16_t>(fieldsExt & 0xFFFF);
+    frame.values[F_RY] = static_cast<int16_t>((fieldsExt >> 16) & 0xFFFF);
+    return frame.present;
+}
+
+bool InputMerger::compose(int group, TranslatedState& merged) {
+    Group& g = m_groups[group];
+
+    std::array<int32_t, FIELD_COUNT> result{};
+    std::array<uint64_t, FIELD_COUNT> newestChange{};
+    std::array<bool, FIELD_COUNT> decided{};
+    bool anyPresent = false;
+    int targetType = TranslatedState::TARGET_XINPUT;
+    uint64_t newestTimestamp = 0;
+
+    for (size_t s = 0; s < g.sourceCount; ++s) {
+        Frame frame;
+        if (!readSlot(g.slots[s], frame)) {
+            continue;
+        }
+
+        // Highest-priority present source decides the target type
+        if (!anyPresent) {
+            targetType = frame.targetType;
+        }
+        anyPresent = true;
+        newestTimestamp = std::max(newestTimestamp, frame.timestamp);
+
+        SourceHistory& history = g.history[s];
+        for (int f = 0; f < FIELD_COUNT; ++f) {
+            int32_t value = frame.values[f];
+            if (value != history.lastValue[f]) {
+                history.lastValue[f] = value;
+                history.lastChange[f] = frame.timestamp;
+            }
+
+            switch (g.policy[f]) {
+                case MergePolicy::OR:
+                case MergePolicy::MAX:
+                    if (f == F_BUTTONS) {
+                        result[f] |= value;
+                    } else if (f >= F_LX) {
+                        result[f] = largerDeflection(result[f], value);
+                    } else {
+                        result[f] = std::max(result[f], value);
+                    }
+                    break;
+                case MergePolicy::LAST_CHANGED:
+                    // Ties go to the higher-priority source (earlier in the list)
+                    if (!decided[f] || history.lastChange[f] > newestChange[f]) {
+                        result[f] = value;
+                        newestChange[f] = history.lastChange[f];
+                        decided[f] = true;
+                    }
+                    break;
+                case MergePolicy::PRIORITY:
+                    if (!decided[f] && value != 0) {
+                        result[f] = value;
+                        decided[f] = true;
+                    }
+                    break;
+            }
+        }
+    }
+
+    if (!anyPresent) {
+        return false;
+    }
+
+    merged = TranslatedState{};
+    merged.sourceUserId = virtualUserId(group);
+    merged.sourceSlot = -1;
+    merged.isXInputSource = false;
+    merged.timestamp = newestTimestamp;
+    merged.targetType = static_cast<TranslatedState::TargetType>(targetType);
+    merged.gamepad.wButtons = static_cast<WORD>(result[F_BUTTONS]);
+    merged.gamepad.bLeftTrigger = static_cast<BYTE>(result[F_LT]);
+    merged.gamepad.bRightTrigger = static_cast<BYTE>(result[F_RT]);
+    merged.gamepad.sThumbLX = static_cast<SHORT>(result[F_LX]);
+    merged.gamepad.sThumbLY = static_cast<SHORT>(result[F_LY]);
+    merged.gamepad.sThumbRX = static_cast<SHORT>(result[F_RX]);
+    merged.gamepad.sThumbRY = static_cast<SHORT>(result[F_RY]);
+    return true;
+}
+
+void InputMerger::apply(const std::vector<ControllerState>& inputStates, std::vector<TranslatedState>& translatedStates) {
+    if (m_groupCount == 0) {
+        return;
+    }
+
+    // Drop disconnected members so they stop holding buttons or axes
+    for (size_t i = 0; i < inputStates.size(); ++i) {
+        if (!inputStates[i].isConnected) {
+            int source = -1;
+            int group = groupForSlot(i, inputStates[i], &source);
+            if (group >= 0) {
+                clearSource(group, source);
+            }
+        }
+    }
+
+    // Publish member frames and remove them from the per-device output
+    auto newEnd = std::remove_if(translatedStates.begin(), translatedStates.end(),
+        [&](const TranslatedState& translated) {
+            if (translated.sourceSlot < 0 || static_cast<size_t>(translated.sourceSlot) >= inputStates.size()) {
+                return false;
+            }
+            int source = -1;
+            int group = groupForSlot(translated.sourceSlot, inputStates[translated.sourceSlot], &source);
+            if (group < 0) {
+                return false;
+            }
+            publish(group, source, translated);
+            return true;
+        });
+    translatedStates.erase(newEnd, translatedStates.end());
+
+    // One merged report per group per frame
+    for (size_t g = 0; g < m_groupCount; ++g) {
+        TranslatedState merged;
+        if (compose(static_cast<int>(g), merged)) {
+            translatedStates.push_back(merged);
+        }
+    }
+}
+
+MergePolicy InputMerger::parsePolicy(const std::string& name, MergePolicy defaultPolicy) {
+    std::string lower = name;
+    std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+    if (lower == "or") return MergePolicy::OR;
+    if (lower == "max") return MergePolicy::MAX;
+    if (lower == "last_changed" || lower == "last") return MergePolicy::LAST_CHANGED;
+    if (lower == "priority") return MergePolicy::PRIORITY;
+    return defaultPolicy;
+}
@@ -0,0 +1,236 @@
+#include "core/latency_rig.hpp"
+#include "core/synthetic_source.hpp"
+#include "core/pipeline.hpp"
+#include "core/report_phase.hpp"
+#include "utils/config_manager.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+namespace {
+
+double percentile(const std::vector<double>& sorted, double fraction) {
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    size_t index = static_cast<size_t>(fraction * static_cast<double>(sorted.size() - 1) + 0.5);
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+
+void sleepUntilUs(uint64_t targetUs) {
+    uint64_t now = SyntheticInputSource::nowUs();
+    if (targetUs > now) {
+        std::this_thread::sleep_for(std::chrono::microseconds(targetUs - now));
+    }
+}
+
+} // namespace
+
+LatencyRig::Result LatencyRig::run(const Scenario& scenario) {
+    SyntheticInputSource::Config sourceConfig;
+    sourceConfig.controllers = std::max<size_t>(1, scenario.controllers);
+    sourceConfig.reportRateHz = scenario.reportRateHz;
+    sourceConfig.reportsPerEdge = scenario.reportsPerEdge;
+    auto ownedSource = std::make_unique<SyntheticInputSource>(sourceConfig);
+    auto ownedBus = std::make_unique<EdgeProbeBus>(sourceConfig.controllers);
+    SyntheticInputSource& source = *ownedSource;
+    EdgeProbeBus& bus = *ownedBus;
+    const size_t controllers = sourceConfig.controllers;
+
+    // The proxy's own loop body; stick deadzones stay off so the sequence
+    // number in the right stick survives translation
+    auto config = std::make_unique<ConfigManager>();
+    config->setBool("auto_load_profiles", false);
+    config->setBool("stick_deadzone_enabled", false);
+    config->setBool("output_shaping_enabled", scenario.outputShaping);
+    config->setInt("output_max_rate_hz", 250);
+    config->setBool("inject_thread_enabled", scenario.threading == Threading::INJECT_THREAD);
+    config->setInt("polling_frequency", static_cast<int>(std::max<uint32_t>(1, scenario.loopHz)));
+    Pipeline pipeline(0, std::move(config), std::move(ownedSource), std::move(ownedBus));
+
+    // The rig paces the loop itself (Pipeline::run only sleeps a fixed interval)
+    // and calls runFrame; start() is only needed for the injection thread
+    PhaseAlignedPacer pacer;
+    std::vector<uint64_t> seenReportUs(controllers, 0);
+    uint64_t lastLookUs = SyntheticInputSource::nowUs();
+    auto notePhase = [&]() {
+        uint64_t now = SyntheticInputSource::nowUs();
+        if (scenario.pacing == Pacing::PHASE_ALIGNED) {
+            // Like InputCapture: a new report is only known to have arrived since the last look
+            for (size_t i = 0; i < controllers; ++i) {
+                uint64_t reportUs = source.lastReportUs(i);
+                if (reportUs != seenReportUs[i]) {
+                    seenReportUs[i] = reportUs;
+                    pacer.onReport(i, now, lastLookUs);
+                }
+            }
+        }
+        lastLookUs = now;
+    };
+
+    const uint64_t intervalUs = 1000000ull / std::max<uint32_t>(1, scenario.loopHz);
+    Result result;
+    result.scenario = scenario;
+
+    if (scenario.threading == Threading::INJECT_THREAD) {
+        pipeline.startInjection();
+    }
+    source.start();
+    const uint64_t startUs = SyntheticInputSource::nowUs();
+    const uint64_t generateUntilUs = startUs + static_cast<uint64_t>(scenario.durationMs) * 1000;
+    const uint64_t drainUntilUs = generateUntilUs + 20000;   // Let the last edges through
+    bool generating = true;
+
+    while (true) {
+        uint64_t frameUs = SyntheticInputSource::nowUs();
+        if (generating && frameUs >= generateUntilUs) {
+            source.stop();
+            generating = false;
+        }
+        if (frameUs >= drainUntilUs) {
+            break;
+        }
+
+        pipeline.runFrame(frameUs);
+        notePhase();
+
+        uint64_t regularWakeUs = frameUs + intervalUs;
+        switch (scenario.pacing) {
+            case Pacing::FIXED:
+                sleepUntilUs(regularWakeUs);
+                break;
+            case Pacing::SPIN:
+                while (SyntheticInputSource::nowUs() < regularWakeUs) {
+                    std::this_thread::yield();
+                }
+                break;
+            case Pacing::PHASE_ALIGNED: {
+                PhaseAlignedPacer::WakePlan plan = pacer.plan(frameUs, regularWakeUs);
+                sleepUntilUs(plan.wakeUs);
+                // Watch the anchor until its report lands, as InputCapture::watchPhaseAnchor does
+                if (plan.anchor >= 0) {
+                    size_t anchor = static_cast<size_t>(plan.anchor);
+                    uint64_t before = seenReportUs[anchor];
+                    while (SyntheticInputSource::nowUs() < plan.watchUntilUs) {
+                        source.update(0.0);
+                        notePhase();
+                        if (seenReportUs[anchor] != before) {
+                            break;
+                        }
+                        std::this_thread::yield();
+                    }
+                }
+                break;
+            }
+        }
+    }
+    pipeline.stop();
+    result.loopFrames = pipeline.getStats().frames;
+
+    std::vector<double> latencies;
+    bus.match(source.getEdges(), scenario.reportsPerEdge, result, latencies);
+    summarize(latencies, result);
+    return result;
+}
+
+void LatencyRig::summarize(std::vector<double>& latencies, Result& result) {
+    std::sort(latencies.begin(), latencies.end());
+    if (latencies.empty()) {
+        return;
+    }
+    double sum = 0.0;
+    for (double latency : latencies) sum += latency;
+    result.meanUs = sum / static_cast<double>(latencies.size());
+    result.p50Us = percentile(latencies, 0.50);
+    result.p90Us = percentile(latencies, 0.90);
+    result.p99Us = percentile(latencies, 0.99);
+    result.maxUs = latencies.back();
+}
+
+EdgeProbeBus::EdgeProbeBus(size_t targets)
+    : m_pressed(targets, false),
+      m_arrivals(targets) {
+}
+
+bool EdgeProbeBus::submit(int targetId, const TranslatedState& state) {
+    uint64_t now = SyntheticInputSource::nowUs();
+    (void)targetId;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    size_t target = static_cast<size_t>(state.sourceUserId);
+    if (state.sourceUserId < 0 || target >= m_arrivals.size()) {
+        return false;
+    }
+    bool pressed = (state.gamepad.wButtons & XINPUT_GAMEPAD_A) != 0;
+    if (pressed != m_pressed[target]) {
+        m_pressed[target] = pressed;
+        m_arrivals[target].push_back({SyntheticInputSource::sequenceOf(state.gamepad.sThumbRX), pressed, now});
+    }
+    return true;
+}
+
+bool EdgeProbeBus::replug(int targetId) {
+    (void)targetId;
+    return true;
+}
+
+std::vector<std::vector<EdgeProbeBus::Arrival>> EdgeProbeBus::arrivals() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_arrivals;
+}
+
+void EdgeProbeBus::match(const std::vector<SyntheticInputSource::Edge>& edges, uint32_t reportsPerEdge,
+                         LatencyRig::Result& result, std::vector<double>& latencies) const {
+    std::vector<std::vector<Arrival>> arrived = arrivals();
+    std::vector<size_t> nextArrival(arrived.size(), 0);
+    for (const auto& edge : edges) {
+        result.edges++;
+        if (edge.controller >= arrived.size()) {
+            continue;
+        }
+        size_t& k = nextArrival[edge.controller];
+        if (k >= arrived[edge.controller].size()) {
+            continue;
+        }
+        const Arrival& arrival = arrived[edge.controller][k++];
+        // The delivered report may be newer than the edge's report, but not past the next edge
+        uint16_t behind = static_cast<uint16_t>(arrival.sequence - edge.sequence);
+        result.delivered++;
+        if (arrival.pressed != edge.pressed || behind >= reportsPerEdge) {
+            // Paired with the wrong report: its arrival time says nothing about this edge
+            result.sequenceErrors++;
+            continue;
+        }
+        latencies.push_back(static_cast<double>(arrival.arrivedUs) - static_cast<double>(edge.generatedUs));
+    }
+}
+
+const char* LatencyRig::pacingName(Pacing pacing) {
+    switch (pacing) {
+        case Pacing::FIXED: return "fixed";
+        case Pacing::SPIN: return "spin";
+        case Pacing::PHASE_ALIGNED: return "phase";
+    }
+    return "unknown";
+}
+
+const char* LatencyRig::threadingName(Threading threading) {
+    switch (threading) {
+        case Threading::INLINE: return "inline";
+        case Threading::INJECT_THREAD: return "inject_thread";
+    }
+    return "unknown";
+}
+
+std::string LatencyRig::describe(const Scenario& scenario) {
+    std::ostringstream name;
+    name << pacingName(scenario.pacing) << "/" << threadingName(scenario.threading)
+         << "/" << scenario.controllers << "_controllers";
+    if (scenario.outputShaping) {
+        name << "/shaped";
+    }
+    return name.str();
+}
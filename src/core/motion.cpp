@@ -0,0 +1,159 @@
+#include "core/motion.hpp"
+
+#include <algorithm>
+
+namespace {
+    constexpr uint16_t VENDOR_SONY = 0x054C;
+    constexpr uint16_t PID_DS4_V1 = 0x05C4;
+    constexpr uint16_t PID_DS4_V2 = 0x09CC;
+    constexpr uint16_t PID_DS4_DONGLE = 0x0BA0;
+    constexpr uint16_t PID_DUALSENSE = 0x0CE6;
+    constexpr uint16_t PID_DUALSENSE_EDGE = 0x0DF2;
+
+    // DS4 USB report 0x01: sticks, buttons, triggers, 16-bit timestamp at 10,
+    // temperature at 12, gyro at 13, accel at 19
+    constexpr MotionReportLayout DS4_USB = {0x01, 13, 19, 10, 0, false, 25};
+    // DS4 Bluetooth report 0x11: same block shifted by two header bytes
+    constexpr MotionReportLayout DS4_BT = {0x11, 15, 21, 12, 0, false, 27};
+    // DualSense USB report 0x01: gyro at 16, accel at 22, 32-bit timestamp (0.33 us) at 28
+    constexpr MotionReportLayout DUALSENSE_USB = {0x01, 16, 22, 28, 4, true, 32};
+    // DualSense Bluetooth report 0x31: same block shifted by one header byte
+    constexpr MotionReportLayout DUALSENSE_BT = {0x31, 17, 23, 29, 4, true, 33};
+
+    inline int16_t readInt16(const uint8_t* p) {
+        return static_cast<int16_t>(static_cast<uint16_t>(p[0]) | (static_cast<uint16_t>(p[1]) << 8));
+    }
+
+    inline uint32_t readUInt32(const uint8_t* p) {
+        return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+               (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+    }
+
+    inline int16_t saturate16(int32_t value) {
+        if (value > 32767) return 32767;
+        if (value < -32768) return -32768;
+        return static_cast<int16_t>(value);
+    }
+
+    // Drop rotation inside the deadzone and shift the rest down to avoid a step
+    inline int32_t applyGyroDeadzone(int32_t value, int32_t deadzone) {
+        if (value > deadzone) return value - deadzone;
+        if (value < -deadzone) return value + deadzone;
+        return 0;
+    }
+}
+
+MotionReportPlan MotionReportPlan::forDevice(uint16_t vendorId, uint16_t productId) {
+    MotionReportPlan plan{};
+    if (vendorId != VENDOR_SONY) {
+        return plan;
+    }
+
+    switch (productId) {
+        case PID_DS4_V1:
+        case PID_DS4_V2:
+        case PID_DS4_DONGLE:
+            plan.layouts[0] = DS4_USB;
+            plan.layouts[1] = DS4_BT;
+            plan.layoutCount = 2;
+            break;
+        case PID_DUALSENSE:
+        case PID_DUALSENSE_EDGE:
+            plan.layouts[0] = DUALSENSE_USB;
+            plan.layouts[1] = DUALSENSE_BT;
+            plan.layoutCount = 2;
+            break;
+        default:
+            break;
+    }
+    return plan;
+}
+
+bool extractMotion(const MotionReportPlan& plan, const uint8_t* report, size_t length, MotionState& motion) {
+    motion.valid = false;
+    if (!report || length == 0) {
+        return false;
+    }
+
+    for (uint8_t i = 0; i < plan.layoutCount; ++i) {
+        const MotionReportLayout& layout = plan.layouts[i];
+        if (report[0] != layout.reportId || length < layout.minLength) {
+            continue;
+        }
+
+        const uint8_t* gyro = report + layout.gyroOffset;
+        const uint8_t* accel = report + layout.accelOffset;
+        motion.gyro[0] = readInt16(gyro);
+        motion.gyro[1] = readInt16(gyro + 2);
+        motion.gyro[2] = readInt16(gyro + 4);
+        motion.accel[0] = readInt16(accel);
+        motion.accel[1] = readInt16(accel + 2);
+        motion.accel[2] = readInt16(accel + 4);
+
+        const uint8_t* ts = report + layout.timestampOffset;
+        uint32_t nativeTimestamp = layout.timestamp32
+            ? readUInt32(ts)
+            : static_cast<uint16_t>(readInt16(ts));
+        motion.sensorTimestamp = static_cast<uint16_t>(nativeTimestamp >> layout.timestampShift);
+
+        motion.valid = true;
+        return true;
+    }
+    return false;
+}
+
+GyroStickMapper::GyroStickMapper()
+    : m_sensitivityQ8(8 * 256),
+      m_alphaQ8(128),
+      m_deadzone(16),
+      m_ratchetButtons(0) {
+}
+
+void GyroStickMapper::setSensitivity(float sensitivity) {
+    sensitivity = std::max(0.0f, std::min(64.0f, sensitivity));
+    m_sensitivityQ8 = static_cast<int32_t>(sensitivity * 256.0f + 0.5f);
+}
+
+void GyroStickMapper::setSmoothing(float smoothing) {
+    smoothing = std::max(0.0f, std::min(0.95f, smoothing));
+    m_alphaQ8 = static_cast<int32_t>((1.0f - smoothing) * 256.0f + 0.5f);
+}
+
+void GyroStickMapper::setDeadzone(int deadzone) {
+    m_deadzone = std::max(0, std::min(32767, deadzone));
+}
+
+void GyroStickMapper::setRatchetButtons(uint16_t buttons) {
+    m_ratchetButtons = buttons;
+}
+
+void GyroStickMapper::apply(const MotionState& motion, uint16_t buttons, GyroFilterState& filter,
+                            int16_t& stickX, int16_t& stickY) const {
+    if (!motion.valid) {
+        return;
+    }
+
+    // Ratchet: disengage and forget accumulated motion while held
+    if (m_ratchetButtons != 0 && (buttons & m_ratchetButtons) != 0) {
+        filter.smoothX = 0;
+        filter.smoothY = 0;
+        return;
+    }
+
+    // Yaw (turning left is positive) drives X to the left; pitch up drives Y up
+    int32_t gx = applyGyroDeadzone(-static_cast<int32_t>(motion.gyro[1]), m_deadzone);
+    int32_t gy = applyGyroDeadzone(static_cast<int32_t>(motion.gyro[0]), m_deadzone);
+
+    // EMA in Q8: smooth += (target - smooth) * alpha
+    filter.smoothX += static_cast<int32_t>((static_cast<int64_t>((gx << 8) - filter.smoothX) * m_alphaQ8) >> 8);
+    filter.smoothY += static_cast<int32_t>((static_cast<int64_t>((gy << 8) - filter.smoothY) * m_alphaQ8) >> 8);
+
+    // Q8 smoothed value * Q8 gain -> Q16, back to stick units
+    int64_t dx = (static_cast<int64_t>(filter.smoothX) * m_sensitivityQ8) >> 16;
+    int64_t dy = (static_cast<int64_t>(filter.smoothY) * m_sensitivityQ8) >> 16;
+    dx = std::max<int64_t>(-65536, std::min<int64_t>(65536, dx));
+    dy = std::max<int64_t>(-65536, std::min<int64_t>(65536, dy));
+
+    stickX = saturate16(stickX + static_cast<int32_t>(dx));
+    stickY = saturate16(stickY + static_cast<int32_t>(dy));
+}
@@ -0,0 +1,142 @@
+#include "core/output_shaper.hpp"
+#include "core/simd_kernels.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+OutputShaper::OutputShaper()
+    : m_maxRateHz(0),
+      m_minIntervalUs(0) {
+}
+
+void OutputShaper::setMaxRateHz(uint32_t hz) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_maxRateHz = hz;
+    m_minIntervalUs = hz ? 1000000ull / hz : 0;
+}
+
+uint32_t OutputShaper::getMaxRateHz() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_maxRateHz;
+}
+
+bool OutputShaper::hasDigitalEdge(const TranslatedState& previous, const TranslatedState& next) {
+    if (previous.gamepad.wButtons != next.gamepad.wButtons) {
+        return true;
+    }
+    // Triggers act as buttons in most games (and set the DS4 L2/R2 bits)
+    auto pressed = [](BYTE trigger) { return trigger > TRIGGER_EDGE_THRESHOLD; };
+    return pressed(previous.gamepad.bLeftTrigger) != pressed(next.gamepad.bLeftTrigger) ||
+           pressed(previous.gamepad.bRightTrigger) != pressed(next.gamepad.bRightTrigger);
+}
+
+bool OutputShaper::sameReport(const TranslatedState& a, const TranslatedState& b) {
+    // No padding in the 12 bytes, so byte equality is field equality
+    static_assert(sizeof(TranslatedState::GamepadState) == SimdKernels::GAMEPAD_REPORT_BYTES,
+                  "sameGamepad compares exactly one gamepad report");
+    if (!SimdKernels::active().sameGamepad(&a.gamepad, &b.gamepad)) {
+        return false;
+    }
+    if (a.motion.valid != b.motion.valid) {
+        return false;
+    }
+    return !a.motion.valid ||
+           (std::memcmp(a.motion.gyro, b.motion.gyro, sizeof(a.motion.gyro)) == 0 &&
+            std::memcmp(a.motion.accel, b.motion.accel, sizeof(a.motion.accel)) == 0);
+}
+
+void OutputShaper::markSubmitted(Device& device, const TranslatedState& state, uint64_t nowUs) {
+    device.hasSubmitted = true;
+    device.lastSubmitted = state;
+    device.hasPending = false;
+    device.nextSubmitUs = nowUs + m_minIntervalUs;
+    device.metrics.submitted++;
+}
+
+OutputShaper::Decision OutputShaper::offer(const TranslatedState& state, uint64_t nowUs) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Device& device = m_devices[keyOf(state.targetType, state.sourceUserId)];
+    device.metrics.offered++;
+
+    if (!device.hasSubmitted) {
+        markSubmitted(device, state, nowUs);
+        return Decision::SUBMIT;
+    }
+
+    if (sameReport(device.lastSubmitted, state)) {
+        // Moved away and back before the deadline: nothing left to send
+        if (device.hasPending) {
+            device.hasPending = false;
+            device.metrics.coalesced++;
+        }
+        device.metrics.unchanged++;
+        return Decision::UNCHANGED;
+    }
+
+    if (hasDigitalEdge(device.lastSubmitted, state)) {
+        // Carries the newest analog values too, so a held state is superseded
+        if (device.hasPending) {
+            device.metrics.coalesced++;
+        }
+        device.metrics.edges++;
+        markSubmitted(device, state, nowUs);
+        return Decision::SUBMIT;
+    }
+
+    if (nowUs >= device.nextSubmitUs) {
+        if (device.hasPending) {
+            device.metrics.coalesced++;
+        }
+        markSubmitted(device, state, nowUs);
+        return Decision::SUBMIT;
+    }
+
+    if (device.hasPending) {
+        device.metrics.coalesced++;
+    }
+    device.hasPending = true;
+    device.pending = state;
+    return Decision::COALESCE;
+}
+
+std::vector<TranslatedState> OutputShaper::takeDue(uint64_t nowUs) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<TranslatedState> due;
+    for (auto& entry : m_devices) {
+        Device& device = entry.second;
+        if (device.hasPending && nowUs >= device.nextSubmitUs) {
+            due.push_back(device.pending);
+            device.metrics.flushed++;
+            markSubmitted(device, device.pending, nowUs);
+        }
+    }
+    return due;
+}
+
+uint64_t OutputShaper::nextDeadlineUs() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    uint64_t earliest = UINT64_MAX;
+    for (const auto& entry : m_devices) {
+        if (entry.second.hasPending) {
+            earliest = std::min(earliest, entry.second.nextSubmitUs);
+        }
+    }
+    return earliest;
+}
+
+void OutputShaper::forget(TranslatedState::TargetType type, int userId) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_devices.find(keyOf(type, userId));
+    if (it != m_devices.end()) {
+        // Keep the counters; the next offer is submitted unconditionally
+        Metrics metrics = it->second.metrics;
+        it->second = Device{};
+        it->second.metrics = metrics;
+    }
+}
+
+OutputShaper::Metrics OutputShaper::getMetrics(TranslatedState::TargetType type, int userId) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_devices.find(keyOf(type, userId));
+    return it != m_devices.end() ? it->second.metrics : Metrics{};
+}
@@ -0,0 +1,277 @@
+#include "core/pipeline.hpp"
+#include "core/profile_library.hpp"
+#include "utils/threading.hpp"
+#include "utils/timing.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+
+namespace {
+
+constexpr int DEFAULT_POLLING_FREQUENCY_HZ = 1000;
+
+uint64_t nowUs() {
+    return static_cast<uint64_t>(TimingUtils::counterToMicroseconds(TimingUtils::getPerformanceCounter()));
+}
+
+} // namespace
+
+Pipeline::Pipeline(int id, std::unique_ptr<ConfigManager> config,
+                   std::unique_ptr<InputSource> source, std::unique_ptr<VirtualBus> bus)
+    : m_id(id),
+      m_config(std::move(config)),
+      m_log("[shard " + std::to_string(id) + "] "),
+      m_source(std::move(source)),
+      m_bus(std::move(bus)),
+      m_injector(*m_bus, [this](const TranslatedState& state) { return resolveTarget(state); }),
+      m_intervalUs(0),
+      m_lastFrameUs(0),
+      m_running(false),
+      m_injectThreadEnabled(false) {
+    TimingUtils::initialize();
+    Logger::Scope scope(m_log);
+
+    configureTranslation(*m_config, m_translationLayer);
+    configureOutput(*m_config, m_injector);
+    m_injectThreadEnabled = m_config->getBool("inject_thread_enabled", false);
+
+    int pollingFrequency = m_config->getInt("polling_frequency", DEFAULT_POLLING_FREQUENCY_HZ);
+    m_intervalUs = 1000000ull / static_cast<uint64_t>(std::max(1, pollingFrequency));
+}
+
+Pipeline::~Pipeline() {
+    stop();
+}
+
+void Pipeline::configureTranslation(ConfigManager& config, TranslationLayer& translationLayer) {
+    translationLayer.setXInputToDInputMapping(config.getBool("xinput_to_dinput", true));
+    translationLayer.setDInputToXInputMapping(config.getBool("dinput_to_xinput", true));
+    translationLayer.setSOCDCleaningEnabled(config.getBool("socd_enabled", true));
+    translationLayer.setSOCDMethod(config.getInt("socd_method", 2));
+    translationLayer.setDebouncingEnabled(config.getBool("debouncing_enabled", false));
+    translationLayer.setDebounceIntervalMs(config.getInt("debounce_interval_ms", 10));
+
+    // Stick drift mitigation
+    translationLayer.setStickDeadzoneEnabled(config.getBool("stick_deadzone_enabled", true));
+    translationLayer.setLeftStickDeadzone(config.getFloat("left_stick_deadzone", 0.15f));
+    translationLayer.setRightStickDeadzone(config.getFloat("right_stick_deadzone", 0.15f));
+    translationLayer.setLeftStickAntiDeadzone(config.getFloat("left_stick_anti_deadzone", 0.0f));
+    translationLayer.setRightStickAntiDeadzone(config.getFloat("right_stick_anti_deadzone", 0.0f));
+    translationLayer.setMotionPassthroughEnabled(config.getBool("motion_passthrough_enabled", true));
+    translationLayer.setGyroToStickEnabled(config.getBool("gyro_to_stick_enabled", false));
+    translationLayer.setGyroSensitivity(config.getFloat("gyro_sensitivity", 8.0f));
+    translationLayer.setGyroSmoothing(config.getFloat("gyro_smoothing", 0.5f));
+    translationLayer.setGyroDeadzone(config.getInt("gyro_deadzone", 16));
+    translationLayer.setGyroRatchetButtons(static_cast<WORD>(config.getInt("gyro_ratchet_button", 0)));
+
+    // Large controller counts: chunked translation on a work-stealing pool
+    int translateWorkers = config.getInt("translate_workers", 0);
+    int parallelThreshold = config.getInt("translate_parallel_threshold", 32);
+    translationLayer.setParallelTranslation(translateWorkers > 0 ? static_cast<size_t>(translateWorkers) : 0u,
+                                            parallelThreshold > 0 ? static_cast<size_t>(parallelThreshold) : 1u);
+
+    // Device profiles: the compiled blob of profile_directory (rebuilt when its sources changed)
+    if (config.getBool("auto_load_profiles", true)) {
+        std::filesystem::path directory = config.getString("profile_directory", "profiles");
+        if (directory.is_relative()) {
+            directory = Logger::getExecutableDirectory() / directory;
+        }
+        std::error_code ec;
+        if (std::filesystem::is_directory(directory, ec)) {
+            std::string error;
+            auto library = ProfileLibrary::loadDirectory(directory.string(), &error);
+            if (library) {
+                Logger::log("Loaded " + std::to_string(library->size()) + " device profile(s) from " +
+                            directory.string() + (library->isMapped() ? "" : " (compiled)"));
+                translationLayer.setProfileLibrary(std::move(library));
+            } else {
+                Logger::error("Device profiles not loaded: " + error);
+            }
+        }
+    }
+}
+
+void Pipeline::configureOutput(ConfigManager& config, TargetInjector& injector) {
+    int outputMaxRateHz = config.getInt("output_max_rate_hz", 250);
+    bool outputShapingEnabled = config.getBool("output_shaping_enabled", false);
+    injector.setOutputShaping(outputShapingEnabled, outputMaxRateHz > 0 ? static_cast<uint32_t>(outputMaxRateHz) : 0u);
+    if (outputShapingEnabled) {
+        Logger::log("Output shaping enabled, analog updates capped at " +
+                    (outputMaxRateHz > 0 ? std::to_string(outputMaxRateHz) + " Hz" : std::string("loop rate")));
+    }
+
+    TargetHealthMonitor::Policy policy;
+    int failuresToReconnect = config.getInt("target_failures_to_reconnect", 3);
+    int reconnectAttempts = config.getInt("target_reconnect_attempts", 6);
+    int reconnectBackoffMs = config.getInt("target_reconnect_backoff_ms", 50);
+    int retryDelayMs = config.getInt("target_retry_delay_ms", 2);
+    policy.failuresToReconnect = failuresToReconnect > 0 ? static_cast<uint32_t>(failuresToReconnect) : 1u;
+    policy.maxReconnectAttempts = reconnectAttempts > 0 ? static_cast<uint32_t>(reconnectAttempts) : 1u;
+    policy.initialBackoffUs = (reconnectBackoffMs > 0 ? static_cast<uint64_t>(reconnectBackoffMs) : 1u) * 1000;
+    policy.retryDelayUs = (retryDelayMs > 0 ? static_cast<uint64_t>(retryDelayMs) : 1u) * 1000;
+    injector.setHealthPolicy(policy);
+}
+
+void Pipeline::start(int core) {
+    if (m_thread.joinable()) {
+        return;
+    }
+    m_running = true;
+    startInjection();
+    m_thread = std::thread(&Pipeline::run, this, core);
+}
+
+void Pipeline::startInjection() {
+    if (!m_injectThreadEnabled) {
+        return;
+    }
+    m_injector.start(false, &m_log);
+}
+
+void Pipeline::stop() {
+    m_running = false;
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+    m_injector.stop();
+    m_log.flush();
+}
+
+void Pipeline::run(int core) {
+    Logger::Scope scope(m_log);
+    if (core >= 0 && !ThreadingUtils::setCurrentThreadAffinity(core)) {
+        Logger::error("Could not pin pipeline to core " + std::to_string(core));
+    }
+    Logger::log("Pipeline started" + (core >= 0 ? " on core " + std::to_string(core) : std::string()) +
+                ", " + std::to_string(1000000ull / m_intervalUs) + " Hz");
+
+    while (m_running) {
+        uint64_t frameUs = nowUs();
+        runFrame(frameUs);
+
+        uint64_t wakeUs = frameUs + m_intervalUs;
+        uint64_t afterUs = nowUs();
+        if (wakeUs > afterUs) {
+            std::this_thread::sleep_for(std::chrono::microseconds(wakeUs - afterUs));
+        }
+    }
+
+    Logger::log("Pipeline stopped");
+}
+
+void Pipeline::runFrame(uint64_t frameUs) {
+    uint64_t deltaUs = m_lastFrameUs ? frameUs - m_lastFrameUs : 0;
+    m_lastFrameUs = frameUs;
+
+    m_source->update(static_cast<double>(deltaUs));
+    std::vector<ControllerState> inputStates = m_source->getInputStates();
+    std::vector<TranslatedState> translatedStates = m_translationLayer.translate(inputStates);
+    m_inputMerger.apply(inputStates, translatedStates);
+
+    uint64_t submitUs = nowUs();
+    m_injector.offer(translatedStates, submitUs);
+    if (!m_injectThreadEnabled) {
+        m_injector.pump(submitUs);
+    }
+
+    uint64_t busyUs = nowUs() - frameUs;
+    std::lock_guard<std::mutex> lock(m_statsMutex);
+    m_stats.frames++;
+    m_stats.statesTranslated += translatedStates.size();
+    m_stats.busyUs += busyUs;
+    m_stats.maxFrameUs = std::max(m_stats.maxFrameUs, busyUs);
+    if (busyUs > m_intervalUs) {
+        m_stats.overruns++;
+    }
+}
+
+int Pipeline::resolveTarget(const TranslatedState& state) {
+    // One target per (type, user), created on first sight as VirtualDeviceEmulator does
+    auto key = std::make_pair(static_cast<int>(state.targetType), state.sourceUserId);
+    auto it = m_targetIds.find(key);
+    if (it == m_targetIds.end()) {
+        it = m_targetIds.emplace(key, static_cast<int>(m_targetIds.size())).first;
+        m_injector.trackTarget(it->second);
+    }
+    return it->second;
+}
+
+Pipeline::Stats Pipeline::getStats() const {
+    std::lock_guard<std::mutex> lock(m_statsMutex);
+    Stats stats = m_stats;
+    stats.submits = m_injector.getSubmits();
+    return stats;
+}
+
+std::vector<PipelineSupervisor::Shard> PipelineSupervisor::plan(size_t controllers, size_t shards,
+                                                               int coreCount, int firstCore) {
+    std::vector<Shard> result;
+    if (controllers == 0) {
+        return result;
+    }
+    shards = std::clamp<size_t>(shards, 1, controllers);
+    coreCount = std::max(1, coreCount);
+
+    size_t base = controllers / shards;
+    size_t extra = controllers % shards;
+    size_t first = 0;
+    for (size_t i = 0; i < shards; ++i) {
+        Shard shard;
+        shard.first = first;
+        shard.count = base + (i < extra ? 1 : 0);
+        shard.core = (firstCore + static_cast<int>(i)) % coreCount;
+        first += shard.count;
+        result.push_back(shard);
+    }
+    return result;
+}
+
+PipelineSupervisor::PipelineSupervisor(const ConfigManager& baseConfig, const std::vector<Shard>& shards,
+                                       const EndpointFactory& factory)
+    : m_shards(shards) {
+    for (size_t i = 0; i < m_shards.size(); ++i) {
+        Endpoints endpoints = factory(i, m_shards[i]);
+        m_pipelines.push_back(std::make_unique<Pipeline>(
+            static_cast<int>(i), baseConfig.createView("shard" + std::to_string(i) + "."),
+            std::move(endpoints.source), std::move(endpoints.bus)));
+    }
+}
+
+PipelineSupervisor::~PipelineSupervisor() {
+    stop();
+}
+
+void PipelineSupervisor::start(bool pin) {
+    for (size_t i = 0; i < m_pipelines.size(); ++i) {
+        m_pipelines[i]->start(pin ? m_shards[i].core : -1);
+    }
+}
+
+void PipelineSupervisor::stop() {
+    for (auto& pipeline : m_pipelines) {
+        pipeline->stop();
+    }
+}
+
+size_t PipelineSupervisor::flushLogs() {
+    size_t lines = 0;
+    for (auto& pipeline : m_pipelines) {
+        lines += pipeline->getLog().flush();
+    }
+    return lines;
+}
+
+Pipeline::Stats PipelineSupervisor::totalStats() const {
+    Pipeline::Stats total;
+    for (const auto& pipeline : m_pipelines) {
+        Pipeline::Stats stats = pipeline->getStats();
+        total.frames += stats.frames;
+        total.statesTranslated += stats.statesTranslated;
+        total.submits += stats.submits;
+        total.busyUs += stats.busyUs;
+        total.maxFrameUs = std::max(total.maxFrameUs, stats.maxFrameUs);
+        total.overruns += stats.overruns;
+    }
+    return total;
+}
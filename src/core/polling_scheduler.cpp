@@ -0,0 +1,200 @@
+#include "core/polling_scheduler.hpp"
+#include "utils/string_utils.hpp"
+
+#include <algorithm>
+#include <sstream>
+
+namespace {
+    // Weight of the newest interval in the report interval average
+    constexpr double INTERVAL_SMOOTHING = 0.125;
+}
+
+PollingScheduler::PollingScheduler()
+    : m_baseRateHz(1000),
+      m_dueMask(0) {
+}
+
+void PollingScheduler::setBaseRate(uint32_t hz) {
+    // Keep the slowest class at a whole number of Hz
+    m_baseRateHz = std::max<uint32_t>(hz, 1u << (CLASS_COUNT - 1));
+}
+
+PollingScheduler::DeviceTiming& PollingScheduler::device(size_t index) {
+    if (index >= m_devices.size()) {
+        m_devices.resize(index + 1);
+    }
+    return m_devices[index];
+}
+
+void PollingScheduler::assignDevice(size_t index, const std::wstring& productName, const std::wstring& instanceId) {
+    DeviceTiming& timing = device(index);
+    if (timing.configured && timing.instanceId == instanceId) {
+        return;
+    }
+
+    // New physical device in this slot: forget the previous one's measurements
+    timing = DeviceTiming{};
+    timing.configured = true;
+    timing.instanceId = instanceId;
+    for (const auto& entry : m_overrides) {
+        if (StringUtils::containsCaseInsensitive(productName, entry.match) || StringUtils::containsCaseInsensitive(instanceId, entry.match)) {
+            timing.pinned = true;
+            timing.rateClass = classForRate(entry.rateHz);
+            break;
+        }
+    }
+}
+
+void PollingScheduler::setActive(size_t index, bool active) {
+    device(index).active = active;
+}
+
+void PollingScheduler::beginFrame(uint64_t nowUs) {
+    m_dueMask = 0;
+    for (size_t c = 0; c < CLASS_COUNT; ++c) {
+        if (nowUs < m_deadlineUs[c]) continue;
+
+        uint64_t period = classPeriodUs(c);
+        m_dueMask |= 1u << c;
+        m_served[c]++;
+        if (m_deadlineUs[c] != 0 && nowUs >= m_deadlineUs[c] + period) {
+            // Fell a whole period behind: resynchronise instead of bursting to catch up
+            m_missed[c]++;
+            m_deadlineUs[c] = nowUs + period;
+        } else {
+            m_deadlineUs[c] = (m_deadlineUs[c] == 0 ? nowUs : m_deadlineUs[c]) + period;
+        }
+    }
+}
+
+bool PollingScheduler::isDue(size_t index) const {
+    if (index >= m_devices.size() || !m_devices[index].active) {
+        return m_dueMask != 0;
+    }
+    return (m_dueMask >> m_devices[index].rateClass) & 1u;
+}
+
+void PollingScheduler::recordService(size_t index, bool newReport, uint64_t nowUs) {
+    DeviceTiming& timing = device(index);
+    timing.services++;
+    timing.windowServices++;
+
+    if (newReport) {
+        timing.windowHits++;
+        if (timing.reports > 0) {
+            // Gaps much longer than the slowest class are idle time, not the report rate
+            uint64_t gap = nowUs - timing.lastReportUs;
+            if (gap <= 4 * classPeriodUs(CLASS_COUNT - 1)) {
+                timing.reportIntervalUs = (timing.reportIntervalUs == 0.0)
+                    ? static_cast<double>(gap)
+                    : timing.reportIntervalUs + INTERVAL_SMOOTHING * (static_cast<double>(gap) - timing.reportIntervalUs);
+            }
+        }
+        timing.reports++;
+        timing.lastReportUs = nowUs;
+    }
+
+    if (timing.windowServices >= CLASSIFY_WINDOW) {
+        classify(timing);
+        timing.windowServices = 0;
+        timing.windowHits = 0;
+    }
+}
+
+void PollingScheduler::classify(DeviceTiming& timing) {
+    if (timing.pinned || timing.reports < MIN_REPORTS_TO_CLASSIFY) {
+        return;
+    }
+
+    double hitRatio = static_cast<double>(timing.windowHits) / static_cast<double>(timing.windowServices);
+    if (hitRatio >= UNDERSAMPLED_HIT_RATIO) {
+        // Every poll finds a report: the device may be faster than we look
+        if (timing.rateClass > 0) {
+            timing.rateClass--;
+        }
+        return;
+    }
+
+    size_t target = classForInterval(timing.reportIntervalUs);
+    if (target < timing.rateClass) {
+        timing.rateClass = target;
+    } else if (target > timing.rateClass) {
+        timing.rateClass++; // Slow down one step at a time
+    }
+}
+
+uint64_t PollingScheduler::nextDeadlineUs() const {
+    uint32_t occupied = 0;
+    for (const auto& timing : m_devices) {
+        if (timing.active) {
+            occupied |= 1u << timing.rateClass;
+        }
+    }
+    if (occupied == 0) {
+        occupied = 1; // Nothing connected: keep the base rate for hot-plug detection
+    }
+
+    uint64_t earliest = UINT64_MAX;
+    for (size_t c = 0; c < CLASS_COUNT; ++c) {
+        if ((occupied >> c) & 1u) {
+            earliest = std::min(earliest, m_deadlineUs[c]);
+        }
+    }
+    return earliest;
+}
+
+PollingScheduler::DeviceTiming PollingScheduler::getTiming(size_t index) const {
+    return index < m_devices.size() ? m_devices[index] : DeviceTiming{};
+}
+
+PollingScheduler::GroupStats PollingScheduler::getGroupStats(size_t rateClass) const {
+    GroupStats stats;
+    stats.rateHz = classRateHz(rateClass);
+    stats.deadlinesServed = m_served[rateClass];
+    stats.deadlinesMissed = m_missed[rateClass];
+    for (const auto& timing : m_devices) {
+        if (timing.active && timing.rateClass == rateClass) {
+            stats.members++;
+        }
+    }
+    return stats;
+}
+
+size_t PollingScheduler::classForInterval(double reportIntervalUs) const {
+    size_t rateClass = 0;
+    for (size_t c = 1; c < CLASS_COUNT; ++c) {
+        if (static_cast<double>(classPeriodUs(c)) * 2.0 <= reportIntervalUs * 1.05) {
+            rateClass = c;
+        }
+    }
+    return rateClass;
+}
+
+size_t PollingScheduler::classForRate(uint32_t rateHz) const {
+    size_t rateClass = 0;
+    for (size_t c = 1; c < CLASS_COUNT; ++c) {
+        if (classRateHz(c) >= rateHz) {
+            rateClass = c;
+        }
+    }
+    return rateClass;
+}
+
+std::vector<PollingRateOverride> PollingScheduler::parseOverrides(const std::string& text) {
+    std::vector<PollingRateOverride> overrides;
+    std::stringstream ss(text);
+    std::string entry;
+    while (std::getline(ss, entry, ';')) {
+        size_t colon = entry.rfind(':');
+        if (colon == std::string::npos || colon == 0) continue;
+        try {
+            unsigned long hz = std::stoul(entry.substr(colon + 1));
+            if (hz == 0) continue;
+            std::string match = entry.substr(0, colon);
+            overrides.push_back({std::wstring(match.begin(), match.end()), static_cast<uint32_t>(hz)});
+        } catch (...) {
+            continue;
+        }
+    }
+    return overrides;
+}
@@ -0,0 +1,880 @@
+#include "core/profile_library.hpp"
+#include "core/controller_db.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+namespace {
+
+// Blob layout (native little-endian, read in place): Header, Bucket[bucketCount],
+// Profile[profileCount], string table. Every section starts 8-byte aligned.
+struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t profileCount;
+    uint32_t bucketCount;           // Power of two
+    uint32_t stringBytes;
+    uint64_t sourceStamp;
+    uint32_t checksum;              // FNV-1a of everything after the header
+    uint32_t reserved;
+};
+
+constexpr char MAGIC[8] = {'X', 'I', 'D', 'P', 'P', 'R', 'F', '\0'};
+constexpr uint32_t KEY_USB = 0;
+constexpr uint32_t KEY_NAME = 1;
+constexpr uint32_t KEY_USB_VERSION = 2;
+constexpr uint32_t MIN_BUCKETS = 8;
+
+// Built-in profiles, compiled on first use. Files in profile_directory may override their keys.
+const char* const BUILTIN_SOURCE =
+    "xidp-profile 1\n"
+    "name \"DualShock 4\"\n"
+    "match name=\"Wireless Controller\"\n"
+    "button 1 x\n"
+    "button 2 a\n"
+    "button 3 b\n"
+    "button 4 y\n"
+    "button 5 lb\n"
+    "button 6 rb\n"
+    "button 9 back\n"
+    "button 10 start\n"
+    "button 11 ls\n"
+    "button 12 rs\n"
+    "axis 0x30 lx fixed center=128 scale=256\n"
+    "axis 0x31 ly fixed center=128 scale=256 invert\n"
+    "axis 0x32 rx fixed center=128 scale=256\n"
+    "axis 0x35 ry fixed center=128 scale=256 invert\n";
+
+constexpr uint64_t FNV_OFFSET = 0xcbf29ce484222325ULL;
+constexpr uint64_t FNV_PRIME = 0x100000001b3ULL;
+
+uint64_t fnv1a(uint64_t hash, const void* data, size_t size) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        hash = (hash ^ bytes[i]) * FNV_PRIME;
+    }
+    return hash;
+}
+
+uint32_t checksum32(const uint8_t* data, size_t size) {
+    uint32_t hash = 0x811c9dc5u;
+    for (size_t i = 0; i < size; ++i) {
+        hash = (hash ^ data[i]) * 0x01000193u;
+    }
+    return hash;
+}
+
+uint64_t hashUsb(uint16_t vendorId, uint16_t productId) {
+    const uint8_t key[5] = {'u', static_cast<uint8_t>(vendorId), static_cast<uint8_t>(vendorId >> 8),
+                            static_cast<uint8_t>(productId), static_cast<uint8_t>(productId >> 8)};
+    return fnv1a(FNV_OFFSET, key, sizeof(key));
+}
+
+uint64_t hashUsbVersion(uint16_t vendorId, uint16_t productId, uint16_t version) {
+    const uint8_t key[7] = {'v', static_cast<uint8_t>(vendorId), static_cast<uint8_t>(vendorId >> 8),
+                            static_cast<uint8_t>(productId), static_cast<uint8_t>(productId >> 8),
+                            static_cast<uint8_t>(version), static_cast<uint8_t>(version >> 8)};
+    return fnv1a(FNV_OFFSET, key, sizeof(key));
+}
+
+// Names are hashed a UTF-16 unit at a time (one multiply per character)
+constexpr uint64_t NAME_HASH_SEED = (FNV_OFFSET ^ 'n') * FNV_PRIME;
+
+uint64_t hashUnit(uint64_t hash, uint16_t unit) {
+    return (hash ^ unit) * FNV_PRIME;
+}
+
+uint64_t hashName(const std::vector<uint16_t>& units) {
+    uint64_t hash = NAME_HASH_SEED;
+    for (uint16_t unit : units) hash = hashUnit(hash, unit);
+    return hash;
+}
+
+void appendUtf16(char32_t codePoint, std::vector<uint16_t>& units) {
+    if (codePoint > 0xFFFF) {
+        codePoint -= 0x10000;
+        units.push_back(static_cast<uint16_t>(0xD800 + (codePoint >> 10)));
+        units.push_back(static_cast<uint16_t>(0xDC00 + (codePoint & 0x3FF)));
+    } else {
+        units.push_back(static_cast<uint16_t>(codePoint));
+    }
+}
+
+// Product names are keyed as UTF-16, what HidD_GetProductString returns
+bool utf8ToUtf16(const std::string& text, std::vector<uint16_t>& units) {
+    units.clear();
+    for (size_t i = 0; i < text.size();) {
+        const uint8_t lead = static_cast<uint8_t>(text[i]);
+        size_t extra = lead < 0x80 ? 0 : (lead & 0xE0) == 0xC0 ? 1 : (lead & 0xF0) == 0xE0 ? 2 : (lead & 0xF8) == 0xF0 ? 3 : 4;
+        if (extra > 3 || i + extra >= text.size()) {
+            return false;
+        }
+        char32_t codePoint = extra == 0 ? lead : lead & (0x3F >> extra);
+        for (size_t k = 1; k <= extra; ++k) {
+            const uint8_t next = static_cast<uint8_t>(text[i + k]);
+            if ((next & 0xC0) != 0x80) return false;
+            codePoint = (codePoint << 6) | (next & 0x3F);
+        }
+        if (codePoint > 0x10FFFF) return false;
+        appendUtf16(codePoint, units);
+        i += extra + 1;
+    }
+    return true;
+}
+
+// UTF-16 units of a wide string without building them: wchar_t is UTF-16 on
+// Windows and UTF-32 elsewhere. Stops early when visit returns false.
+template <typename Visit>
+bool forEachUnit(const std::wstring& text, Visit visit) {
+    for (wchar_t c : text) {
+        char32_t codePoint = static_cast<char32_t>(c);
+        if (codePoint > 0xFFFF) {
+            codePoint -= 0x10000;
+            if (!visit(static_cast<uint16_t>(0xD800 + (codePoint >> 10))) ||
+                !visit(static_cast<uint16_t>(0xDC00 + (codePoint & 0x3FF)))) {
+                return false;
+            }
+        } else if (!visit(static_cast<uint16_t>(codePoint))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Same tokenizer as recordings: whitespace separated, double quotes group a value
+std::vector<std::string> tokenize(const std::string& line) {
+    std::vector<std::string> tokens;
+    std::string current;
+    bool quoted = false;
+    bool pending = false;
+    for (char c : line) {
+        if (c == '"') {
+            quoted = !quoted;
+            pending = true;
+        } else if (!quoted && (c == ' ' || c == '\t' || c == '\r')) {
+            if (pending) {
+                tokens.push_back(current);
+                current.clear();
+                pending = false;
+            }
+        } else {
+            current += c;
+            pending = true;
+        }
+    }
+    if (pending) {
+        tokens.push_back(current);
+    }
+    return tokens;
+}
+
+bool parseInteger(const std::string& text, long long& value, int base = 0) {
+    if (text.empty()) {
+        return false;
+    }
+    char* end = nullptr;
+    value = std::strtoll(text.c_str(), &end, base);
+    return end && *end == '\0';
+}
+
+bool splitKeyValue(const std::string& token, std::string& key, std::string& value) {
+    size_t pos = token.find('=');
+    if (pos == std::string::npos || pos == 0) {
+        return false;
+    }
+    key = token.substr(0, pos);
+    value = token.substr(pos + 1);
+    return true;
+}
+
+bool parseButton(const std::string& text, WORD& mask) {
+    static const std::pair<const char*, WORD> NAMES[] = {
+        {"a", XINPUT_GAMEPAD_A}, {"b", XINPUT_GAMEPAD_B}, {"x", XINPUT_GAMEPAD_X}, {"y", XINPUT_GAMEPAD_Y},
+        {"lb", XINPUT_GAMEPAD_LEFT_SHOULDER}, {"rb", XINPUT_GAMEPAD_RIGHT_SHOULDER},
+        {"back", XINPUT_GAMEPAD_BACK}, {"start", XINPUT_GAMEPAD_START},
+        {"ls", XINPUT_GAMEPAD_LEFT_THUMB}, {"rs", XINPUT_GAMEPAD_RIGHT_THUMB},
+        {"up", XINPUT_GAMEPAD_DPAD_UP}, {"down", XINPUT_GAMEPAD_DPAD_DOWN},
+        {"left", XINPUT_GAMEPAD_DPAD_LEFT}, {"right", XINPUT_GAMEPAD_DPAD_RIGHT}};
+    long long number = 0;
+    if (text.rfind("0x", 0) == 0) {
+        if (!parseInteger(text, number) || number <= 0 || number > 0xFFFF) return false;
+        mask = static_cast<WORD>(number);
+        return true;
+    }
+    for (const auto& [name, bit] : NAMES) {
+        if (text == name) {
+            mask = bit;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool parseAxisTarget(const std::string& text, uint8_t& target) {
+    static const std::pair<const char*, uint8_t> NAMES[] = {
+        {"lx", ProfileLibrary::AXIS_LEFT_X}, {"ly", ProfileLibrary::AXIS_LEFT_Y},
+        {"rx", ProfileLibrary::AXIS_RIGHT_X}, {"ry", ProfileLibrary::AXIS_RIGHT_Y},
+        {"lt", ProfileLibrary::AXIS_LEFT_TRIGGER}, {"rt", ProfileLibrary::AXIS_RIGHT_TRIGGER}};
+    for (const auto& [name, value] : NAMES) {
+        if (text == name) {
+            target = value;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Button names joined by '+'; lt and rt pull a trigger fully
+bool parseButtons(const std::string& text, WORD& mask, uint8_t& triggers) {
+    std::stringstream names(text);
+    std::string name;
+    while (std::getline(names, name, '+')) {
+        WORD bit = 0;
+        if (name == "lt") triggers |= ProfileLibrary::TRIGGER_LEFT;
+        else if (name == "rt") triggers |= ProfileLibrary::TRIGGER_RIGHT;
+        else if (parseButton(name, bit)) mask |= bit;
+        else return false;
+    }
+    return true;
+}
+
+std::string describeKey(uint32_t kind, const std::string& key) {
+    return kind == KEY_NAME ? "name=\"" + key + "\"" : "usb=" + key;
+}
+
+std::string usbText(const ProfileLibrary::Source::UsbId& id) {
+    char text[16];
+    if (id.version != 0) {
+        std::snprintf(text, sizeof(text), "%04x:%04x:%04x", id.vendorId, id.productId, id.version);
+    } else {
+        std::snprintf(text, sizeof(text), "%04x:%04x", id.vendorId, id.productId);
+    }
+    return text;
+}
+
+template <typename T>
+void appendBytes(std::vector<uint8_t>& blob, const T& value) {
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+    blob.insert(blob.end(), bytes, bytes + sizeof(T));
+}
+
+// *.profile files of a directory, sorted so the stamp and the override order are stable
+std::vector<std::filesystem::path> profileFiles(const std::string& directory) {
+    namespace fs = std::filesystem;
+    std::vector<fs::path> files;
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(directory, ec)) {
+        if (entry.path().extension() == ".profile") {
+            files.push_back(entry.path());
+        }
+    }
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+bool builtInSources(std::vector<ProfileLibrary::Source>& sources, std::string* error) {
+    std::istringstream in(BUILTIN_SOURCE);
+    ProfileLibrary::Source source;
+    source.origin = "(built-in)";
+    if (!ProfileLibrary::parse(in, source, error)) {
+        return false;
+    }
+    sources.push_back(source);
+    return true;
+}
+
+bool compileSources(const std::string& directory, uint64_t stamp, std::vector<uint8_t>& blob, std::string* error) {
+    std::vector<ProfileLibrary::Source> sources;
+    if (!builtInSources(sources, error)) {
+        return false;
+    }
+    // An SDL database may redefine built-ins, and profile files anything before them
+    const std::filesystem::path database = std::filesystem::path(directory) / ProfileLibrary::CONTROLLER_DB_NAME;
+    std::error_code ec;
+    if (std::filesystem::exists(database, ec) &&
+        !ControllerDb::importFile(database.string(), ControllerDb::nativePlatform(), sources, nullptr, error)) {
+        return false;
+    }
+    const size_t overridableCount = sources.size();
+    for (const auto& file : profileFiles(directory)) {
+        std::ifstream in(file);
+        ProfileLibrary::Source source;
+        source.origin = file.filename().string();
+        source.name = file.stem().string();
+        std::string reason;
+        if (!in || !ProfileLibrary::parse(in, source, &reason)) {
+            if (error) *error = source.origin + ": " + (in ? reason : "cannot read");
+            return false;
+        }
+        sources.push_back(std::move(source));
+    }
+    return ProfileLibrary::compile(sources, overridableCount, stamp, blob, error);
+}
+
+bool writeBlob(const std::vector<uint8_t>& blob, const std::string& path, std::string* error) {
+    // Written next to the target and renamed, so a reader never maps half a file
+    const std::string temporary = path + ".tmp";
+    {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(blob.data()), static_cast<std::streamsize>(blob.size()));
+        if (!out) {
+            if (error) *error = "cannot write " + temporary;
+            return false;
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(temporary, path, ec);
+    if (ec) {
+        std::filesystem::remove(temporary, ec);
+        if (error) *error = "cannot replace " + path;
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+struct ProfileLibrary::Bucket {
+    uint64_t hash;
+    uint32_t profile;       // Index + 1, 0 = empty
+    uint32_t kind;          // KEY_USB, KEY_USB_VERSION or KEY_NAME
+    uint32_t key;           // USB: vendor << 16 | product; name: byte offset of its UTF-16 units
+    uint32_t keyLength;     // Name length in UTF-16 units; USB: version
+};
+
+static_assert(sizeof(Header) == 40, "blob header layout");
+static_assert(sizeof(ProfileLibrary::Axis) == 12, "blob axis layout");
+static_assert(sizeof(ProfileLibrary::Profile) == 8 + 3 * ProfileLibrary::BUTTON_USAGES + 2 * ProfileLibrary::HAT_DIRECTIONS +
+                                                     12 * ProfileLibrary::AXIS_USAGES,
+              "blob profile layout");
+static_assert(sizeof(ProfileLibrary::Profile) % 8 == 0, "string table stays 8-byte aligned");
+
+ProfileLibrary::ProfileLibrary()
+    : m_buckets(nullptr),
+      m_bucketCount(0),
+      m_profiles(nullptr),
+      m_profileCount(0),
+      m_strings(nullptr),
+      m_stringBytes(0),
+      m_sourceStamp(0) {
+}
+
+ProfileLibrary::~ProfileLibrary() = default;
+
+bool ProfileLibrary::parse(std::istream& in, Source& source, std::string* error) {
+    int lineNumber = 0;
+    auto fail = [&](const std::string& reason) {
+        if (error) {
+            *error = "line " + std::to_string(lineNumber) + ": " + reason;
+        }
+        return false;
+    };
+
+    std::string line;
+    bool sawHeader = false;
+    while (std::getline(in, line)) {
+        lineNumber++;
+        std::vector<std::string> tokens = tokenize(line);
+        // '#' starts a comment, also after a mapping
+        auto comment = std::find_if(tokens.begin(), tokens.end(),
+                                    [](const std::string& token) { return !token.empty() && token[0] == '#'; });
+        tokens.erase(comment, tokens.end());
+        if (tokens.empty()) {
+            continue;
+        }
+        const std::string& kind = tokens[0];
+
+        if (!sawHeader) {
+            if (kind != "xidp-profile" || tokens.size() != 2 || std::atoi(tokens[1].c_str()) != SOURCE_VERSION) {
+                return fail("expected 'xidp-profile " + std::to_string(SOURCE_VERSION) + "'");
+            }
+            sawHeader = true;
+            continue;
+        }
+
+        if (kind == "name") {
+            if (tokens.size() != 2 || tokens[1].empty()) return fail("name needs one value");
+            source.name = tokens[1];
+        } else if (kind == "match") {
+            std::string key, value;
+            if (tokens.size() != 2 || !splitKeyValue(tokens[1], key, value)) return fail("match needs usb=vid:pid or name=\"...\"");
+            if (key == "usb") {
+                std::vector<std::string> parts;
+                std::stringstream ids(value);
+                std::string part;
+                while (std::getline(ids, part, ':')) parts.push_back(part);
+                long long numbers[3] = {0, 0, 0};
+                bool valid = parts.size() == 2 || parts.size() == 3;
+                for (size_t i = 0; valid && i < parts.size(); ++i) {
+                    valid = parseInteger(parts[i], numbers[i], 16) && numbers[i] >= 0 && numbers[i] <= 0xFFFF;
+                }
+                if (!valid) return fail("bad usb id '" + value + "' (expected vvvv:pppp[:version] in hex)");
+                source.usbIds.push_back({static_cast<uint16_t>(numbers[0]), static_cast<uint16_t>(numbers[1]),
+                                         static_cast<uint16_t>(numbers[2])});
+            } else if (key == "name") {
+                std::vector<uint16_t> units;
+                if (value.empty() || !utf8ToUtf16(value, units)) return fail("bad product name");
+                source.productNames.push_back(value);
+            } else {
+                return fail("unknown match key '" + key + "'");
+            }
+        } else if (kind == "button") {
+            long long usage = 0;
+            if (tokens.size() != 3 || !parseInteger(tokens[1], usage)) return fail("button needs a usage and buttons");
+            if (usage < 1 || usage >= static_cast<long long>(BUTTON_USAGES)) {
+                return fail("button usage " + tokens[1] + " out of range 1-" + std::to_string(BUTTON_USAGES - 1));
+            }
+            WORD mask = 0;
+            uint8_t triggers = 0;
+            if (!parseButtons(tokens[2], mask, triggers)) return fail("unknown button '" + tokens[2] + "'");
+            if (mask == 0 && triggers == 0) return fail("button needs at least one target");
+            const USAGE key = static_cast<USAGE>(usage);
+            if (source.buttons.count(key) || source.buttonTriggers.count(key)) {
+                return fail("button " + tokens[1] + " mapped twice");
+            }
+            if (mask != 0) source.buttons[key] = mask;
+            if (triggers != 0) source.buttonTriggers[key] = triggers;
+        } else if (kind == "hat") {
+            static const char* const DIRECTIONS[HAT_DIRECTIONS] = {"up", "right", "down", "left"};
+            if (tokens.size() != 3) return fail("hat needs a direction and buttons");
+            const auto direction = std::find_if(std::begin(DIRECTIONS), std::end(DIRECTIONS),
+                                                [&](const char* name) { return tokens[1] == name; });
+            if (direction == std::end(DIRECTIONS)) return fail("unknown hat direction '" + tokens[1] + "'");
+            WORD mask = 0;
+            uint8_t triggers = 0;
+            if (!parseButtons(tokens[2], mask, triggers) || triggers != 0 || mask == 0) {
+                return fail("bad hat buttons '" + tokens[2] + "'");
+            }
+            WORD& hat = source.hat[direction - std::begin(DIRECTIONS)];
+            if (hat != 0) return fail("hat " + tokens[1] + " mapped twice");
+            hat = mask;
+        } else if (kind == "axis") {
+            long long usage = 0;
+            if (tokens.size() < 4 || !parseInteger(tokens[1], usage)) return fail("axis needs a usage, a target and a mode");
+            if (usage < AXIS_FIRST_USAGE || usage >= static_cast<long long>(AXIS_FIRST_USAGE + AXIS_USAGES)) {
+                return fail("axis usage " + tokens[1] + " out of range 0x30-0x3f");
+            }
+            Axis axis;
+            if (!parseAxisTarget(tokens[2], axis.target)) return fail("unknown axis target '" + tokens[2] + "'");
+            if (tokens[3] == "caps") {
+                axis.mode = AXIS_CAPS;
+            } else if (tokens[3] == "fixed") {
+                axis.mode = AXIS_FIXED;
+            } else {
+                return fail("unknown axis mode '" + tokens[3] + "'");
+            }
+            bool sawScale = false;
+            for (size_t i = 4; i < tokens.size(); ++i) {
+                std::string key, value;
+                long long number = 0;
+                if (tokens[i] == "invert") {
+                    axis.invert = 1;
+                } else if (axis.mode == AXIS_FIXED && splitKeyValue(tokens[i], key, value) && parseInteger(value, number) &&
+                           number >= INT32_MIN && number <= INT32_MAX && (key == "center" || key == "scale")) {
+                    (key == "center" ? axis.center : axis.scale) = static_cast<int32_t>(number);
+                    sawScale |= key == "scale";
+                } else {
+                    return fail("bad axis field: " + tokens[i]);
+                }
+            }
+            if (axis.mode == AXIS_FIXED && (!sawScale || axis.scale == 0)) return fail("fixed axis needs a non-zero scale");
+            if (!source.axes.emplace(static_cast<USAGE>(usage), axis).second) {
+                return fail("axis " + tokens[1] + " mapped twice");
+            }
+        } else {
+            return fail("unknown line kind '" + kind + "'");
+        }
+    }
+    if (!sawHeader) {
+        return fail("missing 'xidp-profile' header");
+    }
+    if (source.usbIds.empty() && source.productNames.empty()) {
+        return fail("profile has no match line");
+    }
+    if (source.name.empty()) {
+        return fail("profile has no name");
+    }
+    return true;
+}
+
+bool ProfileLibrary::compile(const std::vector<Source>& sources, size_t overridableCount, uint64_t sourceStamp,
+                             std::vector<uint8_t>& blob, std::string* error) {
+    struct Key {
+        uint32_t kind;
+        uint32_t usbId;
+        uint16_t version;
+        std::string text;                   // For messages and as the map key
+        std::vector<uint16_t> units;
+        size_t source;
+    };
+
+    // Resolve match keys to sources; a file may take over a built-in or imported key
+    std::vector<Key> keys;
+    std::map<std::pair<uint32_t, std::string>, size_t> keyIndex;
+    for (size_t s = 0; s < sources.size(); ++s) {
+        std::vector<Key> own;
+        for (const auto& id : sources[s].usbIds) {
+            own.push_back({id.version != 0 ? KEY_USB_VERSION : KEY_USB,
+                           static_cast<uint32_t>(id.vendorId) << 16 | id.productId, id.version, usbText(id), {}, s});
+        }
+        for (const auto& name : sources[s].productNames) {
+            Key key{KEY_NAME, 0, 0, name, {}, s};
+            if (!utf8ToUtf16(name, key.units)) {
+                if (error) *error = sources[s].origin + ": bad product name";
+                return false;
+            }
+            own.push_back(std::move(key));
+        }
+        for (auto& key : own) {
+            auto [it, inserted] = keyIndex.emplace(std::make_pair(key.kind, key.text), keys.size());
+            if (inserted) {
+                keys.push_back(std::move(key));
+                continue;
+            }
+            Key& existing = keys[it->second];
+            if (existing.source < overridableCount) {
+                existing.source = s;
+            } else {
+                if (error) {
+                    *error = sources[s].origin + ": " + describeKey(key.kind, key.text) + " is already matched by " +
+                             sources[existing.source].origin;
+                }
+                return false;
+            }
+        }
+    }
+
+    // Only profiles that some key still reaches are emitted
+    std::vector<uint32_t> profileIndex(sources.size(), 0);
+    std::vector<size_t> emitted;
+    for (const auto& key : keys) {
+        if (profileIndex[key.source] == 0) {
+            emitted.push_back(key.source);
+            profileIndex[key.source] = static_cast<uint32_t>(emitted.size());
+        }
+    }
+    std::sort(emitted.begin(), emitted.end());
+    for (size_t i = 0; i < emitted.size(); ++i) {
+        profileIndex[emitted[i]] = static_cast<uint32_t>(i + 1);
+    }
+
+    std::vector<uint8_t> strings;
+    auto addString = [&strings](const void* data, size_t size, size_t alignment) {
+        while (strings.size() % alignment != 0) strings.push_back(0);
+        const uint32_t offset = static_cast<uint32_t>(strings.size());
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        strings.insert(strings.end(), bytes, bytes + size);
+        return offset;
+    };
+
+    std::vector<Profile> profiles(emitted.size());
+    for (size_t i = 0; i < emitted.size(); ++i) {
+        const Source& source = sources[emitted[i]];
+        Profile& profile = profiles[i];
+        profile.nameOffset = addString(source.name.data(), source.name.size(), 1);
+        profile.nameLength = static_cast<uint32_t>(source.name.size());
+        for (const auto& [usage, mask] : source.buttons) {
+            if (usage == 0 || usage >= BUTTON_USAGES) {
+                if (error) *error = source.origin + ": button usage " + std::to_string(usage) + " out of range";
+                return false;
+            }
+            profile.buttons[usage] = mask;
+        }
+        for (const auto& [usage, triggers] : source.buttonTriggers) {
+            if (usage == 0 || usage >= BUTTON_USAGES || (triggers & ~(TRIGGER_LEFT | TRIGGER_RIGHT)) != 0) {
+                if (error) *error = source.origin + ": bad trigger button " + std::to_string(usage);
+                return false;
+            }
+            profile.buttonTriggers[usage] = triggers;
+        }
+        for (size_t d = 0; d < HAT_DIRECTIONS; ++d) {
+            profile.hat[d] = source.hat[d];
+        }
+        for (size_t a = 0; a < AXIS_USAGES; ++a) {
+            profile.axes[a] = Axis{};
+        }
+        for (const auto& [usage, axis] : source.axes) {
+            if (usage < AXIS_FIRST_USAGE || usage >= AXIS_FIRST_USAGE + AXIS_USAGES || axis.target > AXIS_RIGHT_TRIGGER ||
+                axis.mode > AXIS_FIXED) {
+                if (error) *error = source.origin + ": bad axis " + std::to_string(usage);
+                return false;
+            }
+            profile.axes[usage - AXIS_FIRST_USAGE] = axis;
+        }
+    }
+
+    // Open addressing at most half full, so a miss ends after a probe or two
+    uint32_t bucketCount = MIN_BUCKETS;
+    while (bucketCount < keys.size() * 2) bucketCount *= 2;
+    std::vector<Bucket> buckets(bucketCount, Bucket{0, 0, 0, 0, 0});
+    for (const auto& key : keys) {
+        Bucket bucket{0, profileIndex[key.source], key.kind, key.usbId, 0};
+        const uint16_t vendorId = static_cast<uint16_t>(key.usbId >> 16);
+        const uint16_t productId = static_cast<uint16_t>(key.usbId);
+        if (key.kind == KEY_USB) {
+            bucket.hash = hashUsb(vendorId, productId);
+        } else if (key.kind == KEY_USB_VERSION) {
+            bucket.hash = hashUsbVersion(vendorId, productId, key.version);
+            bucket.keyLength = key.version;
+        } else {
+            bucket.hash = hashName(key.units);
+            bucket.key = addString(key.units.data(), key.units.size() * sizeof(uint16_t), 2);
+            bucket.keyLength = static_cast<uint32_t>(key.units.size());
+        }
+        uint32_t slot = static_cast<uint32_t>(bucket.hash) & (bucketCount - 1);
+        while (buckets[slot].profile != 0) slot = (slot + 1) & (bucketCount - 1);
+        buckets[slot] = bucket;
+    }
+    while (strings.size() % 8 != 0) strings.push_back(0);
+
+    Header header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = FORMAT_VERSION;
+    header.profileCount = static_cast<uint32_t>(profiles.size());
+    header.bucketCount = bucketCount;
+    header.stringBytes = static_cast<uint32_t>(strings.size());
+    header.sourceStamp = sourceStamp;
+
+    blob.clear();
+    blob.reserve(sizeof(Header) + buckets.size() * sizeof(Bucket) + profiles.size() * sizeof(Profile) + strings.size());
+    appendBytes(blob, header);
+    for (const auto& bucket : buckets) appendBytes(blob, bucket);
+    for (const auto& profile : profiles) appendBytes(blob, profile);
+    blob.insert(blob.end(), strings.begin(), strings.end());
+
+    header.checksum = checksum32(blob.data() + sizeof(Header), blob.size() - sizeof(Header));
+    std::memcpy(blob.data(), &header, sizeof(Header));
+    return true;
+}
+
+bool ProfileLibrary::compileDirectory(const std::string& directory, const std::string& outputPath, std::string* error) {
+    std::vector<uint8_t> blob;
+    return compileSources(directory, sourceStamp(directory), blob, error) && writeBlob(blob, outputPath, error);
+}
+
+std::shared_ptr<const ProfileLibrary> ProfileLibrary::loadDirectory(const std::string& directory, std::string* error) {
+    const uint64_t stamp = sourceStamp(directory);
+    const std::string compiledPath = (std::filesystem::path(directory) / COMPILED_NAME).string();
+
+    auto mapped = std::make_shared<ProfileLibrary>();
+    if (mapped->open(compiledPath) && mapped->getSourceStamp() == stamp) {
+        return mapped;
+    }
+
+    std::vector<uint8_t> blob;
+    if (!compileSources(directory, stamp, blob, error)) {
+        return nullptr;
+    }
+    writeBlob(blob, compiledPath, nullptr);     // Next start maps it; failing to cache is not an error
+    auto compiled = std::make_shared<ProfileLibrary>();
+    if (!compiled->open(std::move(blob), error)) {
+        return nullptr;
+    }
+    return compiled;
+}
+
+std::shared_ptr<const ProfileLibrary> ProfileLibrary::builtIn() {
+    static const std::shared_ptr<const ProfileLibrary> library = [] {
+        auto compiled = std::make_shared<ProfileLibrary>();
+        std::vector<Source> sources;
+        std::vector<uint8_t> blob;
+        if (builtInSources(sources, nullptr) && compile(sources, sources.size(), 0, blob, nullptr)) {
+            compiled->open(std::move(blob), nullptr);
+        }
+        return compiled;
+    }();
+    return library;
+}
+
+uint64_t ProfileLibrary::sourceStamp(const std::string& directory) {
+    uint64_t stamp = fnv1a(FNV_OFFSET, &FORMAT_VERSION, sizeof(FORMAT_VERSION));
+    stamp = fnv1a(stamp, BUILTIN_SOURCE, std::strlen(BUILTIN_SOURCE));
+    std::vector<std::filesystem::path> files = profileFiles(directory);
+    const std::filesystem::path database = std::filesystem::path(directory) / CONTROLLER_DB_NAME;
+    std::error_code missing;
+    if (std::filesystem::exists(database, missing)) {
+        files.push_back(database);
+    }
+    for (const auto& file : files) {
+        std::error_code ec;
+        const std::string name = file.filename().string();
+        const uint64_t size = std::filesystem::file_size(file, ec);
+        const int64_t time = static_cast<int64_t>(std::filesystem::last_write_time(file, ec).time_since_epoch().count());
+        stamp = fnv1a(stamp, name.data(), name.size() + 1);
+        stamp = fnv1a(stamp, &size, sizeof(size));
+        stamp = fnv1a(stamp, &time, sizeof(time));
+    }
+    return stamp;
+}
+
+bool ProfileLibrary::open(const std::string& path, std::string* error) {
+    m_owned.clear();
+    if (!m_file.open(path, error)) {
+        adopt(nullptr, 0, nullptr);
+        return false;
+    }
+    if (!adopt(m_file.data(), m_file.size(), error)) {
+        if (error) *error = path + ": " + *error;
+        m_file.close();
+        return false;
+    }
+    return true;
+}
+
+bool ProfileLibrary::open(std::vector<uint8_t> blob, std::string* error) {
+    m_file.close();
+    m_owned = std::move(blob);
+    if (!adopt(m_owned.data(), m_owned.size(), error)) {
+        m_owned.clear();
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Checks a blob once so lookups can read it without bounds checks
+ *
+ * Sizes, checksum, and every index and offset the lookups follow are
+ * verified; on failure the library is left empty.
+ */
+bool ProfileLibrary::adopt(const uint8_t* data, size_t size, std::string* error) {
+    m_buckets = nullptr;
+    m_bucketCount = 0;
+    m_profiles = nullptr;
+    m_profileCount = 0;
+    m_strings = nullptr;
+    m_stringBytes = 0;
+    m_sourceStamp = 0;
+    auto fail = [error](const std::string& reason) {
+        if (error) *error = reason;
+        return false;
+    };
+    if (!data) {
+        return fail("empty profile blob");
+    }
+
+    if (size < sizeof(Header) || reinterpret_cast<uintptr_t>(data) % alignof(Header) != 0) {
+        return fail("not a profile blob");
+    }
+    Header header;
+    std::memcpy(&header, data, sizeof(Header));
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) return fail("not a profile blob");
+    if (header.version != FORMAT_VERSION) return fail("profile blob version " + std::to_string(header.version));
+    if (header.bucketCount < MIN_BUCKETS || (header.bucketCount & (header.bucketCount - 1)) != 0 ||
+        header.bucketCount > (1u << 24) || header.profileCount > header.bucketCount) {
+        return fail("bad profile blob index");
+    }
+    const uint64_t expected = sizeof(Header) + static_cast<uint64_t>(header.bucketCount) * sizeof(Bucket) +
+                              static_cast<uint64_t>(header.profileCount) * sizeof(Profile) + header.stringBytes;
+    if (expected != size) return fail("profile blob is " + std::to_string(size) + " bytes, expected " + std::to_string(expected));
+    if (checksum32(data + sizeof(Header), size - sizeof(Header)) != header.checksum) {
+        return fail("profile blob checksum mismatch");
+    }
+
+    const Bucket* buckets = reinterpret_cast<const Bucket*>(data + sizeof(Header));
+    const Profile* profiles = reinterpret_cast<const Profile*>(buckets + header.bucketCount);
+    const uint8_t* strings = reinterpret_cast<const uint8_t*>(profiles + header.profileCount);
+    uint32_t emptyBuckets = 0;
+    for (uint32_t i = 0; i < header.bucketCount; ++i) {
+        const Bucket& bucket = buckets[i];
+        if (bucket.profile == 0) {
+            emptyBuckets++;
+            continue;
+        }
+        if (bucket.profile > header.profileCount || bucket.kind > KEY_USB_VERSION ||
+            (bucket.kind == KEY_NAME && (bucket.key % 2 != 0 ||
+                                         static_cast<uint64_t>(bucket.key) + bucket.keyLength * 2ull > header.stringBytes))) {
+            return fail("bad profile blob key " + std::to_string(i));
+        }
+    }
+    // probe() stops at the first empty bucket; a full index would never miss
+    if (emptyBuckets == 0) {
+        return fail("profile blob index has no empty bucket");
+    }
+    for (uint32_t i = 0; i < header.profileCount; ++i) {
+        const Profile& profile = profiles[i];
+        if (static_cast<uint64_t>(profile.nameOffset) + profile.nameLength > header.stringBytes) {
+            return fail("bad profile blob name " + std::to_string(i));
+        }
+        for (const auto& axis : profile.axes) {
+            if (axis.target > AXIS_RIGHT_TRIGGER || axis.mode > AXIS_FIXED) {
+                return fail("bad profile blob axis in profile " + std::to_string(i));
+            }
+        }
+    }
+
+    m_buckets = buckets;
+    m_bucketCount = header.bucketCount;
+    m_profiles = profiles;
+    m_profileCount = header.profileCount;
+    m_strings = strings;
+    m_stringBytes = header.stringBytes;
+    m_sourceStamp = header.sourceStamp;
+    return true;
+}
+
+const ProfileLibrary::Profile* ProfileLibrary::probe(uint64_t hash, uint32_t kind, uint32_t usbId, uint32_t version,
+                                                     const std::wstring* name) const {
+    const uint32_t mask = m_bucketCount - 1;
+    uint32_t slot = static_cast<uint32_t>(hash) & mask;
+    for (uint32_t step = 0; step < m_bucketCount; ++step, slot = (slot + 1) & mask) {
+        const Bucket& bucket = m_buckets[slot];
+        if (bucket.profile == 0) {
+            return nullptr;
+        }
+        if (bucket.hash != hash || bucket.kind != kind) {
+            continue;
+        }
+        if (kind != KEY_NAME) {
+            if (bucket.key == usbId && bucket.keyLength == version) return &m_profiles[bucket.profile - 1];
+            continue;
+        }
+        // Offsets were checked in adopt(): even and inside the 8-aligned string table
+        const uint16_t* units = reinterpret_cast<const uint16_t*>(m_strings + bucket.key);
+        uint32_t length = 0;
+        const bool same = forEachUnit(*name, [&](uint16_t unit) {
+            return length < bucket.keyLength && units[length++] == unit;
+        });
+        if (same && length == bucket.keyLength) {
+            return &m_profiles[bucket.profile - 1];
+        }
+    }
+    return nullptr;
+}
+
+const ProfileLibrary::Profile* ProfileLibrary::find(uint16_t vendorId, uint16_t productId,
+                                                    const std::wstring& productName, uint16_t version) const {
+    if (m_bucketCount == 0) {
+        return nullptr;
+    }
+    if (vendorId != 0 || productId != 0) {
+        const uint32_t usbId = static_cast<uint32_t>(vendorId) << 16 | productId;
+        if (version != 0) {
+            const uint64_t hash = hashUsbVersion(vendorId, productId, version);
+            if (const Profile* profile = probe(hash, KEY_USB_VERSION, usbId, version, nullptr)) {
+                return profile;
+            }
+        }
+        if (const Profile* profile = probe(hashUsb(vendorId, productId), KEY_USB, usbId, 0, nullptr)) {
+            return profile;
+        }
+    }
+    if (productName.empty()) {
+        return nullptr;
+    }
+    uint64_t hash = NAME_HASH_SEED;
+    forEachUnit(productName, [&hash](uint16_t unit) {
+        hash = hashUnit(hash, unit);
+        return true;
+    });
+    return probe(hash, KEY_NAME, 0, 0, &productName);
+}
+
+std::string ProfileLibrary::getName(const Profile& profile) const {
+    return std::string(reinterpret_cast<const char*>(m_strings + profile.nameOffset), profile.nameLength);
+}
@@ -0,0 +1,817 @@
+#include "core/recording_container.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+namespace {
+
+using Sample = SessionRecording::Sample;
+using SourceKind = SessionRecording::SourceKind;
+
+const char FILE_MAGIC[8] = {'X', 'I', 'D', 'P', 'R', 'E', 'C', '\0'};
+const char CHUNK_MAGIC[4] = {'X', 'C', 'N', 'K'};
+const char INDEX_MAGIC[8] = {'X', 'I', 'D', 'P', 'I', 'D', 'X', '\0'};
+
+constexpr size_t FILE_HEADER_SIZE = 16;     // Magic, version, metadata length
+constexpr size_t CHUNK_HEADER_SIZE = 32;
+constexpr size_t INDEX_ENTRY_SIZE = 28;
+constexpr size_t TRAILER_SIZE = 28;
+
+// XInput field mask
+constexpr uint8_t X_PACKET = 0x01;
+constexpr uint8_t X_BUTTONS = 0x02;
+constexpr uint8_t X_LEFT_TRIGGER = 0x04;
+constexpr uint8_t X_RIGHT_TRIGGER = 0x08;
+constexpr uint8_t X_LEFT_X = 0x10;
+constexpr uint8_t X_LEFT_Y = 0x20;
+constexpr uint8_t X_RIGHT_X = 0x40;
+constexpr uint8_t X_RIGHT_Y = 0x80;
+
+// HID field mask
+constexpr uint8_t H_BUTTONS = 0x01;         // New button list
+constexpr uint8_t H_VALUE_LIST = 0x02;      // New value usages (and values)
+constexpr uint8_t H_VALUES = 0x04;          // Same usages, changed values (bitmap + deltas)
+constexpr uint8_t H_REPORT = 0x08;          // New report bytes
+constexpr uint8_t H_REPORT_PATCH = 0x10;    // Same length, changed bytes (bitmap + bytes)
+
+uint32_t fnv1a(const uint8_t* data, size_t length) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; ++i) {
+        hash ^= data[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+uint64_t zigzag(int64_t value) {
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+int64_t unzigzag(uint64_t value) {
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+void putVarint(std::vector<uint8_t>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+void putSigned(std::vector<uint8_t>& out, int64_t value) {
+    putVarint(out, zigzag(value));
+}
+
+void putFixed(std::vector<uint8_t>& out, uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; ++i) {
+        out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+}
+
+uint64_t getFixed(const uint8_t* data, int bytes) {
+    uint64_t value = 0;
+    for (int i = 0; i < bytes; ++i) {
+        value |= static_cast<uint64_t>(data[i]) << (8 * i);
+    }
+    return value;
+}
+
+/**
+ * Bounds-checked payload reader; any overrun or bad varint sets failed
+ */
+struct Reader {
+    const uint8_t* data;
+    size_t length;
+    size_t& offset;
+    bool failed = false;
+
+    uint8_t byte() {
+        if (offset >= length) {
+            failed = true;
+            return 0;
+        }
+        return data[offset++];
+    }
+    uint64_t varint() {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            uint8_t b = byte();
+            value |= static_cast<uint64_t>(b & 0x7F) << shift;
+            if (!(b & 0x80)) return value;
+        }
+        failed = true;
+        return 0;
+    }
+    int64_t signedVarint() {
+        return unzigzag(varint());
+    }
+    // Element counts are bounded by what is left, so a corrupt count can't allocate gigabytes
+    size_t count() {
+        uint64_t value = varint();
+        if (value > length - std::min(offset, length)) {
+            failed = true;
+            return 0;
+        }
+        return static_cast<size_t>(value);
+    }
+};
+
+void putBitmap(std::vector<uint8_t>& out, const std::vector<bool>& bits) {
+    for (size_t i = 0; i < bits.size(); i += 8) {
+        uint8_t byte = 0;
+        for (size_t b = 0; b < 8 && i + b < bits.size(); ++b) {
+            if (bits[i + b]) byte |= static_cast<uint8_t>(1u << b);
+        }
+        out.push_back(byte);
+    }
+}
+
+std::vector<bool> getBitmap(Reader& reader, size_t count) {
+    std::vector<bool> bits(count, false);
+    for (size_t i = 0; i < count; i += 8) {
+        uint8_t byte = reader.byte();
+        for (size_t b = 0; b < 8 && i + b < count; ++b) {
+            bits[i + b] = (byte >> b) & 1;
+        }
+    }
+    return bits;
+}
+
+bool sameUsages(const std::vector<std::pair<USAGE, LONG>>& a, const std::vector<std::pair<USAGE, LONG>>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a[i].first != b[i].first) return false;
+    }
+    return true;
+}
+
+void encodeSample(std::vector<uint8_t>& out, SourceKind kind, const Sample& previous, const Sample& sample) {
+    if (kind == SourceKind::XINPUT) {
+        const XINPUT_GAMEPAD& a = previous.gamepad;
+        const XINPUT_GAMEPAD& b = sample.gamepad;
+        uint8_t mask = 0;
+        if (sample.packetNumber != previous.packetNumber) mask |= X_PACKET;
+        if (b.wButtons != a.wButtons) mask |= X_BUTTONS;
+        if (b.bLeftTrigger != a.bLeftTrigger) mask |= X_LEFT_TRIGGER;
+        if (b.bRightTrigger != a.bRightTrigger) mask |= X_RIGHT_TRIGGER;
+        if (b.sThumbLX != a.sThumbLX) mask |= X_LEFT_X;
+        if (b.sThumbLY != a.sThumbLY) mask |= X_LEFT_Y;
+        if (b.sThumbRX != a.sThumbRX) mask |= X_RIGHT_X;
+        if (b.sThumbRY != a.sThumbRY) mask |= X_RIGHT_Y;
+        out.push_back(mask);
+        if (mask & X_PACKET) putSigned(out, static_cast<int64_t>(sample.packetNumber) - previous.packetNumber);
+        if (mask & X_BUTTONS) putVarint(out, static_cast<uint16_t>(b.wButtons ^ a.wButtons));
+        if (mask & X_LEFT_TRIGGER) putSigned(out, b.bLeftTrigger - a.bLeftTrigger);
+        if (mask & X_RIGHT_TRIGGER) putSigned(out, b.bRightTrigger - a.bRightTrigger);
+        if (mask & X_LEFT_X) putSigned(out, b.sThumbLX - a.sThumbLX);
+        if (mask & X_LEFT_Y) putSigned(out, b.sThumbLY - a.sThumbLY);
+        if (mask & X_RIGHT_X) putSigned(out, b.sThumbRX - a.sThumbRX);
+        if (mask & X_RIGHT_Y) putSigned(out, b.sThumbRY - a.sThumbRY);
+        return;
+    }
+
+    uint8_t mask = 0;
+    if (sample.buttons != previous.buttons) mask |= H_BUTTONS;
+    bool usagesSame = sameUsages(sample.values, previous.values);
+    if (!usagesSame) {
+        mask |= H_VALUE_LIST;
+    } else if (sample.values != previous.values) {
+        mask |= H_VALUES;
+    }
+    if (sample.report != previous.report) {
+        mask |= (sample.report.size() == previous.report.size()) ? H_REPORT_PATCH : H_REPORT;
+    }
+    out.push_back(mask);
+
+    if (mask & H_BUTTONS) {
+        putVarint(out, sample.buttons.size());
+        int64_t last = 0;
+        for (USAGE usage : sample.buttons) {
+            putSigned(out, static_cast<int64_t>(usage) - last);
+            last = usage;
+        }
+    }
+    if (mask & H_VALUE_LIST) {
+        putVarint(out, sample.values.size());
+        int64_t last = 0;
+        for (const auto& [usage, value] : sample.values) {
+            putSigned(out, static_cast<int64_t>(usage) - last);
+            putSigned(out, value);
+            last = usage;
+        }
+    }
+    if (mask & H_VALUES) {
+        std::vector<bool> changed(sample.values.size());
+        for (size_t i = 0; i < changed.size(); ++i) {
+            changed[i] = sample.values[i].second != previous.values[i].second;
+        }
+        putBitmap(out, changed);
+        for (size_t i = 0; i < changed.size(); ++i) {
+            if (changed[i]) putSigned(out, static_cast<int64_t>(sample.values[i].second) - previous.values[i].second);
+        }
+    }
+    if (mask & H_REPORT) {
+        putVarint(out, sample.report.size());
+        out.insert(out.end(), sample.report.begin(), sample.report.end());
+    }
+    if (mask & H_REPORT_PATCH) {
+        std::vector<bool> changed(sample.report.size());
+        for (size_t i = 0; i < changed.size(); ++i) {
+            changed[i] = sample.report[i] != previous.report[i];
+        }
+        putBitmap(out, changed);
+        for (size_t i = 0; i < changed.size(); ++i) {
+            if (changed[i]) out.push_back(sample.report[i]);
+        }
+    }
+}
+
+// sample may be previous itself (decoding in place)
+void decodeSample(Reader& reader, SourceKind kind, const Sample& previous, Sample& sample) {
+    if (&sample != &previous) {
+        sample = previous;
+    }
+    uint8_t mask = reader.byte();
+    if (kind == SourceKind::XINPUT) {
+        XINPUT_GAMEPAD& g = sample.gamepad;
+        if (mask & X_PACKET) sample.packetNumber = static_cast<DWORD>(previous.packetNumber + reader.signedVarint());
+        if (mask & X_BUTTONS) g.wButtons = static_cast<WORD>(g.wButtons ^ reader.varint());
+        if (mask & X_LEFT_TRIGGER) g.bLeftTrigger = static_cast<BYTE>(g.bLeftTrigger + reader.signedVarint());
+        if (mask & X_RIGHT_TRIGGER) g.bRightTrigger = static_cast<BYTE>(g.bRightTrigger + reader.signedVarint());
+        if (mask & X_LEFT_X) g.sThumbLX = static_cast<SHORT>(g.sThumbLX + reader.signedVarint());
+        if (mask & X_LEFT_Y) g.sThumbLY = static_cast<SHORT>(g.sThumbLY + reader.signedVarint());
+        if (mask & X_RIGHT_X) g.sThumbRX = static_cast<SHORT>(g.sThumbRX + reader.signedVarint());
+        if (mask & X_RIGHT_Y) g.sThumbRY = static_cast<SHORT>(g.sThumbRY + reader.signedVarint());
+        return;
+    }
+
+    if (mask & H_BUTTONS) {
+        sample.buttons.resize(reader.count());
+        int64_t last = 0;
+        for (auto& usage : sample.buttons) {
+            last += reader.signedVarint();
+            usage = static_cast<USAGE>(last);
+        }
+    }
+    if (mask & H_VALUE_LIST) {
+        sample.values.resize(reader.count());
+        int64_t last = 0;
+        for (auto& [usage, value] : sample.values) {
+            last += reader.signedVarint();
+            usage = static_cast<USAGE>(last);
+            value = static_cast<LONG>(reader.signedVarint());
+        }
+    }
+    if (mask & H_VALUES) {
+        std::vector<bool> changed = getBitmap(reader, sample.values.size());
+        for (size_t i = 0; i < changed.size(); ++i) {
+            if (changed[i]) sample.values[i].second = static_cast<LONG>(sample.values[i].second + reader.signedVarint());
+        }
+    }
+    if (mask & H_REPORT) {
+        sample.report.resize(reader.count());
+        for (auto& byte : sample.report) byte = reader.byte();
+    }
+    if (mask & H_REPORT_PATCH) {
+        std::vector<bool> changed = getBitmap(reader, sample.report.size());
+        for (size_t i = 0; i < changed.size(); ++i) {
+            if (changed[i]) sample.report[i] = reader.byte();
+        }
+    }
+}
+
+Sample emptySample(size_t device) {
+    Sample sample;
+    sample.device = device;
+    return sample;
+}
+
+bool readExact(std::istream& in, uint64_t offset, uint8_t* data, size_t length) {
+    in.clear();
+    in.seekg(static_cast<std::streamoff>(offset));
+    in.read(reinterpret_cast<char*>(data), static_cast<std::streamsize>(length));
+    return static_cast<size_t>(in.gcount()) == length;
+}
+
+} // namespace
+
+RecordingWriter::RecordingWriter(std::ostream& out, const SessionRecording& session)
+    : RecordingWriter(out, session, Options()) {
+}
+
+RecordingWriter::RecordingWriter(std::ostream& out, const SessionRecording& session, const Options& options)
+    : m_out(out),
+      m_options(options),
+      m_seen(session.devices.size(), false),
+      m_chunkFrames(0),
+      m_chunkFirstUs(0),
+      m_previousUs(0),
+      m_finished(false) {
+    for (size_t i = 0; i < session.devices.size(); ++i) {
+        m_kinds.push_back(session.devices[i].kind);
+        m_last.push_back(emptySample(i));
+    }
+    m_options.chunkFrames = std::max<uint32_t>(1, m_options.chunkFrames);
+
+    // Metadata is the text format's header, so both formats describe devices the same way
+    SessionRecording metadata;
+    metadata.options = session.options;
+    metadata.devices = session.devices;
+    std::ostringstream text;
+    metadata.write(text);
+    std::string lines = text.str();
+
+    std::vector<uint8_t> header(FILE_MAGIC, FILE_MAGIC + sizeof(FILE_MAGIC));
+    putFixed(header, FORMAT_VERSION, 4);
+    putFixed(header, lines.size(), 4);
+    header.insert(header.end(), lines.begin(), lines.end());
+    m_out.write(reinterpret_cast<const char*>(header.data()), static_cast<std::streamsize>(header.size()));
+    m_stats.bytes += header.size();
+}
+
+bool RecordingWriter::append(const SessionRecording::Frame& frame) {
+    if (m_finished || (m_stats.frames > 0 && frame.timeUs < m_previousUs)) {
+        return false;
+    }
+    for (const auto& sample : frame.samples) {
+        if (sample.device >= m_kinds.size()) {
+            return false;
+        }
+    }
+
+    if (m_chunkFrames == 0) {
+        // Keyframe: what every device last reported, so the chunk needs nothing before it
+        m_chunk.clear();
+        m_chunkFirstUs = frame.timeUs;
+        m_previousUs = frame.timeUs;
+        m_chunkLast.clear();
+        size_t known = static_cast<size_t>(std::count(m_seen.begin(), m_seen.end(), true));
+        putVarint(m_chunk, known);
+        for (size_t device = 0; device < m_kinds.size(); ++device) {
+            m_chunkLast.push_back(m_seen[device] ? m_last[device] : emptySample(device));
+            if (m_seen[device]) {
+                putVarint(m_chunk, device);
+                encodeSample(m_chunk, m_kinds[device], emptySample(device), m_last[device]);
+            }
+        }
+    }
+
+    putVarint(m_chunk, frame.timeUs - m_previousUs);
+    putVarint(m_chunk, frame.samples.size());
+    for (const auto& sample : frame.samples) {
+        putVarint(m_chunk, sample.device);
+        encodeSample(m_chunk, m_kinds[sample.device], m_chunkLast[sample.device], sample);
+        m_chunkLast[sample.device] = sample;
+        m_last[sample.device] = sample;
+        m_seen[sample.device] = true;
+    }
+    m_previousUs = frame.timeUs;
+    m_chunkFrames++;
+    m_stats.frames++;
+    m_stats.samples += frame.samples.size();
+
+    if (m_chunkFrames >= m_options.chunkFrames || m_chunk.size() >= m_options.chunkBytes) {
+        flushChunk();
+    }
+    return true;
+}
+
+void RecordingWriter::flushChunk() {
+    if (m_chunkFrames == 0) {
+        return;
+    }
+    std::vector<uint8_t> header(CHUNK_MAGIC, CHUNK_MAGIC + sizeof(CHUNK_MAGIC));
+    putFixed(header, m_chunk.size(), 4);
+    putFixed(header, m_chunkFrames, 4);
+    putFixed(header, m_chunkFirstUs, 8);
+    putFixed(header, m_previousUs, 8);
+    putFixed(header, fnv1a(m_chunk.data(), m_chunk.size()), 4);
+    m_out.write(reinterpret_cast<const char*>(header.data()), static_cast<std::streamsize>(header.size()));
+    m_out.write(reinterpret_cast<const char*>(m_chunk.data()), static_cast<std::streamsize>(m_chunk.size()));
+
+    m_index.push_back(ChunkInfo{m_stats.bytes, m_chunkFirstUs, m_previousUs, m_chunkFrames});
+    m_stats.bytes += header.size() + m_chunk.size();
+    m_stats.chunks++;
+    m_chunkFrames = 0;
+    m_chunk.clear();
+}
+
+bool RecordingWriter::finish() {
+    if (m_finished) {
+        return false;
+    }
+    flushChunk();
+    m_finished = true;
+
+    std::vector<uint8_t> footer;
+    for (const auto& chunk : m_index) {
+        putFixed(footer, chunk.offset, 8);
+        putFixed(footer, chunk.firstTimeUs, 8);
+        putFixed(footer, chunk.lastTimeUs, 8);
+        putFixed(footer, chunk.frames, 4);
+    }
+    putFixed(footer, m_stats.bytes, 8);
+    putFixed(footer, m_index.size(), 4);
+    putFixed(footer, m_stats.frames, 8);
+    footer.insert(footer.end(), INDEX_MAGIC, INDEX_MAGIC + sizeof(INDEX_MAGIC));
+    m_out.write(reinterpret_cast<const char*>(footer.data()), static_cast<std::streamsize>(footer.size()));
+    m_stats.bytes += footer.size();
+    m_out.flush();
+    return m_out.good();
+}
+
+bool RecordingWriter::write(const SessionRecording& recording, std::ostream& out, const Options& options) {
+    RecordingWriter writer(out, recording, options);
+    for (const auto& frame : recording.frames) {
+        if (!writer.append(frame)) {
+            return false;
+        }
+    }
+    return writer.finish();
+}
+
+bool RecordingWriter::write(const SessionRecording& recording, std::ostream& out) {
+    return write(recording, out, Options());
+}
+
+bool RecordingWriter::save(const SessionRecording& recording, const std::string& path, const Options& options) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    return out && write(recording, out, options);
+}
+
+bool RecordingWriter::save(const SessionRecording& recording, const std::string& path) {
+    return save(recording, path, Options());
+}
+
+RecordingReader::RecordingReader()
+    : m_in(nullptr),
+      m_data(nullptr),
+      m_size(0),
+      m_frameCount(0),
+      m_recovered(false),
+      m_nextChunk(0),
+      m_payloadData(nullptr),
+      m_payloadSize(0),
+      m_offset(0),
+      m_framesLeft(0),
+      m_previousUs(0),
+      m_hasPeeked(false) {
+}
+
+bool RecordingReader::fail(const std::string& reason) {
+    m_error = reason;
+    return false;
+}
+
+bool RecordingReader::isContainer(std::istream& in) {
+    char magic[sizeof(FILE_MAGIC)] = {};
+    in.read(magic, sizeof(magic));
+    bool match = in.gcount() == static_cast<std::streamsize>(sizeof(magic)) &&
+                 std::memcmp(magic, FILE_MAGIC, sizeof(magic)) == 0;
+    in.clear();
+    in.seekg(0);
+    return match;
+}
+
+bool RecordingReader::readAt(uint64_t offset, uint8_t* data, size_t length) const {
+    if (m_data) {
+        if (offset > m_size || length > m_size - offset) {
+            return false;
+        }
+        std::memcpy(data, m_data + offset, length);
+        return true;
+    }
+    return m_in && readExact(*m_in, offset, data, length);
+}
+
+bool RecordingReader::open(std::istream& in, std::string* error) {
+    m_in = &in;
+    m_data = nullptr;
+    in.clear();
+    in.seekg(0, std::ios::end);
+    m_size = static_cast<uint64_t>(in.tellg());
+    return openContainer(error);
+}
+
+bool RecordingReader::open(const uint8_t* data, size_t size, std::string* error) {
+    m_in = nullptr;
+    m_data = data;
+    m_size = size;
+    return openContainer(error);
+}
+
+bool RecordingReader::openContainer(std::string* error) {
+    m_chunks.clear();
+    m_frameCount = 0;
+    m_recovered = false;
+    m_error.clear();
+    auto failOpen = [&](const std::string& reason) {
+        m_error = reason;
+        if (error) *error = reason;
+        return false;
+    };
+
+    uint8_t header[FILE_HEADER_SIZE];
+    if (!readAt(0, header, sizeof(header)) || std::memcmp(header, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0) {
+        return failOpen("not a recording container");
+    }
+    if (getFixed(header + 8, 4) != RecordingWriter::FORMAT_VERSION) {
+        return failOpen("unsupported container version " + std::to_string(getFixed(header + 8, 4)));
+    }
+    uint64_t metadataLength = getFixed(header + 12, 4);
+    if (metadataLength > m_size - FILE_HEADER_SIZE) {
+        return failOpen("truncated metadata");
+    }
+    std::string lines(static_cast<size_t>(metadataLength), '\0');
+    if (!readAt(FILE_HEADER_SIZE, reinterpret_cast<uint8_t*>(&lines[0]), lines.size())) {
+        return failOpen("truncated metadata");
+    }
+    std::istringstream text(lines);
+    std::string reason;
+    m_session = SessionRecording();
+    if (!m_session.parse(text, &reason)) {
+        return failOpen("metadata " + reason);
+    }
+    uint64_t dataStart = FILE_HEADER_SIZE + lines.size();
+
+    // Index from the trailer; a writer that never finished left none, so scan
+    uint8_t trailer[TRAILER_SIZE];
+    bool indexed = false;
+    if (m_size >= dataStart + TRAILER_SIZE && readAt(m_size - TRAILER_SIZE, trailer, sizeof(trailer)) &&
+        std::memcmp(trailer + 20, INDEX_MAGIC, sizeof(INDEX_MAGIC)) == 0) {
+        uint64_t indexOffset = getFixed(trailer, 8);
+        uint64_t count = getFixed(trailer + 8, 4);
+        if (indexOffset >= dataStart && indexOffset + count * INDEX_ENTRY_SIZE + TRAILER_SIZE == m_size) {
+            std::vector<uint8_t> entries(static_cast<size_t>(count * INDEX_ENTRY_SIZE));
+            if (readAt(indexOffset, entries.data(), entries.size())) {
+                for (size_t i = 0; i < count; ++i) {
+                    const uint8_t* entry = entries.data() + i * INDEX_ENTRY_SIZE;
+                    Chunk chunk;
+                    chunk.offset = getFixed(entry, 8);
+                    chunk.firstTimeUs = getFixed(entry + 8, 8);
+                    chunk.lastTimeUs = getFixed(entry + 16, 8);
+                    chunk.frames = static_cast<uint32_t>(getFixed(entry + 24, 4));
+                    m_chunks.push_back(chunk);
+                    m_frameCount += chunk.frames;
+                }
+                indexed = true;
+            }
+        }
+    }
+    if (!indexed) {
+        scanChunks(dataStart, m_size);
+        m_recovered = true;
+    }
+
+    m_nextChunk = 0;
+    m_framesLeft = 0;
+    m_hasPeeked = false;
+    return true;
+}
+
+void RecordingReader::scanChunks(uint64_t from, uint64_t end) {
+    std::vector<uint8_t> payload;
+    uint64_t offset = from;
+    while (offset + CHUNK_HEADER_SIZE <= end) {
+        uint8_t header[CHUNK_HEADER_SIZE];
+        if (!readAt(offset, header, sizeof(header)) || std::memcmp(header, CHUNK_MAGIC, sizeof(CHUNK_MAGIC)) != 0) {
+            break;
+        }
+        uint64_t length = getFixed(header + 4, 4);
+        if (offset + CHUNK_HEADER_SIZE + length > end) {
+            break;   // Cut off mid-chunk
+        }
+        payload.resize(static_cast<size_t>(length));
+        if (!readAt(offset + CHUNK_HEADER_SIZE, payload.data(), payload.size()) ||
+            fnv1a(payload.data(), payload.size()) != getFixed(header + 28, 4)) {
+            break;
+        }
+        Chunk chunk;
+        chunk.offset = offset;
+        chunk.frames = static_cast<uint32_t>(getFixed(header + 8, 4));
+        chunk.firstTimeUs = getFixed(header + 12, 8);
+        chunk.lastTimeUs = getFixed(header + 20, 8);
+        m_chunks.push_back(chunk);
+        m_frameCount += chunk.frames;
+        offset += CHUNK_HEADER_SIZE + length;
+    }
+}
+
+bool RecordingReader::readChunk(size_t index, std::vector<uint8_t>& buffer, ChunkView& view, std::string& error) const {
+    const Chunk& chunk = m_chunks[index];
+    uint8_t header[CHUNK_HEADER_SIZE];
+    if (!readAt(chunk.offset, header, sizeof(header)) || std::memcmp(header, CHUNK_MAGIC, sizeof(CHUNK_MAGIC)) != 0) {
+        error = "chunk " + std::to_string(index) + ": bad header";
+        return false;
+    }
+    view.length = static_cast<size_t>(getFixed(header + 4, 4));
+    view.frames = static_cast<uint32_t>(getFixed(header + 8, 4));
+    view.firstTimeUs = getFixed(header + 12, 8);
+    const uint64_t payloadOffset = chunk.offset + CHUNK_HEADER_SIZE;
+    bool complete;
+    if (m_data) {
+        // Decoded straight from the mapping, no copy
+        complete = payloadOffset <= m_size && view.length <= m_size - payloadOffset;
+        view.payload = complete ? m_data + payloadOffset : nullptr;
+    } else {
+        buffer.resize(view.length);
+        complete = readAt(payloadOffset, buffer.data(), buffer.size());
+        view.payload = buffer.data();
+    }
+    if (!complete || fnv1a(view.payload, view.length) != getFixed(header + 28, 4)) {
+        error = "chunk " + std::to_string(index) + ": checksum mismatch";
+        return false;
+    }
+    return true;
+}
+
+bool RecordingReader::decodeKeyframe(const ChunkView& view, size_t& offset, std::vector<Sample>& last,
+                                     std::vector<bool>& known) const {
+    const size_t deviceCount = m_session.devices.size();
+    last.clear();
+    for (size_t device = 0; device < deviceCount; ++device) {
+        last.push_back(emptySample(device));
+    }
+    known.assign(deviceCount, false);
+
+    Reader reader{view.payload, view.length, offset};
+    size_t count = reader.count();
+    for (size_t i = 0; i < count && !reader.failed; ++i) {
+        size_t device = static_cast<size_t>(reader.varint());
+        if (device >= deviceCount) {
+            return false;
+        }
+        decodeSample(reader, m_session.devices[device].kind, emptySample(device), last[device]);
+        known[device] = true;
+    }
+    return !reader.failed;
+}
+
+bool RecordingReader::loadChunk(size_t index) {
+    ChunkView view;
+    std::string reason;
+    if (!readChunk(index, m_payload, view, reason)) {
+        return fail(reason);
+    }
+    m_payloadData = view.payload;
+    m_payloadSize = view.length;
+    m_offset = 0;
+    m_framesLeft = view.frames;
+    m_previousUs = view.firstTimeUs;
+    if (!decodeKeyframe(view, m_offset, m_last, m_known)) {
+        return fail("chunk " + std::to_string(index) + ": damaged keyframe");
+    }
+    return true;
+}
+
+bool RecordingReader::decodeFrame(SessionRecording::Frame& frame) {
+    Reader reader{m_payloadData, m_payloadSize, m_offset};
+    frame.timeUs = m_previousUs + reader.varint();
+    frame.samples.resize(reader.count());
+    for (auto& sample : frame.samples) {
+        size_t device = static_cast<size_t>(reader.varint());
+        if (reader.failed || device >= m_last.size()) {
+            return fail("damaged frame at " + std::to_string(m_previousUs) + " us");
+        }
+        decodeSample(reader, m_session.devices[device].kind, m_last[device], sample);
+        m_last[device] = sample;
+        m_known[device] = true;
+    }
+    if (reader.failed) {
+        return fail("damaged frame at " + std::to_string(m_previousUs) + " us");
+    }
+    m_previousUs = frame.timeUs;
+    m_framesLeft--;
+    return true;
+}
+
+bool RecordingReader::visitChunk(size_t index, const SampleVisitor& visit, std::string* error) const {
+    std::vector<uint8_t> buffer;
+    ChunkView view;
+    std::string reason;
+    if (index >= m_chunks.size() || !readChunk(index, buffer, view, reason)) {
+        if (error) *error = index >= m_chunks.size() ? "no chunk " + std::to_string(index) : reason;
+        return false;
+    }
+    size_t offset = 0;
+    std::vector<Sample> last;
+    std::vector<bool> known;
+    if (!decodeKeyframe(view, offset, last, known)) {
+        if (error) *error = "chunk " + std::to_string(index) + ": damaged keyframe";
+        return false;
+    }
+
+    // Samples are decoded over the device's previous one, so nothing is allocated per frame
+    Reader reader{view.payload, view.length, offset};
+    uint64_t timeUs = view.firstTimeUs;
+    for (uint32_t f = 0; f < view.frames; ++f) {
+        timeUs += reader.varint();
+        size_t samples = reader.count();
+        for (size_t s = 0; s < samples; ++s) {
+            size_t device = static_cast<size_t>(reader.varint());
+            if (reader.failed || device >= last.size()) {
+                reader.failed = true;
+                break;
+            }
+            decodeSample(reader, m_session.devices[device].kind, last[device], last[device]);
+            visit(timeUs, last[device]);
+        }
+        if (reader.failed) {
+            if (error) *error = "damaged frame at " + std::to_string(timeUs) + " us";
+            return false;
+        }
+    }
+    return true;
+}
+
+bool RecordingReader::next(SessionRecording::Frame& frame) {
+    if ((!m_in && !m_data) || !m_error.empty()) {
+        return false;
+    }
+    if (m_hasPeeked) {
+        frame = std::move(m_peeked);
+        m_hasPeeked = false;
+        return true;
+    }
+    while (m_framesLeft == 0) {
+        if (m_nextChunk >= m_chunks.size() || !loadChunk(m_nextChunk++)) {
+            return false;
+        }
+    }
+    return decodeFrame(frame);
+}
+
+bool RecordingReader::seek(uint64_t timeUs) {
+    if (!m_in && !m_data) {
+        return false;
+    }
+    m_error.clear();
+    m_hasPeeked = false;
+    m_framesLeft = 0;
+
+    // First chunk that ends at or after the target
+    auto it = std::lower_bound(m_chunks.begin(), m_chunks.end(), timeUs,
+                               [](const Chunk& chunk, uint64_t time) { return chunk.lastTimeUs < time; });
+    m_nextChunk = static_cast<size_t>(it - m_chunks.begin());
+    if (it == m_chunks.end()) {
+        return true;   // Past the end: next() returns false
+    }
+    if (!loadChunk(m_nextChunk++)) {
+        return false;
+    }
+
+    SessionRecording::Frame frame;
+    while (m_framesLeft > 0) {
+        if (!decodeFrame(frame)) {
+            return false;
+        }
+        if (frame.timeUs >= timeUs) {
+            // Prepend the state of every other device so replay starts from it
+            std::vector<bool> inFrame(m_last.size(), false);
+            for (const auto& sample : frame.samples) inFrame[sample.device] = true;
+            std::vector<Sample> state;
+            for (size_t device = 0; device < m_last.size(); ++device) {
+                if (m_known[device] && !inFrame[device]) state.push_back(m_last[device]);
+            }
+            frame.samples.insert(frame.samples.begin(), state.begin(), state.end());
+            m_peeked = std::move(frame);
+            m_hasPeeked = true;
+            return true;
+        }
+    }
+    return true;
+}
+
+bool RecordingReader::readAll(SessionRecording& recording, std::string* error) {
+    recording.options = m_session.options;
+    recording.devices = m_session.devices;
+    recording.frames.clear();
+    recording.frames.reserve(static_cast<size_t>(m_frameCount));
+    m_error.clear();
+    m_nextChunk = 0;
+    m_framesLeft = 0;
+    m_hasPeeked = false;
+
+    SessionRecording::Frame frame;
+    while (next(frame)) {
+        recording.frames.push_back(std::move(frame));
+    }
+    if (!m_error.empty()) {
+        if (error) *error = m_error;
+        return false;
+    }
+    return true;
+}
+
+bool RecordingReader::load(const std::string& path, SessionRecording& recording, std::string* error) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        if (error) *error = "cannot open " + path;
+        return false;
+    }
+    RecordingReader reader;
+    return reader.open(in, error) && reader.readAll(recording, error);
+}
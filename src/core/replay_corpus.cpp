@@ -0,0 +1,125 @@
+#include "core/replay_corpus.hpp"
+#include "core/recording_container.hpp"
+#include "core/session_recording.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <iomanip>
+
+namespace {
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+ReplayCorpus::ReplayCorpus(size_t workers, size_t maxMismatches)
+    : m_pool(workers),
+      m_maxMismatches(maxMismatches) {
+}
+
+bool ReplayCorpus::addDirectory(const std::string& path, std::string* error) {
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    std::vector<fs::path> files;
+    for (const auto& entry : fs::directory_iterator(path, ec)) {
+        if (entry.path().extension() == ".rec" || entry.path().extension() == ".xrec") {
+            files.push_back(entry.path());
+        }
+    }
+    if (ec) {
+        if (error) *error = path + ": " + ec.message();
+        return false;
+    }
+    if (files.empty()) {
+        if (error) *error = "no recordings in " + path;
+        return false;
+    }
+    std::sort(files.begin(), files.end());
+    for (const auto& file : files) {
+        Entry entry;
+        entry.name = file.stem().string();
+        entry.recordingPath = file.string();
+        entry.goldenPath = fs::path(file).replace_extension(".golden").string();
+        add(entry);
+    }
+    return true;
+}
+
+void ReplayCorpus::add(const Entry& entry) {
+    m_entries.push_back(entry);
+}
+
+ReplayCorpus::Outcome ReplayCorpus::runOne(const Entry& entry) const {
+    const auto start = std::chrono::steady_clock::now();
+    Outcome outcome;
+    outcome.name = entry.name;
+
+    SessionRecording recording;
+    GoldenOutput actual, golden;
+    std::string reason;
+    const bool container = std::filesystem::path(entry.recordingPath).extension() == ".xrec";
+    bool loaded = container ? RecordingReader::load(entry.recordingPath, recording, &reason)
+                            : recording.load(entry.recordingPath, &reason);
+    if (!loaded || !GoldenOutput::render(recording, actual, &reason) || !golden.load(entry.goldenPath, &reason)) {
+        outcome.error = reason.empty() ? "cannot replay" : reason;
+    } else {
+        outcome.mismatches = golden.compare(actual, m_maxMismatches);
+        outcome.passed = outcome.mismatches.empty();
+    }
+    outcome.frames = recording.frames.size();
+    outcome.records = actual.records.size();
+    outcome.seconds = secondsSince(start);
+    return outcome;
+}
+
+ReplayCorpus::Summary ReplayCorpus::run() {
+    const auto start = std::chrono::steady_clock::now();
+    Summary summary;
+    summary.threads = m_pool.getWorkerCount() + 1;
+    summary.outcomes.resize(m_entries.size());
+
+    // Each task writes only its own slot: the order is the corpus order, not the finishing order
+    m_pool.parallelFor(m_entries.size(), [this, &summary](size_t index) {
+        summary.outcomes[index] = runOne(m_entries[index]);
+    });
+
+    for (const auto& outcome : summary.outcomes) {
+        (outcome.passed ? summary.passed : summary.failed)++;
+        summary.frames += outcome.frames;
+        summary.busySeconds += outcome.seconds;
+    }
+    summary.seconds = secondsSince(start);
+    return summary;
+}
+
+void ReplayCorpus::writeReport(const Summary& summary, std::ostream& out) {
+    const std::ios::fmtflags flags = out.flags();
+    size_t width = 8;
+    for (const auto& outcome : summary.outcomes) {
+        width = std::max(width, outcome.name.size());
+    }
+
+    out << std::fixed;
+    for (const auto& outcome : summary.outcomes) {
+        out << (outcome.passed ? "PASS " : "FAIL ") << std::left << std::setw(static_cast<int>(width))
+            << outcome.name << std::right << std::setw(10) << outcome.frames << " frames" << std::setw(10)
+            << outcome.records << " records" << std::setprecision(1) << std::setw(9) << outcome.seconds * 1000.0
+            << " ms" << std::setprecision(0) << std::setw(12)
+            << (outcome.seconds > 0.0 ? static_cast<double>(outcome.frames) / outcome.seconds : 0.0)
+            << " frames/s\n";
+        if (!outcome.error.empty()) {
+            out << "    " << outcome.error << "\n";
+        }
+        for (const auto& m : outcome.mismatches) {
+            out << "    record " << m.record << " " << (m.field.empty() ? "(structure)" : m.field)
+                << ": expected " << m.expected << ", got " << m.actual << "\n";
+        }
+    }
+    out << std::setprecision(3) << summary.passed << " passed, " << summary.failed << " failed, "
+        << summary.frames << " frames in " << summary.seconds << " s on " << summary.threads
+        << " thread(s) (" << summary.busySeconds << " s of replay)\n";
+    out.flags(flags);
+}
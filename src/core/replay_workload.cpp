@@ -0,0 +1,117 @@
+#include "core/replay_workload.hpp"
+#include "core/recording_container.hpp"
+#include "core/translation_layer.hpp"
+#include "core/output_shaper.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+
+namespace {
+
+// FNV-1a style fold of one value
+inline void fold(uint64_t& hash, uint64_t value) {
+    hash ^= value;
+    hash *= 1099511628211ull;
+}
+
+void foldReport(uint64_t& hash, const TranslatedState& state, const XINPUT_STATE& xinput,
+                const TranslationLayer::DInputState& dinput) {
+    fold(hash, static_cast<uint64_t>(state.sourceUserId + 1));
+    fold(hash, xinput.Gamepad.wButtons);
+    fold(hash, (static_cast<uint64_t>(xinput.Gamepad.bLeftTrigger) << 8) | xinput.Gamepad.bRightTrigger);
+    fold(hash, static_cast<uint16_t>(xinput.Gamepad.sThumbLX));
+    fold(hash, static_cast<uint16_t>(xinput.Gamepad.sThumbLY));
+    fold(hash, static_cast<uint16_t>(xinput.Gamepad.sThumbRX));
+    fold(hash, static_cast<uint16_t>(xinput.Gamepad.sThumbRY));
+    fold(hash, static_cast<uint32_t>(dinput.lZ));
+    fold(hash, static_cast<uint32_t>(dinput.lRz));
+    fold(hash, dinput.rgdwPOV[0]);
+    for (int b = 0; b < 16; ++b) {
+        fold(hash, dinput.rgbButtons[b]);
+    }
+    if (dinput.motion.valid) {
+        fold(hash, static_cast<uint16_t>(dinput.motion.gyro[0]));
+        fold(hash, static_cast<uint16_t>(dinput.motion.gyro[1]));
+        fold(hash, static_cast<uint16_t>(dinput.motion.accel[2]));
+    }
+}
+
+} // namespace
+
+bool ReplayWorkload::add(const std::string& path, std::string* error) {
+    namespace fs = std::filesystem;
+    std::vector<fs::path> files;
+    std::error_code ec;
+    if (fs::is_directory(path, ec)) {
+        for (const auto& entry : fs::directory_iterator(path, ec)) {
+            if (entry.path().extension() == ".rec" || entry.path().extension() == ".xrec") {
+                files.push_back(entry.path());
+            }
+        }
+        std::sort(files.begin(), files.end());
+        if (files.empty()) {
+            if (error) *error = "no recordings in " + path;
+            return false;
+        }
+    } else {
+        files.push_back(path);
+    }
+
+    for (const auto& file : files) {
+        SessionRecording recording;
+        std::string reason;
+        bool loaded = file.extension() == ".xrec" ? RecordingReader::load(file.string(), recording, &reason)
+                                                  : recording.load(file.string(), &reason);
+        if (!loaded) {
+            if (error) *error = file.string() + ": " + reason;
+            return false;
+        }
+        // Options are validated once here rather than on every replay
+        TranslationLayer probe;
+        if (!recording.applyOptions(probe, &reason)) {
+            if (error) *error = file.string() + ": " + reason;
+            return false;
+        }
+        m_recordings.push_back(std::move(recording));
+    }
+    return true;
+}
+
+ReplayWorkload::Stats ReplayWorkload::run(uint32_t iterations) const {
+    Stats stats;
+    stats.recordings = m_recordings.size();
+    stats.checksum = 14695981039346656037ull;
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t iteration = 0; iteration < iterations; ++iteration) {
+        for (const auto& recording : m_recordings) {
+            // Fresh pipeline per pass, as after a restart of the proxy
+            TranslationLayer layer;
+            recording.applyOptions(layer);
+            OutputShaper shaper;
+            shaper.setMaxRateHz(250);
+            RecordingPlayer player(recording);
+
+            while (!player.done()) {
+                player.update(0.0);
+                uint64_t nowUs = recording.frames[player.frameIndex() - 1].timeUs;
+                std::vector<TranslatedState> states = layer.translate(player.getInputStates());
+                for (const auto& state : states) {
+                    if (shaper.offer(state, nowUs) != OutputShaper::Decision::SUBMIT) {
+                        continue;
+                    }
+                    foldReport(stats.checksum, state, layer.translateToXInput(state), layer.translateToDInput(state));
+                    stats.outputs++;
+                }
+                for (const auto& state : shaper.takeDue(nowUs)) {
+                    foldReport(stats.checksum, state, layer.translateToXInput(state), layer.translateToDInput(state));
+                    stats.outputs++;
+                }
+                stats.frames++;
+            }
+        }
+    }
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return stats;
+}
@@ -0,0 +1,151 @@
+#include "core/report_phase.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+ReportPhaseEstimator::ReportPhaseEstimator() {
+    reset();
+}
+
+void ReportPhaseEstimator::reset() {
+    m_reports = 0;
+    m_lastUs = 0;
+    m_trainingCount = 0;
+    m_trained = false;
+    m_periodUs = 0.0;
+    m_nextUs = 0.0;
+    m_jitterUs = 0.0;
+    m_consistent = 0;
+    m_outliers = 0;
+}
+
+void ReportPhaseEstimator::onReport(uint64_t timestampUs, uint64_t arrivedAfterUs) {
+    m_reports++;
+    if (m_reports == 1) {
+        m_lastUs = timestampUs;
+        return;
+    }
+
+    if (!m_trained) {
+        // Seed the period with the median interval; robust to a dropped report or two
+        m_trainingIntervals[m_trainingCount++] = static_cast<double>(timestampUs - m_lastUs);
+        m_lastUs = timestampUs;
+        if (m_trainingCount == TRAINING_INTERVALS) {
+            std::sort(m_trainingIntervals, m_trainingIntervals + TRAINING_INTERVALS);
+            m_periodUs = m_trainingIntervals[TRAINING_INTERVALS / 2];
+            m_nextUs = static_cast<double>(timestampUs) + m_periodUs;
+            m_trained = m_periodUs > 0.0;
+            m_trainingCount = 0;
+        }
+        return;
+    }
+    m_lastUs = timestampUs;
+
+    double lo = static_cast<double>(std::min(arrivedAfterUs, timestampUs));
+    double hi = static_cast<double>(timestampUs);
+    double gate = std::max(0.1 * m_periodUs, 4.0 * m_jitterUs);
+
+    if (hi - lo > EXACT_WINDOW * m_periodUs) {
+        // Only know the report landed somewhere in (lo, hi]. Match the expected
+        // arrival nearest the pickup; arrivals before m_nextUs were already
+        // matched to earlier reports. Only nudge the phase, and only when the
+        // window rules the expected arrival out.
+        double expected = m_nextUs + std::max(0.0, std::round((hi - m_nextUs) / m_periodUs)) * m_periodUs;
+        double error = expected < lo ? lo - expected : (expected > hi ? hi - expected : 0.0);
+
+        m_nextUs = expected + PHASE_GAIN * std::max(std::min(error, gate), -gate) + m_periodUs;
+        m_consistent = std::abs(error) <= gate ? std::min(m_consistent + 1, LOCK_REPORTS) : 0;
+        return;
+    }
+
+    // Phase error, folded into one period so dropped reports are not errors
+    double error = (lo + hi) / 2.0 - m_nextUs;
+    double skipped = std::round(error / m_periodUs);
+    error -= skipped * m_periodUs;
+    m_nextUs += skipped * m_periodUs;
+
+    if (std::abs(error) > gate) {
+        // Not where any report should be: ignore, and retrain if it keeps happening.
+        // Inliers only pay the count down, so a faster mode that lines up with the
+        // old phase once in a while still wins.
+        m_consistent = 0;
+        if (++m_outliers >= MAX_OUTLIERS) {
+            reset();
+        }
+        return;
+    }
+    m_outliers = std::max(m_outliers - 1, 0);
+
+    // Second-order loop: correct phase now, period slowly (tracks drift)
+    m_nextUs += PHASE_GAIN * error + m_periodUs;
+    m_periodUs += PERIOD_GAIN * error;
+    m_jitterUs += 0.05 * (std::abs(error) - m_jitterUs);
+    m_consistent = std::min(m_consistent + 1, LOCK_REPORTS);
+}
+
+bool ReportPhaseEstimator::isLocked() const {
+    return m_trained && m_consistent >= LOCK_REPORTS && m_jitterUs < 0.1 * m_periodUs;
+}
+
+double ReportPhaseEstimator::predictNextUs(double afterUs) const {
+    if (!m_trained) {
+        return afterUs;
+    }
+    double next = m_nextUs;
+    if (next <= afterUs) {
+        next += (std::floor((afterUs - next) / m_periodUs) + 1.0) * m_periodUs;
+    }
+    return next;
+}
+
+void PhaseAlignedPacer::onReport(size_t device, uint64_t timestampUs, uint64_t arrivedAfterUs) {
+    if (device >= m_estimators.size()) {
+        m_estimators.resize(device + 1);
+    }
+    m_estimators[device].onReport(timestampUs, arrivedAfterUs);
+}
+
+void PhaseAlignedPacer::reset(size_t device) {
+    if (device < m_estimators.size()) {
+        m_estimators[device].reset();
+    }
+}
+
+int PhaseAlignedPacer::anchor() const {
+    int best = -1;
+    for (size_t i = 0; i < m_estimators.size(); ++i) {
+        const ReportPhaseEstimator& e = m_estimators[i];
+        if (e.isLocked() && (best < 0 || e.periodUs() < m_estimators[best].periodUs())) {
+            best = static_cast<int>(i);
+        }
+    }
+    return best;
+}
+
+PhaseAlignedPacer::WakePlan PhaseAlignedPacer::plan(uint64_t lastWakeUs, uint64_t regularWakeUs) const {
+    WakePlan regular{regularWakeUs, regularWakeUs, -1};
+    int device = anchor();
+    if (device < 0 || regularWakeUs <= lastWakeUs) {
+        return regular;
+    }
+
+    const ReportPhaseEstimator& e = m_estimators[device];
+    double guard = std::max(MIN_GUARD_US, JITTER_GUARD_FACTOR * e.jitterUs());
+    double earliest = static_cast<double>(lastWakeUs) + (regularWakeUs - lastWakeUs) / 2.0;
+    // May slip one guard past the grid, otherwise a device running at the loop
+    // rate keeps falling just outside the window
+    double latest = static_cast<double>(regularWakeUs) + guard;
+
+    // Latest arrival whose watch window opens within (earliest, latest]
+    double arrival = e.predictNextUs(earliest + guard);
+    if (arrival - guard > latest) {
+        return regular;
+    }
+    arrival += std::floor((latest + guard - arrival) / e.periodUs()) * e.periodUs();
+
+    WakePlan aligned;
+    aligned.wakeUs = static_cast<uint64_t>(arrival - guard);
+    aligned.watchUntilUs = static_cast<uint64_t>(arrival + guard);
+    aligned.anchor = device;
+    return aligned;
+}
@@ -0,0 +1,387 @@
+#include "core/session_recording.hpp"
+#include "core/translation_layer.hpp"
+
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+namespace {
+
+// Split a line on whitespace; double quotes group a value (no escapes, paths keep their backslashes)
+std::vector<std::string> tokenize(const std::string& line) {
+    std::vector<std::string> tokens;
+    std::string current;
+    bool quoted = false;
+    bool pending = false;
+    for (char c : line) {
+        if (c == '"') {
+            quoted = !quoted;
+            pending = true;
+        } else if (!quoted && (c == ' ' || c == '\t' || c == '\r')) {
+            if (pending) {
+                tokens.push_back(current);
+                current.clear();
+                pending = false;
+            }
+        } else {
+            current += c;
+            pending = true;
+        }
+    }
+    if (pending) {
+        tokens.push_back(current);
+    }
+    return tokens;
+}
+
+bool parseInteger(const std::string& text, long long& value) {
+    if (text.empty()) {
+        return false;
+    }
+    char* end = nullptr;
+    value = std::strtoll(text.c_str(), &end, 0);
+    return end && *end == '\0';
+}
+
+// key=value tokens after the positional ones
+bool splitKeyValue(const std::string& token, std::string& key, std::string& value) {
+    size_t pos = token.find('=');
+    if (pos == std::string::npos || pos == 0) {
+        return false;
+    }
+    key = token.substr(0, pos);
+    value = token.substr(pos + 1);
+    return true;
+}
+
+std::vector<std::string> splitList(const std::string& text, char separator) {
+    std::vector<std::string> items;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, separator)) {
+        if (!item.empty()) items.push_back(item);
+    }
+    return items;
+}
+
+bool parseHex(const std::string& text, std::vector<uint8_t>& bytes) {
+    if (text.size() % 2 != 0) {
+        return false;
+    }
+    bytes.clear();
+    for (size_t i = 0; i < text.size(); i += 2) {
+        char* end = nullptr;
+        std::string pair = text.substr(i, 2);
+        unsigned long byte = std::strtoul(pair.c_str(), &end, 16);
+        if (!end || *end != '\0') {
+            return false;
+        }
+        bytes.push_back(static_cast<uint8_t>(byte));
+    }
+    return true;
+}
+
+std::wstring widen(const std::string& text) {
+    return std::wstring(text.begin(), text.end());
+}
+
+bool optionFlag(const std::string& value) {
+    return value == "1" || value == "true" || value == "on";
+}
+
+} // namespace
+
+bool SessionRecording::parse(std::istream& in, std::string* error) {
+    options.clear();
+    devices.clear();
+    frames.clear();
+
+    int lineNumber = 0;
+    auto fail = [&](const std::string& reason) {
+        if (error) {
+            *error = "line " + std::to_string(lineNumber) + ": " + reason;
+        }
+        return false;
+    };
+
+    std::string line;
+    bool sawHeader = false;
+    while (std::getline(in, line)) {
+        lineNumber++;
+        std::vector<std::string> tokens = tokenize(line);
+        if (tokens.empty() || tokens[0][0] == '#') {
+            continue;
+        }
+        const std::string& kind = tokens[0];
+
+        if (!sawHeader) {
+            if (kind != "xidp-recording" || tokens.size() != 2 || std::atoi(tokens[1].c_str()) != FORMAT_VERSION) {
+                return fail("expected 'xidp-recording " + std::to_string(FORMAT_VERSION) + "'");
+            }
+            sawHeader = true;
+            continue;
+        }
+
+        if (kind == "option") {
+            if (tokens.size() != 3) return fail("option needs a name and a value");
+            options[tokens[1]] = tokens[2];
+        } else if (kind == "device") {
+            long long index = 0;
+            if (tokens.size() < 3 || !parseInteger(tokens[1], index) || index != static_cast<long long>(devices.size())) {
+                return fail("devices must be numbered in order from 0");
+            }
+            Device device;
+            if (tokens[2] == "xinput") {
+                device.kind = SourceKind::XINPUT;
+            } else if (tokens[2] == "hid") {
+                device.kind = SourceKind::HID;
+            } else {
+                return fail("unknown device kind '" + tokens[2] + "'");
+            }
+            for (size_t i = 3; i < tokens.size(); ++i) {
+                std::string key, value;
+                long long number = 0;
+                if (!splitKeyValue(tokens[i], key, value)) return fail("expected key=value: " + tokens[i]);
+                if (key == "user" && parseInteger(value, number)) device.userId = static_cast<int>(number);
+                else if (key == "vid" && parseInteger("0x" + value, number)) device.vendorId = static_cast<USHORT>(number);
+                else if (key == "pid" && parseInteger("0x" + value, number)) device.productId = static_cast<USHORT>(number);
+                else if (key == "name") device.productName = value;
+                else if (key == "path") device.devicePath = value;
+                else return fail("bad device field: " + tokens[i]);
+            }
+            if (device.kind == SourceKind::XINPUT && device.userId < 0) {
+                return fail("xinput device needs user=<slot>");
+            }
+            devices.push_back(device);
+        } else if (kind == "cap") {
+            long long index = 0, usage = 0, logicalMin = 0, logicalMax = 0;
+            if (tokens.size() != 5 || !parseInteger(tokens[1], index) || !parseInteger(tokens[2], usage) ||
+                !parseInteger(tokens[3], logicalMin) || !parseInteger(tokens[4], logicalMax)) {
+                return fail("cap needs <device> <usage> <min> <max>");
+            }
+            if (index < 0 || index >= static_cast<long long>(devices.size())) return fail("cap for unknown device");
+            devices[static_cast<size_t>(index)].valueCaps.push_back(
+                {static_cast<USAGE>(usage), static_cast<LONG>(logicalMin), static_cast<LONG>(logicalMax)});
+        } else if (kind == "frame") {
+            long long timeUs = 0;
+            if (tokens.size() != 2 || !parseInteger(tokens[1], timeUs) || timeUs < 0) return fail("frame needs a time");
+            if (!frames.empty() && static_cast<uint64_t>(timeUs) < frames.back().timeUs) return fail("frame time goes backwards");
+            Frame frame;
+            frame.timeUs = static_cast<uint64_t>(timeUs);
+            frames.push_back(frame);
+        } else if (kind == "x" || kind == "h") {
+            long long index = 0;
+            if (frames.empty()) return fail("sample before the first frame");
+            if (tokens.size() < 2 || !parseInteger(tokens[1], index) ||
+                index < 0 || index >= static_cast<long long>(devices.size())) {
+                return fail("sample for unknown device");
+            }
+            Sample sample;
+            sample.device = static_cast<size_t>(index);
+            SourceKind expected = kind == "x" ? SourceKind::XINPUT : SourceKind::HID;
+            if (devices[sample.device].kind != expected) return fail("sample kind does not match the device");
+
+            for (size_t i = 2; i < tokens.size(); ++i) {
+                std::string key, value;
+                long long number = 0;
+                if (!splitKeyValue(tokens[i], key, value)) return fail("expected key=value: " + tokens[i]);
+                if (expected == SourceKind::XINPUT) {
+                    if (!parseInteger(value, number)) return fail("bad number: " + tokens[i]);
+                    if (key == "packet") sample.packetNumber = static_cast<DWORD>(number);
+                    else if (key == "buttons") sample.gamepad.wButtons = static_cast<WORD>(number);
+                    else if (key == "lt") sample.gamepad.bLeftTrigger = static_cast<BYTE>(number);
+                    else if (key == "rt") sample.gamepad.bRightTrigger = static_cast<BYTE>(number);
+                    else if (key == "lx") sample.gamepad.sThumbLX = static_cast<SHORT>(number);
+                    else if (key == "ly") sample.gamepad.sThumbLY = static_cast<SHORT>(number);
+                    else if (key == "rx") sample.gamepad.sThumbRX = static_cast<SHORT>(number);
+                    else if (key == "ry") sample.gamepad.sThumbRY = static_cast<SHORT>(number);
+                    else return fail("bad xinput field: " + tokens[i]);
+                } else if (key == "buttons") {
+                    for (const auto& item : splitList(value, ',')) {
+                        if (!parseInteger(item, number)) return fail("bad button usage: " + item);
+                        sample.buttons.push_back(static_cast<USAGE>(number));
+                    }
+                } else if (key == "values") {
+                    for (const auto& item : splitList(value, ',')) {
+                        size_t colon = item.find(':');
+                        long long usage = 0;
+                        if (colon == std::string::npos || !parseInteger(item.substr(0, colon), usage) ||
+                            !parseInteger(item.substr(colon + 1), number)) {
+                            return fail("bad usage value: " + item);
+                        }
+                        sample.values.push_back({static_cast<USAGE>(usage), static_cast<LONG>(number)});
+                    }
+                } else if (key == "report") {
+                    if (!parseHex(value, sample.report)) return fail("bad report bytes");
+                } else {
+                    return fail("bad hid field: " + tokens[i]);
+                }
+            }
+            frames.back().samples.push_back(sample);
+        } else {
+            return fail("unknown record '" + kind + "'");
+        }
+    }
+
+    if (!sawHeader) {
+        lineNumber = 0;
+        return fail("empty recording");
+    }
+    return true;
+}
+
+bool SessionRecording::load(const std::string& path, std::string* error) {
+    std::ifstream in(path);
+    if (!in) {
+        if (error) *error = "cannot open " + path;
+        return false;
+    }
+    return parse(in, error);
+}
+
+void SessionRecording::write(std::ostream& out) const {
+    out << "xidp-recording " << FORMAT_VERSION << "\n";
+    for (const auto& [name, value] : options) {
+        out << "option " << name << " " << value << "\n";
+    }
+    for (size_t i = 0; i < devices.size(); ++i) {
+        const Device& device = devices[i];
+        if (device.kind == SourceKind::XINPUT) {
+            out << "device " << i << " xinput user=" << device.userId << "\n";
+            continue;
+        }
+        out << "device " << i << " hid" << std::hex << std::setfill('0')
+            << " vid=" << std::setw(4) << device.vendorId << " pid=" << std::setw(4) << device.productId
+            << std::dec << std::setfill(' ');
+        if (!device.productName.empty()) out << " name=\"" << device.productName << "\"";
+        if (!device.devicePath.empty()) out << " path=\"" << device.devicePath << "\"";
+        out << "\n";
+        for (const auto& cap : device.valueCaps) {
+            out << "cap " << i << " 0x" << std::hex << cap.usage << std::dec
+                << " " << cap.logicalMin << " " << cap.logicalMax << "\n";
+        }
+    }
+    for (const auto& frame : frames) {
+        out << "frame " << frame.timeUs << "\n";
+        for (const auto& sample : frame.samples) {
+            if (devices[sample.device].kind == SourceKind::XINPUT) {
+                const XINPUT_GAMEPAD& g = sample.gamepad;
+                out << "x " << sample.device << " packet=" << sample.packetNumber
+                    << " buttons=0x" << std::hex << g.wButtons << std::dec
+                    << " lt=" << static_cast<int>(g.bLeftTrigger) << " rt=" << static_cast<int>(g.bRightTrigger)
+                    << " lx=" << g.sThumbLX << " ly=" << g.sThumbLY << " rx=" << g.sThumbRX << " ry=" << g.sThumbRY << "\n";
+                continue;
+            }
+            out << "h " << sample.device;
+            if (!sample.buttons.empty()) {
+                out << " buttons=";
+                for (size_t b = 0; b < sample.buttons.size(); ++b) {
+                    out << (b ? "," : "") << sample.buttons[b];
+                }
+            }
+            if (!sample.values.empty()) {
+                out << " values=";
+                for (size_t v = 0; v < sample.values.size(); ++v) {
+                    out << (v ? "," : "") << "0x" << std::hex << sample.values[v].first << std::dec
+                        << ":" << sample.values[v].second;
+                }
+            }
+            if (!sample.report.empty()) {
+                out << " report=" << std::hex << std::setfill('0');
+                for (uint8_t byte : sample.report) {
+                    out << std::setw(2) << static_cast<int>(byte);
+                }
+                out << std::dec << std::setfill(' ');
+            }
+            out << "\n";
+        }
+    }
+}
+
+bool SessionRecording::applyOptions(TranslationLayer& layer, std::string* error) const {
+    for (const auto& [name, value] : options) {
+        float number = static_cast<float>(std::atof(value.c_str()));
+        if (name == "socd") layer.setSOCDCleaningEnabled(optionFlag(value));
+        else if (name == "socd_method") layer.setSOCDMethod(std::atoi(value.c_str()));
+        else if (name == "xinput_to_dinput") layer.setXInputToDInputMapping(optionFlag(value));
+        else if (name == "dinput_to_xinput") layer.setDInputToXInputMapping(optionFlag(value));
+        else if (name == "stick_deadzone") layer.setStickDeadzoneEnabled(optionFlag(value));
+        else if (name == "left_deadzone") layer.setLeftStickDeadzone(number);
+        else if (name == "right_deadzone") layer.setRightStickDeadzone(number);
+        else if (name == "left_anti_deadzone") layer.setLeftStickAntiDeadzone(number);
+        else if (name == "right_anti_deadzone") layer.setRightStickAntiDeadzone(number);
+        else if (name == "motion_passthrough") layer.setMotionPassthroughEnabled(optionFlag(value));
+        else if (name == "gyro_to_stick") layer.setGyroToStickEnabled(optionFlag(value));
+        else if (name == "gyro_sensitivity") layer.setGyroSensitivity(number);
+        else if (name == "gyro_smoothing") layer.setGyroSmoothing(number);
+        else if (name == "gyro_deadzone") layer.setGyroDeadzone(std::atoi(value.c_str()));
+        else {
+            if (error) *error = "unsupported option '" + name + "'";
+            return false;
+        }
+    }
+    return true;
+}
+
+RecordingPlayer::RecordingPlayer(const SessionRecording& recording)
+    : m_recording(recording),
+      m_nextFrame(0) {
+    for (size_t i = 0; i < recording.devices.size(); ++i) {
+        const SessionRecording::Device& device = recording.devices[i];
+        ControllerState state{};
+        state.isConnected = true;
+        state.userId = device.userId;
+        state.vendorId = device.vendorId;
+        state.productId = device.productId;
+        if (device.kind == SessionRecording::SourceKind::HID) {
+            state.userId = -1;
+            state.productName = widen(device.productName);
+            state.devicePath = widen(device.devicePath.empty()
+                ? "recorded-hid-" + std::to_string(i) : device.devicePath);
+            state.motionPlan = MotionReportPlan::forDevice(device.vendorId, device.productId);
+            for (const auto& recorded : device.valueCaps) {
+                HIDP_VALUE_CAPS cap{};
+                cap.UsagePage = 0x01;
+                cap.Range.UsageMin = recorded.usage;
+                cap.Range.UsageMax = recorded.usage;
+                cap.LogicalMin = recorded.logicalMin;
+                cap.LogicalMax = recorded.logicalMax;
+                state.valueCaps.push_back(cap);
+            }
+        }
+        m_states.push_back(state);
+    }
+}
+
+void RecordingPlayer::update(double deltaTime) {
+    (void)deltaTime;
+    if (done()) {
+        return;
+    }
+    const SessionRecording::Frame& frame = m_recording.frames[m_nextFrame++];
+    for (auto& state : m_states) {
+        state.timestamp = frame.timeUs;
+    }
+    for (const auto& sample : frame.samples) {
+        ControllerState& state = m_states[sample.device];
+        if (m_recording.devices[sample.device].kind == SessionRecording::SourceKind::XINPUT) {
+            state.xinputState.dwPacketNumber = sample.packetNumber;
+            state.xinputState.Gamepad = sample.gamepad;
+            continue;
+        }
+        // Same order as InputCapture: motion from the raw report, then the parsed usages
+        if (!sample.report.empty()) {
+            extractMotion(state.motionPlan, sample.report.data(), sample.report.size(), state.motion);
+        }
+        state.m_activeButtons = sample.buttons;
+        state.m_hidValues.clear();
+        for (const auto& [usage, value] : sample.values) {
+            state.m_hidValues[usage] = value;
+        }
+    }
+}
+
+std::vector<ControllerState> RecordingPlayer::getInputStates() const {
+    return m_states;
+}
@@ -0,0 +1,185 @@
+#include "core/simd_kernels.hpp"
+#include "utils/cpu_features.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+// Scalar references. Built with -ffp-contract=off like the SIMD variants, so
+// a -march=native build cannot fuse these multiplies into FMAs either.
+
+void SimdVariants::radialDeadzoneScalar(SHORT* xy, size_t pairs, float deadzone, float antiDeadzone) {
+    for (size_t i = 0; i < pairs; ++i) {
+        SHORT& thumbX = xy[2 * i];
+        SHORT& thumbY = xy[2 * i + 1];
+
+        // Normalize to -1.0 to 1.0 range
+        float x = static_cast<float>(thumbX) / 32767.0f;
+        float y = static_cast<float>(thumbY) / 32767.0f;
+
+        float magnitude = std::sqrt(x * x + y * y);
+
+        // Below the deadzone the stick is centered
+        if (magnitude < deadzone) {
+            thumbX = 0;
+            thumbY = 0;
+            continue;
+        }
+
+        float directionX = (magnitude > 0.0f) ? (x / magnitude) : 0.0f;
+        float directionY = (magnitude > 0.0f) ? (y / magnitude) : 0.0f;
+
+        // Scale magnitude from [deadzone, 1.0] to [0.0, 1.0]
+        float normalizedMagnitude = (magnitude - deadzone) / (1.0f - deadzone);
+
+        // Anti-deadzone adds a minimum output once the stick leaves the deadzone
+        if (antiDeadzone > 0.0f && normalizedMagnitude > 0.0f) {
+            normalizedMagnitude = antiDeadzone + (1.0f - antiDeadzone) * normalizedMagnitude;
+        }
+
+        // Same operand order as _mm_min_ps(normalizedMagnitude, 1.0f), including NaN
+        normalizedMagnitude = (normalizedMagnitude < 1.0f) ? normalizedMagnitude : 1.0f;
+
+        thumbX = static_cast<SHORT>(directionX * normalizedMagnitude * 32767.0f);
+        thumbY = static_cast<SHORT>(directionY * normalizedMagnitude * 32767.0f);
+    }
+}
+
+void SimdVariants::encodeDInputButtonsScalar(WORD buttons, BYTE* rgbButtons) {
+    static const WORD kButtonOrder[10] = {
+        XINPUT_GAMEPAD_A, XINPUT_GAMEPAD_B, XINPUT_GAMEPAD_X, XINPUT_GAMEPAD_Y,
+        XINPUT_GAMEPAD_LEFT_SHOULDER, XINPUT_GAMEPAD_RIGHT_SHOULDER,
+        XINPUT_GAMEPAD_BACK, XINPUT_GAMEPAD_START,
+        XINPUT_GAMEPAD_LEFT_THUMB, XINPUT_GAMEPAD_RIGHT_THUMB
+    };
+    std::memset(rgbButtons, 0, 16);
+    for (int i = 0; i < 10; ++i) {
+        if (buttons & kButtonOrder[i]) rgbButtons[i] = 0x80;
+    }
+}
+
+bool SimdVariants::sameGamepadScalar(const void* a, const void* b) {
+    return std::memcmp(a, b, SimdKernels::GAMEPAD_REPORT_BYTES) == 0;
+}
+
+void SimdVariants::stickStatsScalar(const SHORT* xy, size_t pairs, int32_t restWindow, StickStats& stats) {
+    for (size_t i = 0; i < pairs; ++i) {
+        const int32_t x = xy[2 * i];
+        const int32_t y = xy[2 * i + 1];
+        const int32_t projections[8] = {x, -x, y, -y, x + y, x - y, y - x, -x - y};
+        for (int k = 0; k < 8; ++k) {
+            stats.extents[k] = std::max(stats.extents[k], projections[k]);
+        }
+        if (std::abs(x) <= restWindow && std::abs(y) <= restWindow) {
+            stats.restCount++;
+            stats.restSumX += x;
+            stats.restSumY += y;
+        }
+    }
+}
+
+namespace {
+
+SimdKernelTable buildTable(SimdLevel level) {
+    SimdKernelTable table{
+        SimdVariants::radialDeadzoneScalar, SimdVariants::encodeDInputButtonsScalar,
+        SimdVariants::sameGamepadScalar, SimdVariants::stickStatsScalar, "scalar", "scalar", "scalar", "scalar"
+    };
+#ifdef XIDP_SIMD_X86
+    if (level >= SimdLevel::SSE41) {
+        table.radialDeadzone = SimdVariants::radialDeadzoneSse41;
+        table.encodeDInputButtons = SimdVariants::encodeDInputButtonsSse41;
+        table.sameGamepad = SimdVariants::sameGamepadSse41;
+        table.stickStats = SimdVariants::stickStatsSse41;
+        table.radialDeadzoneVariant = "sse4.1";
+        table.encodeDInputButtonsVariant = "sse4.1";
+        table.sameGamepadVariant = "sse4.1";
+        table.stickStatsVariant = "sse4.1";
+    }
+    if (level >= SimdLevel::AVX2) {
+        table.radialDeadzone = SimdVariants::radialDeadzoneAvx2;
+        table.stickStats = SimdVariants::stickStatsAvx2;
+        table.radialDeadzoneVariant = "avx2";
+        table.stickStatsVariant = "avx2";
+        if (CpuFeatures::get().bmi2) {
+            table.encodeDInputButtons = SimdVariants::encodeDInputButtonsBmi2;
+            table.encodeDInputButtonsVariant = "bmi2";
+        }
+    }
+    if (level >= SimdLevel::AVX512) {
+        table.radialDeadzone = SimdVariants::radialDeadzoneAvx512;
+        table.radialDeadzoneVariant = "avx512";
+    }
+    // A 12-byte compare does not benefit from wider registers than SSE; stick
+    // stats are bound by the decode that feeds them, so they stop at AVX2
+#else
+    (void)level;
+#endif
+    return table;
+}
+
+// One immutable table per level, built once; select() only swaps which one is
+// active, so a thread reading active() never sees a half-written table
+const SimdKernelTable& tableOf(SimdLevel level) {
+    static const SimdKernelTable tables[] = {
+        buildTable(SimdLevel::SCALAR), buildTable(SimdLevel::SSE41),
+        buildTable(SimdLevel::AVX2), buildTable(SimdLevel::AVX512)
+    };
+    return tables[static_cast<int>(level)];
+}
+
+std::atomic<const SimdKernelTable*>& activeTable() {
+    static std::atomic<const SimdKernelTable*> table{&tableOf(SimdKernels::supportedLevel())};
+    return table;
+}
+
+} // namespace
+
+const SimdKernelTable& SimdKernels::active() {
+    return *activeTable().load(std::memory_order_acquire);
+}
+
+SimdLevel SimdKernels::select(SimdLevel maxLevel) {
+    SimdLevel level = std::min(maxLevel, supportedLevel());
+    activeTable().store(&tableOf(level), std::memory_order_release);
+    return level;
+}
+
+SimdLevel SimdKernels::supportedLevel() {
+    const CpuFeatures::Flags& flags = CpuFeatures::get();
+    if (flags.avx512 && flags.avx2) return SimdLevel::AVX512;
+    if (flags.avx2) return SimdLevel::AVX2;
+    if (flags.sse41) return SimdLevel::SSE41;
+    return SimdLevel::SCALAR;
+}
+
+SimdKernelTable SimdKernels::tableFor(SimdLevel level) {
+    return buildTable(std::min(level, supportedLevel()));
+}
+
+const char* SimdKernels::levelName(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::SSE41: return "sse4.1";
+        case SimdLevel::AVX2: return "avx2";
+        case SimdLevel::AVX512: return "avx512";
+        default: return "scalar";
+    }
+}
+
+bool SimdKernels::parseLevel(const std::string& name, SimdLevel& level) {
+    if (name == "auto" || name == "avx512") level = SimdLevel::AVX512;
+    else if (name == "avx2") level = SimdLevel::AVX2;
+    else if (name == "sse4.1" || name == "sse41") level = SimdLevel::SSE41;
+    else if (name == "scalar") level = SimdLevel::SCALAR;
+    else return false;
+    return true;
+}
+
+std::string SimdKernels::describe() {
+    const SimdKernelTable& table = active();
+    return std::string("deadzone=") + table.radialDeadzoneVariant +
+           " buttons=" + table.encodeDInputButtonsVariant +
+           " dedup=" + table.sameGamepadVariant;
+}
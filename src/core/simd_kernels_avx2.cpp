@@ -0,0 +1,137 @@
+// AVX2 and BMI2 kernels. Compiled with -mavx2 -mbmi2 (/arch:AVX2); only
+// reached through SimdKernels after CPUID confirmed support. Keep this unit
+// free of inline library code, see simd_kernels_sse41.cpp.
+
+#include "core/simd_kernels.hpp"
+
+#ifdef XIDP_SIMD_X86
+
+#include <cstdint>
+#include <cstring>
+#include <immintrin.h>
+
+void SimdVariants::radialDeadzoneAvx2(SHORT* xy, size_t pairs, float deadzone, float antiDeadzone) {
+    const __m256 scale = _mm256_set1_ps(32767.0f);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 dz = _mm256_set1_ps(deadzone);
+    const __m256 range = _mm256_set1_ps(1.0f - deadzone);
+    const __m256 anti = _mm256_set1_ps(antiDeadzone);
+    const __m256 antiScale = _mm256_set1_ps(1.0f - antiDeadzone);
+    const bool useAnti = antiDeadzone > 0.0f;
+
+    size_t i = 0;
+    for (; i + 8 <= pairs; i += 8) {
+        // Shuffles stay within 128-bit lanes, so xs/ys hold pairs 0 1 4 5 | 2 3 6 7;
+        // the unpack/pack below restores the order up to one 64-bit permute
+        __m256i raw = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(xy + 2 * i));
+        __m256 lo = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm256_castsi256_si128(raw)));
+        __m256 hi = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm256_extracti128_si256(raw, 1)));
+        __m256 x = _mm256_div_ps(_mm256_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0)), scale);
+        __m256 y = _mm256_div_ps(_mm256_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 1, 3, 1)), scale);
+
+        __m256 magnitude = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(x, x), _mm256_mul_ps(y, y)));
+        __m256 outside = _mm256_cmp_ps(magnitude, dz, _CMP_GE_OQ);
+        __m256 nonZero = _mm256_cmp_ps(magnitude, zero, _CMP_GT_OQ);
+        __m256 dirX = _mm256_blendv_ps(zero, _mm256_div_ps(x, magnitude), nonZero);
+        __m256 dirY = _mm256_blendv_ps(zero, _mm256_div_ps(y, magnitude), nonZero);
+
+        __m256 normalized = _mm256_div_ps(_mm256_sub_ps(magnitude, dz), range);
+        if (useAnti) {
+            __m256 lifted = _mm256_add_ps(anti, _mm256_mul_ps(antiScale, normalized));
+            normalized = _mm256_blendv_ps(normalized, lifted, _mm256_cmp_ps(normalized, zero, _CMP_GT_OQ));
+        }
+        normalized = _mm256_min_ps(normalized, one);
+
+        __m256i outX = _mm256_cvttps_epi32(
+            _mm256_and_ps(_mm256_mul_ps(_mm256_mul_ps(dirX, normalized), scale), outside));
+        __m256i outY = _mm256_cvttps_epi32(
+            _mm256_and_ps(_mm256_mul_ps(_mm256_mul_ps(dirY, normalized), scale), outside));
+        __m256i packed = _mm256_packs_epi32(_mm256_unpacklo_epi32(outX, outY), _mm256_unpackhi_epi32(outX, outY));
+        packed = _mm256_permute4x64_epi64(packed, _MM_SHUFFLE(3, 1, 2, 0));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(xy + 2 * i), packed);
+    }
+    if (i < pairs) {
+        radialDeadzoneSse41(xy + 2 * i, pairs - i, deadzone, antiDeadzone);
+    }
+}
+
+void SimdVariants::encodeDInputButtonsBmi2(WORD buttons, BYTE* rgbButtons) {
+    // Gather the ten buttons in DirectInput order, then deposit each bit as 0x80
+    uint32_t word = buttons;
+    uint32_t bits = _pext_u32(word, XINPUT_GAMEPAD_A | XINPUT_GAMEPAD_B | XINPUT_GAMEPAD_X | XINPUT_GAMEPAD_Y) |
+                    (_pext_u32(word, XINPUT_GAMEPAD_LEFT_SHOULDER | XINPUT_GAMEPAD_RIGHT_SHOULDER) << 4) |
+                    (_pext_u32(word, XINPUT_GAMEPAD_BACK) << 6) |
+                    (_pext_u32(word, XINPUT_GAMEPAD_START) << 7) |
+                    (_pext_u32(word, XINPUT_GAMEPAD_LEFT_THUMB | XINPUT_GAMEPAD_RIGHT_THUMB) << 8);
+    const uint32_t pressedBits = 0x80808080u;
+    uint32_t bytes[4] = {_pdep_u32(bits, pressedBits), _pdep_u32(bits >> 4, pressedBits),
+                         _pdep_u32(bits >> 8, pressedBits), 0};
+    std::memcpy(rgbButtons, bytes, sizeof(bytes));
+}
+
+void SimdVariants::stickStatsAvx2(const SHORT* xy, size_t pairs, int32_t restWindow, StickStats& stats) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i one = _mm256_set1_epi32(1);
+    const __m256i window = _mm256_set1_epi32(restWindow);
+    __m256i extents[8];
+    for (int k = 0; k < 8; ++k) {
+        extents[k] = _mm256_set1_epi32(stats.extents[k]);
+    }
+
+    size_t i = 0;
+    while (i + 8 <= pairs) {
+        // 32-bit lane sums for at most 32768 iterations, as in the SSE4.1 variant
+        size_t remaining = (pairs - i) / 8;
+        size_t end = i + 8 * (remaining < 32768 ? remaining : 32768);
+        __m256i count = zero;
+        __m256i sumX = zero;
+        __m256i sumY = zero;
+        for (; i < end; i += 8) {
+            // Lane order is irrelevant to maxima and sums, so in-lane shuffles are enough
+            __m256i raw = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(xy + 2 * i));
+            __m256 lo = _mm256_castsi256_ps(_mm256_cvtepi16_epi32(_mm256_castsi256_si128(raw)));
+            __m256 hi = _mm256_castsi256_ps(_mm256_cvtepi16_epi32(_mm256_extracti128_si256(raw, 1)));
+            __m256i x = _mm256_castps_si256(_mm256_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0)));
+            __m256i y = _mm256_castps_si256(_mm256_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 1, 3, 1)));
+            __m256i sum = _mm256_add_epi32(x, y);
+            __m256i diff = _mm256_sub_epi32(x, y);
+
+            extents[0] = _mm256_max_epi32(extents[0], x);
+            extents[1] = _mm256_max_epi32(extents[1], _mm256_sub_epi32(zero, x));
+            extents[2] = _mm256_max_epi32(extents[2], y);
+            extents[3] = _mm256_max_epi32(extents[3], _mm256_sub_epi32(zero, y));
+            extents[4] = _mm256_max_epi32(extents[4], sum);
+            extents[5] = _mm256_max_epi32(extents[5], diff);
+            extents[6] = _mm256_max_epi32(extents[6], _mm256_sub_epi32(zero, diff));
+            extents[7] = _mm256_max_epi32(extents[7], _mm256_sub_epi32(zero, sum));
+
+            __m256i outside = _mm256_or_si256(_mm256_cmpgt_epi32(_mm256_abs_epi32(x), window),
+                                              _mm256_cmpgt_epi32(_mm256_abs_epi32(y), window));
+            count = _mm256_add_epi32(count, _mm256_andnot_si256(outside, one));
+            sumX = _mm256_add_epi32(sumX, _mm256_andnot_si256(outside, x));
+            sumY = _mm256_add_epi32(sumY, _mm256_andnot_si256(outside, y));
+        }
+        alignas(32) int32_t lanes[3][8];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lanes[0]), count);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lanes[1]), sumX);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lanes[2]), sumY);
+        for (int lane = 0; lane < 8; ++lane) {
+            stats.restCount += static_cast<uint32_t>(lanes[0][lane]);
+            stats.restSumX += lanes[1][lane];
+            stats.restSumY += lanes[2][lane];
+        }
+    }
+
+    for (int k = 0; k < 8; ++k) {
+        __m128i m = _mm_max_epi32(_mm256_castsi256_si128(extents[k]), _mm256_extracti128_si256(extents[k], 1));
+        m = _mm_max_epi32(m, _mm_shuffle_epi32(m, _MM_SHUFFLE(1, 0, 3, 2)));
+        m = _mm_max_epi32(m, _mm_shuffle_epi32(m, _MM_SHUFFLE(2, 3, 0, 1)));
+        stats.extents[k] = _mm_cvtsi128_si32(m);
+    }
+    if (i < pairs) {
+        stickStatsSse41(xy + 2 * i, pairs - i, restWindow, stats);
+    }
+}
+
+#endif
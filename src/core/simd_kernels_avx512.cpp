@@ -0,0 +1,61 @@
+// AVX-512 kernels. Compiled with -mavx512f -mavx512bw -mavx512vl
+// (/arch:AVX512); only reached through SimdKernels after CPUID confirmed
+// support. Keep this unit free of inline library code, see simd_kernels_sse41.cpp.
+
+#include "core/simd_kernels.hpp"
+
+#ifdef XIDP_SIMD_X86
+
+#include <immintrin.h>
+
+void SimdVariants::radialDeadzoneAvx512(SHORT* xy, size_t pairs, float deadzone, float antiDeadzone) {
+    const __m512 scale = _mm512_set1_ps(32767.0f);
+    const __m512 zero = _mm512_setzero_ps();
+    const __m512 one = _mm512_set1_ps(1.0f);
+    const __m512 dz = _mm512_set1_ps(deadzone);
+    const __m512 range = _mm512_set1_ps(1.0f - deadzone);
+    const __m512 anti = _mm512_set1_ps(antiDeadzone);
+    const __m512 antiScale = _mm512_set1_ps(1.0f - antiDeadzone);
+    const bool useAnti = antiDeadzone > 0.0f;
+
+    // Cross-lane permutes give xs/ys and the interleaved result in natural order
+    const __m512i evens = _mm512_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30);
+    const __m512i odds = _mm512_setr_epi32(1, 3, 5, 7, 9, 11, 13, 15, 17, 19, 21, 23, 25, 27, 29, 31);
+    const __m512i interleaveLo = _mm512_setr_epi32(0, 16, 1, 17, 2, 18, 3, 19, 4, 20, 5, 21, 6, 22, 7, 23);
+    const __m512i interleaveHi = _mm512_setr_epi32(8, 24, 9, 25, 10, 26, 11, 27, 12, 28, 13, 29, 14, 30, 15, 31);
+
+    size_t i = 0;
+    for (; i + 16 <= pairs; i += 16) {
+        const SHORT* src = xy + 2 * i;
+        __m512 lo = _mm512_cvtepi32_ps(_mm512_cvtepi16_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src))));
+        __m512 hi = _mm512_cvtepi32_ps(_mm512_cvtepi16_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 16))));
+        __m512 x = _mm512_div_ps(_mm512_permutex2var_ps(lo, evens, hi), scale);
+        __m512 y = _mm512_div_ps(_mm512_permutex2var_ps(lo, odds, hi), scale);
+
+        __m512 magnitude = _mm512_sqrt_ps(_mm512_add_ps(_mm512_mul_ps(x, x), _mm512_mul_ps(y, y)));
+        __mmask16 outside = _mm512_cmp_ps_mask(magnitude, dz, _CMP_GE_OQ);
+        __mmask16 nonZero = _mm512_cmp_ps_mask(magnitude, zero, _CMP_GT_OQ);
+        __m512 dirX = _mm512_maskz_div_ps(nonZero, x, magnitude);
+        __m512 dirY = _mm512_maskz_div_ps(nonZero, y, magnitude);
+
+        __m512 normalized = _mm512_div_ps(_mm512_sub_ps(magnitude, dz), range);
+        if (useAnti) {
+            __mmask16 lift = _mm512_cmp_ps_mask(normalized, zero, _CMP_GT_OQ);
+            normalized = _mm512_mask_add_ps(normalized, lift, anti, _mm512_mul_ps(antiScale, normalized));
+        }
+        normalized = _mm512_min_ps(normalized, one);
+
+        __m512i outX = _mm512_cvttps_epi32(_mm512_maskz_mul_ps(outside, _mm512_mul_ps(dirX, normalized), scale));
+        __m512i outY = _mm512_cvttps_epi32(_mm512_maskz_mul_ps(outside, _mm512_mul_ps(dirY, normalized), scale));
+        SHORT* dst = xy + 2 * i;
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst),
+                            _mm512_cvtsepi32_epi16(_mm512_permutex2var_epi32(outX, interleaveLo, outY)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + 16),
+                            _mm512_cvtsepi32_epi16(_mm512_permutex2var_epi32(outX, interleaveHi, outY)));
+    }
+    if (i < pairs) {
+        radialDeadzoneAvx2(xy + 2 * i, pairs - i, deadzone, antiDeadzone);
+    }
+}
+
+#endif
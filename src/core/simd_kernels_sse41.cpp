@@ -0,0 +1,146 @@
+// SSE4.1 kernels. Compiled with -msse4.1; only reached through SimdKernels
+// after CPUID confirmed support. Keep this unit free of inline library code
+// (std:: templates) so no SSE4.1 copy of a shared inline function can be
+// picked by the linker for callers running on older CPUs.
+
+#include "core/simd_kernels.hpp"
+
+#ifdef XIDP_SIMD_X86
+
+#include <cstring>
+#include <immintrin.h>
+
+void SimdVariants::radialDeadzoneSse41(SHORT* xy, size_t pairs, float deadzone, float antiDeadzone) {
+    const __m128 scale = _mm_set1_ps(32767.0f);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 dz = _mm_set1_ps(deadzone);
+    const __m128 range = _mm_set1_ps(1.0f - deadzone);
+    const __m128 anti = _mm_set1_ps(antiDeadzone);
+    const __m128 antiScale = _mm_set1_ps(1.0f - antiDeadzone);
+    const bool useAnti = antiDeadzone > 0.0f;
+
+    size_t i = 0;
+    for (; i + 4 <= pairs; i += 4) {
+        // x0 y0 x1 y1 x2 y2 x3 y3 -> xs, ys
+        __m128i raw = _mm_loadu_si128(reinterpret_cast<const __m128i*>(xy + 2 * i));
+        __m128 lo = _mm_cvtepi32_ps(_mm_cvtepi16_epi32(raw));
+        __m128 hi = _mm_cvtepi32_ps(_mm_cvtepi16_epi32(_mm_srli_si128(raw, 8)));
+        __m128 x = _mm_div_ps(_mm_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0)), scale);
+        __m128 y = _mm_div_ps(_mm_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 1, 3, 1)), scale);
+
+        __m128 magnitude = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)));
+        __m128 outside = _mm_cmpge_ps(magnitude, dz);   // !(magnitude < deadzone), NaN-free input
+        __m128 nonZero = _mm_cmpgt_ps(magnitude, zero);
+        __m128 dirX = _mm_blendv_ps(zero, _mm_div_ps(x, magnitude), nonZero);
+        __m128 dirY = _mm_blendv_ps(zero, _mm_div_ps(y, magnitude), nonZero);
+
+        __m128 normalized = _mm_div_ps(_mm_sub_ps(magnitude, dz), range);
+        if (useAnti) {
+            __m128 lifted = _mm_add_ps(anti, _mm_mul_ps(antiScale, normalized));
+            normalized = _mm_blendv_ps(normalized, lifted, _mm_cmpgt_ps(normalized, zero));
+        }
+        normalized = _mm_min_ps(normalized, one);
+
+        __m128i outX = _mm_cvttps_epi32(_mm_and_ps(_mm_mul_ps(_mm_mul_ps(dirX, normalized), scale), outside));
+        __m128i outY = _mm_cvttps_epi32(_mm_and_ps(_mm_mul_ps(_mm_mul_ps(dirY, normalized), scale), outside));
+        __m128i packed = _mm_packs_epi32(_mm_unpacklo_epi32(outX, outY), _mm_unpackhi_epi32(outX, outY));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(xy + 2 * i), packed);
+    }
+    if (i < pairs) {
+        radialDeadzoneScalar(xy + 2 * i, pairs - i, deadzone, antiDeadzone);
+    }
+}
+
+void SimdVariants::encodeDInputButtonsSse41(WORD buttons, BYTE* rgbButtons) {
+    // One 16-bit lane per DirectInput button; masks of 0 are unmapped bytes
+    const __m128i masksLo = _mm_setr_epi16(
+        XINPUT_GAMEPAD_A, XINPUT_GAMEPAD_B, XINPUT_GAMEPAD_X, static_cast<short>(XINPUT_GAMEPAD_Y),
+        XINPUT_GAMEPAD_LEFT_SHOULDER, XINPUT_GAMEPAD_RIGHT_SHOULDER, XINPUT_GAMEPAD_BACK, XINPUT_GAMEPAD_START);
+    const __m128i masksHi = _mm_setr_epi16(XINPUT_GAMEPAD_LEFT_THUMB, XINPUT_GAMEPAD_RIGHT_THUMB, 0, 0, 0, 0, 0, 0);
+    const __m128i pressedBit = _mm_set1_epi8(static_cast<char>(0x80));
+
+    __m128i word = _mm_set1_epi16(static_cast<short>(buttons));
+    __m128i lo = _mm_cmpeq_epi16(_mm_and_si128(word, masksLo), masksLo);
+    __m128i hi = _mm_andnot_si128(_mm_cmpeq_epi16(masksHi, _mm_setzero_si128()),
+                                  _mm_cmpeq_epi16(_mm_and_si128(word, masksHi), masksHi));
+    __m128i bytes = _mm_and_si128(_mm_packs_epi16(lo, hi), pressedBit);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(rgbButtons), bytes);
+}
+
+bool SimdVariants::sameGamepadSse41(const void* a, const void* b) {
+    const unsigned char* pa = static_cast<const unsigned char*>(a);
+    const unsigned char* pb = static_cast<const unsigned char*>(b);
+    int tailA, tailB;
+    std::memcpy(&tailA, pa + 8, sizeof(tailA));
+    std::memcpy(&tailB, pb + 8, sizeof(tailB));
+    __m128i va = _mm_insert_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(pa)), tailA, 2);
+    __m128i vb = _mm_insert_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(pb)), tailB, 2);
+    __m128i diff = _mm_xor_si128(va, vb);
+    return _mm_testz_si128(diff, diff) != 0;
+}
+
+void SimdVariants::stickStatsSse41(const SHORT* xy, size_t pairs, int32_t restWindow, StickStats& stats) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi32(1);
+    const __m128i window = _mm_set1_epi32(restWindow);
+    __m128i extents[8];
+    for (int k = 0; k < 8; ++k) {
+        extents[k] = _mm_set1_epi32(stats.extents[k]);
+    }
+
+    size_t i = 0;
+    while (i + 4 <= pairs) {
+        // 32-bit lane sums for at most 32768 iterations: |sum| <= 2^15 * 2^15
+        size_t remaining = (pairs - i) / 4;
+        size_t end = i + 4 * (remaining < 32768 ? remaining : 32768);
+        __m128i count = zero;
+        __m128i sumX = zero;
+        __m128i sumY = zero;
+        for (; i < end; i += 4) {
+            // x0 y0 x1 y1 x2 y2 x3 y3 -> xs, ys
+            __m128i raw = _mm_loadu_si128(reinterpret_cast<const __m128i*>(xy + 2 * i));
+            __m128 lo = _mm_castsi128_ps(_mm_cvtepi16_epi32(raw));
+            __m128 hi = _mm_castsi128_ps(_mm_cvtepi16_epi32(_mm_srli_si128(raw, 8)));
+            __m128i x = _mm_castps_si128(_mm_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0)));
+            __m128i y = _mm_castps_si128(_mm_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 1, 3, 1)));
+            __m128i sum = _mm_add_epi32(x, y);
+            __m128i diff = _mm_sub_epi32(x, y);
+
+            extents[0] = _mm_max_epi32(extents[0], x);
+            extents[1] = _mm_max_epi32(extents[1], _mm_sub_epi32(zero, x));
+            extents[2] = _mm_max_epi32(extents[2], y);
+            extents[3] = _mm_max_epi32(extents[3], _mm_sub_epi32(zero, y));
+            extents[4] = _mm_max_epi32(extents[4], sum);
+            extents[5] = _mm_max_epi32(extents[5], diff);
+            extents[6] = _mm_max_epi32(extents[6], _mm_sub_epi32(zero, diff));
+            extents[7] = _mm_max_epi32(extents[7], _mm_sub_epi32(zero, sum));
+
+            __m128i outside = _mm_or_si128(_mm_cmpgt_epi32(_mm_abs_epi32(x), window),
+                                           _mm_cmpgt_epi32(_mm_abs_epi32(y), window));
+            count = _mm_add_epi32(count, _mm_andnot_si128(outside, one));
+            sumX = _mm_add_epi32(sumX, _mm_andnot_si128(outside, x));
+            sumY = _mm_add_epi32(sumY, _mm_andnot_si128(outside, y));
+        }
+        alignas(16) int32_t lanes[3][4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(lanes[0]), count);
+        _mm_store_si128(reinterpret_cast<__m128i*>(lanes[1]), sumX);
+        _mm_store_si128(reinterpret_cast<__m128i*>(lanes[2]), sumY);
+        for (int lane = 0; lane < 4; ++lane) {
+            stats.restCount += static_cast<uint32_t>(lanes[0][lane]);
+            stats.restSumX += lanes[1][lane];
+            stats.restSumY += lanes[2][lane];
+        }
+    }
+
+    for (int k = 0; k < 8; ++k) {
+        __m128i m = _mm_max_epi32(extents[k], _mm_shuffle_epi32(extents[k], _MM_SHUFFLE(1, 0, 3, 2)));
+        m = _mm_max_epi32(m, _mm_shuffle_epi32(m, _MM_SHUFFLE(2, 3, 0, 1)));
+        stats.extents[k] = _mm_cvtsi128_si32(m);
+    }
+    if (i < pairs) {
+        stickStatsScalar(xy + 2 * i, pairs - i, restWindow, stats);
+    }
+}
+
+#endif
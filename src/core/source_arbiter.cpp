@@ -0,0 +1,174 @@
+#include "core/source_arbiter.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+
+namespace {
+    // Not exposed by xinput.h, but reported through XInputGetState on most pads
+    constexpr WORD GAMEPAD_GUIDE = 0x0400;
+
+    // Xbox HID collection: buttons 1-10 in this order
+    constexpr WORD HID_BUTTON_MAP[] = {
+        XINPUT_GAMEPAD_A, XINPUT_GAMEPAD_B, XINPUT_GAMEPAD_X, XINPUT_GAMEPAD_Y,
+        XINPUT_GAMEPAD_LEFT_SHOULDER, XINPUT_GAMEPAD_RIGHT_SHOULDER,
+        XINPUT_GAMEPAD_BACK, XINPUT_GAMEPAD_START,
+        XINPUT_GAMEPAD_LEFT_THUMB, XINPUT_GAMEPAD_RIGHT_THUMB,
+    };
+
+    // Hat switch 1-8 clockwise from north, 0 = centered
+    constexpr WORD HAT_MAP[] = {
+        0,
+        XINPUT_GAMEPAD_DPAD_UP,
+        XINPUT_GAMEPAD_DPAD_UP | XINPUT_GAMEPAD_DPAD_RIGHT,
+        XINPUT_GAMEPAD_DPAD_RIGHT,
+        XINPUT_GAMEPAD_DPAD_DOWN | XINPUT_GAMEPAD_DPAD_RIGHT,
+        XINPUT_GAMEPAD_DPAD_DOWN,
+        XINPUT_GAMEPAD_DPAD_DOWN | XINPUT_GAMEPAD_DPAD_LEFT,
+        XINPUT_GAMEPAD_DPAD_LEFT,
+        XINPUT_GAMEPAD_DPAD_UP | XINPUT_GAMEPAD_DPAD_LEFT,
+    };
+
+    inline int combinedTriggers(const XINPUT_GAMEPAD& g) {
+        return static_cast<int>(g.bLeftTrigger) - static_cast<int>(g.bRightTrigger);
+    }
+
+    inline bool stickClose(SHORT a, SHORT b) {
+        return std::abs(static_cast<int>(a) - static_cast<int>(b)) <= SourceArbiter::STICK_MATCH_TOLERANCE;
+    }
+
+    inline SHORT hidStick(LONG value, bool invert) {
+        LONG centered = invert ? (32767 - value) : (value - 32768);
+        return static_cast<SHORT>(std::clamp<LONG>(centered, -32768, 32767));
+    }
+
+    inline bool sameBytes(const XINPUT_GAMEPAD& a, const XINPUT_GAMEPAD& b) {
+        return std::memcmp(&a, &b, sizeof(XINPUT_GAMEPAD)) == 0;
+    }
+}
+
+SourceArbiter::SourceArbiter() {
+}
+
+void SourceArbiter::reset(int device) {
+    if (device < 0 || static_cast<size_t>(device) >= MAX_DEVICES) return;
+    m_devices[device] = DeviceState{};
+}
+
+bool SourceArbiter::submit(int device, CaptureSource source, const XINPUT_GAMEPAD& gamepad, uint64_t timestamp) {
+    if (device < 0 || static_cast<size_t>(device) >= MAX_DEVICES) return false;
+
+    DeviceState& d = m_devices[device];
+    size_t s = static_cast<size_t>(source);
+
+    // Repeats of what this source already said carry no new information
+    if (d.hasSeen[s] && sameBytes(d.lastSeen[s], gamepad)) {
+        return false;
+    }
+    d.lastSeen[s] = gamepad;
+    d.hasSeen[s] = true;
+    d.metrics.updates[s]++;
+
+    // The slower path catching up with a state we already forwarded
+    if (confirmPending(d, source, gamepad, timestamp)) {
+        return false;
+    }
+
+    if (timestamp < d.forwardedTimestamp) {
+        d.metrics.stale[s]++;
+        return false;
+    }
+
+    XINPUT_GAMEPAD forwarded = gamepad;
+    if (source == CaptureSource::HID) {
+        // HID cannot see Guide or separate triggers; keep XInput's view where it agrees
+        const size_t xi = static_cast<size_t>(CaptureSource::XINPUT);
+        if (d.hasSeen[xi]) {
+            forwarded.wButtons |= d.lastSeen[xi].wButtons & GAMEPAD_GUIDE;
+            if (combinedTriggers(d.lastSeen[xi]) == combinedTriggers(gamepad)) {
+                forwarded.bLeftTrigger = d.lastSeen[xi].bLeftTrigger;
+                forwarded.bRightTrigger = d.lastSeen[xi].bRightTrigger;
+            }
+        }
+    }
+
+    d.forwarded = forwarded;
+    d.forwardedTimestamp = timestamp;
+    d.lastWinner = source;
+    d.metrics.wins[s]++;
+
+    d.pending[d.pendingHead] = PendingState{forwarded, timestamp, source, true};
+    d.pendingHead = (d.pendingHead + 1) % PENDING_DEPTH;
+    return true;
+}
+
+bool SourceArbiter::confirmPending(DeviceState& d, CaptureSource source, const XINPUT_GAMEPAD& gamepad, uint64_t timestamp) {
+    // Newest matching state forwarded by the other source
+    PendingState* match = nullptr;
+    for (auto& entry : d.pending) {
+        if (!entry.valid || entry.source == source || !equivalent(entry.gamepad, gamepad)) continue;
+        if (!match || entry.timestamp > match->timestamp) {
+            match = &entry;
+        }
+    }
+    if (!match) {
+        return false;
+    }
+
+    size_t winner = static_cast<size_t>(match->source);
+    uint64_t lead = (timestamp > match->timestamp) ? timestamp - match->timestamp : 0;
+    d.metrics.confirmed[winner]++;
+    d.metrics.totalLeadTicks[winner] += lead;
+    d.metrics.maxLeadTicks[winner] = std::max(d.metrics.maxLeadTicks[winner], lead);
+
+    // Anything older from the winner was skipped by this source and will never be confirmed
+    uint64_t matchTimestamp = match->timestamp;
+    for (auto& entry : d.pending) {
+        if (entry.valid && entry.source == match->source && entry.timestamp <= matchTimestamp) {
+            entry.valid = false;
+        }
+    }
+    return true;
+}
+
+bool SourceArbiter::equivalent(const XINPUT_GAMEPAD& a, const XINPUT_GAMEPAD& b) {
+    return (a.wButtons & ~GAMEPAD_GUIDE) == (b.wButtons & ~GAMEPAD_GUIDE) &&
+           std::abs(combinedTriggers(a) - combinedTriggers(b)) <= 2 &&
+           stickClose(a.sThumbLX, b.sThumbLX) && stickClose(a.sThumbLY, b.sThumbLY) &&
+           stickClose(a.sThumbRX, b.sThumbRX) && stickClose(a.sThumbRY, b.sThumbRY);
+}
+
+XINPUT_GAMEPAD SourceArbiter::fromXboxHID(const ControllerState& state) {
+    XINPUT_GAMEPAD gamepad{};
+
+    for (USAGE usage : state.m_activeButtons) {
+        if (usage >= 1 && usage <= std::size(HID_BUTTON_MAP)) {
+            gamepad.wButtons |= HID_BUTTON_MAP[usage - 1];
+        }
+    }
+
+    auto value = [&state](USAGE usage, LONG fallback) {
+        auto it = state.m_hidValues.find(usage);
+        return it != state.m_hidValues.end() ? it->second : fallback;
+    };
+
+    LONG hat = value(0x39, 0);
+    if (hat >= 0 && hat < static_cast<LONG>(std::size(HAT_MAP))) {
+        gamepad.wButtons |= HAT_MAP[hat];
+    }
+
+    gamepad.sThumbLX = hidStick(value(0x30, 32768), false);
+    gamepad.sThumbLY = hidStick(value(0x31, 32767), true);
+    gamepad.sThumbRX = hidStick(value(0x33, 32768), false);
+    gamepad.sThumbRY = hidStick(value(0x34, 32767), true);
+
+    // Z carries LT above center and RT below it, 128 units per trigger step
+    LONG z = (value(0x32, 32768) - 32768) / 128;
+    if (z > 0) {
+        gamepad.bLeftTrigger = static_cast<BYTE>(std::min<LONG>(z, 255));
+    } else {
+        gamepad.bRightTrigger = static_cast<BYTE>(std::min<LONG>(-z, 255));
+    }
+    return gamepad;
+}
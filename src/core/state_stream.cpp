@@ -0,0 +1,775 @@
+#include "core/state_stream.hpp"
+#include "utils/logger.hpp"
+#include "utils/timing.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/ip.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr uint8_t MAGIC_0 = 'X';
+constexpr uint8_t MAGIC_1 = 'S';
+constexpr uint8_t VERSION = 1;
+constexpr uint8_t FLAG_KEYFRAME = 0x01;
+constexpr uint8_t FLAG_KEYFRAME_REQUEST = 0x02;
+constexpr size_t REQUEST_SIZE = 8;
+
+constexpr uint8_t FIELD_BUTTONS = 0x01;
+constexpr uint8_t FIELD_LEFT_TRIGGER = 0x02;
+constexpr uint8_t FIELD_RIGHT_TRIGGER = 0x04;
+constexpr uint8_t FIELD_LEFT_X = 0x08;
+constexpr uint8_t FIELD_LEFT_Y = 0x10;
+constexpr uint8_t FIELD_RIGHT_X = 0x20;
+constexpr uint8_t FIELD_RIGHT_Y = 0x40;
+constexpr uint8_t FIELD_IDENTITY = 0x80;
+constexpr uint8_t FIELDS_ALL = 0xFF;
+
+constexpr uint8_t META_DINPUT_TARGET = 0x01;
+constexpr uint8_t META_XINPUT_SOURCE = 0x02;
+
+constexpr size_t MAX_DATAGRAM = 65507;
+constexpr int RECEIVER_POLL_MS = 20;   // Bounds how long stop() waits for the thread
+
+// Expedited Forwarding: routers that honor DSCP queue these ahead of bulk traffic
+constexpr int DSCP_EF_TOS = 0xB8;
+
+// Serial number arithmetic, so the sequence may wrap
+bool sequenceAfter(uint32_t a, uint32_t b) {
+    return static_cast<int32_t>(a - b) > 0;
+}
+
+void put16(std::vector<uint8_t>& out, uint16_t value) {
+    out.push_back(static_cast<uint8_t>(value));
+    out.push_back(static_cast<uint8_t>(value >> 8));
+}
+
+void put32(std::vector<uint8_t>& out, uint32_t value) {
+    for (int i = 0; i < 4; ++i) out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+}
+
+void put64(std::vector<uint8_t>& out, uint64_t value) {
+    for (int i = 0; i < 8; ++i) out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+}
+
+/**
+ * Bounds-checked little-endian reader; any overrun sets failed
+ */
+struct Reader {
+    const uint8_t* data;
+    size_t length;
+    size_t offset = 0;
+    bool failed = false;
+
+    bool has(size_t n) {
+        if (offset + n > length) failed = true;
+        return !failed;
+    }
+    uint8_t u8() {
+        return has(1) ? data[offset++] : 0;
+    }
+    uint16_t u16() {
+        if (!has(2)) return 0;
+        uint16_t value = static_cast<uint16_t>(data[offset] | (data[offset + 1] << 8));
+        offset += 2;
+        return value;
+    }
+    uint32_t u32() {
+        if (!has(4)) return 0;
+        uint32_t value = 0;
+        for (int i = 0; i < 4; ++i) value |= static_cast<uint32_t>(data[offset + i]) << (8 * i);
+        offset += 4;
+        return value;
+    }
+    uint64_t u64() {
+        if (!has(8)) return 0;
+        uint64_t value = 0;
+        for (int i = 0; i < 8; ++i) value |= static_cast<uint64_t>(data[offset + i]) << (8 * i);
+        offset += 8;
+        return value;
+    }
+};
+
+uint8_t changedFields(const TranslatedState::GamepadState& a, const TranslatedState::GamepadState& b) {
+    uint8_t mask = 0;
+    if (a.wButtons != b.wButtons) mask |= FIELD_BUTTONS;
+    if (a.bLeftTrigger != b.bLeftTrigger) mask |= FIELD_LEFT_TRIGGER;
+    if (a.bRightTrigger != b.bRightTrigger) mask |= FIELD_RIGHT_TRIGGER;
+    if (a.sThumbLX != b.sThumbLX) mask |= FIELD_LEFT_X;
+    if (a.sThumbLY != b.sThumbLY) mask |= FIELD_LEFT_Y;
+    if (a.sThumbRX != b.sThumbRX) mask |= FIELD_RIGHT_X;
+    if (a.sThumbRY != b.sThumbRY) mask |= FIELD_RIGHT_Y;
+    return mask;
+}
+
+void writeFields(std::vector<uint8_t>& out, uint8_t mask, uint8_t meta, int16_t sourceUserId,
+                 const TranslatedState::GamepadState& pad) {
+    if (mask & FIELD_BUTTONS) put16(out, pad.wButtons);
+    if (mask & FIELD_LEFT_TRIGGER) out.push_back(pad.bLeftTrigger);
+    if (mask & FIELD_RIGHT_TRIGGER) out.push_back(pad.bRightTrigger);
+    if (mask & FIELD_LEFT_X) put16(out, static_cast<uint16_t>(pad.sThumbLX));
+    if (mask & FIELD_LEFT_Y) put16(out, static_cast<uint16_t>(pad.sThumbLY));
+    if (mask & FIELD_RIGHT_X) put16(out, static_cast<uint16_t>(pad.sThumbRX));
+    if (mask & FIELD_RIGHT_Y) put16(out, static_cast<uint16_t>(pad.sThumbRY));
+    if (mask & FIELD_IDENTITY) {
+        out.push_back(meta);
+        put16(out, static_cast<uint16_t>(sourceUserId));
+    }
+}
+
+void readFields(Reader& reader, uint8_t mask, TranslatedState& state) {
+    auto& pad = state.gamepad;
+    if (mask & FIELD_BUTTONS) pad.wButtons = reader.u16();
+    if (mask & FIELD_LEFT_TRIGGER) pad.bLeftTrigger = reader.u8();
+    if (mask & FIELD_RIGHT_TRIGGER) pad.bRightTrigger = reader.u8();
+    if (mask & FIELD_LEFT_X) pad.sThumbLX = static_cast<SHORT>(reader.u16());
+    if (mask & FIELD_LEFT_Y) pad.sThumbLY = static_cast<SHORT>(reader.u16());
+    if (mask & FIELD_RIGHT_X) pad.sThumbRX = static_cast<SHORT>(reader.u16());
+    if (mask & FIELD_RIGHT_Y) pad.sThumbRY = static_cast<SHORT>(reader.u16());
+    if (mask & FIELD_IDENTITY) {
+        uint8_t meta = reader.u8();
+        state.sourceUserId = static_cast<int16_t>(reader.u16());
+        state.targetType = (meta & META_DINPUT_TARGET) ? TranslatedState::TARGET_DINPUT : TranslatedState::TARGET_XINPUT;
+        state.isXInputSource = (meta & META_XINPUT_SOURCE) != 0;
+    }
+}
+
+// Family and address bytes of a socket address, port ignored; IPv4-mapped IPv6
+// addresses compare equal to their IPv4 form. All zero for other families.
+UdpStreamReceiver::HostKey hostKey(const sockaddr* address) {
+    UdpStreamReceiver::HostKey key{};
+    if (address->sa_family == AF_INET) {
+        const auto& in = reinterpret_cast<const sockaddr_in*>(address)->sin_addr;
+        key[0] = 4;
+        std::memcpy(&key[1], &in, 4);
+    } else if (address->sa_family == AF_INET6) {
+        const auto& in6 = reinterpret_cast<const sockaddr_in6*>(address)->sin6_addr;
+        const auto* bytes = reinterpret_cast<const uint8_t*>(&in6);
+        static const uint8_t V4_MAPPED[12] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xFF, 0xFF};
+        if (std::memcmp(bytes, V4_MAPPED, sizeof(V4_MAPPED)) == 0) {
+            key[0] = 4;
+            std::memcpy(&key[1], bytes + 12, 4);
+        } else {
+            key[0] = 6;
+            std::memcpy(&key[1], bytes, 16);
+        }
+    }
+    return key;
+}
+
+uint64_t nowUs() {
+    return static_cast<uint64_t>(TimingUtils::counterToMicroseconds(TimingUtils::getPerformanceCounter()));
+}
+
+#ifdef _WIN32
+using SocketHandle = SOCKET;
+
+bool startSockets() {
+    static const bool started = []() {
+        WSADATA data;
+        return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+    }();
+    return started;
+}
+
+void closeSocket(intptr_t handle) {
+    closesocket(static_cast<SocketHandle>(handle));
+}
+
+bool setNonBlocking(SocketHandle handle) {
+    u_long enabled = 1;
+    return ioctlsocket(handle, FIONBIO, &enabled) == 0;
+}
+
+int lastSocketError() {
+    return WSAGetLastError();
+}
+
+bool wouldBlock(int error) {
+    return error == WSAEWOULDBLOCK;
+}
+
+// An earlier send from this socket hit a closed port; the socket stays usable
+bool peerRefused(int error) {
+    return error == WSAECONNRESET;
+}
+
+int pollSocket(SocketHandle handle, int timeoutMs) {
+    WSAPOLLFD fd{};
+    fd.fd = handle;
+    fd.events = POLLRDNORM;
+    return WSAPoll(&fd, 1, timeoutMs);
+}
+#else
+using SocketHandle = int;
+
+bool startSockets() {
+    return true;
+}
+
+void closeSocket(intptr_t handle) {
+    ::close(static_cast<SocketHandle>(handle));
+}
+
+bool setNonBlocking(SocketHandle handle) {
+    int flags = fcntl(handle, F_GETFL, 0);
+    return flags >= 0 && fcntl(handle, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+int lastSocketError() {
+    return errno;
+}
+
+bool wouldBlock(int error) {
+    return error == EAGAIN || error == EWOULDBLOCK;
+}
+
+bool peerRefused(int error) {
+    return error == ECONNREFUSED;
+}
+
+int pollSocket(SocketHandle handle, int timeoutMs) {
+    pollfd fd{};
+    fd.fd = handle;
+    fd.events = POLLIN;
+    int ready;
+    do {
+        ready = ::poll(&fd, 1, timeoutMs);
+    } while (ready < 0 && errno == EINTR);
+    return ready;
+}
+#endif
+
+} // namespace
+
+StateStreamEncoder::StateStreamEncoder(uint64_t keyframeIntervalUs, uint32_t session)
+    : m_keyframeIntervalUs(keyframeIntervalUs),
+      m_session(session),
+      m_sequence(0),
+      m_keyframeSequence(0),
+      m_keyframeUs(0),
+      m_forceKeyframe(true) {
+    while (m_session == 0) {
+        m_session = std::random_device{}();
+    }
+}
+
+StateStreamEncoder::Slot StateStreamEncoder::makeSlot(const TranslatedState& state) {
+    Slot slot;
+    slot.meta = static_cast<uint8_t>((state.targetType == TranslatedState::TARGET_DINPUT ? META_DINPUT_TARGET : 0) |
+                                     (state.isXInputSource ? META_XINPUT_SOURCE : 0));
+    slot.sourceUserId = static_cast<int16_t>(state.sourceUserId);
+    slot.gamepad = state.gamepad;
+    return slot;
+}
+
+bool StateStreamEncoder::encode(const std::vector<TranslatedState>& states, uint64_t timestampUs,
+                                std::vector<uint8_t>& out) {
+    out.clear();
+    size_t count = std::min(states.size(), MAX_CONTROLLERS);
+    std::vector<Slot> slots;
+    slots.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        slots.push_back(makeSlot(states[i]));
+    }
+
+    bool keyframe = m_forceKeyframe || timestampUs - m_keyframeUs >= m_keyframeIntervalUs ||
+                    slots.size() != m_keyframe.size();
+    for (size_t i = 0; !keyframe && i < slots.size(); ++i) {
+        keyframe = slots[i].meta != m_keyframe[i].meta || slots[i].sourceUserId != m_keyframe[i].sourceUserId;
+    }
+
+    if (!keyframe) {
+        bool unchanged = slots.size() == m_previous.size();
+        for (size_t i = 0; unchanged && i < slots.size(); ++i) {
+            unchanged = changedFields(slots[i].gamepad, m_previous[i].gamepad) == 0;
+        }
+        if (unchanged) {
+            return false;
+        }
+    }
+
+    m_sequence++;
+    if (keyframe) {
+        m_keyframe = slots;
+        m_keyframeSequence = m_sequence;
+        m_keyframeUs = timestampUs;
+        m_forceKeyframe = false;
+    }
+
+    out.reserve(HEADER_SIZE + count * 16);
+    out.push_back(MAGIC_0);
+    out.push_back(MAGIC_1);
+    out.push_back(VERSION);
+    out.push_back(keyframe ? FLAG_KEYFRAME : 0);
+    put32(out, m_session);
+    put32(out, m_sequence);
+    put32(out, m_keyframeSequence);
+    put64(out, timestampUs);
+    size_t countOffset = out.size();
+    out.push_back(0);
+
+    uint8_t entries = 0;
+    for (size_t i = 0; i < slots.size(); ++i) {
+        uint8_t mask = keyframe ? FIELDS_ALL : changedFields(slots[i].gamepad, m_keyframe[i].gamepad);
+        if (mask == 0) {
+            continue;   // Same as in the keyframe
+        }
+        out.push_back(static_cast<uint8_t>(i));
+        out.push_back(mask);
+        writeFields(out, mask, slots[i].meta, slots[i].sourceUserId, slots[i].gamepad);
+        entries++;
+    }
+    out[countOffset] = entries;
+
+    m_previous = std::move(slots);
+    return true;
+}
+
+StateStreamDecoder::StateStreamDecoder()
+    : m_synced(false),
+      m_session(0),
+      m_haveApplied(false),
+      m_lastSequence(0),
+      m_haveKeyframe(false),
+      m_keyframeSequence(0) {
+}
+
+StateStreamDecoder::Result StateStreamDecoder::decode(const uint8_t* data, size_t length, Frame& frame) {
+    Reader reader{data, length};
+    uint8_t magic0 = reader.u8();
+    uint8_t magic1 = reader.u8();
+    uint8_t version = reader.u8();
+    uint8_t flags = reader.u8();
+    uint32_t session = reader.u32();
+    uint32_t sequence = reader.u32();
+    uint32_t keyframeSequence = reader.u32();
+    uint64_t timestampUs = reader.u64();
+    uint8_t count = reader.u8();
+    if (reader.failed || magic0 != MAGIC_0 || magic1 != MAGIC_1 || version != VERSION) {
+        m_stats.malformed++;
+        return Result::MALFORMED;
+    }
+    bool keyframe = (flags & FLAG_KEYFRAME) != 0;
+
+    // A new session is a restarted sender: its sequence starts over. The switch
+    // is only committed once the datagram parsed, so garbage with a valid
+    // header cannot wipe the live session.
+    const bool newSession = !m_synced || session != m_session;
+    const bool haveApplied = !newSession && m_haveApplied;
+    const bool haveKeyframe = !newSession && m_haveKeyframe;
+
+    if (haveApplied && !sequenceAfter(sequence, m_lastSequence)) {
+        m_stats.stale++;
+        return Result::STALE;
+    }
+    if (!keyframe && (!haveKeyframe || keyframeSequence != m_keyframeSequence)) {
+        m_stats.noKeyframe++;
+        frame.session = session;    // Whom to ask for a keyframe
+        return Result::NO_KEYFRAME;
+    }
+
+    // Rebuild into a scratch list so a malformed datagram changes nothing
+    std::vector<TranslatedState> states;
+    if (keyframe) {
+        states.resize(count);
+        for (auto& state : states) {
+            state = TranslatedState{};
+        }
+    } else {
+        states = m_keyframe;
+    }
+    for (uint8_t i = 0; i < count; ++i) {
+        uint8_t slot = reader.u8();
+        uint8_t mask = reader.u8();
+        bool valid = keyframe ? (slot == i && mask == FIELDS_ALL)
+                              : (slot < states.size() && mask != 0 && !(mask & FIELD_IDENTITY));
+        if (reader.failed || !valid) {
+            m_stats.malformed++;
+            return Result::MALFORMED;
+        }
+        readFields(reader, mask, states[slot]);
+    }
+    if (reader.failed || reader.offset != length) {
+        m_stats.malformed++;
+        return Result::MALFORMED;
+    }
+
+    for (size_t i = 0; i < states.size(); ++i) {
+        states[i].sourceSlot = static_cast<int>(i);
+        states[i].timestamp = timestampUs;
+    }
+    if (newSession) {
+        m_synced = true;
+        m_session = session;
+        m_haveApplied = false;
+        m_stats.sessions++;
+    }
+    if (keyframe) {
+        m_keyframe = states;
+        m_keyframeSequence = sequence;
+        m_haveKeyframe = true;
+        m_stats.keyframes++;
+    }
+    if (m_haveApplied) {
+        m_stats.lost += sequence - m_lastSequence - 1;
+    }
+    m_haveApplied = true;
+    m_lastSequence = sequence;
+    m_stats.applied++;
+
+    frame.session = session;
+    frame.sequence = sequence;
+    frame.timestampUs = timestampUs;
+    frame.keyframe = keyframe;
+    frame.states = std::move(states);
+    return Result::APPLIED;
+}
+
+void StateStreamDecoder::encodeKeyframeRequest(uint32_t session, std::vector<uint8_t>& out) {
+    out.clear();
+    out.push_back(MAGIC_0);
+    out.push_back(MAGIC_1);
+    out.push_back(VERSION);
+    out.push_back(FLAG_KEYFRAME_REQUEST);
+    put32(out, session);
+}
+
+bool StateStreamDecoder::isKeyframeRequest(const uint8_t* data, size_t length, uint32_t session) {
+    Reader reader{data, length};
+    uint8_t magic0 = reader.u8();
+    uint8_t magic1 = reader.u8();
+    uint8_t version = reader.u8();
+    uint8_t flags = reader.u8();
+    uint32_t requested = reader.u32();
+    return !reader.failed && length == REQUEST_SIZE && magic0 == MAGIC_0 && magic1 == MAGIC_1 &&
+           version == VERSION && flags == FLAG_KEYFRAME_REQUEST && requested == session;
+}
+
+UdpStreamSender::UdpStreamSender(uint64_t keyframeIntervalUs)
+    : m_socket(INVALID_HANDLE),
+      m_encoder(keyframeIntervalUs) {
+}
+
+UdpStreamSender::~UdpStreamSender() {
+    close();
+}
+
+bool UdpStreamSender::open(const std::string& host, uint16_t port) {
+    close();
+    if (!startSockets()) {
+        Logger::error("Stream: socket startup failed");
+        return false;
+    }
+
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_DGRAM;
+    hints.ai_protocol = IPPROTO_UDP;
+    addrinfo* results = nullptr;
+    if (getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &results) != 0 || !results) {
+        Logger::error("Stream: cannot resolve " + host);
+        return false;
+    }
+
+    for (addrinfo* address = results; address; address = address->ai_next) {
+        SocketHandle handle = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+        if (static_cast<intptr_t>(handle) == INVALID_HANDLE) {
+            continue;
+        }
+        // connect() fixes the peer, so each frame is a plain send()
+        if (connect(handle, address->ai_addr, static_cast<int>(address->ai_addrlen)) != 0 || !setNonBlocking(handle)) {
+            closeSocket(static_cast<intptr_t>(handle));
+            continue;
+        }
+        if (address->ai_family == AF_INET) {
+            int tos = DSCP_EF_TOS;
+            setsockopt(handle, IPPROTO_IP, IP_TOS, reinterpret_cast<const char*>(&tos), sizeof(tos));
+        }
+        m_socket = static_cast<intptr_t>(handle);
+        break;
+    }
+    freeaddrinfo(results);
+
+    if (m_socket == INVALID_HANDLE) {
+        Logger::error("Stream: cannot open a socket to " + host + ":" + std::to_string(port));
+        return false;
+    }
+    m_encoder.forceKeyframe();
+    Logger::log("Stream: sending to " + host + ":" + std::to_string(port) + " (session " +
+                std::to_string(m_encoder.getSession()) + ")");
+    return true;
+}
+
+void UdpStreamSender::close() {
+    if (m_socket != INVALID_HANDLE) {
+        closeSocket(m_socket);
+        m_socket = INVALID_HANDLE;
+    }
+}
+
+bool UdpStreamSender::send(const std::vector<TranslatedState>& states, uint64_t nowUs) {
+    m_stats.frames++;
+    if (m_socket == INVALID_HANDLE) {
+        m_stats.errors++;
+        return false;
+    }
+    readRequests();
+    if (!m_encoder.encode(states, nowUs, m_buffer)) {
+        m_stats.skipped++;
+        return true;
+    }
+
+    auto sent = ::send(static_cast<SocketHandle>(m_socket), reinterpret_cast<const char*>(m_buffer.data()),
+                       static_cast<int>(m_buffer.size()), 0);
+    if (sent != static_cast<decltype(sent)>(m_buffer.size())) {
+        // Full send buffer or no listener (ICMP refused): this frame is lost, the
+        // next one supersedes it. Resend a keyframe so the receiver resyncs quickly.
+        m_stats.errors++;
+        m_encoder.forceKeyframe();
+        return false;
+    }
+    m_stats.datagrams++;
+    m_stats.bytes += m_buffer.size();
+    return true;
+}
+
+void UdpStreamSender::readRequests() {
+    // The socket is connected, so only the receiver's datagrams arrive here
+    uint8_t request[64];
+    while (true) {
+        auto received = recv(static_cast<SocketHandle>(m_socket), reinterpret_cast<char*>(request),
+                             static_cast<int>(sizeof(request)), 0);
+        if (received < 0) {
+            if (peerRefused(lastSocketError())) {
+                continue;
+            }
+            break;
+        }
+        if (StateStreamDecoder::isKeyframeRequest(request, static_cast<size_t>(received), m_encoder.getSession())) {
+            m_encoder.forceKeyframe();
+            m_stats.keyframeRequests++;
+        }
+    }
+}
+
+UdpStreamReceiver::UdpStreamReceiver()
+    : m_socket(INVALID_HANDLE),
+      m_port(0),
+      m_buffer(MAX_DATAGRAM),
+      m_peerFiltered(false),
+      m_requestedSession(0),
+      m_running(false) {
+    TimingUtils::initialize();
+}
+
+UdpStreamReceiver::~UdpStreamReceiver() {
+    stop();
+    close();
+}
+
+bool UdpStreamReceiver::open(uint16_t port, const std::string& bindAddress) {
+    close();
+    if (!startSockets()) {
+        Logger::error("Stream: socket startup failed");
+        return false;
+    }
+
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_DGRAM;
+    hints.ai_protocol = IPPROTO_UDP;
+    hints.ai_flags = AI_PASSIVE;
+    addrinfo* results = nullptr;
+    if (getaddrinfo(bindAddress.c_str(), std::to_string(port).c_str(), &hints, &results) != 0 || !results) {
+        Logger::error("Stream: cannot resolve bind address " + bindAddress);
+        return false;
+    }
+
+    for (addrinfo* address = results; address; address = address->ai_next) {
+        SocketHandle handle = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+        if (static_cast<intptr_t>(handle) == INVALID_HANDLE) {
+            continue;
+        }
+        if (bind(handle, address->ai_addr, static_cast<int>(address->ai_addrlen)) != 0 || !setNonBlocking(handle)) {
+            closeSocket(static_cast<intptr_t>(handle));
+            continue;
+        }
+        sockaddr_storage bound{};
+        socklen_t boundLength = sizeof(bound);
+        if (getsockname(handle, reinterpret_cast<sockaddr*>(&bound), &boundLength) == 0) {
+            m_port = ntohs(bound.ss_family == AF_INET6 ? reinterpret_cast<sockaddr_in6*>(&bound)->sin6_port
+                                                       : reinterpret_cast<sockaddr_in*>(&bound)->sin_port);
+        }
+        m_socket = static_cast<intptr_t>(handle);
+        break;
+    }
+    freeaddrinfo(results);
+
+    if (m_socket == INVALID_HANDLE) {
+        Logger::error("Stream: cannot listen on " + bindAddress + ":" + std::to_string(port));
+        return false;
+    }
+    Logger::log("Stream: listening on " + bindAddress + ":" + std::to_string(m_port));
+    return true;
+}
+
+void UdpStreamReceiver::close() {
+    if (m_socket != INVALID_HANDLE) {
+        closeSocket(m_socket);
+        m_socket = INVALID_HANDLE;
+    }
+}
+
+bool UdpStreamReceiver::setAllowedPeer(const std::string& host) {
+    m_allowedPeers.clear();
+    m_peerFiltered = !host.empty();
+    if (!m_peerFiltered) {
+        return true;
+    }
+    if (!startSockets()) {
+        return false;
+    }
+
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_DGRAM;
+    hints.ai_protocol = IPPROTO_UDP;
+    addrinfo* results = nullptr;
+    if (getaddrinfo(host.c_str(), nullptr, &hints, &results) != 0 || !results) {
+        Logger::error("Stream: cannot resolve peer " + host + ", rejecting every sender");
+        return false;
+    }
+    for (addrinfo* address = results; address; address = address->ai_next) {
+        UdpStreamReceiver::HostKey key = hostKey(address->ai_addr);
+        if (key[0] != 0 && std::find(m_allowedPeers.begin(), m_allowedPeers.end(), key) == m_allowedPeers.end()) {
+            m_allowedPeers.push_back(key);
+        }
+    }
+    freeaddrinfo(results);
+    Logger::log("Stream: accepting frames from " + host + " only");
+    return !m_allowedPeers.empty();
+}
+
+void UdpStreamReceiver::setFrameCallback(FrameCallback callback) {
+    m_callback = std::move(callback);
+}
+
+size_t UdpStreamReceiver::poll(int timeoutMs) {
+    if (m_socket == INVALID_HANDLE) {
+        return 0;
+    }
+    SocketHandle handle = static_cast<SocketHandle>(m_socket);
+    if (pollSocket(handle, timeoutMs) <= 0) {
+        return 0;
+    }
+
+    // Drain everything queued; decode each (keyframes matter) but deliver only the newest
+    size_t datagrams = 0;
+    uint64_t bytes = 0;
+    uint64_t applied = 0;
+    uint64_t receiveUs = 0;
+    uint64_t rejected = 0;
+    uint64_t requests = 0;
+    StateStreamDecoder::Frame newest;
+    StateStreamDecoder::Frame frame;
+    while (true) {
+        sockaddr_storage from{};
+        socklen_t fromLength = sizeof(from);
+        auto received = recvfrom(handle, reinterpret_cast<char*>(m_buffer.data()), static_cast<int>(m_buffer.size()),
+                                 0, reinterpret_cast<sockaddr*>(&from), &fromLength);
+        if (received < 0) {
+            int error = lastSocketError();
+            if (peerRefused(error)) {
+                continue;
+            }
+            if (!wouldBlock(error)) {
+                Logger::error("Stream: receive failed (" + std::to_string(error) + ")");
+            }
+            break;
+        }
+        datagrams++;
+        bytes += static_cast<uint64_t>(received);
+        if (m_peerFiltered &&
+            std::find(m_allowedPeers.begin(), m_allowedPeers.end(),
+                      hostKey(reinterpret_cast<const sockaddr*>(&from))) == m_allowedPeers.end()) {
+            rejected++;
+            continue;
+        }
+
+        auto result = m_decoder.decode(m_buffer.data(), static_cast<size_t>(received), frame);
+        if (result == StateStreamDecoder::Result::APPLIED) {
+            if (frame.keyframe) {
+                m_requestedSession = 0;
+            }
+            std::swap(newest, frame);
+            applied++;
+            receiveUs = nowUs();
+        } else if (result == StateStreamDecoder::Result::NO_KEYFRAME && m_requestedSession != frame.session) {
+            // Deltas stay undecodable until a keyframe arrives; ask for one once
+            // per gap instead of waiting out the keyframe interval. A lost request
+            // still falls back to that interval.
+            m_requestedSession = frame.session;
+            StateStreamDecoder::encodeKeyframeRequest(m_requestedSession, m_request);
+            sendto(handle, reinterpret_cast<const char*>(m_request.data()), static_cast<int>(m_request.size()), 0,
+                   reinterpret_cast<const sockaddr*>(&from), fromLength);
+            requests++;
+        }
+    }
+
+    if (applied > 0 && m_callback) {
+        m_callback(newest);
+    }
+
+    std::lock_guard<std::mutex> lock(m_statsMutex);
+    m_stats.datagrams += datagrams;
+    m_stats.bytes += bytes;
+    m_stats.rejected += rejected;
+    m_stats.keyframeRequests += requests;
+    if (applied > 0) {
+        m_stats.delivered++;
+        m_stats.superseded += applied - 1;
+        m_stats.lastReceiveUs = receiveUs;
+    }
+    m_stats.decoder = m_decoder.getStats();
+    return datagrams;
+}
+
+void UdpStreamReceiver::start() {
+    if (m_socket == INVALID_HANDLE || m_running.exchange(true)) {
+        return;
+    }
+    m_thread = std::thread([this]() {
+        while (m_running) {
+            poll(RECEIVER_POLL_MS);
+        }
+    });
+}
+
+void UdpStreamReceiver::stop() {
+    if (!m_running.exchange(false)) {
+        return;
+    }
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+UdpStreamReceiver::Stats UdpStreamReceiver::getStats() const {
+    std::lock_guard<std::mutex> lock(m_statsMutex);
+    return m_stats;
+}
@@ -0,0 +1,121 @@
+#include "core/synthetic_source.hpp"
+#include "utils/timing.hpp"
+
+#include <chrono>
+
+SyntheticInputSource::SyntheticInputSource(const Config& config)
+    : m_config(config),
+      m_running(false) {
+    if (m_config.controllers == 0) m_config.controllers = 1;
+    if (m_config.reportRateHz == 0) m_config.reportRateHz = 1000;
+    if (m_config.reportsPerEdge == 0) m_config.reportsPerEdge = 1;
+
+    m_pending.resize(m_config.controllers);
+    for (size_t i = 0; i < m_config.controllers; ++i) {
+        ControllerState& state = m_pending[i];
+        state = ControllerState{};
+        state.userId = static_cast<int>(i);
+        state.isConnected = true;
+    }
+    m_pendingUs.assign(m_config.controllers, 0);
+    m_visible = m_pending;
+    m_visibleUs = m_pendingUs;
+}
+
+SyntheticInputSource::~SyntheticInputSource() {
+    stop();
+}
+
+uint64_t SyntheticInputSource::nowUs() {
+    return static_cast<uint64_t>(TimingUtils::counterToMicroseconds(TimingUtils::getPerformanceCounter()));
+}
+
+void SyntheticInputSource::start() {
+    if (m_running.exchange(true)) {
+        return;
+    }
+    TimingUtils::initialize();
+    m_generator = std::thread([this]() { generate(); });
+}
+
+void SyntheticInputSource::stop() {
+    if (!m_running.exchange(false)) {
+        return;
+    }
+    if (m_generator.joinable()) {
+        m_generator.join();
+    }
+}
+
+void SyntheticInputSource::generate() {
+    const uint64_t periodUs = 1000000ull / m_config.reportRateHz;
+    const size_t count = m_config.controllers;
+    std::vector<uint64_t> nextUs(count);
+    std::vector<uint32_t> reports(count, 0);
+    uint64_t startUs = nowUs();
+    for (size_t i = 0; i < count; ++i) {
+        nextUs[i] = startUs + periodUs + (periodUs * i) / count;
+    }
+
+    while (m_running) {
+        uint64_t now = nowUs();
+        uint64_t earliest = UINT64_MAX;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (size_t i = 0; i < count; ++i) {
+                if (now >= nextUs[i]) {
+                    ControllerState& state = m_pending[i];
+                    uint32_t report = ++reports[i];
+                    bool toggle = (report % m_config.reportsPerEdge) == 0;
+                    if (toggle) {
+                        state.xinputState.Gamepad.wButtons ^= XINPUT_GAMEPAD_A;
+                    }
+                    state.xinputState.dwPacketNumber = report;
+                    state.xinputState.Gamepad.sThumbRX = static_cast<SHORT>(static_cast<uint16_t>(report));
+                    state.timestamp = TimingUtils::getPerformanceCounter();
+                    m_pendingUs[i] = nowUs();
+                    if (toggle) {
+                        bool pressed = (state.xinputState.Gamepad.wButtons & XINPUT_GAMEPAD_A) != 0;
+                        m_edges.push_back({i, static_cast<uint16_t>(report), pressed, m_pendingUs[i]});
+                    }
+                    // Fixed grid: a late generator catches up instead of drifting
+                    nextUs[i] += periodUs;
+                    if (nextUs[i] <= now) {
+                        nextUs[i] = now + periodUs;
+                    }
+                }
+                earliest = std::min(earliest, nextUs[i]);
+            }
+        }
+
+        // Sleep most of the gap, spin the last stretch for an accurate report time
+        uint64_t after = nowUs();
+        if (earliest > after + 200) {
+            std::this_thread::sleep_for(std::chrono::microseconds(earliest - after - 200));
+        } else {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void SyntheticInputSource::update(double deltaTime) {
+    (void)deltaTime;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_visible = m_pending;
+    m_visibleUs = m_pendingUs;
+}
+
+std::vector<ControllerState> SyntheticInputSource::getInputStates() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_visible;
+}
+
+uint64_t SyntheticInputSource::lastReportUs(size_t controller) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return controller < m_visibleUs.size() ? m_visibleUs[controller] : 0;
+}
+
+std::vector<SyntheticInputSource::Edge> SyntheticInputSource::getEdges() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_edges;
+}
@@ -0,0 +1,231 @@
+#include "core/target_health.hpp"
+
+#include <algorithm>
+
+TargetHealthMonitor::TargetHealthMonitor() {
+}
+
+void TargetHealthMonitor::setPolicy(const Policy& policy) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_policy = policy;
+}
+
+TargetHealthMonitor::Policy TargetHealthMonitor::getPolicy() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_policy;
+}
+
+void TargetHealthMonitor::track(int targetId) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Target& target = m_targets[targetId];
+    // Keep the lifetime counters, restart the state machine
+    Metrics metrics = target.metrics;
+    target = Target{};
+    target.metrics = metrics;
+    target.metrics.health = Health::HEALTHY;
+    target.metrics.consecutiveFailures = 0;
+    target.metrics.backoffUs = 0;
+}
+
+void TargetHealthMonitor::untrack(int targetId) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_targets.erase(targetId);
+}
+
+void TargetHealthMonitor::recordSubmit(Target& target, bool ok, uint64_t nowUs) {
+    Metrics& metrics = target.metrics;
+    if (ok) {
+        metrics.submits++;
+        metrics.consecutiveFailures = 0;
+        metrics.health = Health::HEALTHY;
+        return;
+    }
+
+    metrics.failures++;
+    metrics.consecutiveFailures++;
+    if (metrics.consecutiveFailures >= m_policy.failuresToReconnect) {
+        // Error budget spent: stop submitting and re-plug after a backoff
+        metrics.health = Health::RECONNECTING;
+        metrics.backoffUs = m_policy.initialBackoffUs;
+        target.reconnectAttempts = 0;
+        target.nextReconnectUs = nowUs + metrics.backoffUs;
+        target.hasRetry = false;
+    } else {
+        metrics.health = Health::DEGRADED;
+    }
+}
+
+void TargetHealthMonitor::recordReconnect(Target& target, bool ok, uint64_t nowUs) {
+    Metrics& metrics = target.metrics;
+    metrics.reconnectAttempts++;
+    if (ok) {
+        metrics.reconnects++;
+        metrics.health = Health::HEALTHY;
+        metrics.consecutiveFailures = 0;
+        metrics.backoffUs = 0;
+        target.reconnectAttempts = 0;
+        return;
+    }
+
+    target.reconnectAttempts++;
+    if (target.reconnectAttempts >= m_policy.maxReconnectAttempts) {
+        metrics.health = Health::DEAD;
+        target.hasLatest = false;
+        return;
+    }
+    metrics.backoffUs = std::min(metrics.backoffUs * 2, m_policy.maxBackoffUs);
+    target.nextReconnectUs = nowUs + metrics.backoffUs;
+}
+
+bool TargetHealthMonitor::submit(VirtualBus& bus, int targetId, const TranslatedState& state, uint64_t nowUs) {
+    uint64_t sequence = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_targets.find(targetId);
+        if (it == m_targets.end()) {
+            return false;
+        }
+        Target& target = it->second;
+        sequence = ++target.submitSequence;
+        target.hasLatest = true;
+        target.latestState = state;
+        if (target.metrics.health == Health::RECONNECTING || target.metrics.health == Health::DEAD) {
+            target.metrics.skipped++;
+            return false;
+        }
+    }
+
+    bool ok = bus.submit(targetId, state);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_targets.find(targetId);
+    if (it == m_targets.end()) {
+        return ok;
+    }
+    Target& target = it->second;
+    recordSubmit(target, ok, nowUs);
+    if (ok) {
+        target.hasRetry = false;
+    } else if (target.metrics.health == Health::DEGRADED && sequence == target.submitSequence) {
+        // A newer report supersedes whatever was waiting for a retry
+        target.hasRetry = true;
+        target.retryState = state;
+        target.retrySequence = sequence;
+        target.retryCount = 0;
+        target.nextRetryUs = nowUs + m_policy.retryDelayUs;
+    }
+    return ok;
+}
+
+void TargetHealthMonitor::service(VirtualBus& bus, uint64_t nowUs) {
+    struct Work {
+        int targetId;
+        bool replug;
+        TranslatedState state;
+        uint64_t sequence;
+    };
+    std::vector<Work> work;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto& entry : m_targets) {
+            Target& target = entry.second;
+            if (target.metrics.health == Health::DEGRADED && target.hasRetry && nowUs >= target.nextRetryUs) {
+                work.push_back({entry.first, false, target.retryState, target.retrySequence});
+            } else if (target.metrics.health == Health::RECONNECTING && nowUs >= target.nextReconnectUs) {
+                work.push_back({entry.first, true, TranslatedState{}, target.submitSequence});
+            }
+        }
+    }
+
+    for (const Work& item : work) {
+        if (item.replug) {
+            bool ok = bus.replug(item.targetId);
+            bool resend = false;
+            TranslatedState latest{};
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                auto it = m_targets.find(item.targetId);
+                if (it == m_targets.end()) continue;
+                recordReconnect(it->second, ok, nowUs);
+                resend = ok && it->second.hasLatest;
+                latest = it->second.latestState;
+            }
+            // Bring the fresh target up to date with the newest report (not the one seen before the re-plug)
+            if (resend) {
+                submit(bus, item.targetId, latest, nowUs);
+            }
+        } else {
+            // A report submitted since the work was collected makes the retry stale
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                auto it = m_targets.find(item.targetId);
+                if (it == m_targets.end()) continue;
+                if (it->second.submitSequence != item.sequence) {
+                    if (it->second.retrySequence == item.sequence) {
+                        it->second.hasRetry = false;
+                    }
+                    continue;
+                }
+            }
+            bool ok = bus.submit(item.targetId, item.state);
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto it = m_targets.find(item.targetId);
+            if (it == m_targets.end()) continue;
+            Target& target = it->second;
+            target.metrics.retries++;
+            target.retryCount++;
+            recordSubmit(target, ok, nowUs);
+            if (ok || target.retryCount >= m_policy.maxRetries) {
+                target.hasRetry = false;
+            } else {
+                target.nextRetryUs = nowUs + m_policy.retryDelayUs;
+            }
+        }
+    }
+}
+
+uint64_t TargetHealthMonitor::nextServiceUs() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    uint64_t earliest = UINT64_MAX;
+    for (const auto& entry : m_targets) {
+        const Target& target = entry.second;
+        if (target.metrics.health == Health::DEGRADED && target.hasRetry) {
+            earliest = std::min(earliest, target.nextRetryUs);
+        }
+        if (target.metrics.health == Health::RECONNECTING) {
+            earliest = std::min(earliest, target.nextReconnectUs);
+        }
+    }
+    return earliest;
+}
+
+TargetHealthMonitor::Health TargetHealthMonitor::health(int targetId) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_targets.find(targetId);
+    return it != m_targets.end() ? it->second.metrics.health : Health::DEAD;
+}
+
+TargetHealthMonitor::Metrics TargetHealthMonitor::getMetrics(int targetId) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_targets.find(targetId);
+    return it != m_targets.end() ? it->second.metrics : Metrics{};
+}
+
+std::vector<int> TargetHealthMonitor::trackedTargets() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<int> ids;
+    for (const auto& entry : m_targets) {
+        ids.push_back(entry.first);
+    }
+    return ids;
+}
+
+const char* TargetHealthMonitor::healthName(Health health) {
+    switch (health) {
+        case Health::HEALTHY: return "healthy";
+        case Health::DEGRADED: return "degraded";
+        case Health::RECONNECTING: return "reconnecting";
+        case Health::DEAD: return "dead";
+    }
+    return "unknown";
+}
@@ -0,0 +1,139 @@
+#include "core/target_injector.hpp"
+#include "utils/threading.hpp"
+#include "utils/timing.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <optional>
+
+namespace {
+
+uint64_t nowUs() {
+    return static_cast<uint64_t>(TimingUtils::counterToMicroseconds(TimingUtils::getPerformanceCounter()));
+}
+
+} // namespace
+
+TargetInjector::TargetInjector(VirtualBus& bus, TargetResolver resolver)
+    : m_bus(bus),
+      m_resolver(std::move(resolver)),
+      m_outputShapingEnabled(false),
+      m_submits(0),
+      m_running(false) {
+    TimingUtils::initialize();
+}
+
+TargetInjector::~TargetInjector() {
+    stop();
+}
+
+void TargetInjector::setOutputShaping(bool enabled, uint32_t maxRateHz) {
+    m_outputShaper.setMaxRateHz(maxRateHz);
+    m_outputShapingEnabled = enabled;
+}
+
+void TargetInjector::setHealthPolicy(const TargetHealthMonitor::Policy& policy) {
+    m_targetHealth.setPolicy(policy);
+}
+
+void TargetInjector::offer(const std::vector<TranslatedState>& states, uint64_t offerUs) {
+    {
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        for (const auto& state : states) {
+            if (m_outputShapingEnabled && m_outputShaper.offer(state, offerUs) != OutputShaper::Decision::SUBMIT) {
+                continue; // Unchanged, or held until its deadline
+            }
+            m_queue.push_back(state);
+        }
+    }
+    m_queueReady.notify_one();
+}
+
+void TargetInjector::pump(uint64_t pumpUs) {
+    {
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        // Coalesced analog states whose deadline has passed queue behind the states released before them
+        if (m_outputShapingEnabled) {
+            for (const auto& state : m_outputShaper.takeDue(pumpUs)) {
+                m_queue.push_back(state);
+            }
+        }
+        m_batch.swap(m_queue);
+    }
+
+    for (const auto& state : m_batch) {
+        submitToTarget(state, pumpUs);
+    }
+    m_batch.clear();
+
+    // Delayed retries of failed reports and backoff re-plugs; dead targets are skipped
+    if (m_targetHealth.nextServiceUs() <= pumpUs) {
+        m_targetHealth.service(m_bus, pumpUs);
+    }
+}
+
+void TargetInjector::submitToTarget(const TranslatedState& state, uint64_t submitUs) {
+    int targetId = m_resolver(state);
+    if (targetId < 0) {
+        return;
+    }
+    m_submits++;
+    if (!m_targetHealth.submit(m_bus, targetId, state, submitUs) && m_outputShapingEnabled) {
+        // Not delivered: the shaper must not treat it as the last submitted report
+        m_outputShaper.forget(state.targetType, state.sourceUserId);
+    }
+}
+
+void TargetInjector::start(bool highPriority, LogSink* sink) {
+    if (m_thread.joinable()) {
+        return;
+    }
+    m_running = true;
+    m_thread = std::thread(&TargetInjector::run, this, highPriority, sink);
+}
+
+void TargetInjector::stop() {
+    {
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        m_running = false;
+    }
+    m_queueReady.notify_all();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+void TargetInjector::run(bool highPriority, LogSink* sink) {
+    std::optional<Logger::Scope> scope;
+    if (sink) {
+        scope.emplace(*sink);
+    }
+    if (highPriority) {
+        ThreadingUtils::setCurrentThreadToHighPriority();
+    }
+
+    while (m_running) {
+        uint64_t wakeCheckUs = nowUs();
+        {
+            std::unique_lock<std::mutex> lock(m_queueMutex);
+            // Sleep until a state is queued, a held state is due or a retry/re-plug is due
+            uint64_t wakeUs = std::min({wakeCheckUs + MAX_IDLE_US,
+                                        m_outputShapingEnabled ? m_outputShaper.nextDeadlineUs() : UINT64_MAX,
+                                        m_targetHealth.nextServiceUs()});
+            if (m_queue.empty() && wakeUs > wakeCheckUs) {
+                m_queueReady.wait_for(lock, std::chrono::microseconds(wakeUs - wakeCheckUs),
+                                      [this]() { return !m_queue.empty() || !m_running; });
+            }
+        }
+        pump(nowUs());
+    }
+}
+
+void TargetInjector::trackTarget(int targetId) {
+    m_targetHealth.track(targetId);
+}
+
+void TargetInjector::forgetTarget(int targetId, TranslatedState::TargetType type, int userId) {
+    m_outputShaper.forget(type, userId);
+    m_targetHealth.untrack(targetId);
+}
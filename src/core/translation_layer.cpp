@@ -1,15 +1,44 @@
 #include "core/translation_layer.hpp"
+#include "core/hid_axis.hpp"
+#include "core/profile_library.hpp"
+#include "core/simd_kernels.hpp"
 #include "utils/timing.hpp"
+#include "utils/work_stealing_pool.hpp"
 
 #include <algorithm>
 #include <cmath>
+#include <cstring>
 
 // Include Windows headers for USAGE and other types
-#ifndef WIN32_LEAN_AND_MEAN
-#define WIN32_LEAN_AND_MEAN
-#endif
-#include <windows.h>
-#include <hidusage.h>
+#include "utils/platform.hpp"
+
+namespace {
+
+// D-pad buttons of the hat switch (usage 0x39): directions 0-7 clockwise from up,
+// anything outside the logical range is centered
+WORD mapHatSwitch(LONG value, LONG logicalMin, const ProfileLibrary::Profile& profile) {
+    static const uint8_t DIRECTIONS[8] = {
+        1 << ProfileLibrary::HAT_UP,
+        1 << ProfileLibrary::HAT_UP | 1 << ProfileLibrary::HAT_RIGHT,
+        1 << ProfileLibrary::HAT_RIGHT,
+        1 << ProfileLibrary::HAT_RIGHT | 1 << ProfileLibrary::HAT_DOWN,
+        1 << ProfileLibrary::HAT_DOWN,
+        1 << ProfileLibrary::HAT_DOWN | 1 << ProfileLibrary::HAT_LEFT,
+        1 << ProfileLibrary::HAT_LEFT,
+        1 << ProfileLibrary::HAT_LEFT | 1 << ProfileLibrary::HAT_UP,
+    };
+    const LONG direction = value - logicalMin;
+    if (direction < 0 || direction >= 8) {
+        return 0;
+    }
+    WORD buttons = 0;
+    for (int d = 0; d < ProfileLibrary::HAT_DIRECTIONS; ++d) {
+        if (DIRECTIONS[direction] & (1 << d)) buttons |= profile.hat[d];
+    }
+    return buttons;
+}
+
+} // namespace
 
 TranslationLayer::TranslationLayer() 
     : m_xinputToDInputEnabled(true), 
@@ -23,26 +52,24 @@ TranslationLayer::TranslationLayer()
       m_rightStickDeadzone(0.15f),
       m_leftStickAntiDeadzone(0.0f),
       m_rightStickAntiDeadzone(0.0f),
-      m_lastButtonChangeTime{} {  // Initialize array to zeros
-    initializeProfiles();
-}
-
-void TranslationLayer::initializeProfiles() {
-    // DS4 / DualSense Profile
-    HIDMappingProfile ds4;
-    ds4.productName = L"Wireless Controller"; // Sony's standard name
-    ds4.buttonMap[1] = XINPUT_GAMEPAD_X; // Square
-    ds4.buttonMap[2] = XINPUT_GAMEPAD_A; // Cross
-    ds4.buttonMap[3] = XINPUT_GAMEPAD_B; // Circle
-    ds4.buttonMap[4] = XINPUT_GAMEPAD_Y; // Triangle
-    ds4.buttonMap[5] = XINPUT_GAMEPAD_LEFT_SHOULDER;
-    ds4.buttonMap[6] = XINPUT_GAMEPAD_RIGHT_SHOULDER;
-    ds4.buttonMap[9] = XINPUT_GAMEPAD_BACK;   // Share
-    ds4.buttonMap[10] = XINPUT_GAMEPAD_START; // Options
-    ds4.buttonMap[11] = XINPUT_GAMEPAD_LEFT_THUMB;
-    ds4.buttonMap[12] = XINPUT_GAMEPAD_RIGHT_THUMB;
-    
-    m_deviceProfiles[ds4.productName] = ds4;
+      m_motionPassthroughEnabled(true),
+      m_gyroToStickEnabled(false),
+      m_lastButtonChangeTime{},  // Initialize array to zeros
+      m_gyroFilters{},
+      m_parallelThreshold(32),
+      m_lastTranslateParallel(false) {
+    m_profiles = ProfileLibrary::builtIn();
+}
+
+TranslationLayer::~TranslationLayer() = default;
+
+void TranslationLayer::setProfileLibrary(std::shared_ptr<const ProfileLibrary> library) {
+    m_profiles = library ? std::move(library) : ProfileLibrary::builtIn();
+    m_slotBindings.clear();     // Cached profiles point into the old library
+}
+
+const ProfileLibrary& TranslationLayer::getProfileLibrary() const {
+    return *m_profiles;
 }
 /**
  * @brief Translates input states from various controller formats to a standardized format
@@ -55,48 +82,311 @@ void TranslationLayer::initializeProfiles() {
  */
 std::vector<TranslatedState> TranslationLayer::translate(const std::vector<ControllerState>& inputStates) {
     std::vector<TranslatedState> translatedStates;
+    if (m_slotBindings.size() < inputStates.size()) {
+        m_slotBindings.resize(inputStates.size());
+    }
+    m_lastTranslateParallel = m_pool && inputStates.size() >= m_parallelThreshold &&
+                              controllersOwnTheirState(inputStates);
+    if (m_lastTranslateParallel) {
+        translateParallel(inputStates, translatedStates);
+    } else {
+        translateRange(inputStates, 0, inputStates.size(), m_scratch, translatedStates);
+    }
+    return translatedStates;
+}
+
+/**
+ * @brief Translates a contiguous range of input slots
+ * 
+ * Touches only the filter state of the controllers in the range, so disjoint
+ * ranges can run concurrently with their own scratch and output vectors.
+ */
+void TranslationLayer::translateRange(const std::vector<ControllerState>& inputStates, size_t begin, size_t end,
+                                      TranslateScratch& scratch, std::vector<TranslatedState>& translatedStates) {
+    scratch.directStates.clear();
     
-    for (const auto& inputState : inputStates) {
+    for (size_t slot = begin; slot < end; ++slot) {
+        const auto& inputState = inputStates[slot];
         TranslatedState translatedState;
         
+        // Split devices produce several outputs from one decoded report
+        if (m_deviceSplitter.isEnabled() && inputState.userId < 0 && !inputState.devicePath.empty()) {
+            const SlotBinding& binding = bindSlot(slot, inputState);
+            if (binding.splitDevice >= 0) {
+                translateSplitDevice(binding.split, slot, inputState, translatedStates);
+                continue;
+            }
+        }
+        
         if (inputState.xinputState.dwPacketNumber > 0 || inputState.userId >= 0) {
             // This appears to be an XInput device
             translatedState = convertXInputToStandard(inputState);
             translatedState.isXInputSource = true;
         } else if (!inputState.devicePath.empty()) {
             // This appears to be a HID device
-            translatedState = convertHIDToStandard(inputState);
+            translatedState = convertHIDToStandard(inputState, bindSlot(slot, inputState));
             translatedState.isXInputSource = false;
         } else {
             // Skip unrecognized input state
             continue;
         }
+        translatedState.sourceSlot = static_cast<int>(slot);
+        
+        // Debounce state is indexed by userId; out-of-range IDs (HID) pass through
+        int userId = translatedState.sourceUserId;
+        uint64_t* lastButtonChangeTime = (userId >= 0 && userId < static_cast<int>(MAX_CONTROLLERS))
+            ? &m_lastButtonChangeTime[userId] : nullptr;
+        applyInputProcessing(translatedState, lastButtonChangeTime, false);
+        
+        scratch.directStates.push_back(translatedStates.size());
+        translatedStates.push_back(translatedState);
+    }
+    
+    // Deadzones of all controllers in one batch, then the per-state steps that depend on them
+    if (m_stickDeadzoneEnabled) {
+        applyBatchedStickDeadzones(translatedStates, scratch);
+    }
+    for (size_t index : scratch.directStates) {
+        TranslatedState& translatedState = translatedStates[index];
+        size_t slot = static_cast<size_t>(translatedState.sourceSlot);
         
-        // Apply SOCD cleaning if enabled
-        if (m_socdCleaningEnabled) {
-            applySOCDControl(translatedState.gamepad);
+        // Gyro aiming is added after the stick deadzone so small rotations survive
+        if (m_gyroToStickEnabled && translatedState.motion.valid && slot < MAX_CONTROLLERS) {
+            m_gyroMapper.apply(translatedState.motion, translatedState.gamepad.wButtons, m_gyroFilters[slot],
+                               translatedState.gamepad.sThumbRX, translatedState.gamepad.sThumbRY);
         }
         
-        // Apply debouncing if enabled
-        if (m_debouncingEnabled) {
-            WORD cleanedButtons = translatedState.gamepad.wButtons;
-            if (applyDebouncing(translatedState.sourceUserId, translatedState.gamepad.wButtons, cleanedButtons)) {
-                translatedState.gamepad.wButtons = cleanedButtons;
+        if (!m_motionPassthroughEnabled) {
+            translatedState.motion.valid = false;
+        }
+    }
+}
+
+/**
+ * @brief Resolves the HID device in a slot once, when it first shows up there
+ * 
+ * Matching a device against the split configuration or the profile library is
+ * a string search, and binding the split plan or the hat switch scans its
+ * value caps; none of it changes while the same device stays in the slot.
+ * Each slot is only touched by the chunk that owns it.
+ */
+const TranslationLayer::SlotBinding& TranslationLayer::bindSlot(size_t slot, const ControllerState& inputState) {
+    SlotBinding& binding = m_slotBindings[slot];
+    if (binding.resolved && binding.vendorId == inputState.vendorId && binding.productId == inputState.productId &&
+        binding.devicePath == inputState.devicePath) {
+        return binding;
+    }
+    binding = SlotBinding{};
+    binding.resolved = true;
+    binding.devicePath = inputState.devicePath;
+    binding.vendorId = inputState.vendorId;
+    binding.productId = inputState.productId;
+    binding.splitDevice = m_deviceSplitter.isEnabled() ? m_deviceSplitter.findDevice(inputState) : -1;
+    if (binding.splitDevice >= 0) {
+        binding.split = m_deviceSplitter.bind(binding.splitDevice, inputState);
+        return binding;
+    }
+    binding.profile =
+        m_profiles->find(inputState.vendorId, inputState.productId, inputState.productName, inputState.versionNumber);
+    for (const auto& cap : inputState.valueCaps) {
+        if (cap.UsagePage == 0x01 && cap.Range.UsageMin == ProfileLibrary::HAT_USAGE) {
+            binding.hatLogicalMin = cap.LogicalMin;
+            break;
+        }
+    }
+    return binding;
+}
+
+/**
+ * @brief True when no two input slots share a piece of filter state
+ * 
+ * Debounce state is keyed by userId and split output state by split device;
+ * two slots reporting the same userId, or two devices matching one split
+ * entry, would make their chunks write the same state. Runs serially before
+ * the chunks, so it also binds the slots of newly seen split devices; the
+ * chunks then only read their cached bindings.
+ */
+bool TranslationLayer::controllersOwnTheirState(const std::vector<ControllerState>& inputStates) {
+    std::array<bool, MAX_CONTROLLERS> userIds{};
+    std::array<bool, DeviceSplitter::MAX_DEVICES> splitDevices{};
+    for (size_t slot = 0; slot < inputStates.size(); ++slot) {
+        const auto& inputState = inputStates[slot];
+        if (m_deviceSplitter.isEnabled() && inputState.userId < 0 && !inputState.devicePath.empty()) {
+            int splitDevice = bindSlot(slot, inputState).splitDevice;
+            if (splitDevice >= 0) {
+                if (splitDevices[splitDevice]) return false;
+                splitDevices[splitDevice] = true;
+                continue;
             }
         }
-        
-        // Apply stick drift mitigation if enabled
-        if (m_stickDeadzoneEnabled) {
-            applyScaledRadialDeadzone(translatedState.gamepad.sThumbLX, translatedState.gamepad.sThumbLY, 
-                                     m_leftStickDeadzone, m_leftStickAntiDeadzone);
-            applyScaledRadialDeadzone(translatedState.gamepad.sThumbRX, translatedState.gamepad.sThumbRY, 
-                                     m_rightStickDeadzone, m_rightStickAntiDeadzone);
+        if (inputState.userId >= 0 && inputState.userId < static_cast<int>(MAX_CONTROLLERS)) {
+            if (userIds[inputState.userId]) return false;
+            userIds[inputState.userId] = true;
         }
-        
-        translatedStates.push_back(translatedState);
+    }
+    return true;
+}
+
+/**
+ * @brief Translates the frame as contiguous chunks on the work-stealing pool
+ * 
+ * Output order matches the serial path: chunks are concatenated in slot order.
+ */
+void TranslationLayer::translateParallel(const std::vector<ControllerState>& inputStates,
+                                         std::vector<TranslatedState>& translatedStates) {
+    const size_t count = inputStates.size();
+    const size_t participants = m_pool->getWorkerCount() + 1;
+    // A few chunks per participant leaves something to steal; at least a SIMD batch each
+    const size_t chunkSize = std::max<size_t>(PARALLEL_MIN_CHUNK, (count + participants * 4 - 1) / (participants * 4));
+    const size_t chunks = (count + chunkSize - 1) / chunkSize;
+    if (m_chunkScratch.size() < chunks) {
+        m_chunkScratch.resize(chunks);
+        m_chunkOutputs.resize(chunks);
     }
     
-    return translatedStates;
+    m_pool->parallelFor(chunks, [&](size_t chunk) {
+        std::vector<TranslatedState>& output = m_chunkOutputs[chunk];
+        output.clear();
+        size_t begin = chunk * chunkSize;
+        translateRange(inputStates, begin, std::min(count, begin + chunkSize), m_chunkScratch[chunk], output);
+    });
+    
+    size_t total = 0;
+    for (size_t chunk = 0; chunk < chunks; ++chunk) total += m_chunkOutputs[chunk].size();
+    translatedStates.reserve(total);
+    for (size_t chunk = 0; chunk < chunks; ++chunk) {
+        translatedStates.insert(translatedStates.end(), m_chunkOutputs[chunk].begin(), m_chunkOutputs[chunk].end());
+    }
+}
+
+void TranslationLayer::setParallelTranslation(size_t workers, size_t minControllers) {
+    m_parallelThreshold = std::max<size_t>(1, minControllers);
+    if (workers == getParallelWorkers()) {
+        return;
+    }
+    m_pool = workers > 0 ? std::make_unique<WorkStealingPool>(workers) : nullptr;
+}
+
+size_t TranslationLayer::getParallelWorkers() const {
+    return m_pool ? m_pool->getWorkerCount() : 0;
+}
+
+/**
+ * @brief Applies the stick deadzones of all non-split states of one translateRange()
+ * 
+ * Gathers the sticks into interleaved x,y buffers so the SIMD kernel sees the
+ * whole batch (4-16 controllers fill a vector) instead of one pair at a time.
+ */
+void TranslationLayer::applyBatchedStickDeadzones(std::vector<TranslatedState>& states, TranslateScratch& scratch) {
+    size_t count = scratch.directStates.size();
+    if (count == 0) {
+        return;
+    }
+    scratch.leftSticks.resize(count * 2);
+    scratch.rightSticks.resize(count * 2);
+    for (size_t i = 0; i < count; ++i) {
+        const auto& gamepad = states[scratch.directStates[i]].gamepad;
+        scratch.leftSticks[2 * i] = gamepad.sThumbLX;
+        scratch.leftSticks[2 * i + 1] = gamepad.sThumbLY;
+        scratch.rightSticks[2 * i] = gamepad.sThumbRX;
+        scratch.rightSticks[2 * i + 1] = gamepad.sThumbRY;
+    }
+    
+    const SimdKernelTable& kernels = SimdKernels::active();
+    kernels.radialDeadzone(scratch.leftSticks.data(), count, m_leftStickDeadzone, m_leftStickAntiDeadzone);
+    kernels.radialDeadzone(scratch.rightSticks.data(), count, m_rightStickDeadzone, m_rightStickAntiDeadzone);
+    
+    for (size_t i = 0; i < count; ++i) {
+        auto& gamepad = states[scratch.directStates[i]].gamepad;
+        gamepad.sThumbLX = scratch.leftSticks[2 * i];
+        gamepad.sThumbLY = scratch.leftSticks[2 * i + 1];
+        gamepad.sThumbRX = scratch.rightSticks[2 * i];
+        gamepad.sThumbRY = scratch.rightSticks[2 * i + 1];
+    }
+}
+
+/**
+ * @brief Applies SOCD cleaning, debouncing and stick deadzones to one state
+ * 
+ * @param translatedState State to clean, modified in place
+ * @param lastButtonChangeTime Debounce state of this output (nullptr = no debouncing)
+ * @param stickDeadzone Apply the stick deadzones here (false when the caller batches them)
+ */
+void TranslationLayer::applyInputProcessing(TranslatedState& translatedState, uint64_t* lastButtonChangeTime,
+                                            bool stickDeadzone) {
+    // Apply SOCD cleaning if enabled
+    if (m_socdCleaningEnabled) {
+        applySOCDControl(translatedState.gamepad);
+    }
+    
+    // Apply debouncing if enabled
+    if (m_debouncingEnabled && lastButtonChangeTime) {
+        WORD cleanedButtons = translatedState.gamepad.wButtons;
+        if (applyDebouncing(*lastButtonChangeTime, translatedState.gamepad.wButtons, cleanedButtons)) {
+            translatedState.gamepad.wButtons = cleanedButtons;
+        }
+    }
+    
+    // Apply stick drift mitigation if enabled
+    if (m_stickDeadzoneEnabled && stickDeadzone) {
+        applyScaledRadialDeadzone(translatedState.gamepad.sThumbLX, translatedState.gamepad.sThumbLY, 
+                                 m_leftStickDeadzone, m_leftStickAntiDeadzone);
+        applyScaledRadialDeadzone(translatedState.gamepad.sThumbRX, translatedState.gamepad.sThumbRY, 
+                                 m_rightStickDeadzone, m_rightStickAntiDeadzone);
+    }
+}
+
+/**
+ * @brief Translates a split device into one state per configured output
+ * 
+ * The report is decoded once by InputCapture; the compiled split plan scatters
+ * it into the outputs. Each output then runs through its own SOCD, debounce and
+ * change-detection state, and is only emitted when its state changed.
+ */
+void TranslationLayer::translateSplitDevice(const DeviceSplitter::Binding& binding, size_t slot,
+                                            const ControllerState& inputState,
+                                            std::vector<TranslatedState>& translatedStates) {
+    const int device = binding.device;
+    std::array<SplitGamepad, DeviceSplitter::MAX_OUTPUTS> outputs;
+    m_deviceSplitter.split(binding, inputState, outputs);
+
+    for (size_t output = 0; output < m_deviceSplitter.getOutputCount(device); ++output) {
+        DeviceSplitter::OutputState& outputState = m_deviceSplitter.outputState(device, static_cast<int>(output));
+
+        TranslatedState state{};
+        state.sourceUserId = DeviceSplitter::virtualUserId(device, static_cast<int>(output));
+        state.sourceSlot = static_cast<int>(slot);
+        state.isXInputSource = false;
+        state.timestamp = inputState.timestamp;
+        state.targetType = m_dinputToXInputEnabled ? TranslatedState::TARGET_XINPUT : TranslatedState::TARGET_DINPUT;
+        state.gamepad.wButtons = outputs[output].wButtons;
+        state.gamepad.bLeftTrigger = outputs[output].bLeftTrigger;
+        state.gamepad.bRightTrigger = outputs[output].bRightTrigger;
+        state.gamepad.sThumbLX = outputs[output].sThumbLX;
+        state.gamepad.sThumbLY = outputs[output].sThumbLY;
+        state.gamepad.sThumbRX = outputs[output].sThumbRX;
+        state.gamepad.sThumbRY = outputs[output].sThumbRY;
+
+        // Deadzones run here: change detection below needs the final sticks
+        applyInputProcessing(state, &outputState.lastButtonChangeTime, true);
+
+        // Change detection: the virtual device keeps its last report
+        SplitGamepad emitted{state.gamepad.wButtons, state.gamepad.bLeftTrigger, state.gamepad.bRightTrigger,
+                             state.gamepad.sThumbLX, state.gamepad.sThumbLY,
+                             state.gamepad.sThumbRX, state.gamepad.sThumbRY};
+        if (outputState.hasEmitted && std::memcmp(&emitted, &outputState.lastEmitted, sizeof(SplitGamepad)) == 0) {
+            continue;
+        }
+        outputState.lastEmitted = emitted;
+        outputState.hasEmitted = true;
+
+        translatedStates.push_back(state);
+    }
+}
+
+void TranslationLayer::setSplitConfiguration(const std::vector<SplitDeviceConfig>& devices) {
+    m_deviceSplitter.configure(devices);
+    m_slotBindings.clear();
 }
 
 void TranslationLayer::setXInputToDInputMapping(bool enabled) {
@@ -143,39 +433,37 @@ void TranslationLayer::setRightStickAntiDeadzone(float antiDeadzone) {
     m_rightStickAntiDeadzone = std::max(0.0f, std::min(1.0f, antiDeadzone));
 }
 
+void TranslationLayer::setMotionPassthroughEnabled(bool enabled) {
+    m_motionPassthroughEnabled = enabled;
+}
+
+void TranslationLayer::setGyroToStickEnabled(bool enabled) {
+    m_gyroToStickEnabled = enabled;
+    m_gyroFilters.fill(GyroFilterState{});
+}
+
+void TranslationLayer::setGyroSensitivity(float sensitivity) {
+    m_gyroMapper.setSensitivity(sensitivity);
+}
+
+void TranslationLayer::setGyroSmoothing(float smoothing) {
+    m_gyroMapper.setSmoothing(smoothing);
+}
+
+void TranslationLayer::setGyroDeadzone(int deadzone) {
+    m_gyroMapper.setDeadzone(deadzone);
+}
+
+void TranslationLayer::setGyroRatchetButtons(WORD buttons) {
+    m_gyroMapper.setRatchetButtons(buttons);
+}
+
 void TranslationLayer::applyScaledRadialDeadzone(SHORT& thumbX, SHORT& thumbY, float deadzone, float antiDeadzone) {
-    // Normalize to -1.0 to 1.0 range
-    float x = static_cast<float>(thumbX) / 32767.0f;
-    float y = static_cast<float>(thumbY) / 32767.0f;
-    
-    // Calculate magnitude
-    float magnitude = std::sqrt(x * x + y * y);
-    
-    // If magnitude is below deadzone, zero out the input
-    if (magnitude < deadzone) {
-        thumbX = 0;
-        thumbY = 0;
-        return;
-    }
-    
-    // Calculate normalized direction
-    float directionX = (magnitude > 0.0f) ? (x / magnitude) : 0.0f;
-    float directionY = (magnitude > 0.0f) ? (y / magnitude) : 0.0f;
-    
-    // Scale magnitude from [deadzone, 1.0] to [0.0, 1.0]
-    float normalizedMagnitude = (magnitude - deadzone) / (1.0f - deadzone);
-    
-    // Apply anti-deadzone (adds minimum output when stick moves past deadzone)
-    if (antiDeadzone > 0.0f && normalizedMagnitude > 0.0f) {
-        normalizedMagnitude = antiDeadzone + (1.0f - antiDeadzone) * normalizedMagnitude;
-    }
-    
-    // Clamp to valid range
-    normalizedMagnitude = std::min(1.0f, normalizedMagnitude);
-    
-    // Convert back to SHORT range
-    thumbX = static_cast<SHORT>(directionX * normalizedMagnitude * 32767.0f);
-    thumbY = static_cast<SHORT>(directionY * normalizedMagnitude * 32767.0f);
+    // Scalar reference and SIMD variants live in simd_kernels; all give identical results
+    SHORT xy[2] = {thumbX, thumbY};
+    SimdKernels::active().radialDeadzone(xy, 1, deadzone, antiDeadzone);
+    thumbX = xy[0];
+    thumbY = xy[1];
 }
 
 /**
@@ -265,30 +553,24 @@ void TranslationLayer::applySOCDControl(TranslatedState::GamepadState& gamepad)
  * Debouncing prevents rapid button state changes caused by mechanical switch bounce.
  * If a button state changes within the debounce interval, the change is ignored.
  * 
- * @param userId Controller user ID (0-15)
+ * @param lastChangeTime Debounce state of the output (last accepted change, in counter ticks)
  * @param currentButtons Current button state
  * @param cleanedButtons Output parameter for debounced button state
  * @return true if input should be processed, false if debouncing is active
  */
-bool TranslationLayer::applyDebouncing(int userId, WORD currentButtons, WORD& cleanedButtons) {
-    // Bounds check for fixed-size array
-    if (userId < 0 || userId >= static_cast<int>(MAX_CONTROLLERS)) {
-        cleanedButtons = currentButtons;
-        return true; // Allow input for out-of-bounds IDs
-    }
-    
+bool TranslationLayer::applyDebouncing(uint64_t& lastChangeTime, WORD currentButtons, WORD& cleanedButtons) {
     // Calculate time threshold in performance counter ticks
     uint64_t currentTime = TimingUtils::getPerformanceCounter();
     uint64_t timeThreshold = TimingUtils::microsecondsToCounter(m_debounceIntervalMs * 1000LL);
     
     // Simple debouncing: if button changed recently, ignore the change
-    if ((currentTime - m_lastButtonChangeTime[userId]) < timeThreshold) {
+    if ((currentTime - lastChangeTime) < timeThreshold) {
         // Return false to indicate debouncing is active
         return false;
     }
     
     // Update the last change time
-    m_lastButtonChangeTime[userId] = currentTime;
+    lastChangeTime = currentTime;
     cleanedButtons = currentButtons;
     return true;
 }
@@ -339,9 +621,10 @@ TranslatedState TranslationLayer::convertXInputToStandard(const ControllerState&
  * - Positive Y = up, Negative Y = down
  * 
  * @param inputState Raw HID controller state with parsed HID values
+ * @param binding The slot's cached device profile and hat range (see bindSlot())
  * @return Standardized translated state
  */
-TranslatedState TranslationLayer::convertHIDToStandard(const ControllerState& inputState) {
+TranslatedState TranslationLayer::convertHIDToStandard(const ControllerState& inputState, const SlotBinding& binding) {
     TranslatedState state{};
     state.sourceUserId = -1;
     state.isXInputSource = false;
@@ -355,35 +638,60 @@ TranslatedState TranslationLayer::convertHIDToStandard(const ControllerState& in
     state.gamepad.sThumbLY = 0;
     state.gamepad.sThumbRX = 0;
     state.gamepad.sThumbRY = 0;
+    
+    // Motion block was already extracted from the raw report during capture
+    state.motion = inputState.motion;
 
-    // 1. Check for device-specific profile
-    auto it = m_deviceProfiles.find(inputState.productName);
-    if (it != m_deviceProfiles.end()) {
-        const auto& profile = it->second;
-        
-        // Map Buttons
+    // 1. Check for device-specific profile (resolved when the device connected)
+    const ProfileLibrary::Profile* profile = binding.profile;
+    if (profile) {
+        // Map Buttons (dense table indexed by usage); digital triggers are applied after the axes
+        uint8_t pulled = 0;
         for (USAGE usage : inputState.m_activeButtons) {
-            auto btnIt = profile.buttonMap.find(usage);
-            if (btnIt != profile.buttonMap.end()) {
-                state.gamepad.wButtons |= btnIt->second;
+            if (usage < ProfileLibrary::BUTTON_USAGES) {
+                state.gamepad.wButtons |= profile->buttons[usage];
+                pulled |= profile->buttonTriggers[usage];
             }
         }
         
-        // Map Axes (Specific logic for DS4 etc.)
-        if (inputState.productName == L"Wireless Controller") {
-            // DS4 axes: 0x30=LX, 0x31=LY, 0x32=RX, 0x35=RY (usually)
-            // Values are 0-255, center at 128
-            // XInput convention: positive Y = up, negative Y = down
-            // DS4 HID: 0 = up, 255 = down (inverted from XInput)
-            for (const auto& [usage, value] : inputState.m_hidValues) {
-                switch (usage) {
-                    case 0x30: state.gamepad.sThumbLX = static_cast<SHORT>((value - 128) * 256); break;
-                    case 0x31: state.gamepad.sThumbLY = static_cast<SHORT>((128 - value) * 256); break; // Invert: 0->up, 255->down
-                    case 0x32: state.gamepad.sThumbRX = static_cast<SHORT>((value - 128) * 256); break;
-                    case 0x35: state.gamepad.sThumbRY = static_cast<SHORT>((128 - value) * 256); break; // Invert: 0->up, 255->down
-                }
+        // Map Axes: fixed transforms (e.g. DS4 0-255 centered at 128) or the device's value caps
+        for (const auto& [usage, value] : inputState.m_hidValues) {
+            if (usage == ProfileLibrary::HAT_USAGE) {
+                state.gamepad.wButtons |= mapHatSwitch(value, binding.hatLogicalMin, *profile);
+            }
+            if (usage < ProfileLibrary::AXIS_FIRST_USAGE ||
+                usage >= ProfileLibrary::AXIS_FIRST_USAGE + ProfileLibrary::AXIS_USAGES) {
+                continue;
+            }
+            const ProfileLibrary::Axis& axis = profile->axes[usage - ProfileLibrary::AXIS_FIRST_USAGE];
+            if (axis.target == ProfileLibrary::AXIS_NONE) {
+                continue;
+            }
+            LONG stick = 0;
+            LONG pull = 0;
+            if (axis.mode == ProfileLibrary::AXIS_FIXED) {
+                // Saturated rather than wrapped: DS4 Y = 0 maps to full up, not full down
+                int64_t scaled = (static_cast<int64_t>(value) - axis.center) * axis.scale;
+                if (axis.invert) scaled = -scaled;
+                stick = static_cast<LONG>(std::clamp<int64_t>(scaled, -32768, 32767));
+                pull = static_cast<LONG>(std::clamp<int64_t>(scaled, 0, 255));
+            } else {
+                HidAxis::Range range = HidAxis::findRange(inputState, usage);
+                stick = HidAxis::toStick(value, range, axis.invert != 0);
+                pull = HidAxis::toTrigger(value, range);
+                if (axis.invert) pull = 255 - pull;
+            }
+            switch (axis.target) {
+                case ProfileLibrary::AXIS_LEFT_X: state.gamepad.sThumbLX = static_cast<SHORT>(stick); break;
+                case ProfileLibrary::AXIS_LEFT_Y: state.gamepad.sThumbLY = static_cast<SHORT>(stick); break;
+                case ProfileLibrary::AXIS_RIGHT_X: state.gamepad.sThumbRX = static_cast<SHORT>(stick); break;
+                case ProfileLibrary::AXIS_RIGHT_Y: state.gamepad.sThumbRY = static_cast<SHORT>(stick); break;
+                case ProfileLibrary::AXIS_LEFT_TRIGGER: state.gamepad.bLeftTrigger = static_cast<BYTE>(pull); break;
+                case ProfileLibrary::AXIS_RIGHT_TRIGGER: state.gamepad.bRightTrigger = static_cast<BYTE>(pull); break;
             }
         }
+        if (pulled & ProfileLibrary::TRIGGER_LEFT) state.gamepad.bLeftTrigger = 255;
+        if (pulled & ProfileLibrary::TRIGGER_RIGHT) state.gamepad.bRightTrigger = 255;
     } else {
         // 2. Fallback to robust generic mapping with proper range validation
         // Standardize Buttons (1-based index to standard bits)
@@ -398,60 +706,17 @@ TranslatedState TranslationLayer::convertHIDToStandard(const ControllerState& in
         }
         
         // Standardize Axes (Generic Desktop Page 0x01) with proper range detection
-        // Find the corresponding value caps to get actual min/max ranges
         for (const auto& [usage, value] : inputState.m_hidValues) {
             // Find the value cap for this usage to get the actual range
-            LONG logicalMin = 0;
-            LONG logicalMax = 65535; // Default assumption
-            
-            // Search for the matching value cap
-            for (const auto& cap : inputState.valueCaps) {
-                if (cap.UsagePage == 0x01 && cap.Range.UsageMin == usage) {
-                    logicalMin = cap.LogicalMin;
-                    logicalMax = cap.LogicalMax;
-                    break;
-                }
-            }
-            
-            // Calculate the center point and range
-            LONG center = (logicalMax + logicalMin) / 2;
-            LONG range = logicalMax - logicalMin;
-            
-            // Avoid division by zero
-            if (range == 0) range = 1;
-            
-            // Normalize to -32768 to 32767 range
-            auto normalizeAxis = [&](LONG rawValue, bool invert = false) -> SHORT {
-                // Calculate normalized value: (value - center) / (range/2) * 32767
-                double normalized = static_cast<double>(rawValue - center) / (range / 2.0) * 32767.0;
-                
-                // Clamp to SHORT range
-                if (normalized > 32767.0) normalized = 32767.0;
-                if (normalized < -32768.0) normalized = -32768.0;
-                
-                SHORT result = static_cast<SHORT>(normalized);
-                return invert ? static_cast<SHORT>(-result) : result;
-            };
-            
-            // Normalize to 0 to 255 range for triggers
-            auto normalizeTrigger = [&](LONG rawValue) -> BYTE {
-                // Map from [logicalMin, logicalMax] to [0, 255]
-                double normalized = static_cast<double>(rawValue - logicalMin) / range * 255.0;
-                
-                // Clamp to BYTE range
-                if (normalized > 255.0) normalized = 255.0;
-                if (normalized < 0.0) normalized = 0.0;
-                
-                return static_cast<BYTE>(normalized);
-            };
+            HidAxis::Range range = HidAxis::findRange(inputState, usage);
             
             switch (usage) {
-                case 0x30: state.gamepad.sThumbLX = normalizeAxis(value, false); break;
-                case 0x31: state.gamepad.sThumbLY = normalizeAxis(value, true); break; // Invert Y
-                case 0x32: state.gamepad.sThumbRX = normalizeAxis(value, false); break;
-                case 0x35: state.gamepad.sThumbRY = normalizeAxis(value, true); break; // Invert Y
-                case 0x33: state.gamepad.bLeftTrigger = normalizeTrigger(value); break;
-                case 0x34: state.gamepad.bRightTrigger = normalizeTrigger(value); break;
+                case 0x30: state.gamepad.sThumbLX = HidAxis::toStick(value, range, false); break;
+                case 0x31: state.gamepad.sThumbLY = HidAxis::toStick(value, range, true); break; // Invert Y
+                case 0x32: state.gamepad.sThumbRX = HidAxis::toStick(value, range, false); break;
+                case 0x35: state.gamepad.sThumbRY = HidAxis::toStick(value, range, true); break; // Invert Y
+                case 0x33: state.gamepad.bLeftTrigger = HidAxis::toTrigger(value, range); break;
+                case 0x34: state.gamepad.bRightTrigger = HidAxis::toTrigger(value, range); break;
             }
         }
     }
@@ -491,17 +756,9 @@ TranslationLayer::DInputState TranslationLayer::translateToDInput(const Translat
     dinputState.lRz = static_cast<LONG>(state.gamepad.bRightTrigger * 257) - 32768;
     
     // 3. Map Buttons
-    // XInput buttons (WORD) -> DInput buttons (128-byte array)
-    if (state.gamepad.wButtons & XINPUT_GAMEPAD_A)              dinputState.rgbButtons[0] = 0x80;
-    if (state.gamepad.wButtons & XINPUT_GAMEPAD_B)              dinputState.rgbButtons[1] = 0x80;
-    if (state.gamepad.wButtons & XINPUT_GAMEPAD_X)              dinputState.rgbButtons[2] = 0x80;
-    if (state.gamepad.wButtons & XINPUT_GAMEPAD_Y)              dinputState.rgbButtons[3] = 0x80;
-    if (state.gamepad.wButtons & XINPUT_GAMEPAD_LEFT_SHOULDER)   dinputState.rgbButtons[4] = 0x80;
-    if (state.gamepad.wButtons & XINPUT_GAMEPAD_RIGHT_SHOULDER)  dinputState.rgbButtons[5] = 0x80;
-    if (state.gamepad.wButtons & XINPUT_GAMEPAD_BACK)           dinputState.rgbButtons[6] = 0x80;
-    if (state.gamepad.wButtons & XINPUT_GAMEPAD_START)          dinputState.rgbButtons[7] = 0x80;
-    if (state.gamepad.wButtons & XINPUT_GAMEPAD_LEFT_THUMB)     dinputState.rgbButtons[8] = 0x80;
-    if (state.gamepad.wButtons & XINPUT_GAMEPAD_RIGHT_THUMB)    dinputState.rgbButtons[9] = 0x80;
+    // XInput buttons (WORD) -> DInput buttons (128-byte array); A, B, X, Y, LB, RB,
+    // Back, Start, LS, RS fill buttons 0-9 (buttons 10+ stay released)
+    SimdKernels::active().encodeDInputButtons(state.gamepad.wButtons, dinputState.rgbButtons);
     
     // 4. Map D-Pad to POV
     // POV is in hundredths of degrees: North=0, East=9000, South=18000, West=27000, Release=-1
@@ -525,6 +782,9 @@ TranslationLayer::DInputState TranslationLayer::translateToDInput(const Translat
     dinputState.bLeftTrigger = state.gamepad.bLeftTrigger;
     dinputState.bRightTrigger = state.gamepad.bRightTrigger;
     
+    // Motion passthrough
+    dinputState.motion = state.motion;
+    
     return dinputState;
 }
 
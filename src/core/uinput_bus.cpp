@@ -0,0 +1,577 @@
+#include "core/uinput_bus.hpp"
+
+#ifdef __linux__
+
+#include "utils/logger.hpp"
+#include "utils/timing.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <linux/uinput.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr const char* UINPUT_PATH = "/dev/uinput";
+constexpr uint64_t WAKE_TOKEN = 0;
+constexpr int MAX_EVENTS = 16;
+constexpr uint32_t MAX_EFFECTS = 16;
+
+struct AxisSetup {
+    uint16_t code;
+    int32_t minimum;
+    int32_t maximum;
+    int32_t fuzz;
+    int32_t flat;
+};
+
+struct ButtonMapping {
+    WORD mask;
+    uint16_t code;
+};
+
+/**
+ * Evdev identity and layout of one target type
+ */
+struct Profile {
+    const char* name;
+    uint16_t vendorId;
+    uint16_t productId;
+    uint16_t version;
+    std::vector<ButtonMapping> buttons;
+    std::vector<uint16_t> triggerButtons;     // Digital L2/R2 (DS4 only)
+    std::vector<AxisSetup> axes;              // Sticks, triggers, hat, in encode() order
+};
+
+const std::vector<ButtonMapping>& faceButtons() {
+    static const std::vector<ButtonMapping> buttons = {
+        {XINPUT_GAMEPAD_A, BTN_SOUTH},
+        {XINPUT_GAMEPAD_B, BTN_EAST},
+        {XINPUT_GAMEPAD_X, BTN_WEST},
+        {XINPUT_GAMEPAD_Y, BTN_NORTH},
+        {XINPUT_GAMEPAD_LEFT_SHOULDER, BTN_TL},
+        {XINPUT_GAMEPAD_RIGHT_SHOULDER, BTN_TR},
+        {XINPUT_GAMEPAD_BACK, BTN_SELECT},
+        {XINPUT_GAMEPAD_START, BTN_START},
+        {XINPUT_GAMEPAD_LEFT_THUMB, BTN_THUMBL},
+        {XINPUT_GAMEPAD_RIGHT_THUMB, BTN_THUMBR},
+    };
+    return buttons;
+}
+
+// xpad: signed 16-bit sticks with its fuzz/flat, 8-bit triggers, D-pad as hat
+const Profile& x360Profile() {
+    static const Profile profile = {
+        "Microsoft X-Box 360 pad", 0x045E, 0x028E, 0x0114,
+        faceButtons(),
+        {},
+        {
+            {ABS_X, -32768, 32767, 16, 128},
+            {ABS_Y, -32768, 32767, 16, 128},
+            {ABS_RX, -32768, 32767, 16, 128},
+            {ABS_RY, -32768, 32767, 16, 128},
+            {ABS_Z, 0, 255, 0, 0},
+            {ABS_RZ, 0, 255, 0, 0},
+            {ABS_HAT0X, -1, 1, 0, 0},
+            {ABS_HAT0Y, -1, 1, 0, 0},
+        },
+    };
+    return profile;
+}
+
+// hid-playstation: byte sticks, analog triggers plus digital L2/R2
+const Profile& ds4Profile() {
+    static const Profile profile = {
+        "Sony Interactive Entertainment Wireless Controller", 0x054C, 0x05C4, 0x8111,
+        faceButtons(),
+        {BTN_TL2, BTN_TR2},
+        {
+            {ABS_X, 0, 255, 0, 0},
+            {ABS_Y, 0, 255, 0, 0},
+            {ABS_RX, 0, 255, 0, 0},
+            {ABS_RY, 0, 255, 0, 0},
+            {ABS_Z, 0, 255, 0, 0},
+            {ABS_RZ, 0, 255, 0, 0},
+            {ABS_HAT0X, -1, 1, 0, 0},
+            {ABS_HAT0Y, -1, 1, 0, 0},
+        },
+    };
+    return profile;
+}
+
+const Profile& profileFor(TranslatedState::TargetType type) {
+    return type == TranslatedState::TARGET_DINPUT ? ds4Profile() : x360Profile();
+}
+
+// Same conversion as the ViGEm DS4 report (Y inverted: 0 = up)
+int32_t stickToByte(SHORT value) {
+    return static_cast<int32_t>(TranslationLayer::normalizeLong(TranslationLayer::scaleShortToLong(value)) * 127.5f + 127.5f);
+}
+
+int32_t stickToByteInverted(SHORT value) {
+    return static_cast<int32_t>(127.5f - TranslationLayer::normalizeLong(TranslationLayer::scaleShortToLong(value)) * 127.5f);
+}
+
+int32_t hatAxis(WORD buttons, WORD negative, WORD positive) {
+    return ((buttons & positive) ? 1 : 0) - ((buttons & negative) ? 1 : 0);
+}
+
+uint64_t nowUs() {
+    return static_cast<uint64_t>(TimingUtils::counterToMicroseconds(TimingUtils::getPerformanceCounter()));
+}
+
+} // namespace
+
+UinputBus::UinputBus(Mode mode)
+    : m_mode(mode),
+      m_epoll(-1),
+      m_wakeFd(-1),
+      m_running(false) {
+    TimingUtils::initialize();
+    if (m_mode != Mode::UINPUT) {
+        return;
+    }
+    m_epoll = epoll_create1(EPOLL_CLOEXEC);
+    m_wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (m_epoll < 0 || m_wakeFd < 0) {
+        Logger::error("uinput: epoll/eventfd setup failed: " + std::string(std::strerror(errno)));
+        return;
+    }
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.u64 = WAKE_TOKEN;
+    epoll_ctl(m_epoll, EPOLL_CTL_ADD, m_wakeFd, &event);
+}
+
+UinputBus::~UinputBus() {
+    stop();
+    for (auto& target : m_targets) {
+        destroyDevice(*target);
+    }
+    if (m_wakeFd >= 0) close(m_wakeFd);
+    if (m_epoll >= 0) close(m_epoll);
+}
+
+bool UinputBus::uinputAvailable() {
+    int fd = open(UINPUT_PATH, O_RDWR | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    close(fd);
+    return true;
+}
+
+std::unique_ptr<UinputBus> UinputBus::create() {
+    if (uinputAvailable()) {
+        return std::make_unique<UinputBus>(Mode::UINPUT);
+    }
+    Logger::log("uinput: " + std::string(UINPUT_PATH) + " unavailable, virtual gamepads stay in memory");
+    return std::make_unique<UinputBus>(Mode::MEMORY);
+}
+
+void UinputBus::encode(TranslatedState::TargetType type, const TranslatedState& state, std::vector<Event>& out) {
+    const Profile& profile = profileFor(type);
+    const auto& pad = state.gamepad;
+    out.clear();
+
+    for (const auto& button : profile.buttons) {
+        out.push_back(Event{EV_KEY, button.code, (pad.wButtons & button.mask) ? 1 : 0});
+    }
+    if (!profile.triggerButtons.empty()) {
+        out.push_back(Event{EV_KEY, profile.triggerButtons[0], pad.bLeftTrigger > 0 ? 1 : 0});
+        out.push_back(Event{EV_KEY, profile.triggerButtons[1], pad.bRightTrigger > 0 ? 1 : 0});
+    }
+
+    if (type == TranslatedState::TARGET_DINPUT) {
+        out.push_back(Event{EV_ABS, ABS_X, stickToByte(pad.sThumbLX)});
+        out.push_back(Event{EV_ABS, ABS_Y, stickToByteInverted(pad.sThumbLY)});
+        out.push_back(Event{EV_ABS, ABS_RX, stickToByte(pad.sThumbRX)});
+        out.push_back(Event{EV_ABS, ABS_RY, stickToByteInverted(pad.sThumbRY)});
+    } else {
+        // xpad reports Y as ~value: down is positive
+        out.push_back(Event{EV_ABS, ABS_X, pad.sThumbLX});
+        out.push_back(Event{EV_ABS, ABS_Y, static_cast<SHORT>(~pad.sThumbLY)});
+        out.push_back(Event{EV_ABS, ABS_RX, pad.sThumbRX});
+        out.push_back(Event{EV_ABS, ABS_RY, static_cast<SHORT>(~pad.sThumbRY)});
+    }
+    out.push_back(Event{EV_ABS, ABS_Z, pad.bLeftTrigger});
+    out.push_back(Event{EV_ABS, ABS_RZ, pad.bRightTrigger});
+    out.push_back(Event{EV_ABS, ABS_HAT0X, hatAxis(pad.wButtons, XINPUT_GAMEPAD_DPAD_LEFT, XINPUT_GAMEPAD_DPAD_RIGHT)});
+    out.push_back(Event{EV_ABS, ABS_HAT0Y, hatAxis(pad.wButtons, XINPUT_GAMEPAD_DPAD_UP, XINPUT_GAMEPAD_DPAD_DOWN)});
+}
+
+UinputBus::Target* UinputBus::findTarget(int targetId) {
+    for (auto& target : m_targets) {
+        if (target->id == targetId) return target.get();
+    }
+    return nullptr;
+}
+
+const UinputBus::Target* UinputBus::findTarget(int targetId) const {
+    for (const auto& target : m_targets) {
+        if (target->id == targetId) return target.get();
+    }
+    return nullptr;
+}
+
+bool UinputBus::createDevice(Target& target) {
+    target.emitted.clear();
+    target.effects.clear();
+    target.playing.clear();
+    target.stats.creations++;
+    if (m_mode == Mode::MEMORY) {
+        return true;
+    }
+
+    const Profile& profile = profileFor(target.type);
+    int fd = open(UINPUT_PATH, O_RDWR | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) {
+        Logger::error("uinput: cannot open " + std::string(UINPUT_PATH) + ": " + std::strerror(errno));
+        return false;
+    }
+
+    bool ok = ioctl(fd, UI_SET_EVBIT, EV_KEY) == 0 && ioctl(fd, UI_SET_EVBIT, EV_ABS) == 0 &&
+              ioctl(fd, UI_SET_EVBIT, EV_FF) == 0 && ioctl(fd, UI_SET_FFBIT, FF_RUMBLE) == 0;
+    for (const auto& button : profile.buttons) {
+        ok = ok && ioctl(fd, UI_SET_KEYBIT, button.code) == 0;
+    }
+    for (uint16_t code : profile.triggerButtons) {
+        ok = ok && ioctl(fd, UI_SET_KEYBIT, code) == 0;
+    }
+    for (const auto& axis : profile.axes) {
+        uinput_abs_setup abs{};
+        abs.code = axis.code;
+        abs.absinfo.minimum = axis.minimum;
+        abs.absinfo.maximum = axis.maximum;
+        abs.absinfo.fuzz = axis.fuzz;
+        abs.absinfo.flat = axis.flat;
+        ok = ok && ioctl(fd, UI_SET_ABSBIT, axis.code) == 0 && ioctl(fd, UI_ABS_SETUP, &abs) == 0;
+    }
+
+    uinput_setup setup{};
+    setup.id.bustype = BUS_USB;   // So SDL and games apply their X360/DS4 mappings by vendor/product
+    setup.id.vendor = profile.vendorId;
+    setup.id.product = profile.productId;
+    setup.id.version = profile.version;
+    std::strncpy(setup.name, profile.name, UINPUT_MAX_NAME_SIZE - 1);
+    setup.ff_effects_max = MAX_EFFECTS;
+    ok = ok && ioctl(fd, UI_DEV_SETUP, &setup) == 0 && ioctl(fd, UI_DEV_CREATE) == 0;
+    if (!ok) {
+        Logger::error("uinput: cannot create target " + std::to_string(target.id) + ": " + std::strerror(errno));
+        close(fd);
+        return false;
+    }
+
+    char sysname[64] = {};
+    if (ioctl(fd, UI_GET_SYSNAME(sizeof(sysname)), sysname) >= 0) {
+        target.sysname = sysname;
+    }
+
+    // Force-feedback requests wake the feedback pump
+    epoll_event event{};
+    event.events = EPOLLIN;
+    for (size_t i = 0; i < m_targets.size(); ++i) {
+        if (m_targets[i].get() == &target) event.data.u64 = i + 1;
+    }
+    epoll_ctl(m_epoll, EPOLL_CTL_ADD, fd, &event);
+    target.fd = fd;
+    Logger::log("uinput: target " + std::to_string(target.id) + " created as " + profile.name +
+                (target.sysname.empty() ? std::string() : " (" + target.sysname + ")"));
+    return true;
+}
+
+void UinputBus::destroyDevice(Target& target) {
+    if (target.fd < 0) {
+        return;
+    }
+    epoll_ctl(m_epoll, EPOLL_CTL_DEL, target.fd, nullptr);
+    ioctl(target.fd, UI_DEV_DESTROY);
+    close(target.fd);
+    target.fd = -1;
+    target.sysname.clear();
+}
+
+bool UinputBus::submit(int targetId, const TranslatedState& state) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Target* target = findTarget(targetId);
+    if (!target) {
+        auto created = std::make_unique<Target>();
+        created->id = targetId;
+        created->type = state.targetType;
+        created->fd = -1;
+        m_targets.push_back(std::move(created));
+        target = m_targets.back().get();
+        if (!createDevice(*target)) {
+            return false;
+        }
+    }
+    target->stats.submits++;
+    if (m_mode == Mode::UINPUT && target->fd < 0) {
+        return false;   // Lost; TargetHealthMonitor re-plugs
+    }
+
+    std::vector<Event>& current = target->encoded;
+    encode(target->type, state, current);
+
+    // Only what changed since the last write, then one SYN_REPORT
+    std::vector<Event>& batch = target->batch;
+    batch.clear();
+    for (size_t i = 0; i < current.size(); ++i) {
+        if (target->emitted.size() != current.size() || target->emitted[i].value != current[i].value) {
+            batch.push_back(current[i]);
+        }
+    }
+    if (batch.empty()) {
+        return true;
+    }
+
+    if (m_mode == Mode::UINPUT) {
+        std::vector<input_event>& events = target->events;
+        events.assign(batch.size() + 1, input_event{});
+        for (size_t i = 0; i < batch.size(); ++i) {
+            events[i].type = batch[i].type;
+            events[i].code = batch[i].code;
+            events[i].value = batch[i].value;
+        }
+        events.back().type = EV_SYN;
+        events.back().code = SYN_REPORT;
+        events.back().value = 0;
+
+        ssize_t written;
+        do {
+            written = write(target->fd, events.data(), events.size() * sizeof(input_event));
+        } while (written < 0 && errno == EINTR);
+        if (written != static_cast<ssize_t>(events.size() * sizeof(input_event))) {
+            return false;
+        }
+    }
+
+    // Swap rather than copy: the old vectors become the next submit's scratch
+    target->emitted.swap(current);
+    target->stats.writes++;
+    target->stats.events += batch.size();
+    target->stats.lastWriteUs = nowUs();
+    target->lastBatch.swap(batch);
+    return true;
+}
+
+bool UinputBus::replug(int targetId) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Target* target = findTarget(targetId);
+    if (!target) {
+        return false;
+    }
+    destroyDevice(*target);
+    return createDevice(*target);
+}
+
+void UinputBus::setRumbleCallback(RumbleCallback callback) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_rumbleCallback = std::move(callback);
+}
+
+bool UinputBus::uploadEffect(int targetId, const ff_effect& effect) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Target* target = findTarget(targetId);
+    if (!target || effect.type != FF_RUMBLE || effect.id < 0 || effect.id >= static_cast<int>(MAX_EFFECTS)) {
+        return false;
+    }
+    target->effects[effect.id] = effect;
+    return true;
+}
+
+bool UinputBus::eraseEffect(int targetId, int effectId) {
+    std::vector<Rumble> rumble;
+    RumbleCallback callback;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Target* target = findTarget(targetId);
+        if (!target || target->effects.erase(effectId) == 0) {
+            return false;
+        }
+        if (target->playing.erase(effectId)) {
+            rumble.push_back(rumbleOf(*target));
+            callback = m_rumbleCallback;
+        }
+    }
+    deliverRumble(callback, rumble);
+    return true;
+}
+
+void UinputBus::playEffect(int targetId, int effectId, bool play) {
+    std::vector<Rumble> rumble;
+    RumbleCallback callback;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Target* target = findTarget(targetId);
+        if (!target || target->effects.count(effectId) == 0) {
+            return;
+        }
+        if (play) {
+            target->playing[effectId] = true;
+        } else {
+            target->playing.erase(effectId);
+        }
+        rumble.push_back(rumbleOf(*target));
+        callback = m_rumbleCallback;
+    }
+    deliverRumble(callback, rumble);
+}
+
+// Caller holds m_mutex. Strongest playing effect per motor; nothing playing stops both.
+UinputBus::Rumble UinputBus::rumbleOf(Target& target) {
+    uint16_t strong = 0;
+    uint16_t weak = 0;
+    for (const auto& [effectId, playing] : target.playing) {
+        const ff_effect& effect = target.effects[effectId];
+        strong = std::max(strong, effect.u.rumble.strong_magnitude);
+        weak = std::max(weak, effect.u.rumble.weak_magnitude);
+    }
+    target.stats.rumbleEvents++;
+    return Rumble{target.id, static_cast<float>(strong) / 65535.0f, static_cast<float>(weak) / 65535.0f};
+}
+
+// Called without m_mutex, so the callback may call back into the bus
+void UinputBus::deliverRumble(const RumbleCallback& callback, const std::vector<Rumble>& rumble) {
+    if (!callback) {
+        return;
+    }
+    for (const Rumble& levels : rumble) {
+        callback(levels.targetId, levels.strong, levels.weak);
+    }
+}
+
+// Caller holds m_mutex; rumble changes are appended for delivery after the lock is released
+void UinputBus::handleFeedback(Target& target, const input_event& event, std::vector<Rumble>& rumble) {
+    if (event.type == EV_UINPUT && event.code == UI_FF_UPLOAD) {
+        uinput_ff_upload upload{};
+        upload.request_id = static_cast<uint32_t>(event.value);
+        if (ioctl(target.fd, UI_BEGIN_FF_UPLOAD, &upload) < 0) return;
+        const ff_effect& effect = upload.effect;
+        if (effect.type == FF_RUMBLE && effect.id >= 0 && effect.id < static_cast<int>(MAX_EFFECTS)) {
+            target.effects[effect.id] = effect;
+            upload.retval = 0;
+        } else {
+            upload.retval = -EINVAL;
+        }
+        ioctl(target.fd, UI_END_FF_UPLOAD, &upload);
+    } else if (event.type == EV_UINPUT && event.code == UI_FF_ERASE) {
+        uinput_ff_erase erase{};
+        erase.request_id = static_cast<uint32_t>(event.value);
+        if (ioctl(target.fd, UI_BEGIN_FF_ERASE, &erase) < 0) return;
+        target.effects.erase(static_cast<int>(erase.effect_id));
+        bool wasPlaying = target.playing.erase(static_cast<int>(erase.effect_id)) > 0;
+        erase.retval = 0;
+        ioctl(target.fd, UI_END_FF_ERASE, &erase);
+        if (wasPlaying) rumble.push_back(rumbleOf(target));
+    } else if (event.type == EV_FF && event.code < MAX_EFFECTS && target.effects.count(event.code)) {
+        if (event.value > 0) {
+            target.playing[event.code] = true;
+        } else {
+            target.playing.erase(event.code);
+        }
+        rumble.push_back(rumbleOf(target));
+    }
+}
+
+size_t UinputBus::pumpFeedback(int timeoutMs) {
+    if (m_mode != Mode::UINPUT || m_epoll < 0) {
+        return 0;
+    }
+    epoll_event events[MAX_EVENTS];
+    int ready;
+    do {
+        ready = epoll_wait(m_epoll, events, MAX_EVENTS, timeoutMs);
+    } while (ready < 0 && errno == EINTR);
+
+    size_t handled = 0;
+    std::vector<Rumble> rumble;
+    RumbleCallback callback;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (int i = 0; i < ready; ++i) {
+            uint64_t token = events[i].data.u64;
+            if (token == WAKE_TOKEN) {
+                uint64_t count;
+                while (read(m_wakeFd, &count, sizeof(count)) > 0) {}
+                continue;
+            }
+            if (token - 1 >= m_targets.size()) continue;
+            Target& target = *m_targets[token - 1];
+            input_event event;
+            while (target.fd >= 0 && read(target.fd, &event, sizeof(event)) == static_cast<ssize_t>(sizeof(event))) {
+                handleFeedback(target, event, rumble);
+                handled++;
+            }
+        }
+        if (!rumble.empty()) {
+            callback = m_rumbleCallback;
+        }
+    }
+    deliverRumble(callback, rumble);
+    return handled;
+}
+
+void UinputBus::start() {
+    if (m_mode != Mode::UINPUT || m_running.exchange(true)) {
+        return;
+    }
+    m_thread = std::thread([this]() {
+        while (m_running) {
+            pumpFeedback(-1);
+        }
+    });
+}
+
+void UinputBus::stop() {
+    if (!m_running.exchange(false)) {
+        return;
+    }
+    uint64_t one = 1;
+    ssize_t written = write(m_wakeFd, &one, sizeof(one));
+    (void)written;
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+std::vector<UinputBus::Event> UinputBus::getLastBatch(int targetId) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const Target* target = findTarget(targetId);
+    return target ? target->lastBatch : std::vector<Event>();
+}
+
+int32_t UinputBus::getValue(int targetId, uint16_t type, uint16_t code) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const Target* target = findTarget(targetId);
+    if (target) {
+        for (const auto& event : target->emitted) {
+            if (event.type == type && event.code == code) return event.value;
+        }
+    }
+    return 0;
+}
+
+UinputBus::Stats UinputBus::getStats(int targetId) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const Target* target = findTarget(targetId);
+    return target ? target->stats : Stats();
+}
+
+std::string UinputBus::getDeviceName(int targetId) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const Target* target = findTarget(targetId);
+    return target ? target->sysname : std::string();
+}
+
+size_t UinputBus::getTargetCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_targets.size();
+}
+
+#endif // __linux__
@@ -2,6 +2,7 @@
 #include "utils/timing.hpp"
 #include "utils/hidhide_controller.hpp"
 
+#include <algorithm>
 #include <thread>
 #include <sstream>
 #include <iostream>
@@ -9,8 +10,6 @@
 
 // ViGEmClient.h is already included in the header with proper warning suppression
 
-VirtualDeviceEmulator* VirtualDeviceEmulator::m_instance = nullptr;
-
 void CALLBACK VirtualDeviceEmulator::x360Notification(
     PVIGEM_CLIENT client,
     PVIGEM_TARGET target,
@@ -19,14 +18,23 @@ void CALLBACK VirtualDeviceEmulator::x360Notification(
     BYTE ledNumber,
     LPVOID userData
 ) {
-    if (m_instance && m_instance->m_rumbleCallback) {
-        int userId = static_cast<int>(reinterpret_cast<uintptr_t>(userData));
+    auto* context = static_cast<RumbleContext*>(userData);
+    if (context && context->owner->m_rumbleCallback) {
         float left = static_cast<float>(largeMotor) / 255.0f;
         float right = static_cast<float>(smallMotor) / 255.0f;
-        m_instance->m_rumbleCallback(userId, left, right);
+        context->owner->m_rumbleCallback(context->userId, left, right);
     }
 }
 
+// Caller holds m_devicesMutex
+VirtualDeviceEmulator::RumbleContext* VirtualDeviceEmulator::rumbleContext(int userId) {
+    auto& context = m_rumbleContexts[userId];
+    if (!context) {
+        context = std::make_unique<RumbleContext>(RumbleContext{this, userId});
+    }
+    return context.get();
+}
+
 VirtualDeviceEmulator::VirtualDeviceEmulator()
     : m_initialized(false),
       m_running(false),
@@ -34,8 +42,10 @@ VirtualDeviceEmulator::VirtualDeviceEmulator()
       m_hidHideController(nullptr),
       m_hidHideEnabled(false),
       m_rumbleEnabled(true),
-      m_rumbleIntensity(1.0f) {
-    m_instance = this;
+      m_rumbleIntensity(1.0f),
+      m_injector(*this, [this](const TranslatedState& state) {
+          return findVirtualDeviceId(state.targetType, state.sourceUserId);
+      }) {
 }
 
 VirtualDeviceEmulator::~VirtualDeviceEmulator() {
@@ -61,32 +71,7 @@ bool VirtualDeviceEmulator::initialize() {
     m_running = true;
     
     // Start injection thread with high priority
-    m_injectionThread = std::make_unique<std::thread>([this]() {
-        SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_HIGHEST);
-        
-        while (m_running) {
-            // Process injection queue
-            {
-                std::lock_guard<std::mutex> lock(m_injectionQueueMutex);
-                if (!m_injectionQueue.empty()) {
-                    for (const auto& state : m_injectionQueue) {
-                        // Send the translated state to the appropriate virtual device
-                        if (state.targetType == TranslatedState::TARGET_XINPUT) {
-                            auto xinputState = TranslationLayer().translateToXInput(state);
-                            sendToVirtualXInputDevice(state.sourceUserId, xinputState);
-                        } else {
-                            auto dinputState = TranslationLayer().translateToDInput(state);
-                            sendToVirtualDInputDevice(state.sourceUserId, dinputState);
-                        }
-                    }
-                    m_injectionQueue.clear();
-                }
-            }
-            
-            // Small sleep to prevent 100% CPU usage
-            std::this_thread::sleep_for(std::chrono::microseconds(100));
-        }
-    });
+    m_injector.start(true);
     
     return true;
 }
@@ -97,10 +82,7 @@ void VirtualDeviceEmulator::shutdown() {
     }
 
     m_running = false;
-
-    if (m_injectionThread && m_injectionThread->joinable()) {
-        m_injectionThread->join();
-    }
+    m_injector.stop();
 
     // Destroy all virtual devices
     {
@@ -127,28 +109,59 @@ bool VirtualDeviceEmulator::sendInput(const std::vector<TranslatedState>& transl
         return false;
     }
     
-    // Process each translated state immediately if possible, otherwise queue
-    for (const auto& state : translatedStates) {
-        if (state.targetType == TranslatedState::TARGET_XINPUT) {
-            auto xinputState = TranslationLayer().translateToXInput(state);
-            if (!sendToVirtualXInputDevice(state.sourceUserId, xinputState)) {
-                // If immediate send fails, add to queue for retry
-                std::lock_guard<std::mutex> lock(m_injectionQueueMutex);
-                m_injectionQueue.push_back(state);
-            }
-        } else {
-            auto dinputState = TranslationLayer().translateToDInput(state);
-            if (!sendToVirtualDInputDevice(state.sourceUserId, dinputState)) {
-                // If immediate send fails, add to queue for retry
-                std::lock_guard<std::mutex> lock(m_injectionQueueMutex);
-                m_injectionQueue.push_back(state);
-            }
-        }
-    }
+    uint64_t nowUs = static_cast<uint64_t>(TimingUtils::counterToMicroseconds(TimingUtils::getPerformanceCounter()));
+    
+    // Queue each released state for the injection thread, which sends and retries in order
+    m_injector.offer(translatedStates, nowUs);
     
     return true;
 }
 
+int VirtualDeviceEmulator::findVirtualDeviceId(TranslatedState::TargetType type, int userId) const {
+    std::lock_guard<std::mutex> lock(m_devicesMutex);
+    auto it = std::find_if(m_virtualDevices.begin(), m_virtualDevices.end(),
+                          [type, userId](const VirtualDevice& device) {
+                              return device.userId == userId && device.type == type;
+                          });
+    return it != m_virtualDevices.end() ? it->id : -1;
+}
+
+bool VirtualDeviceEmulator::submit(int targetId, const TranslatedState& state) {
+    (void)targetId; // Targets are addressed by type and userId, which map 1:1 to the id
+    return submitTranslatedState(state);
+}
+
+bool VirtualDeviceEmulator::replug(int targetId) {
+    std::lock_guard<std::mutex> lock(m_devicesMutex);
+    auto it = std::find_if(m_virtualDevices.begin(), m_virtualDevices.end(),
+                          [targetId](const VirtualDevice& device) {
+                              return device.id == targetId;
+                          });
+    if (it == m_virtualDevices.end()) {
+        return false;
+    }
+    
+    // Remove whatever is left of the old target and add a fresh one on the bus
+    destroyVirtualDeviceInternal(*it);
+    it->target = (it->type == TranslatedState::TARGET_XINPUT)
+        ? createVirtualXInputDeviceTarget(it->userId)
+        : createVirtualDInputDeviceTarget(it->userId);
+    it->connected = (it->target != nullptr);
+    
+    Logger::log("VirtualDeviceEmulator: Re-plug of virtual device " + std::to_string(targetId) +
+                (it->connected ? " succeeded" : " failed"));
+    return it->connected;
+}
+
+bool VirtualDeviceEmulator::submitTranslatedState(const TranslatedState& state) {
+    if (state.targetType == TranslatedState::TARGET_XINPUT) {
+        auto xinputState = TranslationLayer().translateToXInput(state);
+        return sendToVirtualXInputDevice(state.sourceUserId, xinputState);
+    }
+    auto dinputState = TranslationLayer().translateToDInput(state);
+    return sendToVirtualDInputDevice(state.sourceUserId, dinputState);
+}
+
 int VirtualDeviceEmulator::createVirtualDevice(TranslatedState::TargetType type, int userId, const std::string& sourceName) {
     if (!m_initialized) {
         return -1;
@@ -190,6 +203,7 @@ int VirtualDeviceEmulator::createVirtualDevice(TranslatedState::TargetType type,
     newDevice.target = target;
     
     m_virtualDevices.push_back(newDevice);
+    m_injector.trackTarget(newId);
     
     // Call callback if set
     if (m_deviceCallback) {
@@ -212,6 +226,7 @@ bool VirtualDeviceEmulator::destroyVirtualDevice(int deviceId) {
                           });
     
     if (it != m_virtualDevices.end()) {
+        m_injector.forgetTarget(deviceId, it->type, it->userId);
         destroyVirtualDeviceInternal(*it);
         m_virtualDevices.erase(it);
         
@@ -347,7 +362,7 @@ void* VirtualDeviceEmulator::createVirtualXInputDeviceTarget(int userId) {
         static_cast<PVIGEM_CLIENT>(m_vigemClient),
         x360Target,
         VirtualDeviceEmulator::x360Notification,
-        reinterpret_cast<LPVOID>(static_cast<uintptr_t>(userId))
+        rumbleContext(userId)
     );
 
     Logger::log("VirtualDeviceEmulator: Created XInput device for userId " + std::to_string(userId));
@@ -389,7 +404,7 @@ bool VirtualDeviceEmulator::sendToVirtualXInputDevice(int userId, const XINPUT_S
                               return device.userId == userId && device.type == TranslatedState::TARGET_XINPUT;
                           });
     
-    if (it == m_virtualDevices.end() || !it->target || !it->connected) {
+    if (it == m_virtualDevices.end() || !it->target) {
         return false;
     }
     
@@ -414,9 +429,9 @@ bool VirtualDeviceEmulator::sendToVirtualXInputDevice(int userId, const XINPUT_S
     // Submit the report to ViGEmBus
     VIGEM_ERROR error = vigem_target_x360_update(static_cast<PVIGEM_CLIENT>(m_vigemClient), static_cast<PVIGEM_TARGET>(it->target), report);
     
-    // If update fails, mark device as disconnected to prevent further crashes
+    // The target health monitor counts the failure, retries the report and
+    // re-plugs the target once the error budget is spent
     if (!VIGEM_SUCCESS(error)) {
-        it->connected = false;
         Logger::log("WARNING: X360 update failed for userId " + std::to_string(userId) + ", error: 0x" + std::to_string(error));
         return false;
     }
@@ -432,7 +447,7 @@ bool VirtualDeviceEmulator::sendToVirtualDInputDevice(int userId, const Translat
                               return device.userId == userId && device.type == TranslatedState::TARGET_DINPUT;
                           });
     
-    if (it == m_virtualDevices.end() || !it->target || !it->connected) {
+    if (it == m_virtualDevices.end() || !it->target) {
         return false;
     }
     
@@ -504,12 +519,40 @@ bool VirtualDeviceEmulator::sendToVirtualDInputDevice(int userId, const Translat
     report.bThumbRX = longToByte(state.lRx);
     report.bThumbRY = longToByteInverted(state.lRy); // Invert Y-axis
 
-    // Submit the report to ViGEmBus
-    VIGEM_ERROR error = vigem_target_ds4_update(static_cast<PVIGEM_CLIENT>(m_vigemClient), static_cast<PVIGEM_TARGET>(it->target), report);
+    // Submit the report to ViGEmBus. Sources with motion sensors use the extended
+    // report so games see gyro/accel; everything else keeps the legacy report.
+    VIGEM_ERROR error;
+    if (state.motion.valid) {
+        DS4_REPORT_EX reportEx{};
+        reportEx.Report.bThumbLX = report.bThumbLX;
+        reportEx.Report.bThumbLY = report.bThumbLY;
+        reportEx.Report.bThumbRX = report.bThumbRX;
+        reportEx.Report.bThumbRY = report.bThumbRY;
+        reportEx.Report.wButtons = report.wButtons;
+        reportEx.Report.bSpecial = report.bSpecial;
+        reportEx.Report.bTriggerL = report.bTriggerL;
+        reportEx.Report.bTriggerR = report.bTriggerR;
+        reportEx.Report.wTimestamp = state.motion.sensorTimestamp;
+        reportEx.Report.bBatteryLvl = 0xFF;
+        reportEx.Report.wGyroX = state.motion.gyro[0];
+        reportEx.Report.wGyroY = state.motion.gyro[1];
+        reportEx.Report.wGyroZ = state.motion.gyro[2];
+        reportEx.Report.wAccelX = state.motion.accel[0];
+        reportEx.Report.wAccelY = state.motion.accel[1];
+        reportEx.Report.wAccelZ = state.motion.accel[2];
+        
+        error = vigem_target_ds4_update_ex(static_cast<PVIGEM_CLIENT>(m_vigemClient), static_cast<PVIGEM_TARGET>(it->target), reportEx);
+        if (error == VIGEM_ERROR_NOT_SUPPORTED) {
+            // Older ViGEmBus without extended report support: drop motion, keep input
+            error = vigem_target_ds4_update(static_cast<PVIGEM_CLIENT>(m_vigemClient), static_cast<PVIGEM_TARGET>(it->target), report);
+        }
+    } else {
+        error = vigem_target_ds4_update(static_cast<PVIGEM_CLIENT>(m_vigemClient), static_cast<PVIGEM_TARGET>(it->target), report);
+    }
 
-    // If update fails, mark device as disconnected to prevent further crashes
+    // The target health monitor counts the failure, retries the report and
+    // re-plugs the target once the error budget is spent
     if (!VIGEM_SUCCESS(error)) {
-        it->connected = false;
         Logger::log("WARNING: DS4 update failed for userId " + std::to_string(userId) + ", error: 0x" + std::to_string(error));
         return false;
     }
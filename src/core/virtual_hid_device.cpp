@@ -0,0 +1,179 @@
+#include "core/virtual_hid_device.hpp"
+
+#ifdef __linux__
+
+#include "core/hidraw_source.hpp"
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <fstream>
+#include <linux/input.h>
+#include <linux/uhid.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+
+namespace {
+
+constexpr const char* UHID_PATH = "/dev/uhid";
+
+bool writeEvent(int fd, const uhid_event& event) {
+    ssize_t written;
+    do {
+        written = write(fd, &event, sizeof(event));
+    } while (written < 0 && errno == EINTR);
+    return written == static_cast<ssize_t>(sizeof(event));
+}
+
+std::string nextUniq() {
+    static std::atomic<uint32_t> counter(0);
+    return "xidp-" + std::to_string(getpid()) + "-" + std::to_string(counter++);
+}
+
+} // namespace
+
+VirtualHidDevice::VirtualHidDevice()
+    : m_backend(Backend::STREAM),
+      m_fd(-1),
+      m_peerFd(-1) {
+}
+
+VirtualHidDevice::~VirtualHidDevice() {
+    destroy();
+}
+
+bool VirtualHidDevice::uhidAvailable() {
+    int fd = open(UHID_PATH, O_RDWR | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    close(fd);
+    return true;
+}
+
+bool VirtualHidDevice::create(const Spec& spec, bool allowUhid) {
+    destroy();
+    m_spec = spec;
+
+    if (allowUhid && spec.descriptor.size() <= UHID_DATA_MAX) {
+        int fd = open(UHID_PATH, O_RDWR | O_CLOEXEC);
+        if (fd >= 0) {
+            m_uniq = nextUniq();
+            uhid_event event{};
+            event.type = UHID_CREATE2;
+            std::strncpy(reinterpret_cast<char*>(event.u.create2.name), spec.name.c_str(),
+                         sizeof(event.u.create2.name) - 1);
+            std::strncpy(reinterpret_cast<char*>(event.u.create2.uniq), m_uniq.c_str(),
+                         sizeof(event.u.create2.uniq) - 1);
+            event.u.create2.rd_size = static_cast<uint16_t>(spec.descriptor.size());
+            event.u.create2.bus = BUS_VIRTUAL;
+            event.u.create2.vendor = spec.vendorId;
+            event.u.create2.product = spec.productId;
+            std::memcpy(event.u.create2.rd_data, spec.descriptor.data(), spec.descriptor.size());
+            if (writeEvent(fd, event)) {
+                m_fd = fd;
+                m_backend = Backend::UHID;
+                return true;
+            }
+            close(fd);
+        }
+    }
+
+    int fds[2];
+    if (socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, fds) < 0) {
+        return false;
+    }
+    m_fd = fds[0];
+    m_peerFd = fds[1];
+    m_backend = Backend::STREAM;
+    m_nodePath = "stream:" + spec.name;
+    return true;
+}
+
+std::string VirtualHidDevice::findHidrawNode() const {
+    std::string found;
+    DIR* dir = opendir("/sys/class/hidraw");
+    if (!dir) {
+        return found;
+    }
+    while (dirent* entry = readdir(dir)) {
+        if (std::strncmp(entry->d_name, "hidraw", 6) != 0) continue;
+        std::ifstream uevent(std::string("/sys/class/hidraw/") + entry->d_name + "/device/uevent");
+        std::string line;
+        while (std::getline(uevent, line)) {
+            if (line == "HID_UNIQ=" + m_uniq) {
+                found = std::string("/dev/") + entry->d_name;
+                break;
+            }
+        }
+        if (!found.empty()) break;
+    }
+    closedir(dir);
+    return found;
+}
+
+bool VirtualHidDevice::attach(HidrawInputSource& source, int timeoutMs) {
+    if (m_backend == Backend::STREAM) {
+        if (m_peerFd < 0) {
+            return false;
+        }
+        int fd = m_peerFd;
+        m_peerFd = -1;
+        return source.addStream(fd, m_spec.descriptor, m_spec.name, m_spec.vendorId, m_spec.productId, m_nodePath);
+    }
+    if (m_fd < 0) {
+        return false;
+    }
+
+    // The kernel registers the node asynchronously; devtmpfs/udev adds /dev/hidrawN after sysfs
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    while (true) {
+        m_nodePath = findHidrawNode();
+        if (!m_nodePath.empty() && access(m_nodePath.c_str(), R_OK) == 0) {
+            return source.openDevice(m_nodePath);
+        }
+        if (std::chrono::steady_clock::now() >= deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+}
+
+bool VirtualHidDevice::sendReport(const uint8_t* report, size_t length) {
+    if (m_fd < 0 || length == 0) {
+        return false;
+    }
+    if (m_backend == Backend::STREAM) {
+        ssize_t written;
+        do {
+            written = send(m_fd, report, length, MSG_NOSIGNAL);
+        } while (written < 0 && errno == EINTR);
+        return written == static_cast<ssize_t>(length);
+    }
+    if (length > UHID_DATA_MAX) {
+        return false;
+    }
+    uhid_event event{};
+    event.type = UHID_INPUT2;
+    event.u.input2.size = static_cast<uint16_t>(length);
+    std::memcpy(event.u.input2.data, report, length);
+    return writeEvent(m_fd, event);
+}
+
+void VirtualHidDevice::destroy() {
+    if (m_fd >= 0 && m_backend == Backend::UHID) {
+        uhid_event event{};
+        event.type = UHID_DESTROY;
+        writeEvent(m_fd, event);
+    }
+    if (m_fd >= 0) close(m_fd);
+    if (m_peerFd >= 0) close(m_peerFd);
+    m_fd = -1;
+    m_peerFd = -1;
+}
+
+#endif // __linux__
@@ -0,0 +1,72 @@
+#include "core/xinput_slot_scheduler.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace {
+    // Weight of the newest sample in the average poll cost
+    constexpr double COST_SMOOTHING = 0.1;
+}
+
+XInputSlotScheduler::XInputSlotScheduler(Provider provider, Clock clock)
+    : m_provider(std::move(provider)),
+      m_clock(std::move(clock)) {
+}
+
+DWORD XInputSlotScheduler::poll(DWORD slot, XINPUT_STATE* state) {
+    if (slot >= SLOT_COUNT) {
+        return ERROR_DEVICE_NOT_CONNECTED;
+    }
+
+    Slot& s = m_slots[slot];
+    uint64_t start = m_clock();
+    bool forced = s.probeRequested.exchange(false, std::memory_order_acq_rel);
+
+    // Empty slots are only probed once their backoff expires
+    if (!s.stats.connected && !forced && start < s.nextProbeUs) {
+        s.stats.skipped++;
+        publish(s);
+        return ERROR_DEVICE_NOT_CONNECTED;
+    }
+
+    DWORD result = m_provider(slot, state);
+    uint64_t end = m_clock();
+
+    double cost = static_cast<double>(end - start);
+    s.stats.calls++;
+    s.stats.lastCostUs = cost;
+    s.stats.maxCostUs = std::max(s.stats.maxCostUs, cost);
+    s.stats.averageCostUs = (s.stats.calls == 1) ? cost
+        : s.stats.averageCostUs + COST_SMOOTHING * (cost - s.stats.averageCostUs);
+
+    if (result == ERROR_SUCCESS) {
+        s.stats.connected = true;
+        s.stats.backoffUs = 0;
+    } else {
+        s.stats.emptyProbes++;
+        // A pad that just left (or a forced probe) restarts the backoff; a slot that stays empty backs off further
+        s.stats.backoffUs = (s.stats.connected || forced || s.stats.backoffUs == 0)
+            ? INITIAL_BACKOFF_US
+            : std::min(s.stats.backoffUs * 2, MAX_BACKOFF_US);
+        s.stats.connected = false;
+        s.nextProbeUs = end + s.stats.backoffUs;
+    }
+    publish(s);
+    return result;
+}
+
+void XInputSlotScheduler::publish(Slot& slot) {
+    std::lock_guard<std::mutex> lock(m_statsMutex);
+    slot.published = slot.stats;
+}
+
+void XInputSlotScheduler::requestProbe() {
+    for (auto& slot : m_slots) {
+        slot.probeRequested.store(true, std::memory_order_release);
+    }
+}
+
+XInputSlotScheduler::SlotStats XInputSlotScheduler::getStats(size_t slot) const {
+    std::lock_guard<std::mutex> lock(m_statsMutex);
+    return m_slots[slot].published;
+}
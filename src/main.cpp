@@ -7,18 +7,31 @@
 #include "core/translation_layer.hpp"
 #include "core/virtual_device_emulator.hpp"
 #include "core/device_manager.hpp"
+#include "core/input_merger.hpp"
+#include "core/pipeline.hpp"
+#include "core/replay_workload.hpp"
+#include "core/simd_kernels.hpp"
+#include "core/state_stream.hpp"
 #include "ui/dashboard.hpp"
 #include "utils/timing.hpp"
 #include "utils/logger.hpp"
 #include "utils/config_manager.hpp"
+#include "utils/cpu_features.hpp"
 #include <csignal>
+#include <algorithm>
 #include <atomic>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <string>
 #include <shlobj.h> // For IsUserAnAdmin
 
 // Configuration constants
 namespace Config {
     constexpr int DEFAULT_POLLING_FREQUENCY_HZ = 1000;
     constexpr double MICROSECONDS_PER_SECOND = 1000000.0;
+    constexpr int DEFAULT_STREAM_PORT = 47810;
+    constexpr int STREAM_USER_ID_BASE = 1000;   // Streamed slot n drives virtual devices as user 1000 + n
 }
 
 // Global flag for signal handling
@@ -39,7 +52,44 @@ BOOL WINAPI consoleHandler(DWORD ctrlType) {
     }
 }
 
-int main() {
+/**
+ * @brief Headless replay: xinput_dinput_proxy --replay <recording|dir> [--iterations <n>]
+ *
+ * Runs recorded sessions through the translation hot path without devices,
+ * drivers or the dashboard. Used to train profile-guided (PGO) builds.
+ */
+int runReplay(int argc, char** argv) {
+    ReplayWorkload workload;
+    uint32_t iterations = 100;
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--iterations" && i + 1 < argc) {
+            iterations = static_cast<uint32_t>(std::atoi(argv[++i]));
+        } else {
+            std::string error;
+            if (!workload.add(arg, &error)) {
+                std::cerr << error << std::endl;
+                return 2;
+            }
+        }
+    }
+    if (workload.size() == 0) {
+        std::cerr << "Usage: xinput_dinput_proxy --replay <recording|dir>... [--iterations <n>]" << std::endl;
+        return 2;
+    }
+
+    TimingUtils::initialize();
+    ReplayWorkload::Stats stats = workload.run(iterations);
+    std::cout << "Replayed " << stats.frames << " frames (" << stats.outputs << " reports) in "
+              << stats.seconds << " s, checksum " << std::hex << stats.checksum << std::dec << std::endl;
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1 && std::string(argv[1]) == "--replay") {
+        return runReplay(argc, argv);
+    }
+
     std::cout << "XInput-DirectInput Proxy for Windows 11" << std::endl;
     std::cout << "=========================================" << std::endl;
 
@@ -54,6 +104,16 @@ int main() {
     Logger::log("System Audit:");
     Logger::log("  - Admin Privileges: " + std::string(IsUserAnAdmin() ? "YES" : "NO"));
     Logger::log("  - Timestamp: " + Logger::getTimestampString());
+
+    // Kernel variants are bound once, before any pipeline thread starts
+    SimdLevel simdLevel = SimdLevel::AVX512;
+    std::string simdSetting = config.getString("simd_level", "auto");
+    if (!SimdKernels::parseLevel(simdSetting, simdLevel)) {
+        Logger::log("WARNING: Unknown simd_level '" + simdSetting + "', using auto");
+    }
+    SimdKernels::select(simdLevel);
+    Logger::log("  - CPU Features: " + CpuFeatures::describe());
+    Logger::log("  - SIMD Kernels: " + SimdKernels::describe());
     
     if (!IsUserAnAdmin()) {
         Logger::log("WARNING: Running without administrator privileges. Some features may not work.");
@@ -65,24 +125,22 @@ int main() {
 
     // Create input capture module
     auto inputCapture = std::make_unique<InputCapture>();
+    inputCapture->setSourceArbitrationEnabled(config.getBool("source_arbitration_enabled", false));
+    inputCapture->setPollingGroups(
+        config.getBool("polling_groups_enabled", false),
+        static_cast<uint32_t>(config.getInt("polling_frequency", Config::DEFAULT_POLLING_FREQUENCY_HZ)),
+        PollingScheduler::parseOverrides(config.getString("polling_rate_overrides", "")));
+    inputCapture->setPhaseAlignedSampling(config.getBool("phase_aligned_sampling", false));
     
     // Create translation layer
     auto translationLayer = std::make_unique<TranslationLayer>();
     
-    // Load translation settings from config
-    translationLayer->setXInputToDInputMapping(config.getBool("xinput_to_dinput", true));
-    translationLayer->setDInputToXInputMapping(config.getBool("dinput_to_xinput", true));
-    translationLayer->setSOCDCleaningEnabled(config.getBool("socd_enabled", true));
-    translationLayer->setSOCDMethod(config.getInt("socd_method", 2));
-    translationLayer->setDebouncingEnabled(config.getBool("debouncing_enabled", false));
-    translationLayer->setDebounceIntervalMs(config.getInt("debounce_interval_ms", 10));
-    
-    // Load stick drift mitigation settings
-    translationLayer->setStickDeadzoneEnabled(config.getBool("stick_deadzone_enabled", true));
-    translationLayer->setLeftStickDeadzone(config.getFloat("left_stick_deadzone", 0.15f));
-    translationLayer->setRightStickDeadzone(config.getFloat("right_stick_deadzone", 0.15f));
-    translationLayer->setLeftStickAntiDeadzone(config.getFloat("left_stick_anti_deadzone", 0.0f));
-    translationLayer->setRightStickAntiDeadzone(config.getFloat("right_stick_anti_deadzone", 0.0f));
+    // Load translation settings from config (same keys as every pipeline shard)
+    Pipeline::configureTranslation(config, *translationLayer);
+    if (translationLayer->getParallelWorkers() > 0) {
+        Logger::log("  - Parallel translation: " + std::to_string(translationLayer->getParallelWorkers()) +
+                    " workers from " + std::to_string(translationLayer->getParallelThreshold()) + " controllers");
+    }
     
     // Create virtual device emulator
     auto virtualDeviceEmulator = std::make_unique<VirtualDeviceEmulator>();
@@ -90,12 +148,72 @@ int main() {
     // Load emulator settings from config
     virtualDeviceEmulator->setRumbleEnabled(config.getBool("rumble_enabled", true));
     virtualDeviceEmulator->setRumbleIntensity(config.getFloat("rumble_intensity", 1.0f));
+    Pipeline::configureOutput(config, virtualDeviceEmulator->getInjector());
+    
+    // Load split devices (one physical device -> several virtual controllers)
+    if (config.getBool("split_enabled", false)) {
+        std::vector<SplitDeviceConfig> devices;
+        for (size_t d = 0; d < DeviceSplitter::MAX_DEVICES; ++d) {
+            std::string prefix = "split_device_" + std::to_string(d) + "_";
+            std::string source = config.getString(prefix + "source", "");
+            if (source.empty()) {
+                continue;
+            }
+
+            SplitDeviceConfig device;
+            device.sourceMatch = std::wstring(source.begin(), source.end());
+            for (size_t o = 0; o < DeviceSplitter::MAX_OUTPUTS; ++o) {
+                std::string outputPrefix = prefix + "output_" + std::to_string(o) + "_";
+                SplitOutputConfig output;
+                output.name = config.getString(outputPrefix + "name", "Player " + std::to_string(o + 1));
+                output.buttons = DeviceSplitter::parseButtonList(config.getString(outputPrefix + "buttons", ""));
+                output.axes = DeviceSplitter::parseAxisList(config.getString(outputPrefix + "axes", ""));
+                if (output.buttons.empty() && output.axes.empty()) {
+                    break;
+                }
+                device.outputs.push_back(output);
+            }
+            Logger::log("Split device '" + source + "' into " + std::to_string(device.outputs.size()) + " output(s)");
+            devices.push_back(device);
+        }
+        translationLayer->setSplitConfiguration(devices);
+    }
+    
+    // Load merge groups (several physical devices -> one virtual controller)
+    auto inputMerger = std::make_unique<InputMerger>();
+    if (config.getBool("merge_enabled", false)) {
+        std::vector<MergeGroupConfig> groups;
+        for (size_t i = 0; i < InputMerger::MAX_GROUPS; ++i) {
+            std::string prefix = "merge_group_" + std::to_string(i) + "_";
+            std::string sources = config.getString(prefix + "sources", "");
+            if (sources.empty()) {
+                continue;
+            }
+
+            MergeGroupConfig group;
+            group.name = config.getString(prefix + "name", "Merged Controller " + std::to_string(i + 1));
+            std::stringstream ss(sources);
+            std::string source;
+            while (std::getline(ss, source, ';')) {
+                if (!source.empty()) {
+                    group.sourceMatches.emplace_back(source.begin(), source.end());
+                }
+            }
+            group.buttons = InputMerger::parsePolicy(config.getString(prefix + "buttons", "or"), MergePolicy::OR);
+            group.triggers = InputMerger::parsePolicy(config.getString(prefix + "triggers", "max"), MergePolicy::MAX);
+            group.sticks = InputMerger::parsePolicy(config.getString(prefix + "sticks", "max"), MergePolicy::MAX);
+            groups.push_back(group);
+            Logger::log("Merge group '" + group.name + "' with " + std::to_string(group.sourceMatches.size()) + " source(s)");
+        }
+        inputMerger->configure(groups);
+    }
     
     // Create device manager
     auto deviceManager = std::make_unique<DeviceManager>(
         virtualDeviceEmulator.get(),
         translationLayer.get()
     );
+    deviceManager->setInputMerger(inputMerger.get());
     
     // Create dashboard UI
     auto dashboard = std::make_unique<Dashboard>();
@@ -158,6 +276,51 @@ int main() {
         inputCapture->setVibration(userId, left, right);
     });
 
+    // Controller state streaming: publish translated frames to another machine,
+    // or drive local virtual devices from one
+    std::string streamMode = config.getString("stream_mode", "off");
+    int streamPortSetting = config.getInt("stream_port", Config::DEFAULT_STREAM_PORT);
+    if (streamMode != "off" && (streamPortSetting < 1 || streamPortSetting > 65535)) {
+        Logger::error("stream_port " + std::to_string(streamPortSetting) + " is not in 1-65535, streaming disabled");
+        streamMode = "off";
+    }
+    uint16_t streamPort = static_cast<uint16_t>(streamPortSetting);
+    std::unique_ptr<UdpStreamSender> streamSender;
+    std::unique_ptr<UdpStreamReceiver> streamReceiver;
+
+    // The receiver thread only parks the newest frame here; the main loop owns
+    // the virtual devices and applies it (latest wins if it falls behind)
+    std::mutex streamInboxMutex;
+    StateStreamDecoder::Frame streamInbox;
+    bool streamInboxPending = false;
+    // One virtual device per streamed slot, replaced when the slot's controller changes type
+    std::map<int, std::pair<int, TranslatedState::TargetType>> streamDevices;
+
+    if (streamMode == "send") {
+        uint64_t keyframeIntervalUs = static_cast<uint64_t>(std::max(1, config.getInt("stream_keyframe_interval_ms", 50))) * 1000;
+        streamSender = std::make_unique<UdpStreamSender>(keyframeIntervalUs);
+        if (!streamSender->open(config.getString("stream_host", "127.0.0.1"), streamPort)) {
+            streamSender.reset();
+        }
+    } else if (streamMode == "receive") {
+        streamReceiver = std::make_unique<UdpStreamReceiver>();
+        std::string bindAddress = config.getString("stream_bind_address", "127.0.0.1");
+        std::string peer = config.getString("stream_peer", "");
+        if (peer.empty() && bindAddress != "127.0.0.1" && bindAddress != "::1" && bindAddress != "localhost") {
+            Logger::error("Stream: listening on " + bindAddress + " without stream_peer; any host can drive the virtual devices");
+        }
+        if (streamReceiver->open(streamPort, bindAddress) && streamReceiver->setAllowedPeer(peer)) {
+            streamReceiver->setFrameCallback([&streamInboxMutex, &streamInbox, &streamInboxPending](const StateStreamDecoder::Frame& frame) {
+                std::lock_guard<std::mutex> lock(streamInboxMutex);
+                streamInbox = frame;
+                streamInboxPending = true;
+            });
+            streamReceiver->start();
+        } else {
+            streamReceiver.reset();
+        }
+    }
+
     std::cout << "Initialization successful!" << std::endl;
     std::cout << "Starting proxy service..." << std::endl;
 
@@ -200,7 +363,53 @@ int main() {
         // Translate and send input if translation is enabled
         if (dashboard->isTranslationEnabled()) {
             std::vector<TranslatedState> translatedStates = translationLayer->translate(inputStates);
+            inputMerger->apply(inputStates, translatedStates);
             virtualDeviceEmulator->sendInput(translatedStates);
+            if (streamSender) {
+                streamSender->send(translatedStates, static_cast<uint64_t>(TimingUtils::counterToMicroseconds(currentTime)));
+            }
+        }
+
+        // Drive the streamed slots from the newest received frame
+        if (streamReceiver) {
+            StateStreamDecoder::Frame frame;
+            bool haveFrame = false;
+            {
+                std::lock_guard<std::mutex> lock(streamInboxMutex);
+                if (streamInboxPending) {
+                    std::swap(frame, streamInbox);
+                    streamInboxPending = false;
+                    haveFrame = true;
+                }
+            }
+            if (haveFrame) {
+                for (auto& state : frame.states) {
+                    state.sourceUserId = Config::STREAM_USER_ID_BASE + state.sourceSlot;
+                    auto it = streamDevices.find(state.sourceSlot);
+                    if (it != streamDevices.end() && it->second.second != state.targetType) {
+                        virtualDeviceEmulator->destroyVirtualDevice(it->second.first);
+                        streamDevices.erase(it);
+                        it = streamDevices.end();
+                    }
+                    if (it == streamDevices.end()) {
+                        int deviceId = virtualDeviceEmulator->createVirtualDevice(
+                            state.targetType, state.sourceUserId, "stream slot " + std::to_string(state.sourceSlot));
+                        if (deviceId >= 0) {
+                            streamDevices[state.sourceSlot] = {deviceId, state.targetType};
+                        }
+                    }
+                }
+                // Slots the sender no longer has
+                for (auto it = streamDevices.begin(); it != streamDevices.end();) {
+                    if (it->first >= static_cast<int>(frame.states.size())) {
+                        virtualDeviceEmulator->destroyVirtualDevice(it->second.first);
+                        it = streamDevices.erase(it);
+                    } else {
+                        ++it;
+                    }
+                }
+                virtualDeviceEmulator->sendInput(frame.states);
+            }
         }
 
         // Update dashboard with current stats
@@ -228,20 +437,33 @@ int main() {
             lastRefreshTime = currentTime;
         }
 
-        // Calculate sleep time to maintain desired polling frequency
-        double elapsedMicroseconds = TimingUtils::counterToMicroseconds(
-            TimingUtils::getPerformanceCounter() - currentTime
-        );
+        // Calculate the next wake-up to maintain desired polling frequency
+        uint64_t lastWakeMicroseconds = static_cast<uint64_t>(TimingUtils::counterToMicroseconds(currentTime));
+        uint64_t regularWakeMicroseconds = 0;
+        if (inputCapture->isPollingGroupsEnabled()) {
+            // Wake for the earliest deadline of any populated polling group
+            regularWakeMicroseconds = inputCapture->getNextPollDeadlineUs();
+        } else {
+            regularWakeMicroseconds = lastWakeMicroseconds + static_cast<uint64_t>(targetIntervalMicroseconds);
+        }
 
-        if (elapsedMicroseconds < targetIntervalMicroseconds) {
-            double sleepMicroseconds = targetIntervalMicroseconds - elapsedMicroseconds;
+        // Phase-aligned sampling moves the wake-up just before the fastest device's next report
+        PhaseAlignedPacer::WakePlan wakePlan = inputCapture->planPhaseWake(lastWakeMicroseconds, regularWakeMicroseconds);
+
+        double nowMicroseconds = TimingUtils::counterToMicroseconds(TimingUtils::getPerformanceCounter());
+        double sleepMicroseconds = static_cast<double>(wakePlan.wakeUs) - nowMicroseconds;
+        if (sleepMicroseconds > 0.0) {
             std::this_thread::sleep_for(std::chrono::microseconds(static_cast<long long>(sleepMicroseconds)));
         }
+        inputCapture->watchPhaseAnchor(wakePlan);
 
         lastTime = TimingUtils::getPerformanceCounter();
     }
 
     // Cleanup
+    if (streamReceiver) {
+        streamReceiver->stop();
+    }
     deviceManager->cleanup();
 
     dashboard->stop();
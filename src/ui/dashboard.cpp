@@ -1,4 +1,6 @@
 #include "ui/dashboard.hpp"
+#include "core/simd_kernels.hpp"
+#include "core/source_arbiter.hpp"
 #include "utils/timing.hpp"
 
 #include <iomanip>
@@ -393,7 +395,8 @@ ftxui::Element Dashboard::renderControllersPanel() {
     children.push_back(ftxui::text(ss.str()));
     children.push_back(ftxui::separator());
     
-    for (const auto& state : m_controllerStates) {
+    for (size_t index = 0; index < m_controllerStates.size(); ++index) {
+        const auto& state = m_controllerStates[index];
         std::string displayName;
         
         // Convert wide string product name to narrow string
@@ -420,7 +423,35 @@ ftxui::Element Dashboard::renderControllersPanel() {
             info << " (Err: " << state.lastError << ")";
         }
         
+        // Polling group and the report interval it was chosen from
+        if (state.isConnected && m_inputCapture && m_inputCapture->isPollingGroupsEnabled()) {
+            PollingScheduler::DeviceTiming timing = m_inputCapture->getPollingTiming(index);
+            PollingScheduler::GroupStats group = m_inputCapture->getPollingGroupStats(timing.rateClass);
+            info << std::fixed << std::setprecision(1) << " [" << group.rateHz << " Hz"
+                 << (timing.pinned ? ", fixed" : "");
+            if (timing.reportIntervalUs > 0.0) {
+                info << ", reports every " << timing.reportIntervalUs / 1000.0 << " ms";
+            }
+            info << "]";
+        }
+        
         children.push_back(ftxui::text(info.str()));
+        
+        // XInput vs HID arbitration: which path wins and by how much
+        bool arbitrated = state.userId >= 0 && state.isConnected &&
+                          state.hidHandle != nullptr && state.hidHandle != INVALID_HANDLE_VALUE;
+        if (arbitrated && m_inputCapture && m_inputCapture->getSourceArbiter()) {
+            m_inputCapture->lockStates();
+            SourceArbiter::Metrics metrics = m_inputCapture->getSourceArbiter()->getMetrics(state.userId);
+            m_inputCapture->unlockStates();
+            
+            std::stringstream arb;
+            arb << std::fixed << std::setprecision(0)
+                << "    Wins XInput/HID: " << metrics.wins[0] << "/" << metrics.wins[1]
+                << "  Lead: " << TimingUtils::counterToMicroseconds(metrics.averageLeadTicks(CaptureSource::XINPUT))
+                << "/" << TimingUtils::counterToMicroseconds(metrics.averageLeadTicks(CaptureSource::HID)) << " us";
+            children.push_back(ftxui::text(arb.str()) | ftxui::dim);
+        }
     }
     
     if (m_controllerStates.empty()) {
@@ -475,9 +506,83 @@ ftxui::Element Dashboard::renderPerformancePanel() {
     ss << "Total Frames: " << m_frameCount << "\n";
     ss << "Latency Estimate: <1ms";
     
-    auto perfInfo = ftxui::vbox({
-        ftxui::text(ss.str())
-    }) | ftxui::border;
+    ftxui::Elements perfChildren;
+    perfChildren.push_back(ftxui::text(ss.str()));
+    
+    // Polling groups: rate, members and deadlines missed
+    if (m_inputCapture && m_inputCapture->isPollingGroupsEnabled()) {
+        for (size_t rateClass = 0; rateClass < PollingScheduler::CLASS_COUNT; ++rateClass) {
+            PollingScheduler::GroupStats group = m_inputCapture->getPollingGroupStats(rateClass);
+            std::stringstream groupInfo;
+            groupInfo << "Group " << group.rateHz << " Hz: " << group.members << " device(s), "
+                      << group.deadlinesMissed << " missed";
+            perfChildren.push_back(ftxui::text(groupInfo.str()) | ftxui::dim);
+        }
+    }
+    
+    // Phase-aligned sampling: which device the loop wakes for, and how well it is tracked
+    if (m_inputCapture && m_inputCapture->isPhaseAlignedSampling()) {
+        int anchor = m_inputCapture->getPhaseAnchor();
+        std::stringstream phaseInfo;
+        if (anchor >= 0) {
+            ReportPhaseEstimator estimate = m_inputCapture->getPhaseEstimate(static_cast<size_t>(anchor));
+            phaseInfo << std::fixed << std::setprecision(1)
+                      << "Phase anchor: device " << anchor << ", period " << estimate.periodUs()
+                      << " μs, jitter " << estimate.jitterUs() << " μs";
+        } else {
+            phaseInfo << "Phase anchor: none locked (regular wake-ups)";
+        }
+        perfChildren.push_back(ftxui::text(phaseInfo.str()) | ftxui::dim);
+    }
+    
+    // Output shaping: driver submits versus analog reports coalesced per virtual device
+    if (m_emulator && m_emulator->isOutputShapingEnabled()) {
+        for (const auto& device : m_emulator->getVirtualDevices()) {
+            OutputShaper::Metrics metrics = m_emulator->getOutputMetrics(device.type, device.userId);
+            std::stringstream outputInfo;
+            outputInfo << "Output " << (device.type == TranslatedState::TARGET_XINPUT ? "X360" : "DS4")
+                       << " #" << device.userId << ": " << metrics.submitted << " submitted ("
+                       << metrics.edges << " edges), " << metrics.coalesced << " coalesced, "
+                       << metrics.unchanged << " unchanged";
+            perfChildren.push_back(ftxui::text(outputInfo.str()) | ftxui::dim);
+        }
+    }
+    
+    // Virtual target health: only listed once a target has failed or been re-plugged
+    if (m_emulator) {
+        for (const auto& device : m_emulator->getVirtualDevices()) {
+            TargetHealthMonitor::Metrics health = m_emulator->getTargetHealth(device.id);
+            if (health.failures == 0 && health.reconnectAttempts == 0) {
+                continue;
+            }
+            std::stringstream healthInfo;
+            healthInfo << "Target " << device.id << ": " << TargetHealthMonitor::healthName(health.health)
+                       << ", " << health.failures << " failed, " << health.retries << " retried, "
+                       << health.skipped << " skipped, " << health.reconnects << "/" << health.reconnectAttempts
+                       << " re-plugs";
+            auto color = health.health == TargetHealthMonitor::Health::HEALTHY ? ftxui::Color::Green
+                       : health.health == TargetHealthMonitor::Health::DEAD ? ftxui::Color::Red
+                       : ftxui::Color::Yellow;
+            perfChildren.push_back(ftxui::text(healthInfo.str()) | ftxui::color(color));
+        }
+    }
+    
+    // XInputGetState cost per slot; empty slots are probed with backoff instead of every frame
+    if (m_inputCapture) {
+        for (size_t slot = 0; slot < XInputSlotScheduler::SLOT_COUNT; ++slot) {
+            XInputSlotScheduler::SlotStats stats = m_inputCapture->getSlotStats(slot);
+            std::stringstream slotInfo;
+            slotInfo << std::fixed << std::setprecision(1)
+                     << "XInput " << slot << ": " << (stats.connected ? "polled" : "probing")
+                     << "  avg " << stats.averageCostUs << " μs, max " << stats.maxCostUs << " μs";
+            if (!stats.connected) {
+                slotInfo << ", every " << (stats.backoffUs / 1000) << " ms (" << stats.skipped << " skipped)";
+            }
+            perfChildren.push_back(ftxui::text(slotInfo.str()) | ftxui::dim);
+        }
+    }
+    
+    auto perfInfo = ftxui::vbox(std::move(perfChildren)) | ftxui::border;
     
     return ftxui::vbox({
         ftxui::text("Performance") | ftxui::bold,
@@ -510,7 +615,8 @@ ftxui::Element Dashboard::renderStatusPanel() {
         ftxui::text("SOCD: " + socdStr),
         ftxui::text(std::string("Debouncing: ") + (m_debouncingEnabled ? "Enabled" : "Disabled")),
         ftxui::text("Stick Drift Fix: " + stickDriftStr),
-        ftxui::text(std::string("HidHide: ") + (m_hidHideEnabled ? "Active" : "Inactive"))
+        ftxui::text(std::string("HidHide: ") + (m_hidHideEnabled ? "Active" : "Inactive")),
+        ftxui::text("SIMD: " + SimdKernels::describe()) | ftxui::dim
     }) | ftxui::border;
     
     return ftxui::vbox({
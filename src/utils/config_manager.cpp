@@ -1,12 +1,53 @@
 #include "utils/config_manager.hpp"
-#include <Windows.h>
 #include <algorithm>
+#include <cctype>
 
 std::filesystem::path ConfigManager::getConfigPath(const std::string& filename) {
-    wchar_t path[MAX_PATH];
-    GetModuleFileNameW(NULL, path, MAX_PATH);
-    std::filesystem::path exePath(path);
-    return exePath.parent_path() / filename;
+    return Logger::getExecutableDirectory() / filename;
+}
+
+namespace {
+
+// True for keys of any instance's override section: the prefix stem ("shard"
+// of "shard1.") followed by an index and a dot
+bool isOverrideKey(const std::string& key, const std::string& stem) {
+    if (stem.empty() || key.compare(0, stem.size(), stem) != 0) {
+        return false;
+    }
+    size_t pos = stem.size();
+    while (pos < key.size() && std::isdigit(static_cast<unsigned char>(key[pos]))) {
+        ++pos;
+    }
+    return pos > stem.size() && pos < key.size() && key[pos] == '.';
+}
+
+} // namespace
+
+std::unique_ptr<ConfigManager> ConfigManager::createView(const std::string& overridePrefix) const {
+    auto view = std::make_unique<ConfigManager>();
+    std::string stem = overridePrefix;
+    if (!stem.empty() && stem.back() == '.') {
+        stem.pop_back();
+        while (!stem.empty() && std::isdigit(static_cast<unsigned char>(stem.back()))) {
+            stem.pop_back();
+        }
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const auto& [key, value] : m_config) {
+        // Neither this view's overrides nor other instances' sections are plain keys
+        if (overridePrefix.empty() || (key.compare(0, overridePrefix.size(), overridePrefix) != 0 &&
+                                       !isOverrideKey(key, stem))) {
+            view->m_config.emplace(key, value);
+        }
+    }
+    if (!overridePrefix.empty()) {
+        for (const auto& [key, value] : m_config) {
+            if (key.size() > overridePrefix.size() && key.compare(0, overridePrefix.size(), overridePrefix) == 0) {
+                view->m_config[key.substr(overridePrefix.size())] = value;
+            }
+        }
+    }
+    return view;
 }
 
 bool ConfigManager::load(const std::string& filename) {
@@ -0,0 +1,91 @@
+#include "utils/cpu_features.hpp"
+
+#include <cstdint>
+
+#if defined(_M_X64) || defined(_M_IX86)
+#include <intrin.h>
+#define XIDP_X86 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#define XIDP_X86 1
+#endif
+
+namespace {
+
+#ifdef XIDP_X86
+void cpuid(uint32_t leaf, uint32_t subleaf, uint32_t regs[4]) {
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuidex(info, static_cast<int>(leaf), static_cast<int>(subleaf));
+    for (int i = 0; i < 4; ++i) regs[i] = static_cast<uint32_t>(info[i]);
+#else
+    __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+uint64_t xgetbv0() {
+#if defined(_MSC_VER)
+    return _xgetbv(0);
+#else
+    uint32_t eax, edx;
+    __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return (static_cast<uint64_t>(edx) << 32) | eax;
+#endif
+}
+#endif
+
+} // namespace
+
+CpuFeatures::Flags CpuFeatures::detect() {
+    Flags flags;
+#ifdef XIDP_X86
+    uint32_t regs[4] = {};
+    cpuid(0, 0, regs);
+    uint32_t maxLeaf = regs[0];
+    if (maxLeaf < 1) {
+        return flags;
+    }
+
+    cpuid(1, 0, regs);
+    flags.sse41 = (regs[2] & (1u << 19)) != 0;
+    bool osxsave = (regs[2] & (1u << 27)) != 0;
+    bool avx = (regs[2] & (1u << 28)) != 0;
+
+    // The OS must save YMM (XCR0 bits 1-2) and, for AVX-512, opmask/ZMM state (bits 5-7)
+    uint64_t xcr0 = osxsave ? xgetbv0() : 0;
+    bool ymmSaved = (xcr0 & 0x6) == 0x6;
+    bool zmmSaved = (xcr0 & 0xE6) == 0xE6;
+
+    if (maxLeaf >= 7) {
+        cpuid(7, 0, regs);
+        uint32_t ebx = regs[1];
+        flags.bmi2 = (ebx & (1u << 8)) != 0;
+        flags.avx2 = avx && ymmSaved && (ebx & (1u << 5)) != 0;
+        bool avx512f = (ebx & (1u << 16)) != 0;
+        bool avx512bw = (ebx & (1u << 30)) != 0;
+        bool avx512vl = (ebx & (1u << 31)) != 0;
+        flags.avx512 = flags.avx2 && zmmSaved && avx512f && avx512bw && avx512vl;
+    }
+#endif
+    return flags;
+}
+
+const CpuFeatures::Flags& CpuFeatures::get() {
+    static const Flags flags = detect();
+    return flags;
+}
+
+std::string CpuFeatures::describe() {
+    const Flags& flags = get();
+    std::string text;
+    auto add = [&text](bool present, const char* name) {
+        if (!present) return;
+        if (!text.empty()) text += " ";
+        text += name;
+    };
+    add(flags.sse41, "sse4.1");
+    add(flags.avx2, "avx2");
+    add(flags.bmi2, "bmi2");
+    add(flags.avx512, "avx512");
+    return text.empty() ? "baseline" : text;
+}
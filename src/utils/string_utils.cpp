@@ -0,0 +1,11 @@
+#include "utils/string_utils.hpp"
+
+#include <algorithm>
+#include <cwctype>
+
+bool StringUtils::containsCaseInsensitive(const std::wstring& haystack, const std::wstring& needle) {
+    if (needle.empty()) return false;
+    auto it = std::search(haystack.begin(), haystack.end(), needle.begin(), needle.end(),
+                          [](wchar_t a, wchar_t b) { return std::towlower(a) == std::towlower(b); });
+    return it != haystack.end();
+}
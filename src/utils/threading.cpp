@@ -1,7 +1,15 @@
 #include "utils/threading.hpp"
 
+#ifndef _WIN32
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#endif
+
 int ThreadingUtils::s_logicalCoreCount = 0;
 
+#ifdef _WIN32
+
 bool ThreadingUtils::setCurrentThreadToHighPriority() {
     return SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_HIGHEST) != 0;
 }
@@ -62,4 +70,78 @@ int ThreadingUtils::getLogicalCoreCount() {
     }
     
     return s_logicalCoreCount;
-}
\ No newline at end of file
+}
+
+#else
+
+// Linux: real-time scheduling needs CAP_SYS_NICE, so the priority calls may
+// fail for unprivileged users; callers treat them as best effort.
+static bool setRealtimePriority(pthread_t thread, int offsetFromMax) {
+    sched_param param{};
+    param.sched_priority = sched_get_priority_max(SCHED_FIFO) - offsetFromMax;
+    return pthread_setschedparam(thread, SCHED_FIFO, &param) == 0;
+}
+
+static bool pinThread(pthread_t thread, int coreId) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(coreId, &set);
+    return pthread_setaffinity_np(thread, sizeof(set), &set) == 0;
+}
+
+bool ThreadingUtils::setCurrentThreadToHighPriority() {
+    return setRealtimePriority(pthread_self(), 10);
+}
+
+bool ThreadingUtils::setCurrentThreadToTimeCriticalPriority() {
+    return setRealtimePriority(pthread_self(), 0);
+}
+
+bool ThreadingUtils::setThreadToHighPriority(std::thread& thread) {
+    if (!thread.joinable()) {
+        return false;
+    }
+
+    return setRealtimePriority(thread.native_handle(), 10);
+}
+
+bool ThreadingUtils::setThreadToTimeCriticalPriority(std::thread& thread) {
+    if (!thread.joinable()) {
+        return false;
+    }
+
+    return setRealtimePriority(thread.native_handle(), 0);
+}
+
+bool ThreadingUtils::setCurrentThreadAffinity(int coreId) {
+    int coreCount = getLogicalCoreCount();
+    if (coreId < 0 || coreId >= coreCount) {
+        return false;
+    }
+
+    return pinThread(pthread_self(), coreId);
+}
+
+bool ThreadingUtils::setThreadAffinity(std::thread& thread, int coreId) {
+    if (!thread.joinable()) {
+        return false;
+    }
+
+    int coreCount = getLogicalCoreCount();
+    if (coreId < 0 || coreId >= coreCount) {
+        return false;
+    }
+
+    return pinThread(thread.native_handle(), coreId);
+}
+
+int ThreadingUtils::getLogicalCoreCount() {
+    if (s_logicalCoreCount == 0) {
+        long count = sysconf(_SC_NPROCESSORS_ONLN);
+        s_logicalCoreCount = count > 0 ? static_cast<int>(count) : 1;
+    }
+
+    return s_logicalCoreCount;
+}
+
+#endif
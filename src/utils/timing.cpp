@@ -1,5 +1,9 @@
 #include "utils/timing.hpp"
 
+#ifndef _WIN32
+#include <time.h>
+#endif
+
 bool TimingUtils::s_initialized = false;
 LARGE_INTEGER TimingUtils::s_frequency = {};
 
@@ -9,18 +13,29 @@ bool TimingUtils::initialize() {
     }
     
     // Get the performance frequency (ticks per second)
+#ifdef _WIN32
     if (!QueryPerformanceFrequency(&s_frequency)) {
         return false;
     }
+#else
+    // CLOCK_MONOTONIC is reported in nanoseconds
+    s_frequency.QuadPart = 1000000000LL;
+#endif
     
     s_initialized = true;
     return true;
 }
 
 uint64_t TimingUtils::getPerformanceCounter() {
+#ifdef _WIN32
     LARGE_INTEGER counter;
     QueryPerformanceCounter(&counter);
     return static_cast<uint64_t>(counter.QuadPart);
+#else
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<uint64_t>(ts.tv_nsec);
+#endif
 }
 
 double TimingUtils::counterToMicroseconds(uint64_t counterDiff) {
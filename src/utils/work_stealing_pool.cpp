@@ -0,0 +1,135 @@
+#include "utils/work_stealing_pool.hpp"
+
+WorkStealingPool::WorkStealingPool(size_t workers)
+    : m_ranges(new Range[workers + 1]),
+      m_participants(workers + 1),
+      m_task(nullptr),
+      m_remaining(0),
+      m_active(0),
+      m_stolen(0),
+      m_generation(0),
+      m_stop(false) {
+    for (size_t i = 0; i < workers; ++i) {
+        m_workers.emplace_back(&WorkStealingPool::workerLoop, this, i + 1);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    for (auto& worker : m_workers) {
+        worker.join();
+    }
+}
+
+void WorkStealingPool::parallelFor(size_t tasks, const std::function<void(size_t)>& task) {
+    if (tasks == 0) {
+        return;
+    }
+    if (m_workers.empty() || tasks == 1) {
+        for (size_t i = 0; i < tasks; ++i) task(i);
+        return;
+    }
+
+    // Publish the task before the ranges: a worker only reads it after claiming an index
+    m_task = &task;
+    m_remaining = tasks;
+    size_t base = tasks / m_participants;
+    size_t extra = tasks % m_participants;
+    uint32_t begin = 0;
+    for (size_t p = 0; p < m_participants; ++p) {
+        uint32_t end = begin + static_cast<uint32_t>(base + (p < extra ? 1 : 0));
+        m_ranges[p].bounds = pack(begin, end);
+        begin = end;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_generation++;
+    }
+    m_wake.notify_all();
+
+    runTasks(0);
+
+    // Wait for stolen tasks still running, and for late workers to leave the ranges
+    while (m_remaining != 0 || m_active != 0) {
+        std::this_thread::yield();
+    }
+    m_task = nullptr;
+}
+
+void WorkStealingPool::workerLoop(size_t participant) {
+    uint64_t seen = 0;
+    while (true) {
+        bool woken = false;
+        for (int spin = 0; spin < SPIN_ITERATIONS; ++spin) {
+            if (m_stop || m_generation != seen) {
+                woken = true;
+                break;
+            }
+            std::this_thread::yield();
+        }
+        if (!woken) {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [&]() { return m_stop || m_generation != seen; });
+        }
+        if (m_stop) {
+            return;
+        }
+        seen = m_generation;
+
+        m_active++;
+        runTasks(participant);
+        m_active--;
+    }
+}
+
+void WorkStealingPool::runTasks(size_t participant) {
+    uint32_t index = 0;
+    while (takeOwn(participant, index)) {
+        (*m_task)(index);
+        m_remaining--;
+    }
+    while (steal(participant, index)) {
+        (*m_task)(index);
+        m_stolen++;
+        m_remaining--;
+    }
+}
+
+bool WorkStealingPool::takeOwn(size_t participant, uint32_t& index) {
+    std::atomic<uint64_t>& bounds = m_ranges[participant].bounds;
+    uint64_t current = bounds;
+    while (true) {
+        uint32_t begin = static_cast<uint32_t>(current);
+        uint32_t end = static_cast<uint32_t>(current >> 32);
+        if (begin >= end) {
+            return false;
+        }
+        if (bounds.compare_exchange_weak(current, pack(begin + 1, end))) {
+            index = begin;
+            return true;
+        }
+    }
+}
+
+bool WorkStealingPool::steal(size_t participant, uint32_t& index) {
+    for (size_t offset = 1; offset < m_participants; ++offset) {
+        std::atomic<uint64_t>& bounds = m_ranges[(participant + offset) % m_participants].bounds;
+        uint64_t current = bounds;
+        while (true) {
+            uint32_t begin = static_cast<uint32_t>(current);
+            uint32_t end = static_cast<uint32_t>(current >> 32);
+            if (begin >= end) {
+                break;
+            }
+            if (bounds.compare_exchange_weak(current, pack(begin, end - 1))) {
+                index = end - 1;
+                return true;
+            }
+        }
+    }
+    return false;
+}
@@ -0,0 +1,118 @@
+/**
+ * @file hid_descriptors.hpp
+ * @brief Recorded report descriptors and report builders for the HID decoding tests
+ *
+ * Input sides as the devices report them over USB (feature and output
+ * reports trimmed to a couple of entries each).
+ */
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace hid_fixtures {
+
+// DualShock 4 (054C:05C4), report 0x01 is 64 bytes:
+// 1-4 sticks, 5 hat + buttons 1-4, 6 buttons 5-12, 7 buttons 13-14 + counter,
+// 8-9 triggers, 10-63 vendor (timestamp at 10, gyro at 13, accel at 19)
+inline const std::vector<uint8_t> DS4_DESCRIPTOR = {
+    0x05, 0x01, 0x09, 0x05, 0xA1, 0x01,
+    0x85, 0x01,
+    0x09, 0x30, 0x09, 0x31, 0x09, 0x32, 0x09, 0x35,
+    0x15, 0x00, 0x26, 0xFF, 0x00, 0x75, 0x08, 0x95, 0x04, 0x81, 0x02,
+    0x09, 0x39, 0x15, 0x00, 0x25, 0x07, 0x35, 0x00, 0x46, 0x3B, 0x01, 0x65, 0x14,
+    0x75, 0x04, 0x95, 0x01, 0x81, 0x42,
+    0x65, 0x00, 0x05, 0x09, 0x19, 0x01, 0x29, 0x0E, 0x15, 0x00, 0x25, 0x01,
+    0x75, 0x01, 0x95, 0x0E, 0x81, 0x02,
+    0x06, 0x00, 0xFF, 0x09, 0x20, 0x75, 0x06, 0x95, 0x01, 0x15, 0x00, 0x25, 0x7F, 0x81, 0x02,
+    0x05, 0x01, 0x09, 0x33, 0x09, 0x34, 0x15, 0x00, 0x26, 0xFF, 0x00,
+    0x75, 0x08, 0x95, 0x02, 0x81, 0x02,
+    0x06, 0x00, 0xFF, 0x09, 0x21, 0x95, 0x36, 0x81, 0x02,
+    0x85, 0x05, 0x09, 0x22, 0x95, 0x1F, 0x91, 0x02,
+    0x85, 0x04, 0x09, 0x23, 0x95, 0x24, 0xB1, 0x02,
+    0x85, 0x02, 0x09, 0x24, 0x95, 0x24, 0xB1, 0x02,
+    0xC0,
+};
+
+// DualSense (054C:0CE6), report 0x01 is 64 bytes:
+// 1-4 sticks, 5-6 triggers, 7 counter, 8 hat + buttons 1-4, 9-10 buttons 5-15,
+// 12-63 vendor (gyro at 16, accel at 22, timestamp at 28)
+inline const std::vector<uint8_t> DUALSENSE_DESCRIPTOR = {
+    0x05, 0x01, 0x09, 0x05, 0xA1, 0x01,
+    0x85, 0x01,
+    0x09, 0x30, 0x09, 0x31, 0x09, 0x32, 0x09, 0x35, 0x09, 0x33, 0x09, 0x34,
+    0x15, 0x00, 0x26, 0xFF, 0x00, 0x75, 0x08, 0x95, 0x06, 0x81, 0x02,
+    0x06, 0x00, 0xFF, 0x09, 0x20, 0x95, 0x01, 0x81, 0x02,
+    0x05, 0x01, 0x09, 0x39, 0x15, 0x00, 0x25, 0x07, 0x35, 0x00, 0x46, 0x3B, 0x01, 0x65, 0x14,
+    0x75, 0x04, 0x95, 0x01, 0x81, 0x42,
+    0x65, 0x00, 0x05, 0x09, 0x19, 0x01, 0x29, 0x0F, 0x15, 0x00, 0x25, 0x01,
+    0x75, 0x01, 0x95, 0x0F, 0x81, 0x02,
+    0x06, 0x00, 0xFF, 0x09, 0x21, 0x95, 0x0D, 0x81, 0x02,
+    0x06, 0x00, 0xFF, 0x09, 0x22, 0x15, 0x00, 0x26, 0xFF, 0x00, 0x75, 0x08, 0x95, 0x34, 0x81, 0x02,
+    0x85, 0x02, 0x09, 0x23, 0x95, 0x2F, 0x91, 0x02,
+    0xC0,
+};
+
+// Generic USB joystick (0079:0006), no report IDs, 7 bytes:
+// X, Y, Z, Rz as 10-bit values, 12 buttons, 4 bits padding
+inline const std::vector<uint8_t> GENERIC_DESCRIPTOR = {
+    0x05, 0x01, 0x09, 0x04, 0xA1, 0x01,
+    0xA1, 0x00,
+    0x09, 0x30, 0x09, 0x31, 0x09, 0x32, 0x09, 0x35,
+    0x15, 0x00, 0x26, 0xFF, 0x03, 0x75, 0x0A, 0x95, 0x04, 0x81, 0x02,
+    0xC0,
+    0x05, 0x09, 0x19, 0x01, 0x29, 0x0C, 0x15, 0x00, 0x25, 0x01, 0x75, 0x01, 0x95, 0x0C, 0x81, 0x02,
+    0x75, 0x04, 0x95, 0x01, 0x81, 0x03,
+    0xC0,
+};
+
+inline void writeBits(std::vector<uint8_t>& report, uint32_t bitOffset, uint8_t bitSize, uint32_t value) {
+    for (uint8_t i = 0; i < bitSize; ++i) {
+        uint32_t bit = bitOffset + i;
+        if (value & (1u << i)) report[bit / 8] |= static_cast<uint8_t>(1u << (bit % 8));
+        else report[bit / 8] &= static_cast<uint8_t>(~(1u << (bit % 8)));
+    }
+}
+
+inline void writeInt16(std::vector<uint8_t>& report, size_t offset, int16_t value) {
+    report[offset] = static_cast<uint8_t>(value & 0xFF);
+    report[offset + 1] = static_cast<uint8_t>((static_cast<uint16_t>(value) >> 8) & 0xFF);
+}
+
+// Sticks centered, hat released, no buttons
+inline std::vector<uint8_t> ds4Report(uint8_t lx, uint8_t ly, uint16_t buttons) {
+    std::vector<uint8_t> report(64, 0);
+    report[0] = 0x01;
+    report[1] = lx;
+    report[2] = ly;
+    report[3] = 0x80;
+    report[4] = 0x80;
+    writeBits(report, 40, 4, 8);           // Hat null state
+    writeBits(report, 44, 14, buttons);    // Bit 0 = button 1
+    return report;
+}
+
+inline std::vector<uint8_t> dualSenseReport(uint8_t lx, uint8_t l2, uint16_t buttons) {
+    std::vector<uint8_t> report(64, 0);
+    report[0] = 0x01;
+    report[1] = lx;
+    report[2] = 0x80;
+    report[3] = 0x80;
+    report[4] = 0x80;
+    report[5] = l2;
+    writeBits(report, 64, 4, 8);
+    writeBits(report, 68, 15, buttons);
+    return report;
+}
+
+inline std::vector<uint8_t> genericReport(uint16_t x, uint16_t y, uint16_t buttons) {
+    std::vector<uint8_t> report(7, 0);
+    writeBits(report, 0, 10, x);
+    writeBits(report, 10, 10, y);
+    writeBits(report, 20, 10, 512);
+    writeBits(report, 30, 10, 512);
+    writeBits(report, 40, 12, buttons);
+    return report;
+}
+
+} // namespace hid_fixtures
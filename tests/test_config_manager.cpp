@@ -86,6 +86,37 @@ TEST(SaveAndLoad) {
     std::filesystem::remove(testFile);
 }
 
+TEST(CreateViewOverridesAndIsolates) {
+    ConfigManager base;
+    base.setInt("polling_frequency", 1000);
+    base.setBool("socd_enabled", true);
+    base.setInt("shard1.polling_frequency", 500);
+    
+    // Prefixed keys replace the plain key; the prefixed form itself is dropped
+    auto view = base.createView("shard1.");
+    ASSERT_EQ(view->getInt("polling_frequency"), 500);
+    ASSERT_TRUE(view->getBool("socd_enabled"));
+    ASSERT_FALSE(view->hasKey("shard1.polling_frequency"));
+    
+    // Other shards see the base value, and no shard's section leaks into another's view
+    auto other = base.createView("shard0.");
+    ASSERT_EQ(other->getInt("polling_frequency"), 1000);
+    ASSERT_FALSE(other->hasKey("shard1.polling_frequency"));
+    base.setInt("shard12.polling_frequency", 125);
+    base.setString("shardless.note", "kept");
+    auto twelfth = base.createView("shard12.");
+    ASSERT_EQ(twelfth->getInt("polling_frequency"), 125);
+    ASSERT_FALSE(twelfth->hasKey("shard1.polling_frequency"));
+    ASSERT_TRUE(twelfth->hasKey("shardless.note"));
+    
+    // Views are copies
+    view->setBool("socd_enabled", false);
+    base.setInt("polling_frequency", 250);
+    ASSERT_TRUE(base.getBool("socd_enabled"));
+    ASSERT_FALSE(view->getBool("socd_enabled"));
+    ASSERT_EQ(other->getInt("polling_frequency"), 1000);
+}
+
 int main() {
     std::cout << "Running Config Manager Tests\n";
     std::cout << "=============================\n\n";
@@ -97,6 +128,7 @@ int main() {
         RUN_TEST(GetSetBool);
         RUN_TEST(HasKey);
         RUN_TEST(SaveAndLoad);
+        RUN_TEST(CreateViewOverridesAndIsolates);
         
         std::cout << "\n=============================\n";
         std::cout << "All tests passed!\n";
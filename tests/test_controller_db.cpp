@@ -0,0 +1,273 @@
+/**
+ * @file test_controller_db.cpp
+ * @brief Tests for the SDL game controller database import
+ */
+
+#include <cassert>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../include/core/controller_db.hpp"
+#include "../include/core/profile_library.hpp"
+#include "../include/core/translation_layer.hpp"
+
+#define TEST(name) void test_##name()
+#define RUN_TEST(name) do { \
+    std::cout << "Running " #name "..."; \
+    test_##name(); \
+    std::cout << " PASSED\n"; \
+} while(0)
+
+#define ASSERT_EQ(a, b) do { \
+    if ((a) != (b)) { \
+        std::cerr << "ASSERT_EQ failed: " << (a) << " != " << (b) << " at line " << __LINE__ << "\n"; \
+        assert(false); \
+    } \
+} while(0)
+
+#define ASSERT_TRUE(x) do { \
+    if (!(x)) { \
+        std::cerr << "ASSERT_TRUE failed at line " << __LINE__ << "\n"; \
+        assert(false); \
+    } \
+} while(0)
+
+namespace fs = std::filesystem;
+
+static const char* const PS4_LINE =
+    "030000004c050000cc09000000000000,PS4 Controller,a:b1,b:b2,back:b8,dpdown:h0.4,dpleft:h0.8,dpright:h0.2,"
+    "dpup:h0.1,guide:b12,leftshoulder:b4,leftstick:b10,lefttrigger:a3,leftx:a0,lefty:a1,rightshoulder:b5,"
+    "rightstick:b11,righttrigger:a4,rightx:a2,righty:a5,start:b9,touchpad:b13,x:b0,y:b3,platform:Windows,\n";
+
+static void importText(const std::string& text, std::vector<ProfileLibrary::Source>& sources,
+                       ControllerDb::Stats* stats = nullptr, const std::string& platform = "Windows") {
+    std::istringstream in(text);
+    ControllerDb::import(in, platform, sources, stats);
+}
+
+static std::shared_ptr<ProfileLibrary> compileSources(const std::vector<ProfileLibrary::Source>& sources) {
+    std::vector<uint8_t> blob;
+    std::string error;
+    auto library = std::make_shared<ProfileLibrary>();
+    ASSERT_TRUE(ProfileLibrary::compile(sources, sources.size(), 0, blob, &error));
+    ASSERT_TRUE(library->open(std::move(blob), &error));
+    return library;
+}
+
+static void writeFile(const fs::path& path, const std::string& text) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out << text;
+}
+
+TEST(ParsesGuids) {
+    ProfileLibrary::Source::UsbId id;
+    ASSERT_TRUE(ControllerDb::parseGuid("030000004c050000cc09000000000000", id));
+    ASSERT_EQ(id.vendorId, 0x054c);
+    ASSERT_EQ(id.productId, 0x09cc);
+    ASSERT_EQ(id.version, 0);
+
+    ASSERT_TRUE(ControllerDb::parseGuid("050000005e040000e002000030110000", id));
+    ASSERT_EQ(id.vendorId, 0x045e);
+    ASSERT_EQ(id.productId, 0x02e0);
+    ASSERT_EQ(id.version, 0x1130);
+
+    ASSERT_TRUE(ControllerDb::parseGuid("4C05CC09000000000000504944564944", id));   // DirectInput "PIDVID"
+    ASSERT_EQ(id.vendorId, 0x054c);
+    ASSERT_EQ(id.productId, 0x09cc);
+    ASSERT_EQ(id.version, 0);
+
+    ASSERT_TRUE(!ControllerDb::parseGuid("xinput", id));
+    ASSERT_TRUE(!ControllerDb::parseGuid("0500000050532833204a6f792d436f6e", id));    // Name, no USB id
+    ASSERT_TRUE(!ControllerDb::parseGuid("03000000000000000000000000000000", id));
+    ASSERT_TRUE(!ControllerDb::parseGuid("030000004c050000cc0900000000000g", id));
+}
+
+TEST(ImportsBindingsAndCountsSkips) {
+    const std::string text = std::string("# Windows\n\n") + PS4_LINE +
+        "03000000790000000600000000000000,G-Shark GS-GP702,a:b2,b:b1,x:b3,y:b0,platform:Linux,\n"
+        "xinput,XInput Controller,a:b0,b:b1,platform:Windows,\n"
+        "03000000ad1b000001f9000000000000,Guide Only,guide:b8,platform:Windows,\n"
+        "03000000ad1b000002f9000000000000,Half Axes,+leftx:+a0,-leftx:-a0,a:b0,\n"
+        "030000004c050000cc09000000000000,PS4 Controller (later),a:b1,platform:Windows,\n";
+    std::vector<ProfileLibrary::Source> sources;
+    ControllerDb::Stats stats;
+    importText(text, sources, &stats);
+
+    ASSERT_EQ(stats.lines, 8u);
+    ASSERT_EQ(stats.entries, 6u);
+    ASSERT_EQ(stats.imported, 2u);
+    ASSERT_EQ(stats.otherPlatform, 1u);
+    ASSERT_EQ(stats.unsupportedGuid, 1u);
+    ASSERT_EQ(stats.unusable, 1u);
+    ASSERT_EQ(stats.replaced, 1u);
+    ASSERT_EQ(stats.skippedBindings, 5u);       // guide twice, touchpad and both half axes
+    ASSERT_EQ(sources.size(), 2u);
+    ASSERT_EQ(sources[0].name, std::string("PS4 Controller (later)"));     // The later entry wins, as in SDL
+    ASSERT_EQ(sources[0].origin, std::string(ProfileLibrary::CONTROLLER_DB_NAME) + ":8");
+    ASSERT_EQ(sources[1].name, std::string("Half Axes"));
+    ASSERT_EQ(sources[1].axes.size(), 0u);
+
+    sources.clear();
+    importText(PS4_LINE, sources, &stats);
+    const ProfileLibrary::Source& ps4 = sources[0];
+    ASSERT_EQ(ps4.buttons.at(1), XINPUT_GAMEPAD_X);             // b0 is button usage 1
+    ASSERT_EQ(ps4.buttons.at(2), XINPUT_GAMEPAD_A);
+    ASSERT_EQ(ps4.buttons.at(10), XINPUT_GAMEPAD_START);
+    ASSERT_EQ(ps4.buttons.count(13), 0u);                      // guide
+    ASSERT_EQ(ps4.hat[ProfileLibrary::HAT_UP], XINPUT_GAMEPAD_DPAD_UP);
+    ASSERT_EQ(ps4.hat[ProfileLibrary::HAT_LEFT], XINPUT_GAMEPAD_DPAD_LEFT);
+    ASSERT_EQ(ps4.axes.at(0x30).target, ProfileLibrary::AXIS_LEFT_X);
+    ASSERT_EQ(ps4.axes.at(0x30).invert, 0);
+    ASSERT_EQ(ps4.axes.at(0x31).invert, 1);                    // SDL +y is down
+    ASSERT_EQ(ps4.axes.at(0x33).target, ProfileLibrary::AXIS_LEFT_TRIGGER);
+    ASSERT_EQ(ps4.axes.at(0x33).mode, ProfileLibrary::AXIS_CAPS);
+    ASSERT_EQ(ps4.axes.at(0x35).target, ProfileLibrary::AXIS_RIGHT_Y);
+
+    sources.clear();
+    importText(PS4_LINE, sources, nullptr, "Linux");
+    ASSERT_TRUE(sources.empty());
+}
+
+TEST(TranslatesImportedPad) {
+    std::vector<ProfileLibrary::Source> sources;
+    importText("03000000ad1b000003f9000000000000,Arcade Pad,a:b0,b:b1,start:b9,dpup:h0.1,dpright:h0.2,"
+               "dpdown:h0.4,dpleft:h0.8,leftx:a0,lefty:a1~,righty:a5,lefttrigger:b6,righttrigger:b7,\n",
+               sources);
+    auto library = compileSources(sources);
+
+    TranslationLayer layer;
+    layer.setSOCDCleaningEnabled(false);
+    layer.setStickDeadzoneEnabled(false);
+    layer.setProfileLibrary(library);
+
+    ControllerState pad{};
+    pad.userId = -1;
+    pad.isConnected = true;
+    pad.devicePath = L"\\\\?\\hid#controller_db_test";
+    pad.vendorId = 0x1bad;
+    pad.productId = 0xf903;
+    pad.m_activeButtons = {1, 7, 10};
+    pad.m_hidValues[0x30] = 255;
+    pad.m_hidValues[0x31] = 255;
+    pad.m_hidValues[0x35] = 255;
+    pad.m_hidValues[ProfileLibrary::HAT_USAGE] = 3;      // Right-down, with a hat counting from 0
+    for (USAGE usage : {USAGE(0x30), USAGE(0x31), USAGE(0x35), ProfileLibrary::HAT_USAGE}) {
+        HIDP_VALUE_CAPS cap = {};
+        cap.UsagePage = 0x01;
+        cap.Range.UsageMin = usage;
+        cap.LogicalMin = 0;
+        cap.LogicalMax = usage == ProfileLibrary::HAT_USAGE ? 7 : 255;
+        pad.valueCaps.push_back(cap);
+    }
+
+    auto translated = layer.translate({pad});
+    ASSERT_EQ(translated[0].gamepad.wButtons,
+              XINPUT_GAMEPAD_A | XINPUT_GAMEPAD_START | XINPUT_GAMEPAD_DPAD_RIGHT | XINPUT_GAMEPAD_DPAD_DOWN);
+    ASSERT_EQ(translated[0].gamepad.bLeftTrigger, 255);
+    ASSERT_EQ(translated[0].gamepad.bRightTrigger, 0);
+    ASSERT_EQ(translated[0].gamepad.sThumbLX, 32767);
+    ASSERT_EQ(translated[0].gamepad.sThumbLY, 32767);       // a1~ undoes SDL's down-positive y
+    ASSERT_EQ(translated[0].gamepad.sThumbRY, -32767);
+
+    pad.m_activeButtons.clear();
+    pad.m_hidValues[ProfileLibrary::HAT_USAGE] = 8;      // Null state: centered
+    translated = layer.translate({pad});
+    ASSERT_EQ(translated[0].gamepad.wButtons, 0);
+    ASSERT_EQ(translated[0].gamepad.bLeftTrigger, 0);
+
+    // Same pad model with a hat counting from 1 in another slot: each slot keeps its own hat range
+    ControllerState oneBased = pad;
+    oneBased.devicePath = L"\\\\?\\hid#controller_db_one_based";
+    oneBased.valueCaps.back().LogicalMin = 1;
+    oneBased.valueCaps.back().LogicalMax = 8;
+    oneBased.m_hidValues[ProfileLibrary::HAT_USAGE] = 1;  // Up
+    pad.m_hidValues[ProfileLibrary::HAT_USAGE] = 0;       // Up
+    translated = layer.translate({pad, oneBased});
+    ASSERT_EQ(translated[0].gamepad.wButtons, XINPUT_GAMEPAD_DPAD_UP);
+    ASSERT_EQ(translated[1].gamepad.wButtons, XINPUT_GAMEPAD_DPAD_UP);
+    oneBased.m_hidValues[ProfileLibrary::HAT_USAGE] = 7;  // Left
+    translated = layer.translate({pad, oneBased});
+    ASSERT_EQ(translated[1].gamepad.wButtons, XINPUT_GAMEPAD_DPAD_LEFT);
+}
+
+TEST(VersionedEntriesFallBackToVidPid) {
+    std::vector<ProfileLibrary::Source> sources;
+    importText("030000005e040000e002000000010000,Pad v1,a:b0,\n"
+               "030000005e040000e002000000020000,Pad v2,a:b1,\n"
+               "030000005e040000ea02000000010000,Other v1,a:b0,\n"
+               "030000005e040000ea02000000000000,Other,a:b2,\n",
+               sources);
+    ASSERT_EQ(sources.size(), 4u);
+    ASSERT_EQ(sources[0].usbIds.size(), 2u);       // Also stands in for 045e:02e0
+    ASSERT_EQ(sources[1].usbIds.size(), 1u);
+    ASSERT_EQ(sources[2].usbIds.size(), 1u);       // 045e:02ea has its own entry
+
+    auto library = compileSources(sources);
+    ASSERT_EQ(library->size(), 4u);
+    auto nameOf = [&library](uint16_t productId, uint16_t version) {
+        const ProfileLibrary::Profile* profile = library->find(0x045e, productId, L"", version);
+        return profile ? library->getName(*profile) : std::string("-");
+    };
+    ASSERT_EQ(nameOf(0x02e0, 0x0200), std::string("Pad v2"));
+    ASSERT_EQ(nameOf(0x02e0, 0x0100), std::string("Pad v1"));
+    ASSERT_EQ(nameOf(0x02e0, 0), std::string("Pad v1"));
+    ASSERT_EQ(nameOf(0x02e0, 0x0300), std::string("Pad v1"));
+    ASSERT_EQ(nameOf(0x02ea, 0x0100), std::string("Other v1"));
+    ASSERT_EQ(nameOf(0x02ea, 0), std::string("Other"));
+    ASSERT_EQ(nameOf(0x02eb, 0x0100), std::string("-"));
+}
+
+TEST(DirectoryImportsDatabaseAndCaches) {
+    fs::path dir = fs::temp_directory_path() / "xidp_controller_db_test";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    const std::string platform = ",platform:" + ControllerDb::nativePlatform() + ",\n";
+    writeFile(dir / ProfileLibrary::CONTROLLER_DB_NAME,
+              "030000004c050000c405000000000000,PS4 Controller,a:b1,b:b2,x:b0,y:b3" + platform +
+              "030000000d0f0000c100000000000000,Stick,a:b0" + platform);
+    writeFile(dir / "stick.profile", "xidp-profile 1\nname \"Stick remap\"\nmatch usb=0f0d:00c1\nbutton 1 b\n");
+
+    std::string error;
+    auto first = ProfileLibrary::loadDirectory(dir.string(), &error);
+    ASSERT_TRUE(first != nullptr);
+    ASSERT_TRUE(!first->isMapped());
+    ASSERT_EQ(first->size(), 3u);                           // Built-in DS4, database PS4, remapped stick
+    const ProfileLibrary::Profile* ps4 = first->find(0x054c, 0x05c4, L"Wireless Controller");
+    ASSERT_EQ(first->getName(*ps4), std::string("PS4 Controller"));  // USB id before the built-in name
+    ASSERT_EQ(ps4->buttons[2], XINPUT_GAMEPAD_A);
+    const ProfileLibrary::Profile* stick = first->find(0x0f0d, 0x00c1, L"");
+    ASSERT_EQ(first->getName(*stick), std::string("Stick remap"));   // Profile files override the database
+    ASSERT_EQ(stick->buttons[1], XINPUT_GAMEPAD_B);
+
+    auto second = ProfileLibrary::loadDirectory(dir.string(), &error);
+    ASSERT_TRUE(second != nullptr && second->isMapped());
+    ASSERT_TRUE(second->find(0x054c, 0x05c4, L"") != nullptr);
+
+    second.reset();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    writeFile(dir / ProfileLibrary::CONTROLLER_DB_NAME, "030000004c050000a00b000000000000,PS4 Adapter,a:b1" + platform);
+    auto third = ProfileLibrary::loadDirectory(dir.string(), &error);
+    ASSERT_TRUE(third != nullptr && !third->isMapped());   // A changed database is imported again
+    ASSERT_TRUE(third->find(0x054c, 0x05c4, L"") == nullptr);
+    ASSERT_TRUE(third->find(0x054c, 0x0ba0, L"") != nullptr);
+    ASSERT_TRUE(ProfileLibrary::loadDirectory(dir.string(), &error)->isMapped());
+    fs::remove_all(dir);
+}
+
+int main() {
+    std::cout << "=== Controller DB Tests ===\n\n";
+
+    RUN_TEST(ParsesGuids);
+    RUN_TEST(ImportsBindingsAndCountsSkips);
+    RUN_TEST(TranslatesImportedPad);
+    RUN_TEST(VersionedEntriesFallBackToVidPid);
+    RUN_TEST(DirectoryImportsDatabaseAndCaches);
+
+    std::cout << "\n=== All tests PASSED ===\n";
+    return 0;
+}
@@ -0,0 +1,252 @@
+/**
+ * @file test_device_splitter.cpp
+ * @brief Tests for splitting one physical device into several virtual controllers
+ */
+
+#include <cassert>
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include "../include/core/translation_layer.hpp"
+
+#define TEST(name) void test_##name()
+#define RUN_TEST(name) do { \
+    std::cout << "Running " #name "..."; \
+    test_##name(); \
+    std::cout << " PASSED\n"; \
+} while(0)
+
+#define ASSERT_EQ(a, b) do { \
+    if ((a) != (b)) { \
+        std::cerr << "ASSERT_EQ failed: " << (a) << " != " << (b) << " at line " << __LINE__ << "\n"; \
+        assert(false); \
+    } \
+} while(0)
+
+#define ASSERT_TRUE(x) do { \
+    if (!(x)) { \
+        std::cerr << "ASSERT_TRUE failed at line " << __LINE__ << "\n"; \
+        assert(false); \
+    } \
+} while(0)
+
+#define ASSERT_FALSE(x) do { \
+    if (x) { \
+        std::cerr << "ASSERT_FALSE failed at line " << __LINE__ << "\n"; \
+        assert(false); \
+    } \
+} while(0)
+
+// Dual-player encoder: player 1 on buttons 1-4 + X/Y, player 2 on buttons 9-12 + Z/Rz
+static SplitDeviceConfig dualEncoder() {
+    SplitDeviceConfig device;
+    device.sourceMatch = L"Dual Arcade Encoder";
+
+    SplitOutputConfig p1;
+    p1.name = "Player 1";
+    p1.buttons = DeviceSplitter::parseButtonList("1:A,2:B,3:X,4:Y,13:DPAD_LEFT,14:DPAD_RIGHT");
+    p1.axes = DeviceSplitter::parseAxisList("0x30:LX,0x31:LY");
+
+    SplitOutputConfig p2;
+    p2.name = "Player 2";
+    p2.buttons = DeviceSplitter::parseButtonList("9:A,10:B,11:X,12:Y,15:DPAD_LEFT,16:DPAD_RIGHT");
+    p2.axes = DeviceSplitter::parseAxisList("0x32:LX,0x35:LY");
+
+    device.outputs = {p1, p2};
+    return device;
+}
+
+static ControllerState makeEncoderState() {
+    ControllerState state{};
+    state.userId = -1;
+    state.devicePath = L"\\\\?\\HID#VID_1234&PID_5678#encoder";
+    state.deviceInstanceId = L"HID\\VID_1234&PID_5678\\encoder";
+    state.productName = L"Dual Arcade Encoder";
+    state.isConnected = true;
+    // Both players' sticks report signed 16-bit values
+    for (USAGE usage : {0x30, 0x31, 0x32, 0x35}) {
+        HIDP_VALUE_CAPS cap{};
+        cap.UsagePage = 0x01;
+        cap.Range.UsageMin = usage;
+        cap.LogicalMin = -32768;
+        cap.LogicalMax = 32767;
+        state.valueCaps.push_back(cap);
+    }
+    return state;
+}
+
+static const TranslatedState* findOutput(const std::vector<TranslatedState>& states, int userId) {
+    for (const auto& state : states) {
+        if (state.sourceUserId == userId) return &state;
+    }
+    return nullptr;
+}
+
+TEST(ParseLists) {
+    auto buttons = DeviceSplitter::parseButtonList("1:A, 0x0A:start ,bogus,5:NOPE,7:dpad_up");
+    ASSERT_EQ(buttons.size(), 3u);
+    ASSERT_EQ(buttons[0].first, 1);
+    ASSERT_EQ(buttons[0].second, XINPUT_GAMEPAD_A);
+    ASSERT_EQ(buttons[1].first, 10);
+    ASSERT_EQ(buttons[1].second, XINPUT_GAMEPAD_START);
+    ASSERT_EQ(buttons[2].second, XINPUT_GAMEPAD_DPAD_UP);
+
+    auto axes = DeviceSplitter::parseAxisList("0x30:LX,0x33:lt,0x99:ZZ");
+    ASSERT_EQ(axes.size(), 2u);
+    ASSERT_TRUE(axes[1].second == SplitField::LT);
+}
+
+TEST(SplitsIntoTwoOutputs) {
+    TranslationLayer layer;
+    layer.setSOCDCleaningEnabled(false);
+    layer.setSplitConfiguration({dualEncoder()});
+
+    ControllerState state = makeEncoderState();
+    state.m_activeButtons = {1, 4, 10};   // P1: A + Y, P2: B
+    state.m_hidValues[0x30] = 32767;      // P1 full right
+    state.m_hidValues[0x35] = -32768;     // P2 full up (inverted)
+
+    auto results = layer.translate({state});
+    ASSERT_EQ(results.size(), 2u);
+
+    const TranslatedState* p1 = findOutput(results, DeviceSplitter::virtualUserId(0, 0));
+    const TranslatedState* p2 = findOutput(results, DeviceSplitter::virtualUserId(0, 1));
+    ASSERT_TRUE(p1 && p2);
+    ASSERT_EQ(p1->gamepad.wButtons, XINPUT_GAMEPAD_A | XINPUT_GAMEPAD_Y);
+    ASSERT_EQ(p2->gamepad.wButtons, XINPUT_GAMEPAD_B);
+    ASSERT_TRUE(p1->gamepad.sThumbLX > 32700);
+    ASSERT_EQ(p1->gamepad.sThumbLY, 0);
+    ASSERT_EQ(p2->gamepad.sThumbLX, 0);
+    ASSERT_TRUE(p2->gamepad.sThumbLY > 32000);
+    ASSERT_EQ(p1->sourceSlot, 0);
+    ASSERT_EQ(p2->sourceSlot, 0);
+}
+
+TEST(OutputsAreDisjoint) {
+    // A usage claimed by two outputs belongs to the first one only
+    SplitDeviceConfig device = dualEncoder();
+    device.outputs[1].buttons.push_back({1, XINPUT_GAMEPAD_START});
+
+    TranslationLayer layer;
+    layer.setSplitConfiguration({device});
+    ControllerState state = makeEncoderState();
+    state.m_activeButtons = {1};
+
+    auto results = layer.translate({state});
+    const TranslatedState* p1 = findOutput(results, DeviceSplitter::virtualUserId(0, 0));
+    const TranslatedState* p2 = findOutput(results, DeviceSplitter::virtualUserId(0, 1));
+    ASSERT_EQ(p1->gamepad.wButtons, XINPUT_GAMEPAD_A);
+    ASSERT_EQ(p2->gamepad.wButtons, 0);
+}
+
+TEST(IndependentSOCDPerOutput) {
+    TranslationLayer layer;
+    layer.setSOCDCleaningEnabled(true);
+    layer.setSOCDMethod(2); // Neutral
+    layer.setSplitConfiguration({dualEncoder()});
+
+    // P1 holds left+right (SOCD), P2 holds only right
+    ControllerState state = makeEncoderState();
+    state.m_activeButtons = {13, 14, 16};
+
+    auto results = layer.translate({state});
+    const TranslatedState* p1 = findOutput(results, DeviceSplitter::virtualUserId(0, 0));
+    const TranslatedState* p2 = findOutput(results, DeviceSplitter::virtualUserId(0, 1));
+    ASSERT_EQ(p1->gamepad.wButtons & (XINPUT_GAMEPAD_DPAD_LEFT | XINPUT_GAMEPAD_DPAD_RIGHT), 0);
+    ASSERT_EQ(p2->gamepad.wButtons, XINPUT_GAMEPAD_DPAD_RIGHT);
+}
+
+TEST(ChangeDetectionPerOutput) {
+    TranslationLayer layer;
+    layer.setSplitConfiguration({dualEncoder()});
+
+    ControllerState state = makeEncoderState();
+    auto results = layer.translate({state});
+    ASSERT_EQ(results.size(), 2u);  // First frame: both outputs emitted
+
+    // Nothing changed: nothing emitted
+    results = layer.translate({state});
+    ASSERT_EQ(results.size(), 0u);
+
+    // Only player 2 pressed a button: only player 2 emitted
+    state.m_activeButtons = {9};
+    results = layer.translate({state});
+    ASSERT_EQ(results.size(), 1u);
+    ASSERT_EQ(results[0].sourceUserId, DeviceSplitter::virtualUserId(0, 1));
+    ASSERT_EQ(results[0].gamepad.wButtons, XINPUT_GAMEPAD_A);
+}
+
+TEST(IndependentDebouncePerOutput) {
+    TranslationLayer layer;
+    layer.setDebouncingEnabled(true);
+    layer.setDebounceIntervalMs(50);
+    layer.setSplitConfiguration({dualEncoder()});
+
+    ControllerState state = makeEncoderState();
+    state.m_activeButtons = {1};
+    layer.translate({state});  // Both outputs record a change time now
+
+    // Wait past the window, then a player 2 press must not be held back by player 1
+    std::this_thread::sleep_for(std::chrono::milliseconds(60));
+    state.m_activeButtons = {1, 9};
+    auto results = layer.translate({state});
+    const TranslatedState* p2 = findOutput(results, DeviceSplitter::virtualUserId(0, 1));
+    ASSERT_TRUE(p2 != nullptr);
+    ASSERT_EQ(p2->gamepad.wButtons, XINPUT_GAMEPAD_A);
+}
+
+TEST(OtherDevicesUnaffected) {
+    TranslationLayer layer;
+    layer.setSplitConfiguration({dualEncoder()});
+
+    ControllerState other = makeEncoderState();
+    other.productName = L"Some Gamepad";
+    other.deviceInstanceId = L"HID\\VID_AAAA&PID_BBBB\\pad";
+    other.m_activeButtons = {1};
+
+    auto results = layer.translate({other});
+    ASSERT_EQ(results.size(), 1u);
+    ASSERT_EQ(results[0].sourceUserId, -1);
+    ASSERT_TRUE(results[0].gamepad.wButtons & XINPUT_GAMEPAD_A);
+}
+
+TEST(RebindsWhenAnotherDeviceTakesTheSlot) {
+    TranslationLayer layer;
+    layer.setSOCDCleaningEnabled(false);
+    layer.setSplitConfiguration({dualEncoder()});
+
+    ControllerState state = makeEncoderState();
+    state.m_hidValues[0x30] = 32767;
+    auto results = layer.translate({state});
+    ASSERT_TRUE(findOutput(results, DeviceSplitter::virtualUserId(0, 0))->gamepad.sThumbLX > 32700);
+
+    // Another encoder with 8-bit axes replaces it: its ranges, not the cached ones, apply
+    ControllerState replacement = makeEncoderState();
+    replacement.devicePath = L"\\\\?\\HID#VID_1234&PID_5678#encoder2";
+    for (auto& cap : replacement.valueCaps) {
+        cap.LogicalMin = 0;
+        cap.LogicalMax = 255;
+    }
+    replacement.m_hidValues[0x30] = 0;
+    results = layer.translate({replacement});
+    const TranslatedState* p1 = findOutput(results, DeviceSplitter::virtualUserId(0, 0));
+    ASSERT_TRUE(p1 != nullptr);
+    ASSERT_TRUE(p1->gamepad.sThumbLX < -32000);
+}
+
+int main() {
+    std::cout << "=== Device Splitter Tests ===\n\n";
+
+    RUN_TEST(ParseLists);
+    RUN_TEST(SplitsIntoTwoOutputs);
+    RUN_TEST(OutputsAreDisjoint);
+    RUN_TEST(IndependentSOCDPerOutput);
+    RUN_TEST(ChangeDetectionPerOutput);
+    RUN_TEST(IndependentDebouncePerOutput);
+    RUN_TEST(OtherDevicesUnaffected);
+    RUN_TEST(RebindsWhenAnotherDeviceTakesTheSlot);
+
+    std::cout << "\n=== All tests PASSED ===\n";
+    return 0;
+}
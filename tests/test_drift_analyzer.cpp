@@ -0,0 +1,303 @@
+/**
+ * @file test_drift_analyzer.cpp
+ * @brief Tests for the offline stick drift analyzer
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "../include/core/drift_analyzer.hpp"
+
+#define TEST(name) void test_##name()
+#define RUN_TEST(name) do { \
+    std::cout << "Running " #name "..."; \
+    test_##name(); \
+    std::cout << " PASSED\n"; \
+} while(0)
+
+#define ASSERT_EQ(a, b) do { \
+    if ((a) != (b)) { \
+        std::cerr << "ASSERT_EQ failed: " << (a) << " != " << (b) << " at line " << __LINE__ << "\n"; \
+        assert(false); \
+    } \
+} while(0)
+
+#define ASSERT_TRUE(x) do { \
+    if (!(x)) { \
+        std::cerr << "ASSERT_TRUE failed at line " << __LINE__ << "\n"; \
+        assert(false); \
+    } \
+} while(0)
+
+#define ASSERT_NEAR(a, b, tolerance) do { \
+    if (std::abs(static_cast<double>(a) - static_cast<double>(b)) > (tolerance)) { \
+        std::cerr << "ASSERT_NEAR failed: " << (a) << " vs " << (b) << " at line " << __LINE__ << "\n"; \
+        assert(false); \
+    } \
+} while(0)
+
+constexpr int LEFT_X = 1200;        // Where the drifting left stick rests
+constexpr int LEFT_Y = -800;
+constexpr int LEFT_NOISE = 150;
+constexpr int RIGHT_NOISE = 50;
+constexpr uint32_t SWEEP_EVERY = 10000;
+constexpr uint32_t SWEEP_FRAMES = 720;
+constexpr uint32_t GAP_EVERY = 5000;
+constexpr uint64_t GAP_US = 7000;
+
+static SHORT clampAxis(double value) {
+    return static_cast<SHORT>(std::lround(std::clamp(value, -32768.0, 32767.0)));
+}
+
+/**
+ * One XInput pad at 1 kHz with a gap every GAP_EVERY frames. The left stick
+ * rests off center and sweeps a round gate now and then, the right stick
+ * rests centered and sweeps a square gate. An optional HID pad has only a
+ * left stick, resting at raw (140, 120) of 0..255.
+ */
+static SessionRecording makeSession(uint32_t frames, bool withHid) {
+    SessionRecording recording;
+    SessionRecording::Device pad;
+    pad.kind = SessionRecording::SourceKind::XINPUT;
+    pad.userId = 0;
+    recording.devices.push_back(pad);
+    if (withHid) {
+        SessionRecording::Device hid;
+        hid.kind = SessionRecording::SourceKind::HID;
+        hid.userId = -1;
+        hid.vendorId = 0x054C;
+        hid.productId = 0x05C4;
+        hid.productName = "Wireless Controller";
+        hid.valueCaps = {{0x30, 0, 255}, {0x31, 0, 255}, {0x39, 0, 7}};
+        recording.devices.push_back(hid);
+    }
+
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> left(-LEFT_NOISE, LEFT_NOISE);
+    std::uniform_int_distribution<int> right(-RIGHT_NOISE, RIGHT_NOISE);
+    uint64_t timeUs = 5000000;
+    for (uint32_t f = 0; f < frames; ++f) {
+        timeUs += (f > 0 && f % GAP_EVERY == 0) ? 1000 + GAP_US : 1000;
+        SessionRecording::Frame frame;
+        frame.timeUs = timeUs;
+
+        SessionRecording::Sample sample;
+        sample.device = 0;
+        sample.packetNumber = f + 1;
+        XINPUT_GAMEPAD& g = sample.gamepad;
+        const uint32_t phase = f % SWEEP_EVERY;
+        if (phase >= SWEEP_EVERY - SWEEP_FRAMES) {
+            const double angle = (phase - (SWEEP_EVERY - SWEEP_FRAMES)) * 3.14159265358979 / 360.0;
+            g.sThumbLX = clampAxis(32000.0 * std::cos(angle));
+            g.sThumbLY = clampAxis(32000.0 * std::sin(angle));
+            g.sThumbRX = clampAxis(46000.0 * std::cos(angle));
+            g.sThumbRY = clampAxis(46000.0 * std::sin(angle));
+        } else {
+            g.sThumbLX = static_cast<SHORT>(LEFT_X + left(rng));
+            g.sThumbLY = static_cast<SHORT>(LEFT_Y + left(rng));
+            g.sThumbRX = static_cast<SHORT>(right(rng));
+            g.sThumbRY = static_cast<SHORT>(right(rng));
+        }
+        frame.samples.push_back(sample);
+
+        if (withHid && f % 4 == 0) {
+            SessionRecording::Sample report;
+            report.device = 1;
+            report.values = {{0x30, 140}, {0x31, 120}, {0x39, 8}};
+            frame.samples.push_back(report);
+        }
+        recording.frames.push_back(frame);
+    }
+    return recording;
+}
+
+static void assertSameResult(const DriftAnalyzer::Result& a, const DriftAnalyzer::Result& b) {
+    ASSERT_EQ(a.devices.size(), b.devices.size());
+    ASSERT_EQ(a.frames, b.frames);
+    ASSERT_EQ(a.samples, b.samples);
+    for (size_t d = 0; d < a.devices.size(); ++d) {
+        const auto& x = a.devices[d];
+        const auto& y = b.devices[d];
+        ASSERT_EQ(x.samples, y.samples);
+        ASSERT_EQ(x.interval.count, y.interval.count);
+        ASSERT_EQ(x.interval.maxUs, y.interval.maxUs);
+        ASSERT_EQ(x.interval.p50Us, y.interval.p50Us);
+        ASSERT_EQ(x.interval.p99Us, y.interval.p99Us);
+        for (int s = 0; s < 2; ++s) {
+            const auto& p = x.sticks[s];
+            const auto& q = y.sticks[s];
+            ASSERT_EQ(p.present, q.present);
+            ASSERT_EQ(p.restSamples, q.restSamples);
+            ASSERT_EQ(p.medianX, q.medianX);
+            ASSERT_EQ(p.medianY, q.medianY);
+            ASSERT_EQ(p.lowX, q.lowX);
+            ASSERT_EQ(p.highY, q.highY);
+            ASSERT_EQ(p.meanX, q.meanX);
+            ASSERT_EQ(p.deadzone, q.deadzone);
+            ASSERT_EQ(std::string(p.gateShape), std::string(q.gateShape));
+            for (int k = 0; k < 8; ++k) {
+                ASSERT_EQ(p.extents[k], q.extents[k]);
+            }
+        }
+    }
+}
+
+TEST(FindsRestingCenterNoiseAndDeadzone) {
+    SessionRecording recording = makeSession(40000, false);
+    DriftAnalyzer analyzer;
+    DriftAnalyzer::Result result;
+    std::string error;
+    ASSERT_TRUE(analyzer.analyze(recording, result, &error));
+    ASSERT_EQ(result.devices.size(), 1u);
+    ASSERT_EQ(result.frames, 40000u);
+
+    const auto& left = result.devices[0].sticks[DriftAnalyzer::LEFT_STICK];
+    ASSERT_TRUE(left.present);
+    ASSERT_EQ(left.samples, 40000u);
+    ASSERT_EQ(left.restSamples, 40000u - 4 * SWEEP_FRAMES);
+    ASSERT_NEAR(left.medianX, LEFT_X, 10);
+    ASSERT_NEAR(left.medianY, LEFT_Y, 10);
+    ASSERT_NEAR(left.meanX, LEFT_X, 5);
+    ASSERT_NEAR(left.meanY, LEFT_Y, 5);
+    ASSERT_TRUE(left.highX - left.lowX > LEFT_NOISE * 2 * 9 / 10);
+    ASSERT_TRUE(left.highX - left.lowX <= LEFT_NOISE * 2);
+    ASSERT_TRUE(left.noiseRadius > LEFT_NOISE && left.noiseRadius < LEFT_NOISE * 1.5);
+
+    // Wide enough for the offset center plus its noise, with margin, and not much more
+    const double needed = std::hypot(LEFT_X, LEFT_Y) + LEFT_NOISE * std::sqrt(2.0);
+    ASSERT_TRUE(left.deadzone * 32767.0 >= needed);
+    ASSERT_TRUE(left.deadzone <= 0.08f);
+    ASSERT_EQ(left.antiDeadzone, 0.0f);
+
+    const auto& right = result.devices[0].sticks[DriftAnalyzer::RIGHT_STICK];
+    ASSERT_NEAR(right.medianX, 0, 5);
+    ASSERT_TRUE(right.deadzone > 0.0f && right.deadzone <= 0.01f);
+
+    // Calibration stretches each half-axis from the drifted center back to full scale
+    ASSERT_NEAR(left.gain[0], 32767.0 / (32000 - left.medianX), 1e-9);
+    ASSERT_NEAR(left.gain[1], 32768.0 / (32000 + left.medianX), 1e-9);
+    ASSERT_NEAR(left.gain[2], 32767.0 / (32000 - left.medianY), 1e-9);
+}
+
+TEST(DetectsGateShape) {
+    DriftAnalyzer analyzer;
+    DriftAnalyzer::Result result;
+    ASSERT_TRUE(analyzer.analyze(makeSession(20000, false), result));
+    const auto& left = result.devices[0].sticks[DriftAnalyzer::LEFT_STICK];
+    const auto& right = result.devices[0].sticks[DriftAnalyzer::RIGHT_STICK];
+    ASSERT_EQ(std::string(left.gateShape), "round");
+    ASSERT_NEAR(left.gateRatio, 1.0, 0.01);
+    ASSERT_EQ(left.extents[0], 32000);
+    ASSERT_EQ(std::string(right.gateShape), "square");
+    ASSERT_TRUE(right.gateRatio > 1.35);
+
+    // Resting only: the gate is never reached
+    SessionRecording resting = makeSession(SWEEP_EVERY - SWEEP_FRAMES, false);
+    ASSERT_TRUE(analyzer.analyze(resting, result));
+    ASSERT_EQ(std::string(result.devices[0].sticks[0].gateShape), "unknown");
+    ASSERT_EQ(result.devices[0].sticks[0].gain[0], 1.0);
+}
+
+TEST(MeasuresReportIntervals) {
+    DriftAnalyzer analyzer;
+    DriftAnalyzer::Result result;
+    ASSERT_TRUE(analyzer.analyze(makeSession(20001, false), result));
+    const auto& interval = result.devices[0].interval;
+    ASSERT_EQ(interval.count, 20000u);
+    ASSERT_EQ(interval.maxUs, 1000 + GAP_US);
+    ASSERT_NEAR(interval.p50Us, 1005.0, 0.1);
+    ASSERT_NEAR(interval.p99Us, 1005.0, 0.1);
+    ASSERT_NEAR(interval.meanUs, 1000.0 + 4 * GAP_US / 20000.0, 1e-6);
+}
+
+TEST(GameDeadzoneBecomesAntiDeadzone) {
+    DriftAnalyzer::Options options;
+    options.gameDeadzone = 0.24f;
+    DriftAnalyzer analyzer(options);
+    DriftAnalyzer::Result result;
+    ASSERT_TRUE(analyzer.analyze(makeSession(5000, false), result));
+    ASSERT_EQ(result.devices[0].sticks[0].antiDeadzone, 0.24f);
+
+    std::ostringstream report;
+    DriftAnalyzer::writeReport(result, report);
+    ASSERT_TRUE(report.str().find("left_stick_anti_deadzone=0.240") != std::string::npos);
+    ASSERT_TRUE(report.str().find("XInput user 0") != std::string::npos);
+}
+
+TEST(NormalizesHidSticks) {
+    DriftAnalyzer analyzer;
+    DriftAnalyzer::Result result;
+    ASSERT_TRUE(analyzer.analyze(makeSession(8000, true), result));
+    ASSERT_EQ(result.devices.size(), 2u);
+    const auto& hid = result.devices[1];
+    ASSERT_EQ(hid.samples, 2000u);
+    ASSERT_NEAR(hid.interval.p50Us, 4005.0, 0.1);
+    ASSERT_TRUE(hid.sticks[DriftAnalyzer::LEFT_STICK].present);
+    ASSERT_TRUE(!hid.sticks[DriftAnalyzer::RIGHT_STICK].present);
+
+    // Center 127 of 0..255; Y is inverted like the translation layer does
+    const auto& stick = hid.sticks[DriftAnalyzer::LEFT_STICK];
+    ASSERT_NEAR(stick.medianX, 13 / 127.5 * 32767, 1.0);
+    ASSERT_NEAR(stick.medianY, 7 / 127.5 * 32767, 1.0);
+    ASSERT_EQ(stick.noiseRadius, 0.0);
+}
+
+TEST(ParallelChunksMatchSerialScan) {
+    namespace fs = std::filesystem;
+    SessionRecording recording = makeSession(30000, true);
+    const fs::path path = fs::temp_directory_path() / "xidp_drift_test.xrec";
+    RecordingWriter::Options writerOptions;
+    writerOptions.chunkFrames = 1000;
+    ASSERT_TRUE(RecordingWriter::save(recording, path.string(), writerOptions));
+
+    DriftAnalyzer serial;
+    DriftAnalyzer::Result expected;
+    ASSERT_TRUE(serial.analyze(recording, expected));
+
+    DriftAnalyzer::Options options;
+    options.workers = 3;
+    DriftAnalyzer parallel(options);
+    DriftAnalyzer::Result mapped;
+    std::string error;
+    ASSERT_TRUE(parallel.analyzeFile(path.string(), mapped, &error));
+    ASSERT_EQ(mapped.tasks, 30u);
+    assertSameResult(mapped, expected);
+
+    // Intervals spanning two chunks are not lost
+    ASSERT_EQ(mapped.devices[0].interval.count, 29999u);
+
+    // The same over a stream, whose chunks are read one at a time
+    std::ifstream in(path, std::ios::binary);
+    RecordingReader reader;
+    ASSERT_TRUE(reader.open(in));
+    ASSERT_TRUE(!reader.isInMemory());
+    DriftAnalyzer::Result streamed;
+    ASSERT_TRUE(parallel.analyze(reader, streamed));
+    assertSameResult(streamed, expected);
+    in.close();
+
+    fs::remove(path);
+    ASSERT_TRUE(!parallel.analyzeFile(path.string(), mapped, &error));
+    ASSERT_TRUE(!error.empty());
+}
+
+int main() {
+    std::cout << "=== Drift Analyzer Tests ===\n\n";
+
+    RUN_TEST(FindsRestingCenterNoiseAndDeadzone);
+    RUN_TEST(DetectsGateShape);
+    RUN_TEST(MeasuresReportIntervals);
+    RUN_TEST(GameDeadzoneBecomesAntiDeadzone);
+    RUN_TEST(NormalizesHidSticks);
+    RUN_TEST(ParallelChunksMatchSerialScan);
+
+    std::cout << "\n=== All tests PASSED ===\n";
+    return 0;
+}
@@ -0,0 +1,245 @@
+/**
+ * @file test_golden_replay.cpp
+ * @brief Golden-output regression suite: recorded sessions through translation and both encoders
+ *
+ * Usage: test_golden_replay <golden dir> [--workers=<n>] [--bless]
+ *
+ * Every <name>.rec (or .xrec) in the directory is replayed and its output
+ * stream is compared against <name>.golden, spread over --workers pool
+ * threads plus the main one (default: one per core), so a large corpus
+ * still runs in seconds. After an intentional output change, run
+ * with --bless to rewrite the golden files (their tolerances are kept) and
+ * review the diff before committing it.
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../include/core/session_recording.hpp"
+#include "../include/core/golden_output.hpp"
+#include "../include/core/recording_container.hpp"
+#include "../include/core/replay_corpus.hpp"
+
+#define TEST(name) void test_##name()
+#define RUN_TEST(name) do { \
+    std::cout << "Running " #name "..."; \
+    test_##name(); \
+    std::cout << " PASSED\n"; \
+} while(0)
+
+#define ASSERT_EQ(a, b) do { \
+    if ((a) != (b)) { \
+        std::cerr << "ASSERT_EQ failed: " << (a) << " != " << (b) << " at line " << __LINE__ << "\n"; \
+        assert(false); \
+    } \
+} while(0)
+
+#define ASSERT_TRUE(x) do { \
+    if (!(x)) { \
+        std::cerr << "ASSERT_TRUE failed at line " << __LINE__ << "\n"; \
+        assert(false); \
+    } \
+} while(0)
+
+namespace fs = std::filesystem;
+
+static fs::path g_goldenDir;
+static size_t g_workers = std::max(1u, std::thread::hardware_concurrency()) - 1;
+
+const char* const SAMPLE_RECORDING =
+    "xidp-recording 1\n"
+    "# Generic 10-bit pad and an XInput pad\n"
+    "option socd 1\n"
+    "device 0 hid vid=1234 pid=5678 name=\"Generic USB Joystick\" path=\"\\\\?\\hid#vid_1234&pid_5678#t\"\n"
+    "cap 0 0x30 0 1023\n"
+    "cap 0 0x33 0 1023\n"
+    "device 1 xinput user=0\n"
+    "frame 1000\n"
+    "h 0 buttons=1,3 values=0x30:1023,0x33:512\n"
+    "x 1 packet=1 buttons=0xc lt=0 rt=255 lx=100 ly=-100 rx=0 ry=0\n"
+    "frame 2000\n"
+    "x 1 packet=2 buttons=0x1000 lt=0 rt=0 lx=0 ly=0 rx=0 ry=0\n";
+
+std::vector<fs::path> recordings() {
+    std::vector<fs::path> paths;
+    for (const auto& entry : fs::directory_iterator(g_goldenDir)) {
+        if (entry.path().extension() == ".rec" || entry.path().extension() == ".xrec") {
+            paths.push_back(entry.path());
+        }
+    }
+    std::sort(paths.begin(), paths.end());
+    return paths;
+}
+
+TEST(RecordingRoundTrip) {
+    SessionRecording recording;
+    std::istringstream in(SAMPLE_RECORDING);
+    std::string error;
+    ASSERT_TRUE(recording.parse(in, &error));
+    ASSERT_EQ(recording.devices.size(), 2u);
+    ASSERT_EQ(recording.devices[0].valueCaps.size(), 2u);
+    ASSERT_EQ(recording.devices[0].vendorId, 0x1234);
+    ASSERT_EQ(recording.frames.size(), 2u);
+    ASSERT_EQ(recording.frames[0].samples.size(), 2u);
+    ASSERT_EQ(recording.frames[1].samples[0].gamepad.wButtons, 0x1000);
+
+    // Written and parsed again, the recording renders the same stream
+    std::ostringstream written;
+    recording.write(written);
+    SessionRecording reparsed;
+    std::istringstream again(written.str());
+    ASSERT_TRUE(reparsed.parse(again, &error));
+
+    GoldenOutput first, second;
+    ASSERT_TRUE(GoldenOutput::render(recording, first, &error));
+    ASSERT_TRUE(GoldenOutput::render(reparsed, second, &error));
+    ASSERT_EQ(first.records.size(), 4u);   // Both devices in both frames
+    ASSERT_TRUE(first.compare(second).empty());
+
+    // Bad input is reported with its line
+    SessionRecording bad;
+    std::istringstream badIn("xidp-recording 1\ndevice 0 hid\nframe 10\nx 0 packet=1\n");
+    ASSERT_TRUE(!bad.parse(badIn, &error));
+    ASSERT_TRUE(error.find("line 4") == 0);
+
+    std::istringstream debounce("xidp-recording 1\noption debounce 1\n");
+    ASSERT_TRUE(bad.parse(debounce, &error));
+    GoldenOutput unused;
+    ASSERT_TRUE(!GoldenOutput::render(bad, unused, &error));
+}
+
+TEST(HeldDevicesKeepTheirLastReport) {
+    SessionRecording recording;
+    std::istringstream in(SAMPLE_RECORDING);
+    ASSERT_TRUE(recording.parse(in));
+    GoldenOutput output;
+    ASSERT_TRUE(GoldenOutput::render(recording, output));
+
+    // The HID pad sent nothing in frame 1: same report, new frame time
+    const auto& held = output.records[2].fields;
+    const auto& sent = output.records[0].fields;
+    ASSERT_EQ(held[0].second, std::string("1"));
+    for (size_t i = 1; i < held.size(); ++i) {
+        if (held[i].first != "pkt") {
+            ASSERT_EQ(held[i].second, sent[i].second);
+        }
+    }
+    ASSERT_EQ(sent[6].first, std::string("btn"));
+    ASSERT_EQ(sent[6].second, std::string("0x5000"));   // Buttons 1 and 3: A and X
+}
+
+TEST(ToleranceAppliesToAnalogFieldsOnly) {
+    SessionRecording recording;
+    std::istringstream in(SAMPLE_RECORDING);
+    ASSERT_TRUE(recording.parse(in));
+    GoldenOutput golden;
+    ASSERT_TRUE(GoldenOutput::render(recording, golden));
+    golden.tolerance.axis = 2;
+    golden.tolerance.trigger = 1;
+
+    auto withField = [&](const std::string& name, long long delta) {
+        GoldenOutput changed = golden;
+        for (auto& [field, value] : changed.records[0].fields) {
+            if (field == name) value = std::to_string(std::stoll(value, nullptr, 0) + delta);
+        }
+        return changed;
+    };
+
+    ASSERT_TRUE(golden.compare(withField("lx", 2)).empty());
+    ASSERT_EQ(golden.compare(withField("lx", 3)).size(), 1u);
+    ASSERT_TRUE(golden.compare(withField("lt", -1)).empty());
+    ASSERT_TRUE(golden.compare(withField("dz", 257)).empty());
+    ASSERT_EQ(golden.compare(withField("dz", 258)).size(), 1u);
+    // Digital and identity fields are exact
+    ASSERT_EQ(golden.compare(withField("btn", 1)).size(), 1u);
+    ASSERT_EQ(golden.compare(withField("pov", 1)).size(), 1u);
+    ASSERT_EQ(golden.compare(withField("slot", 1)).size(), 1u);
+
+    // A missing record is a structural mismatch
+    GoldenOutput shorter = golden;
+    shorter.records.pop_back();
+    std::vector<GoldenOutput::Mismatch> mismatches = golden.compare(shorter);
+    ASSERT_EQ(mismatches.size(), 1u);
+    ASSERT_TRUE(mismatches[0].field.empty());
+
+    // The tolerance survives a write/parse round trip
+    std::ostringstream written;
+    golden.write(written);
+    GoldenOutput reparsed;
+    std::istringstream again(written.str());
+    ASSERT_TRUE(reparsed.parse(again));
+    ASSERT_EQ(reparsed.tolerance.axis, 2);
+    ASSERT_EQ(reparsed.records.size(), golden.records.size());
+}
+
+TEST(RecordedSessionsMatchGoldenOutput) {
+    ReplayCorpus corpus(g_workers);
+    std::string error;
+    ASSERT_TRUE(corpus.addDirectory(g_goldenDir.string(), &error));
+    ASSERT_TRUE(corpus.getEntries().size() >= 5);
+
+    ReplayCorpus::Summary summary = corpus.run();
+    if (summary.failed > 0) {
+        std::cerr << "\n";
+        ReplayCorpus::writeReport(summary, std::cerr);
+        std::cerr << "  " << summary.failed << " recording(s) differ; if intended, re-bless with --bless\n";
+    }
+    ASSERT_EQ(summary.failed, 0u);
+    ASSERT_EQ(summary.passed, corpus.getEntries().size());
+}
+
+int bless() {
+    for (const auto& path : recordings()) {
+        SessionRecording recording;
+        GoldenOutput output, previous;
+        std::string error;
+        bool loaded = path.extension() == ".xrec" ? RecordingReader::load(path.string(), recording, &error)
+                                                  : recording.load(path.string(), &error);
+        if (!loaded || !GoldenOutput::render(recording, output, &error)) {
+            std::cerr << path.filename().string() << ": " << error << "\n";
+            return 1;
+        }
+        fs::path goldenPath = fs::path(path).replace_extension(".golden");
+        if (previous.load(goldenPath.string())) {
+            output.tolerance = previous.tolerance;
+        }
+        std::ofstream out(goldenPath);
+        output.write(out);
+        std::cout << "Blessed " << goldenPath.filename().string() << " (" << output.records.size() << " records)\n";
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    bool blessing = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--bless") blessing = true;
+        else if (arg.compare(0, 10, "--workers=") == 0) g_workers = static_cast<size_t>(std::max(0, std::atoi(arg.c_str() + 10)));
+        else g_goldenDir = arg;
+    }
+    if (g_goldenDir.empty() || !fs::is_directory(g_goldenDir)) {
+        std::cerr << "Usage: test_golden_replay <golden dir> [--workers=<n>] [--bless]\n";
+        return 2;
+    }
+    if (blessing) {
+        return bless();
+    }
+
+    std::cout << "=== Golden Replay Tests ===\n\n";
+
+    RUN_TEST(RecordingRoundTrip);
+    RUN_TEST(HeldDevicesKeepTheirLastReport);
+    RUN_TEST(ToleranceAppliesToAnalogFieldsOnly);
+    RUN_TEST(RecordedSessionsMatchGoldenOutput);
+
+    std::cout << "\n=== All tests PASSED ===\n";
+    return 0;
+}
@@ -0,0 +1,245 @@
+/**
+ * @file test_hid_descriptor.cpp
+ * @brief Tests for the portable HID report descriptor parser and report decoder
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <vector>
+#include "../include/core/hid_descriptor.hpp"
+#include "../include/core/translation_layer.hpp"
+#include "hid_descriptors.hpp"
+
+#define TEST(name) void test_##name()
+#define RUN_TEST(name) do { \
+    std::cout << "Running " #name "..."; \
+    test_##name(); \
+    std::cout << " PASSED\n"; \
+} while(0)
+
+#define ASSERT_EQ(a, b) do { \
+    if ((a) != (b)) { \
+        std::cerr << "ASSERT_EQ failed: " << (a) << " != " << (b) << " at line " << __LINE__ << "\n"; \
+        assert(false); \
+    } \
+} while(0)
+
+#define ASSERT_TRUE(x) do { \
+    if (!(x)) { \
+        std::cerr << "ASSERT_TRUE failed at line " << __LINE__ << "\n"; \
+        assert(false); \
+    } \
+} while(0)
+
+using namespace hid_fixtures;
+
+static ControllerState makeState(const HidReportDescriptor& descriptor, const wchar_t* name,
+                                 uint16_t vendorId, uint16_t productId) {
+    ControllerState state{};
+    state.userId = -1;
+    state.isConnected = true;
+    state.devicePath = L"/dev/hidraw0";
+    state.productName = name;
+    state.vendorId = vendorId;
+    state.productId = productId;
+    state.valueCaps = descriptor.buildValueCaps();
+    state.motionPlan = MotionReportPlan::forDevice(vendorId, productId);
+    return state;
+}
+
+static TranslatedState translateOne(const ControllerState& state) {
+    TranslationLayer layer;
+    layer.setStickDeadzoneEnabled(false);
+    layer.setSOCDCleaningEnabled(false);
+    std::vector<TranslatedState> out = layer.translate({state});
+    assert(out.size() == 1);
+    return out[0];
+}
+
+static bool hasButton(const ControllerState& state, USAGE usage) {
+    return std::find(state.m_activeButtons.begin(), state.m_activeButtons.end(), usage) != state.m_activeButtons.end();
+}
+
+TEST(ParsesDs4Layout) {
+    HidReportDescriptor descriptor;
+    ASSERT_TRUE(descriptor.parse(DS4_DESCRIPTOR.data(), DS4_DESCRIPTOR.size()));
+    ASSERT_TRUE(descriptor.usesReportIds());
+    ASSERT_EQ(descriptor.getUsagePage(), 0x01);
+    ASSERT_EQ(descriptor.getUsage(), 0x05);
+    ASSERT_EQ(descriptor.getInputReportLength(0x01), 64u);
+    ASSERT_EQ(descriptor.getInputReportLength(0x05), 0u);   // Output report
+    ASSERT_EQ(descriptor.getInputReportLength(0x04), 0u);   // Feature report
+    ASSERT_EQ(descriptor.getButtonFields().size(), 14u);
+
+    // Sticks, hat, vendor counter, triggers; the 54-byte vendor blob is not a value
+    ASSERT_EQ(descriptor.getValueFields().size(), 8u);
+    std::vector<HIDP_VALUE_CAPS> caps = descriptor.buildValueCaps();
+    ASSERT_EQ(caps[0].Range.UsageMin, 0x30);
+    ASSERT_EQ(caps[0].LogicalMax, 255);
+    ASSERT_EQ(caps[4].Range.UsageMin, 0x39);
+    ASSERT_TRUE(caps[4].HasNull);
+    ASSERT_EQ(descriptor.getValueFields()[4].bitOffset, 40u);
+    ASSERT_EQ(descriptor.getButtonFields()[0].bitOffset, 44u);
+    ASSERT_EQ(descriptor.buildCaps().InputReportByteLength, 64);
+}
+
+TEST(DecodesDs4ReportThroughTranslation) {
+    HidReportDescriptor descriptor;
+    ASSERT_TRUE(descriptor.parse(DS4_DESCRIPTOR.data(), DS4_DESCRIPTOR.size()));
+    ControllerState state = makeState(descriptor, L"Wireless Controller", 0x054C, 0x05C4);
+
+    // Cross (2) and R1 (6), left stick right and half up, gyro yaw 1234
+    std::vector<uint8_t> report = ds4Report(255, 64, (1u << 1) | (1u << 5));
+    report[8] = 200;
+    writeInt16(report, 15, 1234);
+    ASSERT_TRUE(descriptor.decode(report.data(), report.size(), state));
+    ASSERT_EQ(state.m_activeButtons.size(), 2u);
+    ASSERT_TRUE(hasButton(state, 2) && hasButton(state, 6));
+    ASSERT_EQ(state.m_hidValues[0x30], 255);
+    ASSERT_EQ(state.m_hidValues[0x39], 8);
+    ASSERT_EQ(state.m_hidValues[0x33], 200);
+    ASSERT_TRUE(state.motion.valid);
+    ASSERT_EQ(state.motion.gyro[1], 1234);
+
+    TranslatedState out = translateOne(state);
+    ASSERT_EQ(out.gamepad.wButtons, XINPUT_GAMEPAD_A | XINPUT_GAMEPAD_RIGHT_SHOULDER);
+    ASSERT_EQ(out.gamepad.sThumbLX, 127 * 256);
+    ASSERT_EQ(out.gamepad.sThumbLY, 64 * 256);
+
+    // Releasing everything clears the buttons
+    report = ds4Report(128, 128, 0);
+    ASSERT_TRUE(descriptor.decode(report.data(), report.size(), state));
+    ASSERT_TRUE(state.m_activeButtons.empty());
+
+    // Unknown report IDs are rejected and leave the state alone
+    report[0] = 0x11;
+    state.m_hidValues[0x30] = 7;
+    ASSERT_TRUE(!descriptor.decode(report.data(), report.size(), state));
+    ASSERT_EQ(state.m_hidValues[0x30], 7);
+}
+
+TEST(DecodesDualSenseAndGenericReports) {
+    HidReportDescriptor dualSense;
+    ASSERT_TRUE(dualSense.parse(DUALSENSE_DESCRIPTOR.data(), DUALSENSE_DESCRIPTOR.size()));
+    ASSERT_EQ(dualSense.getInputReportLength(0x01), 64u);
+    ASSERT_EQ(dualSense.getButtonFields().size(), 15u);
+    ControllerState pad = makeState(dualSense, L"DualSense Wireless Controller", 0x054C, 0x0CE6);
+    std::vector<uint8_t> report = dualSenseReport(0, 255, (1u << 0) | (1u << 14));
+    ASSERT_TRUE(dualSense.decode(report.data(), report.size(), pad));
+    ASSERT_TRUE(hasButton(pad, 1) && hasButton(pad, 15));
+    TranslatedState out = translateOne(pad);
+    ASSERT_EQ(out.gamepad.wButtons, XINPUT_GAMEPAD_A);
+    ASSERT_EQ(out.gamepad.bLeftTrigger, 255);
+    ASSERT_TRUE(out.gamepad.sThumbLX <= -32000);
+
+    HidReportDescriptor generic;
+    ASSERT_TRUE(generic.parse(GENERIC_DESCRIPTOR.data(), GENERIC_DESCRIPTOR.size()));
+    ASSERT_TRUE(!generic.usesReportIds());
+    ASSERT_EQ(generic.getUsage(), 0x04);
+    ASSERT_EQ(generic.getInputReportLength(0), 7u);
+    ControllerState stick = makeState(generic, L"Generic USB Joystick", 0x0079, 0x0006);
+    report = genericReport(1023, 0, (1u << 0) | (1u << 3));
+    ASSERT_TRUE(generic.decode(report.data(), report.size(), stick));
+    ASSERT_EQ(stick.m_hidValues[0x30], 1023);
+    ASSERT_EQ(stick.m_hidValues[0x35], 512);
+    out = translateOne(stick);
+    ASSERT_EQ(out.gamepad.wButtons, XINPUT_GAMEPAD_A | XINPUT_GAMEPAD_Y);
+    ASSERT_EQ(out.gamepad.sThumbLX, 32767);
+    ASSERT_TRUE(out.gamepad.sThumbLY >= 32700);   // Y inverted
+}
+
+TEST(ReadsFieldsAcrossByteBoundaries) {
+    const uint8_t report[] = {0xAB, 0xCD, 0xEF, 0x12, 0x34};
+    ASSERT_EQ(HidReportDescriptor::readBits(report, 5, 0, 8), 0xABu);
+    ASSERT_EQ(HidReportDescriptor::readBits(report, 5, 4, 8), 0xDAu);
+    ASSERT_EQ(HidReportDescriptor::readBits(report, 5, 3, 10), (0xCDABu >> 3) & 0x3FF);
+    ASSERT_EQ(HidReportDescriptor::readBits(report, 5, 4, 32), 0x412EFCDAu);
+    ASSERT_EQ(HidReportDescriptor::readBits(report, 5, 36, 8), 0u);   // Past the end
+}
+
+TEST(DecodesButtonArrays) {
+    // Two 4-bit slots, each naming a pressed button 1-8 (0 = none)
+    const std::vector<uint8_t> descriptor = {
+        0x05, 0x01, 0x09, 0x05, 0xA1, 0x01,
+        0x05, 0x09, 0x19, 0x01, 0x29, 0x08, 0x15, 0x01, 0x25, 0x08,
+        0x75, 0x04, 0x95, 0x02, 0x81, 0x00,
+        0xC0,
+    };
+    HidReportDescriptor parsed;
+    ASSERT_TRUE(parsed.parse(descriptor.data(), descriptor.size()));
+    ASSERT_EQ(parsed.getButtonArrays().size(), 1u);
+    ControllerState state{};
+    const uint8_t twoPressed[] = {0x73};
+    ASSERT_TRUE(parsed.decode(twoPressed, 1, state));
+    ASSERT_EQ(state.m_activeButtons.size(), 2u);
+    ASSERT_TRUE(hasButton(state, 3) && hasButton(state, 7));
+    const uint8_t nonePressed[] = {0x00};
+    ASSERT_TRUE(parsed.decode(nonePressed, 1, state));
+    ASSERT_TRUE(state.m_activeButtons.empty());
+}
+
+TEST(PushPopAndReportsWithoutButtons) {
+    // Report 1: 8-bit X; report 2: button 1 (X's globals restored by Pop)
+    const std::vector<uint8_t> descriptor = {
+        0x05, 0x01, 0x09, 0x05, 0xA1, 0x01,
+        0x85, 0x01, 0x15, 0x00, 0x26, 0xFF, 0x00, 0x75, 0x08, 0x95, 0x01,
+        0xA4,
+        0x85, 0x02, 0x05, 0x09, 0x09, 0x01, 0x25, 0x01, 0x75, 0x01, 0x81, 0x02,
+        0x75, 0x07, 0x81, 0x03,
+        0xB4,
+        0x09, 0x30, 0x81, 0x02,
+        0xC0,
+    };
+    HidReportDescriptor parsed;
+    ASSERT_TRUE(parsed.parse(descriptor.data(), descriptor.size()));
+    ASSERT_EQ(parsed.getInputReportLength(1), 2u);
+    ASSERT_EQ(parsed.getInputReportLength(2), 2u);
+    ASSERT_EQ(parsed.getValueFields()[0].reportId, 1);
+    ASSERT_EQ(parsed.getValueFields()[0].logicalMax, 255);
+
+    ControllerState state{};
+    const uint8_t buttons[] = {0x02, 0x01};
+    const uint8_t axis[] = {0x01, 0x40};
+    ASSERT_TRUE(parsed.decode(buttons, 2, state));
+    ASSERT_TRUE(parsed.decode(axis, 2, state));
+    ASSERT_TRUE(hasButton(state, 1));   // Report 1 carries no buttons
+    ASSERT_EQ(state.m_hidValues[0x30], 0x40);
+}
+
+TEST(RejectsMalformedDescriptors) {
+    HidReportDescriptor parsed;
+    const uint8_t truncated[] = {0x05, 0x01, 0x26, 0xFF};
+    ASSERT_TRUE(!parsed.parse(truncated, sizeof(truncated)));
+    ASSERT_TRUE(!parsed.getError().empty());
+    const uint8_t unterminated[] = {0x05, 0x01, 0x09, 0x05, 0xA1, 0x01};
+    ASSERT_TRUE(!parsed.parse(unterminated, sizeof(unterminated)));
+    const uint8_t popWithoutPush[] = {0xB4};
+    ASSERT_TRUE(!parsed.parse(popWithoutPush, sizeof(popWithoutPush)));
+    const uint8_t strayEnd[] = {0xC0};
+    ASSERT_TRUE(!parsed.parse(strayEnd, sizeof(strayEnd)));
+
+    // 32 bits x 2^27 wraps to zero in 32-bit arithmetic
+    const uint8_t wrappingSize[] = {0x05, 0x09, 0x19, 0x01, 0x2A, 0xFF, 0xFF,
+                                    0x75, 0x20, 0x97, 0x00, 0x00, 0x00, 0x08, 0x81, 0x02};
+    ASSERT_TRUE(!parsed.parse(wrappingSize, sizeof(wrappingSize)));
+    // Zero-bit fields take no space, but a huge count must not size the usage list
+    const uint8_t hugeCount[] = {0x05, 0x09, 0x19, 0x01, 0x2A, 0xFF, 0xFF,
+                                 0x75, 0x00, 0x97, 0xFF, 0xFF, 0xFF, 0x7F, 0x81, 0x02};
+    ASSERT_TRUE(!parsed.parse(hugeCount, sizeof(hugeCount)));
+}
+
+int main() {
+    std::cout << "=== HID Descriptor Tests ===\n\n";
+
+    RUN_TEST(ParsesDs4Layout);
+    RUN_TEST(DecodesDs4ReportThroughTranslation);
+    RUN_TEST(DecodesDualSenseAndGenericReports);
+    RUN_TEST(ReadsFieldsAcrossByteBoundaries);
+    RUN_TEST(DecodesButtonArrays);
+    RUN_TEST(PushPopAndReportsWithoutButtons);
+    RUN_TEST(RejectsMalformedDescriptors);
+
+    std::cout << "\n=== All tests PASSED ===\n";
+    return 0;
+}
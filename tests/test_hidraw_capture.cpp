@@ -0,0 +1,224 @@
+/**
+ * @file test_hidraw_capture.cpp
+ * @brief End-to-end tests for the Linux hidraw capture backend
+ *
+ * Devices are emulated with VirtualHidDevice: real kernel devices through
+ * /dev/uhid when this process may open it, otherwise the socket pair stand-in.
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "../include/core/hidraw_source.hpp"
+#include "../include/core/translation_layer.hpp"
+#include "../include/core/virtual_hid_device.hpp"
+#include "hid_descriptors.hpp"
+
+#define TEST(name) void test_##name()
+#define RUN_TEST(name) do { \
+    std::cout << "Running " #name "..."; \
+    test_##name(); \
+    std::cout << " PASSED\n"; \
+} while(0)
+
+#define ASSERT_EQ(a, b) do { \
+    if ((a) != (b)) { \
+        std::cerr << "ASSERT_EQ failed: " << (a) << " != " << (b) << " at line " << __LINE__ << "\n"; \
+        assert(false); \
+    } \
+} while(0)
+
+#define ASSERT_TRUE(x) do { \
+    if (!(x)) { \
+        std::cerr << "ASSERT_TRUE failed at line " << __LINE__ << "\n"; \
+        assert(false); \
+    } \
+} while(0)
+
+using namespace hid_fixtures;
+
+static const VirtualHidDevice::Spec DS4_SPEC = {"Wireless Controller", 0x054C, 0x05C4, DS4_DESCRIPTOR};
+static const VirtualHidDevice::Spec DUALSENSE_SPEC = {"DualSense Wireless Controller", 0x054C, 0x0CE6, DUALSENSE_DESCRIPTOR};
+static const VirtualHidDevice::Spec GENERIC_SPEC = {"Generic USB Joystick", 0x0079, 0x0006, GENERIC_DESCRIPTOR};
+
+static bool sendReport(VirtualHidDevice& device, const std::vector<uint8_t>& report) {
+    return device.sendReport(report.data(), report.size());
+}
+
+// Poll until the source has read `count` reports of a device
+static bool waitForReports(HidrawInputSource& source, size_t device, uint64_t count) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (source.getReportCount(device) < count) {
+        if (std::chrono::steady_clock::now() > deadline) return false;
+        if (source.isRunning()) std::this_thread::yield();
+        else source.poll(10);
+    }
+    return true;
+}
+
+TEST(RecordedDevicesFeedTranslation) {
+    HidrawInputSource source;
+    VirtualHidDevice ds4, dualSense, generic;
+    ASSERT_TRUE(ds4.create(DS4_SPEC) && ds4.attach(source));
+    ASSERT_TRUE(dualSense.create(DUALSENSE_SPEC) && dualSense.attach(source));
+    ASSERT_TRUE(generic.create(GENERIC_SPEC) && generic.attach(source));
+    ASSERT_EQ(source.getDeviceCount(), 3u);
+
+    std::vector<uint8_t> ds4Input = ds4Report(255, 128, 1u << 1);    // Cross
+    writeInt16(ds4Input, 13, -300);                                   // Gyro pitch
+    ASSERT_TRUE(sendReport(ds4, ds4Input));
+    ASSERT_TRUE(sendReport(dualSense, dualSenseReport(128, 255, 1u << 3)));
+    ASSERT_TRUE(sendReport(generic, genericReport(0, 512, 1u << 1)));
+    ASSERT_TRUE(waitForReports(source, 0, 1) && waitForReports(source, 1, 1) && waitForReports(source, 2, 1));
+
+    std::vector<ControllerState> states = source.getInputStates();
+    ASSERT_EQ(states.size(), 3u);
+    for (const auto& state : states) {
+        ASSERT_TRUE(state.isConnected);
+        ASSERT_EQ(state.userId, -1);
+        ASSERT_TRUE(!state.valueCaps.empty());
+    }
+    ASSERT_TRUE(states[0].productName == L"Wireless Controller");
+    ASSERT_EQ(states[0].vendorId, 0x054C);
+    ASSERT_TRUE(states[0].motion.valid);
+    ASSERT_EQ(states[0].motion.gyro[0], -300);
+
+    TranslationLayer layer;
+    layer.setStickDeadzoneEnabled(false);
+    std::vector<TranslatedState> out = layer.translate(states);
+    ASSERT_EQ(out.size(), 3u);
+    ASSERT_EQ(out[0].gamepad.wButtons, XINPUT_GAMEPAD_A);
+    ASSERT_EQ(out[0].gamepad.sThumbLX, 127 * 256);
+    ASSERT_EQ(out[1].gamepad.wButtons, XINPUT_GAMEPAD_Y);
+    ASSERT_EQ(out[1].gamepad.bLeftTrigger, 255);
+    ASSERT_EQ(out[2].gamepad.wButtons, XINPUT_GAMEPAD_B);
+    ASSERT_TRUE(out[2].gamepad.sThumbLX <= -32000);
+}
+
+TEST(UpdateDrainsBurstsAndKeepsNewest) {
+    HidrawInputSource source;
+    VirtualHidDevice generic;
+    ASSERT_TRUE(generic.create(GENERIC_SPEC) && generic.attach(source));
+
+    // Several reports between two frames: update() reads them all, the last one wins
+    for (uint16_t x = 100; x < 105; ++x) {
+        ASSERT_TRUE(sendReport(generic, genericReport(x, 512, 0)));
+    }
+    ASSERT_TRUE(waitForReports(source, 0, 5));
+    ASSERT_EQ(source.getReportCount(0), 5u);
+    ASSERT_EQ(source.getInputStates()[0].m_hidValues.at(0x30), 104);
+
+    // Nothing new: a non-blocking update() reads nothing
+    source.update(1.0);
+    ASSERT_EQ(source.getReportCount(0), 5u);
+}
+
+TEST(CaptureThreadWakesOnReports) {
+    HidrawInputSource source;
+    VirtualHidDevice generic;
+    ASSERT_TRUE(generic.create(GENERIC_SPEC) && generic.attach(source));
+    source.start();
+    ASSERT_TRUE(source.isRunning());
+
+    // Ping one report at a time and time it from send to decode
+    const int reports = 200;
+    std::vector<uint64_t> latencies;
+    for (int i = 0; i < reports; ++i) {
+        uint64_t sentUs = HidrawInputSource::nowUs();
+        ASSERT_TRUE(sendReport(generic, genericReport(static_cast<uint16_t>(i % 1024), 512, 0)));
+        ASSERT_TRUE(waitForReports(source, 0, static_cast<uint64_t>(i + 1)));
+        uint64_t readUs = source.lastReportUs(0);
+        latencies.push_back(readUs >= sentUs ? readUs - sentUs : 0);
+    }
+    ASSERT_EQ(source.getInputStates()[0].m_hidValues.at(0x30), reports - 1);
+
+    // update() only publishes while the capture thread reads
+    source.update(1.0);
+    ASSERT_EQ(source.getReportCount(0), static_cast<uint64_t>(reports));
+    source.stop();
+    ASSERT_TRUE(!source.isRunning());
+
+    std::sort(latencies.begin(), latencies.end());
+    std::cout << " [" << (generic.getBackend() == VirtualHidDevice::Backend::UHID ? "uhid" : "stream")
+              << " p50 " << latencies[reports / 2] << " us, p99 " << latencies[reports * 99 / 100] << " us]";
+}
+
+TEST(UnplugMarksDeviceDisconnected) {
+    HidrawInputSource source;
+    VirtualHidDevice ds4;
+    ASSERT_TRUE(ds4.create(DS4_SPEC) && ds4.attach(source));
+    ASSERT_TRUE(sendReport(ds4, ds4Report(128, 128, 1u << 1)));
+    ASSERT_TRUE(waitForReports(source, 0, 1));
+    ASSERT_TRUE(!source.getInputStates()[0].m_activeButtons.empty());
+
+    ds4.destroy();
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    std::vector<ControllerState> states = source.getInputStates();
+    while (states[0].isConnected && std::chrono::steady_clock::now() < deadline) {
+        source.poll(10);
+        states = source.getInputStates();
+    }
+    ASSERT_TRUE(!states[0].isConnected);
+    ASSERT_TRUE(states[0].m_activeButtons.empty());
+
+    // The disconnect is published once, then the dead entry is left out
+    ASSERT_EQ(source.getInputStates().size(), 0u);
+}
+
+TEST(ReopenedNodeReusesItsEntry) {
+    HidrawInputSource source;
+    for (int round = 0; round < 3; ++round) {
+        int fds[2];
+        ASSERT_EQ(socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, fds), 0);
+        ASSERT_TRUE(source.addStream(fds[0], GENERIC_DESCRIPTOR, "Generic USB Joystick", 0x0079, 0x0006,
+                                     "/test/hidraw9"));
+        ASSERT_EQ(source.getDeviceCount(), 1u);
+        ASSERT_EQ(source.getInputStates().size(), 1u);
+
+        // Unplug: the reader sees EOF and closes the entry
+        close(fds[1]);
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+        std::vector<ControllerState> states = source.getInputStates();
+        while (!states.empty() && states[0].isConnected && std::chrono::steady_clock::now() < deadline) {
+            source.poll(10);
+            states = source.getInputStates();
+        }
+        ASSERT_EQ(states.size(), 1u);
+        ASSERT_TRUE(!states[0].isConnected);
+        ASSERT_EQ(source.getInputStates().size(), 0u);
+    }
+}
+
+TEST(RejectsBadDescriptorsAndMissingNodes) {
+    HidrawInputSource source;
+    VirtualHidDevice broken;
+    VirtualHidDevice::Spec spec = GENERIC_SPEC;
+    spec.descriptor.pop_back();   // Unterminated collection
+    ASSERT_TRUE(broken.create(spec, false));
+    ASSERT_TRUE(!broken.attach(source));
+    ASSERT_EQ(source.getDeviceCount(), 0u);
+
+    ASSERT_TRUE(!source.openDevice("/nonexistent/hidraw0"));
+    ASSERT_EQ(source.scan("/nonexistent"), 0u);
+}
+
+int main() {
+    std::cout << "=== Hidraw Capture Tests ===\n";
+    std::cout << "(devices via " << (VirtualHidDevice::uhidAvailable() ? "/dev/uhid" : "socket pair stand-in")
+              << ")\n\n";
+
+    RUN_TEST(RecordedDevicesFeedTranslation);
+    RUN_TEST(UpdateDrainsBurstsAndKeepsNewest);
+    RUN_TEST(CaptureThreadWakesOnReports);
+    RUN_TEST(UnplugMarksDeviceDisconnected);
+    RUN_TEST(ReopenedNodeReusesItsEntry);
+    RUN_TEST(RejectsBadDescriptorsAndMissingNodes);
+
+    std::cout << "\n=== All tests PASSED ===\n";
+    return 0;
+}
@@ -0,0 +1,337 @@
+/**
+ * @file test_input_merger.cpp
+ * @brief Tests for many-to-one input merging
+ */
+
+#include <cassert>
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include "../include/core/input_merger.hpp"
+
+#define TEST(name) void test_##name()
+#define RUN_TEST(name) do { \
+    std::cout << "Running " #name "..."; \
+    test_##name(); \
+    std::cout << " PASSED\n"; \
+} while(0)
+
+#define ASSERT_EQ(a, b) do { \
+    if ((a) != (b)) { \
+        std::cerr << "ASSERT_EQ failed: " << (a) << " != " << (b) << " at line " << __LINE__ << "\n"; \
+        assert(false); \
+    } \
+} while(0)
+
+#define ASSERT_TRUE(x) do { \
+    if (!(x)) { \
+        std::cerr << "ASSERT_TRUE failed at line " << __LINE__ << "\n"; \
+        assert(false); \
+    } \
+} while(0)
+
+#define ASSERT_FALSE(x) do { \
+    if (x) { \
+        std::cerr << "ASSERT_FALSE failed at line " << __LINE__ << "\n"; \
+        assert(false); \
+    } \
+} while(0)
+
+// Synthetic HID source with its own report rate
+struct SyntheticSource {
+    ControllerState capture;
+    int periodMs;
+};
+
+static ControllerState makeHidState(const std::wstring& name) {
+    ControllerState state{};
+    state.userId = -1;
+    state.devicePath = L"\\\\?\\HID#" + name;
+    state.deviceInstanceId = L"HID\\" + name;
+    state.productName = name;
+    state.isConnected = true;
+    return state;
+}
+
+static TranslatedState makeFrame(int slot, uint64_t timestamp) {
+    TranslatedState state{};
+    state.sourceUserId = -1;
+    state.sourceSlot = slot;
+    state.timestamp = timestamp;
+    state.targetType = TranslatedState::TARGET_XINPUT;
+    return state;
+}
+
+static MergeGroupConfig racingRig() {
+    MergeGroupConfig group;
+    group.name = "Racing Rig";
+    group.sourceMatches = {L"Pedals", L"Shifter", L"Button Box"};
+    return group;
+}
+
+TEST(FindGroupMatchesByNameOrInstanceId) {
+    InputMerger merger;
+    merger.configure({racingRig()});
+
+    int source = -1;
+    ASSERT_EQ(merger.findGroup(makeHidState(L"Fanatec Pedals V3"), &source), 0);
+    ASSERT_EQ(source, 0);
+    ASSERT_EQ(merger.findGroup(makeHidState(L"Generic BUTTON BOX"), &source), 0);
+    ASSERT_EQ(source, 2);
+    ASSERT_EQ(merger.findGroup(makeHidState(L"Xbox Controller")), -1);
+}
+
+TEST(NoGroupsLeavesFrameUntouched) {
+    InputMerger merger;
+    std::vector<ControllerState> inputs = {makeHidState(L"Pedals")};
+    std::vector<TranslatedState> frame = {makeFrame(0, 1)};
+    merger.apply(inputs, frame);
+    ASSERT_EQ(frame.size(), 1u);
+    ASSERT_EQ(frame[0].sourceUserId, -1);
+}
+
+TEST(MergesIntoSingleReport) {
+    InputMerger merger;
+    merger.configure({racingRig()});
+
+    std::vector<ControllerState> inputs = {
+        makeHidState(L"Pedals"), makeHidState(L"Shifter"), makeHidState(L"Button Box"), makeHidState(L"Xbox Controller")
+    };
+    inputs[3].userId = 0;
+
+    std::vector<TranslatedState> frame = {makeFrame(0, 10), makeFrame(1, 10), makeFrame(2, 10), makeFrame(3, 10)};
+    frame[0].gamepad.bRightTrigger = 200;  // Throttle
+    frame[0].gamepad.bLeftTrigger = 50;    // Brake
+    frame[1].gamepad.wButtons = XINPUT_GAMEPAD_DPAD_UP;  // Gear up
+    frame[2].gamepad.wButtons = XINPUT_GAMEPAD_A | XINPUT_GAMEPAD_START;
+    frame[2].gamepad.bRightTrigger = 10;
+    frame[3].sourceUserId = 0;
+
+    merger.apply(inputs, frame);
+
+    // Xbox controller passes through, three members become one report
+    ASSERT_EQ(frame.size(), 2u);
+    ASSERT_EQ(frame[0].sourceUserId, 0);
+    const TranslatedState& merged = frame[1];
+    ASSERT_EQ(merged.sourceUserId, InputMerger::virtualUserId(0));
+    ASSERT_EQ(merged.gamepad.wButtons, XINPUT_GAMEPAD_DPAD_UP | XINPUT_GAMEPAD_A | XINPUT_GAMEPAD_START);
+    ASSERT_EQ(merged.gamepad.bRightTrigger, 200);
+    ASSERT_EQ(merged.gamepad.bLeftTrigger, 50);
+}
+
+TEST(StickMaxKeepsLargestDeflection) {
+    InputMerger merger;
+    merger.configure({racingRig()});
+
+    TranslatedState a = makeFrame(0, 1);
+    TranslatedState b = makeFrame(1, 1);
+    a.gamepad.sThumbLX = 1000;
+    b.gamepad.sThumbLX = -20000;
+    merger.publish(0, 0, a);
+    merger.publish(0, 1, b);
+
+    TranslatedState merged;
+    ASSERT_TRUE(merger.compose(0, merged));
+    ASSERT_EQ(merged.gamepad.sThumbLX, -20000);
+}
+
+TEST(PriorityPrefersEarlierSource) {
+    MergeGroupConfig group = racingRig();
+    group.buttons = MergePolicy::PRIORITY;
+    group.sticks = MergePolicy::PRIORITY;
+    InputMerger merger;
+    merger.configure({group});
+
+    TranslatedState a = makeFrame(0, 1);
+    TranslatedState b = makeFrame(1, 1);
+    a.gamepad.sThumbLX = 0;        // Neutral: falls through to next source
+    a.gamepad.wButtons = XINPUT_GAMEPAD_A;
+    b.gamepad.sThumbLX = 12000;
+    b.gamepad.wButtons = XINPUT_GAMEPAD_B;
+    merger.publish(0, 0, a);
+    merger.publish(0, 1, b);
+
+    TranslatedState merged;
+    ASSERT_TRUE(merger.compose(0, merged));
+    ASSERT_EQ(merged.gamepad.wButtons, XINPUT_GAMEPAD_A);
+    ASSERT_EQ(merged.gamepad.sThumbLX, 12000);
+}
+
+TEST(LastChangedFollowsMostRecentSource) {
+    MergeGroupConfig group = racingRig();
+    group.sticks = MergePolicy::LAST_CHANGED;
+    InputMerger merger;
+    merger.configure({group});
+
+    TranslatedState a = makeFrame(0, 100);
+    TranslatedState b = makeFrame(1, 100);
+    a.gamepad.sThumbLX = 5000;
+    b.gamepad.sThumbLX = -3000;
+    merger.publish(0, 0, a);
+    merger.publish(0, 1, b);
+
+    TranslatedState merged;
+    merger.compose(0, merged);
+    // Same change time: priority order breaks the tie
+    ASSERT_EQ(merged.gamepad.sThumbLX, 5000);
+
+    // Source 1 moves later; source 0 keeps reporting the same value
+    a.timestamp = 200;
+    b.timestamp = 200;
+    b.gamepad.sThumbLX = -8000;
+    merger.publish(0, 0, a);
+    merger.publish(0, 1, b);
+    merger.compose(0, merged);
+    ASSERT_EQ(merged.gamepad.sThumbLX, -8000);
+
+    // Source 0 moves last
+    a.timestamp = 300;
+    a.gamepad.sThumbLX = 7000;
+    merger.publish(0, 0, a);
+    merger.compose(0, merged);
+    ASSERT_EQ(merged.gamepad.sThumbLX, 7000);
+}
+
+TEST(DisconnectedSourceStopsContributing) {
+    InputMerger merger;
+    merger.configure({racingRig()});
+
+    std::vector<ControllerState> inputs = {makeHidState(L"Pedals"), makeHidState(L"Button Box")};
+    std::vector<TranslatedState> frame = {makeFrame(0, 1), makeFrame(1, 1)};
+    frame[1].gamepad.wButtons = XINPUT_GAMEPAD_Y;
+    merger.apply(inputs, frame);
+    ASSERT_EQ(frame.back().gamepad.wButtons, XINPUT_GAMEPAD_Y);
+
+    // Button box unplugged mid-press
+    inputs[1].isConnected = false;
+    frame = {makeFrame(0, 2)};
+    merger.apply(inputs, frame);
+    ASSERT_EQ(frame.size(), 1u);
+    ASSERT_EQ(frame[0].gamepad.wButtons, 0);
+
+    // Everything gone: no merged report at all
+    inputs[0].isConnected = false;
+    frame.clear();
+    merger.apply(inputs, frame);
+    ASSERT_TRUE(frame.empty());
+}
+
+TEST(SlotReassignedToAnotherDevice) {
+    InputMerger merger;
+    merger.configure({racingRig()});
+
+    std::vector<ControllerState> inputs = {makeHidState(L"Pedals")};
+    std::vector<TranslatedState> frame = {makeFrame(0, 1)};
+    frame[0].gamepad.bRightTrigger = 120;
+    merger.apply(inputs, frame);
+    ASSERT_EQ(frame.size(), 1u);
+    ASSERT_EQ(frame[0].sourceUserId, InputMerger::virtualUserId(0));
+
+    // Pedals unplugged, an Xbox pad takes over the slot: it must not be merged
+    inputs[0].isConnected = false;
+    frame.clear();
+    merger.apply(inputs, frame);
+    inputs[0] = makeHidState(L"Xbox Controller");
+    inputs[0].userId = 0;
+    frame = {makeFrame(0, 2)};
+    frame[0].sourceUserId = 0;
+    merger.apply(inputs, frame);
+    ASSERT_EQ(frame.size(), 1u);
+    ASSERT_EQ(frame[0].sourceUserId, 0);
+}
+
+TEST(SourcesAtDifferentRates) {
+    InputMerger merger;
+    merger.configure({racingRig()});
+
+    // Pedals at 1000 Hz, shifter at 250 Hz, button box at 125 Hz
+    std::vector<SyntheticSource> sources = {
+        {makeHidState(L"Pedals"), 1},
+        {makeHidState(L"Shifter"), 4},
+        {makeHidState(L"Button Box"), 8},
+    };
+    std::vector<ControllerState> inputs;
+    for (const auto& source : sources) inputs.push_back(source.capture);
+
+    for (int ms = 0; ms < 64; ++ms) {
+        // Only sources that produced a report this tick appear in the frame
+        std::vector<TranslatedState> frame;
+        for (size_t i = 0; i < sources.size(); ++i) {
+            if (ms % sources[i].periodMs != 0) continue;
+            TranslatedState state = makeFrame(static_cast<int>(i), ms);
+            if (i == 0) state.gamepad.bRightTrigger = static_cast<BYTE>(ms * 4);  // Throttle ramp
+            if (i == 1) state.gamepad.wButtons = (ms / 4) % 2 ? XINPUT_GAMEPAD_DPAD_UP : 0;
+            if (i == 2) state.gamepad.wButtons = XINPUT_GAMEPAD_X;
+            frame.push_back(state);
+        }
+
+        merger.apply(inputs, frame);
+
+        // Exactly one merged report per frame, always reflecting the newest
+        // frame of each source even on ticks where the slow sources are silent
+        ASSERT_EQ(frame.size(), 1u);
+        ASSERT_EQ(frame[0].gamepad.bRightTrigger, static_cast<BYTE>(ms * 4));
+        ASSERT_TRUE(frame[0].gamepad.wButtons & XINPUT_GAMEPAD_X);
+        bool gearUp = (ms / 4) % 2;
+        ASSERT_EQ((frame[0].gamepad.wButtons & XINPUT_GAMEPAD_DPAD_UP) != 0, gearUp);
+    }
+}
+
+TEST(ConcurrentPublishNeverTears) {
+    InputMerger merger;
+    merger.configure({racingRig()});
+
+    std::atomic<bool> done{false};
+    std::thread producer([&]() {
+        TranslatedState state = makeFrame(0, 0);
+        for (int i = 1; i < 200000; ++i) {
+            // Every field derives from the same counter so a torn read is detectable
+            state.timestamp = static_cast<uint64_t>(i);
+            state.gamepad.wButtons = static_cast<WORD>(i);
+            state.gamepad.sThumbLX = static_cast<SHORT>(i);
+            state.gamepad.sThumbRY = static_cast<SHORT>(-(i & 0x7FFF));
+            merger.publish(0, 0, state);
+        }
+        done = true;
+    });
+
+    uint64_t lastTimestamp = 0;
+    while (!done) {
+        TranslatedState merged;
+        if (!merger.compose(0, merged)) continue;
+        uint64_t i = merged.timestamp;
+        ASSERT_EQ(merged.gamepad.wButtons, static_cast<WORD>(i));
+        ASSERT_EQ(merged.gamepad.sThumbLX, static_cast<SHORT>(i));
+        ASSERT_EQ(merged.gamepad.sThumbRY, static_cast<SHORT>(-static_cast<int>(i & 0x7FFF)));
+        ASSERT_TRUE(i >= lastTimestamp);
+        lastTimestamp = i;
+    }
+    producer.join();
+}
+
+TEST(ParsePolicy) {
+    ASSERT_TRUE(InputMerger::parsePolicy("OR", MergePolicy::MAX) == MergePolicy::OR);
+    ASSERT_TRUE(InputMerger::parsePolicy("last_changed", MergePolicy::MAX) == MergePolicy::LAST_CHANGED);
+    ASSERT_TRUE(InputMerger::parsePolicy("Priority", MergePolicy::MAX) == MergePolicy::PRIORITY);
+    ASSERT_TRUE(InputMerger::parsePolicy("bogus", MergePolicy::MAX) == MergePolicy::MAX);
+}
+
+int main() {
+    std::cout << "=== Input Merger Tests ===\n\n";
+
+    RUN_TEST(FindGroupMatchesByNameOrInstanceId);
+    RUN_TEST(NoGroupsLeavesFrameUntouched);
+    RUN_TEST(MergesIntoSingleReport);
+    RUN_TEST(StickMaxKeepsLargestDeflection);
+    RUN_TEST(PriorityPrefersEarlierSource);
+    RUN_TEST(LastChangedFollowsMostRecentSource);
+    RUN_TEST(DisconnectedSourceStopsContributing);
+    RUN_TEST(SlotReassignedToAnotherDevice);
+    RUN_TEST(SourcesAtDifferentRates);
+    RUN_TEST(ConcurrentPublishNeverTears);
+    RUN_TEST(ParsePolicy);
+
+    std::cout << "\n=== All tests PASSED ===\n";
+    return 0;
+}
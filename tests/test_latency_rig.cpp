@@ -0,0 +1,144 @@
+/**
+ * @file test_latency_rig.cpp
+ * @brief Tests for the synthetic input source and the end-to-end latency rig
+ */
+
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../include/core/synthetic_source.hpp"
+#include "../include/core/latency_rig.hpp"
+
+#define TEST(name) void test_##name()
+#define RUN_TEST(name) do { \
+    std::cout << "Running " #name "..."; \
+    test_##name(); \
+    std::cout << " PASSED\n"; \
+} while(0)
+
+#define ASSERT_EQ(a, b) do { \
+    if ((a) != (b)) { \
+        std::cerr << "ASSERT_EQ failed: " << (a) << " != " << (b) << " at line " << __LINE__ << "\n"; \
+        assert(false); \
+    } \
+} while(0)
+
+#define ASSERT_TRUE(x) do { \
+    if (!(x)) { \
+        std::cerr << "ASSERT_TRUE failed at line " << __LINE__ << "\n"; \
+        assert(false); \
+    } \
+} while(0)
+
+TEST(SyntheticSourceStampsEdges) {
+    SyntheticInputSource::Config config;
+    config.controllers = 2;
+    config.reportRateHz = 1000;
+    config.reportsPerEdge = 4;
+    SyntheticInputSource source(config);
+
+    // Nothing is visible before the first update
+    std::vector<ControllerState> states = source.getInputStates();
+    ASSERT_EQ(states.size(), 2u);
+    ASSERT_EQ(states[1].userId, 1);
+    ASSERT_EQ(source.lastReportUs(0), 0u);
+
+    source.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    source.stop();
+    source.update(0.0);
+
+    states = source.getInputStates();
+    std::vector<SyntheticInputSource::Edge> edges = source.getEdges();
+    ASSERT_TRUE(edges.size() > 10);
+    std::vector<bool> pressed(2, false);
+    for (const auto& edge : edges) {
+        // An edge every reportsPerEdge reports, alternating press and release
+        ASSERT_EQ(edge.sequence % config.reportsPerEdge, 0);
+        ASSERT_TRUE(edge.pressed != pressed[edge.controller]);
+        pressed[edge.controller] = edge.pressed;
+    }
+
+    // The newest report carries its sequence number and the current button state
+    for (size_t i = 0; i < 2; ++i) {
+        uint16_t sequence = SyntheticInputSource::sequenceOf(states[i].xinputState.Gamepad.sThumbRX);
+        ASSERT_EQ(static_cast<DWORD>(sequence), states[i].xinputState.dwPacketNumber);
+        bool a = (states[i].xinputState.Gamepad.wButtons & XINPUT_GAMEPAD_A) != 0;
+        ASSERT_EQ(a, pressed[i]);
+        ASSERT_TRUE(source.lastReportUs(i) > 0);
+    }
+}
+
+TEST(SequenceErrorsRecordNoLatency) {
+    EdgeProbeBus bus(1);
+    TranslatedState state{};
+    state.gamepad.wButtons = XINPUT_GAMEPAD_A;
+    state.gamepad.sThumbRX = 8;
+    bus.submit(0, state);                 // Press carried by report 8: matches its edge
+    state.gamepad.wButtons = 0;
+    state.gamepad.sThumbRX = 40;
+    bus.submit(0, state);                 // Release carried by report 40: past the next edge
+
+    std::vector<SyntheticInputSource::Edge> edges = {{0, 8, true, 0}, {0, 16, false, 0}};
+    LatencyRig::Result result;
+    std::vector<double> latencies;
+    bus.match(edges, 8, result, latencies);
+    ASSERT_EQ(result.edges, 2u);
+    ASSERT_EQ(result.delivered, 2u);
+    ASSERT_EQ(result.sequenceErrors, 1u);
+    ASSERT_EQ(latencies.size(), 1u);
+}
+
+// Wall-clock runs: registered separately (label "slow") since a loaded machine can skew them
+
+TEST(InlineRunDeliversEveryEdge) {
+    LatencyRig::Scenario scenario;
+    scenario.pacing = LatencyRig::Pacing::FIXED;
+    scenario.threading = LatencyRig::Threading::INLINE;
+    scenario.controllers = 1;
+    scenario.durationMs = 300;
+
+    LatencyRig::Result result = LatencyRig::run(scenario);
+    ASSERT_TRUE(result.edges > 20);
+    ASSERT_EQ(result.delivered, result.edges);
+    ASSERT_EQ(result.sequenceErrors, 0u);
+    ASSERT_TRUE(result.loopFrames > 0);
+    ASSERT_TRUE(result.p50Us >= 0.0);
+    ASSERT_TRUE(result.p50Us <= result.p99Us);
+    ASSERT_TRUE(result.p99Us <= result.maxUs);
+    // Generous bound: a loaded CI machine may oversleep, but not by this much
+    ASSERT_TRUE(result.p99Us < 20000.0);
+}
+
+TEST(InjectThreadPhaseAlignedDeliversEveryEdge) {
+    LatencyRig::Scenario scenario;
+    scenario.pacing = LatencyRig::Pacing::PHASE_ALIGNED;
+    scenario.threading = LatencyRig::Threading::INJECT_THREAD;
+    scenario.controllers = 4;
+    scenario.durationMs = 300;
+
+    LatencyRig::Result result = LatencyRig::run(scenario);
+    ASSERT_TRUE(result.edges > 80);
+    ASSERT_EQ(result.delivered, result.edges);
+    ASSERT_EQ(result.sequenceErrors, 0u);
+    ASSERT_EQ(LatencyRig::describe(scenario), std::string("phase/inject_thread/4_controllers"));
+}
+
+int main(int argc, char* argv[]) {
+    bool timing = argc > 1 && std::string(argv[1]) == "--timing";
+    std::cout << "=== Latency Rig Tests" << (timing ? " (timing)" : "") << " ===\n\n";
+
+    if (timing) {
+        RUN_TEST(InlineRunDeliversEveryEdge);
+        RUN_TEST(InjectThreadPhaseAlignedDeliversEveryEdge);
+    } else {
+        RUN_TEST(SyntheticSourceStampsEdges);
+        RUN_TEST(SequenceErrorsRecordNoLatency);
+    }
+
+    std::cout << "\n=== All tests PASSED ===\n";
+    return 0;
+}
@@ -0,0 +1,252 @@
+/**
+ * @file test_motion.cpp
+ * @brief Tests for motion sensor extraction and gyro-to-stick mapping
+ */
+
+#include <cassert>
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+#include "../include/core/translation_layer.hpp"
+#include "../include/core/motion.hpp"
+
+#define TEST(name) void test_##name()
+#define RUN_TEST(name) do { \
+    std::cout << "Running " #name "..."; \
+    test_##name(); \
+    std::cout << " PASSED\n"; \
+} while(0)
+
+#define ASSERT_EQ(a, b) do { \
+    if ((a) != (b)) { \
+        std::cerr << "ASSERT_EQ failed: " << (a) << " != " << (b) << " at line " << __LINE__ << "\n"; \
+        assert(false); \
+    } \
+} while(0)
+
+#define ASSERT_TRUE(x) do { \
+    if (!(x)) { \
+        std::cerr << "ASSERT_TRUE failed at line " << __LINE__ << "\n"; \
+        assert(false); \
+    } \
+} while(0)
+
+#define ASSERT_FALSE(x) do { \
+    if (x) { \
+        std::cerr << "ASSERT_FALSE failed at line " << __LINE__ << "\n"; \
+        assert(false); \
+    } \
+} while(0)
+
+// DualSense USB input report 0x01 (64 bytes), controller lying still.
+// Gyro (2, -3, 1), accel (-150, 8200, 300), sensor timestamp 0x00123400.
+static const uint8_t DUALSENSE_USB_REST[64] = {
+    0x01, 0x80, 0x7F, 0x81, 0x80, 0x00, 0x00, 0x2A, 0x08, 0x00, 0x00, 0x00, 0x9C, 0x3F, 0x11, 0x05,
+    0x02, 0x00, 0xFD, 0xFF, 0x01, 0x00, 0x6A, 0xFF, 0x08, 0x20, 0x2C, 0x01, 0x00, 0x34, 0x12, 0x00,
+    0x17, 0x80, 0x00, 0x00, 0x00, 0x80, 0x00, 0x00, 0x00, 0x09, 0x09, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x8B, 0x46, 0x13, 0x00, 0x18, 0x00, 0x00, 0x00, 0x3A, 0x16, 0xC9, 0x6E, 0x0D, 0x4F, 0x5C, 0x51
+};
+
+// Same controller turning right: gyro (40, -800, 12), accel (-160, 8190, 310), timestamp 0x00123C00.
+static const uint8_t DUALSENSE_USB_TURN_RIGHT[64] = {
+    0x01, 0x80, 0x7F, 0x81, 0x80, 0x00, 0x00, 0x2B, 0x08, 0x00, 0x00, 0x00, 0x9C, 0x3F, 0x11, 0x05,
+    0x28, 0x00, 0xE0, 0xFC, 0x0C, 0x00, 0x60, 0xFF, 0xFE, 0x1F, 0x36, 0x01, 0x00, 0x3C, 0x12, 0x00,
+    0x17, 0x80, 0x00, 0x00, 0x00, 0x80, 0x00, 0x00, 0x00, 0x09, 0x09, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x8B, 0x46, 0x13, 0x00, 0x18, 0x00, 0x00, 0x00, 0x3A, 0x16, 0xC9, 0x6E, 0x0D, 0x4F, 0x5C, 0x51
+};
+
+// DualSense Bluetooth input report 0x31 (first 40 bytes): one extra header byte before the USB layout.
+// Gyro (-500, 250, 0), accel (0, 8192, 0).
+static const uint8_t DUALSENSE_BT_PITCH[40] = {
+    0x31, 0x10, 0x80, 0x80, 0x80, 0x80, 0x00, 0x00, 0x05, 0x08, 0x00, 0x00, 0x00, 0x9C, 0x3F, 0x11,
+    0x05, 0x0C, 0xFE, 0xFA, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x20, 0x00, 0x00, 0x00, 0x10, 0x00,
+    0x00, 0x17, 0x80, 0x00, 0x00, 0x00, 0x80, 0x00
+};
+
+static constexpr uint16_t SONY = 0x054C;
+static constexpr uint16_t DUALSENSE = 0x0CE6;
+static constexpr uint16_t DS4_V2 = 0x09CC;
+
+static ControllerState makeDualSenseState(const uint8_t* report, size_t length) {
+    ControllerState state{};
+    state.userId = -1;
+    state.devicePath = L"\\\\?\\HID#VID_054C&PID_0CE6#test";
+    state.productName = L"DualSense Wireless Controller";
+    state.vendorId = SONY;
+    state.productId = DUALSENSE;
+    state.isConnected = true;
+    state.motionPlan = MotionReportPlan::forDevice(SONY, DUALSENSE);
+    extractMotion(state.motionPlan, report, length, state.motion);
+    return state;
+}
+
+TEST(PlanResolvesSonyControllersOnly) {
+    ASSERT_TRUE(MotionReportPlan::forDevice(SONY, DUALSENSE).hasMotion());
+    ASSERT_TRUE(MotionReportPlan::forDevice(SONY, DS4_V2).hasMotion());
+    ASSERT_FALSE(MotionReportPlan::forDevice(0x045E, 0x028E).hasMotion()); // Xbox 360
+    ASSERT_FALSE(MotionReportPlan::forDevice(SONY, 0x0268).hasMotion());   // DualShock 3
+}
+
+TEST(ExtractDualSenseUsb) {
+    MotionReportPlan plan = MotionReportPlan::forDevice(SONY, DUALSENSE);
+    MotionState motion{};
+    ASSERT_TRUE(extractMotion(plan, DUALSENSE_USB_REST, sizeof(DUALSENSE_USB_REST), motion));
+    ASSERT_TRUE(motion.valid);
+    ASSERT_EQ(motion.gyro[0], 2);
+    ASSERT_EQ(motion.gyro[1], -3);
+    ASSERT_EQ(motion.gyro[2], 1);
+    ASSERT_EQ(motion.accel[0], -150);
+    ASSERT_EQ(motion.accel[1], 8200);
+    ASSERT_EQ(motion.accel[2], 300);
+    // 0x00123400 in 0.33 us units -> DS4 5.33 us units
+    ASSERT_EQ(motion.sensorTimestamp, static_cast<uint16_t>(0x00123400 >> 4));
+}
+
+TEST(ExtractDualSenseBluetooth) {
+    MotionReportPlan plan = MotionReportPlan::forDevice(SONY, DUALSENSE);
+    MotionState motion{};
+    ASSERT_TRUE(extractMotion(plan, DUALSENSE_BT_PITCH, sizeof(DUALSENSE_BT_PITCH), motion));
+    ASSERT_EQ(motion.gyro[0], -500);
+    ASSERT_EQ(motion.gyro[1], 250);
+    ASSERT_EQ(motion.accel[1], 8192);
+}
+
+TEST(ShortOrUnknownReportsCarryNoMotion) {
+    MotionReportPlan plan = MotionReportPlan::forDevice(SONY, DUALSENSE);
+    MotionState motion{};
+    motion.valid = true;
+    // Truncated report
+    ASSERT_FALSE(extractMotion(plan, DUALSENSE_USB_REST, 20, motion));
+    ASSERT_FALSE(motion.valid);
+    // Unknown report ID
+    uint8_t other[64] = {0x05};
+    ASSERT_FALSE(extractMotion(plan, other, sizeof(other), motion));
+    // Device without a plan
+    ASSERT_FALSE(extractMotion(MotionReportPlan{}, DUALSENSE_USB_REST, sizeof(DUALSENSE_USB_REST), motion));
+}
+
+TEST(MotionPassesThroughToDInput) {
+    TranslationLayer layer;
+    std::vector<ControllerState> inputs = {makeDualSenseState(DUALSENSE_USB_TURN_RIGHT, 64)};
+    auto results = layer.translate(inputs);
+    ASSERT_EQ(results.size(), 1u);
+    ASSERT_TRUE(results[0].motion.valid);
+    ASSERT_EQ(results[0].motion.gyro[1], -800);
+
+    auto dinput = layer.translateToDInput(results[0]);
+    ASSERT_TRUE(dinput.motion.valid);
+    ASSERT_EQ(dinput.motion.gyro[0], 40);
+    ASSERT_EQ(dinput.motion.accel[1], 8190);
+
+    layer.setMotionPassthroughEnabled(false);
+    results = layer.translate(inputs);
+    ASSERT_FALSE(results[0].motion.valid);
+}
+
+TEST(GyroDisabledLeavesStickAlone) {
+    TranslationLayer layer;
+    std::vector<ControllerState> inputs = {makeDualSenseState(DUALSENSE_USB_TURN_RIGHT, 64)};
+    auto results = layer.translate(inputs);
+    ASSERT_EQ(results[0].gamepad.sThumbRX, 0);
+    ASSERT_EQ(results[0].gamepad.sThumbRY, 0);
+}
+
+TEST(GyroTurnMovesRightStick) {
+    TranslationLayer layer;
+    layer.setGyroToStickEnabled(true);
+    layer.setGyroSensitivity(8.0f);
+    layer.setGyroSmoothing(0.0f);
+    layer.setGyroDeadzone(16);
+
+    std::vector<ControllerState> inputs = {makeDualSenseState(DUALSENSE_USB_TURN_RIGHT, 64)};
+    auto results = layer.translate(inputs);
+    // Yaw -800 (turning right) -> +784 after deadzone -> * 8
+    ASSERT_EQ(results[0].gamepad.sThumbRX, 784 * 8);
+    // Pitch 40 -> 24 after deadzone -> * 8
+    ASSERT_EQ(results[0].gamepad.sThumbRY, 24 * 8);
+}
+
+TEST(GyroDeadzoneFiltersRestNoise) {
+    TranslationLayer layer;
+    layer.setGyroToStickEnabled(true);
+    layer.setGyroSmoothing(0.0f);
+    layer.setGyroDeadzone(16);
+
+    std::vector<ControllerState> inputs = {makeDualSenseState(DUALSENSE_USB_REST, 64)};
+    auto results = layer.translate(inputs);
+    ASSERT_EQ(results[0].gamepad.sThumbRX, 0);
+    ASSERT_EQ(results[0].gamepad.sThumbRY, 0);
+}
+
+TEST(GyroSmoothingConverges) {
+    TranslationLayer layer;
+    layer.setGyroToStickEnabled(true);
+    layer.setGyroSensitivity(8.0f);
+    layer.setGyroSmoothing(0.5f);
+    layer.setGyroDeadzone(16);
+
+    std::vector<ControllerState> inputs = {makeDualSenseState(DUALSENSE_USB_TURN_RIGHT, 64)};
+    SHORT previous = 0;
+    SHORT first = 0;
+    for (int i = 0; i < 20; ++i) {
+        auto results = layer.translate(inputs);
+        SHORT rx = results[0].gamepad.sThumbRX;
+        if (i == 0) first = rx;
+        ASSERT_TRUE(rx >= previous);
+        previous = rx;
+    }
+    // First sample is damped, steady state reaches the unsmoothed value
+    ASSERT_TRUE(first < 784 * 8);
+    ASSERT_TRUE(std::abs(previous - 784 * 8) <= 8);
+}
+
+TEST(GyroRatchetDisengages) {
+    TranslationLayer layer;
+    layer.setGyroToStickEnabled(true);
+    layer.setGyroSmoothing(0.0f);
+    layer.setGyroRatchetButtons(XINPUT_GAMEPAD_A);
+
+    ControllerState state = makeDualSenseState(DUALSENSE_USB_TURN_RIGHT, 64);
+    // The test product name has no profile, so button usage 1 maps to A
+    state.m_activeButtons.push_back(1);
+    std::vector<ControllerState> inputs = {state};
+    auto results = layer.translate(inputs);
+    ASSERT_TRUE(results[0].gamepad.wButtons & XINPUT_GAMEPAD_A);
+    ASSERT_EQ(results[0].gamepad.sThumbRX, 0);
+
+    inputs[0].m_activeButtons.clear();
+    results = layer.translate(inputs);
+    ASSERT_TRUE(results[0].gamepad.sThumbRX > 0);
+}
+
+TEST(GyroSaturatesStick) {
+    GyroStickMapper mapper;
+    mapper.setSensitivity(64.0f);
+    mapper.setSmoothing(0.0f);
+    MotionState motion{};
+    motion.valid = true;
+    motion.gyro[1] = -32768;
+    GyroFilterState filter{};
+    int16_t x = 30000, y = 0;
+    mapper.apply(motion, 0, filter, x, y);
+    ASSERT_EQ(x, 32767);
+}
+
+int main() {
+    std::cout << "=== Motion Tests ===\n\n";
+
+    RUN_TEST(PlanResolvesSonyControllersOnly);
+    RUN_TEST(ExtractDualSenseUsb);
+    RUN_TEST(ExtractDualSenseBluetooth);
+    RUN_TEST(ShortOrUnknownReportsCarryNoMotion);
+    RUN_TEST(MotionPassesThroughToDInput);
+    RUN_TEST(GyroDisabledLeavesStickAlone);
+    RUN_TEST(GyroTurnMovesRightStick);
+    RUN_TEST(GyroDeadzoneFiltersRestNoise);
+    RUN_TEST(GyroSmoothingConverges);
+    RUN_TEST(GyroRatchetDisengages);
+    RUN_TEST(GyroSaturatesStick);
+
+    std::cout << "\n=== All tests PASSED ===\n";
+    return 0;
+}
@@ -0,0 +1,217 @@
+/**
+ * @file test_output_shaper.cpp
+ * @brief Tests for per-virtual-device output rate shaping
+ */
+
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <vector>
+#include "../include/core/output_shaper.hpp"
+
+#define TEST(name) void test_##name()
+#define RUN_TEST(name) do { \
+    std::cout << "Running " #name "..."; \
+    test_##name(); \
+    std::cout << " PASSED\n"; \
+} while(0)
+
+#define ASSERT_EQ(a, b) do { \
+    if ((a) != (b)) { \
+        std::cerr << "ASSERT_EQ failed: " << (a) << " != " << (b) << " at line " << __LINE__ << "\n"; \
+        assert(false); \
+    } \
+} while(0)
+
+#define ASSERT_TRUE(x) do { \
+    if (!(x)) { \
+        std::cerr << "ASSERT_TRUE failed at line " << __LINE__ << "\n"; \
+        assert(false); \
+    } \
+} while(0)
+
+static TranslatedState makeState(int userId, TranslatedState::TargetType type = TranslatedState::TARGET_XINPUT) {
+    TranslatedState state{};
+    state.sourceUserId = userId;
+    state.targetType = type;
+    return state;
+}
+
+/**
+ * Fake virtual device: records what reached the driver and when, the way the
+ * emulator submits (offers from the capture loop, flushes from the inject thread).
+ */
+struct FakeTarget {
+    std::vector<std::pair<uint64_t, TranslatedState>> received;
+
+    void frame(OutputShaper& shaper, const TranslatedState& state, uint64_t nowUs) {
+        for (const auto& due : shaper.takeDue(nowUs)) received.push_back({nowUs, due});
+        if (shaper.offer(state, nowUs) == OutputShaper::Decision::SUBMIT) {
+            received.push_back({nowUs, state});
+        }
+    }
+};
+
+TEST(UnchangedReportsAreDropped) {
+    OutputShaper shaper;
+    shaper.setMaxRateHz(0);
+    TranslatedState state = makeState(0);
+
+    ASSERT_TRUE(shaper.offer(state, 0) == OutputShaper::Decision::SUBMIT);
+    for (uint64_t t = 1000; t <= 100000; t += 1000) {
+        ASSERT_TRUE(shaper.offer(state, t) == OutputShaper::Decision::UNCHANGED);
+    }
+
+    // Without a cap every change still goes straight through
+    state.gamepad.sThumbLX = 100;
+    ASSERT_TRUE(shaper.offer(state, 100500) == OutputShaper::Decision::SUBMIT);
+
+    OutputShaper::Metrics metrics = shaper.getMetrics(TranslatedState::TARGET_XINPUT, 0);
+    ASSERT_EQ(metrics.offered, 102u);
+    ASSERT_EQ(metrics.submitted, 2u);
+    ASSERT_EQ(metrics.unchanged, 100u);
+    ASSERT_EQ(shaper.nextDeadlineUs(), UINT64_MAX);
+}
+
+TEST(AnalogMotionCoalescedToCap) {
+    OutputShaper shaper;
+    shaper.setMaxRateHz(125);
+    FakeTarget target;
+
+    // 1 kHz stick sweep for one second
+    TranslatedState state = makeState(0);
+    for (uint64_t t = 0; t < 1000000; t += 1000) {
+        state.gamepad.sThumbLX = static_cast<SHORT>(std::sin(t * 1e-5) * 30000.0);
+        state.gamepad.sThumbRY = static_cast<SHORT>(t / 100);
+        target.frame(shaper, state, t);
+    }
+
+    ASSERT_TRUE(target.received.size() >= 124 && target.received.size() <= 126);
+    for (size_t i = 1; i < target.received.size(); ++i) {
+        ASSERT_TRUE(target.received[i].first - target.received[i - 1].first >= 8000);
+    }
+
+    OutputShaper::Metrics metrics = shaper.getMetrics(TranslatedState::TARGET_XINPUT, 0);
+    ASSERT_EQ(metrics.submitted, target.received.size());
+    ASSERT_EQ(metrics.edges, 0u);
+    ASSERT_EQ(metrics.offered, 1000u);
+
+    // Input stops: the held final position still reaches the device at its deadline
+    uint64_t deadline = shaper.nextDeadlineUs();
+    ASSERT_TRUE(deadline != UINT64_MAX && deadline <= 1000000 + 8000);
+    ASSERT_TRUE(shaper.takeDue(deadline - 1).empty());
+    std::vector<TranslatedState> flushed = shaper.takeDue(deadline);
+    ASSERT_EQ(flushed.size(), 1u);
+    ASSERT_EQ(flushed[0].gamepad.sThumbLX, state.gamepad.sThumbLX);
+    ASSERT_EQ(flushed[0].gamepad.sThumbRY, state.gamepad.sThumbRY);
+
+    metrics = shaper.getMetrics(TranslatedState::TARGET_XINPUT, 0);
+    ASSERT_EQ(metrics.submitted + metrics.coalesced, metrics.offered);
+    ASSERT_EQ(shaper.nextDeadlineUs(), UINT64_MAX);
+}
+
+TEST(ButtonEdgesAreNeverDelayed) {
+    OutputShaper shaper;
+    shaper.setMaxRateHz(60);
+    FakeTarget target;
+
+    // Sticks moving every frame, A pressed and released on an unrelated schedule
+    TranslatedState state = makeState(1);
+    target.frame(shaper, state, 0);
+    std::vector<uint64_t> edgeTimes;
+    for (uint64_t t = 1000; t < 500000; t += 1000) {
+        state.gamepad.sThumbLY = static_cast<SHORT>((t / 1000) * 37 % 20000);
+        WORD buttons = ((t / 7000) % 3 == 0) ? XINPUT_GAMEPAD_A : 0;
+        if (buttons != state.gamepad.wButtons) edgeTimes.push_back(t);
+        state.gamepad.wButtons = buttons;
+        target.frame(shaper, state, t);
+    }
+    ASSERT_TRUE(edgeTimes.size() > 40);
+
+    // Every press and release reached the device on the frame it happened
+    size_t found = 0;
+    for (uint64_t edge : edgeTimes) {
+        for (const auto& entry : target.received) {
+            if (entry.first == edge) {
+                found++;
+                break;
+            }
+        }
+    }
+    ASSERT_EQ(found, edgeTimes.size());
+
+    OutputShaper::Metrics metrics = shaper.getMetrics(TranslatedState::TARGET_XINPUT, 1);
+    ASSERT_EQ(metrics.edges, edgeTimes.size());
+    ASSERT_TRUE(metrics.coalesced > metrics.submitted);
+}
+
+TEST(TriggerThresholdIsAnEdge) {
+    TranslatedState a = makeState(0);
+    TranslatedState b = a;
+    b.gamepad.bLeftTrigger = 20;
+    ASSERT_TRUE(!OutputShaper::hasDigitalEdge(a, b));   // Below threshold: analog travel
+    b.gamepad.bLeftTrigger = 200;
+    ASSERT_TRUE(OutputShaper::hasDigitalEdge(a, b));
+    a.gamepad.bLeftTrigger = 150;
+    ASSERT_TRUE(!OutputShaper::hasDigitalEdge(a, b));   // Still pressed
+
+    // Motion samples count as analog changes
+    TranslatedState m1 = makeState(0, TranslatedState::TARGET_DINPUT);
+    m1.motion.valid = true;
+    TranslatedState m2 = m1;
+    ASSERT_TRUE(OutputShaper::sameReport(m1, m2));
+    m2.motion.gyro[1] = 42;
+    ASSERT_TRUE(!OutputShaper::sameReport(m1, m2));
+    ASSERT_TRUE(!OutputShaper::hasDigitalEdge(m1, m2));
+}
+
+TEST(DevicesHaveIndependentDeadlines) {
+    OutputShaper shaper;
+    shaper.setMaxRateHz(100);
+
+    TranslatedState pad0 = makeState(0);
+    TranslatedState pad1 = makeState(1);
+    TranslatedState ds4 = makeState(0, TranslatedState::TARGET_DINPUT);
+    ASSERT_TRUE(shaper.offer(pad0, 0) == OutputShaper::Decision::SUBMIT);
+    ASSERT_TRUE(shaper.offer(pad1, 5000) == OutputShaper::Decision::SUBMIT);
+    ASSERT_TRUE(shaper.offer(ds4, 5000) == OutputShaper::Decision::SUBMIT); // Same userId, other target
+
+    pad0.gamepad.sThumbLX = 1;
+    pad1.gamepad.sThumbLX = 1;
+    ASSERT_TRUE(shaper.offer(pad0, 6000) == OutputShaper::Decision::COALESCE);
+    ASSERT_TRUE(shaper.offer(pad1, 6000) == OutputShaper::Decision::COALESCE);
+    ASSERT_EQ(shaper.nextDeadlineUs(), 10000u);
+
+    std::vector<TranslatedState> due = shaper.takeDue(10000);
+    ASSERT_EQ(due.size(), 1u);
+    ASSERT_EQ(due[0].sourceUserId, 0);
+    ASSERT_EQ(shaper.nextDeadlineUs(), 15000u);
+    due = shaper.takeDue(15000);
+    ASSERT_EQ(due.size(), 1u);
+    ASSERT_EQ(due[0].sourceUserId, 1);
+
+    // Moving back to the submitted position cancels the held report
+    pad0.gamepad.sThumbLX = 2;
+    ASSERT_TRUE(shaper.offer(pad0, 16000) == OutputShaper::Decision::COALESCE);
+    pad0.gamepad.sThumbLX = 1;
+    ASSERT_TRUE(shaper.offer(pad0, 17000) == OutputShaper::Decision::UNCHANGED);
+    ASSERT_TRUE(shaper.takeDue(30000).empty());
+
+    // A forgotten device (failed submit, destroyed target) is resent on its next offer
+    shaper.forget(TranslatedState::TARGET_XINPUT, 0);
+    ASSERT_TRUE(shaper.offer(pad0, 30001) == OutputShaper::Decision::SUBMIT);
+    ASSERT_EQ(shaper.getMetrics(TranslatedState::TARGET_XINPUT, 0).flushed, 1u);
+}
+
+int main() {
+    std::cout << "=== Output Shaper Tests ===\n\n";
+
+    RUN_TEST(UnchangedReportsAreDropped);
+    RUN_TEST(AnalogMotionCoalescedToCap);
+    RUN_TEST(ButtonEdgesAreNeverDelayed);
+    RUN_TEST(TriggerThresholdIsAnEdge);
+    RUN_TEST(DevicesHaveIndependentDeadlines);
+
+    std::cout << "\n=== All tests PASSED ===\n";
+    return 0;
+}
@@ -0,0 +1,227 @@
+/**
+ * @file test_parallel_translate.cpp
+ * @brief Tests for the work-stealing pool and parallel translation
+ */
+
+#include <atomic>
+#include <cassert>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <vector>
+#include "../include/core/translation_layer.hpp"
+#include "../include/utils/work_stealing_pool.hpp"
+
+#define TEST(name) void test_##name()
+#define RUN_TEST(name) do { \
+    std::cout << "Running " #name "..."; \
+    test_##name(); \
+    std::cout << " PASSED\n"; \
+} while(0)
+
+#define ASSERT_EQ(a, b) do { \
+    if ((a) != (b)) { \
+        std::cerr << "ASSERT_EQ failed: " << (a) << " != " << (b) << " at line " << __LINE__ << "\n"; \
+        assert(false); \
+    } \
+} while(0)
+
+#define ASSERT_TRUE(x) do { \
+    if (!(x)) { \
+        std::cerr << "ASSERT_TRUE failed at line " << __LINE__ << "\n"; \
+        assert(false); \
+    } \
+} while(0)
+
+// Deterministic LCG so failures reproduce
+static uint32_t nextRandom(uint32_t& seed) {
+    seed = seed * 1664525u + 1013904223u;
+    return seed >> 8;
+}
+
+// Even slots XInput, odd slots generic 10-bit HID
+static std::vector<ControllerState> makeControllers(size_t count, uint32_t seed) {
+    std::vector<ControllerState> states(count);
+    for (size_t i = 0; i < count; ++i) {
+        ControllerState& state = states[i];
+        state.isConnected = true;
+        if (i % 2 == 0) {
+            state.userId = static_cast<int>(i);
+            state.xinputState.dwPacketNumber = 1;
+            state.xinputState.Gamepad.wButtons = static_cast<WORD>(nextRandom(seed) & 0xF30F);
+            state.xinputState.Gamepad.sThumbLX = static_cast<SHORT>(nextRandom(seed));
+            state.xinputState.Gamepad.sThumbLY = static_cast<SHORT>(nextRandom(seed));
+            state.xinputState.Gamepad.sThumbRX = static_cast<SHORT>(nextRandom(seed));
+            state.xinputState.Gamepad.sThumbRY = static_cast<SHORT>(nextRandom(seed));
+            state.xinputState.Gamepad.bLeftTrigger = static_cast<BYTE>(nextRandom(seed));
+        } else {
+            state.userId = -1;
+            state.devicePath = L"\\\\?\\hid#vid_1234&pid_5678#" + std::to_wstring(i);
+            state.productName = L"Generic USB Joystick";
+            state.m_activeButtons = {1, static_cast<USAGE>(1 + nextRandom(seed) % 10)};
+            const USAGE usages[] = {0x30, 0x31, 0x32, 0x35};
+            for (USAGE usage : usages) {
+                HIDP_VALUE_CAPS cap{};
+                cap.UsagePage = 0x01;
+                cap.Range.UsageMin = usage;
+                cap.LogicalMin = 0;
+                cap.LogicalMax = 1023;
+                state.valueCaps.push_back(cap);
+                state.m_hidValues[usage] = static_cast<LONG>(nextRandom(seed) % 1024);
+            }
+        }
+    }
+    return states;
+}
+
+static void configure(TranslationLayer& layer) {
+    layer.setStickDeadzoneEnabled(true);
+    layer.setLeftStickDeadzone(0.2f);
+    layer.setRightStickAntiDeadzone(0.1f);
+    layer.setSOCDCleaningEnabled(true);
+    layer.setDebouncingEnabled(true);
+}
+
+static bool sameStates(const std::vector<TranslatedState>& a, const std::vector<TranslatedState>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a[i].sourceUserId != b[i].sourceUserId || a[i].sourceSlot != b[i].sourceSlot ||
+            a[i].targetType != b[i].targetType ||
+            std::memcmp(&a[i].gamepad, &b[i].gamepad, sizeof(a[i].gamepad)) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+TEST(PoolRunsEveryTaskOnce) {
+    WorkStealingPool pool(3);
+    ASSERT_EQ(pool.getWorkerCount(), 3u);
+    for (size_t tasks : {0u, 1u, 2u, 7u, 64u, 1000u}) {
+        std::vector<std::atomic<int>> runs(tasks);
+        for (int round = 0; round < 20; ++round) {
+            pool.parallelFor(tasks, [&](size_t i) { runs[i]++; });
+        }
+        for (size_t i = 0; i < tasks; ++i) ASSERT_EQ(runs[i].load(), 20);
+    }
+
+    // Without workers everything runs on the caller
+    WorkStealingPool serial(0);
+    std::thread::id caller = std::this_thread::get_id();
+    bool onCaller = true;
+    serial.parallelFor(10, [&](size_t) { onCaller = onCaller && std::this_thread::get_id() == caller; });
+    ASSERT_TRUE(onCaller);
+}
+
+TEST(PoolStealsFromABlockedParticipant) {
+    // Task 0 (the caller's first) blocks until every other task ran, so the
+    // caller's remaining tasks can only finish by being stolen
+    WorkStealingPool pool(2);
+    const size_t tasks = 30;
+    std::atomic<size_t> done(0);
+    pool.parallelFor(tasks, [&](size_t i) {
+        if (i == 0) {
+            while (done != tasks - 1) std::this_thread::yield();
+        }
+        done++;
+    });
+    ASSERT_EQ(done.load(), tasks);
+    ASSERT_TRUE(pool.getStolenCount() > 0);
+}
+
+TEST(ParallelMatchesSerial) {
+    for (size_t count : {16u, 33u, 64u, 256u}) {
+        TranslationLayer serial;
+        TranslationLayer parallel;
+        configure(serial);
+        configure(parallel);
+        parallel.setParallelTranslation(3, 16);
+
+        // Several frames so debounce state carries over between calls
+        uint32_t seed = static_cast<uint32_t>(count);
+        for (int frame = 0; frame < 5; ++frame) {
+            std::vector<ControllerState> inputs = makeControllers(count, seed++);
+            std::vector<TranslatedState> expected = serial.translate(inputs);
+            std::vector<TranslatedState> actual = parallel.translate(inputs);
+            ASSERT_TRUE(parallel.wasLastTranslateParallel());
+            ASSERT_TRUE(!serial.wasLastTranslateParallel());
+            ASSERT_TRUE(sameStates(expected, actual));
+        }
+    }
+}
+
+TEST(SmallOrSharedFramesStaySerial) {
+    TranslationLayer layer;
+    configure(layer);
+    layer.setParallelTranslation(2, 32);
+
+    // Below the threshold
+    layer.translate(makeControllers(31, 1));
+    ASSERT_TRUE(!layer.wasLastTranslateParallel());
+    layer.translate(makeControllers(32, 1));
+    ASSERT_TRUE(layer.wasLastTranslateParallel());
+
+    // Two slots with one userId share debounce state, so the frame runs serially
+    std::vector<ControllerState> inputs = makeControllers(40, 2);
+    inputs[10].userId = 4;
+    inputs[10].xinputState.dwPacketNumber = 1;
+    layer.translate(inputs);
+    ASSERT_TRUE(!layer.wasLastTranslateParallel());
+
+    // Turning the pool off
+    layer.setParallelTranslation(0, 32);
+    ASSERT_EQ(layer.getParallelWorkers(), 0u);
+    layer.translate(makeControllers(64, 3));
+    ASSERT_TRUE(!layer.wasLastTranslateParallel());
+}
+
+TEST(SplitDevicesRunInParallel) {
+    // Two split devices; their slots are bound before the chunks run
+    std::vector<SplitDeviceConfig> split(2);
+    split[0].sourceMatch = L"Encoder A";
+    split[1].sourceMatch = L"Encoder B";
+    for (auto& device : split) {
+        SplitOutputConfig p1{"P1", {{1, XINPUT_GAMEPAD_A}}, {{0x30, SplitField::LX}}};
+        SplitOutputConfig p2{"P2", {{2, XINPUT_GAMEPAD_A}}, {{0x31, SplitField::LX}}};
+        device.outputs = {p1, p2};
+    }
+    TranslationLayer serial;
+    TranslationLayer parallel;
+    configure(serial);
+    configure(parallel);
+    serial.setSplitConfiguration(split);
+    parallel.setSplitConfiguration(split);
+    parallel.setParallelTranslation(3, 16);
+
+    uint32_t seed = 7;
+    for (int frame = 0; frame < 3; ++frame) {
+        std::vector<ControllerState> inputs = makeControllers(48, seed++);
+        inputs[5].productName = L"Encoder A";
+        inputs[29].productName = L"Encoder B";
+        std::vector<TranslatedState> expected = serial.translate(inputs);
+        std::vector<TranslatedState> actual = parallel.translate(inputs);
+        ASSERT_TRUE(parallel.wasLastTranslateParallel());
+        ASSERT_TRUE(sameStates(expected, actual));
+    }
+
+    // A second Encoder A replacing Encoder B: two slots now share one split device's output state
+    std::vector<ControllerState> inputs = makeControllers(48, seed);
+    inputs[5].productName = L"Encoder A";
+    inputs[29].productName = L"Encoder A";
+    inputs[29].devicePath = L"\\\\?\\hid#vid_1234&pid_5678#second_a";
+    parallel.translate(inputs);
+    ASSERT_TRUE(!parallel.wasLastTranslateParallel());
+}
+
+int main() {
+    std::cout << "=== Parallel Translation Tests ===\n\n";
+
+    RUN_TEST(PoolRunsEveryTaskOnce);
+    RUN_TEST(PoolStealsFromABlockedParticipant);
+    RUN_TEST(ParallelMatchesSerial);
+    RUN_TEST(SmallOrSharedFramesStaySerial);
+    RUN_TEST(SplitDevicesRunInParallel);
+
+    std::cout << "\n=== All tests PASSED ===\n";
+    return 0;
+}
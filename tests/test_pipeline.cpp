@@ -0,0 +1,363 @@
+/**
+ * @file test_pipeline.cpp
+ * @brief Tests for pipeline instances, instance log sinks and the shard supervisor
+ */
+
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "../include/core/pipeline.hpp"
+#include "../include/core/latency_rig.hpp"
+#include "../include/core/synthetic_source.hpp"
+#include "../include/utils/threading.hpp"
+
+#define TEST(name) void test_##name()
+#define RUN_TEST(name) do { \
+    std::cout << "Running " #name "..."; \
+    test_##name(); \
+    std::cout << " PASSED\n"; \
+} while(0)
+
+#define ASSERT_EQ(a, b) do { \
+    if ((a) != (b)) { \
+        std::cerr << "ASSERT_EQ failed: " << (a) << " != " << (b) << " at line " << __LINE__ << "\n"; \
+        assert(false); \
+    } \
+} while(0)
+
+#define ASSERT_TRUE(x) do { \
+    if (!(x)) { \
+        std::cerr << "ASSERT_TRUE failed at line " << __LINE__ << "\n"; \
+        assert(false); \
+    } \
+} while(0)
+
+// Connected XInput controllers with fixed buttons and stick
+class FixedSource : public InputSource {
+public:
+    FixedSource(size_t controllers, WORD buttons, SHORT thumbLX) : m_states(controllers) {
+        for (size_t i = 0; i < controllers; ++i) {
+            m_states[i].userId = static_cast<int>(i);
+            m_states[i].isConnected = true;
+            m_states[i].xinputState.dwPacketNumber = 1;
+            m_states[i].xinputState.Gamepad.wButtons = buttons;
+            m_states[i].xinputState.Gamepad.sThumbLX = thumbLX;
+        }
+    }
+
+    void update(double deltaTime) override { (void)deltaTime; updates++; }
+    std::vector<ControllerState> getInputStates() const override { return m_states; }
+
+    int updates = 0;
+
+private:
+    std::vector<ControllerState> m_states;
+};
+
+// Remembers the newest report per target
+class RecordingBus : public VirtualBus {
+public:
+    bool submit(int targetId, const TranslatedState& state) override {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_latest[targetId] = state;
+        m_submits++;
+        return true;
+    }
+    bool replug(int targetId) override { (void)targetId; return true; }
+
+    std::map<int, TranslatedState> latest() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_latest;
+    }
+    size_t submits() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_submits;
+    }
+
+private:
+    mutable std::mutex m_mutex;
+    std::map<int, TranslatedState> m_latest;
+    size_t m_submits = 0;
+};
+
+TEST(LogScopeRoutesToSink) {
+    LogSink sink("[test] ");
+    Logger::log("before scope");
+    {
+        Logger::Scope scope(sink);
+        ASSERT_TRUE(Logger::currentSink() == &sink);
+        Logger::log("inside");
+        Logger::error("broken");
+
+        // Other threads keep logging to the process log
+        std::thread other([]() { ASSERT_TRUE(Logger::currentSink() == nullptr); });
+        other.join();
+    }
+    ASSERT_TRUE(Logger::currentSink() == nullptr);
+    Logger::log("after scope");
+
+    std::vector<std::string> lines = sink.getLogs();
+    ASSERT_EQ(lines.size(), 2u);
+    ASSERT_EQ(lines[0], std::string("inside"));
+    ASSERT_EQ(lines[1], std::string("ERROR: broken"));
+
+    // Nothing reaches the process log until the owner flushes, then tagged with the prefix
+    for (const auto& line : Logger::getLogs()) {
+        ASSERT_TRUE(line != "[test] inside");
+    }
+    ASSERT_EQ(sink.flush(), 2u);
+    ASSERT_EQ(sink.flush(), 0u);
+    bool tagged = false;
+    for (const auto& line : Logger::getLogs()) {
+        if (line == "[test] inside") tagged = true;
+    }
+    ASSERT_TRUE(tagged);
+}
+
+TEST(LogSinkKeepsTheNewestLines) {
+    LogSink sink("[ring] ", 3);
+    for (int i = 0; i < 5; ++i) {
+        sink.log("line " + std::to_string(i));
+    }
+    std::vector<std::string> lines = sink.getLogs();
+    ASSERT_EQ(lines.size(), 3u);
+    ASSERT_EQ(lines.front(), std::string("line 2"));
+    ASSERT_EQ(lines.back(), std::string("line 4"));
+    ASSERT_EQ(sink.getDropped(), 2u);
+
+    // Flushed lines are evicted without counting as dropped
+    ASSERT_EQ(sink.flush(), 3u);
+    sink.log("line 5");
+    ASSERT_EQ(sink.getDropped(), 2u);
+    ASSERT_EQ(sink.flush(), 1u);
+}
+
+TEST(PlanIsBalancedAndContiguous) {
+    std::vector<PipelineSupervisor::Shard> shards = PipelineSupervisor::plan(10, 4, 2, 1);
+    ASSERT_EQ(shards.size(), 4u);
+    size_t next = 0;
+    for (size_t i = 0; i < shards.size(); ++i) {
+        ASSERT_EQ(shards[i].first, next);
+        ASSERT_TRUE(shards[i].count == 2 || shards[i].count == 3);
+        next += shards[i].count;
+    }
+    ASSERT_EQ(next, 10u);
+    ASSERT_EQ(shards[0].core, 1);
+    ASSERT_EQ(shards[1].core, 0);
+
+    // More shards than controllers collapses to one controller per shard
+    ASSERT_EQ(PipelineSupervisor::plan(3, 8, 8).size(), 3u);
+    ASSERT_EQ(PipelineSupervisor::plan(0, 4, 4).size(), 0u);
+}
+
+TEST(PipelinesUseTheirOwnConfig) {
+    // DPad left+right held: shard 0 cleans SOCD to neutral, shard 1 turns it off
+    ConfigManager base;
+    base.setBool("socd_enabled", true);
+    base.setInt("socd_method", 2);
+    base.setBool("shard1.socd_enabled", false);
+    base.setBool("stick_deadzone_enabled", true);
+    base.setFloat("shard1.left_stick_deadzone", 0.5f);
+
+    const WORD held = XINPUT_GAMEPAD_DPAD_LEFT | XINPUT_GAMEPAD_DPAD_RIGHT | XINPUT_GAMEPAD_A;
+    std::vector<PipelineSupervisor::Shard> shards = PipelineSupervisor::plan(4, 2, 1);
+    std::vector<RecordingBus*> buses;
+    PipelineSupervisor supervisor(base, shards, [&](size_t, const PipelineSupervisor::Shard& shard) {
+        PipelineSupervisor::Endpoints endpoints;
+        endpoints.source = std::make_unique<FixedSource>(shard.count, held, 10000);
+        auto bus = std::make_unique<RecordingBus>();
+        buses.push_back(bus.get());
+        endpoints.bus = std::move(bus);
+        return endpoints;
+    });
+    ASSERT_EQ(supervisor.size(), 2u);
+    ASSERT_TRUE(supervisor.pipeline(0).getConfig().getBool("socd_enabled"));
+    ASSERT_TRUE(!supervisor.pipeline(1).getConfig().getBool("socd_enabled"));
+
+    supervisor.pipeline(0).runFrame(1000);
+    supervisor.pipeline(1).runFrame(1000);
+
+    std::map<int, TranslatedState> cleaned = buses[0]->latest();
+    std::map<int, TranslatedState> raw = buses[1]->latest();
+    ASSERT_EQ(cleaned.size(), 2u);
+    ASSERT_EQ(raw.size(), 2u);
+    for (const auto& [id, state] : cleaned) {
+        ASSERT_EQ(state.gamepad.wButtons & (XINPUT_GAMEPAD_DPAD_LEFT | XINPUT_GAMEPAD_DPAD_RIGHT), 0);
+        ASSERT_TRUE(state.gamepad.sThumbLX > 0);            // 0.31 deflection clears the 0.15 deadzone
+    }
+    for (const auto& [id, state] : raw) {
+        ASSERT_EQ(state.gamepad.wButtons, held);
+        ASSERT_EQ(state.gamepad.sThumbLX, 0);               // ...but not shard 1's 0.5
+    }
+
+    Pipeline::Stats stats = supervisor.totalStats();
+    ASSERT_EQ(stats.frames, 2u);
+    ASSERT_EQ(stats.submits, 4u);
+}
+
+TEST(InjectionThreadSubmitsQueuedStates) {
+    auto config = std::make_unique<ConfigManager>();
+    config->setBool("auto_load_profiles", false);
+    config->setBool("inject_thread_enabled", true);
+    auto bus = std::make_unique<RecordingBus>();
+    RecordingBus& recorded = *bus;
+    Pipeline pipeline(0, std::move(config), std::make_unique<FixedSource>(2, XINPUT_GAMEPAD_A, 0), std::move(bus));
+
+    // The loop only queues; nothing reaches the bus until the injection thread runs
+    pipeline.runFrame(1000);
+    ASSERT_EQ(recorded.submits(), 0u);
+    ASSERT_EQ(pipeline.getStats().submits, 0u);
+
+    pipeline.startInjection();
+    for (int i = 0; i < 1000 && recorded.submits() < 2; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    pipeline.stop();
+    ASSERT_EQ(recorded.submits(), 2u);
+    ASSERT_EQ(pipeline.getStats().submits, 2u);
+    ASSERT_EQ(recorded.latest().at(1).gamepad.wButtons, XINPUT_GAMEPAD_A);
+}
+
+// An XInput pad and a HID pad without a user id: a DInput and an XInput target, both of source user -1
+class MixedSource : public InputSource {
+public:
+    MixedSource() : m_states(2) {
+        for (auto& state : m_states) {
+            state.userId = -1;
+            state.isConnected = true;
+        }
+        m_states[0].xinputState.dwPacketNumber = 1;
+        m_states[0].xinputState.Gamepad.wButtons = XINPUT_GAMEPAD_A;
+        m_states[1].devicePath = L"\\\\?\\hid#vid_0000&pid_0000";
+    }
+
+    void update(double deltaTime) override { (void)deltaTime; }
+    std::vector<ControllerState> getInputStates() const override { return m_states; }
+
+private:
+    std::vector<ControllerState> m_states;
+};
+
+// Fails every DInput submit; remembers which target each type went to and counts re-plugs
+class FailDInputBus : public VirtualBus {
+public:
+    bool submit(int targetId, const TranslatedState& state) override {
+        targets[state.targetType] = targetId;
+        return state.targetType != TranslatedState::TARGET_DINPUT;
+    }
+    bool replug(int targetId) override { replugs[targetId]++; return true; }
+
+    std::map<TranslatedState::TargetType, int> targets;
+    std::map<int, int> replugs;
+};
+
+TEST(TargetsAreKeyedByTypeAndUser) {
+    auto config = std::make_unique<ConfigManager>();
+    config->setBool("auto_load_profiles", false);
+    config->setInt("target_failures_to_reconnect", 1);
+    config->setInt("target_reconnect_backoff_ms", 1);
+    auto bus = std::make_unique<FailDInputBus>();
+    FailDInputBus& failing = *bus;
+    Pipeline pipeline(0, std::move(config), std::make_unique<MixedSource>(), std::move(bus));
+
+    for (int frame = 0; frame < 3; ++frame) {
+        pipeline.runFrame(1000 * (frame + 1));
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+
+    // Same user id, separate targets and error budgets: the DInput failures never touch the XInput target
+    int dinput = failing.targets.at(TranslatedState::TARGET_DINPUT);
+    int xinput = failing.targets.at(TranslatedState::TARGET_XINPUT);
+    ASSERT_TRUE(dinput != xinput);
+    TargetHealthMonitor::Metrics xinputHealth = pipeline.getInjector().getTargetHealth(xinput);
+    ASSERT_TRUE(xinputHealth.health == TargetHealthMonitor::Health::HEALTHY);
+    ASSERT_EQ(xinputHealth.submits, 3u);
+    ASSERT_EQ(xinputHealth.failures, 0u);
+    ASSERT_EQ(failing.replugs[xinput], 0);
+    ASSERT_TRUE(pipeline.getInjector().getTargetHealth(dinput).failures > 0);
+}
+
+TEST(FailedSubmitsAreForgottenByTheShaper) {
+    auto config = std::make_unique<ConfigManager>();
+    config->setBool("auto_load_profiles", false);
+    config->setBool("output_shaping_enabled", true);
+    config->setInt("target_failures_to_reconnect", 100);
+    Pipeline pipeline(0, std::move(config), std::make_unique<MixedSource>(), std::make_unique<FailDInputBus>());
+
+    for (int frame = 0; frame < 3; ++frame) {
+        pipeline.runFrame(1000 * (frame + 1));
+    }
+
+    // Unchanged reports are dropped after a delivered submit, but resent after a failed one
+    OutputShaper::Metrics delivered = pipeline.getInjector().getOutputMetrics(TranslatedState::TARGET_XINPUT, -1);
+    ASSERT_EQ(delivered.submitted, 1u);
+    ASSERT_EQ(delivered.unchanged, 2u);
+    OutputShaper::Metrics failed = pipeline.getInjector().getOutputMetrics(TranslatedState::TARGET_DINPUT, -1);
+    ASSERT_EQ(failed.submitted, 3u);
+    ASSERT_EQ(failed.unchanged, 0u);
+}
+
+TEST(ShardedSyntheticRunDeliversEveryEdge) {
+    ConfigManager base;
+    base.setBool("stick_deadzone_enabled", false);   // Keeps the sequence number in the right stick
+    base.setInt("polling_frequency", 1000);
+
+    const uint32_t reportsPerEdge = 8;
+    std::vector<PipelineSupervisor::Shard> shards =
+        PipelineSupervisor::plan(6, 3, ThreadingUtils::getLogicalCoreCount());
+    std::vector<SyntheticInputSource*> sources;
+    std::vector<EdgeProbeBus*> buses;
+    PipelineSupervisor supervisor(base, shards, [&](size_t, const PipelineSupervisor::Shard& shard) {
+        SyntheticInputSource::Config config;
+        config.controllers = shard.count;
+        config.reportRateHz = 500;
+        config.reportsPerEdge = reportsPerEdge;
+        auto source = std::make_unique<SyntheticInputSource>(config);
+        auto bus = std::make_unique<EdgeProbeBus>(shard.count);
+        sources.push_back(source.get());
+        buses.push_back(bus.get());
+        return PipelineSupervisor::Endpoints{std::move(source), std::move(bus)};
+    });
+
+    supervisor.start(true);
+    for (auto* source : sources) source->start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    for (auto* source : sources) source->stop();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));   // Let the last edges through
+    supervisor.stop();
+
+    for (size_t i = 0; i < supervisor.size(); ++i) {
+        LatencyRig::Result result;
+        std::vector<double> latencies;
+        buses[i]->match(sources[i]->getEdges(), reportsPerEdge, result, latencies);
+        ASSERT_TRUE(result.edges > 0);
+        ASSERT_EQ(result.delivered, result.edges);
+        ASSERT_EQ(result.sequenceErrors, 0u);
+        ASSERT_TRUE(supervisor.pipeline(i).getStats().frames > 0);
+
+        // Each pipeline logged into its own sink
+        std::vector<std::string> lines = supervisor.pipeline(i).getLog().getLogs();
+        ASSERT_TRUE(!lines.empty());
+        ASSERT_EQ(lines.front().rfind("Pipeline started", 0), 0u);
+    }
+}
+
+int main() {
+    std::cout << "=== Pipeline Tests ===\n\n";
+
+    RUN_TEST(LogScopeRoutesToSink);
+    RUN_TEST(LogSinkKeepsTheNewestLines);
+    RUN_TEST(PlanIsBalancedAndContiguous);
+    RUN_TEST(PipelinesUseTheirOwnConfig);
+    RUN_TEST(InjectionThreadSubmitsQueuedStates);
+    RUN_TEST(TargetsAreKeyedByTypeAndUser);
+    RUN_TEST(FailedSubmitsAreForgottenByTheShaper);
+    RUN_TEST(ShardedSyntheticRunDeliversEveryEdge);
+
+    std::cout << "\n=== All tests PASSED ===\n";
+    return 0;
+}
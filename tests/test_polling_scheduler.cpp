@@ -0,0 +1,254 @@
+/**
+ * @file test_polling_scheduler.cpp
+ * @brief Tests for per-device polling groups using synthetic devices at mixed rates
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "../include/core/polling_scheduler.hpp"
+
+#define TEST(name) void test_##name()
+#define RUN_TEST(name) do { \
+    std::cout << "Running " #name "..."; \
+    test_##name(); \
+    std::cout << " PASSED\n"; \
+} while(0)
+
+#define ASSERT_EQ(a, b) do { \
+    if ((a) != (b)) { \
+        std::cerr << "ASSERT_EQ failed: " << (a) << " != " << (b) << " at line " << __LINE__ << "\n"; \
+        assert(false); \
+    } \
+} while(0)
+
+#define ASSERT_TRUE(x) do { \
+    if (!(x)) { \
+        std::cerr << "ASSERT_TRUE failed at line " << __LINE__ << "\n"; \
+        assert(false); \
+    } \
+} while(0)
+
+/**
+ * Synthetic device: emits a report every intervalUs. A service picks up the
+ * oldest unread report (like an overlapped HID read), so polling slower than
+ * the report rate shows up as growing pickup delay.
+ */
+struct SyntheticDevice {
+    std::wstring name;
+    uint64_t intervalUs;
+    uint64_t nextReportUs = 0;
+    std::vector<uint64_t> queue{};  // Emission times of unread reports
+    uint64_t maxPickupDelayUs = 0;
+    uint64_t services = 0;
+
+    void advance(uint64_t nowUs) {
+        while (nextReportUs <= nowUs) {
+            queue.push_back(nextReportUs);
+            nextReportUs += intervalUs;
+        }
+    }
+
+    bool service(uint64_t nowUs, bool trackDelay) {
+        services++;
+        if (queue.empty()) return false;
+        if (trackDelay) maxPickupDelayUs = std::max(maxPickupDelayUs, nowUs - queue.front());
+        queue.erase(queue.begin());
+        return true;
+    }
+};
+
+/**
+ * Drive the scheduler like the capture loop: wake at the next deadline,
+ * service due devices, record results.
+ */
+static void run(PollingScheduler& scheduler, std::vector<SyntheticDevice>& devices,
+                uint64_t& nowUs, uint64_t durationUs, bool trackDelay = false) {
+    uint64_t end = nowUs + durationUs;
+    while (nowUs < end) {
+        scheduler.beginFrame(nowUs);
+        for (size_t i = 0; i < devices.size(); ++i) {
+            devices[i].advance(nowUs);
+            if (scheduler.isDue(i)) {
+                bool report = devices[i].service(nowUs, trackDelay);
+                scheduler.recordService(i, report, nowUs);
+            }
+        }
+        uint64_t next = scheduler.nextDeadlineUs();
+        nowUs = std::max(next, nowUs + 1);
+    }
+}
+
+static std::vector<SyntheticDevice> mixedDevices() {
+    return {
+        {L"DualSense Wireless Controller", 1000},  // 1 kHz
+        {L"Xbox Controller", 4000},                // 250 Hz
+        {L"Generic USB Joystick", 8000},           // 125 Hz
+        {L"Flight Pedals", 20000},                 // 50 Hz
+    };
+}
+
+static void attach(PollingScheduler& scheduler, const std::vector<SyntheticDevice>& devices) {
+    for (size_t i = 0; i < devices.size(); ++i) {
+        scheduler.assignDevice(i, devices[i].name, L"HID\\DEV_" + std::to_wstring(i));
+        scheduler.setActive(i, true);
+    }
+}
+
+TEST(ClassHelpers) {
+    PollingScheduler scheduler;
+    scheduler.setBaseRate(1000);
+    ASSERT_EQ(scheduler.classRateHz(0), 1000u);
+    ASSERT_EQ(scheduler.classRateHz(3), 125u);
+    ASSERT_EQ(scheduler.classPeriodUs(2), 4000u);
+
+    // Polled at least twice per report interval
+    ASSERT_EQ(scheduler.classForInterval(1000.0), 0u);
+    ASSERT_EQ(scheduler.classForInterval(4000.0), 1u);
+    ASSERT_EQ(scheduler.classForInterval(8000.0), 2u);
+    ASSERT_EQ(scheduler.classForInterval(20000.0), 3u);
+
+    ASSERT_EQ(scheduler.classForRate(1000), 0u);
+    ASSERT_EQ(scheduler.classForRate(250), 2u);
+    ASSERT_EQ(scheduler.classForRate(300), 1u);
+    ASSERT_EQ(scheduler.classForRate(10), 3u);
+}
+
+TEST(ParseOverrides) {
+    auto overrides = PollingScheduler::parseOverrides("DualSense:1000;Generic USB Joystick:125;bad;:5;x:0;VID_045E:abc");
+    ASSERT_EQ(overrides.size(), 2u);
+    ASSERT_TRUE(overrides[0].match == L"DualSense");
+    ASSERT_EQ(overrides[0].rateHz, 1000u);
+    ASSERT_TRUE(overrides[1].match == L"Generic USB Joystick");
+    ASSERT_EQ(overrides[1].rateHz, 125u);
+}
+
+TEST(MixedRatesConverge) {
+    PollingScheduler scheduler;
+    scheduler.setBaseRate(1000);
+    auto devices = mixedDevices();
+    attach(scheduler, devices);
+
+    uint64_t now = 1;
+    run(scheduler, devices, now, 3000000);
+
+    ASSERT_EQ(scheduler.getTiming(0).rateClass, 0u);  // 1 kHz device at 1000 Hz
+    ASSERT_EQ(scheduler.getTiming(1).rateClass, 1u);  // 250 Hz device at 500 Hz
+    ASSERT_EQ(scheduler.getTiming(2).rateClass, 2u);  // 125 Hz device at 250 Hz
+    ASSERT_EQ(scheduler.getTiming(3).rateClass, 3u);  // 50 Hz device at 125 Hz
+
+    ASSERT_TRUE(std::abs(scheduler.getTiming(1).reportIntervalUs - 4000.0) < 200.0);
+    ASSERT_TRUE(std::abs(scheduler.getTiming(2).reportIntervalUs - 8000.0) < 400.0);
+
+    // Steady state: service counts follow the group rates
+    for (auto& device : devices) device.services = 0;
+    run(scheduler, devices, now, 1000000, true);
+    ASSERT_TRUE(devices[0].services >= 990 && devices[0].services <= 1010);
+    ASSERT_TRUE(devices[1].services >= 495 && devices[1].services <= 505);
+    ASSERT_TRUE(devices[2].services >= 245 && devices[2].services <= 255);
+    ASSERT_TRUE(devices[3].services >= 120 && devices[3].services <= 130);
+
+    // No device falls behind its reports
+    for (const auto& device : devices) {
+        ASSERT_TRUE(device.queue.size() <= 1);
+        ASSERT_TRUE(device.maxPickupDelayUs <= device.intervalUs);
+    }
+
+    auto fast = scheduler.getGroupStats(0);
+    ASSERT_EQ(fast.rateHz, 1000u);
+    ASSERT_EQ(fast.members, 1u);
+    ASSERT_EQ(scheduler.getGroupStats(3).members, 1u);
+}
+
+TEST(OverridePinsGroup) {
+    PollingScheduler scheduler;
+    scheduler.setBaseRate(1000);
+    scheduler.setOverrides(PollingScheduler::parseOverrides("generic usb:125;dualsense:1000"));
+    auto devices = mixedDevices();
+    devices[2].intervalUs = 1000; // Generic pad actually reports at 1 kHz, config says 125 Hz
+    attach(scheduler, devices);
+
+    uint64_t now = 1;
+    run(scheduler, devices, now, 2000000);
+    ASSERT_TRUE(scheduler.getTiming(2).pinned);
+    ASSERT_EQ(scheduler.getTiming(2).rateClass, 3u);
+    ASSERT_TRUE(scheduler.getTiming(0).pinned);
+    ASSERT_EQ(scheduler.getTiming(0).rateClass, 0u);
+    ASSERT_TRUE(!scheduler.getTiming(1).pinned);
+}
+
+TEST(UndersampledDeviceIsPromoted) {
+    PollingScheduler scheduler;
+    scheduler.setBaseRate(1000);
+    std::vector<SyntheticDevice> devices = {{L"Adaptive Pad", 8000}};
+    attach(scheduler, devices);
+
+    uint64_t now = 1;
+    run(scheduler, devices, now, 2000000);
+    ASSERT_EQ(scheduler.getTiming(0).rateClass, 2u);
+
+    // Same device switches to a 1 kHz mode: every poll finds a report, so it climbs back up
+    devices[0].intervalUs = 1000;
+    devices[0].nextReportUs = now;
+    run(scheduler, devices, now, 2000000);
+    ASSERT_EQ(scheduler.getTiming(0).rateClass, 0u);
+}
+
+TEST(IdleGapsDoNotSlowDevice) {
+    PollingScheduler scheduler;
+    scheduler.setBaseRate(1000);
+    std::vector<SyntheticDevice> devices = {{L"Xbox Controller", 4000}};
+    attach(scheduler, devices);
+
+    uint64_t now = 1;
+    run(scheduler, devices, now, 1000000);
+    ASSERT_EQ(scheduler.getTiming(0).rateClass, 1u);
+
+    // Pad goes idle for a second (no packets), then resumes
+    devices[0].nextReportUs = now + 1000000;
+    run(scheduler, devices, now, 1000000);
+    run(scheduler, devices, now, 200000);
+    ASSERT_TRUE(std::abs(scheduler.getTiming(0).reportIntervalUs - 4000.0) < 400.0);
+    ASSERT_EQ(scheduler.getTiming(0).rateClass, 1u);
+}
+
+TEST(InactiveDevicesDoNotHoldDeadlines) {
+    PollingScheduler scheduler;
+    scheduler.setBaseRate(1000);
+    std::vector<SyntheticDevice> devices = {{L"Flight Pedals", 20000}, {L"Empty Slot", 1000000000}};
+    attach(scheduler, devices);
+    scheduler.setActive(1, false);
+
+    uint64_t now = 1;
+    run(scheduler, devices, now, 2000000);
+    ASSERT_EQ(scheduler.getTiming(0).rateClass, 3u);
+
+    // Only the 125 Hz group is populated, so wake-ups are 8 ms apart
+    scheduler.beginFrame(now);
+    uint64_t next = scheduler.nextDeadlineUs();
+    ASSERT_TRUE(next - now <= 8000 && next - now > 1000);
+    ASSERT_TRUE(scheduler.isDue(1)); // Inactive device still looked at on every wake-up
+
+    // Re-binding the slot to another device resets its measurements
+    scheduler.assignDevice(0, L"Other Device", L"HID\\OTHER");
+    ASSERT_EQ(scheduler.getTiming(0).rateClass, 0u);
+    ASSERT_EQ(scheduler.getTiming(0).reports, 0u);
+}
+
+int main() {
+    std::cout << "=== Polling Scheduler Tests ===\n\n";
+
+    RUN_TEST(ClassHelpers);
+    RUN_TEST(ParseOverrides);
+    RUN_TEST(MixedRatesConverge);
+    RUN_TEST(OverridePinsGroup);
+    RUN_TEST(UndersampledDeviceIsPromoted);
+    RUN_TEST(IdleGapsDoNotSlowDevice);
+    RUN_TEST(InactiveDevicesDoNotHoldDeadlines);
+
+    std::cout << "\n=== All tests PASSED ===\n";
+    return 0;
+}
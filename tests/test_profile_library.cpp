@@ -0,0 +1,356 @@
+/**
+ * @file test_profile_library.cpp
+ * @brief Tests for the compiled device profile library
+ */
+
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../include/core/profile_library.hpp"
+#include "../include/core/translation_layer.hpp"
+
+#define TEST(name) void test_##name()
+#define RUN_TEST(name) do { \
+    std::cout << "Running " #name "..."; \
+    test_##name(); \
+    std::cout << " PASSED\n"; \
+} while(0)
+
+#define ASSERT_EQ(a, b) do { \
+    if ((a) != (b)) { \
+        std::cerr << "ASSERT_EQ failed: " << (a) << " != " << (b) << " at line " << __LINE__ << "\n"; \
+        assert(false); \
+    } \
+} while(0)
+
+#define ASSERT_TRUE(x) do { \
+    if (!(x)) { \
+        std::cerr << "ASSERT_TRUE failed at line " << __LINE__ << "\n"; \
+        assert(false); \
+    } \
+} while(0)
+
+namespace fs = std::filesystem;
+
+static bool parseText(const std::string& text, ProfileLibrary::Source& source, std::string* error = nullptr) {
+    std::istringstream in(text);
+    return ProfileLibrary::parse(in, source, error);
+}
+
+static void writeFile(const fs::path& path, const std::string& text) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out << text;
+}
+
+static ControllerState hidState(const std::wstring& name, USHORT vendorId, USHORT productId) {
+    ControllerState state{};
+    state.userId = -1;
+    state.isConnected = true;
+    state.devicePath = L"\\\\?\\hid#profile_test";
+    state.productName = name;
+    state.vendorId = vendorId;
+    state.productId = productId;
+    return state;
+}
+
+TEST(ParsesSourcesAndReportsLines) {
+    ProfileLibrary::Source source;
+    std::string error;
+    ASSERT_TRUE(parseText("# pad\nxidp-profile 1\nname \"Arcade Stick\"\nmatch usb=0F0d:00c1\n"
+                          "match name=\"Fighting Stick mini\"\nbutton 1 a   # light punch\nbutton 7 lb+rb\n"
+                          "button 8 0x0400\naxis 0x31 ly fixed center=2 scale=-16384 invert\naxis 0x33 lt caps\n",
+                          source, &error));
+    ASSERT_EQ(source.name, std::string("Arcade Stick"));
+    ASSERT_EQ(source.usbIds.size(), 1u);
+    ASSERT_EQ(source.usbIds[0].vendorId, 0x0f0d);
+    ASSERT_EQ(source.usbIds[0].productId, 0x00c1);
+    ASSERT_EQ(source.productNames[0], std::string("Fighting Stick mini"));
+    ASSERT_EQ(source.buttons[1], XINPUT_GAMEPAD_A);
+    ASSERT_EQ(source.buttons[7], XINPUT_GAMEPAD_LEFT_SHOULDER | XINPUT_GAMEPAD_RIGHT_SHOULDER);
+    ASSERT_EQ(source.buttons[8], 0x0400);
+    ASSERT_EQ(source.axes[0x31].target, ProfileLibrary::AXIS_LEFT_Y);
+    ASSERT_EQ(source.axes[0x31].mode, ProfileLibrary::AXIS_FIXED);
+    ASSERT_EQ(source.axes[0x31].center, 2);
+    ASSERT_EQ(source.axes[0x31].scale, -16384);
+    ASSERT_EQ(source.axes[0x31].invert, 1);
+    ASSERT_EQ(source.axes[0x33].mode, ProfileLibrary::AXIS_CAPS);
+
+    const std::string head = "xidp-profile 1\nname n\nmatch usb=1:2\n";
+    const std::pair<std::string, std::string> broken[] = {
+        {"xidp-profile 2\n", "line 1:"},
+        {head + "button 32 a\n", "line 4: button usage 32"},
+        {head + "button 3 turbo\n", "line 4: unknown button 'turbo'"},
+        {head + "button 3 a\nbutton 3 b\n", "line 5: button 3 mapped twice"},
+        {head + "axis 0x40 lx caps\n", "line 4: axis usage"},
+        {head + "axis 0x30 lx fixed center=128\n", "line 4: fixed axis needs a non-zero scale"},
+        {head + "axis 0x30 lx caps scale=4\n", "line 4: bad axis field"},
+        {head + "match usb=12345:1\n", "line 4: bad usb id"},
+        {head + "rumble on\n", "line 4: unknown line kind"},
+        {"xidp-profile 1\nname n\n", "line 2: profile has no match line"},
+    };
+    for (const auto& [text, expected] : broken) {
+        ProfileLibrary::Source bad;
+        error.clear();
+        ASSERT_TRUE(!parseText(text, bad, &error));
+        ASSERT_TRUE(error.find(expected) == 0);
+    }
+}
+
+TEST(ParsesHatsTriggerButtonsAndVersions) {
+    ProfileLibrary::Source source;
+    std::string error;
+    ASSERT_TRUE(parseText("xidp-profile 1\nname \"Retro Pad\"\nmatch usb=2dc8:6001:0114\nmatch usb=2dc8:6001\n"
+                          "button 7 lt\nbutton 8 rt+start\nhat up up\nhat left left\n",
+                          source, &error));
+    ASSERT_EQ(source.usbIds.size(), 2u);
+    ASSERT_EQ(source.usbIds[0].version, 0x0114);
+    ASSERT_EQ(source.usbIds[1].version, 0);
+    ASSERT_EQ(source.buttons.count(7), 0u);
+    ASSERT_EQ(source.buttonTriggers[7], ProfileLibrary::TRIGGER_LEFT);
+    ASSERT_EQ(source.buttons[8], XINPUT_GAMEPAD_START);
+    ASSERT_EQ(source.buttonTriggers[8], ProfileLibrary::TRIGGER_RIGHT);
+    ASSERT_EQ(source.hat[ProfileLibrary::HAT_UP], XINPUT_GAMEPAD_DPAD_UP);
+    ASSERT_EQ(source.hat[ProfileLibrary::HAT_LEFT], XINPUT_GAMEPAD_DPAD_LEFT);
+    ASSERT_EQ(source.hat[ProfileLibrary::HAT_DOWN], 0);
+
+    const std::string head = "xidp-profile 1\nname n\nmatch usb=1:2\n";
+    const std::pair<std::string, std::string> broken[] = {
+        {head + "hat north up\n", "line 4: unknown hat direction 'north'"},
+        {head + "hat up lt\n", "line 4: bad hat buttons 'lt'"},
+        {head + "hat up up\nhat up down\n", "line 5: hat up mapped twice"},
+        {head + "match usb=1:2:3:4\n", "line 4: bad usb id"},
+    };
+    for (const auto& [text, expected] : broken) {
+        ProfileLibrary::Source bad;
+        error.clear();
+        ASSERT_TRUE(!parseText(text, bad, &error));
+        ASSERT_TRUE(error.find(expected) == 0);
+    }
+}
+
+TEST(BuiltInKeepsDualShock4Mapping) {
+    auto library = ProfileLibrary::builtIn();
+    ASSERT_EQ(library->size(), 1u);
+    const ProfileLibrary::Profile* ds4 = library->find(0x054c, 0x09cc, L"Wireless Controller");
+    ASSERT_TRUE(ds4 != nullptr);
+    ASSERT_EQ(library->getName(*ds4), std::string("DualShock 4"));
+    ASSERT_TRUE(library->find(0, 0, L"Wireless Controller") == ds4);
+    ASSERT_TRUE(library->find(0x054c, 0x09cc, L"Generic Gamepad") == nullptr);   // No USB key built in
+    ASSERT_TRUE(library->find(0, 0, L"") == nullptr);
+
+    TranslationLayer layer;
+    layer.setSOCDCleaningEnabled(false);
+    layer.setStickDeadzoneEnabled(false);
+    std::vector<ControllerState> inputs{hidState(L"Wireless Controller", 0x054c, 0x09cc)};
+    inputs[0].m_activeButtons = {1, 2, 9, 12, 13};
+    inputs[0].m_hidValues[0x30] = 255;
+    inputs[0].m_hidValues[0x31] = 1;
+    inputs[0].m_hidValues[0x32] = 128;
+    inputs[0].m_hidValues[0x35] = 0;        // Saturates to full up
+    inputs[0].m_hidValues[0x33] = 200;      // Triggers are not mapped by the built-in
+    auto translated = layer.translate(inputs);
+    ASSERT_EQ(translated.size(), 1u);
+    ASSERT_EQ(translated[0].gamepad.wButtons,
+              XINPUT_GAMEPAD_X | XINPUT_GAMEPAD_A | XINPUT_GAMEPAD_BACK | XINPUT_GAMEPAD_RIGHT_THUMB);
+    ASSERT_EQ(translated[0].gamepad.sThumbLX, 32512);
+    ASSERT_EQ(translated[0].gamepad.sThumbLY, 32512);
+    ASSERT_EQ(translated[0].gamepad.sThumbRX, 0);
+    ASSERT_EQ(translated[0].gamepad.sThumbRY, 32767);
+    ASSERT_EQ(translated[0].gamepad.bLeftTrigger, 0);
+}
+
+TEST(CompilesAndFindsManyProfiles) {
+    std::vector<ProfileLibrary::Source> sources;
+    for (int i = 0; i < 500; ++i) {
+        ProfileLibrary::Source source;
+        source.name = "Pad " + std::to_string(i);
+        source.origin = "pad" + std::to_string(i) + ".profile";
+        source.usbIds.push_back({static_cast<uint16_t>(0x1000 + i % 7), static_cast<uint16_t>(i)});
+        source.productNames.push_back("Pad \xc3\xa9 " + std::to_string(i));   // U+00E9
+        source.buttons[1 + i % 31] = static_cast<WORD>(1u << (i % 16));
+        ProfileLibrary::Axis axis;
+        axis.target = ProfileLibrary::AXIS_RIGHT_X;
+        axis.mode = ProfileLibrary::AXIS_FIXED;
+        axis.center = i;
+        axis.scale = 3;
+        source.axes[0x32] = axis;
+        sources.push_back(source);
+    }
+    std::vector<uint8_t> blob;
+    std::string error;
+    ASSERT_TRUE(ProfileLibrary::compile(sources, 0, 42, blob, &error));
+
+    ProfileLibrary library;
+    ASSERT_TRUE(library.open(blob, &error));
+    ASSERT_EQ(library.size(), 500u);
+    ASSERT_EQ(library.getSourceStamp(), 42u);
+    for (int i = 0; i < 500; ++i) {
+        const std::wstring name = L"Pad é " + std::to_wstring(i);
+        const ProfileLibrary::Profile* byUsb = library.find(static_cast<uint16_t>(0x1000 + i % 7), static_cast<uint16_t>(i), L"");
+        const ProfileLibrary::Profile* byName = library.find(0, 0, name);
+        ASSERT_TRUE(byUsb != nullptr && byUsb == byName);
+        ASSERT_EQ(library.getName(*byUsb), "Pad " + std::to_string(i));
+        ASSERT_EQ(byUsb->buttons[1 + i % 31], static_cast<WORD>(1u << (i % 16)));
+        ASSERT_EQ(byUsb->axes[0x32 - ProfileLibrary::AXIS_FIRST_USAGE].center, i);
+        ASSERT_TRUE(library.find(0x2000, static_cast<uint16_t>(i), L"Pad " + std::to_wstring(i)) == nullptr);
+    }
+    // An unknown USB id still falls back to the name
+    ASSERT_TRUE(library.find(0xffff, 0xffff, L"Pad é 7") == library.find(0x1000, 7, L""));
+
+    // Two files claiming one key is an error, naming both
+    sources[3].usbIds.push_back(sources[2].usbIds[0]);
+    ASSERT_TRUE(!ProfileLibrary::compile(sources, 0, 42, blob, &error));
+    ASSERT_TRUE(error.find("pad3.profile") == 0 && error.find("pad2.profile") != std::string::npos);
+}
+
+TEST(RejectsDamagedBlobs) {
+    ProfileLibrary::Source source;
+    ASSERT_TRUE(parseText("xidp-profile 1\nname n\nmatch name=\"Pad\"\nbutton 1 a\n", source));
+    std::vector<uint8_t> blob;
+    ASSERT_TRUE(ProfileLibrary::compile({source}, 0, 0, blob));
+
+    std::string error;
+    std::vector<uint8_t> flipped = blob;
+    flipped[64] ^= 0x40;                                    // Inside the key index
+    ProfileLibrary library;
+    ASSERT_TRUE(!library.open(flipped, &error));
+    ASSERT_TRUE(error.find("checksum") != std::string::npos);
+    ASSERT_TRUE(library.find(0, 0, L"Pad") == nullptr);     // Left empty
+
+    std::vector<uint8_t> truncated(blob.begin(), blob.end() - 8);
+    ASSERT_TRUE(!library.open(truncated, &error));
+    std::vector<uint8_t> wrongMagic = blob;
+    wrongMagic[0] = 'Y';
+    ASSERT_TRUE(!library.open(wrongMagic, &error));
+    ASSERT_TRUE(error == "not a profile blob");
+    ASSERT_TRUE(!library.open(std::vector<uint8_t>(), &error));
+
+    // Every bucket taken, checksum fixed up: a lookup miss would probe forever
+    std::vector<uint8_t> full = blob;
+    uint32_t bucketCount = 0;
+    std::memcpy(&bucketCount, full.data() + 16, sizeof(bucketCount));
+    for (uint32_t i = 0; i < bucketCount; ++i) {
+        uint8_t* bucket = full.data() + 40 + 24 * i;               // Header, then {hash, profile, kind, key, keyLength}
+        const uint32_t fields[4] = {1, 0, 0xdeadbeef, 0};          // Profile 1, USB key
+        std::memcpy(bucket + 8, fields, sizeof(fields));
+    }
+    uint32_t checksum = 0x811c9dc5u;
+    for (size_t i = 40; i < full.size(); ++i) {
+        checksum = (checksum ^ full[i]) * 0x01000193u;
+    }
+    std::memcpy(full.data() + 32, &checksum, sizeof(checksum));
+    ASSERT_TRUE(!library.open(full, &error));
+    ASSERT_TRUE(error.find("no empty bucket") != std::string::npos);
+
+    ASSERT_TRUE(library.open(blob, &error));
+    ASSERT_TRUE(library.find(0, 0, L"Pad") != nullptr);
+}
+
+TEST(LoadDirectoryCachesAndRecompiles) {
+    fs::path dir = fs::temp_directory_path() / "xidp_profile_library_test";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    writeFile(dir / "ds4.profile",
+              "xidp-profile 1\nname \"DS4 remap\"\nmatch name=\"Wireless Controller\"\nbutton 2 b\n");
+    writeFile(dir / "stick.profile", "xidp-profile 1\nname Stick\nmatch usb=0f0d:00c1\nbutton 1 a\n");
+
+    std::string error;
+    auto first = ProfileLibrary::loadDirectory(dir.string(), &error);
+    ASSERT_TRUE(first != nullptr);
+    ASSERT_TRUE(!first->isMapped());
+    ASSERT_TRUE(fs::exists(dir / ProfileLibrary::COMPILED_NAME));
+    ASSERT_EQ(first->size(), 2u);                           // The file took over the built-in key
+    const ProfileLibrary::Profile* ds4 = first->find(0, 0, L"Wireless Controller");
+    ASSERT_EQ(first->getName(*ds4), std::string("DS4 remap"));
+    ASSERT_EQ(ds4->buttons[2], XINPUT_GAMEPAD_B);
+
+    auto second = ProfileLibrary::loadDirectory(dir.string(), &error);
+    ASSERT_TRUE(second != nullptr && second->isMapped());  // Current blob: mapped, not compiled
+    ASSERT_EQ(second->getSourceStamp(), first->getSourceStamp());
+    ASSERT_TRUE(second->find(0x0f0d, 0x00c1, L"") != nullptr);
+
+    second.reset();                                         // Windows cannot replace a mapped file
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    writeFile(dir / "stick.profile", "xidp-profile 1\nname Stick\nmatch usb=0f0d:00c2\nbutton 1 a\n");
+    auto third = ProfileLibrary::loadDirectory(dir.string(), &error);
+    ASSERT_TRUE(third != nullptr && !third->isMapped());
+    ASSERT_TRUE(third->find(0x0f0d, 0x00c1, L"") == nullptr);
+    ASSERT_TRUE(third->find(0x0f0d, 0x00c2, L"") != nullptr);
+
+    // A damaged blob is rebuilt rather than trusted
+    {
+        std::fstream blob(dir / ProfileLibrary::COMPILED_NAME, std::ios::in | std::ios::out | std::ios::binary);
+        blob.seekp(60);
+        blob.put('\x7f');
+    }
+    auto fourth = ProfileLibrary::loadDirectory(dir.string(), &error);
+    ASSERT_TRUE(fourth != nullptr && !fourth->isMapped());
+    ASSERT_TRUE(ProfileLibrary::loadDirectory(dir.string(), &error)->isMapped());
+
+    writeFile(dir / "broken.profile", "xidp-profile 1\nname b\nmatch usb=0f0d:00c2\n");
+    ASSERT_TRUE(ProfileLibrary::loadDirectory(dir.string(), &error) == nullptr);
+    ASSERT_TRUE(error.find("stick.profile: usb=0f0d:00c2 is already matched by broken.profile") == 0);
+    fs::remove_all(dir);
+}
+
+TEST(TranslationUsesInstalledLibrary) {
+    ProfileLibrary::Source source;
+    ASSERT_TRUE(parseText("xidp-profile 1\nname Stick\nmatch usb=0f0d:00c1\nbutton 3 up+left\n"
+                          "axis 0x30 rx fixed center=0 scale=1\naxis 0x33 rt caps invert\n",
+                          source));
+    std::vector<uint8_t> blob;
+    auto library = std::make_shared<ProfileLibrary>();
+    ASSERT_TRUE(ProfileLibrary::compile({source}, 0, 0, blob) && library->open(blob));
+
+    TranslationLayer layer;
+    layer.setSOCDCleaningEnabled(false);
+    layer.setProfileLibrary(library);
+    ASSERT_TRUE(&layer.getProfileLibrary() == library.get());
+
+    std::vector<ControllerState> inputs{hidState(L"Some Stick", 0x0f0d, 0x00c1)};
+    inputs[0].m_activeButtons = {1, 3};
+    inputs[0].m_hidValues[0x30] = 100000;   // Saturated
+    inputs[0].m_hidValues[0x33] = 0;
+    HIDP_VALUE_CAPS cap = {};
+    cap.UsagePage = 0x01;
+    cap.Range.UsageMin = 0x33;
+    cap.LogicalMin = 0;
+    cap.LogicalMax = 1023;
+    inputs[0].valueCaps.push_back(cap);
+    auto translated = layer.translate(inputs);
+    ASSERT_EQ(translated[0].gamepad.wButtons, XINPUT_GAMEPAD_DPAD_UP | XINPUT_GAMEPAD_DPAD_LEFT);
+    ASSERT_EQ(translated[0].gamepad.sThumbRX, 32767);
+    ASSERT_EQ(translated[0].gamepad.sThumbLX, 0);
+    ASSERT_EQ(translated[0].gamepad.bRightTrigger, 255);
+
+    // A DS4 is no longer known to this library: generic mapping
+    std::vector<ControllerState> ds4{hidState(L"Wireless Controller", 0x054c, 0x09cc)};
+    ds4[0].m_activeButtons = {1};
+    ASSERT_EQ(layer.translate(ds4)[0].gamepad.wButtons, XINPUT_GAMEPAD_A);
+
+    layer.setProfileLibrary(nullptr);                        // Back to the built-in
+    ASSERT_EQ(layer.translate(ds4)[0].gamepad.wButtons, XINPUT_GAMEPAD_X);
+}
+
+int main() {
+    std::cout << "=== Profile Library Tests ===\n\n";
+
+    RUN_TEST(ParsesSourcesAndReportsLines);
+    RUN_TEST(ParsesHatsTriggerButtonsAndVersions);
+    RUN_TEST(BuiltInKeepsDualShock4Mapping);
+    RUN_TEST(CompilesAndFindsManyProfiles);
+    RUN_TEST(RejectsDamagedBlobs);
+    RUN_TEST(LoadDirectoryCachesAndRecompiles);
+    RUN_TEST(TranslationUsesInstalledLibrary);
+
+    std::cout << "\n=== All tests PASSED ===\n";
+    return 0;
+}
@@ -0,0 +1,327 @@
+/**
+ * @file test_recording_container.cpp
+ * @brief Tests for the chunked, delta-compressed recording container
+ */
+
+#include <cassert>
+#include <filesystem>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "../include/core/recording_container.hpp"
+
+#define TEST(name) void test_##name()
+#define RUN_TEST(name) do { \
+    std::cout << "Running " #name "..."; \
+    test_##name(); \
+    std::cout << " PASSED\n"; \
+} while(0)
+
+#define ASSERT_EQ(a, b) do { \
+    if ((a) != (b)) { \
+        std::cerr << "ASSERT_EQ failed: " << (a) << " != " << (b) << " at line " << __LINE__ << "\n"; \
+        assert(false); \
+    } \
+} while(0)
+
+#define ASSERT_TRUE(x) do { \
+    if (!(x)) { \
+        std::cerr << "ASSERT_TRUE failed at line " << __LINE__ << "\n"; \
+        assert(false); \
+    } \
+} while(0)
+
+static std::string g_goldenDir = "tests/golden";
+
+// The text format is the uncompressed reference
+static std::string asText(const SessionRecording& recording) {
+    std::ostringstream out;
+    recording.write(out);
+    return out.str();
+}
+
+static std::string encode(const SessionRecording& recording, const RecordingWriter::Options& options) {
+    std::ostringstream out;
+    ASSERT_TRUE(RecordingWriter::write(recording, out, options));
+    return out.str();
+}
+
+static std::string encode(const SessionRecording& recording) {
+    return encode(recording, RecordingWriter::Options());
+}
+
+static SessionRecording decode(const std::string& bytes) {
+    std::istringstream in(bytes);
+    RecordingReader reader;
+    std::string error;
+    ASSERT_TRUE(reader.open(in, &error));
+    SessionRecording recording;
+    ASSERT_TRUE(reader.readAll(recording, &error));
+    return recording;
+}
+
+// Two XInput pads and one HID pad at 1 kHz; sticks drift, buttons toggle now and then
+static SessionRecording makeSession(uint32_t frames) {
+    SessionRecording recording;
+    recording.options["deadzone"] = "0.1";
+    for (int pad = 0; pad < 2; ++pad) {
+        SessionRecording::Device device;
+        device.kind = SessionRecording::SourceKind::XINPUT;
+        device.userId = pad;
+        recording.devices.push_back(device);
+    }
+    SessionRecording::Device hid;
+    hid.kind = SessionRecording::SourceKind::HID;
+    hid.userId = -1;
+    hid.vendorId = 0x054C;
+    hid.productId = 0x05C4;
+    hid.productName = "Wireless Controller";
+    hid.devicePath = "\\\\?\\hid#vid_054c&pid_05c4";
+    hid.valueCaps = {{0x30, 0, 255}, {0x31, 0, 255}, {0x32, 0, 255}, {0x35, 0, 255}};
+    recording.devices.push_back(hid);
+
+    for (uint32_t f = 0; f < frames; ++f) {
+        SessionRecording::Frame frame;
+        frame.timeUs = 1000000 + static_cast<uint64_t>(f) * 1000;
+        for (size_t pad = 0; pad < 2; ++pad) {
+            if (pad == 1 && f % 3 != 0) continue;   // Second pad reports less often
+            SessionRecording::Sample sample;
+            sample.device = pad;
+            sample.packetNumber = f + 1;
+            sample.gamepad.sThumbLX = static_cast<SHORT>((static_cast<int>(f) * 37 + static_cast<int>(pad) * 5000) % 30000 - 15000);
+            sample.gamepad.sThumbLY = static_cast<SHORT>(-static_cast<int>(f % 2000) * 11);
+            sample.gamepad.wButtons = (f / 250) % 2 ? XINPUT_GAMEPAD_A : 0;
+            sample.gamepad.bRightTrigger = static_cast<BYTE>(f / 100);
+            frame.samples.push_back(sample);
+        }
+        SessionRecording::Sample sample;
+        sample.device = 2;
+        sample.packetNumber = f;
+        if ((f / 400) % 2) sample.buttons = {1, 3};
+        sample.values = {{0x30, static_cast<LONG>(128 + f % 64)}, {0x31, 128}, {0x32, 127}, {0x35, static_cast<LONG>(f % 256)}};
+        sample.report = {0x01, static_cast<uint8_t>(128 + f % 64), 128, 127, static_cast<uint8_t>(f), 0x08, 0, 0};
+        frame.samples.push_back(sample);
+        recording.frames.push_back(frame);
+    }
+    return recording;
+}
+
+TEST(GoldenRecordingsRoundTrip) {
+    namespace fs = std::filesystem;
+    size_t checked = 0;
+    for (const auto& entry : fs::directory_iterator(g_goldenDir)) {
+        if (entry.path().extension() != ".rec") continue;
+        SessionRecording original;
+        std::string error;
+        ASSERT_TRUE(original.load(entry.path().string(), &error));
+        SessionRecording decoded = decode(encode(original));
+        ASSERT_EQ(decoded.frames.size(), original.frames.size());
+        ASSERT_TRUE(asText(decoded) == asText(original));
+        checked++;
+    }
+    ASSERT_TRUE(checked > 0);
+}
+
+TEST(SyntheticSessionRoundTripAcrossChunks) {
+    SessionRecording original = makeSession(5000);
+    RecordingWriter::Options options;
+    options.chunkFrames = 700;
+    std::string bytes = encode(original, options);
+
+    std::istringstream in(bytes);
+    RecordingReader reader;
+    ASSERT_TRUE(reader.open(in));
+    ASSERT_EQ(reader.getChunks().size(), 8u);   // 5000 / 700, rounded up
+    ASSERT_EQ(reader.getFrameCount(), 5000u);
+    ASSERT_TRUE(!reader.wasRecovered());
+
+    SessionRecording decoded = decode(bytes);
+    ASSERT_TRUE(asText(decoded) == asText(original));
+}
+
+TEST(DeltasAreMuchSmallerThanText) {
+    SessionRecording original = makeSession(5000);
+    std::string text = asText(original);
+    std::string bytes = encode(original);
+    // Every frame changes a stick or two, so this is not a best case
+    ASSERT_TRUE(bytes.size() * 5 < text.size());
+
+    // A frame that repeats the previous one costs a mask byte per sample
+    SessionRecording still = makeSession(1);
+    for (uint32_t f = 1; f < 1000; ++f) {
+        SessionRecording::Frame frame = still.frames[0];
+        frame.timeUs += f * 1000;
+        still.frames.push_back(frame);
+    }
+    RecordingWriter::Options oneChunk;
+    oneChunk.chunkFrames = 2000;
+    std::string first = encode(still, oneChunk);
+    still.frames.push_back(still.frames.back());
+    still.frames.back().timeUs += 1000;
+    std::string second = encode(still, oneChunk);
+    // Time delta (2 bytes), sample count, then device index and an empty mask per sample
+    ASSERT_EQ(second.size() - first.size(), 9u);
+}
+
+TEST(SeekCarriesStateOfEveryDevice) {
+    SessionRecording original = makeSession(3000);
+    RecordingWriter::Options options;
+    options.chunkFrames = 512;
+    std::string bytes = encode(original, options);
+    std::istringstream in(bytes);
+    RecordingReader reader;
+    ASSERT_TRUE(reader.open(in));
+
+    // Frame 2000 has no sample from pad 1 (2000 % 3 != 0); its last one was at frame 1998
+    const uint64_t target = original.frames[2000].timeUs;
+    ASSERT_TRUE(reader.seek(target - 500));
+    SessionRecording::Frame frame;
+    ASSERT_TRUE(reader.next(frame));
+    ASSERT_EQ(frame.timeUs, target);
+    bool sawPad1 = false;
+    for (const auto& sample : frame.samples) {
+        if (sample.device == 1) {
+            sawPad1 = true;
+            ASSERT_EQ(sample.packetNumber, 1999u);
+            ASSERT_EQ(sample.gamepad.sThumbLX, original.frames[1998].samples[1].gamepad.sThumbLX);
+        }
+    }
+    ASSERT_TRUE(sawPad1);
+
+    // Frames after the seek are the original ones
+    for (size_t f = 2001; f < 2100; ++f) {
+        ASSERT_TRUE(reader.next(frame));
+        ASSERT_EQ(frame.timeUs, original.frames[f].timeUs);
+        ASSERT_EQ(frame.samples.size(), original.frames[f].samples.size());
+        ASSERT_EQ(frame.samples.back().report[4], original.frames[f].samples.back().report[4]);
+    }
+
+    // Back to the start, and past the end
+    ASSERT_TRUE(reader.seek(0));
+    ASSERT_TRUE(reader.next(frame));
+    ASSERT_EQ(frame.timeUs, original.frames[0].timeUs);
+    ASSERT_TRUE(reader.seek(original.frames.back().timeUs + 1));
+    ASSERT_TRUE(!reader.next(frame));
+    ASSERT_TRUE(reader.getError().empty());
+}
+
+TEST(UnfinishedFileIsRecovered) {
+    SessionRecording original = makeSession(2000);
+    std::ostringstream out;
+    RecordingWriter::Options options;
+    options.chunkFrames = 300;
+    RecordingWriter writer(out, original, options);
+    for (const auto& frame : original.frames) {
+        ASSERT_TRUE(writer.append(frame));
+    }
+    // No finish(): six complete chunks (1800 frames) reached the stream, plus a torn seventh
+    std::string bytes = out.str() + std::string("XCNK\x40", 5);
+
+    std::istringstream in(bytes);
+    RecordingReader reader;
+    ASSERT_TRUE(reader.open(in));
+    ASSERT_TRUE(reader.wasRecovered());
+    ASSERT_EQ(reader.getChunks().size(), 6u);
+    ASSERT_EQ(reader.getFrameCount(), 1800u);
+
+    SessionRecording decoded;
+    ASSERT_TRUE(reader.readAll(decoded));
+    original.frames.resize(1800);
+    ASSERT_TRUE(asText(decoded) == asText(original));
+}
+
+TEST(RejectsDamage) {
+    SessionRecording original = makeSession(1000);
+    RecordingWriter::Options options;
+    options.chunkFrames = 250;
+    std::string bytes = encode(original, options);
+
+    {
+        std::istringstream in("xidp-recording 1\n");
+        RecordingReader reader;
+        std::string error;
+        ASSERT_TRUE(!RecordingReader::isContainer(in));
+        ASSERT_TRUE(!reader.open(in, &error));
+        ASSERT_TRUE(!error.empty());
+    }
+    {
+        // Flip a byte inside the third chunk's payload: the first two still decode
+        std::istringstream probe(bytes);
+        RecordingReader indexed;
+        ASSERT_TRUE(indexed.open(probe));
+        std::string damaged = bytes;
+        damaged[indexed.getChunks()[2].offset + 40] ^= 0x5A;
+
+        std::istringstream in(damaged);
+        RecordingReader reader;
+        ASSERT_TRUE(reader.open(in));
+        SessionRecording::Frame frame;
+        size_t frames = 0;
+        while (reader.next(frame)) frames++;
+        ASSERT_EQ(frames, 500u);
+        ASSERT_TRUE(reader.getError().find("checksum") != std::string::npos);
+
+        SessionRecording decoded;
+        std::string error;
+        ASSERT_TRUE(!reader.readAll(decoded, &error));
+        ASSERT_TRUE(!error.empty());
+    }
+    {
+        // Frames going back in time and unknown devices are refused
+        std::ostringstream out;
+        RecordingWriter writer(out, original);
+        ASSERT_TRUE(writer.append(original.frames[1]));
+        ASSERT_TRUE(!writer.append(original.frames[0]));
+        SessionRecording::Frame stray = original.frames[2];
+        stray.samples[0].device = 7;
+        ASSERT_TRUE(!writer.append(stray));
+        ASSERT_TRUE(writer.finish());
+        ASSERT_TRUE(!writer.append(original.frames[3]));
+    }
+}
+
+TEST(WriterMemoryIsBoundedByChunk) {
+    SessionRecording original = makeSession(4000);
+    std::ostringstream out;
+    RecordingWriter::Options options;
+    options.chunkFrames = 1u << 30;
+    options.chunkBytes = 4096;
+    RecordingWriter writer(out, original, options);
+    uint64_t written = writer.getStats().bytes;
+    for (const auto& frame : original.frames) {
+        ASSERT_TRUE(writer.append(frame));
+        // Whatever is not on the stream yet is the open chunk, which closes at chunkBytes
+        ASSERT_EQ(static_cast<uint64_t>(out.tellp()), writer.getStats().bytes);
+        ASSERT_TRUE(writer.getStats().bytes >= written);
+        written = writer.getStats().bytes;
+    }
+    ASSERT_TRUE(writer.finish());
+    ASSERT_TRUE(writer.getStats().chunks > 4);
+
+    std::istringstream in(out.str());
+    RecordingReader reader;
+    ASSERT_TRUE(reader.open(in));
+    for (const auto& chunk : reader.getChunks()) {
+        ASSERT_TRUE(chunk.frames > 0);
+    }
+    ASSERT_TRUE(asText(decode(out.str())) == asText(original));
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1) {
+        g_goldenDir = argv[1];
+    }
+    std::cout << "=== Recording Container Tests ===\n\n";
+
+    RUN_TEST(GoldenRecordingsRoundTrip);
+    RUN_TEST(SyntheticSessionRoundTripAcrossChunks);
+    RUN_TEST(DeltasAreMuchSmallerThanText);
+    RUN_TEST(SeekCarriesStateOfEveryDevice);
+    RUN_TEST(UnfinishedFileIsRecovered);
+    RUN_TEST(RejectsDamage);
+    RUN_TEST(WriterMemoryIsBoundedByChunk);
+
+    std::cout << "\n=== All tests PASSED ===\n";
+    return 0;
+}
@@ -0,0 +1,179 @@
+/**
+ * @file test_replay_corpus.cpp
+ * @brief Tests for the parallel replay corpus runner
+ */
+
+#include <cassert>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "../include/core/replay_corpus.hpp"
+#include "../include/core/recording_container.hpp"
+#include "../include/core/session_recording.hpp"
+
+#define TEST(name) void test_##name()
+#define RUN_TEST(name) do { \
+    std::cout << "Running " #name "..."; \
+    test_##name(); \
+    std::cout << " PASSED\n"; \
+} while(0)
+
+#define ASSERT_EQ(a, b) do { \
+    if ((a) != (b)) { \
+        std::cerr << "ASSERT_EQ failed: " << (a) << " != " << (b) << " at line " << __LINE__ << "\n"; \
+        assert(false); \
+    } \
+} while(0)
+
+#define ASSERT_TRUE(x) do { \
+    if (!(x)) { \
+        std::cerr << "ASSERT_TRUE failed at line " << __LINE__ << "\n"; \
+        assert(false); \
+    } \
+} while(0)
+
+namespace fs = std::filesystem;
+
+static fs::path g_goldenDir = "tests/golden";
+
+// Everything but the timing columns
+static std::string outcomeKey(const ReplayCorpus::Outcome& outcome) {
+    std::ostringstream key;
+    key << outcome.name << " " << outcome.passed << " " << outcome.error << " " << outcome.frames << " "
+        << outcome.records;
+    for (const auto& m : outcome.mismatches) {
+        key << " " << m.record << ":" << m.field << ":" << m.expected << ":" << m.actual;
+    }
+    return key.str();
+}
+
+/**
+ * A scratch corpus: one intact recording, one whose golden stream was
+ * changed, one without golden file, one that does not parse and the intact
+ * one again as a container
+ */
+static fs::path makeCorpus() {
+    fs::path dir = fs::temp_directory_path() / "xidp_replay_corpus_test";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+
+    fs::copy_file(g_goldenDir / "xinput_socd_deadzone.rec", dir / "a_intact.rec");
+    fs::copy_file(g_goldenDir / "xinput_socd_deadzone.golden", dir / "a_intact.golden");
+
+    fs::copy_file(g_goldenDir / "hid_generic_8bit.rec", dir / "b_changed.rec");
+    GoldenOutput golden;
+    ASSERT_TRUE(golden.load((g_goldenDir / "hid_generic_8bit.golden").string()));
+    for (auto& [field, value] : golden.records[3].fields) {
+        if (field == "btn") value = "0xffff";
+    }
+    std::ofstream changed(dir / "b_changed.golden");
+    golden.write(changed);
+    changed.close();
+
+    fs::copy_file(g_goldenDir / "ds4_usb.rec", dir / "c_unblessed.rec");
+
+    std::ofstream broken(dir / "d_broken.rec");
+    broken << "xidp-recording 1\nframe 10\nx 3 packet=1\n";
+    broken.close();
+
+    SessionRecording recording;
+    ASSERT_TRUE(recording.load((g_goldenDir / "xinput_socd_deadzone.rec").string()));
+    ASSERT_TRUE(RecordingWriter::save(recording, (dir / "e_container.xrec").string()));
+    fs::copy_file(g_goldenDir / "xinput_socd_deadzone.golden", dir / "e_container.golden");
+    return dir;
+}
+
+TEST(GoldenCorpusPassesInCorpusOrder) {
+    ReplayCorpus corpus(3);
+    std::string error;
+    ASSERT_TRUE(corpus.addDirectory(g_goldenDir.string(), &error));
+    ReplayCorpus::Summary summary = corpus.run();
+    ASSERT_EQ(summary.threads, 4u);
+    ASSERT_EQ(summary.failed, 0u);
+    ASSERT_EQ(summary.outcomes.size(), corpus.getEntries().size());
+    for (size_t i = 0; i < summary.outcomes.size(); ++i) {
+        const auto& outcome = summary.outcomes[i];
+        ASSERT_EQ(outcome.name, corpus.getEntries()[i].name);
+        ASSERT_TRUE(outcome.passed);
+        ASSERT_TRUE(outcome.frames > 0 && outcome.records > 0);
+        if (i > 0) ASSERT_TRUE(summary.outcomes[i - 1].name < outcome.name);
+    }
+
+    ASSERT_TRUE(!corpus.addDirectory((g_goldenDir / "missing").string(), &error));
+    ASSERT_TRUE(!error.empty());
+}
+
+TEST(ReportsDifferencesAndFailures) {
+    fs::path dir = makeCorpus();
+    ReplayCorpus corpus(2);
+    ASSERT_TRUE(corpus.addDirectory(dir.string()));
+    ReplayCorpus::Summary summary = corpus.run();
+    ASSERT_EQ(summary.outcomes.size(), 5u);
+    ASSERT_EQ(summary.passed, 2u);
+    ASSERT_EQ(summary.failed, 3u);
+
+    const auto& outcomes = summary.outcomes;
+    ASSERT_TRUE(outcomes[0].passed);
+    ASSERT_TRUE(!outcomes[1].passed && outcomes[1].error.empty());
+    ASSERT_EQ(outcomes[1].mismatches.size(), 1u);
+    ASSERT_EQ(outcomes[1].mismatches[0].record, 3u);
+    ASSERT_EQ(outcomes[1].mismatches[0].field, std::string("btn"));
+    ASSERT_EQ(outcomes[1].mismatches[0].expected, std::string("0xffff"));
+    ASSERT_TRUE(!outcomes[2].passed && !outcomes[2].error.empty());
+    ASSERT_TRUE(outcomes[2].records > 0);                           // Rendered, only the golden file is missing
+    ASSERT_TRUE(!outcomes[3].passed && outcomes[3].error.find("line 3") == 0);
+    ASSERT_TRUE(outcomes[4].passed);                                // The container renders the same stream
+    ASSERT_EQ(outcomes[4].records, outcomes[0].records);
+
+    std::ostringstream report;
+    ReplayCorpus::writeReport(summary, report);
+    const std::string text = report.str();
+    ASSERT_TRUE(text.find("PASS a_intact") == 0);
+    ASSERT_TRUE(text.find("FAIL b_changed") != std::string::npos);
+    ASSERT_TRUE(text.find("record 3 btn: expected 0xffff") != std::string::npos);
+    ASSERT_TRUE(text.find("2 passed, 3 failed") != std::string::npos);
+    fs::remove_all(dir);
+}
+
+TEST(OutcomeDoesNotDependOnWorkers) {
+    fs::path dir = makeCorpus();
+    std::vector<std::string> reference;
+    for (size_t workers : {0, 1, 3, 7}) {
+        ReplayCorpus corpus(workers);
+        ASSERT_TRUE(corpus.addDirectory(dir.string()));
+        // Doubled three times: several entries per participant, so tasks are stolen and finish out of order
+        for (int round = 0; round < 3; ++round) {
+            for (const auto& entry : std::vector<ReplayCorpus::Entry>(corpus.getEntries())) {
+                corpus.add(entry);
+            }
+        }
+        ReplayCorpus::Summary summary = corpus.run();
+        std::vector<std::string> keys;
+        for (const auto& outcome : summary.outcomes) {
+            keys.push_back(outcomeKey(outcome));
+        }
+        if (reference.empty()) {
+            reference = keys;
+        }
+        ASSERT_TRUE(keys == reference);
+        ASSERT_EQ(summary.outcomes.size(), 40u);
+    }
+    fs::remove_all(dir);
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1) {
+        g_goldenDir = argv[1];
+    }
+    std::cout << "=== Replay Corpus Tests ===\n\n";
+
+    RUN_TEST(GoldenCorpusPassesInCorpusOrder);
+    RUN_TEST(ReportsDifferencesAndFailures);
+    RUN_TEST(OutcomeDoesNotDependOnWorkers);
+
+    std::cout << "\n=== All tests PASSED ===\n";
+    return 0;
+}
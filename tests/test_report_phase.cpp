@@ -0,0 +1,225 @@
+/**
+ * @file test_report_phase.cpp
+ * @brief Tests for report phase estimation and phase-aligned pacing with simulated devices
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "../include/core/report_phase.hpp"
+
+#define TEST(name) void test_##name()
+#define RUN_TEST(name) do { \
+    std::cout << "Running " #name "..."; \
+    test_##name(); \
+    std::cout << " PASSED\n"; \
+} while(0)
+
+#define ASSERT_EQ(a, b) do { \
+    if ((a) != (b)) { \
+        std::cerr << "ASSERT_EQ failed: " << (a) << " != " << (b) << " at line " << __LINE__ << "\n"; \
+        assert(false); \
+    } \
+} while(0)
+
+#define ASSERT_TRUE(x) do { \
+    if (!(x)) { \
+        std::cerr << "ASSERT_TRUE failed at line " << __LINE__ << "\n"; \
+        assert(false); \
+    } \
+} while(0)
+
+/**
+ * Simulated device: nominal period scaled by a clock drift (ppm), uniform
+ * jitter on every report, and occasional dropped reports.
+ */
+static std::vector<uint64_t> simulateArrivals(double nominalUs, double driftPpm, double jitterUs,
+                                              double dropRate, uint64_t startUs, uint64_t durationUs,
+                                              unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> jitter(-jitterUs, jitterUs);
+    std::uniform_real_distribution<double> drop(0.0, 1.0);
+    double period = nominalUs * (1.0 + driftPpm * 1e-6);
+
+    std::vector<uint64_t> arrivals;
+    for (double t = static_cast<double>(startUs); t < startUs + durationUs; t += period) {
+        if (drop(rng) < dropRate) continue;
+        arrivals.push_back(static_cast<uint64_t>(std::max(0.0, t + jitter(rng))));
+    }
+    return arrivals;
+}
+
+/**
+ * Run a capture loop over the arrivals and return the average input age
+ * (pickup time minus arrival time). With a pacer the loop wakes as planned
+ * and watches the anchor in watchStepUs steps; without, it wakes on a fixed grid.
+ * Reports seen while watching carry a narrow arrival window.
+ */
+struct LoopResult {
+    double averageAgeUs;
+    uint64_t wakes;
+};
+
+static LoopResult runLoop(const std::vector<uint64_t>& arrivals, uint64_t basePeriodUs, uint64_t offsetUs,
+                          PhaseAlignedPacer* pacer, uint64_t measureFromUs, uint64_t watchStepUs = 10) {
+    size_t nextArrival = 0;
+    uint64_t lastWake = offsetUs;
+    uint64_t regular = offsetUs;
+    double ageSum = 0.0;
+    uint64_t ageCount = 0;
+    uint64_t wakes = 0;
+    uint64_t end = arrivals.back();
+
+    uint64_t lastLook = offsetUs;
+    auto pickup = [&](uint64_t now) {
+        bool got = false;
+        while (nextArrival < arrivals.size() && arrivals[nextArrival] <= now) {
+            if (arrivals[nextArrival] >= measureFromUs) {
+                ageSum += static_cast<double>(now - arrivals[nextArrival]);
+                ageCount++;
+            }
+            nextArrival++;
+            got = true;
+        }
+        if (got && pacer) pacer->onReport(0, now, lastLook);
+        lastLook = now;
+        return got;
+    };
+
+    while (regular < end) {
+        PhaseAlignedPacer::WakePlan plan = pacer ? pacer->plan(lastWake, regular)
+                                                 : PhaseAlignedPacer::WakePlan{regular, regular, -1};
+        uint64_t now = plan.wakeUs;
+        if (now >= measureFromUs) wakes++;
+
+        // Watch the anchor until its report lands or the window closes
+        while (!pickup(now) && now < plan.watchUntilUs) {
+            now = std::min(now + watchStepUs, plan.watchUntilUs);
+        }
+
+        lastWake = plan.wakeUs;
+        regular = lastWake + basePeriodUs;
+    }
+    return {ageCount ? ageSum / ageCount : 0.0, wakes};
+}
+
+TEST(EstimatorTracksDriftAndJitter) {
+    // 1 kHz device whose crystal runs 300 ppm slow, +-40 us jitter, 2% drops
+    auto arrivals = simulateArrivals(1000.0, 300.0, 40.0, 0.02, 5000, 2000000, 1);
+
+    ReportPhaseEstimator estimator;
+    double errorSum = 0.0;
+    int errorCount = 0;
+    for (size_t i = 0; i < arrivals.size(); ++i) {
+        if (i > 200) {
+            // Predicted from the previous report, folded over any dropped reports
+            double error = estimator.predictNextUs(static_cast<double>(arrivals[i - 1])) - static_cast<double>(arrivals[i]);
+            error -= std::round(error / estimator.periodUs()) * estimator.periodUs();
+            errorSum += std::abs(error);
+            errorCount++;
+        }
+        estimator.onReport(arrivals[i]);
+    }
+
+    ASSERT_TRUE(estimator.isLocked());
+    ASSERT_TRUE(std::abs(estimator.periodUs() - 1000.3) < 1.0);
+    ASSERT_TRUE(estimator.jitterUs() < 40.0);
+    // Prediction is within the jitter band on average
+    ASSERT_TRUE(errorSum / errorCount < 40.0);
+}
+
+TEST(EstimatorRetrainsOnRateChange) {
+    ReportPhaseEstimator estimator;
+    auto slow = simulateArrivals(8000.0, 0.0, 100.0, 0.0, 0, 1000000, 2);
+    for (uint64_t t : slow) estimator.onReport(t);
+    ASSERT_TRUE(estimator.isLocked());
+    ASSERT_TRUE(std::abs(estimator.periodUs() - 8000.0) < 20.0);
+
+    // Device switches to a 1 kHz mode: phase errors are outliers until it retrains
+    auto fast = simulateArrivals(1000.0, 0.0, 20.0, 0.0, slow.back() + 1000, 200000, 3);
+    for (uint64_t t : fast) estimator.onReport(t);
+    ASSERT_TRUE(estimator.isLocked());
+    ASSERT_TRUE(std::abs(estimator.periodUs() - 1000.0) < 5.0);
+}
+
+TEST(NoLockOnIrregularReports) {
+    // Event-driven reports (e.g. XInput packet changes) never lock
+    std::mt19937 rng(4);
+    std::uniform_int_distribution<int> gap(1000, 30000);
+    ReportPhaseEstimator estimator;
+    uint64_t t = 0;
+    for (int i = 0; i < 500; ++i) {
+        t += gap(rng);
+        estimator.onReport(t);
+    }
+    ASSERT_TRUE(!estimator.isLocked());
+
+    PhaseAlignedPacer pacer;
+    pacer.onReport(0, 1000);
+    ASSERT_EQ(pacer.anchor(), -1);
+    PhaseAlignedPacer::WakePlan plan = pacer.plan(1000, 2000);
+    ASSERT_EQ(plan.wakeUs, 2000u);
+    ASSERT_EQ(plan.watchUntilUs, 2000u);
+}
+
+TEST(AlignedSamplingReducesInputAge) {
+    // 1 kHz loop whose grid is unrelated to a drifting, jittery 1 kHz device
+    auto arrivals = simulateArrivals(1000.0, -250.0, 30.0, 0.01, 3370, 3000000, 5);
+
+    LoopResult unaligned = runLoop(arrivals, 1000, 0, nullptr, 500000);
+
+    PhaseAlignedPacer pacer;
+    LoopResult aligned = runLoop(arrivals, 1000, 0, &pacer, 500000);
+
+    ASSERT_TRUE(pacer.anchor() == 0);
+    ASSERT_TRUE(unaligned.averageAgeUs > 300.0);
+    ASSERT_TRUE(aligned.averageAgeUs < 60.0);
+
+    // Same loop rate: wake-ups within 2% of the fixed grid
+    double ratio = static_cast<double>(aligned.wakes) / static_cast<double>(unaligned.wakes);
+    ASSERT_TRUE(ratio > 0.98 && ratio < 1.02);
+}
+
+TEST(SlowAnchorOnlyShiftsOneWakePerReport) {
+    // 250 Hz device under a 1 kHz loop: every fourth wake snaps to the arrival
+    auto arrivals = simulateArrivals(4000.0, 100.0, 50.0, 0.0, 1730, 3000000, 6);
+
+    LoopResult unaligned = runLoop(arrivals, 1000, 0, nullptr, 500000);
+    PhaseAlignedPacer pacer;
+    LoopResult aligned = runLoop(arrivals, 1000, 0, &pacer, 500000);
+
+    ASSERT_TRUE(aligned.averageAgeUs < unaligned.averageAgeUs / 3.0);
+    double ratio = static_cast<double>(aligned.wakes) / static_cast<double>(unaligned.wakes);
+    ASSERT_TRUE(ratio > 0.98 && ratio < 1.30);
+}
+
+TEST(PacerPicksFastestLockedDevice) {
+    PhaseAlignedPacer pacer;
+    auto fast = simulateArrivals(1000.0, 0.0, 10.0, 0.0, 0, 200000, 7);
+    auto slow = simulateArrivals(8000.0, 0.0, 10.0, 0.0, 0, 400000, 8);
+    for (uint64_t t : slow) pacer.onReport(1, t);
+    ASSERT_EQ(pacer.anchor(), 1);
+    for (uint64_t t : fast) pacer.onReport(2, t);
+    ASSERT_EQ(pacer.anchor(), 2);
+
+    pacer.reset(2);
+    ASSERT_EQ(pacer.anchor(), 1);
+    ASSERT_TRUE(pacer.estimator(9) == nullptr);
+}
+
+int main() {
+    std::cout << "=== Report Phase Tests ===\n\n";
+
+    RUN_TEST(EstimatorTracksDriftAndJitter);
+    RUN_TEST(EstimatorRetrainsOnRateChange);
+    RUN_TEST(NoLockOnIrregularReports);
+    RUN_TEST(AlignedSamplingReducesInputAge);
+    RUN_TEST(SlowAnchorOnlyShiftsOneWakePerReport);
+    RUN_TEST(PacerPicksFastestLockedDevice);
+
+    std::cout << "\n=== All tests PASSED ===\n";
+    return 0;
+}
@@ -0,0 +1,297 @@
+/**
+ * @file test_simd_kernels.cpp
+ * @brief Tests that every SIMD kernel variant matches the scalar reference
+ *
+ * Each level the CPU supports is forced in turn; levels above it are skipped.
+ */
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <atomic>
+#include <iostream>
+#include <thread>
+#include <vector>
+#include "../include/core/simd_kernels.hpp"
+#include "../include/core/translation_layer.hpp"
+#include "../include/utils/cpu_features.hpp"
+
+#define TEST(name) void test_##name()
+#define RUN_TEST(name) do { \
+    std::cout << "Running " #name "..."; \
+    test_##name(); \
+    std::cout << " PASSED\n"; \
+} while(0)
+
+#define ASSERT_EQ(a, b) do { \
+    if ((a) != (b)) { \
+        std::cerr << "ASSERT_EQ failed: " << (a) << " != " << (b) << " at line " << __LINE__ << "\n"; \
+        assert(false); \
+    } \
+} while(0)
+
+#define ASSERT_TRUE(x) do { \
+    if (!(x)) { \
+        std::cerr << "ASSERT_TRUE failed at line " << __LINE__ << "\n"; \
+        assert(false); \
+    } \
+} while(0)
+
+static const SimdLevel kLevels[] = {SimdLevel::SCALAR, SimdLevel::SSE41, SimdLevel::AVX2, SimdLevel::AVX512};
+
+static std::vector<SimdLevel> supportedLevels() {
+    std::vector<SimdLevel> levels;
+    for (SimdLevel level : kLevels) {
+        if (level <= SimdKernels::supportedLevel()) levels.push_back(level);
+    }
+    return levels;
+}
+
+// Deterministic LCG so failures reproduce
+static uint32_t nextRandom(uint32_t& seed) {
+    seed = seed * 1664525u + 1013904223u;
+    return seed >> 8;
+}
+
+static std::vector<SHORT> stickSamples() {
+    std::vector<SHORT> xy;
+    // Extremes, center and the +-1 neighbourhood of zero
+    const SHORT edges[] = {0, 1, -1, 2, -2, 32767, -32767, -32768, 16384, -16384, 4915, -4915};
+    for (SHORT x : edges) {
+        for (SHORT y : edges) {
+            xy.push_back(x);
+            xy.push_back(y);
+        }
+    }
+    // Odd pair count, so every variant also runs its tail path
+    uint32_t seed = 12345;
+    while (xy.size() < 2 * 20001) {
+        xy.push_back(static_cast<SHORT>(nextRandom(seed) & 0xFFFF));
+    }
+    return xy;
+}
+
+TEST(DeadzoneVariantsMatchScalar) {
+    const std::vector<SHORT> input = stickSamples();
+    const float deadzones[] = {0.0f, 0.05f, 0.15f, 0.5f, 0.99f, 1.0f};
+    const float antiDeadzones[] = {0.0f, 0.2f, 1.0f};
+
+    for (float deadzone : deadzones) {
+        for (float antiDeadzone : antiDeadzones) {
+            std::vector<SHORT> expected = input;
+            SimdVariants::radialDeadzoneScalar(expected.data(), expected.size() / 2, deadzone, antiDeadzone);
+
+            for (SimdLevel level : supportedLevels()) {
+                SimdKernelTable table = SimdKernels::tableFor(level);
+                std::vector<SHORT> actual = input;
+                table.radialDeadzone(actual.data(), actual.size() / 2, deadzone, antiDeadzone);
+                for (size_t i = 0; i < actual.size(); ++i) {
+                    if (actual[i] != expected[i]) {
+                        std::cerr << table.radialDeadzoneVariant << " dz=" << deadzone << " anti=" << antiDeadzone
+                                  << " input " << input[i & ~size_t(1)] << "," << input[i | 1] << "\n";
+                    }
+                    ASSERT_EQ(actual[i], expected[i]);
+                }
+            }
+        }
+    }
+}
+
+TEST(DeadzoneScalarMatchesReferenceBehaviour) {
+    SHORT xy[6] = {1000, 1000, 32767, 0, 0, -32767};
+    SimdVariants::radialDeadzoneScalar(xy, 3, 0.15f, 0.0f);
+    ASSERT_EQ(xy[0], 0);                // Inside the deadzone
+    ASSERT_EQ(xy[1], 0);
+    ASSERT_EQ(xy[2], 32767);            // Full deflection stays full
+    ASSERT_EQ(xy[3], 0);
+    ASSERT_EQ(xy[5], -32767);
+}
+
+TEST(ButtonVariantsMatchScalarForEveryWord) {
+    for (SimdLevel level : supportedLevels()) {
+        SimdKernelTable table = SimdKernels::tableFor(level);
+        for (uint32_t word = 0; word <= 0xFFFF; ++word) {
+            BYTE expected[16];
+            BYTE actual[16];
+            std::memset(actual, 0x55, sizeof(actual));
+            SimdVariants::encodeDInputButtonsScalar(static_cast<WORD>(word), expected);
+            table.encodeDInputButtons(static_cast<WORD>(word), actual);
+            if (std::memcmp(expected, actual, sizeof(expected)) != 0) {
+                std::cerr << table.encodeDInputButtonsVariant << " word " << word << "\n";
+            }
+            ASSERT_TRUE(std::memcmp(expected, actual, sizeof(expected)) == 0);
+        }
+    }
+
+    BYTE bytes[16];
+    SimdVariants::encodeDInputButtonsScalar(XINPUT_GAMEPAD_A | XINPUT_GAMEPAD_RIGHT_THUMB | XINPUT_GAMEPAD_DPAD_UP, bytes);
+    ASSERT_EQ(bytes[0], 0x80);
+    ASSERT_EQ(bytes[9], 0x80);
+    for (int i = 1; i < 9; ++i) ASSERT_EQ(bytes[i], 0);
+    for (int i = 10; i < 16; ++i) ASSERT_EQ(bytes[i], 0);   // D-pad goes to the POV, not a button
+}
+
+TEST(DedupVariantsMatchScalar) {
+    uint32_t seed = 99;
+    for (SimdLevel level : supportedLevels()) {
+        SimdKernelTable table = SimdKernels::tableFor(level);
+        for (int round = 0; round < 2000; ++round) {
+            unsigned char a[SimdKernels::GAMEPAD_REPORT_BYTES];
+            unsigned char b[SimdKernels::GAMEPAD_REPORT_BYTES];
+            for (auto& byte : a) byte = static_cast<unsigned char>(nextRandom(seed));
+            std::memcpy(b, a, sizeof(a));
+            ASSERT_TRUE(table.sameGamepad(a, b));
+
+            // A single flipped bit anywhere in the report is a change
+            size_t bit = nextRandom(seed) % (sizeof(a) * 8);
+            b[bit / 8] ^= static_cast<unsigned char>(1u << (bit % 8));
+            ASSERT_EQ(table.sameGamepad(a, b), SimdVariants::sameGamepadScalar(a, b));
+            ASSERT_TRUE(!table.sameGamepad(a, b));
+        }
+    }
+}
+
+static bool sameStickStats(const StickStats& a, const StickStats& b) {
+    return std::memcmp(a.extents, b.extents, sizeof(a.extents)) == 0 && a.restCount == b.restCount &&
+           a.restSumX == b.restSumX && a.restSumY == b.restSumY;
+}
+
+TEST(StickStatsVariantsMatchScalar) {
+    const std::vector<SHORT> input = stickSamples();
+    const int32_t windows[] = {0, 1, 4915, 8192, 32767, 32768};
+    // Slices that start and end off the vector width, and more than one 32-bit sum block
+    std::vector<SHORT> noise(2 * 300007);
+    uint32_t seed = 4242;
+    for (auto& value : noise) value = static_cast<SHORT>(nextRandom(seed) & 0xFFFF);
+
+    for (int32_t window : windows) {
+        const std::vector<SHORT>* sets[] = {&input, &noise};
+        for (const std::vector<SHORT>* samples : sets) {
+            StickStats expected;
+            expected.extents[3] = 5;   // Accumulates onto existing stats
+            expected.restCount = 7;
+            StickStats start = expected;
+            SimdVariants::stickStatsScalar(samples->data() + 2, samples->size() / 2 - 1, window, expected);
+
+            for (SimdLevel level : supportedLevels()) {
+                SimdKernelTable table = SimdKernels::tableFor(level);
+                StickStats actual = start;
+                table.stickStats(samples->data() + 2, samples->size() / 2 - 1, window, actual);
+                if (!sameStickStats(actual, expected)) {
+                    std::cerr << table.stickStatsVariant << " window " << window << "\n";
+                }
+                ASSERT_TRUE(sameStickStats(actual, expected));
+            }
+        }
+    }
+
+    SHORT xy[6] = {-32768, 100, 300, -200, 20000, 20000};
+    StickStats stats;
+    SimdVariants::stickStatsScalar(xy, 3, 1000, stats);
+    ASSERT_EQ(stats.extents[1], 32768);     // -x of -32768 does not wrap
+    ASSERT_EQ(stats.extents[4], 40000);     // x+y on the diagonal
+    ASSERT_EQ(stats.extents[3], 200);
+    ASSERT_EQ(stats.restCount, 1u);
+    ASSERT_EQ(stats.restSumX, 300);
+    ASSERT_EQ(stats.restSumY, -200);
+}
+
+TEST(SelectCapsAtSupportedLevel) {
+    ASSERT_TRUE(SimdKernels::select(SimdLevel::SCALAR) == SimdLevel::SCALAR);
+    ASSERT_EQ(SimdKernels::describe(), std::string("deadzone=scalar buttons=scalar dedup=scalar"));
+
+    ASSERT_TRUE(SimdKernels::select(SimdLevel::AVX512) == SimdKernels::supportedLevel());
+    if (SimdKernels::supportedLevel() >= SimdLevel::SSE41) {
+        ASSERT_TRUE(SimdKernels::describe() != "deadzone=scalar buttons=scalar dedup=scalar");
+    }
+
+    SimdLevel level = SimdLevel::SCALAR;
+    ASSERT_TRUE(SimdKernels::parseLevel("auto", level) && level == SimdLevel::AVX512);
+    ASSERT_TRUE(SimdKernels::parseLevel("sse4.1", level) && level == SimdLevel::SSE41);
+    ASSERT_TRUE(SimdKernels::parseLevel("scalar", level) && level == SimdLevel::SCALAR);
+    ASSERT_TRUE(!SimdKernels::parseLevel("neon", level));
+}
+
+TEST(TranslationAgreesAcrossLevels) {
+    // 13 XInput controllers with the deadzone on: batches hit full vectors and tails
+    std::vector<ControllerState> inputs(13);
+    uint32_t seed = 7;
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        inputs[i].userId = static_cast<int>(i);
+        inputs[i].xinputState.dwPacketNumber = 1;
+        inputs[i].xinputState.Gamepad.wButtons = static_cast<WORD>(nextRandom(seed) & 0xF3F0);
+        inputs[i].xinputState.Gamepad.sThumbLX = static_cast<SHORT>(nextRandom(seed));
+        inputs[i].xinputState.Gamepad.sThumbLY = static_cast<SHORT>(nextRandom(seed));
+        inputs[i].xinputState.Gamepad.sThumbRX = static_cast<SHORT>(nextRandom(seed) % 6000);
+        inputs[i].xinputState.Gamepad.sThumbRY = static_cast<SHORT>(nextRandom(seed));
+    }
+
+    std::vector<TranslatedState> reference;
+    std::vector<TranslationLayer::DInputState> referenceDInput;
+    for (SimdLevel level : supportedLevels()) {
+        SimdKernels::select(level);
+        TranslationLayer layer;
+        layer.setStickDeadzoneEnabled(true);
+        layer.setLeftStickDeadzone(0.2f);
+        layer.setRightStickAntiDeadzone(0.1f);
+        std::vector<TranslatedState> states = layer.translate(inputs);
+        ASSERT_EQ(states.size(), inputs.size());
+
+        if (reference.empty()) {
+            reference = states;
+            for (const auto& state : states) referenceDInput.push_back(layer.translateToDInput(state));
+            continue;
+        }
+        for (size_t i = 0; i < states.size(); ++i) {
+            ASSERT_TRUE(std::memcmp(&states[i].gamepad, &reference[i].gamepad, sizeof(states[i].gamepad)) == 0);
+            TranslationLayer::DInputState dinput = layer.translateToDInput(states[i]);
+            ASSERT_TRUE(std::memcmp(dinput.rgbButtons, referenceDInput[i].rgbButtons, sizeof(dinput.rgbButtons)) == 0);
+        }
+    }
+    SimdKernels::select(SimdLevel::AVX512);
+}
+
+TEST(SelectWhileKernelsRun) {
+    // Readers always see one complete table, never fields of two levels
+    std::vector<SimdKernelTable> tables;
+    for (SimdLevel level : supportedLevels()) tables.push_back(SimdKernels::tableFor(level));
+    std::atomic<bool> done{false};
+    std::thread selector([&done] {
+        for (int i = 0; i < 20000; ++i) {
+            SimdKernels::select(i % 2 ? SimdLevel::SCALAR : SimdLevel::AVX512);
+        }
+        done = true;
+    });
+    size_t reads = 0;
+    while (!done || reads == 0) {
+        const SimdKernelTable& table = SimdKernels::active();
+        bool known = false;
+        for (const auto& candidate : tables) {
+            known = known || (table.radialDeadzone == candidate.radialDeadzone &&
+                              table.encodeDInputButtons == candidate.encodeDInputButtons &&
+                              table.sameGamepad == candidate.sameGamepad && table.stickStats == candidate.stickStats);
+        }
+        ASSERT_TRUE(known);
+        reads++;
+    }
+    selector.join();
+    SimdKernels::select(SimdLevel::AVX512);
+}
+
+int main() {
+    std::cout << "=== SIMD Kernel Tests ===\n";
+    std::cout << "CPU: " << CpuFeatures::describe() << ", supported level: "
+              << SimdKernels::levelName(SimdKernels::supportedLevel()) << "\n\n";
+
+    RUN_TEST(DeadzoneVariantsMatchScalar);
+    RUN_TEST(DeadzoneScalarMatchesReferenceBehaviour);
+    RUN_TEST(ButtonVariantsMatchScalarForEveryWord);
+    RUN_TEST(DedupVariantsMatchScalar);
+    RUN_TEST(StickStatsVariantsMatchScalar);
+    RUN_TEST(SelectCapsAtSupportedLevel);
+    RUN_TEST(SelectWhileKernelsRun);
+    RUN_TEST(TranslationAgreesAcrossLevels);
+
+    std::cout << "\n=== All tests PASSED ===\n";
+    return 0;
+}
@@ -0,0 +1,282 @@
+/**
+ * @file test_source_arbiter.cpp
+ * @brief Tests for XInput/HID freshest-source arbitration
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <vector>
+#include "../include/core/source_arbiter.hpp"
+
+#define TEST(name) void test_##name()
+#define RUN_TEST(name) do { \
+    std::cout << "Running " #name "..."; \
+    test_##name(); \
+    std::cout << " PASSED\n"; \
+} while(0)
+
+#define ASSERT_EQ(a, b) do { \
+    if ((a) != (b)) { \
+        std::cerr << "ASSERT_EQ failed: " << (a) << " != " << (b) << " at line " << __LINE__ << "\n"; \
+        assert(false); \
+    } \
+} while(0)
+
+#define ASSERT_TRUE(x) do { \
+    if (!(x)) { \
+        std::cerr << "ASSERT_TRUE failed at line " << __LINE__ << "\n"; \
+        assert(false); \
+    } \
+} while(0)
+
+#define ASSERT_FALSE(x) do { \
+    if (x) { \
+        std::cerr << "ASSERT_FALSE failed at line " << __LINE__ << "\n"; \
+        assert(false); \
+    } \
+} while(0)
+
+static constexpr int XINPUT = static_cast<int>(CaptureSource::XINPUT);
+static constexpr int HID = static_cast<int>(CaptureSource::HID);
+
+/**
+ * Fake dual-source backend: one physical pad whose state changes are seen by
+ * the XInput path and by the HID path after per-path latencies. The HID path
+ * encodes each state as an Xbox HID report so decoding is exercised as well.
+ */
+class FakeDualSourcePad {
+public:
+    struct Delivery {
+        uint64_t time;
+        CaptureSource source;
+        XINPUT_GAMEPAD gamepad;
+    };
+
+    void change(uint64_t time, const XINPUT_GAMEPAD& gamepad, uint64_t xinputLatency, uint64_t hidLatency) {
+        m_deliveries.push_back({time + xinputLatency, CaptureSource::XINPUT, gamepad});
+        m_deliveries.push_back({time + hidLatency, CaptureSource::HID, SourceArbiter::fromXboxHID(encodeHID(gamepad))});
+    }
+
+    // Feed both paths to the arbiter in arrival order, returning every forwarded state
+    std::vector<XINPUT_GAMEPAD> run(SourceArbiter& arbiter, int device = 0) {
+        std::stable_sort(m_deliveries.begin(), m_deliveries.end(),
+                         [](const Delivery& a, const Delivery& b) { return a.time < b.time; });
+        std::vector<XINPUT_GAMEPAD> forwarded;
+        for (const auto& delivery : m_deliveries) {
+            if (arbiter.submit(device, delivery.source, delivery.gamepad, delivery.time)) {
+                forwarded.push_back(arbiter.current(device));
+            }
+        }
+        return forwarded;
+    }
+
+    static ControllerState encodeHID(const XINPUT_GAMEPAD& g) {
+        static const WORD buttons[] = {
+            XINPUT_GAMEPAD_A, XINPUT_GAMEPAD_B, XINPUT_GAMEPAD_X, XINPUT_GAMEPAD_Y,
+            XINPUT_GAMEPAD_LEFT_SHOULDER, XINPUT_GAMEPAD_RIGHT_SHOULDER,
+            XINPUT_GAMEPAD_BACK, XINPUT_GAMEPAD_START,
+            XINPUT_GAMEPAD_LEFT_THUMB, XINPUT_GAMEPAD_RIGHT_THUMB,
+        };
+        ControllerState state{};
+        for (USAGE i = 0; i < 10; ++i) {
+            if (g.wButtons & buttons[i]) state.m_activeButtons.push_back(i + 1);
+        }
+        bool up = g.wButtons & XINPUT_GAMEPAD_DPAD_UP;
+        bool down = g.wButtons & XINPUT_GAMEPAD_DPAD_DOWN;
+        bool left = g.wButtons & XINPUT_GAMEPAD_DPAD_LEFT;
+        bool right = g.wButtons & XINPUT_GAMEPAD_DPAD_RIGHT;
+        LONG hat = 0;
+        if (up && right) hat = 2; else if (down && right) hat = 4;
+        else if (down && left) hat = 6; else if (up && left) hat = 8;
+        else if (up) hat = 1; else if (right) hat = 3; else if (down) hat = 5; else if (left) hat = 7;
+        state.m_hidValues[0x39] = hat;
+        state.m_hidValues[0x30] = g.sThumbLX + 32768;
+        state.m_hidValues[0x31] = 32767 - g.sThumbLY;
+        state.m_hidValues[0x33] = g.sThumbRX + 32768;
+        state.m_hidValues[0x34] = 32767 - g.sThumbRY;
+        state.m_hidValues[0x32] = 32768 + (static_cast<LONG>(g.bLeftTrigger) - g.bRightTrigger) * 128;
+        return state;
+    }
+
+private:
+    std::vector<Delivery> m_deliveries;
+};
+
+static XINPUT_GAMEPAD pad(WORD buttons, SHORT lx = 0, BYTE lt = 0, BYTE rt = 0) {
+    XINPUT_GAMEPAD g{};
+    g.wButtons = buttons;
+    g.sThumbLX = lx;
+    g.bLeftTrigger = lt;
+    g.bRightTrigger = rt;
+    return g;
+}
+
+TEST(DecodesXboxHIDCollection) {
+    XINPUT_GAMEPAD g{};
+    g.wButtons = XINPUT_GAMEPAD_A | XINPUT_GAMEPAD_START | XINPUT_GAMEPAD_RIGHT_THUMB |
+                 XINPUT_GAMEPAD_DPAD_DOWN | XINPUT_GAMEPAD_DPAD_LEFT;
+    g.sThumbLX = -32768;
+    g.sThumbLY = 32767;
+    g.sThumbRX = 1234;
+    g.sThumbRY = -20000;
+    g.bRightTrigger = 200;
+
+    XINPUT_GAMEPAD decoded = SourceArbiter::fromXboxHID(FakeDualSourcePad::encodeHID(g));
+    ASSERT_EQ(decoded.wButtons, g.wButtons);
+    ASSERT_EQ(decoded.sThumbLX, g.sThumbLX);
+    ASSERT_EQ(decoded.sThumbLY, g.sThumbLY);
+    ASSERT_EQ(decoded.sThumbRX, g.sThumbRX);
+    ASSERT_EQ(decoded.sThumbRY, g.sThumbRY);
+    ASSERT_EQ(decoded.bLeftTrigger, 0);
+    ASSERT_EQ(decoded.bRightTrigger, 200);
+
+    // Nothing reported: centered sticks and triggers
+    XINPUT_GAMEPAD idle = SourceArbiter::fromXboxHID(ControllerState{});
+    ASSERT_EQ(idle.wButtons, 0);
+    ASSERT_EQ(idle.sThumbLX, 0);
+    ASSERT_EQ(idle.sThumbLY, 0);
+    ASSERT_EQ(idle.bLeftTrigger, 0);
+}
+
+TEST(FasterHIDWinsAndXInputConfirms) {
+    FakeDualSourcePad fake;
+    fake.change(1000, pad(XINPUT_GAMEPAD_A), 4000, 1000);
+    fake.change(20000, pad(0), 4000, 1000);
+    fake.change(40000, pad(XINPUT_GAMEPAD_B, 16000), 4000, 1000);
+
+    SourceArbiter arbiter;
+    auto forwarded = fake.run(arbiter);
+    ASSERT_EQ(forwarded.size(), 3u);
+    ASSERT_EQ(forwarded[0].wButtons, XINPUT_GAMEPAD_A);
+    ASSERT_EQ(forwarded[1].wButtons, 0);
+    ASSERT_EQ(forwarded[2].wButtons, XINPUT_GAMEPAD_B);
+    ASSERT_EQ(forwarded[2].sThumbLX, 16000);
+
+    const auto& metrics = arbiter.getMetrics(0);
+    ASSERT_EQ(metrics.wins[HID], 3u);
+    ASSERT_EQ(metrics.wins[XINPUT], 0u);
+    ASSERT_EQ(metrics.confirmed[HID], 3u);
+    ASSERT_EQ(metrics.averageLeadTicks(CaptureSource::HID), 3000u);
+    ASSERT_EQ(metrics.maxLeadTicks[HID], 3000u);
+    ASSERT_TRUE(arbiter.lastWinner(0) == CaptureSource::HID);
+}
+
+TEST(FasterXInputWins) {
+    FakeDualSourcePad fake;
+    fake.change(0, pad(XINPUT_GAMEPAD_X), 500, 2500);
+    fake.change(10000, pad(0), 500, 2500);
+
+    SourceArbiter arbiter;
+    auto forwarded = fake.run(arbiter);
+    ASSERT_EQ(forwarded.size(), 2u);
+    const auto& metrics = arbiter.getMetrics(0);
+    ASSERT_EQ(metrics.wins[XINPUT], 2u);
+    ASSERT_EQ(metrics.wins[HID], 0u);
+    ASSERT_EQ(metrics.averageLeadTicks(CaptureSource::XINPUT), 2000u);
+}
+
+TEST(QuickTapIsNotReplayed) {
+    // Press and release both land on HID before XInput has seen the press
+    FakeDualSourcePad fake;
+    fake.change(0, pad(XINPUT_GAMEPAD_A), 5000, 500);
+    fake.change(2000, pad(0), 5000, 500);
+
+    SourceArbiter arbiter;
+    auto forwarded = fake.run(arbiter);
+    ASSERT_EQ(forwarded.size(), 2u);
+    ASSERT_EQ(forwarded[0].wButtons, XINPUT_GAMEPAD_A);
+    ASSERT_EQ(forwarded[1].wButtons, 0);
+    ASSERT_EQ(arbiter.current(0).wButtons, 0);
+    ASSERT_EQ(arbiter.getMetrics(0).confirmed[HID], 2u);
+}
+
+TEST(SkippedStateIsDroppedFromPending) {
+    // XInput coalesces two HID changes into one packet; the skipped one is never confirmed
+    SourceArbiter arbiter;
+    ASSERT_TRUE(arbiter.submit(0, CaptureSource::HID, pad(XINPUT_GAMEPAD_A), 100));
+    ASSERT_TRUE(arbiter.submit(0, CaptureSource::HID, pad(XINPUT_GAMEPAD_A | XINPUT_GAMEPAD_B), 200));
+    ASSERT_FALSE(arbiter.submit(0, CaptureSource::XINPUT, pad(XINPUT_GAMEPAD_A | XINPUT_GAMEPAD_B), 900));
+
+    // A later genuine XInput-only change to the skipped state is forwarded, not eaten as an echo
+    ASSERT_TRUE(arbiter.submit(0, CaptureSource::XINPUT, pad(XINPUT_GAMEPAD_A), 2000));
+    ASSERT_EQ(arbiter.current(0).wButtons, XINPUT_GAMEPAD_A);
+    ASSERT_EQ(arbiter.getMetrics(0).confirmed[HID], 1u);
+    ASSERT_EQ(arbiter.getMetrics(0).maxLeadTicks[HID], 700u);
+}
+
+TEST(MixedLatencyFollowsFreshestPath) {
+    FakeDualSourcePad fake;
+    fake.change(0, pad(XINPUT_GAMEPAD_A), 300, 900);           // XInput first
+    fake.change(10000, pad(0), 900, 300);                      // HID first
+    fake.change(20000, pad(XINPUT_GAMEPAD_Y), 300, 900);       // XInput first
+    fake.change(30000, pad(XINPUT_GAMEPAD_Y, -8000), 900, 300); // HID first
+
+    SourceArbiter arbiter;
+    auto forwarded = fake.run(arbiter);
+    ASSERT_EQ(forwarded.size(), 4u);
+    ASSERT_EQ(forwarded[3].sThumbLX, -8000);
+    const auto& metrics = arbiter.getMetrics(0);
+    ASSERT_EQ(metrics.wins[XINPUT], 2u);
+    ASSERT_EQ(metrics.wins[HID], 2u);
+    ASSERT_EQ(metrics.confirmed[XINPUT] + metrics.confirmed[HID], 4u);
+}
+
+TEST(HIDWinKeepsXInputTriggersAndGuide) {
+    SourceArbiter arbiter;
+    // Both triggers half pressed plus Guide: HID sees a centered Z and no Guide
+    XINPUT_GAMEPAD xi = pad(0x0400, 0, 100, 100);
+    ASSERT_TRUE(arbiter.submit(0, CaptureSource::XINPUT, xi, 100));
+
+    XINPUT_GAMEPAD hid = SourceArbiter::fromXboxHID(FakeDualSourcePad::encodeHID(pad(XINPUT_GAMEPAD_A, 0, 100, 100)));
+    ASSERT_TRUE(arbiter.submit(0, CaptureSource::HID, hid, 200));
+    ASSERT_EQ(arbiter.current(0).wButtons, XINPUT_GAMEPAD_A | 0x0400);
+    ASSERT_EQ(arbiter.current(0).bLeftTrigger, 100);
+    ASSERT_EQ(arbiter.current(0).bRightTrigger, 100);
+}
+
+TEST(SingleSourceFallback) {
+    SourceArbiter arbiter;
+    ASSERT_TRUE(arbiter.submit(1, CaptureSource::XINPUT, pad(XINPUT_GAMEPAD_A), 100));
+    ASSERT_FALSE(arbiter.submit(1, CaptureSource::XINPUT, pad(XINPUT_GAMEPAD_A), 200)); // Repeat
+    ASSERT_TRUE(arbiter.submit(1, CaptureSource::XINPUT, pad(0), 300));
+    ASSERT_EQ(arbiter.getMetrics(1).wins[XINPUT], 2u);
+    ASSERT_EQ(arbiter.getMetrics(1).updates[XINPUT], 2u);
+    ASSERT_EQ(arbiter.getMetrics(0).wins[XINPUT], 0u); // Devices are independent
+}
+
+TEST(StaleUpdateIsNotForwarded) {
+    SourceArbiter arbiter;
+    ASSERT_TRUE(arbiter.submit(0, CaptureSource::HID, pad(XINPUT_GAMEPAD_A), 500));
+    ASSERT_FALSE(arbiter.submit(0, CaptureSource::XINPUT, pad(XINPUT_GAMEPAD_B), 400));
+    ASSERT_EQ(arbiter.current(0).wButtons, XINPUT_GAMEPAD_A);
+    ASSERT_EQ(arbiter.getMetrics(0).stale[XINPUT], 1u);
+}
+
+TEST(ResetForgetsHistory) {
+    SourceArbiter arbiter;
+    arbiter.submit(0, CaptureSource::HID, pad(XINPUT_GAMEPAD_A), 500);
+    arbiter.reset(0);
+    ASSERT_EQ(arbiter.current(0).wButtons, 0);
+    ASSERT_EQ(arbiter.getMetrics(0).wins[HID], 0u);
+    ASSERT_TRUE(arbiter.submit(0, CaptureSource::XINPUT, pad(XINPUT_GAMEPAD_A), 10));
+    ASSERT_FALSE(arbiter.submit(9, CaptureSource::XINPUT, pad(XINPUT_GAMEPAD_A), 10)); // Out of range
+}
+
+int main() {
+    std::cout << "=== Source Arbiter Tests ===\n\n";
+
+    RUN_TEST(DecodesXboxHIDCollection);
+    RUN_TEST(FasterHIDWinsAndXInputConfirms);
+    RUN_TEST(FasterXInputWins);
+    RUN_TEST(QuickTapIsNotReplayed);
+    RUN_TEST(SkippedStateIsDroppedFromPending);
+    RUN_TEST(MixedLatencyFollowsFreshestPath);
+    RUN_TEST(HIDWinKeepsXInputTriggersAndGuide);
+    RUN_TEST(SingleSourceFallback);
+    RUN_TEST(StaleUpdateIsNotForwarded);
+    RUN_TEST(ResetForgetsHistory);
+
+    std::cout << "\n=== All tests PASSED ===\n";
+    return 0;
+}
@@ -0,0 +1,420 @@
+/**
+ * @file test_state_stream.cpp
+ * @brief Tests for controller state streaming (codec and UDP over loopback)
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "../include/core/state_stream.hpp"
+#include "../include/utils/timing.hpp"
+
+#define TEST(name) void test_##name()
+#define RUN_TEST(name) do { \
+    std::cout << "Running " #name "..."; \
+    test_##name(); \
+    std::cout << " PASSED\n"; \
+} while(0)
+
+#define ASSERT_EQ(a, b) do { \
+    if ((a) != (b)) { \
+        std::cerr << "ASSERT_EQ failed: " << (a) << " != " << (b) << " at line " << __LINE__ << "\n"; \
+        assert(false); \
+    } \
+} while(0)
+
+#define ASSERT_TRUE(x) do { \
+    if (!(x)) { \
+        std::cerr << "ASSERT_TRUE failed at line " << __LINE__ << "\n"; \
+        assert(false); \
+    } \
+} while(0)
+
+using Result = StateStreamDecoder::Result;
+
+static TranslatedState makeState(int userId, TranslatedState::TargetType type, WORD buttons, SHORT lx) {
+    TranslatedState state{};
+    state.sourceUserId = userId;
+    state.isXInputSource = userId >= 0;
+    state.targetType = type;
+    state.gamepad.wButtons = buttons;
+    state.gamepad.sThumbLX = lx;
+    state.gamepad.sThumbRY = -1234;
+    state.gamepad.bRightTrigger = 77;
+    return state;
+}
+
+static std::vector<TranslatedState> twoControllers(WORD buttons, SHORT lx) {
+    return {makeState(0, TranslatedState::TARGET_DINPUT, XINPUT_GAMEPAD_A, 100),
+            makeState(-1, TranslatedState::TARGET_XINPUT, buttons, lx)};
+}
+
+static Result decode(StateStreamDecoder& decoder, const std::vector<uint8_t>& datagram,
+                     StateStreamDecoder::Frame& frame) {
+    return decoder.decode(datagram.data(), datagram.size(), frame);
+}
+
+static uint64_t nowUs() {
+    return static_cast<uint64_t>(TimingUtils::counterToMicroseconds(TimingUtils::getPerformanceCounter()));
+}
+
+TEST(KeyframeRoundTrip) {
+    StateStreamEncoder encoder(50000, 7);
+    StateStreamDecoder decoder;
+    std::vector<uint8_t> datagram;
+    ASSERT_TRUE(encoder.encode(twoControllers(XINPUT_GAMEPAD_B, -32768), 1000, datagram));
+    ASSERT_EQ(datagram.size(), StateStreamEncoder::HEADER_SIZE + 2 * 17);
+
+    StateStreamDecoder::Frame frame;
+    ASSERT_TRUE(decode(decoder, datagram, frame) == Result::APPLIED);
+    ASSERT_TRUE(frame.keyframe);
+    ASSERT_EQ(frame.session, 7u);
+    ASSERT_EQ(frame.sequence, 1u);
+    ASSERT_EQ(frame.timestampUs, 1000u);
+    ASSERT_EQ(frame.states.size(), 2u);
+
+    const TranslatedState& ds4 = frame.states[0];
+    ASSERT_EQ(ds4.sourceUserId, 0);
+    ASSERT_EQ(ds4.sourceSlot, 0);
+    ASSERT_TRUE(ds4.isXInputSource);
+    ASSERT_TRUE(ds4.targetType == TranslatedState::TARGET_DINPUT);
+    ASSERT_EQ(ds4.gamepad.wButtons, XINPUT_GAMEPAD_A);
+    ASSERT_EQ(ds4.gamepad.sThumbLX, 100);
+    ASSERT_EQ(ds4.gamepad.sThumbRY, -1234);
+    ASSERT_EQ(ds4.gamepad.bRightTrigger, 77);
+
+    const TranslatedState& hid = frame.states[1];
+    ASSERT_EQ(hid.sourceUserId, -1);
+    ASSERT_EQ(hid.sourceSlot, 1);
+    ASSERT_TRUE(!hid.isXInputSource);
+    ASSERT_TRUE(hid.targetType == TranslatedState::TARGET_XINPUT);
+    ASSERT_EQ(hid.gamepad.sThumbLX, -32768);
+}
+
+TEST(DeltasCarryOnlyChangedFields) {
+    StateStreamEncoder encoder;
+    StateStreamDecoder decoder;
+    StateStreamDecoder::Frame frame;
+    std::vector<uint8_t> datagram;
+    ASSERT_TRUE(encoder.encode(twoControllers(0, 0), 1000, datagram));
+    ASSERT_TRUE(decode(decoder, datagram, frame) == Result::APPLIED);
+
+    // Same frame again: nothing to send
+    ASSERT_TRUE(!encoder.encode(twoControllers(0, 0), 2000, datagram));
+    ASSERT_TRUE(datagram.empty());
+
+    // One stick moved on slot 1: slot, mask and one axis
+    ASSERT_TRUE(encoder.encode(twoControllers(0, 5000), 3000, datagram));
+    ASSERT_EQ(datagram.size(), StateStreamEncoder::HEADER_SIZE + 4);
+    ASSERT_TRUE(decode(decoder, datagram, frame) == Result::APPLIED);
+    ASSERT_TRUE(!frame.keyframe);
+    ASSERT_EQ(frame.states.size(), 2u);
+    ASSERT_EQ(frame.states[1].gamepad.sThumbLX, 5000);
+    ASSERT_EQ(frame.states[0].gamepad.sThumbLX, 100);
+
+    // Deltas are against the keyframe, not the previous frame: a button on top
+    // of the moved stick carries both
+    ASSERT_TRUE(encoder.encode(twoControllers(XINPUT_GAMEPAD_X, 5000), 4000, datagram));
+    ASSERT_EQ(datagram.size(), StateStreamEncoder::HEADER_SIZE + 6);
+    ASSERT_TRUE(decode(decoder, datagram, frame) == Result::APPLIED);
+    ASSERT_EQ(frame.states[1].gamepad.wButtons, XINPUT_GAMEPAD_X);
+    ASSERT_EQ(frame.states[1].gamepad.sThumbLX, 5000);
+
+    // Back to the keyframe's values: an empty delta still goes out
+    ASSERT_TRUE(encoder.encode(twoControllers(0, 0), 5000, datagram));
+    ASSERT_EQ(datagram.size(), StateStreamEncoder::HEADER_SIZE);
+    ASSERT_TRUE(decode(decoder, datagram, frame) == Result::APPLIED);
+    ASSERT_EQ(frame.states[1].gamepad.wButtons, 0);
+}
+
+TEST(KeyframesOnIntervalAndControllerChanges) {
+    StateStreamEncoder encoder(10000);
+    StateStreamDecoder decoder;
+    StateStreamDecoder::Frame frame;
+    std::vector<uint8_t> datagram;
+    ASSERT_TRUE(encoder.encode(twoControllers(0, 0), 0, datagram));
+    ASSERT_TRUE(encoder.encode(twoControllers(0, 1), 5000, datagram));
+    ASSERT_TRUE(decode(decoder, datagram, frame) == Result::NO_KEYFRAME);
+
+    // Interval elapsed: a keyframe even though nothing changed
+    ASSERT_TRUE(encoder.encode(twoControllers(0, 1), 10000, datagram));
+    ASSERT_TRUE(decode(decoder, datagram, frame) == Result::APPLIED);
+    ASSERT_TRUE(frame.keyframe);
+
+    // A controller left
+    std::vector<TranslatedState> one = twoControllers(0, 1);
+    one.pop_back();
+    ASSERT_TRUE(encoder.encode(one, 11000, datagram));
+    ASSERT_TRUE(decode(decoder, datagram, frame) == Result::APPLIED);
+    ASSERT_TRUE(frame.keyframe);
+    ASSERT_EQ(frame.states.size(), 1u);
+
+    // Same count, different controller
+    std::vector<TranslatedState> other = {makeState(2, TranslatedState::TARGET_DINPUT, XINPUT_GAMEPAD_A, 100)};
+    ASSERT_TRUE(encoder.encode(other, 12000, datagram));
+    ASSERT_TRUE(decode(decoder, datagram, frame) == Result::APPLIED);
+    ASSERT_TRUE(frame.keyframe);
+    ASSERT_EQ(frame.states[0].sourceUserId, 2);
+
+    encoder.forceKeyframe();
+    ASSERT_TRUE(encoder.encode(other, 13000, datagram));
+    ASSERT_TRUE(decode(decoder, datagram, frame) == Result::APPLIED);
+    ASSERT_TRUE(frame.keyframe);
+}
+
+TEST(LatestWinsAndLossIsCounted) {
+    StateStreamEncoder encoder;
+    std::vector<std::vector<uint8_t>> datagrams(5);
+    for (size_t i = 0; i < datagrams.size(); ++i) {
+        ASSERT_TRUE(encoder.encode(twoControllers(0, static_cast<SHORT>(i)), 1000 * i, datagrams[i]));
+    }
+
+    StateStreamDecoder decoder;
+    StateStreamDecoder::Frame frame;
+    ASSERT_TRUE(decode(decoder, datagrams[0], frame) == Result::APPLIED);
+    ASSERT_TRUE(decode(decoder, datagrams[2], frame) == Result::APPLIED);
+    ASSERT_TRUE(decode(decoder, datagrams[1], frame) == Result::STALE);    // Reordered
+    ASSERT_TRUE(decode(decoder, datagrams[2], frame) == Result::STALE);    // Duplicated
+    ASSERT_EQ(frame.states[1].gamepad.sThumbLX, 2);
+    ASSERT_TRUE(decode(decoder, datagrams[4], frame) == Result::APPLIED);
+    ASSERT_EQ(frame.states[1].gamepad.sThumbLX, 4);
+
+    StateStreamDecoder::Stats stats = decoder.getStats();
+    ASSERT_EQ(stats.applied, 3u);
+    ASSERT_EQ(stats.stale, 2u);
+    ASSERT_EQ(stats.lost, 2u);
+    ASSERT_EQ(stats.keyframes, 1u);
+}
+
+TEST(LostKeyframeRecoversOnNext) {
+    StateStreamEncoder encoder;
+    std::vector<uint8_t> keyframe, delta, nextKeyframe, nextDelta;
+    ASSERT_TRUE(encoder.encode(twoControllers(0, 0), 0, keyframe));
+    ASSERT_TRUE(encoder.encode(twoControllers(0, 1), 1000, delta));
+    encoder.forceKeyframe();
+    ASSERT_TRUE(encoder.encode(twoControllers(0, 2), 2000, nextKeyframe));
+    ASSERT_TRUE(encoder.encode(twoControllers(0, 3), 3000, nextDelta));
+
+    StateStreamDecoder decoder;
+    StateStreamDecoder::Frame frame;
+    ASSERT_TRUE(decode(decoder, delta, frame) == Result::NO_KEYFRAME);
+    ASSERT_TRUE(decode(decoder, nextKeyframe, frame) == Result::APPLIED);
+    ASSERT_TRUE(decode(decoder, nextDelta, frame) == Result::APPLIED);
+    ASSERT_EQ(frame.states[1].gamepad.sThumbLX, 3);
+    ASSERT_TRUE(decode(decoder, keyframe, frame) == Result::STALE);   // Late arrival
+    ASSERT_EQ(decoder.getStats().noKeyframe, 1u);
+}
+
+TEST(NewSessionResets) {
+    StateStreamEncoder first(50000, 1);
+    StateStreamDecoder decoder;
+    StateStreamDecoder::Frame frame;
+    std::vector<uint8_t> datagram;
+    for (SHORT x = 0; x < 10; ++x) {
+        ASSERT_TRUE(first.encode(twoControllers(0, x), 1000 * x, datagram));
+        ASSERT_TRUE(decode(decoder, datagram, frame) == Result::APPLIED);
+    }
+
+    // Restarted sender: its sequence starts over at 1
+    StateStreamEncoder restarted(50000, 2);
+    ASSERT_TRUE(restarted.encode(twoControllers(XINPUT_GAMEPAD_Y, 0), 0, datagram));
+    ASSERT_TRUE(decode(decoder, datagram, frame) == Result::APPLIED);
+    ASSERT_EQ(frame.sequence, 1u);
+    ASSERT_EQ(frame.states[1].gamepad.wButtons, XINPUT_GAMEPAD_Y);
+    ASSERT_EQ(decoder.getStats().sessions, 2u);
+    ASSERT_EQ(decoder.getStats().lost, 0u);
+}
+
+TEST(MalformedNewSessionKeepsLiveSession) {
+    StateStreamEncoder live(50000, 1);
+    StateStreamDecoder decoder;
+    StateStreamDecoder::Frame frame;
+    std::vector<uint8_t> keyframe, delta;
+    ASSERT_TRUE(live.encode(twoControllers(0, 0), 0, keyframe));
+    ASSERT_TRUE(live.encode(twoControllers(0, 1), 1000, delta));
+    ASSERT_TRUE(decode(decoder, keyframe, frame) == Result::APPLIED);
+
+    // Valid header of another session, body cut short
+    StateStreamEncoder other(50000, 2);
+    std::vector<uint8_t> garbage;
+    ASSERT_TRUE(other.encode(twoControllers(XINPUT_GAMEPAD_Y, 0), 0, garbage));
+    garbage.resize(StateStreamEncoder::HEADER_SIZE + 3);
+    ASSERT_TRUE(decode(decoder, garbage, frame) == Result::MALFORMED);
+
+    // The live keyframe still decodes its deltas
+    ASSERT_TRUE(decode(decoder, delta, frame) == Result::APPLIED);
+    ASSERT_EQ(frame.session, 1u);
+    ASSERT_EQ(frame.states[1].gamepad.sThumbLX, 1);
+    ASSERT_EQ(decoder.getStats().sessions, 1u);
+}
+
+TEST(RejectsMalformedDatagrams) {
+    StateStreamEncoder encoder;
+    StateStreamDecoder decoder;
+    StateStreamDecoder::Frame frame;
+    std::vector<uint8_t> keyframe, delta;
+    ASSERT_TRUE(encoder.encode(twoControllers(0, 0), 0, keyframe));
+    ASSERT_TRUE(encoder.encode(twoControllers(0, 1), 1000, delta));
+
+    std::vector<uint8_t> bad = keyframe;
+    bad[0] = 'Y';
+    ASSERT_TRUE(decode(decoder, bad, frame) == Result::MALFORMED);
+    bad = keyframe;
+    bad.resize(bad.size() - 1);
+    ASSERT_TRUE(decode(decoder, bad, frame) == Result::MALFORMED);
+    bad = keyframe;
+    bad.push_back(0);
+    ASSERT_TRUE(decode(decoder, bad, frame) == Result::MALFORMED);
+    ASSERT_TRUE(decoder.decode(keyframe.data(), 10, frame) == Result::MALFORMED);
+
+    ASSERT_TRUE(decode(decoder, keyframe, frame) == Result::APPLIED);
+    bad = delta;
+    bad[StateStreamEncoder::HEADER_SIZE] = 9;    // Slot the keyframe doesn't have
+    ASSERT_TRUE(decode(decoder, bad, frame) == Result::MALFORMED);
+    ASSERT_TRUE(decode(decoder, delta, frame) == Result::APPLIED);
+    ASSERT_EQ(decoder.getStats().malformed, 5u);
+}
+
+TEST(LoopbackDeliversNewestOfBurst) {
+    UdpStreamReceiver receiver;
+    ASSERT_TRUE(receiver.open(0, "127.0.0.1"));
+    ASSERT_TRUE(receiver.getPort() != 0);
+    std::vector<StateStreamDecoder::Frame> frames;
+    receiver.setFrameCallback([&](const StateStreamDecoder::Frame& frame) { frames.push_back(frame); });
+
+    UdpStreamSender sender;
+    ASSERT_TRUE(sender.open("127.0.0.1", receiver.getPort()));
+    for (SHORT x = 1; x <= 5; ++x) {
+        ASSERT_TRUE(sender.send(twoControllers(0, x), static_cast<uint64_t>(x) * 1000));
+    }
+    ASSERT_TRUE(sender.send(twoControllers(0, 5), 6000));    // Unchanged: skipped
+
+    // Everything queued is drained in one poll; only the newest reaches the callback
+    size_t datagrams = 0;
+    for (int i = 0; i < 100 && datagrams < 5; ++i) {
+        datagrams += receiver.poll(10);
+    }
+    ASSERT_EQ(datagrams, 5u);
+    ASSERT_TRUE(!frames.empty());
+    ASSERT_EQ(frames.back().states[1].gamepad.sThumbLX, 5);
+    ASSERT_EQ(frames.back().sequence, 5u);
+
+    UdpStreamReceiver::Stats stats = receiver.getStats();
+    ASSERT_EQ(stats.delivered, static_cast<uint64_t>(frames.size()));
+    ASSERT_EQ(stats.delivered + stats.superseded, 5u);
+    ASSERT_EQ(stats.decoder.lost, 0u);
+
+    UdpStreamSender::Stats sent = sender.getStats();
+    ASSERT_EQ(sent.frames, 6u);
+    ASSERT_EQ(sent.datagrams, 5u);
+    ASSERT_EQ(sent.skipped, 1u);
+    ASSERT_EQ(sent.bytes, stats.bytes);
+}
+
+TEST(ReceiverThreadStreamsFrames) {
+    TimingUtils::initialize();
+    UdpStreamReceiver receiver;
+    ASSERT_TRUE(receiver.open(0, "127.0.0.1"));
+    std::mutex mutex;
+    std::vector<uint64_t> latencies;
+    SHORT lastX = 0;
+    receiver.setFrameCallback([&](const StateStreamDecoder::Frame& frame) {
+        std::lock_guard<std::mutex> lock(mutex);
+        latencies.push_back(nowUs() - frame.timestampUs);
+        lastX = frame.states[1].gamepad.sThumbLX;
+    });
+    receiver.start();
+    ASSERT_TRUE(receiver.isRunning());
+
+    UdpStreamSender sender;
+    ASSERT_TRUE(sender.open("127.0.0.1", receiver.getPort()));
+    const SHORT frames = 200;
+    for (SHORT x = 1; x <= frames; ++x) {
+        ASSERT_TRUE(sender.send(twoControllers(0, x), nowUs()));
+        std::this_thread::sleep_for(std::chrono::microseconds(500));
+    }
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (std::chrono::steady_clock::now() < deadline) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (lastX == frames) break;
+    }
+    receiver.stop();
+    ASSERT_TRUE(!receiver.isRunning());
+
+    std::lock_guard<std::mutex> lock(mutex);
+    ASSERT_EQ(lastX, frames);
+    std::sort(latencies.begin(), latencies.end());
+    std::cout << " [loopback p50 " << latencies[latencies.size() / 2] << " us, max " << latencies.back() << " us]";
+}
+
+TEST(LostKeyframeIsRequestedFromSender) {
+    UdpStreamReceiver receiver;
+    ASSERT_TRUE(receiver.open(0, "127.0.0.1"));
+    std::vector<StateStreamDecoder::Frame> frames;
+    receiver.setFrameCallback([&](const StateStreamDecoder::Frame& frame) { frames.push_back(frame); });
+    auto drain = [&](size_t expected) {
+        size_t datagrams = 0;
+        for (int i = 0; i < 100 && datagrams < expected; ++i) {
+            datagrams += receiver.poll(10);
+        }
+        return datagrams;
+    };
+
+    // Only a documentation-range host is allowed, so the opening keyframe is dropped
+    ASSERT_TRUE(receiver.setAllowedPeer("192.0.2.1"));
+    UdpStreamSender sender;
+    ASSERT_TRUE(sender.open("127.0.0.1", receiver.getPort()));
+    ASSERT_TRUE(sender.send(twoControllers(0, 1), 1000));
+    ASSERT_EQ(drain(1), 1u);
+    ASSERT_TRUE(frames.empty());
+    ASSERT_EQ(receiver.getStats().rejected, 1u);
+
+    // Deltas naming the lost keyframe: one request for the whole gap
+    ASSERT_TRUE(receiver.setAllowedPeer("127.0.0.1"));
+    ASSERT_TRUE(sender.send(twoControllers(0, 2), 2000));
+    ASSERT_TRUE(sender.send(twoControllers(XINPUT_GAMEPAD_A, 2), 3000));
+    ASSERT_EQ(drain(2), 2u);
+    ASSERT_TRUE(frames.empty());
+    UdpStreamReceiver::Stats stats = receiver.getStats();
+    ASSERT_EQ(stats.decoder.noKeyframe, 2u);
+    ASSERT_EQ(stats.keyframeRequests, 1u);
+
+    // Well inside the keyframe interval, yet the next frame is a keyframe
+    ASSERT_TRUE(sender.send(twoControllers(XINPUT_GAMEPAD_A, 3), 4000));
+    ASSERT_EQ(sender.getStats().keyframeRequests, 1u);
+    ASSERT_EQ(drain(1), 1u);
+    ASSERT_EQ(frames.size(), 1u);
+    ASSERT_TRUE(frames.back().keyframe);
+    ASSERT_EQ(frames.back().states[1].gamepad.sThumbLX, 3);
+
+    // Requests for another session are ignored
+    std::vector<uint8_t> request;
+    StateStreamDecoder::encodeKeyframeRequest(1234, request);
+    ASSERT_TRUE(StateStreamDecoder::isKeyframeRequest(request.data(), request.size(), 1234));
+    ASSERT_TRUE(!StateStreamDecoder::isKeyframeRequest(request.data(), request.size(), 1235));
+    ASSERT_TRUE(!StateStreamDecoder::isKeyframeRequest(request.data(), request.size() - 1, 1234));
+}
+
+int main() {
+    std::cout << "=== State Stream Tests ===\n\n";
+
+    RUN_TEST(KeyframeRoundTrip);
+    RUN_TEST(DeltasCarryOnlyChangedFields);
+    RUN_TEST(KeyframesOnIntervalAndControllerChanges);
+    RUN_TEST(LatestWinsAndLossIsCounted);
+    RUN_TEST(LostKeyframeRecoversOnNext);
+    RUN_TEST(NewSessionResets);
+    RUN_TEST(MalformedNewSessionKeepsLiveSession);
+    RUN_TEST(RejectsMalformedDatagrams);
+    RUN_TEST(LoopbackDeliversNewestOfBurst);
+    RUN_TEST(ReceiverThreadStreamsFrames);
+    RUN_TEST(LostKeyframeIsRequestedFromSender);
+
+    std::cout << "\n=== All tests PASSED ===\n";
+    return 0;
+}
@@ -0,0 +1,261 @@
+/**
+ * @file test_target_health.cpp
+ * @brief Tests for virtual target health, bounded retry and re-plug backoff
+ */
+
+#include <cassert>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <set>
+#include <vector>
+#include "../include/core/target_health.hpp"
+
+#define TEST(name) void test_##name()
+#define RUN_TEST(name) do { \
+    std::cout << "Running " #name "..."; \
+    test_##name(); \
+    std::cout << " PASSED\n"; \
+} while(0)
+
+#define ASSERT_EQ(a, b) do { \
+    if ((a) != (b)) { \
+        std::cerr << "ASSERT_EQ failed: " << (a) << " != " << (b) << " at line " << __LINE__ << "\n"; \
+        assert(false); \
+    } \
+} while(0)
+
+#define ASSERT_TRUE(x) do { \
+    if (!(x)) { \
+        std::cerr << "ASSERT_TRUE failed at line " << __LINE__ << "\n"; \
+        assert(false); \
+    } \
+} while(0)
+
+using Health = TargetHealthMonitor::Health;
+
+/**
+ * Mock bus: submits fail while a target is broken or has failures queued;
+ * a re-plug repairs the target unless re-plugs are set to fail too.
+ */
+struct MockBus : VirtualBus {
+    std::set<int> broken;              // Targets whose submits fail until re-plugged
+    std::map<int, int> failNext;       // Transient failures still to inject
+    bool replugFails = false;
+    std::map<int, std::vector<TranslatedState>> delivered;
+    std::vector<uint64_t> replugTimes;
+    uint64_t now = 0;
+    size_t submitCalls = 0;
+    size_t replugCalls = 0;
+    std::function<void(int)> afterDelivery;   // Runs once after the next delivered report
+
+    bool submit(int targetId, const TranslatedState& state) override {
+        submitCalls++;
+        if (broken.count(targetId)) return false;
+        if (failNext[targetId] > 0) {
+            failNext[targetId]--;
+            return false;
+        }
+        delivered[targetId].push_back(state);
+        if (afterDelivery) {
+            auto hook = std::move(afterDelivery);
+            afterDelivery = nullptr;
+            hook(targetId);
+        }
+        return true;
+    }
+
+    bool replug(int targetId) override {
+        replugCalls++;
+        replugTimes.push_back(now);
+        if (replugFails) return false;
+        broken.erase(targetId);
+        return true;
+    }
+};
+
+static TranslatedState makeState(SHORT lx) {
+    TranslatedState state{};
+    state.targetType = TranslatedState::TARGET_XINPUT;
+    state.gamepad.sThumbLX = lx;
+    return state;
+}
+
+TEST(TransientFailureIsRetried) {
+    TargetHealthMonitor monitor;
+    MockBus bus;
+    monitor.track(0);
+
+    ASSERT_TRUE(monitor.submit(bus, 0, makeState(1), 0));
+    bus.failNext[0] = 1;
+    ASSERT_TRUE(!monitor.submit(bus, 0, makeState(2), 1000));
+    ASSERT_TRUE(monitor.health(0) == Health::DEGRADED);
+    ASSERT_EQ(monitor.nextServiceUs(), 1000u + TargetHealthMonitor::Policy{}.retryDelayUs);
+
+    // Not before the retry delay: a transient error gets time to clear
+    monitor.service(bus, 1100);
+    ASSERT_EQ(bus.delivered[0].size(), 1u);
+
+    // The injection thread resends the failed report once the bus recovers
+    monitor.service(bus, monitor.nextServiceUs());
+    ASSERT_TRUE(monitor.health(0) == Health::HEALTHY);
+    ASSERT_EQ(bus.delivered[0].size(), 2u);
+    ASSERT_EQ(bus.delivered[0].back().gamepad.sThumbLX, 2);
+    ASSERT_EQ(monitor.nextServiceUs(), UINT64_MAX);
+
+    TargetHealthMonitor::Metrics metrics = monitor.getMetrics(0);
+    ASSERT_EQ(metrics.submits, 2u);
+    ASSERT_EQ(metrics.failures, 1u);
+    ASSERT_EQ(metrics.retries, 1u);
+    ASSERT_EQ(metrics.reconnectAttempts, 0u);
+}
+
+TEST(RetriesAreBounded) {
+    TargetHealthMonitor monitor;
+    TargetHealthMonitor::Policy policy;
+    policy.failuresToReconnect = 100;   // Keep the target degraded
+    policy.maxRetries = 2;
+    monitor.setPolicy(policy);
+    MockBus bus;
+    monitor.track(0);
+    bus.broken.insert(0);
+
+    ASSERT_TRUE(!monitor.submit(bus, 0, makeState(5), 0));
+    for (uint64_t t = 100; t < 10000; t += 100) {
+        monitor.service(bus, t);
+    }
+    ASSERT_EQ(bus.submitCalls, 3u);     // The submit plus two retries, then nothing
+    ASSERT_EQ(monitor.getMetrics(0).retries, 2u);
+    ASSERT_EQ(monitor.nextServiceUs(), UINT64_MAX);
+    ASSERT_TRUE(monitor.health(0) == Health::DEGRADED);
+}
+
+TEST(ReplugBacksOffThenGivesUp) {
+    TargetHealthMonitor monitor;
+    TargetHealthMonitor::Policy policy;
+    policy.failuresToReconnect = 3;
+    policy.maxReconnectAttempts = 6;
+    policy.initialBackoffUs = 50000;
+    policy.maxBackoffUs = 400000;
+    monitor.setPolicy(policy);
+    MockBus bus;
+    bus.replugFails = true;
+    monitor.track(0);
+    bus.broken.insert(0);
+
+    // A 1 kHz loop against a target that never comes back
+    size_t submitsWhileDown = 0;
+    for (uint64_t t = 0; t < 5000000; t += 1000) {
+        bus.now = t;
+        size_t before = bus.submitCalls;
+        monitor.submit(bus, 0, makeState(static_cast<SHORT>(t / 1000)), t);
+        monitor.service(bus, t);
+        if (monitor.health(0) != Health::HEALTHY && monitor.health(0) != Health::DEGRADED) {
+            submitsWhileDown += bus.submitCalls - before;
+        }
+    }
+
+    // Only the error budget reached the bus; nothing was submitted while down
+    ASSERT_EQ(submitsWhileDown, 1u);    // The third failure itself
+    ASSERT_TRUE(bus.submitCalls <= 3 + policy.failuresToReconnect * policy.maxRetries);
+
+    // Re-plugs at exponentially growing intervals, capped, then dead
+    ASSERT_EQ(bus.replugTimes.size(), 6u);
+    std::vector<uint64_t> gaps;
+    for (size_t i = 1; i < bus.replugTimes.size(); ++i) {
+        gaps.push_back(bus.replugTimes[i] - bus.replugTimes[i - 1]);
+    }
+    ASSERT_EQ(gaps[0], 100000u);
+    ASSERT_EQ(gaps[1], 200000u);
+    ASSERT_EQ(gaps[2], 400000u);
+    ASSERT_EQ(gaps[3], 400000u);
+    ASSERT_TRUE(monitor.health(0) == Health::DEAD);
+    ASSERT_EQ(monitor.nextServiceUs(), UINT64_MAX);
+
+    TargetHealthMonitor::Metrics metrics = monitor.getMetrics(0);
+    ASSERT_EQ(metrics.reconnectAttempts, 6u);
+    ASSERT_EQ(metrics.reconnects, 0u);
+    ASSERT_TRUE(metrics.skipped > 4900);
+
+    // Tracking again (physical device re-arrived) gives it a fresh budget
+    bus.replugFails = false;
+    bus.broken.clear();
+    monitor.track(0);
+    ASSERT_TRUE(monitor.submit(bus, 0, makeState(1), 6000000));
+    ASSERT_TRUE(monitor.health(0) == Health::HEALTHY);
+    ASSERT_EQ(monitor.getMetrics(0).reconnectAttempts, 6u); // Lifetime counters kept
+}
+
+TEST(ReplugRecoversAndResendsLatest) {
+    TargetHealthMonitor monitor;
+    MockBus bus;
+    monitor.track(0);
+    monitor.track(1);
+    bus.broken.insert(0);
+
+    uint64_t recoveredAt = 0;
+    for (uint64_t t = 0; t < 500000; t += 1000) {
+        bus.now = t;
+        monitor.submit(bus, 0, makeState(static_cast<SHORT>(t / 1000)), t);
+        monitor.submit(bus, 1, makeState(7), t);
+        monitor.service(bus, t);
+        if (!recoveredAt && monitor.getMetrics(0).reconnects == 1) {
+            recoveredAt = t;
+            // The fresh target got the newest report, not a stale one
+            ASSERT_EQ(bus.delivered[0].back().gamepad.sThumbLX, static_cast<SHORT>(t / 1000));
+        }
+    }
+
+    ASSERT_EQ(bus.replugCalls, 1u);
+    ASSERT_TRUE(recoveredAt >= 50000 && recoveredAt <= 53000);
+    ASSERT_TRUE(monitor.health(0) == Health::HEALTHY);
+    ASSERT_TRUE(monitor.getMetrics(0).skipped > 40);
+
+    // The healthy neighbour was never affected
+    TargetHealthMonitor::Metrics other = monitor.getMetrics(1);
+    ASSERT_EQ(other.failures, 0u);
+    ASSERT_EQ(other.submits, 500u);
+    ASSERT_EQ(bus.delivered[1].size(), 500u);
+
+    // Untracked targets are not submitted at all
+    monitor.untrack(1);
+    size_t before = bus.submitCalls;
+    ASSERT_TRUE(!monitor.submit(bus, 1, makeState(7), 600000));
+    ASSERT_EQ(bus.submitCalls, before);
+    ASSERT_EQ(monitor.trackedTargets().size(), 1u);
+}
+
+TEST(StaleRetryIsDropped) {
+    TargetHealthMonitor monitor;
+    MockBus bus;
+    monitor.track(0);
+    monitor.track(1);
+    bus.failNext[0] = 1;
+    bus.failNext[1] = 1;
+    ASSERT_TRUE(!monitor.submit(bus, 0, makeState(1), 0));
+    ASSERT_TRUE(!monitor.submit(bus, 1, makeState(10), 0));
+
+    // While target 0's retry is being sent, a newer report reaches target 1
+    uint64_t retryUs = monitor.nextServiceUs();
+    bus.afterDelivery = [&](int) { ASSERT_TRUE(monitor.submit(bus, 1, makeState(11), retryUs + 50)); };
+    monitor.service(bus, retryUs);
+
+    // Target 1's old retry must not follow the newer report
+    ASSERT_EQ(bus.delivered[1].size(), 1u);
+    ASSERT_EQ(bus.delivered[1].back().gamepad.sThumbLX, 11);
+    ASSERT_EQ(monitor.getMetrics(1).retries, 0u);
+    ASSERT_EQ(monitor.nextServiceUs(), UINT64_MAX);
+}
+
+int main() {
+    std::cout << "=== Target Health Tests ===\n\n";
+
+    RUN_TEST(TransientFailureIsRetried);
+    RUN_TEST(RetriesAreBounded);
+    RUN_TEST(ReplugBacksOffThenGivesUp);
+    RUN_TEST(ReplugRecoversAndResendsLatest);
+    RUN_TEST(StaleRetryIsDropped);
+
+    std::cout << "\n=== All tests PASSED ===\n";
+    return 0;
+}
@@ -456,6 +456,7 @@ TEST(DebouncingFunctionality) {
 TEST(XInputToStandardConversion) {
     // Test XInput to standard format conversion
     TranslationLayer layer;
+    layer.setStickDeadzoneEnabled(false);   // Stick deadzones are on by default
     
     std::vector<ControllerState> inputs(1);
     inputs[0].userId = 0;
@@ -0,0 +1,243 @@
+/**
+ * @file test_uinput_bus.cpp
+ * @brief Tests for the Linux uinput output backend
+ *
+ * Runs the bus in MEMORY mode, so encoding, diffing and rumble handling are
+ * checked without /dev/uinput; the full-stack test feeds it from a
+ * VirtualHidDevice through HidrawInputSource and a Pipeline.
+ */
+
+#include <cassert>
+#include <iostream>
+#include <linux/input.h>
+#include <memory>
+#include <vector>
+#include "../include/core/hidraw_source.hpp"
+#include "../include/core/pipeline.hpp"
+#include "../include/core/uinput_bus.hpp"
+#include "../include/core/virtual_hid_device.hpp"
+#include "../include/utils/config_manager.hpp"
+#include "hid_descriptors.hpp"
+
+#define TEST(name) void test_##name()
+#define RUN_TEST(name) do { \
+    std::cout << "Running " #name "..."; \
+    test_##name(); \
+    std::cout << " PASSED\n"; \
+} while(0)
+
+#define ASSERT_EQ(a, b) do { \
+    if ((a) != (b)) { \
+        std::cerr << "ASSERT_EQ failed: " << (a) << " != " << (b) << " at line " << __LINE__ << "\n"; \
+        assert(false); \
+    } \
+} while(0)
+
+#define ASSERT_TRUE(x) do { \
+    if (!(x)) { \
+        std::cerr << "ASSERT_TRUE failed at line " << __LINE__ << "\n"; \
+        assert(false); \
+    } \
+} while(0)
+
+static TranslatedState makeState(TranslatedState::TargetType type, WORD buttons, SHORT lx, SHORT ly, BYTE lt) {
+    TranslatedState state{};
+    state.targetType = type;
+    state.gamepad.wButtons = buttons;
+    state.gamepad.sThumbLX = lx;
+    state.gamepad.sThumbLY = ly;
+    state.gamepad.bLeftTrigger = lt;
+    return state;
+}
+
+static ff_effect rumbleEffect(int id, uint16_t strong, uint16_t weak) {
+    ff_effect effect{};
+    effect.type = FF_RUMBLE;
+    effect.id = static_cast<int16_t>(id);
+    effect.u.rumble.strong_magnitude = strong;
+    effect.u.rumble.weak_magnitude = weak;
+    return effect;
+}
+
+TEST(EncodesX360Layout) {
+    UinputBus bus(UinputBus::Mode::MEMORY);
+    TranslatedState state = makeState(TranslatedState::TARGET_XINPUT,
+                                      XINPUT_GAMEPAD_A | XINPUT_GAMEPAD_BACK | XINPUT_GAMEPAD_DPAD_UP |
+                                      XINPUT_GAMEPAD_DPAD_RIGHT, 32767, 32767, 200);
+    ASSERT_TRUE(bus.submit(0, state));
+
+    ASSERT_EQ(bus.getValue(0, EV_KEY, BTN_SOUTH), 1);
+    ASSERT_EQ(bus.getValue(0, EV_KEY, BTN_EAST), 0);
+    ASSERT_EQ(bus.getValue(0, EV_KEY, BTN_SELECT), 1);
+    ASSERT_EQ(bus.getValue(0, EV_ABS, ABS_X), 32767);
+    ASSERT_EQ(bus.getValue(0, EV_ABS, ABS_Y), -32768);     // Up is negative on evdev
+    ASSERT_EQ(bus.getValue(0, EV_ABS, ABS_Z), 200);
+    ASSERT_EQ(bus.getValue(0, EV_ABS, ABS_HAT0X), 1);
+    ASSERT_EQ(bus.getValue(0, EV_ABS, ABS_HAT0Y), -1);
+
+    // First batch carries the whole state: 10 keys and 8 axes
+    ASSERT_EQ(bus.getLastBatch(0).size(), 18u);
+}
+
+TEST(EncodesDs4Layout) {
+    UinputBus bus(UinputBus::Mode::MEMORY);
+    TranslatedState state = makeState(TranslatedState::TARGET_DINPUT, XINPUT_GAMEPAD_Y | XINPUT_GAMEPAD_START,
+                                      -32768, 32767, 1);
+    ASSERT_TRUE(bus.submit(3, state));
+
+    ASSERT_EQ(bus.getValue(3, EV_KEY, BTN_NORTH), 1);       // Triangle
+    ASSERT_EQ(bus.getValue(3, EV_KEY, BTN_START), 1);       // Options
+    ASSERT_EQ(bus.getValue(3, EV_KEY, BTN_TL2), 1);         // Digital L2 with any travel
+    ASSERT_EQ(bus.getValue(3, EV_KEY, BTN_TR2), 0);
+    ASSERT_EQ(bus.getValue(3, EV_ABS, ABS_X), 0);
+    ASSERT_EQ(bus.getValue(3, EV_ABS, ABS_Y), 0);           // Up is 0, as in the DS4 report
+    ASSERT_EQ(bus.getValue(3, EV_ABS, ABS_RX), 127);
+    ASSERT_EQ(bus.getValue(3, EV_ABS, ABS_Z), 1);
+    ASSERT_EQ(bus.getLastBatch(3).size(), 20u);
+}
+
+TEST(BatchesOnlyChangedEvents) {
+    UinputBus bus(UinputBus::Mode::MEMORY);
+    TranslatedState state = makeState(TranslatedState::TARGET_XINPUT, 0, 0, 0, 0);
+    ASSERT_TRUE(bus.submit(1, state));
+    ASSERT_EQ(bus.getStats(1).writes, 1u);
+
+    // Unchanged frame: nothing written
+    ASSERT_TRUE(bus.submit(1, state));
+    ASSERT_EQ(bus.getStats(1).writes, 1u);
+
+    state.gamepad.wButtons = XINPUT_GAMEPAD_B;
+    state.gamepad.sThumbRX = -1000;
+    ASSERT_TRUE(bus.submit(1, state));
+    std::vector<UinputBus::Event> batch = bus.getLastBatch(1);
+    ASSERT_EQ(batch.size(), 2u);
+    ASSERT_EQ(batch[0].code, BTN_EAST);
+    ASSERT_EQ(batch[1].code, ABS_RX);
+    ASSERT_EQ(batch[1].value, -1000);
+
+    UinputBus::Stats stats = bus.getStats(1);
+    ASSERT_EQ(stats.submits, 3u);
+    ASSERT_EQ(stats.writes, 2u);
+    ASSERT_EQ(stats.events, 20u);
+    ASSERT_EQ(bus.getTargetCount(), 1u);
+}
+
+TEST(ReplugResendsFullState) {
+    UinputBus bus(UinputBus::Mode::MEMORY);
+    TranslatedState state = makeState(TranslatedState::TARGET_XINPUT, XINPUT_GAMEPAD_X, 0, 0, 0);
+    ASSERT_TRUE(bus.submit(0, state));
+    ASSERT_TRUE(!bus.replug(7));
+    ASSERT_TRUE(bus.replug(0));
+    ASSERT_EQ(bus.getStats(0).creations, 2u);
+
+    ASSERT_TRUE(bus.submit(0, state));
+    ASSERT_EQ(bus.getLastBatch(0).size(), 18u);
+}
+
+TEST(RumbleEffectsDriveCallback) {
+    UinputBus bus(UinputBus::Mode::MEMORY);
+    std::vector<std::pair<float, float>> calls;
+    bus.setRumbleCallback([&](int userId, float left, float right) {
+        ASSERT_EQ(userId, 2);
+        calls.push_back({left, right});
+    });
+    ASSERT_TRUE(!bus.uploadEffect(2, rumbleEffect(0, 0xFFFF, 0)));   // No target yet
+    ASSERT_TRUE(bus.submit(2, makeState(TranslatedState::TARGET_XINPUT, 0, 0, 0, 0)));
+
+    ff_effect periodic = rumbleEffect(1, 0, 0);
+    periodic.type = FF_PERIODIC;
+    ASSERT_TRUE(!bus.uploadEffect(2, periodic));
+
+    ASSERT_TRUE(bus.uploadEffect(2, rumbleEffect(0, 0xFFFF, 0)));
+    ASSERT_TRUE(bus.uploadEffect(2, rumbleEffect(1, 0x8000, 0x4000)));
+    bus.playEffect(2, 5, true);                                     // Never uploaded: ignored
+    ASSERT_EQ(calls.size(), 0u);
+
+    bus.playEffect(2, 1, true);
+    ASSERT_EQ(calls.size(), 1u);
+    ASSERT_TRUE(calls[0].first > 0.49f && calls[0].first < 0.51f);
+    ASSERT_TRUE(calls[0].second > 0.24f && calls[0].second < 0.26f);
+
+    // Strongest playing effect per motor
+    bus.playEffect(2, 0, true);
+    ASSERT_EQ(calls.back().first, 1.0f);
+    ASSERT_TRUE(calls.back().second > 0.24f);
+
+    bus.playEffect(2, 0, false);
+    ASSERT_TRUE(calls.back().first < 0.51f);
+
+    // Erasing the last playing effect stops the motors
+    ASSERT_TRUE(bus.eraseEffect(2, 1));
+    ASSERT_EQ(calls.back().first, 0.0f);
+    ASSERT_EQ(calls.back().second, 0.0f);
+    ASSERT_TRUE(!bus.eraseEffect(2, 1));
+    ASSERT_EQ(bus.getStats(2).rumbleEvents, 4u);
+}
+
+TEST(RumbleCallbackRunsOutsideTheBusLock) {
+    // A callback that forwards rumble straight into another report would deadlock under the lock
+    UinputBus bus(UinputBus::Mode::MEMORY);
+    ASSERT_TRUE(bus.submit(1, makeState(TranslatedState::TARGET_XINPUT, 0, 0, 0, 0)));
+    uint64_t seenEvents = 0;
+    bus.setRumbleCallback([&](int userId, float left, float right) {
+        (void)left;
+        (void)right;
+        seenEvents = bus.getStats(userId).rumbleEvents;
+        bus.submit(userId, makeState(TranslatedState::TARGET_XINPUT, XINPUT_GAMEPAD_A, 0, 0, 0));
+    });
+    ASSERT_TRUE(bus.uploadEffect(1, rumbleEffect(0, 0xFFFF, 0)));
+    bus.playEffect(1, 0, true);
+    ASSERT_EQ(seenEvents, 1u);
+    ASSERT_EQ(bus.getValue(1, EV_KEY, BTN_SOUTH), 1);
+}
+
+TEST(CreateFallsBackToMemory) {
+    std::unique_ptr<UinputBus> bus = UinputBus::create();
+    ASSERT_TRUE(bus->getMode() == (UinputBus::uinputAvailable() ? UinputBus::Mode::UINPUT : UinputBus::Mode::MEMORY));
+    ASSERT_EQ(bus->pumpFeedback(0), 0u);
+}
+
+TEST(HidrawToUinputFullStack) {
+    static const VirtualHidDevice::Spec spec = {"Wireless Controller", 0x054C, 0x05C4, hid_fixtures::DS4_DESCRIPTOR};
+    auto source = std::make_unique<HidrawInputSource>();
+    VirtualHidDevice ds4;
+    ASSERT_TRUE(ds4.create(spec) && ds4.attach(*source));
+    HidrawInputSource* capture = source.get();
+
+    auto bus = std::make_unique<UinputBus>(UinputBus::Mode::MEMORY);
+    UinputBus* output = bus.get();
+    ConfigManager config;
+    config.setBool("stick_deadzone_enabled", false);
+    Pipeline pipeline(0, config.createView(), std::move(source), std::move(bus));
+
+    // Cross held, left stick full right
+    std::vector<uint8_t> report = hid_fixtures::ds4Report(255, 128, 1u << 1);
+    ASSERT_TRUE(ds4.sendReport(report.data(), report.size()));
+    for (int i = 0; i < 200 && capture->getReportCount(0) == 0; ++i) {
+        capture->poll(10);
+    }
+    pipeline.runFrame(1000);
+
+    // HID sources have no XInput slot: their target id is -1
+    ASSERT_EQ(output->getTargetCount(), 1u);
+    ASSERT_EQ(output->getValue(-1, EV_KEY, BTN_SOUTH), 1);
+    ASSERT_TRUE(output->getValue(-1, EV_ABS, ABS_X) > 32000);
+    ASSERT_EQ(output->getStats(-1).writes, 1u);
+}
+
+int main() {
+    std::cout << "=== Uinput Bus Tests ===\n";
+    std::cout << "(/dev/uinput " << (UinputBus::uinputAvailable() ? "available" : "unavailable") << ")\n\n";
+
+    RUN_TEST(EncodesX360Layout);
+    RUN_TEST(EncodesDs4Layout);
+    RUN_TEST(BatchesOnlyChangedEvents);
+    RUN_TEST(ReplugResendsFullState);
+    RUN_TEST(RumbleEffectsDriveCallback);
+    RUN_TEST(RumbleCallbackRunsOutsideTheBusLock);
+    RUN_TEST(CreateFallsBackToMemory);
+    RUN_TEST(HidrawToUinputFullStack);
+
+    std::cout << "\n=== All tests PASSED ===\n";
+    return 0;
+}
@@ -0,0 +1,170 @@
+/**
+ * @file test_xinput_slot_scheduler.cpp
+ * @brief Tests for XInput slot presence scheduling with a fake XInput provider
+ */
+
+#include <array>
+#include <cassert>
+#include <iostream>
+#include "../include/core/xinput_slot_scheduler.hpp"
+
+#define TEST(name) void test_##name()
+#define RUN_TEST(name) do { \
+    std::cout << "Running " #name "..."; \
+    test_##name(); \
+    std::cout << " PASSED\n"; \
+} while(0)
+
+#define ASSERT_EQ(a, b) do { \
+    if ((a) != (b)) { \
+        std::cerr << "ASSERT_EQ failed: " << (a) << " != " << (b) << " at line " << __LINE__ << "\n"; \
+        assert(false); \
+    } \
+} while(0)
+
+#define ASSERT_TRUE(x) do { \
+    if (!(x)) { \
+        std::cerr << "ASSERT_TRUE failed at line " << __LINE__ << "\n"; \
+        assert(false); \
+    } \
+} while(0)
+
+/**
+ * Fake XInput: a simulated clock, a set of plugged-in slots, and a per-call
+ * cost that is much higher for empty slots (as on real hardware).
+ */
+struct FakeXInput {
+    uint64_t nowUs = 0;
+    std::array<bool, XUSER_MAX_COUNT> connected{};
+    std::array<int, XUSER_MAX_COUNT> calls{};
+    uint64_t connectedCostUs = 20;
+    uint64_t emptyCostUs = 800;
+
+    XInputSlotScheduler makeScheduler() {
+        return XInputSlotScheduler(
+            [this](DWORD slot, XINPUT_STATE* state) -> DWORD {
+                calls[slot]++;
+                if (connected[slot]) {
+                    nowUs += connectedCostUs;
+                    state->dwPacketNumber = static_cast<DWORD>(calls[slot]);
+                    return ERROR_SUCCESS;
+                }
+                nowUs += emptyCostUs;
+                return ERROR_DEVICE_NOT_CONNECTED;
+            },
+            [this]() { return nowUs; });
+    }
+
+    // One 1 kHz frame over all slots
+    void frame(XInputSlotScheduler& scheduler) {
+        for (DWORD slot = 0; slot < XUSER_MAX_COUNT; ++slot) {
+            XINPUT_STATE state{};
+            scheduler.poll(slot, &state);
+        }
+        nowUs += 1000;
+    }
+};
+
+TEST(ConnectedSlotsPolledEveryFrame) {
+    FakeXInput fake;
+    fake.connected[0] = true;
+    auto scheduler = fake.makeScheduler();
+
+    for (int i = 0; i < 100; ++i) fake.frame(scheduler);
+
+    ASSERT_EQ(fake.calls[0], 100);
+    auto stats = scheduler.getStats(0);
+    ASSERT_TRUE(stats.connected);
+    ASSERT_EQ(stats.skipped, 0u);
+    ASSERT_EQ(stats.maxCostUs, 20.0);
+    ASSERT_EQ(stats.averageCostUs, 20.0);
+}
+
+TEST(EmptySlotsBackOffExponentially) {
+    FakeXInput fake;
+    auto scheduler = fake.makeScheduler();
+
+    // ~10 seconds of frames: without scheduling this would be 10000 calls per slot
+    for (int i = 0; i < 10000; ++i) fake.frame(scheduler);
+
+    // Probes at ~0, 50, 150, 350, 750, 1550 ms, then every 2 s
+    ASSERT_TRUE(fake.calls[1] >= 8 && fake.calls[1] <= 12);
+    auto stats = scheduler.getStats(1);
+    ASSERT_TRUE(!stats.connected);
+    ASSERT_EQ(stats.backoffUs, XInputSlotScheduler::MAX_BACKOFF_US);
+    ASSERT_EQ(stats.emptyProbes, static_cast<uint64_t>(fake.calls[1]));
+    ASSERT_EQ(stats.calls + stats.skipped, 10000u);
+    ASSERT_EQ(stats.maxCostUs, 800.0);
+}
+
+TEST(ForcedProbeFindsHotPluggedPad) {
+    FakeXInput fake;
+    auto scheduler = fake.makeScheduler();
+    for (int i = 0; i < 5000; ++i) fake.frame(scheduler);
+
+    // Pad arrives while the slot is deep in backoff; HID arrival forces a probe
+    fake.connected[2] = true;
+    int before = fake.calls[2];
+    scheduler.requestProbe();
+    fake.frame(scheduler);
+    ASSERT_EQ(fake.calls[2], before + 1);
+    ASSERT_TRUE(scheduler.getStats(2).connected);
+
+    // From now on polled every frame
+    for (int i = 0; i < 10; ++i) fake.frame(scheduler);
+    ASSERT_EQ(fake.calls[2], before + 11);
+}
+
+TEST(UnforcedHotPlugFoundWithinBackoff) {
+    FakeXInput fake;
+    auto scheduler = fake.makeScheduler();
+    for (int i = 0; i < 5000; ++i) fake.frame(scheduler);
+
+    fake.connected[3] = true;
+    int frames = 0;
+    while (!scheduler.getStats(3).connected && frames < 5000) {
+        fake.frame(scheduler);
+        frames++;
+    }
+    ASSERT_TRUE(scheduler.getStats(3).connected);
+    ASSERT_TRUE(frames * 1000u <= XInputSlotScheduler::MAX_BACKOFF_US + 10000);
+}
+
+TEST(UnplugRestartsShortBackoff) {
+    FakeXInput fake;
+    fake.connected[0] = true;
+    auto scheduler = fake.makeScheduler();
+    for (int i = 0; i < 10; ++i) fake.frame(scheduler);
+
+    fake.connected[0] = false;
+    fake.frame(scheduler);
+    auto stats = scheduler.getStats(0);
+    ASSERT_TRUE(!stats.connected);
+    ASSERT_EQ(stats.backoffUs, XInputSlotScheduler::INITIAL_BACKOFF_US);
+
+    // Re-plugged quickly: found on the next short probe
+    fake.connected[0] = true;
+    for (int i = 0; i < 60; ++i) fake.frame(scheduler);
+    ASSERT_TRUE(scheduler.getStats(0).connected);
+}
+
+TEST(InvalidSlotRejected) {
+    FakeXInput fake;
+    auto scheduler = fake.makeScheduler();
+    XINPUT_STATE state{};
+    ASSERT_EQ(scheduler.poll(XUSER_MAX_COUNT, &state), static_cast<DWORD>(ERROR_DEVICE_NOT_CONNECTED));
+}
+
+int main() {
+    std::cout << "=== XInput Slot Scheduler Tests ===\n\n";
+
+    RUN_TEST(ConnectedSlotsPolledEveryFrame);
+    RUN_TEST(EmptySlotsBackOffExponentially);
+    RUN_TEST(ForcedProbeFindsHotPluggedPad);
+    RUN_TEST(UnforcedHotPlugFoundWithinBackoff);
+    RUN_TEST(UnplugRestartsShortBackoff);
+    RUN_TEST(InvalidSlotRejected);
+
+    std::cout << "\n=== All tests PASSED ===\n";
+    return 0;
+}